@@ -20,6 +20,7 @@
 # define HPP_CORE_BASIC_CONFIGURATION_SHOOTER_HH
 
 # include <sstream>
+# include <boost/random/mersenne_twister.hpp>
 # include <hpp/model/device.hh>
 # include <hpp/model/joint.hh>
 # include <hpp/model/joint-configuration.hh>
@@ -31,6 +32,11 @@ namespace hpp {
     /// \{
 
     /// Uniformly sample with bounds of degrees of freedom.
+    ///
+    /// Extra configuration variables are drawn from a random number
+    /// generator owned by the instance. Joint configurations are sampled by
+    /// the joints, that use the global generator of the C library: see
+    /// SeededConfigurationShooter for reproducible sampling.
     class HPP_CORE_DLLAPI BasicConfigurationShooter :
       public ConfigurationShooter
     {
@@ -42,6 +48,7 @@ namespace hpp {
 	ptr->init (shPtr);
 	return shPtr;
       }
+      using ConfigurationShooter::shoot;
       virtual ConfigurationPtr_t shoot () const
       {
 	JointVector_t jv = robot_->getJointVector ();
@@ -65,15 +72,23 @@ namespace hpp {
 	    oss << i << ". min = " <<lower<< ", max = " << upper << std::endl;
 	    throw std::runtime_error (oss.str ());
 	  }
-	  (*config) [offset + i] = lower + (upper - lower) * rand ()/RAND_MAX;
+	  // 32 random bits are enough for sampling.
+	  (*config) [offset + i] = lower + (upper - lower) *
+	    (value_type) generator_ () / 4294967296.;
 	}
 	return config;
       }
+      /// Reset random number generator
+      virtual void seed (unsigned int seed)
+      {
+	generator_.seed (seed);
+      }
     protected:
       /// Uniformly sample configuration space
       ///
       /// Note that translation joints have to be bounded.
-      BasicConfigurationShooter (const DevicePtr_t& robot) : robot_ (robot)
+      BasicConfigurationShooter (const DevicePtr_t& robot) : robot_ (robot),
+	generator_ ()
       {
       }
       void init (const BasicConfigurationShooterPtr_t& self)
@@ -84,6 +99,7 @@ namespace hpp {
 
     private:
       const DevicePtr_t& robot_;
+      mutable boost::mt19937 generator_;
       BasicConfigurationShooterWkPtr_t weak_;
     }; // class BasicConfigurationShooter
     /// \}
@@ -0,0 +1,207 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_CACHED_PATH_VALIDATION_HH
+# define HPP_CORE_CACHED_PATH_VALIDATION_HH
+
+# include <list>
+# include <map>
+# include <hpp/core/path-validation.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup validation
+    /// \{
+
+    /// Path validation storing the results of another path validation
+    ///
+    /// Path optimizers run one after the other validate again and again
+    /// the same segments: a shortcut tried by RandomShortcut is tried again
+    /// by PartialShortcut, the segments kept by an optimizer are validated
+    /// by the next one. Results of the validation of straight paths are
+    /// stored, identified by the end configurations and the length of the
+    /// path, the revisions of its constraint set and of its config
+    /// projector (see Constraint::revision) and the right hand side of the
+    /// config projector, so that later validations of the same segment
+    /// return the stored result.
+    ///
+    /// Stored results are removed when obstacles are added or removed. When
+    /// the cache is full, the least recently used result is removed.
+    class HPP_CORE_DLLAPI CachedPathValidation : public PathValidation
+    {
+    public:
+      /// Create instance and return shared pointer
+      /// \param pathValidation path validation the results of which are
+      ///        stored,
+      /// \param size maximal number of stored results.
+      static CachedPathValidationPtr_t create
+	(const PathValidationPtr_t& pathValidation, std::size_t size);
+
+      /// Validate a path
+      ///
+      /// Not stored.
+      virtual bool validate (const PathPtr_t& path, bool reverse,
+			     PathPtr_t& validPart) HPP_CORE_DEPRECATED;
+
+      /// Validate a path
+      ///
+      /// Not stored.
+      virtual bool validate (const PathPtr_t& path, bool reverse,
+			     PathPtr_t& validPart,
+			     ValidationReport& report) HPP_CORE_DEPRECATED;
+
+      /// Compute the largest valid interval starting from the path beginning
+      ///
+      /// \param path the path to check for validity,
+      /// \param reverse if true check from the end,
+      /// \retval the extracted valid part of the path, pointer to path if
+      ///         path is valid.
+      /// \retval report information about the validation process. A report
+      ///         is allocated if the path is not valid. Reports of stored
+      ///         results are shared and should not be modified.
+      /// \return whether the whole path is valid.
+      virtual bool validate (const PathPtr_t& path, bool reverse,
+			     PathPtr_t& validPart,
+			     PathValidationReportPtr_t& report);
+
+      /// Compute whether the whole path is valid
+      ///
+      /// A stored result of validate in any direction is used.
+      virtual bool isValid (const PathPtr_t& path);
+
+      /// Add an obstacle to the inner path validation and clear the cache
+      virtual void addObstacle (const CollisionObjectPtr_t& object);
+
+      /// Remove a collision pair from the inner path validation and clear
+      /// the cache
+      virtual void removeObstacleFromJoint
+	(const JointPtr_t& joint, const CollisionObjectPtr_t& obstacle);
+
+      /// Remove an obstacle from the inner path validation and clear the
+      /// cache
+      virtual void removeObstacle (const CollisionObjectPtr_t& object);
+
+      /// Notify the inner path validation that an obstacle has moved and
+      /// clear the cache
+      virtual void obstacleMoved (const CollisionObjectPtr_t& object);
+
+      /// Set distance field of the inner path validation
+      ///
+      /// The cache is kept: the field does not change validation results.
+      virtual void distanceField (const DistanceFieldPtr_t& field);
+
+      /// Create a copy validating paths of another robot
+      ///
+      /// The copy stores results of a copy of the inner path validation in
+      /// its own cache: caches are not shared between threads.
+      /// \return new instance, or an empty pointer if the inner path
+      ///         validation cannot be copied.
+      virtual PathValidationPtr_t copy (const DevicePtr_t& robot) const;
+
+      /// Get path validation the results of which are stored
+      const PathValidationPtr_t& inner () const
+      {
+	return inner_;
+      }
+
+      /// \name Cache of results
+      /// \{
+
+      /// Set maximal number of stored results
+      void cacheSize (std::size_t size);
+
+      /// Get maximal number of stored results
+      std::size_t cacheSize () const
+      {
+	return cacheSize_;
+      }
+
+      /// Remove stored results and reset counters
+      void clearCache ();
+
+      /// Number of validations found in the cache
+      std::size_t cacheHits () const
+      {
+	return cacheHits_;
+      }
+
+      /// Number of validations computed by the inner path validation
+      std::size_t cacheMisses () const
+      {
+	return cacheMisses_;
+      }
+      /// \}
+
+    protected:
+      CachedPathValidation (const PathValidationPtr_t& pathValidation,
+			    std::size_t size);
+
+    private:
+      struct CacheKey {
+	Configuration_t initial;
+	Configuration_t end;
+	value_type length;
+	/// Revisions of the constraint set and of its config projector, 0
+	/// if the path is not constrained
+	std::size_t constraints;
+	std::size_t configProjector;
+	vector_t rightHandSide;
+	bool operator< (const CacheKey& other) const;
+      }; // struct CacheKey
+      /// Result of the validation of a path
+      ///
+      /// If the path is not valid, the length of the valid part and the
+      /// report are stored for each direction, length is negative if the
+      /// path has not been validated in this direction.
+      struct CacheEntry {
+	CacheEntry (bool s) : success (s)
+	{
+	  validLength [0] = validLength [1] = -1;
+	}
+	bool success;
+	value_type validLength [2];
+	PathValidationReportPtr_t report [2];
+      }; // struct CacheEntry
+      /// Entries by decreasing time of last use
+      typedef std::list <std::pair <CacheKey, CacheEntry> > Cache_t;
+      typedef std::map <CacheKey, Cache_t::iterator> CacheIndex_t;
+      /// Compute key of a path
+      /// \return false if results for this path are not stored.
+      bool key (const PathPtr_t& path, CacheKey& key) const;
+      /// Find entry and make it the most recently used
+      /// \return pointer to entry, NULL if not found.
+      CacheEntry* find (const CacheKey& key);
+      /// Insert a new entry, the key should not be in the cache
+      CacheEntry& insert (const CacheKey& key, bool success);
+      /// Remove least recently used entries above the maximal size
+      void trimCache ();
+      /// Remove stored results, keep counters
+      void invalidate ();
+
+      PathValidationPtr_t inner_;
+      std::size_t cacheSize_;
+      Cache_t cache_;
+      CacheIndex_t cacheIndex_;
+      std::size_t cacheHits_;
+      std::size_t cacheMisses_;
+    }; // class CachedPathValidation
+    /// \}
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_CACHED_PATH_VALIDATION_HH
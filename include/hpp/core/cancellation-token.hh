@@ -0,0 +1,70 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_CANCELLATION_TOKEN_HH
+# define HPP_CORE_CANCELLATION_TOKEN_HH
+
+# include <boost/atomic.hpp>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup path_planning
+    /// \{
+
+    /// Request to stop a computation running in another thread
+    ///
+    /// A token is shared between the thread that may cancel and the
+    /// computation, that checks it at points where it can stop cleanly:
+    /// between steps of PathPlanner::solve (see
+    /// PathPlanner::cancellationToken) and between iterations of path
+    /// optimizers (see PathOptimizer::cancellationToken). Cancellation is
+    /// not reverted: a new token is created for each computation.
+    class HPP_CORE_DLLAPI CancellationToken
+    {
+    public:
+      /// Return shared pointer to new object.
+      static CancellationTokenPtr_t create ()
+      {
+	return CancellationTokenPtr_t (new CancellationToken);
+      }
+      /// Request the computation to stop
+      ///
+      /// Can be called from any thread.
+      void cancel ()
+      {
+	cancelled_.store (true, boost::memory_order_release);
+      }
+      /// Whether cancel has been called
+      bool cancelled () const
+      {
+	return cancelled_.load (boost::memory_order_acquire);
+      }
+    protected:
+      CancellationToken () : cancelled_ (false)
+      {
+      }
+    private:
+      boost::atomic <bool> cancelled_;
+    }; // class CancellationToken
+    /// \}
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_CANCELLATION_TOKEN_HH
@@ -42,6 +42,44 @@ namespace hpp {
 				     const ValidationReportPtr_t& report) :
 	PathValidationReport (param, report)
       {}
+
+      /// Get the collision report of a path report, if it can be reused
+      ///
+      /// \param report report given to a path validation.
+      /// \return the configuration report of report if it is a collision
+      ///         report and nobody else refers to them, an empty pointer
+      ///         otherwise.
+      static CollisionValidationReportPtr_t reusableConfigurationReport
+	(const PathValidationReportPtr_t& report)
+      {
+	if (!report.unique () || !report->configurationReport.unique ()) {
+	  return CollisionValidationReportPtr_t ();
+	}
+	return HPP_DYNAMIC_PTR_CAST (CollisionValidationReport,
+				     report->configurationReport);
+      }
+
+      /// Get a report to fill after a failed validation
+      ///
+      /// \param report report given to a path validation: kept if nobody
+      ///        else refers to it and it is a collision report, replaced by
+      ///        a new report without configuration report otherwise.
+      /// \return report.
+      static CollisionPathValidationReportPtr_t reuse
+	(PathValidationReportPtr_t& report)
+      {
+	CollisionPathValidationReportPtr_t result;
+	if (report.unique ()) {
+	  result = HPP_DYNAMIC_PTR_CAST (CollisionPathValidationReport,
+					 report);
+	}
+	if (!result) {
+	  result = CollisionPathValidationReportPtr_t
+	    (new CollisionPathValidationReport (0, ValidationReportPtr_t ()));
+	  report = result;
+	}
+	return result;
+      }
     }; // struct CollisionPathValidationReport
     /// \}
   } // namespace core
@@ -19,6 +19,8 @@
 #ifndef HPP_CORE_COLLISION_VALIDATION_HH
 # define HPP_CORE_COLLISION_VALIDATION_HH
 
+# include <map>
+# include <boost/unordered_set.hpp>
 # include <hpp/core/collision-validation-report.hh>
 # include <hpp/core/config-validation.hh>
 # include <hpp/fcl/collision_data.h>
@@ -30,6 +32,11 @@ namespace hpp {
 
     /// Validate a configuration with respect to collision
     ///
+    /// Collision pairs between bodies of the robot are tested one by one.
+    /// Obstacles are stored in a dynamic AABB tree (see ObstacleScene): each
+    /// inner object of the robot is tested only against the obstacles the
+    /// bounding box of which overlaps its own bounding box.
+    /// \note obstacleMoved should be called after an obstacle has moved.
     class HPP_CORE_DLLAPI CollisionValidation : public ConfigValidation
     {
     public:
@@ -61,9 +68,38 @@ namespace hpp {
       ///         a validation report will be allocated and returned via this
       ///         shared pointer.
       /// \return whether the whole config is valid.
+      /// \note If validationReport is the only pointer to a
+      ///       CollisionValidationReport, this report is filled instead of
+      ///       allocating a new one.
       virtual bool validate (const Configuration_t& config,
 			     ValidationReportPtr_t& validationReport);
 
+      /// Compute whether the configuration is valid without report
+      virtual bool isValid (const Configuration_t& config);
+
+      /// Compute whether several configurations are valid
+      ///
+      /// Configurations are split in contiguous ranges processed by
+      /// numberThreads threads. Threads other than the calling one use
+      /// copies of this object with a clone of the robot, built at the first
+      /// call and after obstacles are modified.
+      /// \sa ConfigValidation::validateBatch
+      virtual bool validateBatch (const matrix_t& configurations,
+				  std::vector <bool>& valid, bool stopAtFirst);
+
+      /// Set number of threads used by validateBatch
+      /// \param number number of threads, 1 by default.
+      void numberThreads (std::size_t number)
+      {
+	numberThreads_ = number;
+	workers_.clear ();
+      }
+      /// Get number of threads used by validateBatch
+      std::size_t numberThreads () const
+      {
+	return numberThreads_;
+      }
+
       /// Add an obstacle
       /// \param object obstacle added
       /// Store obstacle and build a collision pair with each body of the robot.
@@ -77,6 +113,104 @@ namespace hpp {
       /// validation methods that do not care about obstacles.
       virtual void removeObstacleFromJoint
 	(const JointPtr_t& joint, const CollisionObjectPtr_t& obstacle);
+
+      /// Remove an obstacle
+      /// \param object obstacle previously added, ignored otherwise.
+      ///
+      /// The obstacle is removed from the broad phase structure in
+      /// logarithmic time in the number of obstacles.
+      virtual void removeObstacle (const CollisionObjectPtr_t& object);
+
+      /// Update the broad phase structure after an obstacle has moved
+      /// \param object obstacle previously added, ignored otherwise.
+      ///
+      /// The distance field is dropped if it contains the obstacle.
+      virtual void obstacleMoved (const CollisionObjectPtr_t& object);
+
+      /// Set distance field of the static obstacles
+      /// \param field field, empty pointer to disable.
+      ///
+      /// Inner objects the bounding box of which is proved far from the
+      /// obstacles by the field are not tested against the obstacles. The
+      /// field is used only while it contains all the obstacles of the
+      /// scene.
+      virtual void distanceField (const DistanceFieldPtr_t& field);
+
+      /// Create a copy validating configurations of another robot
+      /// \param robot copy of the robot the validation applies to.
+      ///
+      /// The copy shares the obstacle scene of this object: copying does not
+      /// depend on the number of obstacles. Adding again an obstacle of the
+      /// scene to the copy has no effect. Obstacles removed from joints by
+      /// removeObstacleFromJoint are not removed in the copy.
+      virtual ConfigValidationPtr_t copy (const DevicePtr_t& robot) const;
+
+      /// Get obstacles
+      const ObstacleScenePtr_t& obstacleScene () const
+      {
+	return obstacles_;
+      }
+
+      /// Number of pairs of robot objects and of robot objects tested
+      /// against obstacles, plus one for forward kinematics
+      virtual value_type cost () const
+      {
+	return (value_type) (1 + collisionPairs_.size () +
+			     innerObjects_.size ());
+      }
+
+      /// \name Adaptive ordering of collision tests
+      /// \{
+
+      /// Number of collisions reported by each pair of objects
+      typedef std::map <CollisionPair_t, std::size_t> HitCounts_t;
+
+      /// Set whether pairs that collide are tested first
+      ///
+      /// If true, a pair of bodies of the robot that collides is moved to the
+      /// front of the list of pairs, and the pairs with obstacles that
+      /// collided most recently are tested before the broad phase.
+      /// Disabled by default.
+      void adaptiveOrdering (bool adaptive)
+      {
+	adaptiveOrdering_ = adaptive;
+	if (!adaptive) hotPairs_.clear ();
+      }
+      /// Get whether pairs that collide are tested first
+      bool adaptiveOrdering () const
+      {
+	return adaptiveOrdering_;
+      }
+      /// Get number of collisions reported by each pair of objects
+      ///
+      /// Pairs that never collided are not in the map.
+      const HitCounts_t& hitCounts () const
+      {
+	return hitCounts_;
+      }
+      /// Reset collision statistics
+      void resetHitCounts ()
+      {
+	hitCounts_.clear ();
+      }
+      /// \}
+
+      /// Set whether collision tests of bodies that did not move are skipped
+      ///
+      /// If true, the configuration is compared to the previous validated
+      /// one. A joint moves if its configuration variables changed or if
+      /// its parent joint moved. Pairs of objects that were found collision
+      /// free are not tested again as long as the joints holding them do
+      /// not move. This speeds up validation of successive configurations
+      /// along a path in which few joints move.
+      /// Disabled by default.
+      /// \note obstacles are assumed not to move.
+      void incremental (bool incremental);
+      /// Get whether collision tests of bodies that did not move are skipped
+      bool incremental () const
+      {
+	return incremental_;
+      }
     public:
       /// fcl low level request object used for collision checking.
       /// modify this attribute to obtain more detailed validation
@@ -85,8 +219,81 @@ namespace hpp {
     protected:
       CollisionValidation (const DevicePtr_t& robot);
     private:
+      /// Motion of a joint with respect to previous configuration
+      enum Motion {
+	UNKNOWN,
+	STILL,
+	MOVED
+      };
+      /// Set robot configuration and compute forward kinematics
+      ///
+      /// In incremental mode, also forget that objects attached to joints
+      /// that moved are collision free.
+      void computeForwardKinematics (const Configuration_t& config);
+      /// Index of joint in robot joint vector
+      ///
+      /// Joints that do not belong to the robot get the index of a joint
+      /// that always moves.
+      std::size_t jointIndex (const JointPtr_t& joint) const;
+      /// Test collision of robot at current configuration
+      /// \retval object1, object2 colliding objects if any,
+      /// \retval result result of the narrow phase test of these objects.
+      /// \return whether a collision has been found.
+      bool collide (CollisionObjectPtr_t& object1,
+		    CollisionObjectPtr_t& object2,
+		    fcl::CollisionResult& result);
+      /// Create copies of this object used by threads of validateBatch
+      void createWorkers ();
+      /// Collect inner objects of the robot tested against obstacles
+      void collectInnerObjects ();
+      /// Check whether the distance field contains all the obstacles
+      void updateFieldCoverage ();
+      /// Test collision between inner objects of the robot and obstacles
+      /// \retval object1, object2 colliding objects if any,
+      /// \retval result result of the narrow phase test of these objects.
+      /// \return whether a collision has been found.
+      bool collideObstacles (CollisionObjectPtr_t& object1,
+			     CollisionObjectPtr_t& object2,
+			     fcl::CollisionResult& result);
       DevicePtr_t robot_;
-      CollisionPairs_t collisionPairs_;
+      /// Pairs of inner objects of the robot
+      std::vector <CollisionPair_t> collisionPairs_;
+      /// Same pairs as collisionPairs_ in the same order, for the loop over
+      /// pairs
+      FclCollisionPairs_t fclPairs_;
+      /// Obstacles, possibly shared with copies of this object
+      ObstacleScenePtr_t obstacles_;
+      DistanceFieldPtr_t distanceField_;
+      /// Whether distanceField_ contains all the obstacles of the scene
+      bool fieldCovers_;
+      /// Inner objects of the robot tested against obstacles
+      ObjectVector_t innerObjects_;
+      /// Pairs (inner object, obstacle) removed by removeObstacleFromJoint
+      boost::unordered_set <FclCollisionPair_t> disabledPairs_;
+      bool adaptiveOrdering_;
+      /// Pairs with obstacles that collided recently, most recent first
+      CollisionPairs_t hotPairs_;
+      HitCounts_t hitCounts_;
+      /// Result of collision tests reused between calls
+      fcl::CollisionResult collisionResult_;
+      std::size_t numberThreads_;
+      /// Copies used by threads of validateBatch
+      std::vector <CollisionValidationPtr_t> workers_;
+      bool incremental_;
+      /// Last configuration validated in incremental mode
+      Configuration_t previousConfig_;
+      std::map <JointPtr_t, std::size_t> jointIndices_;
+      /// Motion of each joint, indexed as in jointIndices_
+      std::vector <Motion> moved_;
+      std::vector <std::size_t> unknownJoints_;
+      /// Indices of joints holding the objects of fclPairs_
+      std::vector <std::pair <std::size_t, std::size_t> > pairJoints_;
+      /// Whether pairs of fclPairs_ are known to be collision free
+      std::vector <char> pairFree_;
+      /// Indices of joints holding innerObjects_
+      std::vector <std::size_t> innerJoints_;
+      /// Whether innerObjects_ are known to be collision free with obstacles
+      std::vector <char> innerFree_;
       /// This member is used by the validate method that does not take a
       /// validation report as input to call the validate method that expects
       /// a validation report as input. This is not fully satisfactory, but
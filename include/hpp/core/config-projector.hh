@@ -20,6 +20,8 @@
 # define HPP_CORE_CONFIG_PROJECTOR_HH
 
 # include <Eigen/SVD>
+# include <Eigen/Cholesky>
+# include <Eigen/QR>
 
 # include <hpp/core/config.hh>
 # include <hpp/core/constraint.hh>
@@ -31,6 +33,10 @@
 
 namespace hpp {
   namespace core {
+    namespace configProjector {
+      HPP_PREDEF_CLASS (BatchThreads);
+      typedef boost::shared_ptr <BatchThreads> BatchThreadsPtr_t;
+    } // namespace configProjector
     /// \addtogroup constraints
     /// \{
 
@@ -58,6 +64,37 @@ namespace hpp {
     class HPP_CORE_DLLAPI ConfigProjector : public Constraint
     {
     public:
+      /// Method that solves the linearized constraints at each iteration
+      ///
+      /// Levels of priority followed by lower priority levels require the
+      /// projector on the kernel of their Jacobian, they are always solved
+      /// by singular value decomposition.
+      enum LinearSolver {
+	/// Pseudo-inverse by singular value decomposition
+	SVD,
+	/// Damped least squares
+	/// \f$dq = J^T (J J^T + \lambda^2 I)^{-1} e\f$ by Cholesky
+	/// decomposition, see ConfigProjector::damping
+	DAMPED_LEAST_SQUARES,
+	/// Minimal norm solution by rank revealing QR decomposition of
+	/// \f$J^T\f$ with column pivoting
+	QR
+      };
+
+      /// Strategy choosing the length of each Newton step
+      enum StepStrategy {
+	/// Steps scaled by a factor increasing from 0.2 to 0.95, resolution
+	/// stops when the error does not decrease for 3 iterations.
+	FIXED_STEPS,
+	/// Backtracking line search: the full step is halved until the
+	/// squared error satisfies the Armijo condition.
+	LINE_SEARCH,
+	/// Levenberg-Marquardt: steps are computed by damped least squares,
+	/// the damping, relative to the squared error, decreases when the
+	/// error decreases and increases when a step is rejected.
+	LEVENBERG_MARQUARDT
+      };
+
       /// Return shared pointer to new object
       /// \param robot robot the constraint applies to.
       /// \param errorThreshold norm of the value of the constraint under which
@@ -76,6 +113,15 @@ namespace hpp {
       /// return shared pointer to copy
       virtual ConstraintPtr_t copy () const;
 
+      /// Return shared pointer to copy applying to another robot
+      /// \param robot copy of the robot of this projector, for another
+      ///        thread for instance.
+      /// \return copy the numerical constraints of which are copied with
+      ///         functions applying to robot, empty pointer if one of them
+      ///         cannot be copied.
+      /// \sa NumericalConstraint::copy (const DevicePtr_t&)
+      ConfigProjectorPtr_t copy (const DevicePtr_t& robot) const;
+
       /// Add a numerical constraint
       /// \param numericalConstraint The numerical constraint.
       /// \param passiveDofs column indexes of the jacobian vector that will be
@@ -84,13 +130,29 @@ namespace hpp {
       ///        optinal.
       /// \note The intervals are interpreted as a list of couple
       /// (index_start, length) and NOT as (index_start, index_end).
+      /// \sa beginUpdate
       void add (const NumericalConstraintPtr_t& numericalConstraint,
           const SizeIntervals_t& passiveDofs = SizeIntervals_t (0),
           const std::size_t priority = 0);
 
+      /// Start adding several constraints or locked joints
+      ///
+      /// Until commit is called, methods add only store the constraints:
+      /// intervals of non locked degrees of freedom, sizes of the
+      /// workspaces and explicit computation are computed once by commit.
+      /// Other methods should not be called in between.
+      void beginUpdate ()
+      {
+	updating_ = true;
+      }
+
+      /// Finish adding constraints started by beginUpdate
+      void commit ();
+
       void lastIsOptional (bool optional)
       {
         lastIsOptional_ = optional;
+	modified ();
       }
 
       bool lastIsOptional () const
@@ -149,6 +211,7 @@ namespace hpp {
       ///         as the Jacobian to which columns corresponding to locked
       ///         joints have been removed and to which columns corresponding
       ///         to passive dofs are set to 0.
+      /// \sa NumericalConstraint::activeColumns
       void computeValueAndJacobian (ConfigurationIn_t configuration,
 				    vectorOut_t value,
 				    matrixOut_t reducedJacobian);
@@ -157,6 +220,50 @@ namespace hpp {
       /// \return true if the constraints are satisfied
       bool oneStep (ConfigurationOut_t config, const value_type& alpha);
 
+      /// Project several configurations
+      ///
+      /// \param configurations matrix the columns of which are the
+      ///        configurations to project, replaced by their projections,
+      /// \retval success success of the projection of each column,
+      /// \param numberThreads number of threads projecting columns.
+      ///
+      /// Columns are split into ranges, the calling thread projecting the
+      /// first one with this projector. Each other thread projects its
+      /// range with a copy of this projector for its own copy of the
+      /// robot, see copy (const DevicePtr_t&). Copies and threads are kept
+      /// for the next batches until the constraints are modified.
+      /// Statistics of the copies are merged into the statistics of this
+      /// projector.
+      /// \throw std::runtime_error if more than one thread is requested and
+      ///        a numerical constraint has no function builder.
+      void applyBatch (matrixOut_t configurations, std::vector <bool>& success,
+		       std::size_t numberThreads = 1);
+
+      /// Execute one iteration of the projection algorithm on several
+      /// configurations
+      ///
+      /// \param configurations matrix the columns of which are the
+      ///        configurations, updated by the iteration,
+      /// \param alpha step of the iteration for each column,
+      /// \retval success whether the constraints are satisfied by each
+      ///         column after the iteration.
+      /// \sa applyBatch
+      void oneStepBatch (matrixOut_t configurations, vectorIn_t alpha,
+			 std::vector <bool>& success,
+			 std::size_t numberThreads = 1);
+
+      /// Estimate the curvature of the constraints along a direction
+      ///
+      /// \param configuration configuration,
+      /// \param direction unit velocity,
+      /// \param h step of the finite difference.
+      /// \return \f$\|J^{+}(J(q \oplus h v) - J(q)) v\| / h\f$, the norm
+      ///         of the second order correction the projection applies to
+      ///         \f$q \oplus s v\f$ is about this value times
+      ///         \f$s^2/2\f$.
+      value_type curvature (ConfigurationIn_t configuration,
+			    vectorIn_t direction, const value_type& h);
+
       /// Linearization of the system of equations
       /// rhs - v_{i} = J (q_i) (dq_{i+1} - q_{i})
       /// q_{i+1} - q_{i} = J(q_i)^{+} ( rhs - v_{i} )
@@ -222,6 +329,7 @@ namespace hpp {
       void maxIterations (size_type iterations)
       {
 	maxIterations_ = iterations;
+	modified ();
       }
       /// Get maximal number of iterations in config projector
       size_type maxIterations () const
@@ -229,10 +337,81 @@ namespace hpp {
 	return maxIterations_;
       }
 
+      /// Set method solving the linearized constraints
+      void linearSolver (LinearSolver solver)
+      {
+	linearSolver_ = solver;
+	modified ();
+      }
+      /// Get method solving the linearized constraints
+      LinearSolver linearSolver () const
+      {
+	return linearSolver_;
+      }
+
+      /// Set damping of damped least squares
+      /// \param damping \f$\lambda\f$, 1e-3 by default.
+      void damping (const value_type& damping)
+      {
+	squareDamping_ = damping * damping;
+	modified ();
+      }
+      /// Get damping of damped least squares
+      value_type damping () const
+      {
+	return sqrt (squareDamping_);
+      }
+
+      /// Set strategy choosing the length of Newton steps
+      /// \note FIXED_STEPS by default.
+      void stepStrategy (StepStrategy strategy)
+      {
+	stepStrategy_ = strategy;
+	modified ();
+      }
+      /// Get strategy choosing the length of Newton steps
+      StepStrategy stepStrategy () const
+      {
+	return stepStrategy_;
+      }
+
+      /// Enable or disable warm start
+      ///
+      /// When enabled, the correction (projected minus input configuration)
+      /// of the last successful projection is applied to the next input
+      /// configuration if both inputs are closer than
+      /// warmStartMaxDistance, and if it decreases the error. Consecutive
+      /// projections of configurations along a path then start close to
+      /// the solution.
+      /// \note disabled by default. The correction is forgotten when the
+      ///       right hand side or the constraints change.
+      void warmStart (bool enable)
+      {
+	warmStart_ = enable;
+	hasWarmStart_ = false;
+      }
+      /// Whether warm start is enabled
+      bool warmStart () const
+      {
+	return warmStart_;
+      }
+      /// Set maximal distance between consecutive inputs for warm start
+      /// \param distance norm of the velocity between inputs.
+      void warmStartMaxDistance (const value_type& distance)
+      {
+	warmStartMaxDistance_ = distance;
+      }
+      /// Get maximal distance between consecutive inputs for warm start
+      const value_type& warmStartMaxDistance () const
+      {
+	return warmStartMaxDistance_;
+      }
+
       /// Set error threshold
       void errorThreshold (const value_type& threshold)
       {
 	squareErrorThreshold_ = threshold * threshold;
+	modified ();
       }
       /// Get errorimal number of threshold in config projector
       value_type errorThreshold () const
@@ -278,6 +457,9 @@ namespace hpp {
       /// \note Class NumericalConstraint contains a cache for its own RHS.
       /// Its value is simply copied in the ConfigProjector RHS. This allow a
       /// finer control on the RHS.
+      /// \note Values of the locked joints are also copied: this method
+      ///       should be called after modifying the value of a locked joint
+      ///       directly.
       void updateRightHandSide ();
 
       /// @}
@@ -294,6 +476,12 @@ namespace hpp {
       ///         \li difference between locked joint value and right and side.
       virtual bool isSatisfied (ConfigurationIn_t config, vector_t& error);
 
+      /// Get estimate of the memory used by the solver and its workspaces
+      ///
+      /// Numerical constraints and locked joints, shared with the copies of
+      /// the projector, are not counted.
+      virtual std::size_t memoryUsage () const;
+
       /// Get the statistics
       ::hpp::statistics::SuccessStatistics& statistics()
       {
@@ -342,38 +530,171 @@ namespace hpp {
 
     private:
       typedef Eigen::JacobiSVD <matrix_t> SVD_t;
+      /// Decompositions used by the solvers other than SVD
+      struct Decompositions {
+        Eigen::LLT <matrix_t> llt_;
+        Eigen::ColPivHouseholderQR <matrix_t> qr_;
+        matrix_t JJt_;
+        vector_t y_;
+      };
       struct PriorityStack {
         std::size_t level_; // 0, 1, 2 or 3.
         std::size_t outputSize_, cols_;
         NumericalConstraints_t functions_;
         IntervalsContainer_t passiveDofs_;
         mutable SVD_t svd_;
+        Decompositions decompositions_;
         matrix_t PK_;
+        /// Buffers of computeIncrement: jacobian * projector, residual of
+        /// the level and increment in the projected space.
+        matrix_t JP_;
+        vector_t residual_;
+        vector_t dqLevel_;
+        /// Block of columns of the Jacobian of a function copied into the
+        /// reduced Jacobian
+        struct Block {
+          size_type col, reducedCol, cols;
+        };
+        typedef std::vector <Block> Blocks_t;
+        /// For each function, blocks of active columns that are neither
+        /// passive nor locked
+        std::vector <Blocks_t> blocks_;
+        /// Whether each function is compared by inequalities, the rows of
+        /// which are zeroed when they are inactive
+        std::vector <bool> inequalities_;
+        /// Rows of the level that are not inactive inequalities, at the
+        /// configuration of the last call to computeValueAndJacobian
+        std::vector <size_type> activeRows_;
+        /// Active rows of the Jacobian and of the error, reallocated only
+        /// when the number of active rows changes
+        matrix_t activeJacobian_;
+        vector_t activeError_;
         
         PriorityStack (std::size_t level, std::size_t cols);
+        /// Copy the definition of the level, not the workspaces
+        PriorityStack (const PriorityStack& other);
+        /// Allocate decompositions and buffers
+        void allocateWorkspaces ();
         void add (const NumericalConstraintPtr_t& numericalConstraint,
             const SizeIntervals_t& passiveDofs);
         void nbNonLockedDofs (const std::size_t nbNonLockedDofs);
+        /// Compute blocks_ and inequalities_ from the intervals of non
+        /// locked dofs
+        void computeBlocks (const SizeIntervals_t& intervals);
+        /// Write value and non zero blocks of reducedJacobian
+        /// \param computeValues whether functions should be evaluated.
+        ///        If false, the value of each numerical constraint should
+        ///        store the value of its function at cfg.
+        ///
+        /// Also update activeRows_.
         void computeValueAndJacobian (ConfigurationIn_t cfg,
-            const SizeIntervals_t& intervals,
-            vectorOut_t value, matrixOut_t reducedJacobian);
+            vectorOut_t value, matrixOut_t reducedJacobian,
+            bool computeValues);
         /// Return false if it is not possible solve this constraints.
+        ///
+        /// Rows of inactive inequalities are removed from the system
+        /// before it is factorized: they are zero and do not change the
+        /// increment.
         bool computeIncrement (vectorIn_t value, matrixIn_t jacobian,
-            vectorOut_t dq, matrixOut_t projector);
+            vectorOut_t dq, matrixOut_t projector, LinearSolver solver,
+            const value_type& squareDamping);
+        /// Implementation of computeIncrement for the active rows
+        bool solveLevel (vectorIn_t value, matrixIn_t jacobian,
+            vectorOut_t dq, matrixOut_t projector, LinearSolver solver,
+            const value_type& squareDamping);
       };
+      /// Solve jacobian dq = error with a given method
+      static void solve (LinearSolver solver, const value_type& squareDamping,
+          SVD_t& svd, Decompositions& decompositions, matrixIn_t jacobian,
+          vectorIn_t error, vectorOut_t dq);
       virtual std::ostream& print (std::ostream& os) const;
       virtual void addToConstraintSet (const ConstraintSetPtr_t& constraintSet);
+      /// Update structure after numerical constraints or locked joints were
+      /// added, unless beginUpdate was called.
+      /// \param lockedJointsChanged whether intervals of non locked degrees
+      ///        of freedom need to be recomputed.
+      void update (bool lockedJointsChanged);
+      /// Compute explicitOrder_ and explicitComputation_
+      ///
+      /// An explicit constraint is solved in closed form if its output is
+      /// neither locked nor output of another explicit constraint. It
+      /// depends on the explicit constraints the output degrees of freedom
+      /// of which are in its active columns. Explicit constraints are
+      /// solved in topological order of these dependencies, those that are
+      /// in a cycle are left to Newton iterations.
+      /// \sa NumericalConstraint::activeColumns
       void updateExplicitComputation ();
+      /// Solve explicit constraints of explicitOrder_
+      void solveExplicitConstraints (ConfigurationOut_t configuration);
       bool isSatisfiedNoLockedJoint (ConfigurationIn_t config);
       void resize ();
+      /// Allocate decompositions and buffers sized by resize
+      void allocateWorkspaces ();
+      /// Allocate workspaces if not done yet
+      void checkWorkspaces ()
+      {
+	if (!workspaces_) allocateWorkspaces ();
+      }
       void computeIntervals ();
+      /// Copy values of locked joints into lockedValues_
+      void updateLockedValues ();
       inline void computeError ();
+      /// Same as computeValueAndJacobian, but write only non zero blocks of
+      /// reducedJacobian, the other coefficients of which should be zero.
+      void assembleValueAndJacobian (ConfigurationIn_t configuration,
+				     vectorOut_t value,
+				     matrixOut_t reducedJacobian);
+      /// Squared norm of the error of the constraints that are not optional
+      value_type squaredError (vectorIn_t value) const;
+      /// Compute value of the constraints without the Jacobian
+      ///
+      /// Values of the functions are kept in the numerical constraints, so
+      /// that assembleValueAndJacobian at the same configuration does not
+      /// evaluate them again.
+      void computeValue (ConfigurationIn_t configuration, vectorOut_t value);
+      void computePrioritizedIncrement (vectorIn_t value,
+          matrixIn_t reducedJacobian, const value_type& alpha, vectorOut_t dq,
+          LinearSolver solver, const value_type& squareDamping);
+      /// Newton iterations of each step strategy
+      /// \retval iter number of iterations.
+      /// \return false if resolution stopped since the error did not
+      ///         decrease.
+      bool solveFixedSteps (ConfigurationOut_t configuration,
+			    size_type& iter);
+      bool solveLineSearch (ConfigurationOut_t configuration,
+			    size_type& iter);
+      bool solveLevenbergMarquardt (ConfigurationOut_t configuration,
+				    size_type& iter);
+      /// Apply correction of last projection if the input is close to the
+      /// previous one and if the error decreases.
+      /// \pre squareNorm_ is the error at configuration.
+      void applyWarmStart (ConfigurationOut_t configuration);
+      /// Implementation of applyBatch and oneStepBatch
+      /// \param alpha steps of one iteration, or null to project.
+      void projectBatch (matrixOut_t configurations, const vectorIn_t* alpha,
+			 std::vector <bool>& success,
+			 std::size_t numberThreads);
+      /// Copy right hand side, locked values and warm start settings into
+      /// a copy used by another thread
+      void synchronize (ConfigProjector& copy) const;
       DevicePtr_t robot_;
       std::vector <PriorityStack> stack_;
       NumericalConstraints_t functions_;
       std::vector <std::size_t> explicitFunctions_;
+      /// Indices in functions_ of the explicit constraints solved in closed
+      /// form before Newton iterations, in the order they are solved.
+      std::vector <std::size_t> explicitOrder_;
       IntervalsContainer_t passiveDofs_;
+      /// Sorted by rank
       LockedJoints_t lockedJoints_;
+      /// Intervals of locked configuration variables, consecutive locked
+      /// joints being merged
+      SizeIntervals_t lockedConfIntervals_;
+      /// Values of locked configuration variables, stacked in the order of
+      /// lockedConfIntervals_
+      vector_t lockedValues_;
+      /// Locked configuration variables of a configuration
+      vector_t lockedBuffer_;
       /// Intervals of non locked degrees of freedom
       SizeIntervals_t intervals_;
       value_type squareErrorThreshold_;
@@ -385,6 +706,26 @@ namespace hpp {
       /// Jacobian without locked degrees of freedom
       mutable matrix_t reducedJacobian_;
       mutable SVD_t svd_;
+      Decompositions decompositions_;
+      LinearSolver linearSolver_;
+      value_type squareDamping_;
+      StepStrategy stepStrategy_;
+      /// Configuration and value tested by line search and
+      /// Levenberg-Marquardt
+      Configuration_t qTrial_;
+      vector_t valueTrial_;
+      bool warmStart_;
+      value_type warmStartMaxDistance_;
+      /// Whether the input and correction of a successful projection are
+      /// stored.
+      bool hasWarmStart_;
+      Configuration_t warmStartInput_;
+      vector_t warmStartCorrection_;
+      /// Whether numerical constraints store the values of their functions
+      /// at valueConfiguration_. Only valid during a call to a public method,
+      /// since functions may change in between.
+      bool valueCached_;
+      Configuration_t valueConfiguration_;
       mutable matrix_t reducedProjector_;
       mutable vector_t toMinusFrom_;
       mutable vector_t toMinusFromSmall_;
@@ -392,11 +733,22 @@ namespace hpp {
       mutable vector_t projMinusFromSmall_;
       mutable vector_t dq_;
       mutable vector_t dqSmall_;
+      /// Buffers of computePrioritizedIncrement
+      mutable vector_t error_;
+      mutable matrix_t projector_;
       size_type nbNonLockedDofs_;
       size_type nbLockedDofs_;
       value_type squareNorm_;
+      /// Whether all the constraints are in explicitOrder_
       bool explicitComputation_;
+      /// Whether beginUpdate was called and commit was not
+      bool updating_;
+      /// Whether workspaces are allocated. Copies share the definition of
+      /// the constraints and allocate their workspaces when first used.
+      bool workspaces_;
       ConfigProjectorWkPtr_t weak_;
+      /// Threads and copies projecting batches, not copied
+      configProjector::BatchThreadsPtr_t batchThreads_;
 
       ::hpp::statistics::SuccessStatistics statistics_;
     }; // class ConfigProjector
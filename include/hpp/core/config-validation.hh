@@ -19,6 +19,7 @@
 #ifndef HPP_CORE_CONFIG_VALIDATION_HH
 # define HPP_CORE_CONFIG_VALIDATION_HH
 
+# include <vector>
 # include <hpp/core/validation-report.hh>
 # include <hpp/core/deprecated.hh>
 
@@ -67,6 +68,43 @@ namespace hpp {
       /// \return whether the whole config is valid.
       virtual bool validate (const Configuration_t& config,
 			     ValidationReportPtr_t& validationReport) = 0;
+
+      /// Compute whether the configuration is valid without report
+      ///
+      /// \param config the config to check for validity,
+      /// \return whether the whole config is valid.
+      /// Derived classes may reimplement this method for callers that do not
+      /// need a report.
+      virtual bool isValid (const Configuration_t& config)
+      {
+	ValidationReportPtr_t validationReport;
+	return validate (config, validationReport);
+      }
+
+      /// Compute whether several configurations are valid
+      ///
+      /// \param configurations configurations to check, one per column,
+      /// \retval valid whether each configuration is valid,
+      /// \param stopAtFirst if true, stop at the first invalid configuration:
+      ///        configurations after it are reported as invalid,
+      /// \return whether all configurations are valid.
+      /// The default implementation calls isValid for each configuration.
+      virtual bool validateBatch (const matrix_t& configurations,
+				  std::vector <bool>& valid, bool stopAtFirst)
+      {
+	valid.assign (configurations.cols (), false);
+	bool allValid = true;
+	Configuration_t q (configurations.rows ());
+	for (size_type i = 0; i < configurations.cols (); ++i) {
+	  q = configurations.col (i);
+	  valid [i] = isValid (q);
+	  if (!valid [i]) {
+	    allValid = false;
+	    if (stopAtFirst) break;
+	  }
+	}
+	return allValid;
+      }
       /// Add an obstacle
       /// \param object obstacle added
       /// \notice collision configuration validation needs to know about
@@ -86,6 +124,51 @@ namespace hpp {
 					   const CollisionObjectPtr_t&)
       {
       }
+
+      /// Remove an obstacle
+      /// \param object obstacle previously added by addObstacle.
+      /// This virtual method does nothing for configuration validation
+      /// methods that do not care about obstacles.
+      virtual void removeObstacle (const CollisionObjectPtr_t&)
+      {
+      }
+
+      /// Notify that an obstacle has moved
+      /// \param object obstacle previously added by addObstacle, the
+      ///        position of which has changed.
+      /// This virtual method does nothing for configuration validation
+      /// methods that do not care about obstacles.
+      virtual void obstacleMoved (const CollisionObjectPtr_t&)
+      {
+      }
+
+      /// Set distance field of the static obstacles
+      /// \param field field used to skip collision tests far from the
+      ///        obstacles, empty pointer to disable.
+      /// This virtual method does nothing for configuration validation
+      /// methods that do not care about obstacles.
+      virtual void distanceField (const DistanceFieldPtr_t&)
+      {
+      }
+
+      /// Create a copy validating configurations of another robot
+      /// \param robot copy of the robot the validation applies to.
+      /// \return new instance, or an empty pointer if this validation method
+      ///         cannot be copied.
+      /// \note obstacles are not copied.
+      virtual ConfigValidationPtr_t copy (const DevicePtr_t&) const
+      {
+	return ConfigValidationPtr_t ();
+      }
+
+      /// Estimated cost of the validation of one configuration
+      ///
+      /// The unit is the cost of one collision test between two objects.
+      /// Used by ConfigValidations to test cheap validations first.
+      virtual value_type cost () const
+      {
+	return 1;
+      }
     protected:
       ConfigValidation ()
       {
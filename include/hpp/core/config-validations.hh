@@ -58,6 +58,14 @@ namespace hpp {
       /// \return whether the whole config is valid.
       virtual bool validate (const Configuration_t& config,
 			     ValidationReportPtr_t& validationReport);
+      /// Compute whether the configuration is valid without report
+      virtual bool isValid (const Configuration_t& config);
+      /// Compute whether several configurations are valid
+      ///
+      /// Each validation processes the whole batch, see
+      /// ConfigValidation::validateBatch.
+      virtual bool validateBatch (const matrix_t& configurations,
+				  std::vector <bool>& valid, bool stopAtFirst);
       /// Add a configuration validation object
       void add (const ConfigValidationPtr_t& configValidation);
 
@@ -74,10 +82,102 @@ namespace hpp {
       /// validation methods that do not care about obstacles.
       virtual void removeObstacleFromJoint
 	(const JointPtr_t& joint, const CollisionObjectPtr_t& obstacle);
+
+      /// Remove an obstacle from each validation
+      virtual void removeObstacle (const CollisionObjectPtr_t& object);
+
+      /// Notify each validation that an obstacle has moved
+      virtual void obstacleMoved (const CollisionObjectPtr_t& object);
+
+      /// Set distance field of the static obstacles of each validation
+      virtual void distanceField (const DistanceFieldPtr_t& field);
+
+      /// Create a copy validating configurations of another robot
+      /// \param robot copy of the robot the validations apply to.
+      /// \return new instance containing a copy of each validation, or an
+      ///         empty pointer if one of them cannot be copied.
+      /// \note obstacles are not copied.
+      virtual ConfigValidationPtr_t copy (const DevicePtr_t& robot) const;
+
+      /// Sum of the costs of the validations
+      virtual value_type cost () const;
+
+      /// \name Adaptive ordering of validations
+      /// \{
+
+      /// Set whether validations that fail are tested first
+      ///
+      /// If true, a validation that rejects a configuration is moved to the
+      /// front of the list of validations. Disabled by default. Cost
+      /// ordering takes precedence if both are enabled.
+      void adaptiveOrdering (bool adaptive)
+      {
+	adaptiveOrdering_ = adaptive;
+      }
+      /// Get whether validations that fail are tested first
+      bool adaptiveOrdering () const
+      {
+	return adaptiveOrdering_;
+      }
+      /// Set whether validations are ordered by expected cost
+      ///
+      /// If true, validations are sorted every hundred configurations by
+      /// increasing ratio between their cost (see ConfigValidation::cost)
+      /// and the rate of configurations they rejected so far. For
+      /// independent validations, this order minimizes the expected cost of
+      /// validating a configuration. Enabled by default.
+      void costOrdering (bool costOrdering)
+      {
+	costOrdering_ = costOrdering;
+      }
+      /// Get whether validations are ordered by expected cost
+      bool costOrdering () const
+      {
+	return costOrdering_;
+      }
+      /// Get validations in the order they are tested
+      const std::vector <ConfigValidationPtr_t>& validations () const
+      {
+	return validations_;
+      }
+      /// Get number of configurations rejected by each validation
+      ///
+      /// Counts are given in the order of validations ().
+      const std::vector <std::size_t>& hitCounts () const
+      {
+	return hitCounts_;
+      }
+      /// Get number of configurations tested by each validation
+      ///
+      /// Counts are given in the order of validations ().
+      const std::vector <std::size_t>& testCounts () const
+      {
+	return testCounts_;
+      }
+      /// Reset number of configurations rejected and tested by each
+      /// validation
+      void resetHitCounts ()
+      {
+	hitCounts_.assign (hitCounts_.size (), 0);
+	testCounts_.assign (testCounts_.size (), 0);
+      }
+      /// \}
     protected:
       ConfigValidations ();
     private:
+      /// Record that validation of given rank rejected a configuration
+      void rejected (std::size_t rank);
+      /// Record that a configuration has been validated or rejected
+      void validated ();
+      /// Sort validations by increasing expected cost
+      void sortByExpectedCost ();
       std::vector <ConfigValidationPtr_t> validations_;
+      std::vector <std::size_t> hitCounts_;
+      std::vector <std::size_t> testCounts_;
+      bool adaptiveOrdering_;
+      bool costOrdering_;
+      /// Number of configurations validated since the last sort
+      std::size_t sinceSort_;
     }; // class ConfigValidation
     /// \}
   } // namespace core
@@ -36,6 +36,26 @@ namespace hpp {
     public:
       /// Shoot a random configuration
       virtual ConfigurationPtr_t shoot () const = 0;
+      /// Shoot several random configurations
+      /// \retval configurations matrix the columns of which are filled with
+      ///         random configurations. The number of columns is the number
+      ///         of configurations to shoot.
+      ///
+      /// The default implementation calls shoot () for each column. Derived
+      /// classes may reimplement it without allocating configurations.
+      virtual void shoot (matrixOut_t configurations) const
+      {
+	for (size_type i = 0; i < configurations.cols (); ++i) {
+	  configurations.col (i) = *shoot ();
+	}
+      }
+      /// Reset random number generator
+      ///
+      /// The default implementation does nothing, for shooters that do not
+      /// draw random numbers.
+      virtual void seed (unsigned int)
+      {
+      }
     protected:
       ConfigurationShooter ()
     {
@@ -44,9 +44,16 @@ namespace hpp {
       /// Merge two connected components.
       ///
       /// \param other connected component to merge into this one.
-      /// \note other will be empty after calling this method.
+      /// \note other will be empty after calling this method. Nodes of other
+      ///       are not updated, Node::connectedComponent follows merges.
       void merge (const ConnectedComponentPtr_t& other);
 
+      /// Get connected component this one has been merged into
+      ///
+      /// \return this connected component if it has not been merged.
+      /// Merges are followed with path compression.
+      ConnectedComponentPtr_t representative ();
+
       /// Add node in connected component
       /// \param node node to add.
       void addNode (const NodePtr_t& node)
@@ -64,8 +71,14 @@ namespace hpp {
 
       /// Whether this connected component can reach cc
       /// \param cc a connected component
+      /// Returns false without exploring the graph of connected components
+      /// if no sequence of edges, whatever their direction, links them.
       bool canReach (const ConnectedComponentPtr_t& cc);
 
+      /// Whether this connected component and cc are linked by edges
+      /// regardless of their direction
+      bool isLinkedTo (const ConnectedComponentPtr_t& cc);
+
       
       /// Whether this connected component can reach cc
       /// \param cc a connected component
@@ -88,23 +101,41 @@ namespace hpp {
       /// \}
     protected:
       /// Constructor
-      ConnectedComponent () : nodes_ (), explored_ (false), weak_ ()
+      ConnectedComponent () : nodes_ (), reachableFrom_ (), reachableTo_ (),
+	mergedInto_ (), linkedTo_ (), forwardMark_ (0), backwardMark_ (0),
+	lastMark_ (0), weak_ ()
 	  {
 	  }
       void init (const ConnectedComponentPtr_t& shPtr){
 	weak_ = shPtr;
       }
     private:
+      // Root of the union-find structure of connected components linked by
+      // edges regardless of their direction
+      ConnectedComponentPtr_t linkRoot ();
+      // Record that an edge links this connected component and cc
+      void link (const ConnectedComponentPtr_t& cc);
+      // Mark for a new search among the linked connected components
+      unsigned int newMark ();
+
       Nodes_t nodes_;
       // List of CCs from which this connected component can be reached
       ConnectedComponents_t reachableFrom_;
       // List of CCs that can be reached from this connected component
       ConnectedComponents_t reachableTo_;
-      // status variable to indicate whether or not CC has been visited
-      mutable bool explored_;
+      // Connected component this one has been merged into
+      ConnectedComponentPtr_t mergedInto_;
+      // Parent in union-find structure of linked connected components
+      ConnectedComponentPtr_t linkedTo_;
+      // Marks set when the CC is visited by a forward or backward search
+      unsigned int forwardMark_;
+      unsigned int backwardMark_;
+      // Mark of the last search among the connected components linked to
+      // this one, only meaningful for the root of the union-find structure,
+      // so that roadmaps do not share a counter.
+      unsigned int lastMark_;
       ConnectedComponentWkPtr_t weak_;
       friend class Roadmap;
-      friend void clean (ConnectedComponents_t& set);
     }; // class ConnectedComponent
   } //   namespace core
 } // namespace hpp
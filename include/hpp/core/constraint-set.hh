@@ -85,6 +85,9 @@ namespace hpp {
       /// \retval error concatenation of errors of each constraint.
       virtual bool isSatisfied (ConfigurationIn_t config, vector_t& error);
 
+      /// Get estimate of the memory used by the set and its constraints
+      virtual std::size_t memoryUsage () const;
+
       /// \name Compression of locked degrees of freedom
       ///
       /// Degrees of freedom related to locked joint are not taken into
@@ -47,6 +47,16 @@ namespace hpp {
 	return name_;
       }
 
+      /// Get identifier of the content of the constraint
+      ///
+      /// Copies keep the identifier of the constraint they copy. A new
+      /// identifier is drawn when the constraint is modified, so that caches
+      /// of projections recognize copies of the same constraints.
+      std::size_t revision () const
+      {
+	return revision_;
+      }
+
       /// Check whether a configuration statisfies the constraint.
       ///
       /// \param config the configuration to check
@@ -62,17 +72,29 @@ namespace hpp {
       /// return shared pointer to copy
       virtual ConstraintPtr_t copy () const = 0;
 
+      /// Get estimate of the memory used by the constraint in bytes
+      ///
+      /// Memory shared with the copies of the constraint, like the
+      /// numerical constraints of a ConfigProjector, is not counted. The
+      /// default implementation counts the members of this class: derived
+      /// classes that own buffers reimplement it.
+      virtual std::size_t memoryUsage () const;
+
     protected:
       /// User defined implementation of the constraint.
       virtual bool impl_compute (ConfigurationOut_t configuration) = 0;
       /// Constructor
-      Constraint (const std::string& name) : name_ (name), weak_ ()
+      Constraint (const std::string& name) : name_ (name), revision_ (0),
+	weak_ ()
 	{
+	  modified ();
 	}
       Constraint (const Constraint& constraint) : name_ (constraint.name_),
-	weak_ ()
+	revision_ (constraint.revision_), weak_ ()
 	{
 	}
+      /// Draw a new revision, to be called when the constraint is modified
+      void modified ();
       /// Store shared pointer to itself
       void init (const ConstraintPtr_t& self)
       {
@@ -87,6 +109,7 @@ namespace hpp {
       }
 
       std::string name_;
+      std::size_t revision_;
       ConstraintWkPtr_t weak_;
       friend class ConstraintSet;
       friend class LockedJoint;
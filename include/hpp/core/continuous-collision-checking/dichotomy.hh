@@ -27,7 +27,9 @@ namespace hpp {
     namespace continuousCollisionChecking {
       namespace dichotomy {
 	HPP_PREDEF_CLASS (BodyPairCollision);
+	HPP_PREDEF_CLASS (PathSample);
 	typedef boost::shared_ptr <BodyPairCollision> BodyPairCollisionPtr_t;
+	typedef boost::shared_ptr <PathSample> PathSamplePtr_t;
 	typedef std::list <BodyPairCollisionPtr_t> BodyPairCollisions_t;
       }
       using dichotomy::BodyPairCollisions_t;
@@ -38,8 +40,9 @@ namespace hpp {
       /// Continuous validation of a path for collision
       ///
       /// This class tests for collision
-      /// \li straight paths, or
-      /// \li concatenation of straight paths.
+      /// \li paths that provide bounds of their velocity (see
+      ///     Path::velocityBound), like straight and interpolated paths, or
+      /// \li concatenation of such paths.
       ///
       /// A path is valid if and only if each pair of objects to test is
       /// collision-free along the whole interval of definition. 
@@ -48,21 +51,30 @@ namespace hpp {
       /// collision-free is computed.
       ///
       /// First, each pair is tested at the beginning of the interval
-      /// (at the end if reverse is set to true). Then the pair that
-      /// has the smaller upper bound of the first valid sub-interval is
-      /// tested at the middle of the segment delimited by the upper bound
-      /// of the first valid sub-interval and by the lower bound of the second
-      /// valid sub-interval (or the end of the interval of definition if the
-      /// union of sub-intervals contains only one sub-interval).
+      /// (at the end if reverse is set to true). Then pairs that are not
+      /// valid on the whole interval are stored in a priority queue, the
+      /// pair with the smallest distance lower bound computed at its last
+      /// test coming first, since it is the most likely to collide. The
+      /// pair on top of the queue is tested at the middle of the segment
+      /// delimited by the upper bound of the first valid sub-interval and by
+      /// the lower bound of the second valid sub-interval (or the end of the
+      /// interval of definition if the union of sub-intervals contains only
+      /// one sub-interval), and is pushed back in the queue until it is valid
+      /// on the whole interval.
+      ///
+      /// If a collision is found, the valid part of the path is the interval
+      /// that starts at the beginning of the path and is valid for all pairs.
       ///
       /// Collision pairs between bodies of the robot are initialized at
       /// construction of the instance.
       ///
       /// Method Dichotomy::addObstacle adds an obstacle in the environment.
       /// This obstacle is added to the pair corresponding to each joint with
-      /// the environment.
+      /// the environment. Pairs with the environment are indexed by joint,
+      /// so that adding or removing an obstacle does not search the list of
+      /// pairs.
       ///
-      /// Validation of pairs along straight interpolations is based on the
+      /// Validation of pairs along paths is based on the
       /// computation of an upper-bound of the relative velocity of objects
       /// of one joint (or of the environment) in the reference frame of the
       /// other joint.
@@ -117,6 +129,15 @@ namespace hpp {
 			       PathPtr_t& validPart,
 			       PathValidationReportPtr_t& report);
 
+	/// Compute the largest valid intervals of several paths
+	///
+	/// If the number of threads is more than 1, paths are validated in
+	/// parallel by the copies validating the segments of path vectors.
+	/// See PathValidation::validateBatch.
+	virtual void validateBatch (const Paths_t& paths, bool reverse,
+				    bool stopAtValid, Paths_t& validParts,
+				    std::vector <bool>& valid);
+
 	/// Add an obstacle
 	/// \param object obstacle added
 	/// Add the object to each collision pair a body of which is the
@@ -133,6 +154,39 @@ namespace hpp {
 	virtual void removeObstacleFromJoint
 	  (const JointPtr_t& joint, const CollisionObjectPtr_t& obstacle);
 
+	/// Remove an obstacle from the pairs of each joint with the
+	/// environment
+	virtual void removeObstacle (const CollisionObjectPtr_t& object);
+
+	/// Forget the intervals proved collision-free for the pairs of joints
+	/// with the environment that contain an obstacle that has moved
+	virtual void obstacleMoved (const CollisionObjectPtr_t& object);
+
+	/// Create a copy validating paths of another robot
+	/// \param robot copy of the robot the validation applies to.
+	/// \note obstacles are not copied.
+	virtual PathValidationPtr_t copy (const DevicePtr_t& robot) const;
+
+	/// Set number of threads validating the segments of path vectors
+	/// and batches of paths
+	/// \param number number of threads, 1 by default.
+	///
+	/// Segments are validated by copies of this object with a clone of
+	/// the robot, built at the first call and after obstacles are
+	/// modified. Segments after the first invalid one are not validated.
+	/// Path vectors the segments of which are subject to constraints are
+	/// validated by the calling thread.
+	void numberThreads (std::size_t number)
+	{
+	  numberThreads_ = number;
+	  workers_.clear ();
+	}
+	/// Get number of threads validating the segments of path vectors
+	virtual std::size_t numberThreads () const
+	{
+	  return numberThreads_;
+	}
+
 	virtual ~Dichotomy ();
       protected:
 	/// Constructor
@@ -141,9 +195,32 @@ namespace hpp {
 	Dichotomy (const DevicePtr_t& robot,
 		   const value_type& tolerance);
       private:
+	/// Validate a path that is not a path vector
+	/// \retval parameter parameter of the configuration in collision if
+	///         the path is not valid,
+	/// \retval report pair of objects in collision if the path is not
+	///         valid.
+	bool validateElementaryPath (const PathPtr_t& path, bool reverse,
+				     PathPtr_t& validPart,
+				     value_type& parameter,
+				     CollisionValidationReport& report);
+	/// Create copies of this object validating segments in parallel
+	void createWorkers ();
+	/// Pair of a joint with the environment, for each joint
+	typedef std::map <JointConstPtr_t, BodyPairCollisions_t::iterator>
+	  ObstaclePairs_t;
 	DevicePtr_t robot_;
 	value_type tolerance_;
 	dichotomy::BodyPairCollisions_t bodyPairCollisions_;
+	ObstaclePairs_t obstaclePairs_;
+	/// Configuration and joint positions shared by the body pairs
+	dichotomy::PathSamplePtr_t sample_;
+	std::size_t numberThreads_;
+	/// Copies validating segments of path vectors, one per thread
+	std::vector <PathValidationPtr_t> workers_;
+	/// Report filled by the validation of elementary paths, copied into
+	/// the report of the caller if the path is not valid
+	CollisionValidationReport collisionReport_;
       /// This member is used by the validate method that does not take a
       /// validation report as input to call the validate method that expects
       /// a validation report as input. This is not fully satisfactory, but
@@ -29,6 +29,8 @@ namespace hpp {
 	HPP_PREDEF_CLASS (BodyPairCollision);
 	typedef boost::shared_ptr <BodyPairCollision> BodyPairCollisionPtr_t;
 	typedef std::list <BodyPairCollisionPtr_t> BodyPairCollisions_t;
+	HPP_PREDEF_CLASS (PairThreads);
+	typedef boost::shared_ptr <PairThreads> PairThreadsPtr_t;
       }
       /// \addtogroup validation
       /// \{
@@ -36,8 +38,9 @@ namespace hpp {
       /// Continuous validation of a path for collision
       ///
       /// This class tests for collision
-      /// \li straight paths, or
-      /// \li concatenation of straight paths.
+      /// \li paths that provide bounds of their velocity (see
+      ///     Path::velocityBound), like straight and interpolated paths, or
+      /// \li concatenation of such paths.
       ///
       /// A path is valid if and only if each pair of objects to test is
       /// collision-free along the whole interval of definition. 
@@ -57,9 +60,11 @@ namespace hpp {
       /// construction of the instance.
       ///
       /// Method Progressive::addObstacle adds an obstacle in the environment.
-      /// For each joint, a new pair is created with the new obstacle.
+      /// For each joint, a new pair is created with the new obstacle. Pairs
+      /// are indexed by joint and obstacle, so that removing an obstacle
+      /// does not search the list of pairs.
       ///
-      /// Validation of pairs along straight interpolations is based on the
+      /// Validation of pairs along paths is based on the
       /// computation of an upper-bound of the relative velocity of objects
       /// of one joint (or of the environment) in the reference frame of the
       /// other joint.
@@ -116,6 +121,15 @@ namespace hpp {
 	virtual bool validate (const PathPtr_t& path, bool reverse,
 			       PathPtr_t& validPart,
 			       PathValidationReportPtr_t& report);
+
+	/// Compute the largest valid intervals of several paths
+	///
+	/// If the number of threads is more than 1, paths are validated in
+	/// parallel by the copies validating the segments of path vectors.
+	/// See PathValidation::validateBatch.
+	virtual void validateBatch (const Paths_t& paths, bool reverse,
+				    bool stopAtValid, Paths_t& validParts,
+				    std::vector <bool>& valid);
 	/// Add an obstacle
 	/// \param object obstacle added
 	/// Add the object to each collision pair a body of which is the
@@ -132,6 +146,51 @@ namespace hpp {
 	virtual void removeObstacleFromJoint
 	  (const JointPtr_t& joint, const CollisionObjectPtr_t& obstacle);
 
+	/// Remove the pairs of the joints with an obstacle
+	virtual void removeObstacle (const CollisionObjectPtr_t& object);
+
+	/// Update the bounding box of an obstacle that has moved
+	///
+	/// The distance field is dropped if it contains the obstacle.
+	virtual void obstacleMoved (const CollisionObjectPtr_t& object);
+
+	/// Set distance field of the static obstacles
+	/// \param field field, empty pointer to disable.
+	///
+	/// Pairs of joints with obstacles contained in the field use the
+	/// field as distance lower bound, the narrow phase is called only
+	/// for objects close to the obstacles.
+	virtual void distanceField (const DistanceFieldPtr_t& field);
+
+	/// Create a copy validating paths of another robot
+	/// \param robot copy of the robot the validation applies to.
+	/// \note obstacles are not copied.
+	virtual PathValidationPtr_t copy (const DevicePtr_t& robot) const;
+
+	/// Set number of threads validating the body pairs
+	/// \param number number of threads, 1 by default.
+	///
+	/// Segments of path vectors are validated in parallel by copies of
+	/// this object with a clone of the robot, built at the first call and
+	/// after obstacles are modified. Segments after the first invalid one
+	/// are not validated. Other paths, and path vectors the segments of
+	/// which are subject to constraints, are validated by splitting pairs
+	/// at each configuration along the path in contiguous ranges
+	/// validated in parallel by threads created at the first call. Threads
+	/// stop as soon as one of them finds a collision. Paths of batches are
+	/// distributed to the copies.
+	void numberThreads (std::size_t number)
+	{
+	  numberThreads_ = number;
+	  workers_.clear ();
+	  pairThreads_.reset ();
+	}
+	/// Get number of threads validating the body pairs
+	virtual std::size_t numberThreads () const
+	{
+	  return numberThreads_;
+	}
+
 	virtual ~Progressive ();
       protected:
 	/// Constructor
@@ -147,9 +206,38 @@ namespace hpp {
 	bool validateConfiguration (const Configuration_t& config,
 				    bool reverse, value_type& tmin,
 				    PathValidationReportPtr_t& report);
+	/// Set configuration of the robot and compute forward kinematics
+	/// and bounding boxes of the objects of the robot.
+	void computeForwardKinematics (const Configuration_t& config);
+	/// Validate body pairs in parallel at the current configuration
+	bool validatePairs (const value_type& t, bool reverse,
+			    value_type& tmin, PathValidationReportPtr_t& report);
+	/// Validate a path that is not a path vector, report is either a
+	/// PathValidationReport or a PathValidationReportPtr_t.
+	template <typename Report> bool validateElementaryPath
+	  (const PathPtr_t& path, bool reverse, PathPtr_t& validPart,
+	   Report& report);
+	/// Create copies of this object validating segments in parallel
+	void createWorkers ();
+	/// Pair of a joint with an obstacle, for each joint and obstacle
+	typedef std::map <std::pair <JointConstPtr_t, CollisionObjectPtr_t>,
+			  progressive::BodyPairCollisions_t::iterator>
+	  ObstaclePairs_t;
 	DevicePtr_t robot_;
 	value_type tolerance_;
 	progressive::BodyPairCollisions_t bodyPairCollisions_;
+	ObstaclePairs_t obstaclePairs_;
+	/// Configuration along the path reused between samples
+	Configuration_t q_;
+	/// Objects of the robot the bounding boxes of which are updated
+	ObjectVector_t innerObjects_;
+	DistanceFieldPtr_t distanceField_;
+	std::size_t numberThreads_;
+	/// Copies validating segments of path vectors, one per thread
+	std::vector <PathValidationPtr_t> workers_;
+	/// Threads validating body pairs with the calling thread, kept
+	/// between configurations
+	progressive::PairThreadsPtr_t pairThreads_;
       value_type stepSize_;
       /// This member is used by the validate method that does not take a
       /// validation report as input to call the validate method that expects
@@ -19,14 +19,26 @@
 #ifndef HPP_CORE_DIFFUSING_PLANNER_HH
 # define HPP_CORE_DIFFUSING_PLANNER_HH
 
+# include <vector>
+# include <boost/random/mersenne_twister.hpp>
 # include <hpp/core/path-planner.hh>
 
 namespace hpp {
   namespace core {
+    namespace diffusingPlanner {
+      HPP_PREDEF_CLASS (ExtensionThreads);
+      typedef boost::shared_ptr <ExtensionThreads> ExtensionThreadsPtr_t;
+    } // namespace diffusingPlanner
     /// \addtogroup path_planning
     /// \{
 
     /// Generic implementation of RRT algorithm
+    ///
+    /// If problems have been added by PathPlanner::addThreadProblem,
+    /// connected components are extended by one thread per problem and the
+    /// results are inserted in the roadmap afterwards. The virtual method
+    /// extend is not called by worker threads. Worker threads are started
+    /// at the first step and kept until the problems change.
     class HPP_CORE_DLLAPI DiffusingPlanner : public PathPlanner
     {
     public:
@@ -39,6 +51,32 @@ namespace hpp {
       virtual void oneStep ();
       /// Set configuration shooter.
       void configurationShooter (const ConfigurationShooterPtr_t& shooter);
+      /// \name Sampling
+      /// \{
+
+      /// Set probability to extend toward a goal node instead of a random
+      /// configuration
+      /// \param probability value between 0 and 1, 0 by default.
+      void goalBias (value_type probability)
+      {
+	goalBias_ = probability;
+      }
+      /// Get probability to extend toward a goal node
+      value_type goalBias () const
+      {
+	return goalBias_;
+      }
+      /// Set number of random configurations shot at once
+      ///
+      /// Random configurations are shot by batches in a preallocated matrix
+      /// and consumed one per step.
+      void samplingBatchSize (size_type size);
+      /// Get number of random configurations shot at once
+      size_type samplingBatchSize () const
+      {
+	return samples_.cols ();
+      }
+      /// \}
     protected:
       /// Constructor
       DiffusingPlanner (const Problem& problem, const RoadmapPtr_t& roadmap);
@@ -46,15 +84,42 @@ namespace hpp {
       DiffusingPlanner (const Problem& problem);
       /// Store weak pointer to itself
       void init (const DiffusingPlannerWkPtr_t& weak);
+      /// Get configuration shooter.
+      const ConfigurationShooterPtr_t& configurationShooter () const
+      {
+	return configurationShooter_;
+      }
       /// Extend a node in the direction of a configuration
       /// \param near node in the roadmap,
       /// \param target target configuration
       virtual PathPtr_t extend (const NodePtr_t& near,
 				const ConfigurationPtr_t& target);
+      /// Get target of next extension
+      ///
+      /// Either a goal configuration with probability goalBias, or the next
+      /// random configuration of the current batch.
+      /// \note the returned configuration is overwritten by the next call.
+      const ConfigurationPtr_t& sample ();
     private:
+      struct Extension;
+      typedef std::vector <Extension> Extensions_t;
+      /// Extend nearest nodes in worker threads
+      void extendInParallel (const NearestNodes_t& nearestNodes,
+			     const ConfigurationPtr_t& target,
+			     Extensions_t& extensions) const;
       ConfigurationShooterPtr_t configurationShooter_;
+      value_type goalBias_;
+      /// Batch of random configurations, one per column
+      matrix_t samples_;
+      /// Rank of next column of samples_ to use
+      size_type nextSample_;
+      ConfigurationPtr_t q_rand_;
       mutable Configuration_t qProj_;
       DiffusingPlannerWkPtr_t weakPtr_;
+      /// Draws goal biased samples, seeded by the problem
+      boost::mt19937 generator_;
+      /// Threads extending nodes with the problems of threadProblems ()
+      mutable diffusingPlanner::ExtensionThreadsPtr_t extensionThreads_;
     };
     /// \}
   } // namespace core
@@ -19,6 +19,7 @@
 #ifndef HPP_CORE_DISCRETIZED_COLLISION_CHECKING
 # define HPP_CORE_DISCRETIZED_COLLISION_CHECKING
 
+# include <vector>
 # include <hpp/core/path-validation-report.hh>
 # include <hpp/core/path-validation.hh>
 
@@ -33,6 +34,15 @@ namespace hpp {
     class HPP_CORE_DLLAPI DiscretizedCollisionChecking : public PathValidation
     {
     public:
+      /// Order in which configurations along the path are validated
+      enum Order {
+	/// From the beginning of the path in the direction of validation
+	LINEAR,
+	/// Van der Corput order: the samples halve the interval between
+	/// samples already validated. Collisions in the middle of the path are
+	/// found earlier.
+	DICHOTOMY
+      };
       static DiscretizedCollisionCheckingPtr_t
       createWithValidation (const DevicePtr_t& robot, 
 				const value_type& stepSize,
@@ -81,6 +91,50 @@ namespace hpp {
       virtual bool validate (const PathPtr_t& path, bool reverse,
 			     PathPtr_t& validPart,
 			     PathValidationReportPtr_t& report);
+
+      /// Compute whether the whole path is valid
+      ///
+      /// Validation stops at the first invalid configuration found, in the
+      /// order defined by order ().
+      virtual bool isValid (const PathPtr_t& path);
+
+      /// Set order of validation of configurations along the path
+      ///
+      /// In DICHOTOMY order, validate still computes the largest valid part
+      /// of the path: configurations after an invalid one are not validated,
+      /// configurations before are.
+      /// Default is LINEAR.
+      void order (Order order)
+      {
+	order_ = order;
+      }
+      /// Get order of validation of configurations along the path
+      Order order () const
+      {
+	return order_;
+      }
+
+      /// Set whether the step adapts to the distance to collision
+      ///
+      /// If true, along paths that provide velocity bounds (see
+      /// Path::velocityBound), the step after a valid configuration
+      /// is the largest one along which no pair of objects can come in
+      /// contact. It is computed from the distance lower bounds of the pairs
+      /// and from upper bounds of the velocities of the bodies, bounded as
+      /// in continuousCollisionChecking::Progressive. The fixed step is used
+      /// if it is larger, close to obstacles.
+      /// Configurations are then validated in linear order. Other paths are
+      /// validated with the fixed step. Disabled by default.
+      void adaptiveStep (bool adaptive)
+      {
+	adaptiveStep_ = adaptive;
+      }
+      /// Get whether the step adapts to the distance to collision
+      bool adaptiveStep () const
+      {
+	return adaptiveStep_;
+      }
+
       /// Add an obstacle
       /// \param object obstacle added
       virtual void addObstacle (const CollisionObjectPtr_t&);
@@ -94,15 +148,101 @@ namespace hpp {
       virtual void removeObstacleFromJoint (const JointPtr_t& joint,
           const CollisionObjectPtr_t& obstacle);
 
+      /// Remove an obstacle from the configuration validation and the
+      /// distance pairs
+      virtual void removeObstacle (const CollisionObjectPtr_t& object);
+
+      /// Notify the configuration validation that an obstacle has moved
+      virtual void obstacleMoved (const CollisionObjectPtr_t& object);
+
+      /// Set distance field of the configuration validation
+      virtual void distanceField (const DistanceFieldPtr_t& field);
+
+      /// Create a copy validating paths of another robot
+      /// \param robot copy of the robot the validation applies to.
+      /// \note obstacles are not copied.
+      virtual PathValidationPtr_t copy (const DevicePtr_t& robot) const;
+
     protected:
       DiscretizedCollisionChecking (const DevicePtr_t& robot,
 				    const value_type& stepSize,
 				    const PathValidationReport& defaultValidationReport,
 				    const ConfigValidationPtr_t& configValidation);
     private:
+      typedef std::pair <JointConstPtr_t, value_type> CoefficientVelocity_t;
+      /// Body of the robot the velocity of which is bounded in adaptive step
+      struct MovingBody {
+	JointConstPtr_t joint;
+	/// Joints from the body joint to the root joint and coefficients
+	/// multiplying their velocity in the velocity bound of the body points
+	std::vector <CoefficientVelocity_t> coefficients;
+	/// Upper bound of the velocity of the body points along current path
+	value_type velocity;
+      }; // struct MovingBody
+      typedef std::vector <MovingBody> MovingBodies_t;
+      /// Pair of objects the distance of which bounds the adaptive step
+      struct DistancePair {
+	CollisionObjectPtr_t object1;
+	CollisionObjectPtr_t object2;
+	/// Index of bodies in movingBodies_, body2 is out of range for
+	/// obstacles.
+	std::size_t body1;
+	std::size_t body2;
+      }; // struct DistancePair
+      typedef std::vector <DistancePair> DistancePairs_t;
+      /// Compute the parameters of the configurations to validate
+      /// \retval params parameters ordered in the direction of validation,
+      ///         the last one being the end of the path.
+      void parameters (const PathPtr_t& path, bool reverse,
+		       std::vector <value_type>& params) const;
+      /// Find first invalid configuration along the path
+      /// \param reverse whether path is validated from the end,
+      /// \param stopAtFirst if true, return the first invalid configuration
+      ///        found in the order of validation, that may not be the first
+      ///        one along the path.
+      /// \retval params parameters of the configurations to validate, in
+      ///         the direction of validation,
+      /// \retval q invalid configuration, if any and if it could be computed,
+      /// \retval evaluated whether q could be computed.
+      /// \return index of invalid configuration in params, params.size () if
+      ///         none.
+      std::size_t findInvalid (const PathPtr_t& path, bool reverse,
+			       bool stopAtFirst,
+			       std::vector <value_type>& params,
+			       Configuration_t& q, bool& evaluated);
+      /// Compute velocity bounds of moving bodies along a path
+      /// \return whether the path provides velocity bounds.
+      bool computeVelocities (const PathPtr_t& path);
+      /// Find first invalid configuration with adaptive step
+      /// \pre computeVelocities has been called with the path.
+      /// \sa findInvalid
+      std::size_t findInvalidAdaptive (const PathPtr_t& path,
+				       bool reverse,
+				       std::vector <value_type>& params,
+				       Configuration_t& q, bool& evaluated);
+      /// Largest step along which pairs cannot collide from configuration
+      value_type safeStep (const Configuration_t& config);
+      /// Get index of body in movingBodies_, insert it if needed
+      std::size_t movingBody (const JointConstPtr_t& joint);
+      /// Create distance pairs between the body of a joint and an obstacle
+      void addDistancePairs (const CollisionObjectPtr_t& object,
+			     const JointConstPtr_t& joint);
       DevicePtr_t robot_;
       ConfigValidationPtr_t configValidation_;
       value_type stepSize_;
+      Order order_;
+      /// Indices of configurations in van der Corput order
+      std::vector <std::size_t> indices_;
+      /// Buffers reused between calls
+      std::vector <value_type> params_;
+      matrix_t configurations_;
+      std::vector <bool> computed_;
+      Configuration_t invalidConfig_;
+      Configuration_t q_;
+      bool adaptiveStep_;
+      MovingBodies_t movingBodies_;
+      DistancePairs_t distancePairs_;
+      vector_t velocityBound_;
       /// This member is used by the validate method that does not take a
       /// validation report as input to call the validate method that expects
       /// a validation report as input. This is not fully satisfactory, but
@@ -19,6 +19,7 @@
 #ifndef HPP_CORE_DISTANCE_BETWEEN_OBJECTS_HH
 # define HPP_CORE_DISTANCE_BETWEEN_OBJECTS_HH
 
+# include <limits>
 # include <hpp/core/fwd.hh>
 
 namespace hpp {
@@ -32,6 +33,10 @@ namespace hpp {
       /// \param object obstacle to add
       /// Create distance computation pairs for each body of the robot
       void addObstacle (const CollisionObjectPtr_t& object);
+      /// Remove the distance computation pairs of an obstacle
+      void removeObstacle (const CollisionObjectPtr_t& object);
+      /// Update the bounding box of an obstacle that has moved
+      void obstacleMoved (const CollisionObjectPtr_t& object);
       /// Add a list of obstacles
       void obstacles (const ObjectVector_t& obstacles);
       /// Compute distances between pairs of objects stored in bodies
@@ -39,13 +44,52 @@ namespace hpp {
       /// Get result of distance computations
       const DistanceResults_t&
 	distanceResults () const {return distanceResults_;};
+
+      /// Set number of threads used by computeDistances
+      /// \param number number of threads, 1 by default.
+      ///
+      /// Pairs are split in contiguous ranges computed in parallel.
+      void numberThreads (std::size_t number)
+      {
+	numberThreads_ = number;
+      }
+      /// Get number of threads used by computeDistances
+      std::size_t numberThreads () const
+      {
+	return numberThreads_;
+      }
+      /// Set distance above which distances are not computed exactly
+      /// \param threshold distance threshold, infinity by default.
+      ///
+      /// For pairs the bounding boxes of which are farther than the
+      /// threshold, computeDistances only sets min_distance to the distance
+      /// between the bounding boxes, that is a lower bound of the distance
+      /// between the objects, and does not compute nearest points.
+      /// \note obstacleMoved should be called after an obstacle has moved.
+      void distanceThreshold (value_type threshold)
+      {
+	distanceThreshold_ = threshold;
+      }
+      /// Get distance above which distances are not computed exactly
+      value_type distanceThreshold () const
+      {
+	return distanceThreshold_;
+      }
       /// \}
 
 
     private:
+      /// Compute distances of pairs of rank in [begin, end)
+      void computeDistances (std::size_t begin, std::size_t end);
       DevicePtr_t robot_;
-      CollisionPairs_t collisionPairs_;
+      /// Pairs of objects, stored objects are kept alive by distanceResults_
+      FclCollisionPairs_t collisionPairs_;
       DistanceResults_t distanceResults_;
+      /// Inner objects of the robot, the bounding boxes of which are updated
+      /// if distanceThreshold is finite.
+      std::vector <fcl::CollisionObject*> innerObjects_;
+      std::size_t numberThreads_;
+      value_type distanceThreshold_;
     };
   } // namespace core
 } // namespace hpp
@@ -0,0 +1,110 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_DISTANCE_FIELD_HH
+# define HPP_CORE_DISTANCE_FIELD_HH
+
+# include <set>
+# include <vector>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+
+namespace fcl {
+  class AABB;
+  class CollisionObject;
+} // namespace fcl
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup validation
+    /// \{
+
+    /// Lower bounds of the distance to static obstacles on a voxel grid
+    ///
+    /// The grid covers the bounding box of the obstacles, enlarged by a
+    /// margin. Each voxel stores a lower bound of the distance between the
+    /// points of the voxel and the obstacles, computed once by the narrow
+    /// phase between the obstacles and the sphere circumscribed to the
+    /// voxel. Voxels the sphere of which touches an obstacle store 0.
+    ///
+    /// Collision validations use the field as a conservative pre-check:
+    /// objects of the robot the bounding box of which only covers voxels
+    /// of positive value are not tested against the obstacles. The
+    /// narrow phase is thus only called near the surface of the obstacles.
+    ///
+    /// Values inside the obstacles are not signed: the field only proves
+    /// the absence of collision. The field is only read after
+    /// construction and can be shared between threads.
+    class HPP_CORE_DLLAPI DistanceField
+    {
+    public:
+      /// Create a field and compute its values
+      /// \param obstacles obstacles, which should not move afterwards,
+      /// \param resolution length of the edges of the voxels.
+      /// \throw std::invalid_argument if resolution is not positive, or if
+      ///        the grid would contain more than 2^24 voxels.
+      static DistanceFieldPtr_t create (const ObjectVector_t& obstacles,
+					value_type resolution);
+
+      /// Get lower bound of the distance between a box and the obstacles
+      /// \return 0 if the box may touch an obstacle, infinity if there is
+      ///         no obstacle.
+      value_type lowerBound (const fcl::AABB& box) const;
+
+      /// Whether an obstacle is taken into account by the field
+      bool contains (const CollisionObjectPtr_t& object) const;
+      /// Get obstacles the field is computed from
+      const ObjectVector_t& obstacles () const
+      {
+	return obstacles_;
+      }
+      /// Get length of the edges of the voxels
+      value_type resolution () const
+      {
+	return resolution_;
+      }
+
+    protected:
+      DistanceField (const ObjectVector_t& obstacles, value_type resolution);
+
+    private:
+      /// Compute the grid and the values of the voxels
+      void compute ();
+      /// Rank of the voxel containing a coordinate along an axis, clamped
+      /// to the grid
+      size_type voxel (std::size_t axis, value_type coordinate) const;
+
+      ObjectVector_t obstacles_;
+      std::set <const fcl::CollisionObject*> fclObstacles_;
+      value_type resolution_;
+      /// Bounding box of the obstacles
+      value_type lower_ [3], upper_ [3];
+      /// Lower corner and number of voxels of the grid along each axis
+      value_type origin_ [3];
+      size_type size_ [3];
+      /// Distance from the bounding box of the obstacles to the outside of
+      /// the grid
+      value_type margin_;
+      /// Values of the voxels, x varying first
+      std::vector <value_type> values_;
+    }; // class DistanceField
+    /// \}
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_DISTANCE_FIELD_HH
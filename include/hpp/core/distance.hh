@@ -37,6 +37,41 @@ namespace hpp {
 	return impl_distance (q1, q2);
       }
 
+      /// Compute distances between a configuration and several others
+      /// \param q configuration,
+      /// \param configurations matrix the columns of which are
+      ///        configurations,
+      /// \retval result distance between q and each column of
+      ///         configurations, of size configurations.cols ().
+      ///
+      /// Default implementation evaluates each distance separately. Derived
+      /// classes may reimplement it to process configurations in batch.
+      virtual void distances (ConfigurationIn_t q, matrixIn_t configurations,
+			      vectorOut_t result) const
+      {
+	assert (result.size () == configurations.cols ());
+	for (size_type i=0; i < configurations.cols (); ++i) {
+	  result [i] = (*this) (q, configurations.col (i));
+	}
+      }
+
+      /// Compute distance between two configurations up to a bound
+      /// \param q1, q2 configurations,
+      /// \param bound distance above which the exact value is not needed.
+      /// \return the distance if it is not greater than bound, otherwise a
+      ///         lower bound of the distance greater than bound.
+      ///
+      /// Default implementation computes the distance. Derived classes may
+      /// stop the computation as soon as the bound is exceeded, so that
+      /// nearest neighbor searches reject far candidates early.
+      virtual value_type boundedDistance (ConfigurationIn_t q1,
+					  ConfigurationIn_t q2,
+					  value_type bound) const
+      {
+	(void) bound;
+	return (*this) (q1, q2);
+      }
+
       virtual DistancePtr_t clone () const = 0;
       
     protected:
@@ -21,6 +21,7 @@
 
 # include <hpp/core/config.hh>
 # include <hpp/core/fwd.hh>
+# include <hpp/core/path.hh>
 
 namespace hpp {
   namespace core {
@@ -31,11 +32,26 @@ namespace hpp {
     ///
     /// Links two nodes and stores a path linking the configurations stored in
     /// the nodes the edge links.
+    ///
+    /// The path may be computed on first access by a steering method, so
+    /// that edges of a loaded roadmap only store their nodes and length
+    /// until a query uses them.
     class HPP_CORE_DLLAPI Edge
     {
     public:
       Edge (NodePtr_t n1, NodePtr_t n2, const PathPtr_t& path) :
-	n1_ (n1), n2_ (n2), path_ (path)
+	n1_ (n1), n2_ (n2), path_ (path), length_ (path->length ()),
+	steeringMethod_ (), costFunction_ (), cost_ (0)
+      {
+      }
+      /// Constructor of an edge the path of which is computed on first access
+      /// \param steeringMethod steering method that computes the path
+      ///        between the configurations of the nodes,
+      /// \param length length of the path.
+      Edge (NodePtr_t n1, NodePtr_t n2,
+	    const SteeringMethodPtr_t& steeringMethod, value_type length) :
+	n1_ (n1), n2_ (n2), path_ (), length_ (length),
+	steeringMethod_ (steeringMethod), costFunction_ (), cost_ (0)
       {
       }
       NodePtr_t from () const
@@ -46,14 +62,45 @@ namespace hpp {
       {
 	return n2_;
       }
+      /// Get path of the edge
+      ///
+      /// If the path has not been computed yet, it is computed by the
+      /// steering method given at construction.
+      /// \return the path, or an empty pointer if the steering method failed.
       PathPtr_t path () const
       {
+	if (!path_ && steeringMethod_) computePath ();
 	return path_;
       }
+      /// Whether the path has already been computed
+      bool hasPath () const
+      {
+	return path_.get () != 0x0;
+      }
+      /// Get length of the path, computed at construction
+      value_type length () const
+      {
+	return length_;
+      }
+      /// Get cost of the path
+      ///
+      /// The cost is computed on first call and cached for the last cost
+      /// function given, so that searches in a roadmap evaluate each edge
+      /// once. The path is computed if needed.
+      /// \return infinity if the path cannot be computed.
+      value_type cost (const PathCostPtr_t& cost) const;
     private:
+      void computePath () const;
+
       NodePtr_t n1_;
       NodePtr_t n2_;
-      PathPtr_t path_;
+      mutable PathPtr_t path_;
+      value_type length_;
+      /// Steering method computing path_ on first access, reset afterwards
+      mutable SteeringMethodPtr_t steeringMethod_;
+      /// Cost function of cost_
+      mutable PathCostWkPtr_t costFunction_;
+      mutable value_type cost_;
     }; // class Edge
     /// \}
   } // namespace core
@@ -99,6 +99,13 @@ namespace hpp {
     public:
       /// Copy object and return shared pointer to copy
       virtual EquationPtr_t copy () const;
+      /// Copy object for another robot and return shared pointer to copy
+      ///
+      /// If the constraint was created with a robot, the function builder
+      /// builds the relation between input and output configuration
+      /// variables, otherwise it builds the implicit function.
+      /// \sa NumericalConstraint::copy (const DevicePtr_t&)
+      virtual NumericalConstraintPtr_t copy (const DevicePtr_t& robot) const;
       /// Create instance and return shared pointer
       ///
       /// function relation between input configuration variables and output
@@ -137,6 +144,11 @@ namespace hpp {
       ///
       /// Compute output with respect to input.
       /// \param configuration input and output configuration
+      /// \note ConfigProjector solves several explicit constraints in closed
+      ///       form if none of them depends on itself through the outputs of
+      ///       the others. Since the input of the function is made of all the
+      ///       configuration variables that are not output, dependencies
+      ///       should be restricted by NumericalConstraint::activeColumns.
       virtual void solve (ConfigurationOut_t configuration);
 
       /// Get output configuration variables
@@ -23,13 +23,20 @@
 # include <vector>
 # include <deque>
 # include <list>
+# include <map>
 # include <set>
 # include <hpp/util/pointer.hh>
 # include <hpp/constraints/fwd.hh>
 
+namespace fcl {
+  class CollisionObject;
+} // namespace fcl
+
 namespace hpp {
   namespace core {
     HPP_PREDEF_CLASS (BasicConfigurationShooter);
+    HPP_PREDEF_CLASS (CachedPathValidation);
+    HPP_PREDEF_CLASS (CancellationToken);
     HPP_PREDEF_CLASS (CollisionPathValidation);
     struct CollisionPathValidationReport;
     HPP_PREDEF_CLASS (CollisionValidation);
@@ -44,6 +51,7 @@ namespace hpp {
     HPP_PREDEF_CLASS (DiffusingPlanner);
     HPP_PREDEF_CLASS (Distance);
     HPP_PREDEF_CLASS (DistanceBetweenObjects);
+    HPP_PREDEF_CLASS (DistanceField);
     HPP_PREDEF_CLASS (DiscretizedCollisionChecking);
     HPP_PREDEF_CLASS (Equation);
     HPP_PREDEF_CLASS (ExplicitNumericalConstraint);
@@ -52,10 +60,18 @@ namespace hpp {
     HPP_PREDEF_CLASS (LockedJoint);
     class Edge;
     HPP_PREDEF_CLASS (ExtractedPath);
+    HPP_PREDEF_CLASS (HaltonConfigurationShooter);
     HPP_PREDEF_CLASS (JointBoundValidation);
     struct JointBoundValidationReport;
+    HPP_PREDEF_CLASS (LazyPrmPlanner);
     class Node;
     HPP_PREDEF_CLASS (Path);
+    HPP_PREDEF_CLASS (PathCost);
+    HPP_PREDEF_CLASS (ClearanceCost);
+    HPP_PREDEF_CLASS (EnergyCost);
+    HPP_PREDEF_CLASS (LengthCost);
+    HPP_PREDEF_CLASS (TimeCost);
+    HPP_PREDEF_CLASS (ObstacleScene);
     HPP_PREDEF_CLASS (PathOptimizer);
     HPP_PREDEF_CLASS (PathPlanner);
     HPP_PREDEF_CLASS (PathVector);
@@ -63,14 +79,23 @@ namespace hpp {
     struct PathValidationReport;
     HPP_PREDEF_CLASS (PathValidation);
     HPP_PREDEF_CLASS (PlanAndOptimize);
+    HPP_PREDEF_CLASS (PortfolioPlanner);
     HPP_PREDEF_CLASS (Problem);
     class ProblemSolver;
     HPP_PREDEF_CLASS (RandomShortcut);
     HPP_PREDEF_CLASS (Roadmap);
+    HPP_PREDEF_CLASS (RrtConnectPlanner);
+    HPP_PREDEF_CLASS (RrtStarPlanner);
+    HPP_PREDEF_CLASS (SeededConfigurationShooter);
+    HPP_PREDEF_CLASS (SolveFuture);
+    HPP_PREDEF_CLASS (SolverPool);
     HPP_PREDEF_CLASS (SteeringMethod);
     HPP_PREDEF_CLASS (SteeringMethodStraight);
     HPP_PREDEF_CLASS (StraightPath);
+    HPP_PREDEF_CLASS (SweptVolume);
     HPP_PREDEF_CLASS (InterpolatedPath);
+    HPP_PREDEF_CLASS (InterpolationPlan);
+    HPP_PREDEF_CLASS (TimeParameterizedPath);
     HPP_PREDEF_CLASS (ValidationReport);
     HPP_PREDEF_CLASS (VisibilityPrmPlanner);
     HPP_PREDEF_CLASS (WeighedDistance);
@@ -89,6 +114,9 @@ namespace hpp {
 
     typedef boost::shared_ptr < BasicConfigurationShooter >
     BasicConfigurationShooterPtr_t;
+    typedef boost::shared_ptr <CachedPathValidation>
+    CachedPathValidationPtr_t;
+    typedef boost::shared_ptr <CancellationToken> CancellationTokenPtr_t;
     typedef hpp::model::Body Body;
     typedef hpp::model::BodyPtr_t BodyPtr_t;
     typedef boost::shared_ptr <CollisionPathValidationReport>
@@ -130,6 +158,7 @@ namespace hpp {
     typedef boost::shared_ptr <Distance> DistancePtr_t;
     typedef boost::shared_ptr <DistanceBetweenObjects>
     DistanceBetweenObjectsPtr_t;
+    typedef boost::shared_ptr <DistanceField> DistanceFieldPtr_t;
     typedef model::DistanceResult DistanceResult;
     typedef model::DistanceResults_t DistanceResults_t;
     typedef Edge* EdgePtr_t;
@@ -139,6 +168,8 @@ namespace hpp {
     typedef boost::shared_ptr <ExplicitRelativeTransformation>
     ExplicitRelativeTransformationPtr_t;
     typedef boost::shared_ptr <ExtractedPath> ExtractedPathPtr_t;
+    typedef boost::shared_ptr <HaltonConfigurationShooter>
+    HaltonConfigurationShooterPtr_t;
     typedef model::JointJacobian_t JointJacobian_t;
     typedef model::Joint Joint;
     typedef model::JointConstPtr_t JointConstPtr_t;
@@ -149,11 +180,12 @@ namespace hpp {
     typedef model::HalfJointJacobian_t HalfJointJacobian_t;
     typedef model::JointVector_t JointVector_t;
     typedef KDTree* KDTreePtr_t;
+    typedef boost::shared_ptr <LazyPrmPlanner> LazyPrmPlannerPtr_t;
     typedef boost::shared_ptr <LockedJoint> LockedJointPtr_t;
     typedef boost::shared_ptr <Equation> EquationPtr_t;
     typedef boost::shared_ptr <const LockedJoint> LockedJointConstPtr_t;
     typedef boost::shared_ptr <NumericalConstraint> NumericalConstraintPtr_t;
-    typedef std::list <LockedJointPtr_t> LockedJoints_t;
+    typedef std::vector <LockedJointPtr_t> LockedJoints_t;
     typedef model::matrix_t matrix_t;
     typedef constraints::matrixIn_t matrixIn_t;
     typedef constraints::matrixOut_t matrixOut_t;
@@ -168,7 +200,13 @@ namespace hpp {
     typedef Node* NodePtr_t;
     typedef model::ObjectVector_t ObjectVector_t;
     typedef boost::shared_ptr <Path> PathPtr_t;
+    typedef boost::shared_ptr <PathCost> PathCostPtr_t;
+    typedef boost::shared_ptr <ClearanceCost> ClearanceCostPtr_t;
+    typedef boost::shared_ptr <EnergyCost> EnergyCostPtr_t;
+    typedef boost::shared_ptr <LengthCost> LengthCostPtr_t;
+    typedef boost::shared_ptr <TimeCost> TimeCostPtr_t;
     typedef boost::shared_ptr <const Path> PathConstPtr_t;
+    typedef boost::shared_ptr <ObstacleScene> ObstacleScenePtr_t;
     typedef boost::shared_ptr <PathOptimizer> PathOptimizerPtr_t;
     typedef boost::shared_ptr <PathPlanner> PathPlannerPtr_t;
     typedef boost::shared_ptr <PathValidation> PathValidationPtr_t;
@@ -176,14 +214,25 @@ namespace hpp {
     typedef boost::shared_ptr <PathVector> PathVectorPtr_t;
     typedef boost::shared_ptr <const PathVector> PathVectorConstPtr_t;
     typedef boost::shared_ptr <PlanAndOptimize> PlanAndOptimizePtr_t;
+    typedef boost::shared_ptr <PortfolioPlanner> PortfolioPlannerPtr_t;
     typedef Problem* ProblemPtr_t;
     typedef ProblemSolver* ProblemSolverPtr_t;
     typedef boost::shared_ptr <RandomShortcut> RandomShortcutPtr_t;
     typedef boost::shared_ptr <Roadmap> RoadmapPtr_t;
+    typedef boost::shared_ptr <RrtConnectPlanner> RrtConnectPlannerPtr_t;
+    typedef boost::shared_ptr <RrtStarPlanner> RrtStarPlannerPtr_t;
+    typedef boost::shared_ptr <SeededConfigurationShooter>
+    SeededConfigurationShooterPtr_t;
+    typedef boost::shared_ptr <SolveFuture> SolveFuturePtr_t;
+    typedef boost::shared_ptr <SolverPool> SolverPoolPtr_t;
     typedef boost::shared_ptr <StraightPath> StraightPathPtr_t;
     typedef boost::shared_ptr <const StraightPath> StraightPathConstPtr_t;
+    typedef boost::shared_ptr <SweptVolume> SweptVolumePtr_t;
     typedef boost::shared_ptr <InterpolatedPath> InterpolatedPathPtr_t;
     typedef boost::shared_ptr <const InterpolatedPath> InterpolatedPathConstPtr_t;
+    typedef boost::shared_ptr <const InterpolationPlan> InterpolationPlanPtr_t;
+    typedef boost::shared_ptr <TimeParameterizedPath>
+    TimeParameterizedPathPtr_t;
     typedef boost::shared_ptr <SteeringMethod> SteeringMethodPtr_t;
     typedef boost::shared_ptr <SteeringMethodStraight>
     SteeringMethodStraightPtr_t;
@@ -212,6 +261,12 @@ namespace hpp {
     typedef std::pair <CollisionObjectPtr_t, CollisionObjectPtr_t>
     CollisionPair_t;
     typedef std::list <CollisionPair_t> CollisionPairs_t;
+    /// Pair of fcl objects used in loops over collision pairs
+    ///
+    /// The corresponding CollisionObjectPtr_t should be kept alive elsewhere.
+    typedef std::pair <const fcl::CollisionObject*,
+		       const fcl::CollisionObject*> FclCollisionPair_t;
+    typedef std::vector <FclCollisionPair_t> FclCollisionPairs_t;
 
     namespace continuousCollisionChecking {
       HPP_PREDEF_CLASS (Dichotomy);
@@ -222,6 +277,10 @@ namespace hpp {
 
     class NearestNeighbor;
     typedef NearestNeighbor* NearestNeighborPtr_t;
+    typedef std::pair <NodePtr_t, value_type> NodeAndDistance_t;
+    typedef std::pair <ConnectedComponentPtr_t, NodeAndDistance_t>
+    NearestNode_t;
+    typedef std::vector <NearestNode_t> NearestNodes_t;
     namespace nearestNeighbor {
       class Basic;
       class KDTree;
@@ -241,10 +300,17 @@ namespace hpp {
       HPP_PREDEF_CLASS (ConfigOptimization);
       typedef boost::shared_ptr <ConfigOptimization>
         ConfigOptimizationPtr_t;
+      HPP_PREDEF_CLASS (SplineSmoothing);
+      typedef boost::shared_ptr <SplineSmoothing> SplineSmoothingPtr_t;
+      HPP_PREDEF_CLASS (TimeParameterization);
+      typedef boost::shared_ptr <TimeParameterization>
+        TimeParameterizationPtr_t;
     } // namespace pathOptimization
 
     HPP_PREDEF_CLASS (PathProjector);
     typedef boost::shared_ptr <PathProjector> PathProjectorPtr_t;
+    HPP_PREDEF_CLASS (ProjectedSteering);
+    typedef boost::shared_ptr <ProjectedSteering> ProjectedSteeringPtr_t;
     namespace pathProjector {
       HPP_PREDEF_CLASS (Global);
       typedef boost::shared_ptr <Global> GlobalPtr_t;
@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_HALTON_CONFIGURATION_SHOOTER_HH
+# define HPP_CORE_HALTON_CONFIGURATION_SHOOTER_HH
+
+# include <vector>
+# include <boost/cstdint.hpp>
+# include <boost/thread/mutex.hpp>
+# include <hpp/core/configuration-shooter.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup configuration_sampling
+    /// \{
+
+    /// Sample configurations along a Halton sequence
+    ///
+    /// The Halton sequence is a deterministic low-discrepancy sequence:
+    /// the first n samples cover the configuration space more evenly than n
+    /// random samples. Each uniform variable of the configuration is the
+    /// radical inverse of the index of the sample in a different prime
+    /// base. Unbounded rotations are sampled as angles in [-pi, pi], SO(3)
+    /// joints as unit quaternions by the method of Shoemake using three
+    /// variables of the sequence.
+    ///
+    /// The index of the next sample is protected by a mutex, so that
+    /// threads can share an instance: the samples shot by all threads are
+    /// then the first elements of the sequence. For reproducible sequences
+    /// in each thread, give each thread its own stream built with
+    /// leapfrog (). Shooting does not allocate memory except for the
+    /// configuration returned by shoot ().
+    ///
+    /// \note the kinematic chain of the robot should not change after
+    ///       construction.
+    class HPP_CORE_DLLAPI HaltonConfigurationShooter :
+      public ConfigurationShooter
+    {
+    public:
+      /// Create instance and return shared pointer
+      /// \param robot the robot the configurations of which are sampled.
+      static HaltonConfigurationShooterPtr_t create (const DevicePtr_t& robot);
+      /// Create a stream of samples of the sequence of this instance
+      ///
+      /// \param robot robot with the same kinematic chain,
+      /// \param rank, number the sequence of this instance, from its next
+      ///        sample, is split into number interleaved streams. The
+      ///        instance returned shoots stream rank.
+      ///
+      /// Streams skip a prime number of samples of the sequence of this
+      /// instance at each shot. The prime is different from the bases of
+      /// the sequence, so that each stream is a low-discrepancy sequence.
+      /// \throw std::invalid_argument if rank is not less than number.
+      HaltonConfigurationShooterPtr_t leapfrog
+	(const DevicePtr_t& robot, std::size_t rank, std::size_t number) const;
+      /// Restart the sequence of this instance from its first sample
+      void reset ();
+
+      using ConfigurationShooter::shoot;
+      virtual ConfigurationPtr_t shoot () const;
+      virtual void shoot (matrixOut_t configurations) const;
+      /// Write the next configuration of the sequence in a preallocated
+      /// vector
+      /// \retval configuration vector of size robot configuration size.
+      void sample (ConfigurationOut_t configuration) const;
+
+    protected:
+      /// Constructor
+      ///
+      /// \throw std::runtime_error if a degree of freedom cannot be sampled
+      ///        uniformly, i.e. if it is not bounded.
+      HaltonConfigurationShooter (const DevicePtr_t& robot);
+      void init (const HaltonConfigurationShooterPtr_t& self);
+
+    private:
+      /// How to sample some consecutive configuration variables
+      struct Sampler {
+	enum Type {
+	  /// Uniform value between lower and upper
+	  INTERVAL,
+	  /// Angle in [-pi, pi]
+	  ANGLE,
+	  /// Cosine and sine of an angle in [-pi, pi]
+	  UNIT_COMPLEX,
+	  /// Unit quaternion
+	  UNIT_QUATERNION
+	};
+	Type type;
+	size_type rank;
+	/// Rank of the first variable of the sequence used by the sampler
+	std::size_t dimension;
+	value_type lower;
+	value_type upper;
+      }; // struct Sampler
+      typedef std::vector <Sampler> Samplers_t;
+      /// Radical inverse of index in base of dimension
+      value_type uniform (boost::uint64_t index, std::size_t dimension) const;
+      void addSampler (Sampler::Type type, size_type rank,
+		       std::size_t dimensions, value_type lower = 0,
+		       value_type upper = 0);
+
+      DevicePtr_t robot_;
+      Samplers_t samplers_;
+      /// One prime base per dimension of the sequence
+      std::vector <unsigned int> bases_;
+      /// Index of the first sample and space between samples in the Halton
+      /// sequence
+      boost::uint64_t start_;
+      boost::uint64_t stride_;
+      /// Number of samples already shot
+      mutable boost::uint64_t count_;
+      mutable boost::mutex mutex_;
+      HaltonConfigurationShooterWkPtr_t weak_;
+    }; // class HaltonConfigurationShooter
+    /// \}
+  } //   namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_HALTON_CONFIGURATION_SHOOTER_HH
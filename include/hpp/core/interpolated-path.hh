@@ -18,6 +18,7 @@
 #ifndef HPP_CORE_INTERPOLATED_PATH_HH
 # define HPP_CORE_INTERPOLATED_PATH_HH
 
+# include <vector>
 # include <hpp/core/fwd.hh>
 # include <hpp/core/config.hh>
 # include <hpp/core/path.hh>
@@ -33,6 +34,11 @@ namespace hpp {
     ///       joints, and translation part of freeflyer joints,
     ///   \li angular interpolation for unbounded rotation joints,
     ///   \li constant angular velocity for SO(3) part of freeflyer joints.
+    ///
+    /// Interpolation points are stored in a matrix, one column per point,
+    /// with the times in a sorted vector. Configuration variables that are
+    /// interpolated linearly are grouped once per device, so that they are
+    /// interpolated together without calling the joints.
     class HPP_CORE_DLLAPI InterpolatedPath : public Path
     {
     public:
@@ -135,28 +141,50 @@ namespace hpp {
       DevicePtr_t device () const;
 
       /// Insert interpolation point
-      void insert (const value_type& time, ConfigurationIn_t config)
-      {
-        configs_.insert (InterpolationPoint_t (time, config));
-      }
+      ///
+      /// Nothing is done if there is already a point at this time.
+      /// \note inserting points in increasing order of time before the end
+      ///       configuration is cheap.
+      void insert (const value_type& time, ConfigurationIn_t config);
 
       /// Get the initial configuration
       Configuration_t initial () const
       {
-        return configs_.begin ()->second;
+        return configs_.col (0);
       }
 
       /// Get the final configuration
       Configuration_t end () const
       {
-        return (--(configs_.end ()))->second;
+        return configs_.col (times_.size () - 1);
+      }
+
+      /// Get the number of interpolation points, including initial and end
+      /// configurations
+      std::size_t numberInterpolationPoints () const
+      {
+	return times_.size ();
       }
 
-      const InterpolationPoints_t& interpolationPoints () const
+      /// Get the time of an interpolation point
+      /// \param rank rank of the point in increasing order of time.
+      const value_type& interpolationTime (std::size_t rank) const
       {
-        return configs_;
+	return times_ [rank];
       }
 
+      /// Get the configuration of an interpolation point
+      /// \param rank rank of the point in increasing order of time.
+      ConfigurationIn_t interpolationPoint (std::size_t rank) const
+      {
+	return configs_.col (rank);
+      }
+
+      /// Get a copy of the interpolation points
+      /// \deprecated use numberInterpolationPoints, interpolationTime and
+      ///             interpolationPoint.
+      InterpolationPoints_t interpolationPoints () const HPP_CORE_DEPRECATED;
+
     protected:
       /// Print path in a stream
       virtual std::ostream& print (std::ostream &os) const
@@ -192,11 +220,32 @@ namespace hpp {
       virtual bool impl_compute (ConfigurationOut_t result,
 				 value_type param) const;
 
+      /// Interpolation points surrounding successive increasing parameters
+      /// are found by walking along the interpolation points.
+      virtual void impl_eval (vectorIn_t times, matrixOut_t configurations,
+			      std::vector <bool>& success) const;
+
+      /// Maximal velocity of the straight interpolations overlapping the
+      /// interval
+      virtual bool impl_velocityBound (vectorOut_t result, value_type t0,
+				       value_type t1) const;
+
+      virtual std::size_t impl_memoryUsage () const;
+
     private:
       inline void checkPath () const;
+      /// Interpolate between points of rank i - 1 and i
+      void interpolate (std::size_t i, value_type param,
+			ConfigurationOut_t result) const;
 
       DevicePtr_t device_;
-      InterpolationPoints_t configs_;
+      /// Times of the interpolation points, in increasing order
+      std::vector <value_type> times_;
+      /// Interpolation points, column i is the configuration at times_ [i].
+      /// There may be more columns than points.
+      matrix_t configs_;
+      /// Shared by the paths of the device
+      InterpolationPlanPtr_t plan_;
       InterpolatedPathWkPtr_t weak_;
     }; // class InterpolatedPath
   } //   namespace core
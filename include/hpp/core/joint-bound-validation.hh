@@ -19,6 +19,7 @@
 #ifndef HPP_CORE_JOINT_BOUND_VALIDATION_HH
 # define HPP_CORE_JOINT_BOUND_VALIDATION_HH
 
+# include <vector>
 # include <hpp/model/joint.hh>
 # include <hpp/core/config-validation.hh>
 
@@ -66,15 +67,22 @@ namespace hpp {
       /// Print report in a stream
       virtual std::ostream& print (std::ostream& os) const
       {
-	os << "Joint " << joint_->name () << ", rank: " << rank_
+	if (joint_) {
+	  os << "Joint " << joint_->name ();
+	} else {
+	  os << "Extra config space";
+	}
+	os << ", rank: " << rank_
 	   << ", value out of range: " << value_ << " not in ["
 	   << lowerBound_ << ", " << upperBound_ << "]";
 	return os;
       }
 
-      /// Joint the configuration value is out of bounds
+      /// Joint the configuration value is out of bounds, null for extra
+      /// config space
       JointPtr_t joint_;
-      /// degree of freedom in the joint (usually 0)
+      /// degree of freedom in the joint (usually 0), or rank in the extra
+      /// config space
       size_type rank_;
       /// lower bound
       value_type lowerBound_;
@@ -86,6 +94,13 @@ namespace hpp {
 
     /// Validate a configuration with respect to joint bounds
     ///
+    /// Bounds of the joints and of the extra config space are gathered at
+    /// construction in two vectors of the size of the configuration, with
+    /// infinite values for unbounded variables: validation is a comparison
+    /// of vectors, cheap enough to be run before collision checking.
+    ///
+    /// \note updateBounds () should be called after the bounds of the
+    ///       robot are modified.
     class HPP_CORE_DLLAPI JointBoundValidation : public ConfigValidation
     {
     public:
@@ -107,6 +122,30 @@ namespace hpp {
       /// \return whether the whole config is valid.
       bool validate (const Configuration_t& config,
 		     ValidationReportPtr_t& validationReport);
+
+      /// Compute whether the configuration is valid without report
+      virtual bool isValid (const Configuration_t& config);
+
+      /// Compute whether several configurations are valid
+      ///
+      /// Each bound is checked on all configurations at once.
+      /// \sa ConfigValidation::validateBatch
+      virtual bool validateBatch (const matrix_t& configurations,
+				  std::vector <bool>& valid, bool stopAtFirst);
+
+      /// Create a copy validating configurations of another robot
+      /// \param robot copy of the robot the validation applies to.
+      /// \note obstacles are not copied.
+      virtual ConfigValidationPtr_t copy (const DevicePtr_t& robot) const;
+
+      /// Read the bounds of the robot again
+      void updateBounds ();
+
+      /// Validation is much cheaper than one collision test
+      virtual value_type cost () const
+      {
+	return 1e-2;
+      }
     protected:
       JointBoundValidation (const DevicePtr_t& robot);
     private:
@@ -119,7 +158,16 @@ namespace hpp {
       virtual bool validate (const Configuration_t& config,
 			     ValidationReport& validationReport,
 			     bool throwIfInValid = false) HPP_CORE_DEPRECATED;
+      /// Rank of first configuration variable out of bounds, size of
+      /// config if none.
+      size_type firstOutOfBounds (const Configuration_t& config) const;
       DevicePtr_t robot_;
+      vector_t lower_;
+      vector_t upper_;
+      /// Joint and rank in joint of each configuration variable, null joint
+      /// for extra config space.
+      std::vector <JointPtr_t> joints_;
+      std::vector <size_type> ranks_;
     }; // class ConfigValidation
     /// \}
   } // namespace core
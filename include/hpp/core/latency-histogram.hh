@@ -0,0 +1,124 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_LATENCY_HISTOGRAM_HH
+# define HPP_CORE_LATENCY_HISTOGRAM_HH
+
+# include <iostream>
+# include <vector>
+# include <boost/atomic.hpp>
+# include <boost/cstdint.hpp>
+# include <boost/date_time/posix_time/posix_time_types.hpp>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup path_planning
+    /// \{
+
+    /// Histogram of durations with fixed memory
+    ///
+    /// Durations are counted in microseconds in buckets the width of which
+    /// grows with the duration, as in HDR histograms: durations below 16
+    /// microseconds have their own bucket, and each power of two above is
+    /// divided into 16 buckets, so that quantiles are known with a relative
+    /// error below 1/16. Durations above 2^40 microseconds, about 12 days,
+    /// are counted in the last bucket.
+    ///
+    /// Durations can be recorded by one thread while another thread takes
+    /// snapshots: counts are updated atomically, without lock.
+    class HPP_CORE_DLLAPI LatencyHistogram
+    {
+    public:
+      /// Number of linear buckets per power of two
+      static const std::size_t subBuckets = 16;
+      /// Number of buckets
+      static const std::size_t numberBuckets = subBuckets * 37;
+
+      /// Copy of the counts of a histogram
+      struct HPP_CORE_DLLAPI Snapshot
+      {
+	Snapshot ();
+	/// Number of durations of each bucket
+	std::vector <boost::uint64_t> counts;
+	/// Number of durations
+	boost::uint64_t count;
+	/// Sum of the durations in microseconds
+	boost::uint64_t total;
+	/// Largest duration in microseconds
+	boost::uint64_t max;
+
+	/// Mean duration in seconds, 0 if the histogram is empty
+	value_type mean () const;
+	/// Duration below which a given ratio of the durations lie
+	/// \param ratio between 0 and 1, 0.99 for the 99th percentile,
+	/// \return upper bound of the bucket of the quantile in seconds, not
+	///         larger than the largest duration, 0 if the histogram is
+	///         empty.
+	value_type quantile (value_type ratio) const;
+	/// Print number, mean, median, 99th percentile and maximum
+	std::ostream& print (std::ostream& os) const;
+      }; // struct Snapshot
+
+      LatencyHistogram ();
+
+      /// Record a duration in microseconds
+      void record (boost::uint64_t microseconds)
+      {
+	counts_ [bucket (microseconds)].fetch_add
+	  (1, boost::memory_order_relaxed);
+	total_.fetch_add (microseconds, boost::memory_order_relaxed);
+	boost::uint64_t max = max_.load (boost::memory_order_relaxed);
+	while (microseconds > max &&
+	       !max_.compare_exchange_weak (max, microseconds,
+					    boost::memory_order_relaxed));
+      }
+      /// Record the duration between a time and now
+      void recordSince (const boost::posix_time::ptime& start)
+      {
+	boost::posix_time::time_duration duration
+	  (boost::posix_time::microsec_clock::universal_time () - start);
+	boost::int64_t microseconds = duration.total_microseconds ();
+	record (microseconds > 0 ? (boost::uint64_t) microseconds : 0);
+      }
+      /// Remove all durations
+      void reset ();
+      /// Copy counts
+      Snapshot snapshot () const;
+
+      /// Get bucket of a duration in microseconds
+      static std::size_t bucket (boost::uint64_t microseconds);
+      /// Get smallest duration in microseconds of a bucket
+      static boost::uint64_t lowerBound (std::size_t bucket);
+      /// Get smallest duration in microseconds of the next bucket
+      static boost::uint64_t upperBound (std::size_t bucket);
+
+    private:
+      LatencyHistogram (const LatencyHistogram&);
+      LatencyHistogram& operator= (const LatencyHistogram&);
+      boost::atomic <boost::uint64_t> counts_ [numberBuckets];
+      boost::atomic <boost::uint64_t> total_;
+      boost::atomic <boost::uint64_t> max_;
+    }; // class LatencyHistogram
+    /// \}
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_LATENCY_HISTOGRAM_HH
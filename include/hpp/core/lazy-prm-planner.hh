@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_LAZY_PRM_PLANNER_HH
+# define HPP_CORE_LAZY_PRM_PLANNER_HH
+
+# include <set>
+# include <hpp/core/path-planner.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup path_planning
+    /// \{
+
+    /// Implementation of Lazy PRM algorithm
+    ///
+    /// Random collision-free configurations are connected to their nearest
+    /// neighbors by edges that are inserted in the roadmap without being
+    /// validated. Only the edges of the shortest path between the initial
+    /// and goal nodes are validated: invalid edges are removed from the
+    /// roadmap and the shortest path is searched again, until a valid path
+    /// is found or initial and goal nodes are not connected anymore.
+    ///
+    /// \note Edges added to the roadmap by other means (for instance by
+    ///       PathPlanner::tryDirectPath) are considered as valid.
+    class HPP_CORE_DLLAPI LazyPrmPlanner : public PathPlanner
+    {
+    public:
+      /// Return shared pointer to new object.
+      static LazyPrmPlannerPtr_t createWithRoadmap
+	(const Problem& problem, const RoadmapPtr_t& roadmap);
+      /// Return shared pointer to new object.
+      static LazyPrmPlannerPtr_t create (const Problem& problem);
+      /// Initialize the problem resolution
+      ///
+      /// Forget about edges that have been removed from the roadmap since
+      /// last resolution.
+      virtual void startSolve ();
+      /// Try to make direct connection between init and goal configurations
+      ///
+      /// Validate the shortest path between init and goal nodes if the
+      /// roadmap already connects them.
+      virtual void tryDirectPath ();
+      /// One step of extension.
+      ///
+      /// Add a random configuration in the roadmap, connect it to its
+      /// nearest neighbors without validation, and validate the shortest
+      /// path between init and goal nodes if any.
+      virtual void oneStep ();
+      /// Remove redundant nodes of the roadmap
+      ///
+      /// The ends of edges not validated yet are kept.
+      virtual void pruneRoadmap ();
+      /// Set configuration shooter.
+      void configurationShooter (const ConfigurationShooterPtr_t& shooter);
+      /// Set number of nearest nodes of each connected component a new node
+      /// is connected to
+      void numberNeighbors (std::size_t size)
+      {
+	numberNeighbors_ = size;
+      }
+      /// Get number of nearest nodes of each connected component a new node
+      /// is connected to
+      std::size_t numberNeighbors () const
+      {
+	return numberNeighbors_;
+      }
+    protected:
+      /// Constructor
+      LazyPrmPlanner (const Problem& problem, const RoadmapPtr_t& roadmap);
+      /// Constructor with roadmap
+      LazyPrmPlanner (const Problem& problem);
+      /// Store weak pointer to itself
+      void init (const LazyPrmPlannerWkPtr_t& weak);
+    private:
+      /// Validate edges of shortest paths until one is valid or init and
+      /// goal nodes are not connected anymore.
+      void validateShortestPath ();
+      /// Validate an edge that has been inserted without validation
+      /// \return whether the path of the edge is valid.
+      bool validate (const EdgePtr_t& edge);
+      /// Get edge not validated yet going in the other direction, if any.
+      EdgePtr_t reverse (const EdgePtr_t& edge) const;
+
+      ConfigurationShooterPtr_t configurationShooter_;
+      LazyPrmPlannerWkPtr_t weakPtr_;
+      // Edges inserted in the roadmap that have not been validated yet
+      std::set <EdgePtr_t> unvalidated_;
+      std::size_t numberNeighbors_;
+    }; // class LazyPrmPlanner
+    /// \}
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_LAZY_PRM_PLANNER_HH
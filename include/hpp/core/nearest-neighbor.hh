@@ -27,12 +27,91 @@ namespace hpp {
     class NearestNeighbor
     {
     public:
+      virtual ~NearestNeighbor ()
+      {
+      }
+
+      /// Set approximation factor of nearest neighbor searches
+      ///
+      /// Searches may return nodes farther than the exact nearest nodes by
+      /// a factor at most 1 + epsilon. 0 means exact search. Implementations
+      /// that only support exact search ignore this value.
+      void epsilon (value_type epsilon)
+      {
+	epsilon_ = epsilon;
+      }
+
+      /// Get approximation factor of nearest neighbor searches
+      value_type epsilon () const
+      {
+	return epsilon_;
+      }
+
       virtual void clear () = 0;
       virtual void addNode (const NodePtr_t& node) = 0;
+      /// Remove a node
+      ///
+      /// The node should have been added since the structure was last
+      /// cleared. Implementations may read the nodes of the connected
+      /// components: the node should also be removed from its connected
+      /// component.
+      virtual void removeNode (const NodePtr_t& node) = 0;
+      /// Search nearest node in a connected component
+      /// \param configuration configuration,
+      /// \param connectedComponent connected component to search in,
+      /// \retval distance distance to the returned node,
+      /// \param exact whether to ignore the approximation factor epsilon.
       virtual NodePtr_t search (const ConfigurationPtr_t& configuration,
 			       const ConnectedComponentPtr_t&
 				connectedComponent,
-			       value_type& distance) = 0;
+			       value_type& distance, bool exact = false) = 0;
+
+      /// Search nearest node in each connected component of a set
+      /// \param configuration configuration,
+      /// \param connectedComponents connected components to search in,
+      /// \retval nearestNodes connected component, nearest node and distance
+      ///         to the configuration for each connected component, in the
+      ///         order of connectedComponents,
+      /// \param exact whether to ignore the approximation factor epsilon.
+      ///
+      /// Default implementation calls search for each connected component.
+      virtual void search (const ConfigurationPtr_t& configuration,
+			   const ConnectedComponents_t& connectedComponents,
+			   NearestNodes_t& nearestNodes, bool exact = false)
+      {
+	nearestNodes.clear ();
+	nearestNodes.reserve (connectedComponents.size ());
+	for (ConnectedComponents_t::const_iterator itcc =
+	       connectedComponents.begin ();
+	     itcc != connectedComponents.end (); ++itcc) {
+	  value_type distance;
+	  NodePtr_t node = search (configuration, *itcc, distance, exact);
+	  nearestNodes.push_back
+	    (NearestNode_t (*itcc, NodeAndDistance_t (node, distance)));
+	}
+      }
+
+      /// Search the K nearest nodes of a connected component
+      /// \param configuration configuration,
+      /// \param connectedComponent connected component to search in,
+      /// \param K maximal number of nodes returned,
+      /// \retval distance distance to the farthest returned node, infinity
+      ///         if no node is returned.
+      /// \return nodes sorted by increasing distance to the configuration.
+      virtual Nodes_t KNearest (const ConfigurationPtr_t& configuration,
+				const ConnectedComponentPtr_t&
+				connectedComponent,
+				std::size_t K, value_type& distance) = 0;
+
+      /// Search nodes of a connected component within a radius
+      /// \param configuration configuration,
+      /// \param connectedComponent connected component to search in,
+      /// \param radius maximal distance to the configuration.
+      /// \return nodes sorted by increasing distance to the configuration.
+      virtual Nodes_t withinRadius (const ConfigurationPtr_t& configuration,
+				    const ConnectedComponentPtr_t&
+				    connectedComponent,
+				    value_type radius) = 0;
 
       // merge two connected components in the whole tree
       virtual void merge (ConnectedComponentPtr_t cc1,
@@ -41,6 +120,30 @@ namespace hpp {
       // Get distance function
       virtual DistancePtr_t distance () const = 0;
 
+      /// Get estimate of the memory used by the structure in bytes
+      ///
+      /// Nodes are not counted. The default implementation returns 0 for
+      /// unknown.
+      virtual std::size_t memoryUsage () const
+      {
+	return 0;
+      }
+
+    protected:
+      NearestNeighbor () : epsilon_ (0)
+      {
+      }
+
+      /// Compare distances of two nodes
+      static bool closer (const NodeAndDistance_t& n1,
+			  const NodeAndDistance_t& n2)
+      {
+	return n1.second < n2.second;
+      }
+
+      /// Approximation factor of searches
+      value_type epsilon_;
+
     }; // class NearestNeighbor
   } // namespace core
 } // namespace hpp
@@ -19,6 +19,7 @@
 #ifndef HPP_CORE_NODE_HH
 # define HPP_CORE_NODE_HH
 
+# include <vector>
 # include <hpp/model/fwd.hh>
 # include <hpp/core/fwd.hh>
 # include <hpp/core/config.hh>
@@ -33,7 +34,8 @@ namespace hpp {
     /// Stores a configuration.
     class HPP_CORE_DLLAPI Node {
     public:
-      typedef std::list <EdgePtr_t> Edges_t;
+      /// Edges are stored contiguously for fast graph traversal
+      typedef std::vector <EdgePtr_t> Edges_t;
       /// Constructor
       /// \param configuration configuration stored in the new node
       /// \note A new connected component is created. For consistency, the
@@ -46,21 +48,49 @@ namespace hpp {
 	    ConnectedComponentPtr_t connectedComponent);
       void addOutEdge (EdgePtr_t edge);
       void addInEdge (EdgePtr_t edge);
+      /// Remove an edge starting from the node
+      void removeOutEdge (EdgePtr_t edge);
+      /// Remove an edge ending at the node
+      void removeInEdge (EdgePtr_t edge);
       /// Store the connected component the node belongs to
       void connectedComponent (const ConnectedComponentPtr_t& cc);
+      /// Get the connected component the node belongs to
+      /// \note If the stored connected component has been merged, the
+      ///       connected component it has been merged into is returned.
       ConnectedComponentPtr_t connectedComponent () const;
       /// Access to outEdges
       const Edges_t& outEdges () const;
       /// Access to inEdges
       const Edges_t& inEdges () const;
-      ConfigurationPtr_t configuration () const;
+      /// Get configuration stored in the node
+      ///
+      /// Returned by reference: nearest neighbor searches and shortest path
+      /// heuristics read configurations of many nodes in a row, without
+      /// changing the reference count of the shared pointer.
+      const ConfigurationPtr_t& configuration () const;
+      /// Get index of the node in the roadmap
+      ///
+      /// Nodes of a roadmap are indexed from 0 in order of creation, so that
+      /// algorithms can store data about nodes in arrays.
+      std::size_t index () const;
+      /// Set index of the node in the roadmap
+      void index (std::size_t index);
+      /// Whether the node is a goal node of the roadmap
+      ///
+      /// Set by Roadmap::addGoalNode and Roadmap::resetGoalNodes, so that
+      /// shortest path searches test goals in constant time.
+      bool isGoal () const;
+      /// Set whether the node is a goal node of the roadmap
+      void isGoal (bool goal);
       /// Print node in a stream
       std::ostream& print (std::ostream& os) const;
     private:
       ConfigurationPtr_t configuration_;
       Edges_t outEdges_;
       Edges_t inEdges_;
-      ConnectedComponentPtr_t connectedComponent_;
+      mutable ConnectedComponentPtr_t connectedComponent_;
+      std::size_t index_;
+      bool goal_;
     }; // class Node
     std::ostream& operator<< (std::ostream& os, const Node& n);
     /// \}
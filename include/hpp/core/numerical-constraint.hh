@@ -18,6 +18,7 @@
 #ifndef HPP_CORE_NUMERICALCONSTRAINT_HH
 # define HPP_CORE_NUMERICALCONSTRAINT_HH
 
+# include <boost/function.hpp>
 # include <hpp/core/equation.hh>
 
 namespace hpp {
@@ -30,8 +31,19 @@ namespace hpp {
     /// \li in which \f$ f \f$ is a differentiable function.
     class HPP_CORE_DLLAPI NumericalConstraint : public Equation {
       public:
+        /// Build the function of the constraint for a robot
+        typedef boost::function <DifferentiableFunctionPtr_t
+				 (const DevicePtr_t&)> FunctionBuilder_t;
+
         /// Copy object and return shared pointer to copy
         virtual EquationPtr_t copy () const;
+
+        /// Copy object for another robot and return shared pointer to copy
+        /// \param robot copy of the robot the function applies to, for
+        ///        another thread for instance.
+        /// \return copy with its own function built by the function builder
+        ///         for robot, empty pointer if no builder is set.
+        virtual NumericalConstraintPtr_t copy (const DevicePtr_t& robot) const;
         /// Create a shared pointer to a new instance.
         /// \sa constructors
         static NumericalConstraintPtr_t create (const DifferentiableFunctionPtr_t& function,
@@ -61,6 +73,22 @@ namespace hpp {
           return function_;
         }
 
+        /// Set builder of the function of copies for other robots
+        /// \param builder returns a new function equivalent to the function
+        ///        of this constraint, applying to the robot passed as
+        ///        argument.
+        /// \sa copy (const DevicePtr_t&)
+        void functionBuilder (const FunctionBuilder_t& builder)
+        {
+          functionBuilder_ = builder;
+        }
+
+        /// Get builder of the function of copies for other robots
+        const FunctionBuilder_t& functionBuilder () const
+        {
+          return functionBuilder_;
+        }
+
         /// Return a reference to the value.
         /// This vector can be used to store the output of the function,
         /// its size being initialized.
@@ -77,6 +105,26 @@ namespace hpp {
           return jacobian_;
         }
 
+        /// Set columns of the Jacobian that may be non zero
+        ///
+        /// \param columns intervals (first column, number of columns) of
+        ///        the input derivative space out of which the Jacobian of the
+        ///        function is zero.
+        /// ConfigProjector only copies these columns into its reduced
+        /// Jacobian.
+        /// \note By default, all columns are active. Columns should be set
+        ///       before the constraint is added to a ConfigProjector.
+        void activeColumns (const SizeIntervals_t& columns)
+        {
+          activeColumns_ = columns;
+        }
+
+        /// Get columns of the Jacobian that may be non zero
+        const SizeIntervals_t& activeColumns () const
+        {
+          return activeColumns_;
+        }
+
       protected:
         /// Constructor
         /// \param function the differentiable function
@@ -99,11 +147,16 @@ namespace hpp {
 	  weak_ = weak;
 	}
 
+	/// Replace the function of a copy
+	void function (const DifferentiableFunctionPtr_t& function);
+
       private:
         DifferentiableFunctionPtr_t function_;
+        FunctionBuilder_t functionBuilder_;
 
         vector_t value_;
         matrix_t jacobian_;
+        SizeIntervals_t activeColumns_;
 	NumericalConstraintWkPtr_t weak_;
     };
     /// \}
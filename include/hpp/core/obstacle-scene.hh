@@ -0,0 +1,113 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_OBSTACLE_SCENE_HH
+# define HPP_CORE_OBSTACLE_SCENE_HH
+
+# include <map>
+# include <boost/shared_ptr.hpp>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+
+namespace fcl {
+  class CollisionObject;
+  class DynamicAABBTreeCollisionManager;
+} // namespace fcl
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup validation
+    /// \{
+
+    /// Set of obstacles stored in a broad phase structure
+    ///
+    /// A scene is shared by the collision validations of several robots or
+    /// threads, see CollisionValidation::copy: the broad phase structure is
+    /// built once. A shared scene should not be modified: a validation that
+    /// modifies a shared scene modifies a copy of it.
+    ///
+    /// The broad phase structure is built by setup () and only read by
+    /// collide (), so that several threads may test collisions in the same
+    /// scene.
+    class HPP_CORE_DLLAPI ObstacleScene
+    {
+    public:
+      typedef std::map <const fcl::CollisionObject*, CollisionObjectPtr_t>
+	Obstacles_t;
+      /// Called for each obstacle the bounding box of which overlaps the
+      /// one of the tested object. Return true to stop the search.
+      typedef bool (*Callback_t) (fcl::CollisionObject*,
+				  fcl::CollisionObject*, void*);
+
+      /// Create an empty scene
+      static ObstacleScenePtr_t create ();
+      /// Create a scene with the same obstacles
+      static ObstacleScenePtr_t createCopy (const ObstacleScene& scene);
+
+      /// Add an obstacle
+      /// \return false if the obstacle is already in the scene.
+      bool add (const CollisionObjectPtr_t& object);
+      /// Remove an obstacle
+      /// \return false if the obstacle is not in the scene.
+      bool remove (const CollisionObjectPtr_t& object);
+      /// Update the bounding box of an obstacle that has moved
+      /// \return false if the obstacle is not in the scene.
+      ///
+      /// Removal and update cost a logarithmic time in the number of
+      /// obstacles.
+      bool update (const CollisionObjectPtr_t& object);
+      /// Get obstacle
+      /// \return the obstacle the fcl object of which is object, an empty
+      ///         pointer if there is none.
+      CollisionObjectPtr_t find (const fcl::CollisionObject* object) const;
+      /// Get obstacles indexed by their fcl objects
+      const Obstacles_t& obstacles () const
+      {
+	return obstacles_;
+      }
+      /// Whether the scene contains obstacles
+      bool empty () const
+      {
+	return obstacles_.empty ();
+      }
+
+      /// Build broad phase structure if obstacles have been modified
+      /// \note not thread safe.
+      void setup ();
+      /// Test an object against the obstacles in the broad phase
+      /// \param object object with an up to date bounding box,
+      /// \param data passed to callback,
+      /// \param callback narrow phase test.
+      /// \pre setup () has been called after the last modification.
+      void collide (fcl::CollisionObject* object, void* data,
+		    Callback_t callback) const;
+
+    protected:
+      ObstacleScene ();
+
+    private:
+      Obstacles_t obstacles_;
+      boost::shared_ptr <fcl::DynamicAABBTreeCollisionManager> manager_;
+      /// Whether the broad phase structure is up to date
+      bool ready_;
+    }; // class ObstacleScene
+    /// \}
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_OBSTACLE_SCENE_HH
@@ -0,0 +1,100 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_OPERATION_COUNTERS_HH
+# define HPP_CORE_OPERATION_COUNTERS_HH
+
+# include <iostream>
+# include <vector>
+# include <boost/atomic.hpp>
+# include <hpp/core/config.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup path_planning
+    /// \{
+
+    /// Counters of the elementary operations performed by path planning
+    ///
+    /// Nearest neighbor queries, steering method calls, projections, and so
+    /// on, are counted by the components of the library when counting is
+    /// enabled. Each thread increments its own counters, so that counting
+    /// does not synchronize threads; values () sums the counters of all
+    /// threads, including threads that have terminated.
+    ///
+    /// When counting is disabled, which is the default, the cost of a
+    /// counted operation is the test of a flag.
+    ///
+    /// \sa ProblemSolver::operationCounts
+    class HPP_CORE_DLLAPI OperationCounters
+    {
+    public:
+      /// Operations counted
+      enum Operation {
+	/// Nearest neighbor queries in a roadmap
+	NEAREST_NEIGHBOR,
+	/// Calls to a steering method
+	STEERING,
+	/// Projections of a configuration onto constraints
+	PROJECTION,
+	/// Validations of a configuration by ConfigValidations
+	CONFIG_VALIDATION,
+	/// Collision tests between two objects
+	NARROW_PHASE,
+	/// Steps of continuous collision checking
+	CONTINUOUS_STEP,
+	/// Expansions of a node by graph search
+	ASTAR_EXPANSION,
+	NUMBER_OPERATIONS
+      }; // enum Operation
+      /// Number of operations indexed by Operation
+      typedef std::vector <std::size_t> Values_t;
+
+      /// Enable or disable counting
+      static void enable (bool enable);
+      /// Whether counting is enabled
+      static bool enabled ()
+      {
+	return enabled_.load (boost::memory_order_relaxed);
+      }
+      /// Count operations if counting is enabled
+      static void increment (Operation operation, std::size_t n = 1)
+      {
+	if (enabled ()) add (operation, n);
+      }
+      /// Get number of operations counted by all threads since last reset
+      static Values_t values ();
+      /// Set all counters of all threads to 0
+      /// \note operations counted concurrently may be counted since
+      ///       before the reset.
+      static void reset ();
+      /// Get name of an operation
+      static const char* name (Operation operation);
+      /// Print values with the names of the operations
+      static std::ostream& print (std::ostream& os, const Values_t& values);
+
+    private:
+      static void add (Operation operation, std::size_t n);
+      static boost::atomic <bool> enabled_;
+    }; // class OperationCounters
+    /// \}
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_OPERATION_COUNTERS_HH
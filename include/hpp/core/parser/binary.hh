@@ -0,0 +1,196 @@
+//
+// Copyright (c) 2016 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_PARSER_BINARY_HH
+# define HPP_CORE_PARSER_BINARY_HH
+
+# include <ostream>
+# include <string>
+# include <boost/cstdint.hpp>
+# include <boost/interprocess/file_mapping.hpp>
+# include <boost/interprocess/mapped_region.hpp>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+
+namespace hpp {
+  namespace core {
+    namespace parser {
+      /// \addtogroup parser
+      /// \{
+
+      /// Header of binary roadmap and path files
+      ///
+      /// Files are made of this header followed by arrays of 8 byte values
+      /// in the byte order of the machine that wrote them:
+      /// \li roadmaps: configurations of the nodes (numberConfigurations
+      ///     columns of configSize doubles), then for each edge, its length
+      ///     (doubles), the ranks of its initial and final nodes and the
+      ///     type of its path (unsigned integers), then the ranks of the
+      ///     goal nodes;
+      /// \li path vectors: interpolation points of all the paths
+      ///     (numberConfigurations columns of configSize doubles), their
+      ///     times on the paths (doubles), then for each path, its length
+      ///     (doubles), the rank of its first point and the type of the path
+      ///     (unsigned integers).
+      struct BinaryHeader {
+	enum Content {
+	  ROADMAP = 1,
+	  PATH_VECTOR = 2
+	};
+	enum PathType {
+	  /// StraightPath between the configurations
+	  STRAIGHT_PATH = 0,
+	  /// InterpolatedPath through the configurations
+	  INTERPOLATED_PATH = 1,
+	  /// Constrained StraightPath, path of another type or path not
+	  /// computed yet, computed again by a steering method when read
+	  OTHER_PATH = 2
+	};
+	/// "HPPB"
+	char magic [4];
+	boost::uint32_t version;
+	boost::uint32_t content;
+	boost::uint32_t reserved;
+	boost::uint64_t configSize;
+	boost::uint64_t numberDof;
+	boost::uint64_t numberConfigurations;
+	/// Number of edges of the roadmap or of paths in the vector
+	boost::uint64_t numberPaths;
+	/// Rank of the initial node, -1 if none
+	boost::int64_t initNode;
+	boost::uint64_t numberGoalNodes;
+      }; // struct BinaryHeader
+
+      /// Write a roadmap in binary format
+      ///
+      /// \param o output stream, should be opened in binary mode,
+      /// \param roadmap roadmap to write,
+      /// \param robot robot the configurations of which are stored in the
+      ///        roadmap.
+      /// \note As writeRoadmap, constraints of the edges are not saved.
+      void writeRoadmapBinary (std::ostream& o, const RoadmapPtr_t& roadmap,
+			       const DevicePtr_t& robot);
+
+      /// Roadmap stored in a memory mapped binary file
+      ///
+      /// Configurations and edges are read from the file without copy.
+      /// Nodes and edges of a Roadmap are only created by method roadmap.
+      class HPP_CORE_DLLAPI MappedRoadmap
+      {
+      public:
+	/// Map a file written by writeRoadmapBinary
+	/// \throw std::runtime_error if the file is not a binary roadmap.
+	MappedRoadmap (const std::string& filename);
+
+	/// Get number of nodes
+	std::size_t numberNodes () const
+	{
+	  return header_->numberConfigurations;
+	}
+
+	/// Get number of edges
+	std::size_t numberEdges () const
+	{
+	  return header_->numberPaths;
+	}
+
+	/// Get configurations of the nodes, one per column
+	Eigen::Map <const matrix_t> configurations () const
+	{
+	  return Eigen::Map <const matrix_t>
+	    (configurations_, header_->configSize,
+	     header_->numberConfigurations);
+	}
+
+	/// Get rank of the initial node of an edge
+	std::size_t edgeFrom (std::size_t edge) const
+	{
+	  return from_ [edge];
+	}
+
+	/// Get rank of the final node of an edge
+	std::size_t edgeTo (std::size_t edge) const
+	{
+	  return to_ [edge];
+	}
+
+	/// Get length of the path of an edge
+	value_type edgeLength (std::size_t edge) const
+	{
+	  return lengths_ [edge];
+	}
+
+	/// Get type of the path of an edge
+	BinaryHeader::PathType edgeType (std::size_t edge) const
+	{
+	  return (BinaryHeader::PathType) types_ [edge];
+	}
+
+	/// Create a roadmap with the nodes and edges of the file
+	///
+	/// \param distance, robot see Roadmap::create,
+	/// \param steeringMethod steering method computing the paths of the
+	///        edges of type OTHER_PATH on first access, see
+	///        Roadmap::addEdge.
+	/// Paths of the edges of type STRAIGHT_PATH are unconstrained straight
+	/// interpolations of the stored length.
+	/// \throw std::runtime_error if the robot does not have the
+	///        configuration size stored in the file, or if an edge is of
+	///        type OTHER_PATH and no steering method is given.
+	RoadmapPtr_t roadmap (const DistancePtr_t& distance,
+			      const DevicePtr_t& robot,
+			      const SteeringMethodPtr_t& steeringMethod =
+			      SteeringMethodPtr_t ()) const;
+
+      private:
+	MappedRoadmap (const MappedRoadmap&);
+	MappedRoadmap& operator= (const MappedRoadmap&);
+	boost::interprocess::file_mapping file_;
+	boost::interprocess::mapped_region region_;
+	const BinaryHeader* header_;
+	const value_type* configurations_;
+	const value_type* lengths_;
+	const boost::uint64_t* from_;
+	const boost::uint64_t* to_;
+	const boost::uint64_t* types_;
+	const boost::uint64_t* goals_;
+      }; // class MappedRoadmap
+
+      /// Write a path vector in binary format
+      ///
+      /// \param o output stream, should be opened in binary mode,
+      /// \param path path vector to write, it is flattened.
+      /// \throw std::runtime_error if a path is neither a StraightPath nor
+      ///        an InterpolatedPath.
+      /// \note constraints of the paths are not saved.
+      void writePathVectorBinary (std::ostream& o, const PathVectorPtr_t& path);
+
+      /// Read a path vector written by writePathVectorBinary
+      ///
+      /// \param filename name of the file,
+      /// \param robot robot the configurations of which are stored in the
+      ///        file.
+      /// \throw std::runtime_error if the file is not a binary path vector
+      ///        for this robot.
+      PathVectorPtr_t readPathVectorBinary (const std::string& filename,
+					    const DevicePtr_t& robot);
+      /// \}
+    } //   namespace parser
+  } //   namespace core
+} // namespace hpp
+#endif // HPP_CORE_PARSER_BINARY_HH
@@ -37,9 +37,18 @@ namespace hpp {
       typedef hpp::util::parser::SequenceFactory<double> ConfigurationFactory;
       typedef hpp::util::parser::SequenceFactory<unsigned int> IdSequence;
 
+      /// Write a roadmap in XML format
+      ///
+      /// Elements are written directly in the stream, in the format of
+      /// RoadmapFactory::write, without building a document in memory.
       void writeRoadmap (std::ostream& o, const RoadmapPtr_t roadmap,
           const DevicePtr_t robot);
 
+      /// Read a roadmap written by writeRoadmap
+      ///
+      /// The file is read sequentially and nodes are added to the roadmap
+      /// as they are read. Paths of the edges are computed by
+      /// SteeringMethodStraight.
       RoadmapPtr_t readRoadmap (const std::string& filename, const DistancePtr_t distance,
           const DevicePtr_t robot);
 
@@ -0,0 +1,196 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_PATH_COST_HH
+# define HPP_CORE_PATH_COST_HH
+
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup path_optimization
+    /// \{
+
+    /// Cost of a path
+    ///
+    /// Costs are additive: the cost of a concatenation of paths is the sum of
+    /// the costs of the paths. They are used
+    /// \li by A* to search roadmaps, see PathPlanner::pathCost; the cost of
+    ///     the path of an edge is cached in the edge, see Edge::cost,
+    /// \li by RandomShortcut to compare shortcuts, see RandomShortcut::cost.
+    ///
+    /// Derived classes implement impl_cost.
+    class HPP_CORE_DLLAPI PathCost
+    {
+    public:
+      virtual ~PathCost ()
+      {
+      }
+      /// Compute the cost of a path
+      value_type operator () (const PathPtr_t& path) const
+      {
+	return impl_cost (path);
+      }
+      /// Get lower bound of the ratio of the cost to the distance
+      ///
+      /// The cost of a path is greater than the product of this factor by
+      /// the distance between its end configurations, so that A* can
+      /// scale the distance to the goal into an admissible heuristic.
+      /// \return 0 by default, in which case A* explores the roadmap as
+      ///         Dijkstra algorithm.
+      virtual value_type distanceFactor () const
+      {
+	return 0;
+      }
+    protected:
+      PathCost ()
+      {
+      }
+      /// Compute the cost of a path
+      /// \return infinity if the path cannot be evaluated.
+      virtual value_type impl_cost (const PathPtr_t& path) const = 0;
+    }; // class PathCost
+
+    /// Length of the interval of definition of a path
+    ///
+    /// That is the distance between the end configurations for the paths
+    /// of the steering methods of this package.
+    class HPP_CORE_DLLAPI LengthCost : public PathCost
+    {
+    public:
+      /// Return shared pointer to new object.
+      static LengthCostPtr_t create ();
+
+      virtual value_type distanceFactor () const
+      {
+	return 1;
+      }
+    protected:
+      LengthCost ()
+      {
+      }
+      virtual value_type impl_cost (const PathPtr_t& path) const;
+    }; // class LengthCost
+
+    /// Length of a path weighted by the inverse of the clearance
+    ///
+    /// The path is sampled with a given step. The cost is the sum over the
+    /// intervals between consecutive samples of the distance between the
+    /// samples times \f$1 + w / c\f$, where \f$w\f$ is the weight and
+    /// \f$c\f$ the mean of the clearances of the samples, so that paths far
+    /// from the obstacles are preferred.
+    ///
+    /// \note The configuration of the robot is modified: instances should
+    ///       not be shared between threads.
+    class HPP_CORE_DLLAPI ClearanceCost : public PathCost
+    {
+    public:
+      /// Return shared pointer to new object.
+      /// \param robot robot the configuration of which is set at samples,
+      /// \param clearance distance computation between the bodies of the
+      ///        robot and the obstacles,
+      /// \param distance distance between samples,
+      /// \param weight weight of the inverse of the clearance,
+      /// \param step maximal interval of parameter between samples.
+      /// \throw std::invalid_argument if weight is negative or if step
+      ///        is not positive.
+      static ClearanceCostPtr_t create
+	(const DevicePtr_t& robot,
+	 const DistanceBetweenObjectsPtr_t& clearance,
+	 const DistancePtr_t& distance, value_type weight, value_type step);
+
+      virtual value_type distanceFactor () const
+      {
+	return 1;
+      }
+    protected:
+      ClearanceCost (const DevicePtr_t& robot,
+		     const DistanceBetweenObjectsPtr_t& clearance,
+		     const DistancePtr_t& distance, value_type weight,
+		     value_type step);
+      virtual value_type impl_cost (const PathPtr_t& path) const;
+    private:
+      /// Minimal distance between the robot and the obstacles
+      value_type clearance (ConfigurationIn_t q) const;
+
+      DevicePtr_t robot_;
+      DistanceBetweenObjectsPtr_t clearance_;
+      DistancePtr_t distance_;
+      value_type weight_;
+      value_type step_;
+    }; // class ClearanceCost
+
+    /// Integral of the squared velocity along a path
+    ///
+    /// The path is sampled with a given step, the velocity between
+    /// consecutive samples is the distance between the samples divided by
+    /// the interval of parameter. The cost of a path of given length
+    /// decreases with the duration of the interval of definition and is
+    /// minimal when the velocity is constant.
+    class HPP_CORE_DLLAPI EnergyCost : public PathCost
+    {
+    public:
+      /// Return shared pointer to new object.
+      /// \param distance distance between samples,
+      /// \param step maximal interval of parameter between samples.
+      /// \throw std::invalid_argument if step is not positive.
+      static EnergyCostPtr_t create (const DistancePtr_t& distance,
+				     value_type step);
+    protected:
+      EnergyCost (const DistancePtr_t& distance, value_type step);
+      virtual value_type impl_cost (const PathPtr_t& path) const;
+    private:
+      DistancePtr_t distance_;
+      value_type step_;
+    }; // class EnergyCost
+
+    /// Minimal time to follow a path with velocity limits
+    ///
+    /// The path is followed at constant speed, the fastest speed such that
+    /// the upper bounds of the velocities of the degrees of freedom (see
+    /// Path::velocityBound) are within the limits. That is the duration
+    /// given by pathOptimization::TimeParameterization without
+    /// accelerations.
+    class HPP_CORE_DLLAPI TimeCost : public PathCost
+    {
+    public:
+      /// Return shared pointer to new object.
+      /// \param velocityLimits velocity limits of the degrees of freedom.
+      /// \throw std::invalid_argument if a limit is not positive.
+      static TimeCostPtr_t create (vectorIn_t velocityLimits);
+
+      /// Get velocity limits of the degrees of freedom
+      const vector_t& velocityLimits () const
+      {
+	return velocityLimits_;
+      }
+    protected:
+      TimeCost (vectorIn_t velocityLimits);
+      /// \throw std::runtime_error if the path does not provide velocity
+      ///        bounds,
+      /// \throw std::invalid_argument if the size of the velocity of the
+      ///        path differs from the size of the limits.
+      virtual value_type impl_cost (const PathPtr_t& path) const;
+    private:
+      vector_t velocityLimits_;
+    }; // class TimeCost
+    /// \}
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_PATH_COST_HH
@@ -19,6 +19,7 @@
 #ifndef HPP_CORE_PATH_OPTIMIZATION_CONFIG_OPTIMIZATION_HH
 # define HPP_CORE_PATH_OPTIMIZATION_CONFIG_OPTIMIZATION_HH
 
+# include <vector>
 # include <hpp/core/path-optimizer.hh>
 # include <hpp/core/path-vector.hh>
 
@@ -86,9 +87,49 @@ namespace hpp {
             boost::function <bool (const JointPtr_t, const size_type)>
               shouldFilter;
 
+            /// Whether to optimize all the waypoints at once at each pass
+            ///
+            /// If true, all waypoints are optimized, then the segments that
+            /// changed are validated together, in parallel if thread
+            /// problems have been added. Waypoints adjacent to an invalid
+            /// segment are set back to their previous value and the
+            /// segments around them validated again, until all segments are
+            /// valid. Otherwise, forward and backward passes optimize the
+            /// waypoints one after the other.
+            /// Defaults to false
+            bool batchPass;
+
             Parameters ();
           } parameters;
 
+          /// \name Parallel validation
+          /// \{
+
+          /// Add a problem used by a worker thread
+          /// \param problem copy of the problem of the optimizer, with its
+          ///        own robot, steering method, constraints and path
+          ///        validation, see Problem::cloneForThread.
+          ///
+          /// If problems have been added, the segments of batch passes are
+          /// steered and validated by one thread per problem. The problem
+          /// should outlive the optimizer.
+          /// \sa Parameters::batchPass
+          void addThreadProblem (const Problem& problem)
+          {
+            threadProblems_.push_back (&problem);
+          }
+          /// Remove problems used by worker threads
+          void resetThreadProblems ()
+          {
+            threadProblems_.clear ();
+          }
+          /// Get problems used by worker threads
+          const std::vector <const Problem*>& threadProblems () const
+          {
+            return threadProblems_;
+          }
+          /// \}
+
         protected:
           ConfigOptimization (const Problem& problem);
 
@@ -118,6 +159,18 @@ namespace hpp {
               const Optimizers_t& optimizers, const std::size_t& index,
               const value_type& alpha, PathVectorPtr_t opted, bool& didChange)
             const;
+
+          /// Optimize all waypoints and validate the segments that changed
+          /// \param path path of which configs are the waypoints,
+          /// \retval didChange whether some waypoints changed.
+          /// \return the path through newConfigs, or an empty pointer if a
+          ///         segment could not be steered.
+          PathVectorPtr_t batchPass (const PathVectorPtr_t& path,
+              vectorIn_t configs, vectorOut_t newConfigs,
+              const Optimizers_t& optimizers, const value_type& alpha,
+              bool& didChange) const;
+
+          std::vector <const Problem*> threadProblems_;
       }; // class RandomShortcut
       /// \}
 
@@ -19,6 +19,7 @@
 #ifndef HPP_CORE_PATH_OPTIMIZATION_GRADIENT_BASED_HH
 # define HPP_CORE_PATH_OPTIMIZATION_GRADIENT_BASED_HH
 
+#include <vector>
 #include <hpp/core/path-optimizer.hh>
 #include <hpp/core/path-vector.hh>
 #include <hpp/core/steering-method-straight.hh>
@@ -31,6 +32,8 @@ namespace hpp {
       class CollisionConstraintsResult;
       typedef std::vector <CollisionConstraintsResult>
       CollisionConstraintsResults_t;
+      typedef std::vector <std::pair <CollisionPathValidationReportPtr_t,
+				      std::size_t> > Reports_t;
 
       class HPP_CORE_DLLAPI GradientBased : public PathOptimizer
       {
@@ -40,15 +43,61 @@ namespace hpp {
 	static GradientBasedPtr_t create (const Problem& problem);
 
 	/// Optimize path
+	/// \throw std::invalid_argument if a cost is set and its input size
+	///        does not match the way points of the path.
 	virtual PathVectorPtr_t optimize (const PathVectorPtr_t& path);
 
+	/// Set cost minimized by the optimizer
+	/// \param cost function of the way points of the path to optimize,
+	///        excluding the first and last ones, as PathLength; empty for
+	///        the path length, which is the default.
+	///
+	/// The Hessian of costs other than PathLength is approximated by the
+	/// blocks of Cost::hessian on the three block diagonals.
+	void cost (const CostPtr_t& cost)
+	{
+	  userCost_ = cost;
+	}
+	/// Get cost minimized by the optimizer
+	const CostPtr_t& cost () const
+	{
+	  return userCost_;
+	}
+
+	/// \name Parallel validation
+	/// \{
+
+	/// Add a problem used by a worker thread
+	/// \param problem copy of the problem of the optimizer, with its own
+	///        robot, steering method, constraints and path validation,
+	///        see Problem::cloneForThread.
+	///
+	/// If problems have been added, the elements of each iterate are
+	/// validated, and collision constraints are computed, by one thread
+	/// per problem. The problem should outlive the optimizer.
+	void addThreadProblem (const Problem& problem)
+	{
+	  threadProblems_.push_back (&problem);
+	}
+	/// Remove problems used by worker threads
+	void resetThreadProblems ()
+	{
+	  threadProblems_.clear ();
+	}
+	/// Get problems used by worker threads
+	const std::vector <const Problem*>& threadProblems () const
+	{
+	  return threadProblems_;
+	}
+	/// \}
+
       protected:
 	GradientBased (const Problem& problem);
 
       private:
-	typedef Eigen::JacobiSVD < matrix_t > Jacobi_t;
+	typedef std::vector <matrix_t> Blocks_t;
 
-	void compressHessian (matrixIn_t normal, matrixOut_t small) const;
+	void compressHessian (const Blocks_t& normal, Blocks_t& small) const;
 	void compressVector (vectorIn_t normal, vectorOut_t small) const;
 	void uncompressVector (vectorIn_t small, vectorOut_t normal) const;
 
@@ -106,6 +155,18 @@ namespace hpp {
 	/// Compute iteration of optimization program
 	vector_t computeIterate (vectorIn_t x) const;
 
+	/// Compute block Cholesky decomposition of the Hessian
+	///
+	/// The Hessian is block tridiagonal with one block per way point, its
+	/// decomposition H = L L^T is stored as the diagonal and lower blocks
+	/// of the block bidiagonal matrix L.
+	/// \throw std::runtime_error if the Hessian is not positive definite.
+	void factorizeHessian () const;
+	/// Solve H x = b in place using the Cholesky decomposition
+	/// \param x right hand side b as input, solution x as output. Each
+	///        column is a different right hand side.
+	void solveHessian (matrixOut_t x) const;
+
 	/// Display path waypoints in log file
 	void displayPath (vectorIn_t x, std::string
 #ifdef HPP_DEBUG
@@ -118,15 +179,20 @@ namespace hpp {
 	  hppDout(info, "finish path parsing");
 	}
 
-	/// Add a collision constraint
+	/// Add collision constraints
 	///
-	/// \param ccr contains parameter of collision configuration
-	/// \param latest valid path
+	/// \param path0 latest valid path
+	/// \param path1 path in collision
+	/// \param reports collisions of path1 and ranks of the elements in
+	///        collision
+	/// \retval collisionConstraints the new constraints are appended.
 	/// Add lines to the Jacobian and fill with values corresponding to
-	/// new relative position constraint.
-	/// Resize right hand side.
-	void addCollisionConstraint (const CollisionConstraintsResult& ccr,
-				     const PathVectorPtr_t& path) const;
+	/// new relative position constraints, in parallel if thread problems
+	/// have been added. Resize right hand side.
+	void addCollisionConstraints
+	  (const PathVectorPtr_t& path0, const PathVectorPtr_t& path1,
+	   const Reports_t& reports,
+	   CollisionConstraintsResults_t& collisionConstraints) const;
 
 	/// Update right hand side of constraints
 	///
@@ -142,6 +208,9 @@ namespace hpp {
 	/// Get constraints of problem and update local jacobian J_
 	bool getProblemConstraints ();
 
+	std::vector <const Problem*> threadProblems_;
+	/// Cost set by the user
+	CostPtr_t userCost_;
 	mutable CostPtr_t cost_;
 	DevicePtr_t robot_;
 	size_type configSize_;
@@ -153,13 +222,11 @@ namespace hpp {
 	mutable Configuration_t end_;
 	WeighedDistancePtr_t distance_;
 	SteeringMethodStraightPtr_t steeringMethod_;
-	/// I_, H_ Identity matrix and cost Hessian respectively
-	/// Jf_  collision-constraints jacobian for now
-	/// J_ problem-constraints jacobian
-	/// V0_ orthogonal base of Jf_ null space
-	/// Aplusb = Jf^{+}*b (for affine constraints)
-	mutable matrix_t H_, Hinverse_, J_, V0_;
-	mutable matrix_t Hz_, gz_;
+	/// Hdiagonal_, Hlower_ diagonal and lower blocks of the cost Hessian
+	/// Ldiagonal_, Llower_ blocks of its Cholesky decomposition
+	/// J_ problem and collision constraints jacobian
+	mutable Blocks_t Hdiagonal_, Hlower_, Ldiagonal_, Llower_;
+	mutable matrix_t J_;
 	mutable vector_t stepNormal_;
 	mutable bool fullRank_;
 	mutable size_type nbWaypoints_;
@@ -167,7 +234,7 @@ namespace hpp {
 	mutable rowvector_t rgrad_;
 	mutable vector_t rhs_;
 	mutable vector_t value_;
-	mutable vector_t p_, p0_;
+	mutable vector_t p_;
 	value_type epsilon_;
 	std::size_t iterMax_;
 	value_type alphaInit_; // .1, .2, .4
@@ -19,6 +19,8 @@
 #ifndef HPP_CORE_PATH_OPTIMIZATION_PARTIAL_SHORTCUT_HH
 # define HPP_CORE_PATH_OPTIMIZATION_PARTIAL_SHORTCUT_HH
 
+# include <vector>
+# include <boost/random/mersenne_twister.hpp>
 # include <hpp/core/path-optimizer.hh>
 
 namespace hpp {
@@ -35,6 +37,10 @@ namespace hpp {
       ///     a joint, then the joint is inserted in a input set of next step.
       /// \li try to find random shortcut on each joint in the set.
       ///
+      /// Parameters of the random shortcuts are drawn from a random number
+      /// generator owned by the instance and seeded by the problem (see
+      /// Problem::drawSeed).
+      ///
       /// See Parameters for information on how to tune the algorithm.
       ///
       /// \note The optimizer assumes that the input path is a vector of optimal
@@ -63,6 +69,12 @@ namespace hpp {
           /// Optimize path
           virtual PathVectorPtr_t optimize (const PathVectorPtr_t& path);
 
+          /// Reset random number generator
+          void seed (unsigned int seed)
+          {
+            generator_.seed (seed);
+          }
+
           struct Parameters {
             /// Whether of not the joint that are locked by the constraints
             /// in the path should not be optimized.
@@ -87,15 +99,39 @@ namespace hpp {
             Parameters ();
           } parameters;
 
+          /// \name Parallel evaluation of joints
+          /// \{
+
+          /// Add a problem used by a worker thread
+          /// \param problem copy of the problem of the optimizer, with its
+          ///        own robot, steering method, constraints and path
+          ///        validation, see Problem::cloneForThread.
+          ///
+          /// If problems have been added, the shortcuts of all joints are
+          /// computed and validated on the same path, by one thread per
+          /// problem, and the shortest one is kept. Otherwise joints are
+          /// optimized one after the other. The problem should outlive the
+          /// optimizer.
+          void addThreadProblem (const Problem& problem)
+          {
+            threadProblems_.push_back (&problem);
+          }
+          /// Remove problems used by worker threads
+          void resetThreadProblems ()
+          {
+            threadProblems_.clear ();
+          }
+          /// Get problems used by worker threads
+          const std::vector <const Problem*>& threadProblems () const
+          {
+            return threadProblems_;
+          }
+          /// \}
+
         protected:
           PartialShortcut (const Problem& problem);
 
         private:
-          PathVectorPtr_t generatePath (
-              PathVectorPtr_t path, const JointPtr_t joint,
-              const value_type t1, ConfigurationIn_t q1,
-              const value_type t2, ConfigurationIn_t q2) const;
-
           JointVector_t generateJointVector (const PathVectorPtr_t& pv) const;
 
           /// try direct path on each joint in jvIn.
@@ -112,7 +148,25 @@ namespace hpp {
           ///        tried
           /// \return the optimized path
           PathVectorPtr_t optimizeRandom (const PathVectorPtr_t& pv,
-              const JointVector_t& jv) const;
+              const JointVector_t& jv);
+
+          /// try direct path on all joints in jvIn at each round, in
+          /// parallel, and keep the shortest valid one.
+          /// \sa optimizeFullPath
+          PathVectorPtr_t optimizeFullPathInParallel (const PathVectorPtr_t& pv,
+              const JointVector_t& jvIn, JointVector_t& jvOut) const;
+
+          /// try a random shortcut on all joints in jv at each round, in
+          /// parallel, and keep the shortest valid one.
+          /// \sa optimizeRandom
+          PathVectorPtr_t optimizeRandomInParallel (const PathVectorPtr_t& pv,
+              const JointVector_t& jv);
+
+          /// Uniform random value in [0, 1)
+          value_type uniform ();
+
+          std::vector <const Problem*> threadProblems_;
+          boost::mt19937 generator_;
       }; // class RandomShortcut
       /// \}
 
@@ -19,6 +19,7 @@
 #ifndef HPP_CORE_PATH_OPTIMIZATION_PATH_LENGTH_HH
 # define HPP_CORE_PATH_OPTIMIZATION_PATH_LENGTH_HH
 
+# include <vector>
 # include <hpp/core/path-optimization/cost.hh>
 
 namespace hpp {
@@ -39,6 +40,16 @@ namespace hpp {
       public:
 	static PathLengthPtr_t create (const WeighedDistancePtr_t& distance,
 				       const PathVectorPtr_t& path);
+
+	/// Return the approximation of the Hessian as tridiagonal blocks
+	///
+	/// The Hessian is block tridiagonal with one block row per way point.
+	/// \retval diagonal blocks on the diagonal,
+	/// \retval lower blocks below the diagonal: block i is at block row
+	///         i+1 and block column i. Blocks above the diagonal are their
+	///         transposes.
+	void hessian (std::vector <matrix_t>& diagonal,
+		      std::vector <matrix_t>& lower) const;
       protected:
 	PathLength (const WeighedDistancePtr_t& distance,
 		    const PathVectorPtr_t& path);
@@ -55,6 +66,8 @@ namespace hpp {
 	/// Weight are computed according to initial partial
 	/// paths lengths with regard to the total length.
 	void computeLambda (const PathVectorPtr_t& path) const;
+	/// Diagonal matrix of the squared weights of the distance
+	matrix_t squaredWeights () const;
 
 	std::size_t nbPaths_;
 	WeighedDistancePtr_t distance_;
@@ -0,0 +1,66 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_PATH_OPTIMIZATION_SPLINE_SMOOTHING_HH
+# define HPP_CORE_PATH_OPTIMIZATION_SPLINE_SMOOTHING_HH
+
+# include <hpp/core/path-optimizer.hh>
+
+namespace hpp {
+  namespace core {
+    namespace pathOptimization {
+      /// \addtogroup path_optimization
+      /// \{
+
+      /// Smoothing of a path by a cubic spline through its way points
+      ///
+      /// The way points of the flattened input path are interpolated by a
+      /// natural cubic spline parameterized by the lengths of the paths
+      /// between way points. The tangents at the way points are the
+      /// solution of one tridiagonal linear system, solved for all degrees
+      /// of freedom at once. The spline is continuous with continuous
+      /// first and second derivatives, except at SO(3) joints where the
+      /// tangents of consecutive pieces are expressed in different frames.
+      ///
+      /// Each piece of the spline is validated by the path validation of
+      /// the problem. The pieces provide velocity bounds (see
+      /// Path::velocityBound) so that continuous collision checking can be
+      /// used. An invalid piece is replaced by the original path between
+      /// the same way points.
+      ///
+      /// The spline is not shorter than the straight interpolations between
+      /// the same way points: optimizers that remove way points, like
+      /// RandomShortcut or PartialShortcut, should be run before.
+      class HPP_CORE_DLLAPI SplineSmoothing : public PathOptimizer
+      {
+      public:
+	/// Return shared pointer to new object.
+	static SplineSmoothingPtr_t create (const Problem& problem);
+
+	/// Optimize path
+	virtual PathVectorPtr_t optimize (const PathVectorPtr_t& path);
+
+      protected:
+	SplineSmoothing (const Problem& problem);
+      }; // class SplineSmoothing
+      /// \}
+    } // namespace pathOptimization
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_PATH_OPTIMIZATION_SPLINE_SMOOTHING_HH
@@ -0,0 +1,94 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_PATH_OPTIMIZATION_TIME_PARAMETERIZATION_HH
+# define HPP_CORE_PATH_OPTIMIZATION_TIME_PARAMETERIZATION_HH
+
+# include <hpp/core/path-optimizer.hh>
+
+namespace hpp {
+  namespace core {
+    namespace pathOptimization {
+      /// \addtogroup path_optimization
+      /// \{
+
+      /// Time parameterization of a path with velocity and acceleration
+      /// limits
+      ///
+      /// Each element of the flattened input path is followed by a
+      /// TimeParameterizedPath that starts and stops at rest, so
+      /// that the velocity is continuous at the way points, where straight
+      /// interpolations change direction. The time law of an element is
+      /// computed from the upper bounds of the velocities of its degrees of
+      /// freedom (see Path::velocityBound), in one pass over the elements,
+      /// without sampling the path.
+      ///
+      /// To be added as the last optimizer of a PlanAndOptimize or of a
+      /// ProblemSolver: the parameter of the resulting path is time.
+      ///
+      /// \note the acceleration limits are honoured along paths the second
+      ///       derivative of which vanishes, like straight paths.
+      ///       Constraints of the paths are not taken into account.
+      class HPP_CORE_DLLAPI TimeParameterization : public PathOptimizer
+      {
+      public:
+	/// Return shared pointer to new object.
+	static TimeParameterizationPtr_t create (const Problem& problem);
+
+	/// Compute time parameterized path
+	/// \throw std::runtime_error if an element of the path does not
+	///        provide velocity bounds.
+	virtual PathVectorPtr_t optimize (const PathVectorPtr_t& path);
+
+	/// Set velocity limits of the degrees of freedom
+	/// \param limits vector of size the number of degrees of freedom of
+	///        the robot, 1 by default.
+	/// \throw std::invalid_argument if the size is wrong or a limit is
+	///        not positive.
+	void velocityLimits (vectorIn_t limits);
+	/// Get velocity limits of the degrees of freedom
+	const vector_t& velocityLimits () const
+	{
+	  return velocityLimits_;
+	}
+	/// Set acceleration limits of the degrees of freedom
+	/// \param limits vector of size the number of degrees of freedom of
+	///        the robot, 1 by default, infinite values for no limit.
+	/// \throw std::invalid_argument if the size is wrong or a limit is
+	///        not positive.
+	void accelerationLimits (vectorIn_t limits);
+	/// Get acceleration limits of the degrees of freedom
+	const vector_t& accelerationLimits () const
+	{
+	  return accelerationLimits_;
+	}
+
+      protected:
+	TimeParameterization (const Problem& problem);
+
+      private:
+	void checkLimits (vectorIn_t limits) const;
+	vector_t velocityLimits_;
+	vector_t accelerationLimits_;
+      }; // class TimeParameterization
+      /// \}
+    } // namespace pathOptimization
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_PATH_OPTIMIZATION_TIME_PARAMETERIZATION_HH
@@ -19,8 +19,12 @@
 #ifndef HPP_CORE_PATH_OPTIMIZER_HH
 # define HPP_CORE_PATH_OPTIMIZER_HH
 
+# include <deque>
+# include <limits>
+# include <boost/date_time/posix_time/posix_time_types.hpp>
 # include <hpp/core/config.hh>
 # include <hpp/core/fwd.hh>
+# include <hpp/core/latency-histogram.hh>
 
 namespace hpp {
   namespace core {
@@ -39,22 +43,150 @@ namespace hpp {
       }
       /// Optimize path
       virtual PathVectorPtr_t optimize (const PathVectorPtr_t& path) = 0;
+      /// Optimize path and record the duration of optimize
+      ///
+      /// Called by PlanAndOptimize and ProblemSolver. The durations of the
+      /// calls that return are recorded in a histogram, see latencies.
+      PathVectorPtr_t measuredOptimize (const PathVectorPtr_t& path)
+      {
+	const boost::posix_time::ptime start
+	  (boost::posix_time::microsec_clock::universal_time ());
+	PathVectorPtr_t result (optimize (path));
+	latency_.recordSince (start);
+	return result;
+      }
+      /// Get histogram of the durations of measuredOptimize
+      ///
+      /// Can be called while another thread optimizes.
+      LatencyHistogram::Snapshot latencies () const
+      {
+	return latency_.snapshot ();
+      }
+      /// Remove durations recorded by measuredOptimize
+      void resetLatencies ()
+      {
+	latency_.reset ();
+      }
       /// Interrupt path optimization
       void interrupt () { interrupt_ = true; }
+      /// Set token that cancels path optimization
+      /// \param token checked by stopOptimization as the interruption
+      ///        flag, empty (default) for none.
+      ///
+      /// When the token is cancelled, optimize returns the best path found
+      /// so far. Unlike the interruption flag, the token is not reset by
+      /// startOptimization.
+      void cancellationToken (const CancellationTokenPtr_t& token)
+      {
+	cancellationToken_ = token;
+      }
+      /// Get token that cancels path optimization
+      const CancellationTokenPtr_t& cancellationToken () const
+      {
+	return cancellationToken_;
+      }
+      /// Set maximal duration of method optimize
+      /// \param seconds duration in seconds, infinity for no limit.
+      /// When the duration is exceeded, optimize returns the best path found
+      /// so far.
+      void timeOut (value_type seconds)
+      {
+	timeOut_ = seconds;
+      }
+      /// Get maximal duration of method optimize in seconds
+      value_type timeOut () const
+      {
+	return timeOut_;
+      }
+      /// Set maximal number of iterations of method optimize
+      ///
+      /// What an iteration is depends on the optimizer: a shortcut attempt
+      /// for RandomShortcut and PartialShortcut, a step for GradientBased, a
+      /// pass for ConfigOptimization.
+      void maxIterations (std::size_t n)
+      {
+	maxIterations_ = n;
+      }
+      /// Get maximal number of iterations of method optimize
+      std::size_t maxIterations () const
+      {
+	return maxIterations_;
+      }
+      /// Set minimal relative improvement of the cost
+      /// \param ratio optimization stops when the cost decreased by less
+      ///        than ratio times its value over the last iterations, 0 to
+      ///        disable,
+      /// \param window number of iterations over which the improvement is
+      ///        measured.
+      ///
+      /// The cost is the quantity each optimizer decreases, the length of
+      /// the path for all optimizers of this package.
+      void minRelativeImprovement (value_type ratio, std::size_t window = 1);
+      /// Get minimal relative improvement of the cost
+      value_type minRelativeImprovement () const
+      {
+	return minRelativeImprovement_;
+      }
+      /// Get number of iterations of the last call to method optimize
+      std::size_t numberIterations () const
+      {
+	return numberIterations_;
+      }
 
     protected:
       /// Whether to interrupt computation
-      /// Set to true at start of optimize method, set to false by method
+      /// Set to false at start of optimize method, set to true by method
       /// interrupt.
       bool interrupt_;
-      PathOptimizer (const Problem& problem) : problem_ (problem)
+      PathOptimizer (const Problem& problem) : interrupt_ (false),
+	cancellationToken_ (), problem_ (problem),
+	timeOut_ (std::numeric_limits <value_type>::infinity ()),
+	startTime_ (boost::posix_time::microsec_clock::universal_time ()),
+	maxIterations_ (std::numeric_limits <std::size_t>::max ()),
+	minRelativeImprovement_ (0), window_ (1), numberIterations_ (0),
+	costs_ (), converged_ (false), latency_ ()
 	{
 	}
 
       PathPtr_t steer (ConfigurationIn_t q1, ConfigurationIn_t q2) const;
+      /// Steer between two configurations, reusing storage
+      ///
+      /// See SteeringMethod::operator(). Paths are always created if the
+      /// problem has a path projector.
+      bool steer (ConfigurationIn_t q1, ConfigurationIn_t q2,
+		  PathPtr_t& path) const;
+
+      /// Reset interruption and start measuring the duration of optimization
+      ///
+      /// To be called at the beginning of method optimize.
+      void startOptimization ();
+      /// Whether optimization should stop
+      ///
+      /// Optimization stops if it has been interrupted or cancelled, exceeds
+      /// the time out or the maximal number of iterations, or if the cost
+      /// does not decrease enough.
+      bool stopOptimization () const;
+      /// Notify the end of an iteration that did not change the cost
+      void iterationDone ();
+      /// Notify the end of an iteration
+      /// \param cost cost of the current path.
+      void iterationDone (const value_type& cost);
 
     private:
+      CancellationTokenPtr_t cancellationToken_;
       const Problem& problem_;
+      value_type timeOut_;
+      /// Time at which optimization started
+      boost::posix_time::ptime startTime_;
+      std::size_t maxIterations_;
+      value_type minRelativeImprovement_;
+      std::size_t window_;
+      std::size_t numberIterations_;
+      /// Costs of the last window_ + 1 iterations
+      std::deque <value_type> costs_;
+      bool converged_;
+      /// Durations of measuredOptimize
+      LatencyHistogram latency_;
     }; // class PathOptimizer;
     /// }
   } // namespace core
@@ -19,8 +19,12 @@
 #ifndef HPP_CORE_PATH_PLANNER_HH
 # define HPP_CORE_PATH_PLANNER_HH
 
+# include <string>
+# include <vector>
+# include <boost/date_time/posix_time/posix_time_types.hpp>
 # include <hpp/core/fwd.hh>
 # include <hpp/core/config.hh>
+# include <hpp/core/latency-histogram.hh>
 
 namespace hpp {
   namespace core {
@@ -33,6 +37,26 @@ namespace hpp {
     /// set of goal configurations.
     class HPP_CORE_DLLAPI PathPlanner {
     public:
+      /// Histograms of the durations of the phases of method solve
+      struct Latencies
+      {
+	LatencyHistogram::Snapshot tryDirectPath;
+	LatencyHistogram::Snapshot oneStep;
+	LatencyHistogram::Snapshot computePath;
+	LatencyHistogram::Snapshot finishSolve;
+      }; // struct Latencies
+      /// Reason why method trySolve returned
+      enum Status {
+	/// A path has been found
+	SOLVED,
+	/// Planning has been interrupted or cancelled
+	CANCELLED,
+	/// The maximal number of iterations has been reached
+	MAX_ITERATIONS_REACHED,
+	/// The time out has been reached
+	TIME_OUT_REACHED
+      }; // enum Status
+
       /// Get roadmap
       const RoadmapPtr_t& roadmap () const;
       /// Get problem
@@ -49,18 +73,163 @@ namespace hpp {
       /// \li finishSolve.
       /// Users can implement themselves the loop to avoid being trapped
       /// in an infinite loop when no solution is found.
+      /// \throw std::runtime_error if trySolve does not return SOLVED.
       virtual PathVectorPtr_t solve ();
+      /// Solve without throwing when planning stops before finding a path
+      ///
+      /// Run the same steps as solve, checking interruption and the
+      /// cancellation token between steps.
+      /// \retval path planned path, empty unless a path has been found.
+      /// \return why planning stopped. The roadmap is kept, so that
+      ///         planning can go on with the work already done.
+      /// \note exceptions thrown by the steps are propagated.
+      Status trySolve (PathVectorPtr_t& path);
+      /// Get message explaining a status of trySolve
+      static std::string statusMessage (Status status);
       /// Try to make direct connection between init and goal
       /// configurations, in order to avoid a random shoot.
+      ///
+      /// Goals are tried by increasing distance to the init configuration.
+      /// If problems have been added (see addThreadProblem), the direct
+      /// paths are steered, projected and validated by one thread per
+      /// problem, and the valid ones are inserted in the roadmap
+      /// afterwards.
       virtual void tryDirectPath();
       /// User implementation of one step of resolution
       virtual void oneStep () = 0;
       /// Post processing of the resulting path
       virtual PathVectorPtr_t finishSolve (const PathVectorPtr_t& path);
       /// Interrupt path planning
-      void interrupt ();
+      virtual void interrupt ();
+      /// Set token that cancels path planning
+      /// \param token checked between the steps of solve as the
+      ///        interruption flag, empty (default) for none.
+      ///
+      /// Unlike interrupt, that may be called while solve is not running
+      /// yet, the token is not reset when solving starts.
+      void cancellationToken (const CancellationTokenPtr_t& token)
+      {
+	cancellationToken_ = token;
+      }
+      /// Get token that cancels path planning
+      const CancellationTokenPtr_t& cancellationToken () const
+      {
+	return cancellationToken_;
+      }
       /// Find a path in the roadmap and transform it in trajectory
+      ///
+      /// The path minimizes the cost set by pathCost or, by default, the
+      /// length of the paths of the edges.
       PathVectorPtr_t computePath () const;
+      /// Set cost of the paths minimized by computePath
+      /// \param cost cost of the paths of the edges, empty for their
+      ///        length, which is the default.
+      ///
+      /// If a cost is set, computePath uses A* even if the incremental
+      /// search of the roadmap is enabled (see Roadmap::incrementalSearch),
+      /// since the latter maintains shortest paths for the lengths of the
+      /// edges.
+      void pathCost (const PathCostPtr_t& cost)
+      {
+	pathCost_ = cost;
+      }
+      /// Get cost of the paths minimized by computePath
+      const PathCostPtr_t& pathCost () const
+      {
+	return pathCost_;
+      }
+      /// Remove redundant nodes of the roadmap
+      ///
+      /// Called by solve between two steps when the roadmap exceeds its
+      /// memory budget, see Roadmap::memoryBudget. The default
+      /// implementation calls Roadmap::prune. Planners that store nodes or
+      /// edges of the roadmap between steps reimplement it to keep them.
+      virtual void pruneRoadmap ();
+
+      /// \name Parallel computations
+      /// \{
+
+      /// Add a problem used by a worker thread
+      /// \param problem copy of the problem of the planner, with its own
+      ///        robot, steering method, constraints and path validation,
+      ///        see Problem::cloneForThread.
+      ///
+      /// The problems are used by tryDirectPath and by the planners that
+      /// support parallel steps. The problem should outlive the planner.
+      void addThreadProblem (const Problem& problem)
+      {
+	threadProblems_.push_back (&problem);
+      }
+      /// Remove problems used by worker threads
+      virtual void resetThreadProblems ()
+      {
+	threadProblems_.clear ();
+      }
+      /// Get problems used by worker threads
+      const std::vector <const Problem*>& threadProblems () const
+      {
+	return threadProblems_;
+      }
+      /// Set whether tryDirectPath stops at the first valid direct path
+      ///
+      /// By default, direct paths to all the goals are tried, so that
+      /// the shortest one can be chosen by computePath.
+      void stopAtFirstDirectPath (bool stop)
+      {
+	stopAtFirstDirectPath_ = stop;
+      }
+      /// Get whether tryDirectPath stops at the first valid direct path
+      bool stopAtFirstDirectPath () const
+      {
+	return stopAtFirstDirectPath_;
+      }
+      /// \}
+
+      /// \name Budgets of method solve
+      /// When a budget is exhausted, solve throws std::runtime_error and the
+      /// roadmap is kept, so that calling solve again goes on with the
+      /// work already done.
+      /// \{
+
+      /// Set maximal number of calls to oneStep in solve
+      /// \param iterations number of iterations, 0 for no limit.
+      void maxIterations (std::size_t iterations)
+      {
+	maxIterations_ = iterations;
+      }
+      /// Get maximal number of calls to oneStep in solve
+      std::size_t maxIterations () const
+      {
+	return maxIterations_;
+      }
+      /// Set maximal duration of solve
+      /// \param seconds duration in seconds, infinity for no limit.
+      void timeOut (value_type seconds)
+      {
+	timeOut_ = seconds;
+      }
+      /// Get maximal duration of solve in seconds
+      value_type timeOut () const
+      {
+	return timeOut_;
+      }
+      /// \}
+
+      /// \name Latencies of method solve
+      /// \{
+
+      /// Get histograms of the durations of the phases of solve
+      ///
+      /// Durations of the calls to tryDirectPath, oneStep, computePath and
+      /// finishSolve made by solve are recorded, since the creation of the
+      /// planner or the last call to resetLatencies. Can be called while
+      /// another thread solves.
+      /// \sa PathOptimizer::latencies for the optimizers of
+      ///     PlanAndOptimize.
+      Latencies latencies () const;
+      /// Remove durations recorded by solve
+      void resetLatencies ();
+      /// \}
     protected:
       /// Constructor
       ///
@@ -72,14 +241,36 @@ namespace hpp {
       PathPlanner (const Problem& problem, const RoadmapPtr_t& roadmap);
       /// Store weak pointer to itself
       void init (const PathPlannerWkPtr_t& weak);
+      /// Whether the duration of solve exceeds the time out
+      ///
+      /// Implementations of oneStep that run for long can call this method
+      /// to return early.
+      bool timeOutReached () const;
+      /// Whether planning has been interrupted or cancelled
+      ///
+      /// Implementations of oneStep that run for long can call this method
+      /// to return early.
+      bool cancelled () const;
     private:
       /// Reference to the problem
       const Problem& problem_;
       /// Pointer to the roadmap.
       const RoadmapPtr_t roadmap_;
+      PathCostPtr_t pathCost_;
       bool interrupt_;
+      CancellationTokenPtr_t cancellationToken_;
+      std::vector <const Problem*> threadProblems_;
+      bool stopAtFirstDirectPath_;
+      std::size_t maxIterations_;
+      value_type timeOut_;
+      /// Time at which solve started
+      boost::posix_time::ptime startTime_;
       /// Store weak pointer to itself
       PathPlannerWkPtr_t weakPtr_;
+      LatencyHistogram tryDirectPathLatency_;
+      LatencyHistogram oneStepLatency_;
+      LatencyHistogram computePathLatency_;
+      LatencyHistogram finishSolveLatency_;
     }; // class PathPlanner
     /// \}
   } //   namespace core
@@ -17,6 +17,8 @@
 #ifndef HPP_CORE_PATHPROJECTOR_HH
 # define HPP_CORE_PATHPROJECTOR_HH
 
+# include <list>
+# include <map>
 # include "hpp/core/config.hh"
 # include "hpp/core/fwd.hh"
 
@@ -43,6 +45,57 @@ namespace hpp {
         /// \return True if projection succeded
         bool apply (const PathPtr_t& path, PathPtr_t& projection) const;
 
+        /// Copy the projector for another problem
+        ///
+        /// \param distance, steeringMethod distance and steering method of
+        ///        the other problem, the steering method is copied.
+        /// \return projector with the same parameters and cache size, and an
+        ///         empty cache, or an empty pointer if the projector cannot
+        ///         be copied.
+        PathProjectorPtr_t copy (const DistancePtr_t& distance,
+                                 const SteeringMethodPtr_t& steeringMethod)
+          const;
+
+        /// \name Cache of projections
+        ///
+        /// Projections of straight paths subject to constraints can be
+        /// stored, so that projecting the same path again, after
+        /// PathVector::extract or in a path optimizer for instance, returns
+        /// the stored projection. Paths are identified by their end
+        /// configurations, the revisions of their constraint set and of its
+        /// config projector (see Constraint::revision), and the right hand
+        /// side of the config projector. When the cache is full, the least
+        /// recently used projection is removed. Each projector has its own
+        /// cache, see copy.
+        /// \{
+
+        /// Set maximal number of stored projections
+        /// \param size maximal number of projections, 0 (default) disables
+        ///        the cache.
+        void cacheSize (std::size_t size);
+
+        /// Get maximal number of stored projections
+        std::size_t cacheSize () const
+        {
+          return cacheSize_;
+        }
+
+        /// Remove stored projections and reset counters
+        void clearCache ();
+
+        /// Number of projections found in the cache
+        std::size_t cacheHits () const
+        {
+          return cacheHits_;
+        }
+
+        /// Number of projections computed and stored in the cache
+        std::size_t cacheMisses () const
+        {
+          return cacheMisses_;
+        }
+        /// \}
+
       protected:
         /// Constructor
 	///
@@ -59,11 +112,48 @@ namespace hpp {
         virtual bool impl_apply (const PathPtr_t& path,
 				 PathPtr_t& projection) const = 0;
 
+        /// Method to be reimplemented by inherited class that can be copied.
+        /// \return empty pointer by default.
+        virtual PathProjectorPtr_t impl_copy
+	  (const DistancePtr_t& distance,
+	   const SteeringMethodPtr_t& steeringMethod) const;
+
         value_type d (ConfigurationIn_t q1, ConfigurationIn_t q2) const;
+        /// Distances between a configuration and several others
+        /// \sa Distance::distances
+        void distances (ConfigurationIn_t q, matrixIn_t configurations,
+			vectorOut_t result) const;
 	PathPtr_t steer (ConfigurationIn_t q1, ConfigurationIn_t q2) const;
       private:
+        struct CacheKey {
+          Configuration_t initial;
+          Configuration_t end;
+          /// Revisions of the constraint set and of its config projector
+          std::size_t constraints;
+          std::size_t configProjector;
+          vector_t rightHandSide;
+          bool operator< (const CacheKey& other) const;
+        }; // struct CacheKey
+        struct CacheEntry {
+          CacheEntry (const PathPtr_t& p, bool s) : projection (p), success (s)
+          {
+          }
+          PathPtr_t projection;
+          bool success;
+        }; // struct CacheEntry
+        /// Entries by decreasing time of last use
+        typedef std::list <std::pair <CacheKey, CacheEntry> > Cache_t;
+        typedef std::map <CacheKey, Cache_t::iterator> CacheIndex_t;
+        /// Remove least recently used entries above the maximal size
+        void trimCache () const;
+
         DistancePtr_t distance_;
 	SteeringMethodPtr_t steeringMethod_;
+        std::size_t cacheSize_;
+        mutable Cache_t cache_;
+        mutable CacheIndex_t cacheIndex_;
+        mutable std::size_t cacheHits_;
+        mutable std::size_t cacheMisses_;
     };
   } // namespace core
 } // namespace hpp
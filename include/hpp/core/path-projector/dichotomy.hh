@@ -17,6 +17,7 @@
 #ifndef HPP_CORE_PATHPROJECTOR_DICHOTOMY_HH
 # define HPP_CORE_PATHPROJECTOR_DICHOTOMY_HH
 
+# include <vector>
 # include "hpp/core/path-projector.hh"
 namespace hpp {
   namespace core {
@@ -39,6 +40,10 @@ namespace hpp {
           bool impl_apply (const PathPtr_t& path,
 			   PathPtr_t& projection) const;
 
+          PathProjectorPtr_t impl_copy
+	    (const DistancePtr_t& distance,
+	     const SteeringMethodPtr_t& steeringMethod) const;
+
           Dichotomy (const DistancePtr_t& distance,
 		     const SteeringMethodPtr_t& steeringMethod,
 		     value_type maxPathLength);
@@ -48,6 +53,16 @@ namespace hpp {
 
         private:
           value_type maxPathLength_;
+          /// Workspaces of applyToStraightPath, kept between calls to
+          /// avoid allocations.
+          /// Paths to split, the next one at the back
+          mutable std::vector <PathPtr_t> toSplit_;
+          /// Projected paths, in the order of the projection
+          mutable std::vector <PathPtr_t> projected_;
+          /// Configuration at the middle of the path to split, before and
+          /// after projection
+          mutable Configuration_t qMiddle_;
+          mutable Configuration_t qProjected_;
       };
     } // namespace pathProjector
   } // namespace core
@@ -18,6 +18,7 @@
 #ifndef HPP_CORE_PATHPROJECTOR_GLOBAL_HH
 # define HPP_CORE_PATHPROJECTOR_GLOBAL_HH
 
+# include <vector>
 # include "hpp/core/path-projector.hh"
 
 namespace hpp {
@@ -37,29 +38,61 @@ namespace hpp {
 						      step));
           }
 
+          /// Set number of threads projecting the waypoints
+          ///
+          /// At each pass, the waypoints that do not satisfy the constraints
+          /// yet are projected in parallel, see
+          /// ConfigProjector::oneStepBatch.
+          /// \note numerical constraints of the paths should have a function
+          ///       builder, see NumericalConstraint::functionBuilder.
+          void numberThreads (std::size_t n)
+          {
+            numberThreads_ = n;
+          }
+
+          /// Get number of threads projecting the waypoints
+          std::size_t numberThreads () const
+          {
+            return numberThreads_;
+          }
+
         protected:
           bool impl_apply (const PathPtr_t& path,
 			   PathPtr_t& projection) const;
 
+          PathProjectorPtr_t impl_copy
+	    (const DistancePtr_t& distance,
+	     const SteeringMethodPtr_t& steeringMethod) const;
+
           Global (const DistancePtr_t& distance,
 		       const SteeringMethodPtr_t& steeringMethod,
 		       value_type step);
         private:
           value_type step_;
+          std::size_t numberThreads_;
 
           const value_type alphaMin;
           const value_type alphaMax;
 
-          typedef std::list <Configuration_t,
-                  Eigen::aligned_allocator <Configuration_t> > Configs_t;
-          typedef std::list <value_type> Lengths_t;
-          typedef std::list <value_type> Alphas_t;
+          /// Waypoints of the path, one per column
+          typedef matrix_t Configs_t;
+          /// Lengths of the segments between consecutive waypoints
+          typedef std::vector <value_type> Lengths_t;
+          /// Step sizes of the projection of each waypoint
+          typedef std::vector <value_type> Alphas_t;
+          /// Whether each waypoint satisfies the constraints
           typedef std::vector <bool> Bools_t;
 
           bool projectOneStep (ConfigProjector& p,
               Configs_t& q, Bools_t& b, Lengths_t& l,
               Alphas_t& alpha) const;
 
+          /// Implementation of projectOneStep with several threads
+          bool projectOneStepInParallel (ConfigProjector& p,
+              Configs_t& q, Bools_t& b, Lengths_t& l,
+              Alphas_t& alpha) const;
+
+          /// Split segments longer than maxDist in one pass
           /// Returns the number of new points
           std::size_t reinterpolate (const DevicePtr_t& robot,
               Configs_t& q, Bools_t& b, Lengths_t& l, Alphas_t& alpha,
@@ -39,6 +39,10 @@ namespace hpp {
           bool impl_apply (const PathPtr_t& path,
 			   PathPtr_t& projection) const;
 
+          PathProjectorPtr_t impl_copy
+	    (const DistancePtr_t& distance,
+	     const SteeringMethodPtr_t& steeringMethod) const;
+
           Progressive (const DistancePtr_t& distance,
 		       const SteeringMethodPtr_t& steeringMethod,
 		       value_type step);
@@ -46,7 +50,21 @@ namespace hpp {
 	  bool applyToStraightPath (const StraightPathPtr_t& path,
 				    PathPtr_t& projection) const;
         private:
+          /// Predict the parameter of the next step from q toward target
+          ///
+          /// The projection of the configuration at parameter s moves it by
+          /// about curvature s^2 / 2, the parameter is chosen so that
+          /// s + curvature s^2 / 2 = step_.
+          value_type stepLength (const ConfigProjectorPtr_t& cp,
+              ConfigurationIn_t q, ConfigurationIn_t target) const;
+
           value_type step_;
+          /// Curvature of the constraints of curvatureProjector_ estimated by
+          /// ConfigProjector::curvature, estimated again when a predicted
+          /// step needs to be reduced.
+          mutable value_type curvature_;
+          mutable bool curvatureOutdated_;
+          mutable ConfigProjectorWkPtr_t curvatureProjector_;
       };
     } // namespace pathProjector
   } // namespace core
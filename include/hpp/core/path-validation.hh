@@ -19,6 +19,7 @@
 #ifndef HPP_CORE_PATH_VALIDATION_HH
 # define HPP_CORE_PATH_VALIDATION_HH
 
+# include <vector>
 # include <hpp/core/config.hh>
 # include <hpp/core/fwd.hh>
 # include <hpp/core/deprecated.hh>
@@ -71,6 +72,69 @@ namespace hpp {
 			     PathPtr_t& validPart,
 			     PathValidationReportPtr_t& report) = 0;
 
+      /// Compute the largest valid interval without returning a report
+      ///
+      /// \param path, reverse, validPart see validate.
+      /// \return whether the whole path is valid.
+      ///
+      /// For callers that only use the valid part of the path. This
+      /// implementation calls validate with a report kept between calls, so
+      /// that validations reusing the reports nobody else refers to
+      /// allocate no report when the path is not valid.
+      virtual bool validateWithoutReport (const PathPtr_t& path, bool reverse,
+					  PathPtr_t& validPart)
+      {
+	return validate (path, reverse, validPart, report_);
+      }
+
+      /// Compute whether the whole path is valid
+      ///
+      /// Neither the valid part of the path nor a report are returned.
+      /// \param path the path to check for validity.
+      /// \return whether the whole path is valid.
+      virtual bool isValid (const PathPtr_t& path)
+      {
+	PathPtr_t validPart;
+	return validate (path, false, validPart, report_);
+      }
+
+      /// Compute the largest valid intervals of several paths
+      ///
+      /// \param paths the paths to check for validity,
+      /// \param reverse if true check from the end,
+      /// \param stopAtValid if true, the paths after the first valid path
+      ///        of the vector are not necessarily validated,
+      /// \retval validParts the extracted valid parts of the paths, as
+      ///         computed by validate; empty for paths not validated,
+      /// \retval valid whether each whole path is valid, false for paths
+      ///         not validated.
+      ///
+      /// This implementation validates the paths one after the other.
+      /// Derived classes may validate them in parallel: connection steps
+      /// of roadmap planners test many candidate edges at once.
+      virtual void validateBatch (const Paths_t& paths, bool reverse,
+				  bool stopAtValid, Paths_t& validParts,
+				  std::vector <bool>& valid)
+      {
+	validParts.assign (paths.size (), PathPtr_t ());
+	valid.assign (paths.size (), false);
+	for (std::size_t i = 0; i < paths.size (); ++i) {
+	  valid [i] = validateWithoutReport (paths [i], reverse,
+					     validParts [i]);
+	  if (stopAtValid && valid [i]) return;
+	}
+      }
+
+      /// Get number of threads validating the paths of validateBatch
+      ///
+      /// Callers that can stop at the first valid path or reuse rejected
+      /// paths validate paths one by one when there is only one thread.
+      /// This implementation returns 1.
+      virtual std::size_t numberThreads () const
+      {
+	return 1;
+      }
+
       /// Add an obstacle
       /// \param object obstacle added
       /// \notice collision path validation need to know about obstacles. This
@@ -89,10 +153,50 @@ namespace hpp {
 					    const CollisionObjectPtr_t&)
       {
       }
+
+      /// Remove an obstacle
+      /// \param object obstacle previously added by addObstacle.
+      /// This virtual method does nothing for path validation methods that
+      /// do not care about obstacles.
+      virtual void removeObstacle (const CollisionObjectPtr_t&)
+      {
+      }
+
+      /// Notify that an obstacle has moved
+      /// \param object obstacle previously added by addObstacle, the
+      ///        position of which has changed.
+      /// Results of previous validations that depend on the position of
+      /// the obstacle are forgotten. This virtual method does nothing for
+      /// path validation methods that do not care about obstacles.
+      virtual void obstacleMoved (const CollisionObjectPtr_t&)
+      {
+      }
+
+      /// Set distance field of the static obstacles
+      /// \param field field used to skip collision tests far from the
+      ///        obstacles, empty pointer to disable.
+      /// This virtual method does nothing for path validation methods that
+      /// do not care about obstacles.
+      virtual void distanceField (const DistanceFieldPtr_t&)
+      {
+      }
+
+      /// Create a copy validating paths of another robot
+      /// \param robot copy of the robot the validation applies to.
+      /// \return new instance, or an empty pointer if this validation method
+      ///         cannot be copied.
+      /// \note obstacles are not copied.
+      virtual PathValidationPtr_t copy (const DevicePtr_t&) const
+      {
+	return PathValidationPtr_t ();
+      }
     protected:
-      PathValidation ()
+      PathValidation () : report_ ()
       {
       }
+    private:
+      /// Report reused by validateWithoutReport, isValid and validateBatch
+      PathValidationReportPtr_t report_;
     }; // class PathValidation
     /// \}
   } // namespace core
@@ -19,6 +19,7 @@
 #ifndef HPP_CORE_PATH_VECTOR_HH
 # define HPP_CORE_PATH_VECTOR_HH
 
+# include <vector>
 # include <hpp/model/device.hh>
 # include <hpp/core/fwd.hh>
 # include <hpp/core/path.hh>
@@ -96,19 +97,47 @@ namespace hpp {
       ///         constraints applicable to the PathVector.
       PathPtr_t pathAtRank (std::size_t rank) const;
 
+      /// Get a path in the vector without copying it
+      ///
+      /// \param rank rank of the path in the vector. Should be between 0 and
+      ///        numberPaths ().
+      /// \return the path stored in the vector.
+      /// \note Contrary to pathAtRank, constraints of the PathVector are not
+      ///       applied to the returned path. The path is shared with the
+      ///       vector.
+      const PathPtr_t& pathAtRankNoCopy (std::size_t rank) const
+      {
+	return paths_ [rank];
+      }
+
       /// Get rank of direct path in vector at param
       ///
       /// \param param parameter in interval of definition,
       /// \retval localParam parameter on sub-path
       /// \return rank of direct path in vector
+      /// \note The rank found by the previous call and the next one are
+      ///       tested first, so that sampling the path in increasing or
+      ///       decreasing order costs constant time per sample. Otherwise,
+      ///       the rank is found by binary search.
       std::size_t rankAtParam (const value_type& param, value_type& localParam) const;
 
       /// Append a path at the end of the vector
       void appendPath (const PathPtr_t& path);
 
       /// Concatenate two vectors of path
+      ///
+      /// Paths of the input vector are copied.
       void concatenate (const PathVector& path);
 
+      /// Concatenate two vectors of path without copying
+      ///
+      /// If the input vector is not subject to constraints, its paths are
+      /// appended without copy and become shared by both vectors. The input
+      /// vector is meant to be dropped afterwards, as a result of extract
+      /// for instance. Otherwise, paths are copied as in
+      /// concatenate (const PathVector&).
+      void concatenate (const PathVectorPtr_t& path);
+
       /// Extraction of a sub-path
       /// \param subInterval interval of definition of the extract path
       virtual PathPtr_t extract (const interval_t& subInterval) const;
@@ -145,12 +174,12 @@ namespace hpp {
       /// Constructor
       PathVector (std::size_t outputSize, std::size_t outputDerivativeSize) :
 	parent_t (std::make_pair (0, 0), outputSize, outputDerivativeSize),
-	paths_ ()
+	paths_ (), ends_ (), lastRank_ (0)
 	  {
 	  }
       ///Copy constructor
       PathVector (const PathVector& path) : parent_t (path),
-	paths_ ()
+	paths_ (), ends_ (path.ends_), lastRank_ (0)
 	  {
 	    timeRange_ = path.timeRange_;
 	    for (Paths_t::const_iterator it = path.paths_.begin ();
@@ -162,7 +191,8 @@ namespace hpp {
       ///Copy constructor with constraints
       PathVector (const PathVector& path,
 		  const ConstraintSetPtr_t& constraints) :
-	parent_t (path, constraints), paths_ ()
+	parent_t (path, constraints), paths_ (), ends_ (path.ends_),
+	lastRank_ (0)
 	  {
 	    timeRange_ = path.timeRange_;
 	    for (Paths_t::const_iterator it = path.paths_.begin ();
@@ -177,9 +207,22 @@ namespace hpp {
 	weak_ = self;
       }
       virtual bool impl_compute (ConfigurationOut_t result, value_type t) const;
+      /// Successive parameters on the same sub-path are evaluated together
+      virtual void impl_eval (vectorIn_t times, matrixOut_t configurations,
+			      std::vector <bool>& success) const;
+      /// Maximal velocity bounds of the paths overlapping the interval
+      virtual bool impl_velocityBound (vectorOut_t result, value_type t0,
+				       value_type t1) const;
+      /// Size of this vector and of the paths it contains
+      virtual std::size_t impl_memoryUsage () const;
 
     private:
       Paths_t paths_;
+      /// Parameter at the end of each path, from the beginning of the vector
+      std::vector <value_type> ends_;
+      /// Rank returned by the last call to rankAtParam, only used as a hint:
+      /// any value gives the right result.
+      mutable std::size_t lastRank_;
       PathVectorWkPtr_t weak_;
     }; // class PathVector
   } //   namespace core
@@ -19,6 +19,8 @@
 #ifndef HPP_CORE_PATH_HH
 # define HPP_CORE_PATH_HH
 
+# include <algorithm>
+# include <vector>
 # include <boost/concept_check.hpp>
 # include <hpp/core/fwd.hh>
 # include <hpp/core/config.hh>
@@ -114,6 +116,60 @@ namespace hpp {
       /// \return true if everything went good.
       virtual bool impl_compute (ConfigurationOut_t configuration,
 				 value_type t) const = 0;
+
+      /// Evaluate the path at several parameters
+      ///
+      /// \param times parameters in the interval of definition,
+      /// \retval configurations matrix with outputSize () rows and
+      ///         times.size () columns, column i is filled with the
+      ///         configuration at parameter times [i],
+      /// \retval success success [i] is true if evaluation at times [i]
+      ///         succeeded, including the application of the constraints.
+      /// \note Parameters in increasing order are evaluated faster by some
+      ///       types of paths.
+      void eval (vectorIn_t times, matrixOut_t configurations,
+		 std::vector <bool>& success) const
+      {
+	assert (configurations.rows () == outputSize ());
+	assert (configurations.cols () == times.size ());
+	success.resize (times.size ());
+	impl_eval (times, configurations, success);
+	if (!constraints_) return;
+	for (size_type i = 0; i < times.size (); ++i) {
+	  if (success [i]) {
+	    success [i] = constraints_->apply (configurations.col (i));
+	  }
+	}
+      }
+
+      /// \brief Evaluation at several parameters without applying constraints
+      ///
+      /// \param times, configurations, success see eval,
+      /// \precond success.size () == times.size ().
+      /// The default implementation calls impl_compute for each parameter.
+      virtual void impl_eval (vectorIn_t times, matrixOut_t configurations,
+			      std::vector <bool>& success) const
+      {
+	for (size_type i = 0; i < times.size (); ++i) {
+	  success [i] = impl_compute (configurations.col (i), times [i]);
+	}
+      }
+
+      /// Get upper bounds of the velocities of the degrees of freedom
+      ///
+      /// \param t0, t1 bounds of a sub-interval of the interval of definition,
+      /// \retval result vector of size outputDerivativeSize (), upper bounds
+      ///         of the absolute values of the components of the derivative
+      ///         of the path over [t0, t1].
+      /// \return whether bounds are provided for this type of path.
+      /// \note constraints are not taken into account.
+      bool velocityBound (vectorOut_t result, value_type t0, value_type t1)
+	const
+      {
+	assert (result.size () == outputDerivativeSize ());
+	if (t1 < t0) std::swap (t0, t1);
+	return impl_velocityBound (result, t0, t1);
+      }
       /// \name Constraints
       /// \{
 
@@ -148,6 +204,13 @@ namespace hpp {
 	return timeRange_.second - timeRange_.first;
       }
 
+      /// Get estimate of the memory used by the path in bytes
+      ///
+      /// Includes the copy of the constraints owned by the path and, for
+      /// paths made of other paths like PathVector, the memory of these
+      /// paths. The robot is not counted.
+      std::size_t memoryUsage () const;
+
       /// Get the initial configuration
       virtual Configuration_t initial () const = 0;
 
@@ -158,6 +221,28 @@ namespace hpp {
       /// Print path in a stream
       virtual std::ostream& print (std::ostream &os) const = 0;
 
+      /// Compute upper bounds of the velocities of the degrees of freedom
+      ///
+      /// \param t0, t1 bounds of a sub-interval, t0 <= t1.
+      /// \sa velocityBound
+      /// The default implementation does not provide bounds and returns
+      /// false.
+      virtual bool impl_velocityBound (vectorOut_t, value_type, value_type)
+	const
+      {
+	return false;
+      }
+
+      /// Get estimate of the memory used by the path without constraints
+      ///
+      /// \sa memoryUsage
+      /// The default implementation returns the size of this class: derived
+      /// classes reimplement it to add the size of their members.
+      virtual std::size_t impl_memoryUsage () const
+      {
+	return sizeof (Path);
+      }
+
       /// Constructor
       /// \param interval interval of definition of the path,
       /// \param outputSize size of the output configuration,
@@ -32,6 +32,15 @@ namespace hpp {
     ///
     /// Plans a path and iteratively applies a series of optimizer on
     /// the result.
+    ///
+    /// The budgets of method solve only bound path planning. Each optimizer
+    /// is bounded by its own budget (see PathOptimizer::timeOut,
+    /// PathOptimizer::maxIterations and
+    /// PathOptimizer::minRelativeImprovement), and the whole optimization
+    /// by optimizationTimeOut.
+    ///
+    /// Adding a pathOptimization::TimeParameterization as the last
+    /// optimizer makes the result a path parameterized by time.
     class HPP_CORE_DLLAPI PlanAndOptimize : public PathPlanner
     {
     public:
@@ -41,15 +50,33 @@ namespace hpp {
       virtual void startSolve ();
       /// One iteration of path planning or path optimization
       virtual void oneStep ();
+      /// Call internal path planner implementation
+      virtual void pruneRoadmap ();
       /// Optimize planned path
       virtual PathVectorPtr_t finishSolve (const PathVectorPtr_t& path);
       void addPathOptimizer (const PathOptimizerPtr_t& optimizer);
+      /// Set maximal duration of method finishSolve
+      /// \param seconds duration in seconds, infinity for no limit.
+      ///
+      /// Each optimizer is given the time remaining when it starts, if
+      /// smaller than its own time out. Optimizers that start after the
+      /// duration is exceeded are skipped.
+      void optimizationTimeOut (value_type seconds)
+      {
+	optimizationTimeOut_ = seconds;
+      }
+      /// Get maximal duration of method finishSolve in seconds
+      value_type optimizationTimeOut () const
+      {
+	return optimizationTimeOut_;
+      }
     protected:
       PlanAndOptimize (const PathPlannerPtr_t& pathPlanner);
     private:
       typedef std::vector <PathOptimizerPtr_t> Optimizers_t;
       const PathPlannerPtr_t pathPlanner_;
       Optimizers_t optimizers_;
+      value_type optimizationTimeOut_;
     }; // class PlanAndOptimize
     /// \}
   } // namespace core
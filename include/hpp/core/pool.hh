@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_POOL_HH
+# define HPP_CORE_POOL_HH
+
+# include <new>
+# include <vector>
+# include <algorithm>
+# include <functional>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup roadmap
+    /// \{
+
+    /// Storage of objects of the same type in contiguous blocks
+    ///
+    /// Objects are constructed in place in blocks of memory allocated once.
+    /// Clearing the pool keeps the blocks for the objects created afterwards,
+    /// so that building and clearing large roadmaps does not call the memory
+    /// allocator for each object. Memory of destroyed objects is reused by
+    /// the next allocations.
+    template <typename T> class Pool
+    {
+    public:
+      /// Constructor
+      /// \param blockSize number of objects stored in each block of memory.
+      Pool (std::size_t blockSize = 1024) : allocatedBlocks_ (), blocks_ (),
+	free_ (), blockSize_ (blockSize), size_ (0)
+      {
+      }
+
+      /// Destructor
+      /// \note Destructors of objects still in the pool are not called.
+      ~Pool ()
+      {
+	for (typename std::vector <T*>::iterator it = blocks_.begin ();
+	     it != blocks_.end (); ++it) {
+	  ::operator delete (*it);
+	}
+      }
+
+      /// Get memory for a new object
+      ///
+      /// \return uninitialized memory, where the object should be
+      ///         constructed with placement new.
+      void* allocate ()
+      {
+	if (!free_.empty ()) {
+	  T* result = free_.back ();
+	  free_.pop_back ();
+	  return result;
+	}
+	std::size_t block = size_ / blockSize_;
+	if (block == allocatedBlocks_.size ()) {
+	  T* memory = static_cast <T*>
+	    (::operator new (blockSize_ * sizeof (T)));
+	  allocatedBlocks_.push_back (memory);
+	  blocks_.insert (std::upper_bound (blocks_.begin (), blocks_.end (),
+					    memory, std::less <T*> ()),
+			  memory);
+	}
+	T* result = allocatedBlocks_ [block] + (size_ % blockSize_);
+	++size_;
+	return result;
+      }
+
+      /// Whether an object has been allocated in the pool
+      bool owns (const T* object) const
+      {
+	typename std::vector <T*>::const_iterator it = std::upper_bound
+	  (blocks_.begin (), blocks_.end (), const_cast <T*> (object),
+	   std::less <T*> ());
+	if (it == blocks_.begin ()) return false;
+	--it;
+	return std::less <const T*> () (object, *it + blockSize_);
+      }
+
+      /// Destroy an object allocated in the pool
+      ///
+      /// Memory is reused by the next call to allocate.
+      void destroy (T* object)
+      {
+	object->~T ();
+	free_.push_back (object);
+      }
+
+      /// Make all the memory of the pool available for new objects
+      ///
+      /// \note objects should have been destroyed before.
+      void clear ()
+      {
+	free_.clear ();
+	size_ = 0;
+      }
+
+      /// Number of objects in the pool
+      std::size_t size () const
+      {
+	return size_ - free_.size ();
+      }
+
+      /// Memory allocated by the pool in bytes
+      std::size_t memoryUsage () const
+      {
+	return (allocatedBlocks_.size () + blocks_.size () +
+		free_.capacity ()) * sizeof (T*) +
+	  allocatedBlocks_.size () * blockSize_ * sizeof (T);
+      }
+
+    private:
+      Pool (const Pool&);
+      Pool& operator= (const Pool&);
+      // Blocks in order of allocation
+      std::vector <T*> allocatedBlocks_;
+      // Blocks sorted by address
+      std::vector <T*> blocks_;
+      // Memory of destroyed objects, before the next call to clear
+      std::vector <T*> free_;
+      std::size_t blockSize_;
+      std::size_t size_;
+    }; // class Pool
+    /// \}
+  } //   namespace core
+} // namespace hpp
+#endif // HPP_CORE_POOL_HH
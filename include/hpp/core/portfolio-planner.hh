@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_PORTFOLIO_PLANNER_HH
+# define HPP_CORE_PORTFOLIO_PLANNER_HH
+
+# include <vector>
+# include <boost/function.hpp>
+# include <boost/thread/mutex.hpp>
+# include <hpp/core/path-planner.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup path_planning
+    /// \{
+
+    /// Race between several path planners
+    ///
+    /// Each step runs several path planners in parallel threads until one of
+    /// them finds a solution. Each planner solves a copy of the problem
+    /// (see Problem::cloneForThread) in its own roadmap. Other planners are
+    /// stopped after their current step and the solution is inserted in the
+    /// roadmap as an edge between the initial node and a goal node.
+    ///
+    /// A copy of the problem the shooter of which is a
+    /// BasicConfigurationShooter gets a SeededConfigurationShooter seeded
+    /// by the problem, so that the threads do not share the generator of
+    /// the C library.
+    class HPP_CORE_DLLAPI PortfolioPlanner : public PathPlanner
+    {
+    public:
+      typedef boost::function < PathPlannerPtr_t (const Problem&,
+						  const RoadmapPtr_t&) >
+	PlannerBuilder_t;
+      /// Return shared pointer to new object.
+      static PortfolioPlannerPtr_t createWithRoadmap
+	(const Problem& problem, const RoadmapPtr_t& roadmap);
+      /// Return shared pointer to new object.
+      static PortfolioPlannerPtr_t create (const Problem& problem);
+      /// Add a planner to the portfolio
+      /// \param builder function that creates the planner from a problem and
+      ///        a roadmap.
+      ///
+      /// The same builder can be added several times to run several
+      /// instances of a planner.
+      void addPlannerType (const PlannerBuilder_t& builder)
+      {
+	builders_.push_back (builder);
+      }
+      /// Remove all planners from the portfolio
+      void resetPlannerTypes ()
+      {
+	builders_.clear ();
+      }
+      /// Get number of planners in the portfolio
+      std::size_t numberPlanners () const
+      {
+	return builders_.size ();
+      }
+      /// Run planners until one of them finds a solution
+      /// \throw std::runtime_error with the error of each planner if all
+      ///        planners failed.
+      virtual void oneStep ();
+      /// Interrupt path planning
+      virtual void interrupt ();
+    protected:
+      /// Constructor
+      PortfolioPlanner (const Problem& problem, const RoadmapPtr_t& roadmap);
+      /// Constructor with roadmap
+      PortfolioPlanner (const Problem& problem);
+      /// Store weak pointer to itself
+      void init (const PortfolioPlannerWkPtr_t& weak);
+    private:
+      /// Solve the problem with one planner, in a worker thread
+      void run (const PathPlannerPtr_t& planner, std::size_t rank);
+      /// Whether a planner found a solution or planning is interrupted
+      bool finished ();
+
+      std::vector <PlannerBuilder_t> builders_;
+      PortfolioPlannerWkPtr_t weakPtr_;
+      /// Protects members below during the race
+      boost::mutex mutex_;
+      bool finished_;
+      PathVectorPtr_t solution_;
+      std::vector <std::string> errors_;
+    }; // class PortfolioPlanner
+    /// \}
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_PORTFOLIO_PLANNER_HH
@@ -23,11 +23,15 @@
 
 # include <hpp/model/fwd.hh>
 # include <boost/function.hpp>
+# include <boost/thread/thread.hpp>
+# include <boost/thread/mutex.hpp>
 # include <hpp/core/deprecated.hh>
 # include <hpp/core/problem.hh>
 # include <hpp/core/fwd.hh>
 # include <hpp/core/config.hh>
 # include <hpp/core/config-projector.hh>
+# include <hpp/core/operation-counters.hh>
+# include <hpp/core/query-record.hh>
 
 namespace hpp {
   namespace core {
@@ -52,6 +56,11 @@ namespace hpp {
 	PathProjectorBuilder_t;
       typedef boost::function <ConfigurationShooterPtr_t (const DevicePtr_t&) >
 	ConfigurationShooterBuilder_t;
+      typedef boost::function <NearestNeighborPtr_t (const DevicePtr_t&,
+						     const DistancePtr_t&) >
+	NearestNeighborBuilder_t;
+      typedef boost::function <void (const PathVectorPtr_t&) >
+	PathCallback_t;
 
       typedef std::vector <PathOptimizerPtr_t> PathOptimizers_t;
       typedef std::vector <std::string> PathOptimizerTypes_t;
@@ -111,6 +120,22 @@ namespace hpp {
       {
 	pathPlannerFactory_ [type] = builder;
       }
+      /// Add a path planner type to the planners run by PortfolioPlanner
+      /// \param type name of a path planner type.
+      ///
+      /// A type can be added several times to run several instances of the
+      /// same planner.
+      void addPortfolioPlannerType (const std::string& type);
+      /// Remove all planner types run by PortfolioPlanner
+      void resetPortfolioPlannerTypes ()
+      {
+	portfolioPlannerTypes_.clear ();
+      }
+      /// Get path planner types run by PortfolioPlanner
+      const std::vector <std::string>& portfolioPlannerTypes () const
+      {
+	return portfolioPlannerTypes_;
+      }
       /// Get path planner
       const PathPlannerPtr_t& pathPlanner () const
       {
@@ -153,6 +178,38 @@ namespace hpp {
       void pathValidationType (const std::string& type,
 			       const value_type& tolerance);
 
+      /// Set maximal number of path validation results stored
+      /// \param size maximal number of results, 0 (default) for no storage.
+      ///
+      /// If positive, the path validation of the problem is a
+      /// CachedPathValidation wrapping the method set by pathValidationType,
+      /// so that path optimizers do not validate again the segments already
+      /// validated by the path planner or by the previous optimizers.
+      void pathValidationCacheSize (std::size_t size);
+
+      /// Get maximal number of path validation results stored
+      std::size_t pathValidationCacheSize () const
+      {
+	return pathValidationCacheSize_;
+      }
+
+      /// Set resolution of the distance field of the obstacles
+      /// \param resolution length of the edges of the voxels, 0 (default)
+      ///        to disable the field.
+      ///
+      /// If positive, a DistanceField of the collision obstacles is
+      /// computed before solving, after obstacles are added, removed or
+      /// moved, and passed to the path and configuration validations of
+      /// the problem, see Problem::distanceField. Collision tests far from
+      /// the obstacles are then skipped.
+      void distanceFieldResolution (value_type resolution);
+
+      /// Get resolution of the distance field of the obstacles
+      value_type distanceFieldResolution () const
+      {
+	return distanceFieldResolution_;
+      }
+
       /// Add a path validation type
       /// \param type name of the new path validation method,
       /// \param static method that creates a path validation with a robot
@@ -184,6 +241,97 @@ namespace hpp {
 	return roadmap_;
       }
 
+      /// Set nearest neighbor search method of the roadmap
+      /// \param type name of the method, "KDTree" (default) or "Basic".
+      /// \note the roadmap is reset if a problem is defined.
+      void nearestNeighborType (const std::string& type);
+
+      /// Set approximation factor of nearest neighbor searches
+      /// \param epsilon nodes returned by nearest neighbor searches are at
+      ///        most 1 + epsilon farther than the exact nearest nodes. 0
+      ///        (default) means exact search.
+      /// \note Searches used to detect configurations already in the roadmap
+      ///       are always exact.
+      void nearestNeighborEpsilon (const value_type& epsilon);
+
+      /// Get approximation factor of nearest neighbor searches
+      value_type nearestNeighborEpsilon () const
+      {
+	return nearestNeighborEpsilon_;
+      }
+
+      /// Set whether the roadmap is kept between queries
+      ///
+      /// If true, adding or moving an obstacle removes the roadmap edges in
+      /// collision with the obstacle instead of resetting the roadmap, and
+      /// paths are found in the roadmap by an incremental search that reuses
+      /// the result of the previous query (see Roadmap::shortestPath). The
+      /// swept volumes of the edges are indexed (see Roadmap::indexEdges).
+      /// Default is false.
+      void multiQuery (bool multiQuery);
+
+      /// Get whether the roadmap is kept between queries
+      bool multiQuery () const
+      {
+	return multiQuery_;
+      }
+
+      /// Set seed of the random number generator of the problem
+      ///
+      /// The problem is reseeded, see Problem::seed, and so are the problems
+      /// created later by resetProblem. The default seed is 5489, so that
+      /// solve is reproducible given the parameters of the problem solver.
+      void seed (unsigned int seed);
+      /// Get seed of the random number generator of the problem
+      unsigned int seed () const
+      {
+	return seed_;
+      }
+
+      /// Set whether the objects created by solve are kept between queries
+      ///
+      /// If true, the configuration shooter, the path planner and the path
+      /// projector created by solve and prepareSolveStepByStep are reused
+      /// by the next calls, as long as the problem, the roadmap and the
+      /// types of these objects do not change. Only init and goal
+      /// configurations are reset at each query. Default is false.
+      /// \note call resetSolveComponents after modifying the bounds of the
+      ///       robot or the builders of the factories.
+      void keepSolveComponents (bool keep)
+      {
+	keepSolveComponents_ = keep;
+      }
+      /// Get whether the objects created by solve are kept between queries
+      bool keepSolveComponents () const
+      {
+	return keepSolveComponents_;
+      }
+      /// Create the objects used by solve again at the next query
+      void resetSolveComponents ()
+      {
+	solveComponents_ = SolveComponents ();
+      }
+
+      /// Create a pool of problems solving queries concurrently
+      /// \param numberContexts number of copies of the problem, see
+      ///        Problem::cloneForThread.
+      ///
+      /// The contexts of the pool use the current path planner, path
+      /// optimizer, configuration shooter and path projector types and the
+      /// planning budget. They share the obstacles with the problem.
+      /// \throw std::runtime_error if the problem is not defined.
+      SolverPoolPtr_t createSolverPool (std::size_t numberContexts);
+
+      /// Add a nearest neighbor search method
+      /// \param type name of the new method,
+      /// \param static method that creates a nearest neighbor object with a
+      /// robot and a distance as input.
+      void addNearestNeighborType (const std::string& type,
+				   const NearestNeighborBuilder_t& builder)
+      {
+	nearestNeighborFactory_ [type] = builder;
+      }
+
       /// \name Constraints
       /// \{
 
@@ -363,6 +511,41 @@ namespace hpp {
       }
       /// \}
 
+      /// \name Budgets of path planning and optimization
+      /// \{
+
+      /// Set maximal duration of path planning in method solve
+      /// \param seconds duration in seconds, infinity for no limit.
+      void planningTimeOut (value_type seconds)
+      {
+	planningTimeOut_ = seconds;
+      }
+      /// Get maximal duration of path planning in seconds
+      value_type planningTimeOut () const
+      {
+	return planningTimeOut_;
+      }
+      /// Set maximal number of iterations of path planning in method solve
+      /// \param iterations number of iterations, 0 for no limit.
+      void maxPlanningIterations (size_type iterations)
+      {
+	maxPlanningIterations_ = iterations;
+      }
+      /// Get maximal number of iterations of path planning
+      size_type maxPlanningIterations () const
+      {
+	return maxPlanningIterations_;
+      }
+      /// Set maximal duration of each path optimizer
+      /// \param seconds duration in seconds, infinity for no limit.
+      void optimizerTimeOut (value_type seconds);
+      /// Get maximal duration of each path optimizer in seconds
+      value_type optimizerTimeOut () const
+      {
+	return optimizerTimeOut_;
+      }
+      /// \}
+
       /// Create new problem.
       virtual void resetProblem ();
 
@@ -396,9 +579,29 @@ namespace hpp {
       virtual void finishSolveStepByStep ();
 
       /// Set and solve the problem
+      /// \throw std::runtime_error if a query solved by solveAsync is
+      ///        running.
       virtual void solve ();
 
+      /// Set the problem and solve it in a background thread
+      ///
+      /// Run path planning with the budgets set by planningTimeOut and
+      /// maxPlanningIterations, then the path optimizers. The problem
+      /// solver should not be modified until the query is done.
+      /// \return handle to poll the progress, cancel the query and get
+      ///         the path. Unlike with solve, paths are not added to
+      ///         paths: see addPath.
+      /// \throw std::runtime_error if a query solved by solveAsync is
+      ///        running.
+      ///
+      /// Path planning and optimization check the cancellation token of the
+      /// query instead of throwing on interruption, see
+      /// PathPlanner::trySolve.
+      SolveFuturePtr_t solveAsync ();
+
       /// Interrupt path planning and path optimization
+      ///
+      /// The query solved by solveAsync, if any, is cancelled.
       void interrupt ();
 
       /// Add a path
@@ -414,6 +617,98 @@ namespace hpp {
       }
       /// \}
 
+      /// \name Anytime path optimization
+      /// \{
+
+      /// Set whether path optimization runs in background
+      ///
+      /// If true, method solve returns as soon as a path is planned and path
+      /// optimizers are run in a separate thread. Each improved path is
+      /// published through bestPath and the callback set by
+      /// pathImprovedCallback.
+      /// \note the problem should not be modified while optimizing.
+      void anytime (bool anytime)
+      {
+	anytime_ = anytime;
+      }
+      /// Get whether path optimization runs in background
+      bool anytime () const
+      {
+	return anytime_;
+      }
+      /// Set function called each time a better path is found
+      ///
+      /// \note in anytime mode, the function is called by the optimization
+      ///       thread.
+      void pathImprovedCallback (const PathCallback_t& callback);
+      /// Get best path found so far by the latest call to solve
+      PathVectorPtr_t bestPath () const;
+      /// Whether path optimization is running in background
+      bool optimizing () const;
+      /// Wait for the end of path optimization running in background
+      ///
+      /// Paths found by the optimizers are then appended to paths.
+      void waitOptimization ();
+      /// Interrupt path optimization running in background and wait for it
+      void stopOptimization ();
+      /// \}
+
+      /// \name Operation counters
+      /// \{
+
+      /// Enable or disable counting of operations
+      /// \sa OperationCounters
+      void countOperations (bool enable)
+      {
+	OperationCounters::enable (enable);
+      }
+      /// Get numbers of operations performed by the latest call to solve
+      ///
+      /// Operations are counted from the beginning of planning to the end of
+      /// path optimization, or to the end of planning in anytime mode. The
+      /// vector is indexed by OperationCounters::Operation and is empty if
+      /// counting was disabled.
+      const OperationCounters::Values_t& operationCounts () const
+      {
+	return operationCounts_;
+      }
+      /// \}
+
+      /// \name Query records
+      /// \{
+
+      /// Record the next calls to solve in a file
+      ///
+      /// Each call to solve overwrites the file with a QueryRecord of the
+      /// query. The problem is reseeded by a seed stored in the record so
+      /// that the query can be replayed.
+      /// \param filename name of the file, empty to stop recording.
+      void recordQueries (const std::string& filename)
+      {
+	recordFilename_ = filename;
+      }
+      /// Get name of the file in which queries are recorded
+      const std::string& recordQueries () const
+      {
+	return recordFilename_;
+      }
+      /// Replay a recorded query
+      ///
+      /// The parameters of the recorded query are set, the problem is
+      /// seeded by the recorded seed and solve is called. The breakdowns of
+      /// the events of the recorded and of the new query are printed.
+      /// \param filename file written by a recording solve,
+      /// \param os stream where breakdowns are printed,
+      /// \return the record of the new query.
+      /// \note The robot and the obstacles are not recorded: they must be
+      ///       the same as for the recorded query. Neither are the roadmap
+      ///       kept in multi-query mode nor the solve components kept
+      ///       between queries, that make the replay differ.
+      /// \throw std::runtime_error if the file cannot be read.
+      QueryRecord replay (const std::string& filename,
+			  std::ostream& os = std::cout);
+      /// \}
+
       /// \name Obstacles
       /// \{
 
@@ -432,6 +727,22 @@ namespace hpp {
       void removeObstacleFromJoint (const std::string& jointName,
 				    const std::string& obstacleName);
 
+      /// Remove an obstacle
+      /// \param name name of the obstacle.
+      ///
+      /// Edges of the roadmap remain valid and are kept.
+      /// \throw std::runtime_error if no obstacle has this name.
+      void removeObstacle (const std::string& name);
+
+      /// Update the problem after an obstacle has moved
+      /// \param name name of the obstacle the position of which has changed.
+      ///
+      /// In multi-query mode, edges of the roadmap in collision with the
+      /// obstacle at its new position are removed. Otherwise, the roadmap
+      /// is reset.
+      /// \throw std::runtime_error if no obstacle has this name.
+      void obstacleMoved (const std::string& name);
+
       /// Get obstacle by name
       const CollisionObjectPtr_t& obstacle (const std::string& name);
 
@@ -508,6 +819,42 @@ namespace hpp {
       /// Path planner
       std::string pathPlannerType_;
     private:
+      /// Create path validation of the problem
+      PathValidationPtr_t createPathValidation () const;
+      /// Set configuration shooter, path planner and path projector before
+      /// solving, see keepSolveComponents.
+      void prepareSolveComponents ();
+      /// Parameters the objects kept between queries were created with
+      struct SolveComponents
+      {
+	SolveComponents () : problem (0x0), roadmap (), pathPlannerType (),
+	  configurationShooterType (), pathProjectorType (),
+	  pathProjectorTolerance (0), portfolioPlannerTypes ()
+	{
+	}
+	bool operator== (const SolveComponents& other) const
+	{
+	  return problem == other.problem && roadmap == other.roadmap &&
+	    pathPlannerType == other.pathPlannerType &&
+	    configurationShooterType == other.configurationShooterType &&
+	    pathProjectorType == other.pathProjectorType &&
+	    pathProjectorTolerance == other.pathProjectorTolerance &&
+	    portfolioPlannerTypes == other.portfolioPlannerTypes;
+	}
+	ProblemPtr_t problem;
+	RoadmapPtr_t roadmap;
+	std::string pathPlannerType;
+	std::string configurationShooterType;
+	std::string pathProjectorType;
+	value_type pathProjectorTolerance;
+	std::vector <std::string> portfolioPlannerTypes;
+      }; // struct SolveComponents
+      /// Read the bounds of the robot in joint bound validations of the
+      /// problem, since they may have been modified since the creation of
+      /// the problem.
+      void updateJointBounds () const;
+      /// Compute the distance field if needed and pass it to the problem
+      void updateDistanceField ();
       /// Map (string , constructor of path planner)
       typedef std::map < std::string, PathPlannerBuilder_t >
 	PathPlannerFactory_t;
@@ -520,6 +867,9 @@ namespace hpp {
       /// Map (string , constructor of configuration shooter method)
       typedef std::map <std::string, ConfigurationShooterBuilder_t >
         ConfigurationShooterFactory_t;
+      /// Map (string , constructor of nearest neighbor method)
+      typedef std::map <std::string, NearestNeighborBuilder_t >
+        NearestNeighborFactory_t;
 
       /// Shared pointer to initial configuration.
       ConfigurationPtr_t initConf_;
@@ -534,8 +884,12 @@ namespace hpp {
       std::string pathValidationType_;
       /// Tolerance of path validation
       value_type pathValidationTolerance_;
+      /// Maximal number of path validation results stored
+      std::size_t pathValidationCacheSize_;
       /// Path planner factory
       PathPlannerFactory_t pathPlannerFactory_;
+      /// Path planner types run by PortfolioPlanner
+      std::vector <std::string> portfolioPlannerTypes_;
       /// Configuration shooter factory
       ConfigurationShooterFactory_t configurationShooterFactory_;
       /// Path optimizer factory
@@ -547,10 +901,18 @@ namespace hpp {
       ObjectVector_t distanceObstacles_;
       /// Map of obstacles by names
       std::map <std::string, CollisionObjectPtr_t> obstacleMap_;
+      /// Resolution of the distance field, 0 if disabled
+      value_type distanceFieldResolution_;
+      /// Distance field of collisionObstacles_, computed before solving
+      DistanceFieldPtr_t distanceField_;
       // Tolerance for numerical constraint resolution
       value_type errorThreshold_;
       // Maximal number of iterations for numerical constraint resolution
       size_type maxIterations_;
+      // Budgets of path planning and of each path optimizer
+      value_type planningTimeOut_;
+      size_type maxPlanningIterations_;
+      value_type optimizerTimeOut_;
       /// Map of constraints
       NumericalConstraintMap_t numericalConstraintMap_;
       /// Map of passive dofs
@@ -559,6 +921,66 @@ namespace hpp {
       CenterOfMassComputationMap_t comcMap_;
       /// Computation of distances to obstacles
       DistanceBetweenObjectsPtr_t distanceBetweenObjects_;
+      /// Nearest neighbor method of the roadmap
+      std::string nearestNeighborType_;
+      /// Nearest neighbor factory
+      NearestNeighborFactory_t nearestNeighborFactory_;
+      /// Approximation factor of nearest neighbor searches
+      value_type nearestNeighborEpsilon_;
+      /// Whether the roadmap is kept between queries
+      bool multiQuery_;
+      /// Seed of the random number generator of the problem
+      unsigned int seed_;
+      /// Whether objects created by solve are kept between queries
+      bool keepSolveComponents_;
+      /// Parameters of the objects kept, empty if none
+      SolveComponents solveComponents_;
+      /// Whether path optimization runs in background
+      bool anytime_;
+      PathCallback_t pathCallback_;
+      /// Best path found by latest call to solve
+      PathVectorPtr_t bestPath_;
+      /// Paths found by optimization running in background, not yet
+      /// appended to paths_
+      PathVectors_t optimizedPaths_;
+      bool optimizing_;
+      bool stopOptimization_;
+      boost::shared_ptr <boost::thread> optimizationThread_;
+      /// Protects pathCallback_, bestPath_, optimizedPaths_, optimizing_
+      /// and stopOptimization_
+      mutable boost::mutex pathMutex_;
+      /// Numbers of operations performed by latest call to solve
+      OperationCounters::Values_t operationCounts_;
+      /// File where queries are recorded, empty if none
+      std::string recordFilename_;
+
+      /// Query solved by solveAsync, empty if none
+      SolveFuturePtr_t solveFuture_;
+      /// Thread running solveFuture_
+      boost::shared_ptr <boost::thread> solveThread_;
+
+      /// Run path optimizers on path and publish the results
+      void runPathOptimizers (PathVectorPtr_t path);
+      /// Set init and goal configurations and budgets of path planning
+      void setPlanningQuery ();
+      /// Solve a query started by solveAsync, in the solving thread
+      void runSolveAsync (SolveFuturePtr_t future);
+      /// Wait for the thread of the latest query started by solveAsync
+      /// \throw std::runtime_error if the query is running.
+      void joinSolveThread ();
+      /// Set cancellation token of the path planner and optimizers
+      void cancellationToken (const CancellationTokenPtr_t& token);
+      /// Publish a path better than the previous ones
+      void publishPath (const PathVectorPtr_t& path);
+
+      /// Remove edges of the roadmap that are not valid anymore
+      /// \param obstacles obstacles added or moved, see
+      ///        Roadmap::removeInvalidEdges.
+      void removeInvalidEdges (const ObjectVector_t& obstacles);
+      /// Create a portfolio of planners of types portfolioPlannerTypes_
+      PathPlannerPtr_t createPortfolioPlanner (const Problem& problem,
+					       const RoadmapPtr_t& roadmap)
+	const;
       /// Store latest instance created by static method create
       static ProblemSolverPtr_t latest_;
     }; // class ProblemSolver
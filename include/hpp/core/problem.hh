@@ -20,6 +20,7 @@
 #ifndef HPP_CORE_PROBLEM_HH
 # define HPP_CORE_PROBLEM_HH
 
+# include <boost/random/mersenne_twister.hpp>
 # include <hpp/model/device.hh>
 # include <hpp/util/pointer.hh>
 
@@ -148,6 +149,29 @@ namespace hpp {
       }
       /// \}
 
+      /// \name Random number generation
+      /// \{
+
+      /// Reset random number generator of the problem
+      ///
+      /// The generator of the problem seeds the generators of the
+      /// configuration shooter, of the path planners and of the path
+      /// optimizers created with the problem, so that a planning session is
+      /// reproducible given the seed. The configuration shooter of the
+      /// problem is reseeded.
+      void seed (unsigned int seed);
+      /// Draw a seed for the random number generator of a component
+      ///
+      /// Components created with the problem draw their seed at
+      /// construction, so that they do not share a sequence.
+      /// \note not thread safe: the problems of worker threads have their
+      ///       own generator, see cloneForThread.
+      unsigned int drawSeed () const
+      {
+	return generator_ ();
+      }
+      /// \}
+
       /// \name Path projector
       /// \{
       /// Set path projector method
@@ -186,6 +210,27 @@ namespace hpp {
       /// Check that problem is well formulated
       virtual void checkProblem () const;
 
+      /// Create a copy of the problem for a worker thread
+      ///
+      /// The robot is cloned. Distance, steering method, validation methods,
+      /// configuration shooter, constraints and path projector of the copy
+      /// apply to the clone of the robot. Obstacles are shared but not
+      /// modified by collision checking.
+      /// \return new problem that the caller should delete.
+      /// \throw std::runtime_error if a validation method or the path
+      ///        projector cannot be copied, see ConfigValidation::copy,
+      ///        PathValidation::copy and PathProjector::copy, or if the
+      ///        constraints contain numerical constraints without function
+      ///        builder, see NumericalConstraint::functionBuilder.
+      /// The random number generator of the copy is seeded by the
+      /// generator of this problem, so that threads draw independent
+      /// sequences, reproducible given the seed of this problem.
+      /// \note a steering method other than SteeringMethodStraight is copied
+      ///       by SteeringMethod::copy and a HaltonConfigurationShooter is
+      ///       shared with the copy: the threads then shoot the first
+      ///       samples of the same sequence.
+      ProblemPtr_t cloneForThread () const;
+
       /// \name Obstacles
       /// \{
 
@@ -197,11 +242,33 @@ namespace hpp {
       /// \param the obstacle to remove.
       void removeObstacleFromJoint (const JointPtr_t& joint,
 				    const CollisionObjectPtr_t& obstacle);
+      /// Remove an obstacle
+      /// \param object obstacle previously added.
+      /// \throw std::runtime_error if the object is not an obstacle.
+      void removeObstacle (const CollisionObjectPtr_t& object);
+      /// Notify path and configuration validations that an obstacle moved
+      /// \param object obstacle previously added, the position of which has
+      ///        changed.
+      /// \throw std::runtime_error if the object is not an obstacle.
+      /// \note problems created by cloneForThread before the obstacle
+      ///       moved should be created again.
+      void obstacleMoved (const CollisionObjectPtr_t& object);
 
       /// Vector of objects considered for collision detection
       const ObjectVector_t& collisionObstacles () const;
       /// Set the vector of objects considered for collision detection
       void collisionObstacles (const ObjectVector_t& collisionObstacles);
+
+      /// Set distance field of the static obstacles
+      /// \param field field passed to the path and configuration
+      ///        validations, empty pointer to disable.
+      /// \note the field is dropped when an obstacle it contains moves.
+      void distanceField (const DistanceFieldPtr_t& field);
+      /// Get distance field of the static obstacles
+      const DistanceFieldPtr_t& distanceField () const
+      {
+	return distanceField_;
+      }
       /// \}
 
     private :
@@ -223,10 +290,13 @@ namespace hpp {
       PathProjectorPtr_t pathProjector_;
       /// List of obstacles
       ObjectVector_t collisionObstacles_;
+      DistanceFieldPtr_t distanceField_;
       /// Set of constraints applicable to the robot
       ConstraintSetPtr_t constraints_;
       /// Configuration shooter
       ConfigurationShooterPtr_t configurationShooter_;
+      /// Seeds the random number generators of the components
+      mutable boost::mt19937 generator_;
     }; // class Problem
     /// \}
   } // namespace core
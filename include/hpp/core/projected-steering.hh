@@ -0,0 +1,96 @@
+//
+// Copyright (c) 2016 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_PROJECTED_STEERING_HH
+# define HPP_CORE_PROJECTED_STEERING_HH
+
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup steering_method
+    /// \{
+
+    /// Steer on the constraint manifold and validate in a single pass
+    ///
+    /// Instead of steering a constrained StraightPath, projecting it with a
+    /// PathProjector and validating the projection, configurations are
+    /// sampled from the initial configuration toward the goal every step,
+    /// each sample is projected on the constraints and immediately
+    /// validated. The last evaluation of the constraints is at the projected
+    /// configuration, so that the robot is already in this configuration
+    /// and the forward kinematics is not computed again by the collision
+    /// validation.
+    ///
+    /// The result is the longest valid prefix, an InterpolatedPath through
+    /// the samples subject to the constraints.
+    /// \note Only the samples are validated: the step should be compatible
+    ///       with the tolerance used by discretized path validation.
+    class HPP_CORE_DLLAPI ProjectedSteering
+    {
+    public:
+      /// Create instance and return shared pointer
+      /// \param robot robot the configurations of which are steered,
+      /// \param distance distance between consecutive samples,
+      /// \param validations validation of each sample,
+      /// \param step maximal distance between consecutive samples.
+      static ProjectedSteeringPtr_t create
+	(const DevicePtr_t& robot, const DistancePtr_t& distance,
+	 const ConfigValidationsPtr_t& validations, value_type step);
+
+      /// Steer from q1 toward q2
+      ///
+      /// \param q1 initial configuration, assumed to be valid and to satisfy
+      ///        the constraints,
+      /// \param q2 goal configuration, should satisfy the constraints,
+      /// \param constraints constraints of the path, may be empty,
+      /// \retval validPart longest valid projected path starting at q1,
+      /// \return whether validPart reaches q2.
+      bool operator() (ConfigurationIn_t q1, ConfigurationIn_t q2,
+		       const ConstraintSetPtr_t& constraints,
+		       PathPtr_t& validPart) const;
+
+      /// Set maximal distance between consecutive samples
+      void step (value_type step)
+      {
+	step_ = step;
+      }
+      /// Get maximal distance between consecutive samples
+      value_type step () const
+      {
+	return step_;
+      }
+
+    protected:
+      ProjectedSteering (const DevicePtr_t& robot,
+			 const DistancePtr_t& distance,
+			 const ConfigValidationsPtr_t& validations,
+			 value_type step);
+
+    private:
+      DevicePtr_t robot_;
+      DistancePtr_t distance_;
+      ConfigValidationsPtr_t validations_;
+      value_type step_;
+    }; // class ProjectedSteering
+    /// \}
+  } //   namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_PROJECTED_STEERING_HH
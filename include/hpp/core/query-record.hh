@@ -0,0 +1,178 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_QUERY_RECORD_HH
+# define HPP_CORE_QUERY_RECORD_HH
+
+# include <iostream>
+# include <string>
+# include <vector>
+# include <boost/atomic.hpp>
+# include <boost/cstdint.hpp>
+# include <boost/date_time/posix_time/posix_time_types.hpp>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup path_planning
+    /// \{
+
+    /// Record of a path planning query
+    ///
+    /// A record stores the parameters of a query set by ProblemSolver, among
+    /// which the seed of the random number generator, and the events of the
+    /// query: random samples, extensions, validations and planning phases,
+    /// with their outcome, start time and duration. Records are written to
+    /// and read from binary files, see ProblemSolver::recordQueries and
+    /// ProblemSolver::replay.
+    ///
+    /// Events are recorded by the thread that called start, until stop is
+    /// called. Events of other threads are not recorded. When no record is
+    /// active, the cost of an event is the test of a flag.
+    class HPP_CORE_DLLAPI QueryRecord
+    {
+    public:
+      /// Types of events
+      enum EventType {
+	/// Random configuration drawn by a planner
+	SAMPLE,
+	/// Extension of a roadmap node toward a configuration
+	EXTENSION,
+	/// Validation of a configuration by ConfigValidations
+	CONFIG_VALIDATION,
+	/// Validation of a path by a planner
+	PATH_VALIDATION,
+	/// PathPlanner::tryDirectPath
+	DIRECT_PATH,
+	/// PathPlanner::oneStep
+	ONE_STEP,
+	/// PathPlanner::computePath
+	COMPUTE_PATH,
+	/// PathOptimizer::optimize
+	PATH_OPTIMIZATION,
+	NUMBER_EVENT_TYPES
+      }; // enum EventType
+
+      /// Event, 10 bytes in a file
+      struct Event
+      {
+	/// EventType
+	boost::uint8_t type;
+	/// Whether the operation succeeded
+	bool success;
+	/// Start time relative to the start of the record in microseconds
+	boost::uint32_t start;
+	/// Duration in microseconds
+	boost::uint32_t duration;
+      }; // struct Event
+      typedef std::vector <Event> Events_t;
+
+      /// \name Parameters of the query
+      /// \{
+      unsigned int seed;
+      std::string pathPlannerType;
+      std::string configurationShooterType;
+      std::string pathValidationType;
+      value_type pathValidationTolerance;
+      std::vector <std::string> pathOptimizerTypes;
+      size_type maxIterations;
+      value_type timeOut;
+      Configuration_t initConfig;
+      std::vector <Configuration_t> goalConfigs;
+      /// \}
+
+      /// Events in chronological order of their end
+      Events_t events;
+
+      QueryRecord ();
+      /// Stop recording if the record is active in the calling thread
+      ~QueryRecord ();
+
+      /// Record events of the calling thread
+      ///
+      /// Previous events are removed.
+      /// \throw std::runtime_error if a record is already active in the
+      ///        calling thread.
+      void start ();
+      /// Stop recording events
+      void stop ();
+      /// Get record active in the calling thread, if any
+      static QueryRecord* active ()
+      {
+	if (numberActive_.load (boost::memory_order_relaxed) == 0) return 0x0;
+	return activeInThread ();
+      }
+
+      /// Add an event that started at a given time and ends now
+      void add (EventType type, bool success,
+		const boost::posix_time::ptime& start);
+      /// Get current time
+      static boost::posix_time::ptime now ()
+      {
+	return boost::posix_time::microsec_clock::universal_time ();
+      }
+
+      /// Write record in a binary file
+      /// \throw std::runtime_error if the file cannot be written.
+      void write (const std::string& filename) const;
+      /// Read record from a binary file written by write
+      /// \throw std::runtime_error if the file cannot be read or has not
+      ///        been written by write.
+      void read (const std::string& filename);
+
+      /// Print number, total and mean duration of events of each type
+      std::ostream& printBreakdown (std::ostream& os) const;
+      /// Get name of a type of event
+      static const char* name (EventType type);
+
+    private:
+      static QueryRecord* activeInThread ();
+      boost::posix_time::ptime start_;
+      static boost::atomic <std::size_t> numberActive_;
+    }; // class QueryRecord
+
+    /// Event recorded in the active QueryRecord, if any
+    ///
+    /// The event starts at construction and ends at the call to done.
+    /// Events interrupted by an exception are not recorded.
+    class RecordedEvent
+    {
+    public:
+      RecordedEvent (QueryRecord::EventType type) :
+	record_ (QueryRecord::active ()), type_ (type), start_ ()
+      {
+	if (record_) start_ = QueryRecord::now ();
+      }
+      /// Record event and return success
+      bool done (bool success)
+      {
+	if (record_) record_->add (type_, success, start_);
+	return success;
+      }
+    private:
+      QueryRecord* record_;
+      QueryRecord::EventType type_;
+      boost::posix_time::ptime start_;
+    }; // class RecordedEvent
+    /// \}
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_QUERY_RECORD_HH
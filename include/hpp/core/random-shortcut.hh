@@ -19,6 +19,8 @@
 #ifndef HPP_CORE_RANDOM_SHORTCUT_HH
 # define HPP_CORE_RANDOM_SHORTCUT_HH
 
+# include <vector>
+# include <boost/random/mersenne_twister.hpp>
 # include <hpp/core/path-optimizer.hh>
 
 namespace hpp {
@@ -32,8 +34,14 @@ namespace hpp {
     /// path and that tries to connect these configurations by a call to
     /// the steering method.
     ///
-    /// \note The optimizer assumes that the input path is a vector of optimal
-    ///       paths for the distance function.
+    /// At each iteration, several pairs of random parameters can be tried:
+    /// the shortest resulting path is kept. Parameters are drawn from a
+    /// random number generator owned by the instance and seeded by the
+    /// problem (see Problem::drawSeed), so that optimization is
+    /// reproducible given the seed.
+    ///
+    /// \note Unless a cost is set, the optimizer assumes that the input path
+    ///       is a vector of optimal paths for the distance function.
     class HPP_CORE_DLLAPI RandomShortcut : public PathOptimizer
     {
     public:
@@ -42,8 +50,77 @@ namespace hpp {
 
       /// Optimize path
       virtual PathVectorPtr_t optimize (const PathVectorPtr_t& path);
+
+      /// Reset random number generator
+      void seed (unsigned int seed)
+      {
+	generator_.seed (seed);
+      }
+
+      /// Set number of pairs of parameters tried at each iteration
+      /// \param number number of candidate shortcuts, 1 by default.
+      void numberCandidates (std::size_t number)
+      {
+	numberCandidates_ = number > 0 ? number : 1;
+      }
+      /// Get number of pairs of parameters tried at each iteration
+      std::size_t numberCandidates () const
+      {
+	return numberCandidates_;
+      }
+
+      /// Set cost of the paths minimized by the optimizer
+      /// \param cost cost of the paths, empty for the distance between the
+      ///        ends of the paths, which is the default.
+      ///
+      /// The costs of the elements of the path are kept between iterations:
+      /// only shortcuts and the elements that they split are evaluated.
+      void cost (const PathCostPtr_t& cost)
+      {
+	cost_ = cost;
+      }
+      /// Get cost of the paths minimized by the optimizer
+      const PathCostPtr_t& cost () const
+      {
+	return cost_;
+      }
+
+      /// \name Parallel evaluation of candidates
+      /// \{
+
+      /// Add a problem used by a worker thread
+      /// \param problem copy of the problem of the optimizer, with its own
+      ///        robot, steering method, constraints and path validation,
+      ///        see Problem::cloneForThread.
+      ///
+      /// If problems have been added, candidate shortcuts are steered and
+      /// validated by one thread per problem. The problem should outlive the
+      /// optimizer.
+      void addThreadProblem (const Problem& problem)
+      {
+	threadProblems_.push_back (&problem);
+      }
+      /// Remove problems used by worker threads
+      void resetThreadProblems ()
+      {
+	threadProblems_.clear ();
+      }
+      /// Get problems used by worker threads
+      const std::vector <const Problem*>& threadProblems () const
+      {
+	return threadProblems_;
+      }
+      /// \}
     protected:
       RandomShortcut (const Problem& problem);
+    private:
+      /// Uniform random value in [0, 1)
+      value_type uniform ();
+
+      std::size_t numberCandidates_;
+      std::vector <const Problem*> threadProblems_;
+      PathCostPtr_t cost_;
+      boost::mt19937 generator_;
     }; // class RandomShortcut
     /// \}
   } // namespace core
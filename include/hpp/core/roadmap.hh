@@ -20,11 +20,18 @@
 # define HPP_CORE_ROADMAP_HH
 
 # include <iostream>
+# include <set>
+# include <vector>
 # include <hpp/core/fwd.hh>
 # include <hpp/core/config.hh>
+# include <hpp/core/pool.hh>
 
 namespace hpp {
   namespace core {
+    class EdgeIndex;
+    class GoalIndex;
+    class LpaStar;
+
     /// \addtogroup roadmap
     /// \{
 
@@ -32,10 +39,31 @@ namespace hpp {
     /// Nodes are configurations, paths are collision-free paths.
     class HPP_CORE_DLLAPI Roadmap {
     public:
+      /// Estimate of the memory used by a roadmap, in bytes
+      struct MemoryUsage
+      {
+	/// Nodes, their configurations and their lists of edges
+	std::size_t nodes;
+	/// Edges
+	std::size_t edges;
+	/// Paths of the edges, except paths not computed yet
+	std::size_t paths;
+	/// Nearest neighbor structure, see NearestNeighbor::memoryUsage
+	std::size_t nearestNeighbor;
+
+	std::size_t total () const
+	{
+	  return nodes + edges + paths + nearestNeighbor;
+	}
+      }; // struct MemoryUsage
+
       /// Return shared pointer to new instance.
       static RoadmapPtr_t create (const DistancePtr_t& distance, const DevicePtr_t& robot);
 
       /// Clear the roadmap by deleting nodes and edges.
+      ///
+      /// Memory of nodes created by Roadmap::createNode and of edges is kept
+      /// for the nodes and edges added afterwards.
       virtual void clear ();
 
       /// Add a node with given configuration
@@ -49,16 +77,49 @@ namespace hpp {
       /// Get nearest node to a configuration in the roadmap.
       /// \param configuration configuration
       /// \retval distance to the nearest node.
+      /// \param exact whether to disable approximate search, see
+      ///        NearestNeighbor::epsilon.
       NodePtr_t nearestNode (const ConfigurationPtr_t& configuration,
-			     value_type& minDistance);
+			     value_type& minDistance, bool exact = false);
 
       /// Get nearest node to a configuration in a connected component.
       /// \param configuration configuration
       /// \param connectedComponent the connected component
       /// \retval distance to the nearest node.
+      /// \param exact whether to disable approximate search, see
+      ///        NearestNeighbor::epsilon.
       NodePtr_t nearestNode (const ConfigurationPtr_t& configuration,
 			     const ConnectedComponentPtr_t& connectedComponent,
-			     value_type& minDistance);
+			     value_type& minDistance, bool exact = false);
+
+      /// Get nearest node to a configuration in each connected component.
+      /// \param configuration configuration
+      /// \retval nearestNodes connected component, nearest node and distance
+      ///         to the configuration for each connected component of the
+      ///         roadmap, sorted by creation of the connected components.
+      /// \note all connected components are searched in one query to the
+      ///       nearest neighbor object.
+      void nearestNodes (const ConfigurationPtr_t& configuration,
+			 NearestNodes_t& nearestNodes);
+
+      /// Get the k nearest nodes to a configuration in a connected component.
+      /// \param configuration configuration
+      /// \param connectedComponent the connected component
+      /// \param k maximal number of nodes returned,
+      /// \retval distance distance to the farthest returned node.
+      /// \return nodes sorted by increasing distance.
+      Nodes_t nearestNodes (const ConfigurationPtr_t& configuration,
+			    const ConnectedComponentPtr_t& connectedComponent,
+			    std::size_t k, value_type& distance);
+
+      /// Get nodes of a connected component within a radius.
+      /// \param configuration configuration
+      /// \param connectedComponent the connected component
+      /// \param radius maximal distance to the configuration.
+      /// \return nodes sorted by increasing distance.
+      Nodes_t nodesWithinRadius (const ConfigurationPtr_t& configuration,
+				 const ConnectedComponentPtr_t&
+				 connectedComponent, value_type radius);
 
       /// Add a node and two edges
       /// \param from node from which the edge starts,
@@ -77,12 +138,11 @@ namespace hpp {
       /// \param config configuration
       /// If configuration is already in the roadmap, tag corresponding node
       /// as goal node. Otherwise create a new node.
+      /// \note A node is listed once in goalNodes, even if added again.
       void addGoalNode (const ConfigurationPtr_t& config);
 
-      void resetGoalNodes ()
-      {
-	goalNodes_.clear ();
-      }
+      /// Untag goal nodes
+      void resetGoalNodes ();
 
       void initNode (const ConfigurationPtr_t& config)
       {
@@ -100,6 +160,26 @@ namespace hpp {
       {
 	return edges_;
       }
+      /// Get number of nodes created since the roadmap was last cleared
+      /// \note Node::index is smaller than this number.
+      std::size_t nodeIndexBound () const
+      {
+	return nodeIndexBound_;
+      }
+      /// Get cache of distances from nodes to the nearest goal node
+      /// \param distance distance with which values are computed.
+      /// \return vector indexed by Node::index, negative values are not
+      ///         computed yet.
+      /// Values are kept until goal nodes change, the roadmap is cleared or
+      /// the method is called with another distance.
+      std::vector <value_type>& distancesToGoal (const DistancePtr_t& distance);
+      /// Get distance from a node to the nearest goal node
+      /// \param distance distance with which the value is computed.
+      /// \return infinity if there is no goal node.
+      /// The value is computed with an index of the goal configurations
+      /// and stored in the cache returned by distancesToGoal.
+      value_type distanceToGoal (const DistancePtr_t& distance,
+				 const NodePtr_t& node);
       NodePtr_t initNode () const
       {
 	return initNode_;
@@ -115,6 +195,8 @@ namespace hpp {
       NearestNeighborPtr_t nearestNeighbor();
 
       /// Set new NearestNeighbor (roadmap must be empty)
+      /// \note the roadmap takes ownership of the object and deletes the
+      ///       previous one.
       void nearestNeighbor(NearestNeighborPtr_t nearestNeighbor);
 
       /// \name Distance used for nearest neighbor search
@@ -126,12 +208,180 @@ namespace hpp {
       EdgePtr_t addEdge (const NodePtr_t& n1, const NodePtr_t& n2,
 			 const PathPtr_t& path);
 
+      /// Add an edge between two nodes, the path of which is computed on
+      /// first access
+      /// \param steeringMethod steering method that computes the path,
+      /// \param length length of the path, used by shortest path searches.
+      /// \sa Edge::path
+      EdgePtr_t addEdge (const NodePtr_t& n1, const NodePtr_t& n2,
+			 const SteeringMethodPtr_t& steeringMethod,
+			 value_type length);
+
+      /// Remove edges from the roadmap
+      /// \param edges edges to remove.
+      /// Connected components are recomputed from the remaining edges.
+      void removeEdges (const Edges_t& edges);
+
+      /// Remove an edge from the roadmap
+      /// \param edge edge to remove, the reverse edge is kept.
+      ///
+      /// Connected components are recomputed from the remaining edges only
+      /// if the edge linked two connected components that no other edge
+      /// links, or if its connected component is split.
+      /// \warning the pointer to the edge becomes invalid.
+      void removeEdge (const EdgePtr_t& edge);
+
+      /// Remove a node and its edges from the roadmap
+      /// \param node node to remove, also removed from the goal nodes. If
+      ///        the node is the initial node, the roadmap has no initial
+      ///        node anymore.
+      ///
+      /// The node is removed from the nearest neighbor structure. As for
+      /// removeEdge, connected components are recomputed only if the edges
+      /// of the node were needed to connect the remaining nodes.
+      /// \warning pointers to the node and its edges become invalid.
+      void removeNode (const NodePtr_t& node);
+
+      /// Remove edges in collision after a change of the environment
+      /// \param pathValidation validation of paths in the new environment,
+      /// \param obstacles obstacles added or moved since the edges were
+      ///        validated.
+      /// \return number of removed edges.
+      ///
+      /// Only the edges returned by edgesNear for these obstacles are
+      /// validated again. An edge and its reverse edge are validated once.
+      /// Connected components are recomputed if edges are removed.
+      /// \note the paths of edges created with a steering method are
+      ///       computed.
+      std::size_t removeInvalidEdges (const PathValidationPtr_t&
+				      pathValidation,
+				      const ObjectVector_t& obstacles);
+
+      /// Set whether the swept volumes of the edges are indexed
+      ///
+      /// If true, the boxes swept by the bodies along the path of each edge
+      /// (see SweptVolume) are computed when the edge is added, and stored
+      /// in an AABB tree, so that edgesNear and removeInvalidEdges find the
+      /// edges near obstacles in logarithmic time in the number of edges.
+      /// Default is false.
+      /// \throw std::runtime_error if the roadmap was created without
+      ///        robot.
+      void indexEdges (bool index);
+      /// Get whether the swept volumes of the edges are indexed
+      bool indexEdges () const
+      {
+	return edgeIndex_ != 0x0;
+      }
+      /// Get edges that may be in collision with obstacles
+      /// \param obstacles obstacles at their current positions.
+      /// \return edges the swept volume of which overlaps the bounding box
+      ///         of an obstacle, and edges the swept volume of which is
+      ///         unknown.
+      Edges_t edgesNear (const ObjectVector_t& obstacles);
+
+      /// \name Shortest path search
+      /// \{
+
+      /// Set whether PathPlanner::computePath uses the incremental search
+      /// implemented by shortestPath instead of A*.
+      void incrementalSearch (bool incremental)
+      {
+	incrementalSearch_ = incremental;
+      }
+      /// Get whether PathPlanner::computePath uses the incremental search
+      bool incrementalSearch () const
+      {
+	return incrementalSearch_;
+      }
+      /// Compute shortest path from initial node to goal nodes
+      /// \param distance distance used to estimate costs to goal.
+      ///
+      /// The search (Lifelong Planning A*) keeps its result between calls:
+      /// when edges are added or removed, or when goal nodes change, only
+      /// costs of nodes affected by the changes are updated. The search
+      /// restarts if the initial node or the distance change.
+      PathVectorPtr_t shortestPath (const DistancePtr_t& distance);
+      /// Compute edges of shortest path from initial node to goal nodes
+      /// \param distance distance used to estimate costs to goal.
+      ///
+      /// Same incremental search as shortestPath, the paths of the edges
+      /// are not computed.
+      Edges_t shortestPathEdges (const DistancePtr_t& distance);
+      /// \}
+
+      /// \name Memory usage
+      /// \{
+
+      /// Get estimate of the memory used by the roadmap
+      ///
+      /// The cost is linear in the number of nodes and edges.
+      MemoryUsage memoryUsage () const;
+
+      /// Set soft memory budget
+      /// \param bytes maximal memory usage, 0 for no limit, which is the
+      ///        default.
+      ///
+      /// When the budget is exceeded, PathPlanner::solve prunes the roadmap
+      /// (see PathPlanner::pruneRoadmap). Memory of the node and edge pools
+      /// is only released when the roadmap is cleared, the budget may thus
+      /// be exceeded by the size of the nodes and edges that were removed.
+      void memoryBudget (std::size_t bytes)
+      {
+	memoryBudget_ = bytes;
+	nextMemoryCheck_ = 0;
+      }
+      /// Get soft memory budget, 0 for no limit
+      std::size_t memoryBudget () const
+      {
+	return memoryBudget_;
+      }
+      /// Whether the roadmap exceeds its memory budget
+      ///
+      /// To keep the cost constant on average, memory usage is computed
+      /// again when the number of nodes and edges has grown by 10% since
+      /// the last computation: false is returned in between.
+      bool memoryBudgetExceeded ();
+
+      /// Remove redundant nodes
+      /// \param kept nodes that should not be removed, in addition to the
+      ///        initial and goal nodes.
+      /// \return number of removed nodes.
+      ///
+      /// Redundant nodes are linked to at most one other node: they are dead
+      /// ends of the roadmap, and removing them does not change which other
+      /// nodes are connected. Their edges are removed. Connected components
+      /// and the nearest neighbor structure are rebuilt.
+      /// \warning pointers to removed nodes and edges become invalid.
+      virtual std::size_t prune (const Nodes_t& kept = Nodes_t ());
+
+      /// Remove edges that do not shorten paths by more than a factor
+      /// \param stretch factor by which the length of shortest paths
+      ///        between nodes may grow, not smaller than 1,
+      /// \param kept nodes that should not be removed by prune.
+      /// \return number of removed edges.
+      ///
+      /// Edges are examined by increasing length: an edge is kept only if
+      /// the edges kept so far link its ends by no path shorter than
+      /// stretch times its length (greedy spanner). Which nodes are
+      /// connected does not change, and the length of the shortest path
+      /// between two nodes grows at most by the stretch factor. The nodes
+      /// that become dead ends are then removed by prune.
+      /// \throw std::invalid_argument if stretch is smaller than 1.
+      /// \warning pointers to removed nodes and edges become invalid.
+      std::size_t sparsify (value_type stretch,
+			    const Nodes_t& kept = Nodes_t ());
+      /// \}
+
       /// Print roadmap in a stream
       std::ostream& print (std::ostream& os) const;
 
     protected:
       /// Constructor
       /// \param distance distance function for nearest neighbor computations
+      /// \param robot robot, used to build the k-d tree of the roadmap.
+      ///
+      /// Nearest neighbor search uses a k-d tree if distance is a
+      /// WeighedDistance, a linear search otherwise.
       Roadmap (const DistancePtr_t& distance, const DevicePtr_t& robot);
 
       /// Add a new connected component in the roadmap.
@@ -148,7 +398,8 @@ namespace hpp {
 
       /// Node factory
       /// Reimplement the function if you want to create an instance of a
-      /// child class of Node
+      /// child class of Node. Nodes created with operator new are deleted
+      /// by Roadmap::clear.
       virtual NodePtr_t createNode (const ConfigurationPtr_t& configuration) const;
 
     private:
@@ -171,6 +422,15 @@ namespace hpp {
       void addEdges (const NodePtr_t from, const NodePtr_t& to,
 		     const PathPtr_t& path);
 
+      /// Register an edge created in the edge pool
+      EdgePtr_t insertEdge (const EdgePtr_t& edge);
+
+      /// Remove edges, without updating connected components
+      void eraseEdges (const std::set <EdgePtr_t>& edges);
+
+      /// Destroy a node created by createNode
+      void destroyNode (const NodePtr_t& node);
+
       /// Update the graph of connected components after new connection
       /// \param cc1, cc2 the two connected components that have just been
       /// connected.
@@ -183,13 +443,49 @@ namespace hpp {
       void merge (const ConnectedComponentPtr_t& cc1,
 		  ConnectedComponents_t& ccs);
 
+      /// Compute connected components from scratch
+      void rebuildConnectedComponents ();
+
+      /// Whether connected components are unchanged by the removal of an
+      /// edge between two nodes
+      bool keepsConnectedComponents (const NodePtr_t& from,
+				     const NodePtr_t& to) const;
+
+      /// Edge from the end to the start of an edge, if any
+      EdgePtr_t reverseEdge (const EdgePtr_t& edge) const;
+
       const DistancePtr_t distance_;
+      DevicePtr_t robot_;
+      /// Bounding boxes of the paths of the edges, created on first use
+      SweptVolumePtr_t sweptVolume_;
       ConnectedComponents_t connectedComponents_;
       Nodes_t nodes_;
       Edges_t edges_;
       NodePtr_t initNode_;
       Nodes_t goalNodes_;
       NearestNeighborPtr_t nearestNeighbor_;
+      /// Storage of nodes and edges
+      mutable Pool <Node> nodePool_;
+      Pool <Edge> edgePool_;
+      /// Index of the next node created
+      std::size_t nodeIndexBound_;
+      /// Cache of distances to goal nodes and distance used to compute them
+      std::vector <value_type> distancesToGoal_;
+      DistancePtr_t distanceToGoal_;
+      /// Goal nodes when distancesToGoal_ was computed
+      Nodes_t goalsOfDistances_;
+      /// Whether goal nodes changed since goalsOfDistances_ was compared
+      bool goalsChanged_;
+      /// Index of goalsOfDistances_, built on first use
+      GoalIndex* goalIndex_;
+      /// Incremental shortest path search
+      LpaStar* lpaStar_;
+      bool incrementalSearch_;
+      /// Spatial index of the swept volumes of the edges, if enabled
+      EdgeIndex* edgeIndex_;
+      std::size_t memoryBudget_;
+      /// Number of nodes and edges from which memory usage is computed again
+      std::size_t nextMemoryCheck_;
 
     }; // class Roadmap
     std::ostream& operator<< (std::ostream& os, const Roadmap& r);
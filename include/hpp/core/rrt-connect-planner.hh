@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_RRT_CONNECT_PLANNER_HH
+# define HPP_CORE_RRT_CONNECT_PLANNER_HH
+
+# include <hpp/core/diffusing-planner.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup path_planning
+    /// \{
+
+    /// Implementation of RRT-Connect algorithm
+    ///
+    /// Two trees are grown, one from the initial node and one from a goal
+    /// node. At each step, one tree is extended toward a random
+    /// configuration, then the other tree is greedily extended toward the
+    /// new node until it connects or is blocked. Trees are swapped at each
+    /// step.
+    class HPP_CORE_DLLAPI RrtConnectPlanner : public DiffusingPlanner
+    {
+    public:
+      /// Return shared pointer to new object.
+      static RrtConnectPlannerPtr_t createWithRoadmap
+	(const Problem& problem, const RoadmapPtr_t& roadmap);
+      /// Return shared pointer to new object.
+      static RrtConnectPlannerPtr_t create (const Problem& problem);
+      /// One step of extension.
+      virtual void oneStep ();
+    protected:
+      /// Constructor
+      RrtConnectPlanner (const Problem& problem, const RoadmapPtr_t& roadmap);
+      /// Constructor with roadmap
+      RrtConnectPlanner (const Problem& problem);
+      /// Store weak pointer to itself
+      void init (const RrtConnectPlannerWkPtr_t& weak);
+    private:
+      /// Extend a node toward a configuration and insert the valid part of
+      /// the path in the roadmap
+      /// \param near node from which the extension starts,
+      /// \param target configuration toward which the node is extended,
+      /// \retval reached whether the whole path is valid.
+      /// \return the new node or NULL if the extension failed.
+      NodePtr_t extendNode (const NodePtr_t& near,
+			    const ConfigurationPtr_t& target, bool& reached);
+      /// Greedily extend a connected component toward a node
+      /// \param cc connected component to extend,
+      /// \param target node of another connected component.
+      /// \return whether the connected component has been connected to the
+      ///         target node.
+      bool connect (const ConnectedComponentPtr_t& cc,
+		    const NodePtr_t& target);
+
+      RrtConnectPlannerWkPtr_t weakPtr_;
+      // Whether the next step extends the tree of the initial node
+      bool extendInitTree_;
+    }; // class RrtConnectPlanner
+    /// \}
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_RRT_CONNECT_PLANNER_HH
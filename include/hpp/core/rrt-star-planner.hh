@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_RRT_STAR_PLANNER_HH
+# define HPP_CORE_RRT_STAR_PLANNER_HH
+
+# include <vector>
+# include <hpp/core/diffusing-planner.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup path_planning
+    /// \{
+
+    /// Implementation of RRT* algorithm
+    ///
+    /// A tree is grown from the initial node. The cost from the initial
+    /// node of each node of the tree is maintained along with its parent
+    /// edge. At each step,
+    /// \li the nearest node of the tree is extended toward a random
+    ///     configuration and the valid part of the path is inserted as new
+    ///     node,
+    /// \li the parent of the new node is chosen among its k nearest nodes
+    ///     in the tree, with k proportional to the logarithm of the number
+    ///     of nodes of the tree,
+    /// \li the near nodes and the goal nodes within the same distance are
+    ///     connected to the new node if the new node decreases their cost;
+    ///     the costs of their descendants are updated.
+    ///
+    /// Validation is lazy: paths to the near nodes are validated in order of
+    /// increasing cost and only if they improve the cost of a node.
+    ///
+    /// Costs are given by PathPlanner::pathCost, the lengths of the paths
+    /// by default. The costs of the edges are cached in the edges. Edges of
+    /// the former parents are kept in the roadmap, so that computePath
+    /// searches a graph of valid edges.
+    ///
+    /// Solution quality improves with the number of steps: after the first
+    /// solution is found, solve keeps extending the tree for a given number
+    /// of steps, see numberRefinementSteps.
+    class HPP_CORE_DLLAPI RrtStarPlanner : public DiffusingPlanner
+    {
+    public:
+      /// Return shared pointer to new object.
+      static RrtStarPlannerPtr_t createWithRoadmap
+	(const Problem& problem, const RoadmapPtr_t& roadmap);
+      /// Return shared pointer to new object.
+      static RrtStarPlannerPtr_t create (const Problem& problem);
+      /// Initialize the problem resolution
+      ///
+      /// Compute the costs of the nodes already connected to the initial
+      /// node.
+      virtual void startSolve ();
+      /// One step of extension and rewiring.
+      virtual void oneStep ();
+      /// Refine the solution
+      ///
+      /// Call oneStep numberRefinementSteps times, or until the time out of
+      /// solve is reached, and search the roadmap again.
+      virtual PathVectorPtr_t finishSolve (const PathVectorPtr_t& path);
+      /// Remove redundant nodes of the roadmap and recompute the costs
+      virtual void pruneRoadmap ();
+
+      /// Set number of steps after the first solution is found
+      /// \param steps number of steps, 0 by default.
+      void numberRefinementSteps (std::size_t steps)
+      {
+	numberRefinementSteps_ = steps;
+      }
+      /// Get number of steps after the first solution is found
+      std::size_t numberRefinementSteps () const
+      {
+	return numberRefinementSteps_;
+      }
+      /// Set factor of the number of near nodes
+      /// \param factor the number of near nodes of a new node is factor
+      ///        times the logarithm of the number of nodes of the tree.
+      ///        2e by default, which is greater than the bound that ensures
+      ///        asymptotic optimality in any dimension.
+      void neighborFactor (value_type factor)
+      {
+	neighborFactor_ = factor;
+      }
+      /// Get factor of the number of near nodes
+      value_type neighborFactor () const
+      {
+	return neighborFactor_;
+      }
+      /// Set maximal length of the extensions
+      /// \param length maximal length of the paths from the nearest node to
+      ///        the new nodes, infinity by default.
+      void extensionLength (value_type length)
+      {
+	extensionLength_ = length;
+      }
+      /// Get maximal length of the extensions
+      value_type extensionLength () const
+      {
+	return extensionLength_;
+      }
+      /// Get cost of a node from the initial node
+      /// \return infinity if the node is not in the tree of the initial
+      ///         node or has been added to the roadmap since the last step.
+      value_type nodeCost (const NodePtr_t& node) const;
+      /// Get edge from the parent of a node in the tree
+      /// \return 0x0 for the initial node and for nodes without cost.
+      EdgePtr_t parentEdge (const NodePtr_t& node) const;
+    protected:
+      /// Constructor
+      RrtStarPlanner (const Problem& problem, const RoadmapPtr_t& roadmap);
+      /// Constructor with roadmap
+      RrtStarPlanner (const Problem& problem);
+      /// Store weak pointer to itself
+      void init (const RrtStarPlannerWkPtr_t& weak);
+    private:
+      /// Compute the costs of the nodes from the initial node by Dijkstra
+      /// algorithm on the edges of the roadmap
+      void computeCosts ();
+      /// Extend the storage of the costs to the nodes of the roadmap
+      void resizeCosts ();
+      /// Update the costs of the descendants of a node the cost of which
+      /// has changed
+      void propagateCost (const NodePtr_t& node);
+      /// Connect a node of the tree to another node with a valid path,
+      /// the latter becoming a child of the former.
+      void connect (const NodePtr_t& parent, const NodePtr_t& child,
+		    const PathPtr_t& path, value_type cost);
+      /// Steer between two configurations and project the path
+      /// \return the path or an empty pointer.
+      PathPtr_t steer (ConfigurationIn_t q1, ConfigurationIn_t q2) const;
+      /// Whether a path is valid
+      bool validate (const PathPtr_t& path) const;
+      /// Cost of the path of an edge
+      value_type cost (const EdgePtr_t& edge) const;
+      /// Cost of a path
+      value_type cost (const PathPtr_t& path) const;
+
+      RrtStarPlannerWkPtr_t weakPtr_;
+      /// Costs of the nodes from the initial node, indexed by Node::index,
+      /// infinity for nodes that are not in the tree
+      std::vector <value_type> costs_;
+      /// Edges from the parents of the nodes, indexed by Node::index
+      std::vector <EdgePtr_t> parents_;
+      std::size_t numberRefinementSteps_;
+      value_type neighborFactor_;
+      value_type extensionLength_;
+    }; // class RrtStarPlanner
+    /// \}
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_RRT_STAR_PLANNER_HH
@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_SEEDED_CONFIGURATION_SHOOTER_HH
+# define HPP_CORE_SEEDED_CONFIGURATION_SHOOTER_HH
+
+# include <vector>
+# include <boost/random/mersenne_twister.hpp>
+# include <hpp/core/configuration-shooter.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup configuration_sampling
+    /// \{
+
+    /// Uniformly sample with bounds of degrees of freedom using a random
+    /// number generator owned by the instance.
+    ///
+    /// Contrary to BasicConfigurationShooter, samples do not depend on the
+    /// global state of rand (): the sequence of configurations is
+    /// reproducible given the seed, and instances used by different threads
+    /// do not interfere. The way each configuration variable is sampled is
+    /// computed at construction, so that shooting does not allocate memory
+    /// except for the configuration returned by shoot ().
+    ///
+    /// \note the kinematic chain of the robot should not change after
+    ///       construction.
+    class HPP_CORE_DLLAPI SeededConfigurationShooter :
+      public ConfigurationShooter
+    {
+    public:
+      /// Create instance and return shared pointer
+      /// \param robot the robot the configurations of which are sampled,
+      /// \param seed seed of the random number generator.
+      static SeededConfigurationShooterPtr_t create
+	(const DevicePtr_t& robot, unsigned int seed = 5489u);
+      /// Create an instance for another robot with the same kinematic chain
+      ///
+      /// The seed of the new instance is drawn from the generator of this
+      /// one, so that copies are reproducible and shoot different sequences.
+      SeededConfigurationShooterPtr_t copy (const DevicePtr_t& robot) const;
+      /// Reset random number generator
+      virtual void seed (unsigned int seed);
+
+      using ConfigurationShooter::shoot;
+      virtual ConfigurationPtr_t shoot () const;
+      virtual void shoot (matrixOut_t configurations) const;
+      /// Write a random configuration in a preallocated vector
+      /// \retval configuration vector of size robot configuration size.
+      void sample (ConfigurationOut_t configuration) const;
+
+    protected:
+      /// Constructor
+      ///
+      /// \throw std::runtime_error if a degree of freedom cannot be sampled
+      ///        uniformly, i.e. if it is not bounded.
+      SeededConfigurationShooter (const DevicePtr_t& robot,
+				  unsigned int seed);
+      void init (const SeededConfigurationShooterPtr_t& self);
+
+    private:
+      /// How to sample some consecutive configuration variables
+      struct Sampler {
+	enum Type {
+	  /// Uniform value between lower and upper
+	  INTERVAL,
+	  /// Angle in [-pi, pi]
+	  ANGLE,
+	  /// Cosine and sine of an angle in [-pi, pi]
+	  UNIT_COMPLEX,
+	  /// Unit quaternion
+	  UNIT_QUATERNION
+	};
+	Type type;
+	size_type rank;
+	value_type lower;
+	value_type upper;
+      }; // struct Sampler
+      typedef std::vector <Sampler> Samplers_t;
+      /// Uniform random value in [0, 1)
+      value_type uniform () const;
+      void addSampler (Sampler::Type type, size_type rank,
+		       value_type lower = 0, value_type upper = 0);
+
+      DevicePtr_t robot_;
+      Samplers_t samplers_;
+      mutable boost::mt19937 generator_;
+      SeededConfigurationShooterWkPtr_t weak_;
+    }; // class SeededConfigurationShooter
+    /// \}
+  } //   namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_SEEDED_CONFIGURATION_SHOOTER_HH
@@ -0,0 +1,125 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_SOLVE_FUTURE_HH
+# define HPP_CORE_SOLVE_FUTURE_HH
+
+# include <string>
+# include <boost/cstdint.hpp>
+# include <boost/thread/condition_variable.hpp>
+# include <boost/thread/mutex.hpp>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup path_planning
+    /// \{
+
+    /// Handle of a query solved in background
+    ///
+    /// Created by ProblemSolver::solveAsync. The solving thread plans a
+    /// path, then runs the path optimizers of the problem solver on it.
+    /// Other threads poll the progress, wait for the end and cancel
+    /// through this object.
+    ///
+    /// After each phase, the path is published and can be retrieved by
+    /// method path, even if the query is cancelled afterwards: the path
+    /// returned by an optimizer when it is cancelled is the best path found
+    /// so far.
+    class HPP_CORE_DLLAPI SolveFuture
+    {
+    public:
+      /// State of the query
+      enum Status {
+	/// Path planning is running
+	PLANNING,
+	/// A path has been planned, path optimizers are running
+	OPTIMIZING,
+	/// All path optimizers have run
+	SOLVED,
+	/// The query has been cancelled
+	CANCELLED,
+	/// Planning failed, see error
+	FAILED
+      }; // enum Status
+
+      /// Get state of the query
+      Status status () const;
+      /// Whether the solving thread is done with the query
+      ///
+      /// The status is then SOLVED, CANCELLED or FAILED.
+      bool done () const;
+      /// Wait until the solving thread is done with the query
+      void wait () const;
+      /// Wait until the query is done or a duration has elapsed
+      /// \param seconds maximal duration of the wait,
+      /// \return whether the query is done.
+      bool timedWait (value_type seconds) const;
+      /// Request the solving thread to stop
+      ///
+      /// Path planning stops after the current step, path optimization
+      /// after the current iteration. Call wait to wait for it.
+      void cancel ();
+
+      /// Get number of steps of path planning done so far
+      std::size_t planningIterations () const;
+      /// Get number of path optimizers that have run
+      std::size_t numberOptimizedPaths () const;
+      /// Get latest path published by the solving thread
+      /// \return the planned path or the path returned by the latest path
+      ///         optimizer, empty if no path has been planned.
+      PathVectorPtr_t path () const;
+      /// Get message of the error that made the query fail
+      std::string error () const;
+
+    protected:
+      /// Constructor
+      /// \param planner path planner of the query,
+      /// \param token token shared with the planner and the optimizers.
+      SolveFuture (const PathPlannerPtr_t& planner,
+		   const CancellationTokenPtr_t& token);
+
+    private:
+      /// Publish a path found by the solving thread
+      /// \param path planned or optimized path,
+      /// \param optimized whether the path was returned by an optimizer.
+      void publish (const PathVectorPtr_t& path, bool optimized);
+      /// Notify the end of the query
+      void finish (Status status, const std::string& error);
+
+      PathPlannerPtr_t planner_;
+      CancellationTokenPtr_t token_;
+      /// Number of steps of the planner before the query
+      boost::uint64_t initialSteps_;
+      /// Protects members below
+      mutable boost::mutex mutex_;
+      /// Notified when the query is done
+      mutable boost::condition_variable finished_;
+      Status status_;
+      PathVectorPtr_t path_;
+      std::size_t optimizedPaths_;
+      std::string error_;
+
+      friend class ProblemSolver;
+    }; // class SolveFuture
+    /// \}
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_SOLVE_FUTURE_HH
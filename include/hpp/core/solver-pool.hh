@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_SOLVER_POOL_HH
+# define HPP_CORE_SOLVER_POOL_HH
+
+# include <vector>
+# include <boost/thread/condition_variable.hpp>
+# include <boost/thread/mutex.hpp>
+# include <hpp/core/problem-solver.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup path_planning
+    /// \{
+
+    /// Pool of problems solving planning queries concurrently
+    ///
+    /// Each problem of the pool, called a context, solves one query at a
+    /// time. Calls to solve from several threads are dispatched to free
+    /// contexts, and wait until one is free if all are busy. A query builds
+    /// a new roadmap: contexts do not share data that is modified by
+    /// planning.
+    ///
+    /// Contexts are usually copies of a problem created by
+    /// Problem::cloneForThread: they share the obstacles and their
+    /// geometry, and the weights of the distance. See
+    /// ProblemSolver::createSolverPool.
+    class HPP_CORE_DLLAPI SolverPool
+    {
+    public:
+      typedef ProblemSolver::PathPlannerBuilder_t PathPlannerBuilder_t;
+      typedef ProblemSolver::PathOptimizerBuilder_t PathOptimizerBuilder_t;
+
+      /// Create an empty pool
+      /// \param pathPlanner builder of the path planner of the queries.
+      static SolverPoolPtr_t create (const PathPlannerBuilder_t& pathPlanner);
+      /// Delete the problems of the contexts
+      ~SolverPool ();
+
+      /// Add a context
+      /// \param problem problem of the context, deleted by the pool. Its
+      ///        robot and the objects it refers to should not be used by
+      ///        other contexts.
+      void addContext (ProblemPtr_t problem);
+      /// Get number of contexts
+      std::size_t numberContexts () const;
+
+      /// Add a path optimizer run on the path of each query
+      void addPathOptimizer (const PathOptimizerBuilder_t& pathOptimizer);
+      /// Set budget of path planning of each query
+      /// \param seconds maximal duration, infinite by default,
+      /// \param iterations maximal number of iterations, 0 (default) for
+      ///        no limit.
+      void planningBudget (value_type seconds, std::size_t iterations);
+
+      /// Solve a query in a free context
+      ///
+      /// Thread safe: this method blocks until a context is free.
+      /// \param init, goals init and goal configurations of the query.
+      /// \return the planned path, optimized by the path optimizers.
+      /// \throw std::runtime_error if the pool has no context, or if
+      ///        planning fails.
+      PathVectorPtr_t solve (const Configuration_t& init,
+			     const Configurations_t& goals);
+
+    protected:
+      SolverPool (const PathPlannerBuilder_t& pathPlanner);
+
+    private:
+      /// Planning parameters, copied by each query
+      struct Parameters
+      {
+	PathPlannerBuilder_t pathPlanner;
+	std::vector <PathOptimizerBuilder_t> pathOptimizers;
+	value_type timeOut;
+	std::size_t maxIterations;
+      }; // struct Parameters
+      /// Mark a free context as busy, waiting for one if needed
+      /// \retval parameters copy of planning parameters,
+      /// \retval problem problem of the context.
+      /// \return rank of the context.
+      std::size_t acquire (Parameters& parameters, ProblemPtr_t& problem);
+      /// Mark a context as free
+      void release (std::size_t context);
+
+      std::vector <ProblemPtr_t> problems_;
+      std::vector <bool> busy_;
+      Parameters parameters_;
+      /// Protects all members
+      mutable boost::mutex mutex_;
+      /// Notified when a context is released
+      boost::condition_variable contextReleased_;
+    }; // class SolverPool
+    /// \}
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_SOLVER_POOL_HH
@@ -75,25 +75,49 @@ namespace hpp {
 					       constraints ());
         return path;
       }
+
+      /// create a path between two configurations, reusing storage
+      ///
+      /// The StraightPath created by the previous call is reset in place if
+      /// nobody else refers to it and if the constraints did not change.
+      virtual bool impl_computeInPlace (ConfigurationIn_t q1,
+					ConfigurationIn_t q2,
+					PathPtr_t& path) const
+      {
+        value_type length = (*distance_) (q1, q2);
+	if (path && path.unique () && path == reusable_.lock () &&
+	    reusableConstraints_.lock () == constraints ()) {
+	  HPP_STATIC_PTR_CAST (StraightPath, path)->reset (q1, q2, length);
+	  return true;
+	}
+	StraightPathPtr_t straight = StraightPath::create
+	  (device_.lock (), q1, q2, length, constraints ());
+	reusable_ = straight;
+	reusableConstraints_ = constraints ();
+	path = straight;
+	return true;
+      }
     protected:
       /// Constructor with robot
       /// Weighed distance is created from robot
       SteeringMethodStraight (const DevicePtr_t& device) :
 	SteeringMethod (), device_ (device),
-	distance_ (WeighedDistance::create (device)), weak_ ()
+	distance_ (WeighedDistance::create (device)), reusable_ (),
+	reusableConstraints_ (), weak_ ()
       {
       }
       /// Constructor with weighed distance
       SteeringMethodStraight (const DevicePtr_t& device,
 			      const WeighedDistancePtr_t& distance) :
 	SteeringMethod (), device_ (device),
-	distance_ (distance), weak_ ()
+	distance_ (distance), reusable_ (), reusableConstraints_ (), weak_ ()
       {
       }
       /// Copy constructor
       SteeringMethodStraight (const SteeringMethodStraight& other) :
 	SteeringMethod (other), device_ (other.device_),
-	distance_ (other.distance_), weak_ ()
+	distance_ (other.distance_), reusable_ (), reusableConstraints_ (),
+	weak_ ()
       {
       }
 
@@ -106,6 +130,10 @@ namespace hpp {
     private:
       DeviceWkPtr_t device_;
       WeighedDistancePtr_t distance_;
+      /// Path created by the last call to impl_computeInPlace and
+      /// constraints it was created with
+      mutable StraightPathWkPtr_t reusable_;
+      mutable ConstraintSetWkPtr_t reusableConstraints_;
       SteeringMethodStraightWkPtr_t weak_;
     }; // SteeringMethodStraight
     /// \}
@@ -20,6 +20,7 @@
 # define HPP_CORE_STEERING_METHOD_HH
 
 # include <hpp/core/path.hh>
+# include <hpp/core/operation-counters.hh>
 
 namespace hpp {
   namespace core {
@@ -40,9 +41,28 @@ namespace hpp {
       PathPtr_t operator() (ConfigurationIn_t q1,
 			    ConfigurationIn_t q2) const
       {
+	OperationCounters::increment (OperationCounters::STEERING);
 	return impl_compute (q1, q2);
       }
 
+      /// create a path between two configurations, reusing storage
+      /// \param q1, q2 configurations to link,
+      /// \retval path if path holds the only reference to a path created by
+      ///         a previous call, the steering method may modify this path
+      ///         instead of allocating a new one; otherwise a new path is
+      ///         created. path is empty if no path could be built.
+      /// \return whether a path was built.
+      ///
+      /// Meant for loops where most paths are rejected by path validation:
+      /// a path that is kept, in a roadmap for instance, is referenced
+      /// elsewhere and is therefore never modified by later calls.
+      bool operator() (ConfigurationIn_t q1, ConfigurationIn_t q2,
+		       PathPtr_t& path) const
+      {
+	OperationCounters::increment (OperationCounters::STEERING);
+	return impl_computeInPlace (q1, q2, path);
+      }
+
       /// Copy instance and return shared pointer
       virtual SteeringMethodPtr_t copy () const = 0;
 
@@ -82,6 +102,16 @@ namespace hpp {
       /// create a path between two configurations
       virtual PathPtr_t impl_compute (ConfigurationIn_t q1,
 				      ConfigurationIn_t q2) const = 0;
+      /// create a path between two configurations, reusing storage
+      ///
+      /// Default implementation always creates a new path with impl_compute.
+      virtual bool impl_computeInPlace (ConfigurationIn_t q1,
+					ConfigurationIn_t q2,
+					PathPtr_t& path) const
+      {
+	path = impl_compute (q1, q2);
+	return path;
+      }
       /// Store weak pointer to itself.
       void init (SteeringMethodWkPtr_t weak)
       {
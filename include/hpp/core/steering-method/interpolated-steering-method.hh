@@ -18,7 +18,13 @@
 #ifndef HPP_CORE_STEERING_METHOD_INTERPOLATED_HH
 # define HPP_CORE_STEERING_METHOD_INTERPOLATED_HH
 
+# include <algorithm>
+# include <list>
+# include <map>
+# include <utility>
 # include <hpp/core/steering-method.hh>
+# include <hpp/core/config-projector.hh>
+# include <hpp/core/constraint-set.hh>
 # include <hpp/core/interpolated-path.hh>
 # include <hpp/core/weighed-distance.hh>
 
@@ -28,8 +34,17 @@ namespace hpp {
       /// \addtogroup steering_method
       /// \{
 
-      /// Steering method that creates StraightPath instances
+      /// Steering method that creates InterpolatedPath instances
       ///
+      /// Creating a path copies the constraints of the steering method.
+      /// Optimizers steer again and again between the same configurations:
+      /// the paths created can be stored, identified by the end
+      /// configurations, the revisions of the constraint set and of its
+      /// config projector (see Constraint::revision) and the right hand
+      /// side of the config projector, so that later calls return the
+      /// stored path. When the cache is full, the least recently used path
+      /// is removed. The cache is disabled by default and is not shared by
+      /// copies.
       class HPP_CORE_DLLAPI Interpolated : public SteeringMethod
       {
         public:
@@ -72,31 +87,87 @@ namespace hpp {
           virtual PathPtr_t impl_compute (ConfigurationIn_t q1,
               ConfigurationIn_t q2) const
           {
-            value_type length = (*distance_) (q1, q2);
-            PathPtr_t path = InterpolatedPath::create (device_.lock (), q1, q2,
-                length, constraints ());
+            if (cacheSize_ == 0) return interpolate (q1, q2);
+            CacheKey k;
+            key (q1, q2, k);
+            CacheIndex_t::iterator it = cacheIndex_.find (k);
+            if (it != cacheIndex_.end ()) {
+              const PathPtr_t& path (it->second->second);
+              // The right hand side of the constraints of the path may have
+              // been modified since it was stored.
+              if (rightHandSide (path->constraints ()) == k.rightHandSide) {
+                ++cacheHits_;
+                cache_.splice (cache_.begin (), cache_, it->second);
+                return path;
+              }
+              cache_.erase (it->second);
+              cacheIndex_.erase (it);
+            }
+            PathPtr_t path = interpolate (q1, q2);
+            if (path) {
+              cache_.push_front (std::make_pair (k, path));
+              cacheIndex_ [k] = cache_.begin ();
+              trimCache ();
+            }
             return path;
           }
 
+          /// \name Cache of paths
+          /// \{
+
+          /// Set maximal number of stored paths
+          /// \param size 0 disables the cache.
+          void cacheSize (std::size_t size)
+          {
+            cacheSize_ = size;
+            trimCache ();
+          }
+
+          /// Get maximal number of stored paths
+          std::size_t cacheSize () const
+          {
+            return cacheSize_;
+          }
+
+          /// Remove stored paths and reset counter
+          void clearCache ()
+          {
+            cache_.clear ();
+            cacheIndex_.clear ();
+            cacheHits_ = 0;
+          }
+
+          /// Number of paths found in the cache
+          std::size_t cacheHits () const
+          {
+            return cacheHits_;
+          }
+          /// \}
+
         protected:
           /// Constructor with robot
           /// Weighed distance is created from robot
           Interpolated (const DevicePtr_t& device) :
             SteeringMethod (), device_ (device),
-            distance_ (WeighedDistance::create (device)), weak_ ()
+            distance_ (WeighedDistance::create (device)), cacheSize_ (0),
+            cache_ (), cacheIndex_ (), cacheHits_ (0), weak_ ()
           {}
 
           /// Constructor with weighed distance
           Interpolated (const DevicePtr_t& device,
               const WeighedDistancePtr_t& distance) :
             SteeringMethod (), device_ (device),
-            distance_ (distance), weak_ ()
+            distance_ (distance), cacheSize_ (0), cache_ (), cacheIndex_ (),
+            cacheHits_ (0), weak_ ()
           {}
 
           /// Copy constructor
+          ///
+          /// Stored paths are not copied: copies are used by other threads.
           Interpolated (const Interpolated& other) :
             SteeringMethod (other), device_ (other.device_),
-            distance_ (other.distance_), weak_ ()
+            distance_ (other.distance_), cacheSize_ (other.cacheSize_),
+            cache_ (), cacheIndex_ (), cacheHits_ (0), weak_ ()
           {}
 
           /// Store weak pointer to itself
@@ -107,8 +178,91 @@ namespace hpp {
           }
 
         private:
+          /// Identification of a path
+          struct CacheKey
+          {
+            Configuration_t initial;
+            Configuration_t end;
+            /// Revisions of the constraint set and of its config projector
+            std::size_t constraints;
+            std::size_t configProjector;
+            vector_t rightHandSide;
+            bool operator< (const CacheKey& other) const
+            {
+              if (lessThan (initial, other.initial)) return true;
+              if (lessThan (other.initial, initial)) return false;
+              if (lessThan (end, other.end)) return true;
+              if (lessThan (other.end, end)) return false;
+              if (constraints != other.constraints)
+                return constraints < other.constraints;
+              if (configProjector != other.configProjector)
+                return configProjector < other.configProjector;
+              return lessThan (rightHandSide, other.rightHandSide);
+            }
+          }; // struct CacheKey
+          typedef std::list <std::pair <CacheKey, PathPtr_t> > Cache_t;
+          typedef std::map <CacheKey, Cache_t::iterator>
+            CacheIndex_t;
+
+          static bool lessThan (vectorIn_t v1, vectorIn_t v2)
+          {
+            if (v1.size () != v2.size ()) return v1.size () < v2.size ();
+            return std::lexicographical_compare
+              (v1.data (), v1.data () + v1.size (),
+               v2.data (), v2.data () + v2.size ());
+          }
+
+          /// Right hand side of the config projector of constraints
+          static vector_t rightHandSide (const ConstraintSetPtr_t& constraints)
+          {
+            if (!constraints) return vector_t ();
+            const ConfigProjectorPtr_t& cp (constraints->configProjector ());
+            if (cp) return cp->rightHandSide ();
+            return vector_t ();
+          }
+
+          /// Create a path without using the cache
+          PathPtr_t interpolate (ConfigurationIn_t q1, ConfigurationIn_t q2)
+            const
+          {
+            value_type length = (*distance_) (q1, q2);
+            PathPtr_t path = InterpolatedPath::create (device_.lock (), q1, q2,
+                length, constraints ());
+            return path;
+          }
+
+          void key (ConfigurationIn_t q1, ConfigurationIn_t q2, CacheKey& k)
+            const
+          {
+            k.initial = q1;
+            k.end = q2;
+            k.constraints = 0;
+            k.configProjector = 0;
+            if (constraints ()) {
+              k.constraints = constraints ()->revision ();
+              const ConfigProjectorPtr_t& cp
+                (constraints ()->configProjector ());
+              if (cp) k.configProjector = cp->revision ();
+            }
+            k.rightHandSide = rightHandSide (constraints ());
+          }
+
+          void trimCache () const
+          {
+            // std::list::size may be linear
+            while (cacheIndex_.size () > cacheSize_) {
+              cacheIndex_.erase (cache_.back ().first);
+              cache_.pop_back ();
+            }
+          }
+
           DeviceWkPtr_t device_;
           WeighedDistancePtr_t distance_;
+          std::size_t cacheSize_;
+          /// Stored paths, the most recently used first
+          mutable Cache_t cache_;
+          mutable CacheIndex_t cacheIndex_;
+          mutable std::size_t cacheHits_;
           InterpolatedWkPtr_t weak_;
       }; // Interpolated
       /// \}
@@ -141,6 +141,17 @@ namespace hpp {
 	end_ = end;
       }
       
+      /// Reset path between new configurations
+      ///
+      /// \param init, end Start and end configurations of the path
+      /// \param length Distance between the configurations.
+      /// The right hand side of the constraints is updated with the initial
+      /// configuration, as at construction.
+      /// \warning the path is modified in place, it should not be referred to
+      ///          by other objects, see SteeringMethod::operator().
+      void reset (ConfigurationIn_t init, ConfigurationIn_t end,
+		  value_type length);
+
       /// Return the internal robot.
       DevicePtr_t device () const;
 
@@ -198,10 +209,22 @@ namespace hpp {
       virtual bool impl_compute (ConfigurationOut_t result,
 				 value_type param) const;
 
+      /// Interpolate all the parameters block by block
+      virtual void impl_eval (vectorIn_t times, matrixOut_t configurations,
+			      std::vector <bool>& success) const;
+
+      /// Velocity is constant along the path
+      virtual bool impl_velocityBound (vectorOut_t result, value_type t0,
+				       value_type t1) const;
+
+      virtual std::size_t impl_memoryUsage () const;
+
     private:
       DevicePtr_t device_;
       Configuration_t initial_;
       Configuration_t end_;
+      /// Shared by the paths of the device
+      InterpolationPlanPtr_t plan_;
       StraightPathWkPtr_t weak_;
     }; // class StraightPath
   } //   namespace core
@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_SWEPT_VOLUME_HH
+# define HPP_CORE_SWEPT_VOLUME_HH
+
+# include <vector>
+# include <hpp/fcl/BV/AABB.h>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup roadmap
+    /// \{
+
+    /// Bounding boxes of the volumes swept by the bodies of a robot along
+    /// a path
+    ///
+    /// The box of a body contains its collision objects at the middle of
+    /// the path, enlarged by an upper bound of the distance run by the
+    /// points of the body during half the path. This bound is the product
+    /// of the velocity bounds of the path (see Path::velocityBound) by
+    /// coefficients depending on the joints from the body to the root
+    /// joint, computed once. A box costs one forward kinematics and no
+    /// collision test.
+    class HPP_CORE_DLLAPI SweptVolume
+    {
+    public:
+      typedef std::vector <fcl::AABB> Boxes_t;
+
+      /// Create instance and return shared pointer
+      /// \param robot robot the bodies of which are bounded.
+      static SweptVolumePtr_t create (const DevicePtr_t& robot);
+
+      /// Get joints holding a body with collision objects
+      /// \note the boxes computed by compute have the same order.
+      const JointVector_t& joints () const
+      {
+	return joints_;
+      }
+
+      /// Compute the boxes of the bodies along a path
+      /// \param path path of the robot,
+      /// \retval boxes one box for each joint of joints ().
+      /// \return false if the path does not provide velocity bounds or
+      ///         cannot be evaluated at its middle.
+      /// \note the current configuration of the robot is modified.
+      bool compute (const PathPtr_t& path, Boxes_t& boxes);
+
+      /// Whether a box of a set overlaps a box of another set
+      static bool overlap (const Boxes_t& boxes1, const Boxes_t& boxes2);
+
+    protected:
+      SweptVolume (const DevicePtr_t& robot);
+
+    private:
+      typedef std::pair <JointConstPtr_t, value_type> CoefficientVelocity_t;
+      DevicePtr_t robot_;
+      JointVector_t joints_;
+      /// For each joint of joints_, joints from the joint to the root joint
+      /// and coefficients multiplying their velocity in the velocity bound
+      /// of the body points
+      std::vector <std::vector <CoefficientVelocity_t> > coefficients_;
+      /// Velocity bounds of the degrees of freedom along the current path
+      vector_t bound_;
+      Configuration_t q_;
+    }; // class SweptVolume
+    /// \}
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_SWEPT_VOLUME_HH
@@ -0,0 +1,160 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_TIME_PARAMETERIZED_PATH_HH
+# define HPP_CORE_TIME_PARAMETERIZED_PATH_HH
+
+# include <hpp/core/fwd.hh>
+# include <hpp/core/config.hh>
+# include <hpp/core/path.hh>
+
+namespace hpp {
+  namespace core {
+    /// Path following another path with a trapezoidal time law
+    ///
+    /// The parameter of the original path starts and ends at rest. Its
+    /// derivative with respect to time increases with constant
+    /// acceleration up to the maximal velocity, stays constant and decreases
+    /// with constant deceleration. If the original path is too short to
+    /// reach the maximal velocity, the velocity profile is triangular.
+    ///
+    /// The parameter of this path is time, starting at 0.
+    /// \note Decorator design pattern
+    class HPP_CORE_DLLAPI TimeParameterizedPath : public Path
+    {
+    public:
+      typedef Path parent_t;
+
+      virtual ~TimeParameterizedPath () throw () {}
+
+      /// Create instance and return shared pointer
+      /// \param original path to follow,
+      /// \param velocity maximal derivative of the parameter of the
+      ///        original path with respect to time, may be infinite,
+      /// \param acceleration maximal second derivative of the parameter of
+      ///        the original path with respect to time, may be infinite.
+      /// If both velocity and acceleration are infinite, the path has
+      /// zero duration.
+      static TimeParameterizedPathPtr_t create
+	(const PathPtr_t& original, value_type velocity,
+	 value_type acceleration);
+
+      static TimeParameterizedPathPtr_t createCopy
+	(const TimeParameterizedPathPtr_t& path);
+
+      static TimeParameterizedPathPtr_t createCopy
+	(const TimeParameterizedPathPtr_t& path,
+	 const ConstraintSetPtr_t& constraints);
+
+      /// Return a shared pointer to a copy of this
+      virtual PathPtr_t copy () const
+      {
+	return createCopy (weak_.lock ());
+      }
+
+      /// Return a shared pointer to a copy of this and set constraints
+      ///
+      /// \param constraints constraints to apply to the copy
+      /// \precond *this should not have constraints.
+      virtual PathPtr_t copy (const ConstraintSetPtr_t& constraints) const
+      {
+	return createCopy (weak_.lock (), constraints);
+      }
+
+      virtual bool impl_compute (ConfigurationOut_t result,
+				 value_type t) const
+      {
+	return original_->impl_compute (result, originalParam (t));
+      }
+
+      virtual void impl_eval (vectorIn_t times, matrixOut_t configurations,
+			      std::vector <bool>& success) const;
+
+      /// Get the initial configuration
+      virtual Configuration_t initial () const
+      {
+	return original_->initial ();
+      }
+
+      /// Get the final configuration
+      virtual Configuration_t end () const
+      {
+	return original_->end ();
+      }
+
+      /// Get path followed by this path
+      const PathPtr_t& original () const
+      {
+	return original_;
+      }
+
+      /// Get parameter of the original path at a time
+      value_type originalParam (value_type t) const;
+
+      /// Get derivative of the parameter of the original path at a time
+      value_type paramDerivative (value_type t) const;
+
+      /// Get maximal derivative of the parameter of the original path
+      ///
+      /// Smaller than the velocity given at construction if the velocity
+      /// profile is triangular.
+      value_type velocity () const
+      {
+	return velocity_;
+      }
+
+      /// Get second derivative of the parameter of the original path
+      /// during the acceleration phase
+      value_type acceleration () const
+      {
+	return acceleration_;
+      }
+
+    protected:
+      /// Bounds of the velocity of the original path times the maximal
+      /// derivative of its parameter over the interval
+      virtual bool impl_velocityBound (vectorOut_t result, value_type t0,
+				       value_type t1) const;
+
+      /// Size of this path and of the original path
+      virtual std::size_t impl_memoryUsage () const;
+
+      /// Print path in a stream
+      virtual std::ostream& print (std::ostream &os) const;
+
+      TimeParameterizedPath (const PathPtr_t& original, value_type velocity,
+			     value_type acceleration);
+
+      TimeParameterizedPath (const TimeParameterizedPath& path);
+
+      TimeParameterizedPath (const TimeParameterizedPath& path,
+			     const ConstraintSetPtr_t& constraints);
+
+      void init (const TimeParameterizedPathPtr_t& self);
+
+    private:
+      PathPtr_t original_;
+      value_type velocity_;
+      value_type acceleration_;
+      /// Duration of the acceleration and of the deceleration phases
+      value_type accelerationTime_;
+      TimeParameterizedPathWkPtr_t weak_;
+    }; // class TimeParameterizedPath
+  } //   namespace core
+} // namespace hpp
+#endif // HPP_CORE_TIME_PARAMETERIZED_PATH_HH
@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_TRACE_HH
+# define HPP_CORE_TRACE_HH
+
+# include <iostream>
+# include <string>
+# include <boost/atomic.hpp>
+# include <boost/date_time/posix_time/posix_time_types.hpp>
+# include <hpp/core/config.hh>
+
+namespace hpp {
+  namespace core {
+    /// \addtogroup path_planning
+    /// \{
+
+    /// Trace of the calls to the hot functions of the library
+    ///
+    /// When tracing is enabled, TraceScope instances placed at the
+    /// beginning of functions like ConfigProjector::impl_compute,
+    /// CollisionValidation::validate or KDTree::search add an event with
+    /// the name of the function, the calling thread, its start time and
+    /// duration. The trace is written in the JSON trace event format, that
+    /// can be loaded in chrome://tracing or Perfetto.
+    ///
+    /// Each thread stores its events in its own buffer, so that tracing
+    /// does not synchronize threads. Events are kept until clear is
+    /// called, including events of threads that have terminated. When
+    /// tracing is disabled, which is the default, the cost of a scope is
+    /// the test of a flag.
+    class HPP_CORE_DLLAPI Trace
+    {
+    public:
+      /// Enable or disable tracing
+      static void enable (bool enable);
+      /// Whether tracing is enabled
+      static bool enabled ()
+      {
+	return enabled_.load (boost::memory_order_relaxed);
+      }
+      /// Add an event of the calling thread that started at a given time and
+      /// ends now
+      /// \param name name of the event, not copied: should be a string
+      ///        literal.
+      static void add (const char* name,
+		       const boost::posix_time::ptime& start);
+      /// Remove all events
+      static void clear ();
+      /// Get number of events
+      static std::size_t numberEvents ();
+      /// Write events in the JSON trace event format
+      static std::ostream& write (std::ostream& os);
+      /// Write events in a file in the JSON trace event format
+      /// \throw std::runtime_error if the file cannot be written.
+      static void write (const std::string& filename);
+
+    private:
+      static boost::atomic <bool> enabled_;
+    }; // class Trace
+
+    /// Event of the Trace covering the lifetime of the instance
+    class TraceScope
+    {
+    public:
+      /// Start event if tracing is enabled
+      /// \param name name of the event, see Trace::add.
+      TraceScope (const char* name) :
+	name_ (Trace::enabled () ? name : 0x0), start_ ()
+      {
+	if (name_) {
+	  start_ = boost::posix_time::microsec_clock::universal_time ();
+	}
+      }
+      ~TraceScope ()
+      {
+	if (name_) Trace::add (name_, start_);
+      }
+    private:
+      TraceScope (const TraceScope&);
+      TraceScope& operator= (const TraceScope&);
+      const char* name_;
+      boost::posix_time::ptime start_;
+    }; // class TraceScope
+    /// \}
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_TRACE_HH
@@ -19,6 +19,8 @@
 #ifndef HPP_CORE_VISIBILITY_PRM_PLANNER_HH
 # define HPP_CORE_VISIBILITY_PRM_PLANNER_HH
 
+# include <deque>
+# include <vector>
 # include <boost/tuple/tuple.hpp>
 # include <hpp/core/path-planner.hh>
 
@@ -38,10 +40,48 @@ namespace hpp {
 	(const Problem& problem, const RoadmapPtr_t& roadmap);
       /// Return shared pointer to new object.
       static VisibilityPrmPlannerPtr_t create (const Problem& problem);
+      /// Forget guard nodes of previous resolutions and tag init and goal
+      /// configurations in the roadmap
+      virtual void startSolve ();
       /// One step of extension.
       virtual void oneStep ();
+      /// Remove redundant nodes of the roadmap, except guard nodes
+      virtual void pruneRoadmap ();
       /// Set configuration shooter.
       void configurationShooter (const ConfigurationShooterPtr_t& shooter);
+      /// Set number of nearest guard nodes of a connected component tested
+      /// for visibility
+      /// \param size number of nodes, 0 means all guard nodes of the
+      ///        component.
+      void neighborhoodSize (std::size_t size)
+      {
+	neighborhoodSize_ = size;
+      }
+      /// Get number of nearest nodes tested for visibility
+      std::size_t neighborhoodSize () const
+      {
+	return neighborhoodSize_;
+      }
+      /// \name Parallel sampling and visibility tests
+      /// \{
+
+      /// Remove problems used by worker threads
+      ///
+      /// If problems have been added by PathPlanner::addThreadProblem,
+      /// valid random configurations are shot by one thread per problem,
+      /// with the configuration shooter of the problem, and queued for the
+      /// next steps. The visibility of a configuration from the connected
+      /// components is tested by the threads, each thread handling some
+      /// components. The roadmap is modified afterwards.
+      ///
+      /// Configurations shot by the worker threads and not used yet are
+      /// removed as well.
+      virtual void resetThreadProblems ()
+      {
+	PathPlanner::resetThreadProblems ();
+	samples_.clear ();
+      }
+      /// \}
     protected:
       /// Constructor
       VisibilityPrmPlanner (const Problem& problem, 
@@ -57,18 +97,36 @@ namespace hpp {
       ConfigurationShooterPtr_t configurationShooter_;
       VisibilityPrmPlannerWkPtr_t weakPtr_;
       DelayedEdges_t delayedEdges_;
-      std::map <NodePtr_t, bool> nodeStatus_; // true for guard node
+      /// Whether nodes are guards, indexed by Node::index
+      std::vector <char> isGuard_;
+      /// Guard nodes in order of creation
+      Nodes_t guards_;
+      std::size_t neighborhoodSize_; // 0 for all nodes
+
+      /// Valid configurations shot by worker threads, not used yet
+      std::deque <ConfigurationPtr_t> samples_;
 
-      /// Return true if the configuration is visible from the given 
-      /// connected component.
-      bool visibleFromCC (const ConfigurationPtr_t q, 
-			  const ConnectedComponentPtr_t cc);
-      
-      /// Apply the problem constraints on a given configuration qTo by 
-      /// projecting it on the tangent space of qFrom.
-      ConfigurationPtr_t applyConstraints (const ConfigurationPtr_t qFrom, 
-					   const ConfigurationPtr_t qTo);
-      bool constrApply_; // True if applyConstraints has successed
+      /// Tag a node as a guard
+      void addGuard (const NodePtr_t& node);
+      /// Whether a node is a guard
+      bool isGuard (const NodePtr_t& node) const;
+      /// Guard nodes of each connected component of the roadmap, in the
+      /// order of the components
+      void guardsByComponent (std::vector <Nodes_t>& guards) const;
+      /// Keep the guard nodes tested for visibility from a configuration
+      /// and sort them by increasing distance
+      void nearestGuards (const ConfigurationPtr_t& q, Nodes_t& guards) const;
+      /// Return true if the configuration is visible from one of the guard
+      /// nodes of a connected component.
+      bool visibleFromCC (const ConfigurationPtr_t q, const Nodes_t& guards);
+      /// Shoot a valid configuration, in worker threads if any
+      ConfigurationPtr_t shootValid (const Configuration_t& qInit);
+      /// Test visibility from all connected components in worker threads
+      /// \param guards the guard nodes of each component, they are sorted
+      ///        by nearestGuards.
+      /// \return the number of components q is visible from.
+      std::size_t visibleInParallel (const ConfigurationPtr_t& q,
+				     std::vector <Nodes_t>& guards);
     };
     /// \}
   } // namespace core
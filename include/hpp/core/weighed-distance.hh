@@ -19,6 +19,7 @@
 #ifndef HPP_CORE_WEIGHED_DISTANCE_HH
 # define HPP_CORE_WEIGHED_DISTANCE_HH
 
+# include <string>
 # include <hpp/core/distance.hh>
 
 namespace hpp {
@@ -39,6 +40,12 @@ namespace hpp {
       static WeighedDistancePtr_t createCopy
 	(const WeighedDistancePtr_t& distance);
       virtual DistancePtr_t clone () const;
+      /// Remove the weights stored by create (robot)
+      ///
+      /// Weights computed from a robot are stored and reused by the next
+      /// instances created for a robot with the same kinematic tree, bodies
+      /// and current configuration, in the same or in another problem.
+      static void clearWeightsCache ();
       /// Get weight of joint at given rank
       /// \param rank rank of the joint in robot joint vector
       value_type getWeight( std::size_t rank ) const;
@@ -56,18 +63,81 @@ namespace hpp {
       {
 	return robot_;
       }
+
+      /// Compute distances between a configuration and several others
+      ///
+      /// Translations, bounded and unbounded rotations and SO3 joints are
+      /// processed for all configurations at once. Other joints use their
+      /// own distance for each configuration.
+      ///
+      /// If all joints have a Euclidean distance, distances are computed,
+      /// as the distance between two configurations, by one weighted
+      /// reduction of the squared differences of configurations.
+      virtual void distances (ConfigurationIn_t q, matrixIn_t configurations,
+			      vectorOut_t result) const;
+
+      /// Compute distance up to a bound
+      ///
+      /// Squared weighed distances of the joints are accumulated until
+      /// the squared bound is exceeded.
+      virtual value_type boundedDistance (ConfigurationIn_t q1,
+					  ConfigurationIn_t q2,
+					  value_type bound) const;
     protected:
       WeighedDistance (const DevicePtr_t& robot);
       WeighedDistance (const DevicePtr_t& robot,
 		       const std::vector <value_type>& weights);
       WeighedDistance (const WeighedDistance& distance);
       void init (WeighedDistanceWkPtr_t self);
+      /// Compute weights from the Jacobians of the joints of the robot
+      void computeWeights ();
+      /// Identify the data the weights computed from the robot depend on
+      std::string weightsKey () const;
+      /// Store, for each joint with degrees of freedom, its rank in the
+      /// configuration and the size of its configuration if its distance is
+      /// Euclidean, 0 otherwise.
+      void computeJointTable ();
+      /// Compute the squared weights of the configuration variables, if all
+      /// joints with degrees of freedom have a Euclidean distance.
+      void computeSquaredWeights ();
+      /// Sum of the squared weighed distances of the joints
+      ///
+      /// The sum stops as soon as it exceeds bound2.
+      value_type squaredDistance (ConfigurationIn_t q1, ConfigurationIn_t q2,
+				  value_type bound2) const;
       /// Derived class should implement this function
       virtual value_type impl_distance (ConfigurationIn_t q1,
 				    ConfigurationIn_t q2) const;
     private:
       DevicePtr_t robot_;
       std::vector <value_type> weights_;
+      /// Joint with degrees of freedom and how its distance is computed
+      struct JointData {
+	/// How distances computes the distance of the joint
+	enum Type {
+	  /// Norm of the difference of configurations
+	  EUCLIDEAN,
+	  /// Angle of the rotation between two unit quaternions
+	  QUATERNION,
+	  /// Difference of angles modulo 2 pi
+	  ANGLE,
+	  /// Angle between two unit complex numbers
+	  UNIT_COMPLEX,
+	  /// Computed by the joint configuration
+	  OTHER
+	}; // enum Type
+	JointPtr_t joint;
+	size_type rank;
+	/// Size of the configuration if the distance is Euclidean, 0
+	/// otherwise
+	size_type euclideanSize;
+	Type type;
+      }; // struct JointData
+      std::vector <JointData> joints_;
+      /// Whether all joints with degrees of freedom have a Euclidean distance
+      bool euclidean_;
+      /// If euclidean_, squared weight of each configuration variable
+      vector_t squaredWeights_;
       WeighedDistanceWkPtr_t weak_;
     }; // class WeighedDistance
     /// \}
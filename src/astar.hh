@@ -20,51 +20,82 @@
 # define HPP_CORE_ASTAR_HH
 
 # include <limits>
+# include <queue>
+# include <vector>
+# include <functional>
 # include <hpp/core/fwd.hh>
 # include <hpp/core/distance.hh>
 # include <hpp/core/edge.hh>
 # include <hpp/core/node.hh>
+# include <hpp/core/operation-counters.hh>
+# include <hpp/core/path-cost.hh>
 # include <hpp/core/path-vector.hh>
+# include <hpp/core/trace.hh>
 
 namespace hpp {
   namespace core {
     class Astar
     {
+    public:
       typedef std::list < NodePtr_t > Nodes_t;
       typedef std::list <EdgePtr_t> Edges_t;
-      typedef std::map <NodePtr_t, EdgePtr_t> Parent_t;
-      Nodes_t closed_;
-      Nodes_t open_;
-      std::map <NodePtr_t, value_type> costFromStart_;
-      std::map <NodePtr_t, value_type> estimatedCostToGoal_;
-      Parent_t parent_;
+    private:
+      // Estimated cost to goal and index of nodes in the open set
+      typedef std::pair <value_type, std::size_t> OpenNode_t;
+      typedef std::priority_queue <OpenNode_t, std::vector <OpenNode_t>,
+				   std::greater <OpenNode_t> > OpenSet_t;
+      // Data about nodes are stored in arrays indexed by Node::index
+      std::vector <NodePtr_t> nodes_;
+      std::vector <bool> closed_;
+      OpenSet_t open_;
+      std::vector <value_type> costFromStart_;
+      std::vector <EdgePtr_t> parent_;
       RoadmapPtr_t roadmap_;
       DistancePtr_t distance_;
+      // Cost of the edges, their length if empty
+      PathCostPtr_t cost_;
+      // Factor of the distance to goal in the heuristic
+      value_type distanceFactor_;
 
     public:
-      Astar (const RoadmapPtr_t& roadmap, const DistancePtr_t distance) :
-	roadmap_ (roadmap), distance_ (distance)
+      /// Constructor
+      /// \param cost cost of the paths of the edges, their length if empty.
+      Astar (const RoadmapPtr_t& roadmap, const DistancePtr_t distance,
+	     const PathCostPtr_t& cost = PathCostPtr_t ()) :
+	nodes_ (), closed_ (), open_ (), costFromStart_ (), parent_ (),
+	roadmap_ (roadmap), distance_ (distance), cost_ (cost),
+	distanceFactor_ (cost ? cost->distanceFactor () : 1)
       {
       }
 
-      PathVectorPtr_t solution ()
+      /// Compute the edges of the shortest path to the goal nodes
+      Edges_t solutionEdges ()
       {
 	NodePtr_t node = findPath ();
 	Edges_t edges;
 
 	while (node) {
-	  Parent_t::const_iterator itEdge = parent_.find (node);
-	  if (itEdge != parent_.end ()) {
-	    EdgePtr_t edge = itEdge->second;
+	  EdgePtr_t edge = parent_ [node->index ()];
+	  if (edge) {
 	    edges.push_front (edge);
 	    node = edge->from ();
 	  }
 	  else node = NodePtr_t (0x0);
 	}
+	return edges;
+      }
+
+      PathVectorPtr_t solution ()
+      {
+	Edges_t edges (solutionEdges ());
 	PathVectorPtr_t pathVector;
 	for (Edges_t::const_iterator itEdge = edges.begin ();
 	     itEdge != edges.end (); ++itEdge) {
 	  const PathPtr_t& path ((*itEdge)->path ());
+	  if (!path) {
+	    throw std::runtime_error
+	      ("Failed to compute the path of an edge of the solution.");
+	  }
 	  if (!pathVector)
 	    pathVector = PathVector::create (path->outputSize (),
 					     path->outputDerivativeSize ());
@@ -74,87 +105,67 @@ namespace hpp {
       }
 
     private:
-      struct SortFunctor {
-	std::map <NodePtr_t, value_type>& cost_;
-	SortFunctor (std::map <NodePtr_t, value_type>& cost) :
-	  cost_ (cost) {}
-	bool operator () (const NodePtr_t& n1, const NodePtr_t& n2)
-	{
-	  return cost_ [n1] < cost_ [n2];
-	}
-      }; // struc SortFunctor
-
-      bool isGoal (const NodePtr_t node)
+      void initialize ()
       {
-	for (Nodes_t::const_iterator itGoal = roadmap_->goalNodes ().begin ();
-	     itGoal != roadmap_->goalNodes ().end (); ++itGoal) {
-	  if (*itGoal == node) {
-	    return true;
-	  }
-	}
-	return false;
+	std::size_t size = roadmap_->nodeIndexBound ();
+	nodes_.assign (size, NodePtr_t (0x0));
+	closed_.assign (size, false);
+	costFromStart_.assign (size,
+			       std::numeric_limits <value_type>::infinity ());
+	parent_.assign (size, EdgePtr_t (0x0));
+	open_ = OpenSet_t ();
       }
 
       NodePtr_t findPath ()
       {
-	closed_.clear ();
-	open_.clear ();
-	parent_.clear ();
-	estimatedCostToGoal_.clear ();
-	costFromStart_.clear ();
-
-	open_.push_back (roadmap_->initNode ());
+	TraceScope trace ("Astar::findPath");
+	initialize ();
+	NodePtr_t initNode (roadmap_->initNode ());
+	costFromStart_ [initNode->index ()] = 0;
+	nodes_ [initNode->index ()] = initNode;
+	open_.push (OpenNode_t (heuristic (initNode), initNode->index ()));
 	while (!open_.empty ()) {
-	  open_.sort (SortFunctor (estimatedCostToGoal_));
-	  Nodes_t::iterator itv = open_.begin ();
-	  NodePtr_t current (*itv);
-	  if (isGoal (current)) {
+	  std::size_t index = open_.top ().second;
+	  open_.pop ();
+	  OperationCounters::increment (OperationCounters::ASTAR_EXPANSION);
+	  // Nodes are pushed again in the open set when their cost decreases,
+	  // older entries are skipped.
+	  if (closed_ [index]) continue;
+	  NodePtr_t current (nodes_ [index]);
+	  if (current->isGoal ()) {
 	    return current;
 	  }
-	  open_.erase (itv);
-	  closed_.push_back (current);
-	  for (Edges_t::const_iterator itEdge = current->outEdges ().begin ();
+	  closed_ [index] = true;
+	  for (Node::Edges_t::const_iterator itEdge =
+		 current->outEdges ().begin ();
 	       itEdge != current->outEdges ().end (); ++itEdge) {
-	    value_type transitionCost = edgeCost (*itEdge);
-	    NodePtr_t child ((*itEdge)->to ());
-	    if (std::find (closed_.begin (), closed_.end (), child) ==
-		closed_.end ()) {
-	      // node is not in closed set
-	      value_type tmpCost = costFromStart_ [current] + transitionCost;
-	      bool childNotInOpenSet = (std::find (open_.begin (),
-						   open_.end (),
-						   child) == open_.end ());
-	      if ((childNotInOpenSet) || (tmpCost < costFromStart_ [child])) {
-		parent_ [child] = *itEdge;
-		costFromStart_ [child] = tmpCost;
-		estimatedCostToGoal_ [child] = costFromStart_ [child] +
-		  heuristic (child);
-		if (childNotInOpenSet) open_.push_back (child);
-	      }
+	    NodePtr_t childNode ((*itEdge)->to ());
+	    std::size_t child = childNode->index ();
+	    if (closed_ [child]) continue;
+	    value_type tmpCost = costFromStart_ [index] + edgeCost (*itEdge);
+	    if (tmpCost < costFromStart_ [child]) {
+	      nodes_ [child] = childNode;
+	      parent_ [child] = *itEdge;
+	      costFromStart_ [child] = tmpCost;
+	      open_.push (OpenNode_t (tmpCost + heuristic (childNode), child));
 	    }
 	  }
 	}
 	throw std::runtime_error ("A* failed to find a solution to the goal.");
       }
 
-      value_type heuristic (const NodePtr_t node) const
+      // Distance to goal scaled by the factor of the cost, so that the
+      // heuristic is admissible. Distances are kept in the roadmap.
+      value_type heuristic (const NodePtr_t node)
       {
-	const ConfigurationPtr_t config = node->configuration ();
-	value_type res = std::numeric_limits <value_type>::infinity ();
-	for (Nodes_t::const_iterator itGoal = roadmap_->goalNodes ().begin ();
-	     itGoal != roadmap_->goalNodes ().end (); ++itGoal) {
-	  ConfigurationPtr_t goal = (*itGoal)->configuration ();
-	  value_type dist = (*distance_) (*config, *goal);
-	  if (dist < res) {
-	    res = dist;
-	  }
-	}
-	return res;
+	if (distanceFactor_ == 0) return 0;
+	return distanceFactor_ * roadmap_->distanceToGoal (distance_, node);
       }
 
       value_type edgeCost (const EdgePtr_t& edge)
       {
-	return edge->path ()->length ();
+	if (!cost_) return edge->length ();
+	return edge->cost (cost_);
       }
     }; // class Astar
   } //   namespace core
@@ -0,0 +1,243 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cassert>
+#include <hpp/util/pointer.hh>
+#include <hpp/core/cached-path-validation.hh>
+#include <hpp/core/config-projector.hh>
+#include <hpp/core/constraint-set.hh>
+#include <hpp/core/straight-path.hh>
+
+namespace hpp {
+  namespace core {
+    CachedPathValidationPtr_t CachedPathValidation::create
+    (const PathValidationPtr_t& pathValidation, std::size_t size)
+    {
+      CachedPathValidation* ptr = new CachedPathValidation
+	(pathValidation, size);
+      return CachedPathValidationPtr_t (ptr);
+    }
+
+    CachedPathValidation::CachedPathValidation
+    (const PathValidationPtr_t& pathValidation, std::size_t size) :
+      PathValidation (), inner_ (pathValidation), cacheSize_ (size),
+      cache_ (), cacheIndex_ (), cacheHits_ (0), cacheMisses_ (0)
+    {
+      assert (inner_);
+    }
+
+    bool CachedPathValidation::validate
+    (const PathPtr_t& path, bool reverse, PathPtr_t& validPart)
+    {
+      return inner_->validate (path, reverse, validPart);
+    }
+
+    bool CachedPathValidation::validate
+    (const PathPtr_t& path, bool reverse, PathPtr_t& validPart,
+     ValidationReport& report)
+    {
+      return inner_->validate (path, reverse, validPart, report);
+    }
+
+    bool CachedPathValidation::validate
+    (const PathPtr_t& path, bool reverse, PathPtr_t& validPart,
+     PathValidationReportPtr_t& report)
+    {
+      CacheKey k;
+      if (cacheSize_ == 0 || !key (path, k)) {
+	return inner_->validate (path, reverse, validPart, report);
+      }
+      const std::size_t direction = reverse ? 1 : 0;
+      CacheEntry* entry = find (k);
+      if (entry && (entry->success || entry->validLength [direction] >= 0)) {
+	++cacheHits_;
+	if (entry->success) {
+	  validPart = path;
+	  return true;
+	}
+	const interval_t& range (path->timeRange ());
+	const value_type length (entry->validLength [direction]);
+	if (reverse) {
+	  validPart = path->extract (interval_t (range.second - length,
+						 range.second));
+	} else {
+	  validPart = path->extract (interval_t (range.first,
+						 range.first + length));
+	}
+	report = entry->report [direction];
+	return false;
+      }
+      ++cacheMisses_;
+      bool success = inner_->validate (path, reverse, validPart, report);
+      if (!entry) entry = &insert (k, success);
+      if (!success) {
+	entry->validLength [direction] = validPart ? validPart->length () : 0;
+	entry->report [direction] = report;
+      }
+      return success;
+    }
+
+    bool CachedPathValidation::isValid (const PathPtr_t& path)
+    {
+      CacheKey k;
+      if (cacheSize_ == 0 || !key (path, k)) return inner_->isValid (path);
+      CacheEntry* entry = find (k);
+      if (entry) {
+	++cacheHits_;
+	return entry->success;
+      }
+      ++cacheMisses_;
+      bool success = inner_->isValid (path);
+      insert (k, success);
+      return success;
+    }
+
+    void CachedPathValidation::addObstacle (const CollisionObjectPtr_t& object)
+    {
+      inner_->addObstacle (object);
+      invalidate ();
+    }
+
+    void CachedPathValidation::removeObstacleFromJoint
+    (const JointPtr_t& joint, const CollisionObjectPtr_t& obstacle)
+    {
+      inner_->removeObstacleFromJoint (joint, obstacle);
+      invalidate ();
+    }
+
+    void CachedPathValidation::removeObstacle
+    (const CollisionObjectPtr_t& object)
+    {
+      inner_->removeObstacle (object);
+      invalidate ();
+    }
+
+    void CachedPathValidation::obstacleMoved
+    (const CollisionObjectPtr_t& object)
+    {
+      inner_->obstacleMoved (object);
+      invalidate ();
+    }
+
+    void CachedPathValidation::distanceField
+    (const DistanceFieldPtr_t& field)
+    {
+      inner_->distanceField (field);
+    }
+
+    PathValidationPtr_t CachedPathValidation::copy
+    (const DevicePtr_t& robot) const
+    {
+      PathValidationPtr_t inner (inner_->copy (robot));
+      if (!inner) return PathValidationPtr_t ();
+      return create (inner, cacheSize_);
+    }
+
+    void CachedPathValidation::cacheSize (std::size_t size)
+    {
+      cacheSize_ = size;
+      trimCache ();
+    }
+
+    void CachedPathValidation::clearCache ()
+    {
+      invalidate ();
+      cacheHits_ = 0;
+      cacheMisses_ = 0;
+    }
+
+    bool CachedPathValidation::key (const PathPtr_t& path, CacheKey& k) const
+    {
+      StraightPathPtr_t sp = HPP_DYNAMIC_PTR_CAST (StraightPath, path);
+      if (!sp) return false;
+      k.initial = sp->initial ();
+      k.end = sp->end ();
+      k.length = sp->length ();
+      k.constraints = 0;
+      k.configProjector = 0;
+      if (path->constraints ()) {
+	k.constraints = path->constraints ()->revision ();
+	const ConfigProjectorPtr_t& cp
+	  (path->constraints ()->configProjector ());
+	if (cp) {
+	  k.configProjector = cp->revision ();
+	  k.rightHandSide = cp->rightHandSide ();
+	}
+      }
+      return true;
+    }
+
+    CachedPathValidation::CacheEntry* CachedPathValidation::find
+    (const CacheKey& k)
+    {
+      CacheIndex_t::iterator it = cacheIndex_.find (k);
+      if (it == cacheIndex_.end ()) return 0x0;
+      cache_.splice (cache_.begin (), cache_, it->second);
+      return &(it->second->second);
+    }
+
+    CachedPathValidation::CacheEntry& CachedPathValidation::insert
+    (const CacheKey& k, bool success)
+    {
+      cache_.push_front (std::make_pair (k, CacheEntry (success)));
+      cacheIndex_ [k] = cache_.begin ();
+      trimCache ();
+      return cache_.front ().second;
+    }
+
+    void CachedPathValidation::trimCache ()
+    {
+      // std::list::size may be linear
+      while (cacheIndex_.size () > cacheSize_) {
+	cacheIndex_.erase (cache_.back ().first);
+	cache_.pop_back ();
+      }
+    }
+
+    void CachedPathValidation::invalidate ()
+    {
+      cache_.clear ();
+      cacheIndex_.clear ();
+    }
+
+    namespace {
+      bool lessThan (vectorIn_t v1, vectorIn_t v2)
+      {
+	if (v1.size () != v2.size ()) return v1.size () < v2.size ();
+	return std::lexicographical_compare (v1.data (), v1.data () + v1.size (),
+					     v2.data (), v2.data () + v2.size ());
+      }
+    } // namespace
+
+    bool CachedPathValidation::CacheKey::operator<
+    (const CacheKey& other) const
+    {
+      if (lessThan (initial, other.initial)) return true;
+      if (lessThan (other.initial, initial)) return false;
+      if (lessThan (end, other.end)) return true;
+      if (lessThan (other.end, end)) return false;
+      if (length != other.length) return length < other.length;
+      if (constraints != other.constraints)
+	return constraints < other.constraints;
+      if (configProjector != other.configProjector)
+	return configProjector < other.configProjector;
+      return lessThan (rightHandSide, other.rightHandSide);
+    }
+  } // namespace core
+} // namespace hpp
@@ -16,6 +16,11 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <hpp/util/debug.hh>
 #include <hpp/fcl/collision.h>
 #include <hpp/model/body.hh>
 #include <hpp/model/collision-object.hh>
@@ -23,12 +28,85 @@
 #include <hpp/model/device.hh>
 #include <hpp/core/collision-validation.hh>
 #include <hpp/core/collision-validation-report.hh>
+#include <hpp/core/distance-field.hh>
+#include <hpp/core/obstacle-scene.hh>
+#include <hpp/core/operation-counters.hh>
+#include <hpp/core/trace.hh>
 
 namespace hpp {
   namespace core {
     using model::displayConfig;
 
     typedef model::JointConfiguration* JointConfigurationPtr_t;
+
+    namespace {
+      // Maximal number of pairs with obstacles tested before the broad phase
+      const std::size_t maxHotPairs = 16;
+
+      // Data passed to the broad phase callback
+      struct BroadPhaseData
+      {
+	const fcl::CollisionObject* inner;
+	const fcl::CollisionRequest* request;
+	const boost::unordered_set <FclCollisionPair_t>* disabled;
+	fcl::CollisionResult* result;
+	const fcl::CollisionObject* obstacle;
+      }; // struct BroadPhaseData
+
+      // Called for each obstacle the bounding box of which overlaps the one
+      // of the inner object. Return true to stop the search.
+      bool narrowPhase (fcl::CollisionObject* o1, fcl::CollisionObject* o2,
+			void* cdata)
+      {
+	BroadPhaseData* data = static_cast <BroadPhaseData*> (cdata);
+	const fcl::CollisionObject* obstacle = (o1 == data->inner) ? o2 : o1;
+	if (data->disabled->count (std::make_pair (data->inner, obstacle))) {
+	  return false;
+	}
+	OperationCounters::increment (OperationCounters::NARROW_PHASE);
+	if (fcl::collide (data->inner, obstacle, *(data->request),
+			  *(data->result)) != 0) {
+	  data->obstacle = obstacle;
+	  return true;
+	}
+	return false;
+      }
+
+      // Data shared by threads validating a batch of configurations
+      struct BatchData
+      {
+	const matrix_t* configurations;
+	bool stopAtFirst;
+	boost::mutex mutex;
+	// Rank of first invalid configuration found if stopAtFirst
+	size_type firstInvalid;
+      }; // struct BatchData
+
+      // Validate configurations of rank in [begin, end)
+      void validateColumns (ConfigValidation* validation, BatchData* data,
+			    size_type begin, size_type end,
+			    std::vector <char>* valid, std::string* error)
+      {
+	try {
+	  Configuration_t q (data->configurations->rows ());
+	  for (size_type i = begin; i < end; ++i) {
+	    if (data->stopAtFirst) {
+	      boost::mutex::scoped_lock lock (data->mutex);
+	      if (data->firstInvalid < i) return;
+	    }
+	    q = data->configurations->col (i);
+	    (*valid) [i - begin] = validation->isValid (q);
+	    if (!(*valid) [i - begin] && data->stopAtFirst) {
+	      boost::mutex::scoped_lock lock (data->mutex);
+	      data->firstInvalid = std::min (data->firstInvalid, i);
+	      return;
+	    }
+	  }
+	} catch (const std::exception& exc) {
+	  *error = exc.what ();
+	}
+      }
+    } // namespace
     CollisionValidationPtr_t CollisionValidation::create
     (const DevicePtr_t& robot)
     {
@@ -36,6 +114,23 @@ namespace hpp {
       return CollisionValidationPtr_t (ptr);
     }
 
+    ConfigValidationPtr_t CollisionValidation::copy
+    (const DevicePtr_t& robot) const
+    {
+      CollisionValidationPtr_t other (create (robot));
+      // Shared scenes are only read.
+      obstacles_->setup ();
+      other->obstacles_ = obstacles_;
+      other->distanceField_ = distanceField_;
+      other->fieldCovers_ = fieldCovers_;
+      other->collectInnerObjects ();
+      other->collisionRequest_ = collisionRequest_;
+      other->adaptiveOrdering_ = adaptiveOrdering_;
+      other->numberThreads_ = numberThreads_;
+      other->incremental (incremental_);
+      return other;
+    }
+
     bool CollisionValidation::validate (const Configuration_t& config,
 					bool throwIfInValid)
     {
@@ -46,25 +141,15 @@ namespace hpp {
 					ValidationReport& validationReport,
 					bool throwIfInValid)
     {
+      TraceScope trace ("CollisionValidation::validate");
       HPP_STATIC_CAST_REF_CHECK (CollisionValidationReport, validationReport);
       CollisionValidationReport& report =
 	static_cast <CollisionValidationReport&> (validationReport);
-      robot_->currentConfiguration (config);
-      robot_->computeForwardKinematics ();
-      bool collision = false;
+      computeForwardKinematics (config);
       fcl::CollisionResult& collisionResult = report.result;
       collisionResult.clear();
-      for (CollisionPairs_t::const_iterator itCol = collisionPairs_.begin ();
-	   itCol != collisionPairs_.end (); ++itCol) {
-	if (fcl::collide (itCol->first->fcl ().get (),
-			  itCol->second->fcl ().get (),
-			  collisionRequest_, collisionResult) != 0) {
-	  report.object1 = itCol->first;
-	  report.object2 = itCol->second;
-	  collision = true;
-	  break;
-	}
-      }
+      bool collision = collide (report.object1, report.object2,
+				collisionResult);
       if (collision && throwIfInValid) {
 	std::ostringstream oss ("Configuration in collision: ");
 	oss << displayConfig (config);
@@ -75,30 +160,276 @@ namespace hpp {
 
     bool CollisionValidation::validate (const Configuration_t& config,
 					ValidationReportPtr_t& validationReport)
+    {
+      TraceScope trace ("CollisionValidation::validate");
+      computeForwardKinematics (config);
+      collisionResult_.clear ();
+      CollisionObjectPtr_t object1, object2;
+      if (collide (object1, object2, collisionResult_)) {
+	CollisionValidationReportPtr_t report;
+	// Reuse report if nobody else refers to it
+	if (validationReport.unique ()) {
+	  report = HPP_DYNAMIC_PTR_CAST (CollisionValidationReport,
+					 validationReport);
+	}
+	if (!report) {
+	  report = CollisionValidationReportPtr_t
+	    (new CollisionValidationReport);
+	}
+	report->object1 = object1;
+	report->object2 = object2;
+	report->result = collisionResult_;
+	validationReport = report;
+	return false;
+      }
+      return true;
+    }
+
+    bool CollisionValidation::isValid (const Configuration_t& config)
+    {
+      computeForwardKinematics (config);
+      collisionResult_.clear ();
+      CollisionObjectPtr_t object1, object2;
+      return !collide (object1, object2, collisionResult_);
+    }
+
+    void CollisionValidation::incremental (bool incremental)
+    {
+      incremental_ = incremental;
+      previousConfig_.resize (0);
+      pairFree_.assign (fclPairs_.size (), false);
+      innerFree_.assign (innerObjects_.size (), false);
+    }
+
+    void CollisionValidation::computeForwardKinematics
+    (const Configuration_t& config)
     {
       robot_->currentConfiguration (config);
       robot_->computeForwardKinematics ();
-      fcl::CollisionResult collisionResult;
-      for (CollisionPairs_t::const_iterator itCol = collisionPairs_.begin ();
-	   itCol != collisionPairs_.end (); ++itCol) {
-	if (fcl::collide (itCol->first->fcl ().get (),
-			  itCol->second->fcl ().get (),
-			  collisionRequest_, collisionResult) != 0) {
-	  CollisionValidationReportPtr_t report (new CollisionValidationReport);
-	  report->object1 = itCol->first;
-	  report->object2 = itCol->second;
-	  report->result = collisionResult;
-	  validationReport = report;
-	  return false;
+      if (!incremental_) return;
+      // Find joints that moved since previous configuration: joints the
+      // value of which changed and their descendants.
+      const JointVector_t& jv = robot_->getJointVector ();
+      moved_.assign (jv.size () + 1, UNKNOWN);
+      moved_ [jv.size ()] = MOVED;
+      for (std::size_t k = 0; k < jv.size (); ++k) {
+	std::size_t j = k;
+	// Go up to the first joint the motion of which is known
+	std::vector <std::size_t>& unknown (unknownJoints_);
+	unknown.clear ();
+	while (moved_ [j] == UNKNOWN) {
+	  const JointPtr_t& joint (jv [j]);
+	  size_type rank = joint->rankInConfiguration ();
+	  size_type size = joint->configSize ();
+	  if (previousConfig_.size () != config.size () ||
+	      previousConfig_.segment (rank, size) != config.segment (rank, size)) {
+	    moved_ [j] = MOVED;
+	  } else if (!joint->parentJoint ()) {
+	    moved_ [j] = STILL;
+	  } else {
+	    unknown.push_back (j);
+	    j = jointIndex (joint->parentJoint ());
+	  }
+	}
+	for (std::vector <std::size_t>::const_iterator it = unknown.begin ();
+	     it != unknown.end (); ++it) {
+	  moved_ [*it] = moved_ [j];
+	}
+      }
+      for (std::size_t i = 0; i < pairFree_.size (); ++i) {
+	if (moved_ [pairJoints_ [i].first] == MOVED ||
+	    moved_ [pairJoints_ [i].second] == MOVED) {
+	  pairFree_ [i] = false;
+	}
+      }
+      for (std::size_t i = 0; i < innerFree_.size (); ++i) {
+	if (moved_ [innerJoints_ [i]] == MOVED) innerFree_ [i] = false;
+      }
+      previousConfig_ = config;
+    }
+
+    std::size_t CollisionValidation::jointIndex (const JointPtr_t& joint) const
+    {
+      std::map <JointPtr_t, std::size_t>::const_iterator it =
+	jointIndices_.find (joint);
+      // Joints not in the robot are considered as moving.
+      if (it == jointIndices_.end ()) return jointIndices_.size ();
+      return it->second;
+    }
+
+    bool CollisionValidation::validateBatch (const matrix_t& configurations,
+					     std::vector <bool>& valid,
+					     bool stopAtFirst)
+    {
+      size_type n = configurations.cols ();
+      size_type nbThreads = std::min ((size_type) numberThreads_, n);
+      if (nbThreads <= 1) {
+	return ConfigValidation::validateBatch (configurations, valid,
+						stopAtFirst);
+      }
+      if (workers_.size () + 1 < numberThreads_) createWorkers ();
+      BatchData data;
+      data.configurations = &configurations;
+      data.stopAtFirst = stopAtFirst;
+      data.firstInvalid = n;
+      size_type chunk = (n + nbThreads - 1) / nbThreads;
+      std::vector <std::vector <char> > results (nbThreads);
+      std::vector <std::string> errors (nbThreads);
+      boost::thread_group threads;
+      for (size_type k = 1; k < nbThreads; ++k) {
+	size_type begin = k * chunk;
+	if (begin >= n) break;
+	size_type end = std::min (n, begin + chunk);
+	results [k].assign (end - begin, false);
+	threads.create_thread
+	  (boost::bind (&validateColumns, workers_ [k - 1].get (), &data,
+			begin, end, &results [k], &errors [k]));
+      }
+      // The calling thread validates the first range
+      results [0].assign (std::min (n, chunk), false);
+      validateColumns (this, &data, 0, std::min (n, chunk), &results [0],
+		       &errors [0]);
+      threads.join_all ();
+      for (size_type k = 0; k < nbThreads; ++k) {
+	if (!errors [k].empty ()) throw std::runtime_error (errors [k]);
+      }
+      valid.assign (n, false);
+      bool allValid = true;
+      for (size_type k = 0; k < nbThreads; ++k) {
+	for (std::size_t i = 0; i < results [k].size (); ++i) {
+	  size_type rank = k * chunk + i;
+	  valid [rank] = results [k][i] && (rank < data.firstInvalid);
+	  if (!valid [rank]) allValid = false;
 	}
       }
+      return allValid;
+    }
+
+    void CollisionValidation::createWorkers ()
+    {
+      workers_.clear ();
+      // Workers share the obstacle scene, only read by collision tests.
+      obstacles_->setup ();
+      // Inner objects of copies are collected in the same order
+      std::map <const fcl::CollisionObject*, std::size_t> innerRanks;
+      for (std::size_t i = 0; i < innerObjects_.size (); ++i) {
+	innerRanks [innerObjects_ [i]->fcl ().get ()] = i;
+      }
+      for (std::size_t k = 1; k < numberThreads_; ++k) {
+	CollisionValidationPtr_t worker (create (robot_->clone ()));
+	worker->collisionRequest_ = collisionRequest_;
+	worker->obstacles_ = obstacles_;
+	worker->distanceField_ = distanceField_;
+	worker->fieldCovers_ = fieldCovers_;
+	worker->collectInnerObjects ();
+	for (boost::unordered_set <FclCollisionPair_t>::const_iterator
+	       itPair = disabledPairs_.begin (); itPair != disabledPairs_.end ();
+	     ++itPair) {
+	  const CollisionObjectPtr_t& inner
+	    (worker->innerObjects_ [innerRanks [itPair->first]]);
+	  worker->disabledPairs_.insert
+	    (FclCollisionPair_t (inner->fcl ().get (), itPair->second));
+	}
+	workers_.push_back (worker);
+      }
+    }
+
+    bool CollisionValidation::collide (CollisionObjectPtr_t& object1,
+				       CollisionObjectPtr_t& object2,
+				       fcl::CollisionResult& result)
+    {
+      bool collision = false;
+      // Pairs of inner objects of the robot
+      for (std::size_t i = 0; i < fclPairs_.size (); ++i) {
+	// Skip pairs known to be collision free
+	if (pairFree_ [i]) continue;
+	OperationCounters::increment (OperationCounters::NARROW_PHASE);
+	if (fcl::collide (fclPairs_ [i].first, fclPairs_ [i].second,
+			  collisionRequest_, result) != 0) {
+	  object1 = collisionPairs_ [i].first;
+	  object2 = collisionPairs_ [i].second;
+	  if (adaptiveOrdering_ && i != 0) {
+	    std::rotate (collisionPairs_.begin (), collisionPairs_.begin () + i,
+			 collisionPairs_.begin () + i + 1);
+	    std::rotate (fclPairs_.begin (), fclPairs_.begin () + i,
+			 fclPairs_.begin () + i + 1);
+	    std::rotate (pairJoints_.begin (), pairJoints_.begin () + i,
+			 pairJoints_.begin () + i + 1);
+	    std::rotate (pairFree_.begin (), pairFree_.begin () + i,
+			 pairFree_.begin () + i + 1);
+	  }
+	  collision = true;
+	  break;
+	}
+	pairFree_ [i] = incremental_;
+      }
+      // Pairs with obstacles that recently collided
+      if (!collision && adaptiveOrdering_) {
+	for (CollisionPairs_t::iterator itCol = hotPairs_.begin ();
+	     itCol != hotPairs_.end (); ++itCol) {
+	  OperationCounters::increment (OperationCounters::NARROW_PHASE);
+	  if (fcl::collide (itCol->first->fcl ().get (),
+			    itCol->second->fcl ().get (),
+			    collisionRequest_, result) != 0) {
+	    object1 = itCol->first;
+	    object2 = itCol->second;
+	    hotPairs_.splice (hotPairs_.begin (), hotPairs_, itCol);
+	    collision = true;
+	    break;
+	  }
+	}
+      }
+      if (!collision) {
+	if (!collideObstacles (object1, object2, result)) return false;
+	if (adaptiveOrdering_) {
+	  CollisionPair_t colPair (object1, object2);
+	  hotPairs_.remove (colPair);
+	  hotPairs_.push_front (colPair);
+	  if (hotPairs_.size () > maxHotPairs) hotPairs_.pop_back ();
+	}
+      }
+      ++hitCounts_ [CollisionPair_t (object1, object2)];
       return true;
     }
 
+    bool CollisionValidation::collideObstacles
+    (CollisionObjectPtr_t& object1, CollisionObjectPtr_t& object2,
+     fcl::CollisionResult& result)
+    {
+      if (obstacles_->empty ()) return false;
+      obstacles_->setup ();
+      BroadPhaseData data;
+      data.request = &collisionRequest_;
+      data.disabled = &disabledPairs_;
+      data.result = &result;
+      data.obstacle = 0x0;
+      for (std::size_t i = 0; i < innerObjects_.size (); ++i) {
+	// Skip inner objects known to be collision free
+	if (innerFree_ [i]) continue;
+	fcl::CollisionObject* inner = innerObjects_ [i]->fcl ().get ();
+	// Bounding box of inner object follows forward kinematics
+	inner->computeAABB ();
+	if (fieldCovers_ && distanceField_->lowerBound (inner->getAABB ()) > 0) {
+	  innerFree_ [i] = incremental_;
+	  continue;
+	}
+	data.inner = inner;
+	obstacles_->collide (inner, &data, &narrowPhase);
+	if (data.obstacle) {
+	  object1 = innerObjects_ [i];
+	  object2 = obstacles_->find (data.obstacle);
+	  return true;
+	}
+	innerFree_ [i] = incremental_;
+      }
+      return false;
+    }
 
-    void CollisionValidation::addObstacle (const CollisionObjectPtr_t& object)
+    void CollisionValidation::collectInnerObjects ()
     {
       using model::COLLISION;
+      innerObjects_.clear ();
+      innerJoints_.clear ();
       const JointVector_t& jv = robot_->getJointVector ();
       for (JointVector_t::const_iterator it = jv.begin (); it != jv.end ();
 	   ++it) {
@@ -106,12 +437,33 @@ namespace hpp {
 	BodyPtr_t body = joint->linkedBody ();
 	if (body) {
 	  const ObjectVector_t& bodyObjects = body->innerObjects (COLLISION);
-	  for (ObjectVector_t::const_iterator itInner = bodyObjects.begin ();
-	       itInner != bodyObjects.end (); ++itInner) {
-	    collisionPairs_.push_back (CollisionPair_t (*itInner, object));
-	  }
+	  innerObjects_.insert (innerObjects_.end (), bodyObjects.begin (),
+				bodyObjects.end ());
+	  innerJoints_.insert (innerJoints_.end (), bodyObjects.size (),
+			       jointIndex (joint));
 	}
       }
+      innerFree_.assign (innerObjects_.size (), false);
+    }
+
+    void CollisionValidation::addObstacle (const CollisionObjectPtr_t& object)
+    {
+      // Inner objects may have been added to the robot since the previous
+      // obstacle. The new obstacle may collide with any inner object.
+      collectInnerObjects ();
+      fcl::CollisionObject* fclObject = object->fcl ().get ();
+      if (obstacles_->find (fclObject)) {
+	hppDout (info, "obstacle " << object->name ()
+		 << " is already in the scene.");
+	return;
+      }
+      // Copies of this object share the scene: modify a copy of it.
+      if (!obstacles_.unique ()) {
+	obstacles_ = ObstacleScene::createCopy (*obstacles_);
+      }
+      obstacles_->add (object);
+      updateFieldCoverage ();
+      workers_.clear ();
     }
 
     void CollisionValidation::removeObstacleFromJoint
@@ -123,34 +475,114 @@ namespace hpp {
 	const ObjectVector_t& bodyObjects = body->innerObjects (COLLISION);
 	for (ObjectVector_t::const_iterator itInner = bodyObjects.begin ();
 	     itInner != bodyObjects.end (); ++itInner) {
-	  CollisionPair_t colPair (*itInner, obstacle);
-	  std::size_t before = collisionPairs_.size ();
-	  collisionPairs_.remove (colPair);
-	  std::size_t after = collisionPairs_.size ();
-	  if (after == before) {
+	  FclCollisionPair_t colPair ((*itInner)->fcl ().get (),
+				      obstacle->fcl ().get ());
+	  hotPairs_.remove (CollisionPair_t (*itInner, obstacle));
+	  workers_.clear ();
+	  if (!obstacles_->find (colPair.second) ||
+	      !disabledPairs_.insert (colPair).second) {
 	    std::ostringstream oss;
 	    oss << "CollisionValidation::removeObstacleFromJoint: obstacle \""
 		<< obstacle->name () <<
 	      "\" is not registered as obstacle for joint \"" << joint->name ()
 		<< "\".";
 	    throw std::runtime_error (oss.str ());
-	  } else if (before - after >= 2) {
-	    hppDout (error, "obstacle "<< obstacle->name () <<
-		     " was registered " << before - after
-		     << " times as obstacle for joint " << joint->name ()
-		     << ".");
 	  }
 	}
       }
     }
 
+    void CollisionValidation::removeObstacle
+    (const CollisionObjectPtr_t& object)
+    {
+      fcl::CollisionObject* fclObject = object->fcl ().get ();
+      if (!obstacles_->find (fclObject)) {
+	hppDout (info, "obstacle " << object->name ()
+		 << " is not in the scene.");
+	return;
+      }
+      if (!obstacles_.unique ()) {
+	obstacles_ = ObstacleScene::createCopy (*obstacles_);
+      }
+      obstacles_->remove (object);
+      updateFieldCoverage ();
+      for (CollisionPairs_t::iterator itCol = hotPairs_.begin ();
+	   itCol != hotPairs_.end ();) {
+	if (itCol->second == object) {
+	  itCol = hotPairs_.erase (itCol);
+	} else {
+	  ++itCol;
+	}
+      }
+      for (boost::unordered_set <FclCollisionPair_t>::iterator itPair =
+	     disabledPairs_.begin (); itPair != disabledPairs_.end ();) {
+	if (itPair->second == fclObject) {
+	  itPair = disabledPairs_.erase (itPair);
+	} else {
+	  ++itPair;
+	}
+      }
+      workers_.clear ();
+    }
+
+    void CollisionValidation::obstacleMoved
+    (const CollisionObjectPtr_t& object)
+    {
+      if (!obstacles_->find (object->fcl ().get ())) {
+	hppDout (info, "obstacle " << object->name ()
+		 << " is not in the scene.");
+	return;
+      }
+      if (!obstacles_.unique ()) {
+	obstacles_ = ObstacleScene::createCopy (*obstacles_);
+      }
+      obstacles_->update (object);
+      // The field was computed at the previous position of the obstacle.
+      if (distanceField_ && distanceField_->contains (object)) {
+	distanceField (DistanceFieldPtr_t ());
+      }
+      // Inner objects proved free may collide with the obstacle.
+      innerFree_.assign (innerObjects_.size (), false);
+      workers_.clear ();
+    }
+
+    void CollisionValidation::distanceField (const DistanceFieldPtr_t& field)
+    {
+      distanceField_ = field;
+      updateFieldCoverage ();
+      workers_.clear ();
+    }
+
+    void CollisionValidation::updateFieldCoverage ()
+    {
+      fieldCovers_ = false;
+      if (!distanceField_) return;
+      const ObstacleScene::Obstacles_t& obstacles (obstacles_->obstacles ());
+      for (ObstacleScene::Obstacles_t::const_iterator it = obstacles.begin ();
+	   it != obstacles.end (); ++it) {
+	if (!distanceField_->contains (it->second)) return;
+      }
+      fieldCovers_ = true;
+    }
+
     CollisionValidation::CollisionValidation (const DevicePtr_t& robot) :
       collisionRequest_(1, false, false, 1, false, true, fcl::GST_INDEP),
-      robot_ (robot)
+      robot_ (robot), collisionPairs_ (), fclPairs_ (),
+      obstacles_ (ObstacleScene::create ()), distanceField_ (),
+      fieldCovers_ (false), innerObjects_ (), disabledPairs_ (),
+      adaptiveOrdering_ (false), hotPairs_ (), hitCounts_ (),
+      collisionResult_ (), numberThreads_ (1), workers_ (),
+      incremental_ (false), previousConfig_ (), jointIndices_ (), moved_ (),
+      unknownJoints_ (), pairJoints_ (), pairFree_ (), innerJoints_ (),
+      innerFree_ ()
     {
       using model::COLLISION;
       typedef hpp::model::Device::CollisionPairs_t JointPairs_t;
       using model::ObjectVector_t;
+      const JointVector_t& jv = robot->getJointVector ();
+      for (std::size_t i = 0; i < jv.size (); ++i) {
+	jointIndices_ [jv [i]] = i;
+      }
       const JointPairs_t& jointPairs (robot->collisionPairs (COLLISION));
       // build collision pairs for internal objects
       for (JointPairs_t::const_iterator it = jointPairs.begin ();
@@ -168,11 +600,16 @@ namespace hpp {
 	    for (ObjectVector_t::const_iterator it2 = objects2.begin ();
 		 it2 != objects2.end (); ++it2) {
 	      collisionPairs_.push_back (CollisionPair_t (*it1, *it2));
+	      pairJoints_.push_back (std::make_pair (jointIndex (j1),
+						     jointIndex (j2)));
+	      fclPairs_.push_back (FclCollisionPair_t ((*it1)->fcl ().get (),
+						       (*it2)->fcl ().get ()));
 	    }
 	  }
 	}
 
       }
+      pairFree_.assign (fclPairs_.size (), false);
     }
   } // namespace core
 } // namespace hpp
@@ -17,17 +17,27 @@
 // <http://www.gnu.org/licenses/>.
 
 #include <limits>
+#include <algorithm>
+#include <map>
+#include <boost/bind.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include <hpp/util/debug.hh>
 #include <hpp/util/timer.hh>
 #include <hpp/model/configuration.hh>
 #include <hpp/model/device.hh>
 #include <hpp/model/joint.hh>
 #include <hpp/constraints/svd.hh>
+#include <hpp/core/comparison-type.hh>
 #include <hpp/core/config-projector.hh>
 #include <hpp/core/constraint-set.hh>
 #include <hpp/constraints/differentiable-function.hh>
 #include <hpp/core/locked-joint.hh>
 #include <hpp/core/explicit-numerical-constraint.hh>
+#include <hpp/core/operation-counters.hh>
+#include <hpp/core/trace.hh>
+#include "memory-usage.hh"
 
 namespace hpp {
   namespace core {
@@ -49,6 +59,185 @@ namespace hpp {
       return l1->rankInVelocity () < l2->rankInVelocity ();
     }
 
+    namespace {
+      bool compareRankInVelocity (const LockedJointPtr_t& l1,
+				  const LockedJointPtr_t& l2)
+      {
+	return l1 < l2;
+      }
+    } // namespace
+
+    namespace configProjector {
+      // Threads projecting contiguous ranges of the columns of batches of
+      // configurations, each with its own copy of the projector.
+      class BatchThreads
+      {
+      public:
+	// Start a thread per copy, the calling thread projects the first
+	// range with the original projector.
+	BatchThreads (const std::vector <ConfigProjectorPtr_t>& copies,
+		      std::size_t revision) :
+	  nbThreads_ (copies.size () + 1), revision_ (revision),
+	  copies_ (copies), merged_ (copies.size ()), mutex_ (), started_ (),
+	  finished_ (), generation_ (0), running_ (0), stop_ (false),
+	  configurations_ (0x0), alpha_ (0x0), results_ (), chunk_ (0),
+	  errors_ (nbThreads_), threads_ ()
+	{
+	  for (std::size_t k = 1; k < nbThreads_; ++k) {
+	    threads_.create_thread (boost::bind (&BatchThreads::work, this,
+						 k));
+	  }
+	}
+
+	~BatchThreads ()
+	{
+	  {
+	    boost::mutex::scoped_lock lock (mutex_);
+	    stop_ = true;
+	  }
+	  started_.notify_all ();
+	  threads_.join_all ();
+	}
+
+	std::size_t numberThreads () const
+	{
+	  return nbThreads_;
+	}
+
+	// Revision of the projector the copies were made of
+	std::size_t revision () const
+	{
+	  return revision_;
+	}
+
+	const std::vector <ConfigProjectorPtr_t>& copies () const
+	{
+	  return copies_;
+	}
+
+	// Project columns of configurations, or only execute one step of the
+	// projection if steps are given.
+	void project (ConfigProjector& projector, matrixOut_t& configurations,
+		      const vectorIn_t* alpha, std::vector <bool>& success)
+	{
+	  std::size_t n = configurations.cols ();
+	  {
+	    boost::mutex::scoped_lock lock (mutex_);
+	    configurations_ = &configurations;
+	    alpha_ = alpha;
+	    chunk_ = (n + nbThreads_ - 1) / nbThreads_;
+	    // std::vector <bool> cannot be written concurrently.
+	    results_.assign (n, false);
+	    errors_.assign (nbThreads_, std::string ());
+	    running_ = nbThreads_ - 1;
+	    ++generation_;
+	  }
+	  started_.notify_all ();
+	  projectRange (projector, 0, std::min (n, chunk_), errors_ [0]);
+	  {
+	    boost::mutex::scoped_lock lock (mutex_);
+	    while (running_ > 0) finished_.wait (lock);
+	  }
+	  mergeStatistics (projector.statistics ());
+	  for (std::size_t k = 0; k < nbThreads_; ++k) {
+	    if (!errors_ [k].empty ()) throw std::runtime_error (errors_ [k]);
+	  }
+	  success.assign (results_.begin (), results_.end ());
+	}
+
+      private:
+	// Numbers of results of the statistics of a copy already merged
+	struct Counts {
+	  std::size_t success, maxIterations, errorIncreased;
+	  Counts () : success (0), maxIterations (0), errorIncreased (0) {}
+	};
+
+	// Project range k of each batch with copy k - 1
+	void work (std::size_t k)
+	{
+	  std::size_t generation = 0;
+	  while (true) {
+	    std::size_t begin, end;
+	    {
+	      boost::mutex::scoped_lock lock (mutex_);
+	      while (!stop_ && generation_ == generation) {
+		started_.wait (lock);
+	      }
+	      if (stop_) return;
+	      generation = generation_;
+	      std::size_t n = configurations_->cols ();
+	      begin = std::min (n, k * chunk_);
+	      end = std::min (n, begin + chunk_);
+	    }
+	    projectRange (*copies_ [k-1], begin, end, errors_ [k]);
+	    boost::mutex::scoped_lock lock (mutex_);
+	    if (--running_ == 0) finished_.notify_one ();
+	  }
+	}
+
+	// Project columns of rank in [begin, end)
+	void projectRange (ConfigProjector& projector, std::size_t begin,
+			   std::size_t end, std::string& error)
+	{
+	  try {
+	    for (std::size_t i = begin; i < end; ++i) {
+	      if (alpha_) {
+		results_ [i] = projector.oneStep (configurations_->col (i),
+						  (*alpha_) [i]);
+	      } else {
+		results_ [i] = projector.apply (configurations_->col (i));
+	      }
+	    }
+	  } catch (const std::exception& exc) {
+	    error = exc.what ();
+	  }
+	}
+
+	// Add the results of the copies since the last batch
+	void mergeStatistics (::hpp::statistics::SuccessStatistics& statistics)
+	{
+	  for (std::size_t k = 0; k < copies_.size (); ++k) {
+	    ::hpp::statistics::SuccessStatistics& other
+	      (copies_ [k]->statistics ());
+	    Counts& merged (merged_ [k]);
+	    for (; merged.success < (std::size_t) other.nbSuccess ();
+		 ++merged.success) {
+	      statistics.addSuccess ();
+	    }
+	    for (; merged.maxIterations <
+		   (std::size_t) other.nbFailure (REASON_MAX_ITER);
+		 ++merged.maxIterations) {
+	      statistics.addFailure (REASON_MAX_ITER);
+	    }
+	    for (; merged.errorIncreased <
+		   (std::size_t) other.nbFailure (REASON_ERROR_INCREASED);
+		 ++merged.errorIncreased) {
+	      statistics.addFailure (REASON_ERROR_INCREASED);
+	    }
+	  }
+	}
+
+	const std::size_t nbThreads_;
+	const std::size_t revision_;
+	const std::vector <ConfigProjectorPtr_t> copies_;
+	std::vector <Counts> merged_;
+	boost::mutex mutex_;
+	boost::condition_variable started_;
+	boost::condition_variable finished_;
+	// Incremented for each batch
+	std::size_t generation_;
+	// Number of threads that have not projected their range yet
+	std::size_t running_;
+	bool stop_;
+	matrixOut_t* configurations_;
+	const vectorIn_t* alpha_;
+	std::vector <char> results_;
+	std::size_t chunk_;
+	std::vector <std::string> errors_;
+	boost::thread_group threads_;
+      }; // class BatchThreads
+    } // namespace configProjector
+
     ConfigProjectorPtr_t ConfigProjector::create (const DevicePtr_t& robot,
 						  const std::string& name,
 						  value_type errorThreshold,
@@ -78,14 +267,20 @@ namespace hpp {
       passiveDofs_ (), lockedJoints_ (),
       squareErrorThreshold_ (errorThreshold * errorThreshold),
       maxIterations_ (maxIterations), rhsReducedSize_ (0),
-      lastIsOptional_ (false),
+      lastIsOptional_ (false), linearSolver_ (SVD), squareDamping_ (1e-6),
+      stepStrategy_ (FIXED_STEPS), qTrial_ (robot->configSize ()),
+      valueTrial_ (), warmStart_ (false), warmStartMaxDistance_ (.1),
+      hasWarmStart_ (false), warmStartInput_ (robot->configSize ()),
+      warmStartCorrection_ (robot->numberDof ()),
+      valueCached_ (false), valueConfiguration_ (robot->configSize ()),
       toMinusFrom_ (robot->numberDof ()),
       projMinusFrom_ (robot->numberDof ()),
       dq_ (robot->numberDof ()),
       dqSmall_ (robot->numberDof ()),
       nbNonLockedDofs_ (robot_->numberDof ()),
       nbLockedDofs_ (0),
-      squareNorm_(0), explicitComputation_ (false), weak_ ()
+      squareNorm_(0), explicitComputation_ (false), updating_ (false),
+      workspaces_ (false), weak_ (), batchThreads_ ()
     {
       dq_.setZero ();
       stack_.push_back (PriorityStack (3,nbNonLockedDofs_)); /// First and last
@@ -93,29 +288,32 @@ namespace hpp {
 
     ConfigProjector::ConfigProjector (const ConfigProjector& cp) :
       Constraint (cp), robot_ (cp.robot_), stack_ (cp.stack_),
-      functions_ (cp.functions_),
+      functions_ (cp.functions_), explicitFunctions_ (cp.explicitFunctions_),
+      explicitOrder_ (cp.explicitOrder_),
       passiveDofs_ (cp.passiveDofs_), lockedJoints_ (),
+      lockedConfIntervals_ (cp.lockedConfIntervals_),
+      lockedValues_ (cp.lockedValues_), lockedBuffer_ (cp.lockedBuffer_),
       intervals_ (cp.intervals_),
       squareErrorThreshold_ (cp.squareErrorThreshold_),
       maxIterations_ (cp.maxIterations_),
       rightHandSide_ (cp.rightHandSide_),
       rhsReducedSize_ (cp.rhsReducedSize_),
       lastIsOptional_ (cp.lastIsOptional_),
-      value_ (cp.value_.size ()),
-      reducedJacobian_ (cp.reducedJacobian_.rows (),
-			cp.reducedJacobian_.cols ()),
-      svd_ (cp.reducedJacobian_.rows (), cp.reducedJacobian_.cols (),
-          Eigen::ComputeThinU | Eigen::ComputeThinV),
-      reducedProjector_ (cp.reducedProjector_.rows (),
-			 cp.reducedProjector_.cols ()),
-      toMinusFrom_ (cp.toMinusFrom_.size ()),
-      projMinusFrom_ (cp.projMinusFrom_.size ()),
-      dq_ (cp.dq_.size ()), dqSmall_ (cp.dqSmall_.size ()),
+      // Workspaces are allocated when first used.
+      value_ (), reducedJacobian_ (), svd_ (), decompositions_ (),
+      linearSolver_ (cp.linearSolver_),
+      squareDamping_ (cp.squareDamping_), stepStrategy_ (cp.stepStrategy_),
+      qTrial_ (), valueTrial_ (), warmStart_ (cp.warmStart_),
+      warmStartMaxDistance_ (cp.warmStartMaxDistance_),
+      hasWarmStart_ (false), warmStartInput_ (), warmStartCorrection_ (),
+      valueCached_ (false), valueConfiguration_ (),
+      reducedProjector_ (), toMinusFrom_ (), projMinusFrom_ (), dq_ (),
+      dqSmall_ (), error_ (), projector_ (),
       nbNonLockedDofs_ (cp.nbNonLockedDofs_), nbLockedDofs_ (cp.nbLockedDofs_),
       squareNorm_ (cp.squareNorm_),
-      explicitComputation_ (cp.explicitComputation_), weak_ ()
+      explicitComputation_ (cp.explicitComputation_), updating_ (false),
+      workspaces_ (false), weak_ (), batchThreads_ ()
     {
-      dq_.setZero ();
       for (LockedJoints_t::const_iterator it = cp.lockedJoints_.begin ();
 	   it != cp.lockedJoints_.end (); ++it) {
 	lockedJoints_.push_back (HPP_STATIC_PTR_CAST (LockedJoint,
@@ -128,11 +326,46 @@ namespace hpp {
       return createCopy (weak_.lock ());
     }
 
+    ConfigProjectorPtr_t ConfigProjector::copy (const DevicePtr_t& robot) const
+    {
+      ConfigProjectorPtr_t cp (createCopy (weak_.lock ()));
+      // Locked joints only store ranks in the configuration of the robot.
+      cp->robot_ = robot;
+      // Functions of the numerical constraints apply to the robot. A
+      // constraint is stored in functions_ and in a level of the stack.
+      std::map <NumericalConstraint*, NumericalConstraintPtr_t> copies;
+      for (NumericalConstraints_t::iterator it = cp->functions_.begin ();
+	   it != cp->functions_.end (); ++it) {
+	NumericalConstraintPtr_t copy ((*it)->copy (robot));
+	if (!copy) return ConfigProjectorPtr_t ();
+	copies [it->get ()] = copy;
+	*it = copy;
+      }
+      for (std::vector <PriorityStack>::iterator itPs = cp->stack_.begin ();
+	   itPs != cp->stack_.end (); ++itPs) {
+	for (NumericalConstraints_t::iterator it = itPs->functions_.begin ();
+	     it != itPs->functions_.end (); ++it) {
+	  assert (copies.count (it->get ()) == 1);
+	  *it = copies [it->get ()];
+	}
+      }
+      return cp;
+    }
+
     ConfigProjector::PriorityStack::PriorityStack (std::size_t level,
         std::size_t cols) :
       level_ (level), outputSize_ (0), cols_ (cols),
       svd_ (outputSize_,cols,Eigen::ComputeThinU | Eigen::ComputeThinV),
-      PK_ (cols, cols)
+      PK_ (cols, cols), JP_ (0, cols), residual_ (0), dqLevel_ (cols)
+    {}
+
+    ConfigProjector::PriorityStack::PriorityStack (const PriorityStack& other) :
+      level_ (other.level_), outputSize_ (other.outputSize_),
+      cols_ (other.cols_), functions_ (other.functions_),
+      passiveDofs_ (other.passiveDofs_), svd_ (), decompositions_ (), PK_ (),
+      JP_ (), residual_ (), dqLevel_ (), blocks_ (other.blocks_),
+      inequalities_ (other.inequalities_), activeRows_ (other.activeRows_),
+      activeJacobian_ (), activeError_ ()
     {}
 
     void ConfigProjector::PriorityStack::add (
@@ -140,18 +373,24 @@ namespace hpp {
     {
       functions_.push_back (nm);
       passiveDofs_.push_back (passiveDofs);
+      // Workspaces are allocated by nbNonLockedDofs.
       outputSize_ += nm->function().outputSize ();
-      svd_ = SVD_t (outputSize_, cols_,
-          Eigen::ComputeThinU | Eigen::ComputeThinV);
     }
 
     void ConfigProjector::PriorityStack::nbNonLockedDofs
       (const std::size_t cols)
     {
       cols_ = cols;
+    }
+
+    void ConfigProjector::PriorityStack::allocateWorkspaces ()
+    {
       svd_ = SVD_t (outputSize_, cols_,
           Eigen::ComputeThinU | Eigen::ComputeThinV);
       PK_.resize (cols_, cols_);
+      JP_.resize (outputSize_, cols_);
+      residual_.resize (outputSize_);
+      dqLevel_.resize (cols_);
     }
 
     void ConfigProjector::add (const NumericalConstraintPtr_t& nm,
@@ -172,8 +411,29 @@ namespace hpp {
         stack_.back  ().level_ = 2; // Last
       }
       stack_[priority].add (nm, passiveDofs);
-      // TODO: no need to recompute intervals.
-      computeIntervals ();
+      update (false);
+    }
+
+    void ConfigProjector::commit ()
+    {
+      assert (updating_);
+      updating_ = false;
+      update (true);
+    }
+
+    void ConfigProjector::update (bool lockedJointsChanged)
+    {
+      modified ();
+      if (updating_) return;
+      if (lockedJointsChanged) {
+	computeIntervals ();
+	hppDout (info, "Intervals: ");
+	for (SizeIntervals_t::const_iterator it = intervals_.begin ();
+	     it != intervals_.end (); ++it) {
+	  hppDout (info, "[" << it->first << "," << it->first + it->second - 1
+		   << "]");
+	}
+      }
       resize ();
       updateExplicitComputation ();
     }
@@ -185,7 +445,23 @@ namespace hpp {
       std::pair < size_type, size_type > interval;
       std::size_t latestIndex = 0;
       size_type size;
-      lockedJoints_.sort ();
+      std::sort (lockedJoints_.begin (), lockedJoints_.end (),
+		 compareRankInVelocity);
+      lockedConfIntervals_.clear ();
+      for (LockedJoints_t::const_iterator itLocked = lockedJoints_.begin ();
+	   itLocked != lockedJoints_.end (); ++itLocked) {
+	size_type rank = (*itLocked)->rankInConfiguration ();
+	size_type size = (*itLocked)->size ();
+	if (size == 0) continue;
+	if (!lockedConfIntervals_.empty () &&
+	    lockedConfIntervals_.back ().first +
+	    lockedConfIntervals_.back ().second == rank) {
+	  lockedConfIntervals_.back ().second += size;
+	} else {
+	  lockedConfIntervals_.push_back (SizeInterval_t (rank, size));
+	}
+      }
+      updateLockedValues ();
       // temporarily add an element at the end of the list.
       lockedJoints_.push_back (LockedJoint::create (robot_));
       for (LockedJoints_t::const_iterator itLocked = lockedJoints_.begin ();
@@ -205,6 +481,25 @@ namespace hpp {
       lockedJoints_.pop_back ();
     }
 
+    void ConfigProjector::updateLockedValues ()
+    {
+      size_type size = 0;
+      for (LockedJoints_t::const_iterator itLocked = lockedJoints_.begin ();
+	   itLocked != lockedJoints_.end (); ++itLocked) {
+	size += (*itLocked)->size ();
+      }
+      lockedValues_.resize (size);
+      lockedBuffer_.resize (size);
+      // Locked joints are sorted by rank, as lockedConfIntervals_.
+      size_type row = 0;
+      for (LockedJoints_t::const_iterator itLocked = lockedJoints_.begin ();
+	   itLocked != lockedJoints_.end (); ++itLocked) {
+	lockedValues_.segment (row, (*itLocked)->size ()) =
+	  (*itLocked)->value ();
+	row += (*itLocked)->size ();
+      }
+    }
+
     void ConfigProjector::resize ()
     {
       std::size_t sizeOutput = 0;
@@ -219,83 +514,237 @@ namespace hpp {
 	}
       }
       nbNonLockedDofs_ = robot_->numberDof () - nbLockedDofs_;
-      value_.resize (sizeOutput);
+      hasWarmStart_ = false;
+      valueCached_ = false;
       rightHandSide_ = vector_t::Zero (sizeOutput);
+      for (std::vector <PriorityStack>::iterator it = stack_.begin ();
+          it != stack_.end (); ++it) {
+        it->nbNonLockedDofs (nbNonLockedDofs_);
+        it->computeBlocks (intervals_);
+      }
+      allocateWorkspaces ();
+    }
+
+    void ConfigProjector::allocateWorkspaces ()
+    {
+      size_type sizeOutput = rightHandSide_.size ();
+      size_type nbDofs = robot_->numberDof ();
+      value_.resize (sizeOutput);
+      valueTrial_.resize (sizeOutput);
       reducedJacobian_.resize (sizeOutput, nbNonLockedDofs_);
-      reducedJacobian_.setConstant (sqrt (-1));
+      // Only non zero blocks are written when computing the Jacobian.
+      reducedJacobian_.setZero ();
       svd_ = SVD_t (sizeOutput, nbNonLockedDofs_,
           Eigen::ComputeThinU | Eigen::ComputeThinV);
+      qTrial_.resize (robot_->configSize ());
+      warmStartInput_.resize (robot_->configSize ());
+      warmStartCorrection_.resize (nbDofs);
+      valueConfiguration_.resize (robot_->configSize ());
+      toMinusFrom_.resize (nbDofs);
+      projMinusFrom_.resize (nbDofs);
+      dq_.resize (nbDofs);
       dqSmall_.resize (nbNonLockedDofs_);
+      error_.resize (sizeOutput);
+      projector_.resize (nbNonLockedDofs_, nbNonLockedDofs_);
       dq_.setZero ();
       toMinusFromSmall_.resize (nbNonLockedDofs_);
       projMinusFromSmall_.resize (nbNonLockedDofs_);
       projMinusFrom_.setZero ();
       reducedProjector_.resize (nbNonLockedDofs_, nbNonLockedDofs_);
       for (std::vector <PriorityStack>::iterator it = stack_.begin ();
-          it != stack_.end (); ++it)
-        it->nbNonLockedDofs (nbNonLockedDofs_);
+          it != stack_.end (); ++it) {
+        it->allocateWorkspaces ();
+      }
+      workspaces_ = true;
+    }
+
+    void ConfigProjector::PriorityStack::computeBlocks
+    (const SizeIntervals_t& intervals)
+    {
+      blocks_.resize (functions_.size ());
+      inequalities_.resize (functions_.size ());
+      activeRows_.clear ();
+      std::vector <bool> used;
+      for (std::size_t i = 0; i < functions_.size (); ++i) {
+        ComparisonType* comparison (functions_ [i]->comparisonType ().get ());
+        inequalities_ [i] = !dynamic_cast <Equality*> (comparison) &&
+          !dynamic_cast <EqualToZero*> (comparison);
+        // Columns that are active and not passive
+        const SizeIntervals_t& active (functions_ [i]->activeColumns ());
+        used.assign (functions_ [i]->function ().inputDerivativeSize (),
+                     false);
+        for (SizeIntervals_t::const_iterator it = active.begin ();
+             it != active.end (); ++it)
+          for (size_type c = it->first; c < it->first + it->second; ++c)
+            used [c] = true;
+        for (SizeIntervals_t::const_iterator it = passiveDofs_ [i].begin ();
+             it != passiveDofs_ [i].end (); ++it)
+          for (size_type c = it->first; c < it->first + it->second; ++c)
+            used [c] = false;
+        // Group consecutive used columns that are not locked
+        Blocks_t& blocks (blocks_ [i]);
+        blocks.clear ();
+        size_type reducedCol = 0;
+        for (SizeIntervals_t::const_iterator itInterval = intervals.begin ();
+             itInterval != intervals.end (); ++itInterval) {
+          size_type end = itInterval->first + itInterval->second;
+          for (size_type c = itInterval->first; c < end; ++c, ++reducedCol) {
+            if (!used [c]) continue;
+            if (!blocks.empty () && blocks.back ().col +
+                blocks.back ().cols == c &&
+                blocks.back ().reducedCol + blocks.back ().cols == reducedCol)
+              ++blocks.back ().cols;
+            else {
+              Block block;
+              block.col = c;
+              block.reducedCol = reducedCol;
+              block.cols = 1;
+              blocks.push_back (block);
+            }
+          }
+        }
+      }
+      // All rows are active until the functions are evaluated.
+      for (std::size_t r = 0; r < outputSize_; ++r) activeRows_.push_back (r);
     }
 
     void ConfigProjector::PriorityStack::computeValueAndJacobian
-    (ConfigurationIn_t configuration, const SizeIntervals_t& intervals,
-     vectorOut_t value, matrixOut_t reducedJacobian)
+    (ConfigurationIn_t configuration, vectorOut_t value,
+     matrixOut_t reducedJacobian, bool computeValues)
     {
+      assert (blocks_.size () == functions_.size ());
       size_type row = 0, nvRows = 0, njRows = 0;
-      IntervalsContainer_t::const_iterator itPassiveDofs
-        = passiveDofs_.begin ();
-      for (NumericalConstraints_t::iterator it = functions_.begin ();
-	   it != functions_.end (); ++it) {
-	DifferentiableFunction& f = (*it)->function ();
-	vector_t& v = (*it)->value ();
-	matrix_t& jacobian = (*it)->jacobian ();
-	f (v, configuration);
+      activeRows_.clear ();
+      for (std::size_t i = 0; i < functions_.size (); ++i) {
+	DifferentiableFunction& f = functions_ [i]->function ();
+	vector_t& v = functions_ [i]->value ();
+	matrix_t& jacobian = functions_ [i]->jacobian ();
+	if (computeValues) f (v, configuration);
 	f.jacobian (jacobian, configuration);
-        (*(*it)->comparisonType ()) (v, jacobian);
 	nvRows = f.outputSize ();
 	njRows = f.outputDerivativeSize ();
-	// Copy columns that are not locked
-	size_type col = 0;
+	// v keeps the value of the function.
 	value.segment (row, nvRows) = v;
-        /// Set the passive DOFs to zero.
-	for (SizeIntervals_t::const_iterator it = itPassiveDofs->begin ();
-	     it != itPassiveDofs->end (); ++it)
-          jacobian.middleCols (it->first, it->second).setZero ();
-        /// Copy the non locked DOFs.
-	for (SizeIntervals_t::const_iterator itInterval = intervals.begin ();
-	     itInterval != intervals.end (); ++itInterval) {
-	  size_type col0 = itInterval->first;
-	  size_type nbCols = itInterval->second;
-	  reducedJacobian.block (row, col, njRows, nbCols) =
-	    jacobian.block (0, col0, njRows, nbCols);
-	  col += nbCols;
+        (*functions_ [i]->comparisonType ()) (value.segment (row, nvRows),
+                                              jacobian);
+        /// Copy the blocks of active, non passive and non locked DOFs.
+	for (Blocks_t::const_iterator itBlock = blocks_ [i].begin ();
+	     itBlock != blocks_ [i].end (); ++itBlock) {
+	  reducedJacobian.block (row, itBlock->reducedCol, njRows,
+				 itBlock->cols) =
+	    jacobian.block (0, itBlock->col, njRows, itBlock->cols);
+	}
+	for (size_type r = 0; r < njRows; ++r) {
+	  // The comparison zeroes the rows of inactive inequalities.
+	  if (!inequalities_ [i] || !jacobian.row (r).isZero (0)) {
+	    activeRows_.push_back (row + r);
+	  }
 	}
         row += njRows;
-        ++itPassiveDofs;
       }
-      assert (itPassiveDofs == passiveDofs_.end ());
     }
 
     void ConfigProjector::computeValueAndJacobian
     (ConfigurationIn_t configuration, vectorOut_t value,
      matrixOut_t reducedJacobian)
     {
+      checkWorkspaces ();
+      valueCached_ = false;
+      reducedJacobian.setZero ();
+      assembleValueAndJacobian (configuration, value, reducedJacobian);
+      valueCached_ = false;
+    }
+
+    void ConfigProjector::assembleValueAndJacobian
+    (ConfigurationIn_t configuration, vectorOut_t value,
+     matrixOut_t reducedJacobian)
+    {
+      bool computeValues = !valueCached_ ||
+	valueConfiguration_ != configuration;
       size_type row = 0, nbRows = 0;
       for (std::vector <PriorityStack>::iterator itPs = stack_.begin ();
-          itPs != stack_.end (); ++itPs) { 
+          itPs != stack_.end (); ++itPs) {
         nbRows = itPs->outputSize_;
-        itPs->computeValueAndJacobian (configuration, intervals_,
+        itPs->computeValueAndJacobian (configuration,
             value.segment (row, nbRows),
-            reducedJacobian.middleRows (row, nbRows));
+            reducedJacobian.middleRows (row, nbRows), computeValues);
         row += nbRows;
       }
+      valueConfiguration_ = configuration;
+      valueCached_ = true;
+    }
+
+    void ConfigProjector::solve (LinearSolver solver,
+        const value_type& squareDamping, SVD_t& svd,
+        Decompositions& decompositions, matrixIn_t jacobian,
+        vectorIn_t error, vectorOut_t dq)
+    {
+      switch (solver) {
+        case DAMPED_LEAST_SQUARES:
+          {
+            matrix_t& JJt = decompositions.JJt_;
+            JJt.noalias () = jacobian * jacobian.transpose ();
+            JJt.diagonal ().array () += squareDamping;
+            decompositions.llt_.compute (JJt);
+            vector_t& y = decompositions.y_;
+            y = decompositions.llt_.solve (error);
+            dq.noalias () = jacobian.transpose () * y;
+          }
+          break;
+        case QR:
+          {
+            // J^T P = Q R, dq = Q_r R_r^{-T} (P^T error)_r where r is the
+            // rank of J.
+            Eigen::ColPivHouseholderQR <matrix_t>& qr = decompositions.qr_;
+            qr.compute (jacobian.transpose ());
+            size_type rank = qr.rank ();
+            vector_t& y = decompositions.y_;
+            y = qr.colsPermutation ().transpose () * error;
+            vector_t::SegmentReturnType head = y.head (rank);
+            qr.matrixQR ().topLeftCorner (rank, rank).
+              triangularView <Eigen::Upper> ().transpose ().
+              solveInPlace (head);
+            dq.setZero ();
+            dq.head (rank) = head;
+            dq.applyOnTheLeft (qr.householderQ ());
+          }
+          break;
+        default:
+          svd.compute (jacobian);
+          dq = svd.solve (error);
+          break;
+      }
     }
 
     bool ConfigProjector::PriorityStack::computeIncrement (vectorIn_t error,
-        matrixIn_t jacobian, vectorOut_t dq, matrixOut_t projector)
+        matrixIn_t jacobian, vectorOut_t dq, matrixOut_t projector,
+        LinearSolver solver, const value_type& squareDamping)
     {
       // TODO: handle case where this is the first element of the stack and it
       // has no functions
       if (functions_.size () == 0) return true;
+      const size_type n = activeRows_.size ();
+      if (n == (size_type) outputSize_) {
+        return solveLevel (error, jacobian, dq, projector, solver,
+                           squareDamping);
+      }
+      // Inactive rows are zero, as their error: neither the increment nor
+      // the projector change if all the rows are inactive.
+      if (n == 0) return true;
+      activeJacobian_.resize (n, jacobian.cols ());
+      activeError_.resize (n);
+      for (size_type i = 0; i < n; ++i) {
+        activeJacobian_.row (i) = jacobian.row (activeRows_ [i]);
+        activeError_ [i] = error [activeRows_ [i]];
+      }
+      return solveLevel (activeError_, activeJacobian_, dq, projector, solver,
+                         squareDamping);
+    }
+
+    bool ConfigProjector::PriorityStack::solveLevel (vectorIn_t error,
+        matrixIn_t jacobian, vectorOut_t dq, matrixOut_t projector,
+        LinearSolver solver, const value_type& squareDamping)
+    {
       /// projector is of size numberDof
       switch (level_) {
         case 0: // First
@@ -305,40 +754,58 @@ namespace hpp {
           break;
         case 2: // Last
           // No need to compute projector for next step.
-          svd_.compute (jacobian * projector);
-          dq.noalias() += projector * svd_.solve (error - jacobian * dq);
+          JP_.noalias () = jacobian * projector;
+          residual_ = error;
+          residual_.noalias () -= jacobian * dq;
+          solve (solver, squareDamping, svd_, decompositions_, JP_,
+                 residual_, dqLevel_);
+          dq.noalias() += projector * dqLevel_;
           return true; // The return value is not important in this case.
           break;
         case 3: // First and last (one level only)
-          svd_.compute (jacobian);
-          dq = svd_.solve (error);
+          solve (solver, squareDamping, svd_, decompositions_, jacobian,
+                 error, dq);
           return true; // The return value is not important in this case.
           break;
         default: /// General case
-          svd_.compute (jacobian * projector);
-          dq.noalias() += projector * svd_.solve (error - jacobian * dq);
+          JP_.noalias () = jacobian * projector;
+          svd_.compute (JP_);
+          residual_ = error;
+          residual_.noalias () -= jacobian * dq;
+          dqLevel_ = svd_.solve (residual_);
+          dq.noalias() += projector * dqLevel_;
           break;
       }
       /// compute projector for next step.
       hpp::constraints::projectorOnKernel <SVD_t> (svd_, PK_);
       assert ((projector * PK_ - PK_).isZero());
       projector -= PK_;
-      return (jacobian * dq - error).isZero ();
+      residual_.noalias () = jacobian * dq;
+      residual_ -= error;
+      return residual_.isZero ();
     }
 
     void ConfigProjector::computePrioritizedIncrement (vectorIn_t value,
         matrixIn_t reducedJacobian, const value_type& alpha, vectorOut_t dq)
     {
-      vector_t error = - alpha * (value - rightHandSide_);
-      matrix_t projector =
-        matrix_t::Identity (nbNonLockedDofs_, nbNonLockedDofs_);
+      checkWorkspaces ();
+      computePrioritizedIncrement (value, reducedJacobian, alpha, dq,
+                                   linearSolver_, squareDamping_);
+    }
+
+    void ConfigProjector::computePrioritizedIncrement (vectorIn_t value,
+        matrixIn_t reducedJacobian, const value_type& alpha, vectorOut_t dq,
+        LinearSolver solver, const value_type& squareDamping)
+    {
+      error_ = alpha * (rightHandSide_ - value);
+      projector_.setIdentity ();
       std::size_t row = 0;
       dqSmall_.setZero ();
       for (std::vector <PriorityStack>::iterator it = stack_.begin ();
           it != stack_.end (); ++it) {
-        if (!it->computeIncrement (error.segment (row, it->outputSize_),
+        if (!it->computeIncrement (error_.segment (row, it->outputSize_),
             reducedJacobian.middleRows (row, it->outputSize_),
-            dqSmall_, projector))
+            dqSmall_, projector_, solver, squareDamping))
           break;
         row += it->outputSize_;
       }
@@ -349,18 +816,18 @@ namespace hpp {
         matrixIn_t reducedJacobian, const value_type& alpha, vectorOut_t dq,
         const std::size_t& level)
     {
-      vector_t error = alpha * (rightHandSide_ - value);
-      matrix_t projector =
-        matrix_t::Identity (nbNonLockedDofs_, nbNonLockedDofs_);
+      checkWorkspaces ();
+      error_ = alpha * (rightHandSide_ - value);
+      projector_.setIdentity ();
       std::size_t row = 0;
       dqSmall_.setZero ();
       std::vector <PriorityStack>::iterator end = stack_.begin ();
       std::advance (end, level);
       for (std::vector <PriorityStack>::iterator it = stack_.begin ();
           it != end; ++it) {
-        if (!it->computeIncrement (error.segment (row, it->outputSize_),
+        if (!it->computeIncrement (error_.segment (row, it->outputSize_),
             reducedJacobian.middleRows (row, it->outputSize_),
-            dqSmall_, projector))
+            dqSmall_, projector_, linearSolver_, squareDamping_))
           break;
         row += it->outputSize_;
       }
@@ -370,8 +837,10 @@ namespace hpp {
     void ConfigProjector::computeIncrement (vectorIn_t value,
         matrixIn_t reducedJacobian, const value_type& alpha, vectorOut_t dq)
     {
-      svd_.compute (reducedJacobian);
-      dqSmall_ = svd_.solve(alpha * (rightHandSide_ - value));
+      checkWorkspaces ();
+      error_ = alpha * (rightHandSide_ - value);
+      solve (linearSolver_, squareDamping_, svd_, decompositions_,
+             reducedJacobian, error_, dqSmall_);
       uncompressVector (dqSmall_, dq);
     }
 
@@ -479,70 +948,162 @@ namespace hpp {
 
     void ConfigProjector::updateExplicitComputation ()
     {
-      if ((functions_.size () != 1) || (explicitFunctions_.size () != 1)) {
-	explicitComputation_ = false;
-	return;
-      }
-      HPP_STATIC_CAST_REF_CHECK (ExplicitNumericalConstraint,
-				 *(functions_ [0]));
-      const SizeIntervals_t& output =
-	HPP_STATIC_PTR_CAST (ExplicitNumericalConstraint,
-			     functions_ [0])->outputConf ();
+      explicitOrder_.clear ();
+      // Configuration variables that are locked or output of an explicit
+      // constraint
+      std::vector <bool> determined (robot_->configSize (), false);
       for (LockedJoints_t::const_iterator itLocked = lockedJoints_.begin ();
 	   itLocked != lockedJoints_.end (); ++itLocked) {
 	size_type a = (size_type) (*itLocked)->rankInConfiguration ();
-	size_type b = (size_type) (*itLocked)->rankInConfiguration () +
-	  (*itLocked)->size () - 1;
+	for (size_type i = a; i < a + (*itLocked)->size (); ++i)
+	  determined [i] = true;
+      }
+      std::vector <ExplicitNumericalConstraintPtr_t> candidates;
+      std::vector <std::size_t> indices;
+      for (std::vector <std::size_t>::const_iterator it =
+	     explicitFunctions_.begin (); it != explicitFunctions_.end ();
+	   ++it) {
+	HPP_STATIC_CAST_REF_CHECK (ExplicitNumericalConstraint,
+				   *(functions_ [*it]));
+	ExplicitNumericalConstraintPtr_t enc
+	  (HPP_STATIC_PTR_CAST (ExplicitNumericalConstraint,
+				functions_ [*it]));
+	const SizeIntervals_t& output = enc->outputConf ();
+	bool isFree = true;
+	for (SizeIntervals_t::const_iterator itOut = output.begin ();
+	     isFree && itOut != output.end (); ++itOut) {
+	  for (size_type i = itOut->first;
+	       i < itOut->first + itOut->second; ++i) {
+	    if (determined [i]) {
+	      isFree = false;
+	      break;
+	    }
+	  }
+	}
+	if (!isFree) continue;
 	for (SizeIntervals_t::const_iterator itOut = output.begin ();
 	     itOut != output.end (); ++itOut) {
-	  size_type c = itOut->first;
-	  size_type d = itOut->first + itOut->second - 1;
-	  if ((d >= a) && (b >= c)) {
-	    explicitComputation_ = false;
-	    return;
+	  for (size_type i = itOut->first;
+	       i < itOut->first + itOut->second; ++i)
+	    determined [i] = true;
+	}
+	candidates.push_back (enc);
+	indices.push_back (*it);
+      }
+      // Candidate owning each output degree of freedom
+      std::size_t n = candidates.size ();
+      std::vector <std::size_t> owner (robot_->numberDof (), n);
+      for (std::size_t k = 0; k < n; ++k) {
+	const SizeIntervals_t& output = candidates [k]->outputVelocity ();
+	for (SizeIntervals_t::const_iterator itOut = output.begin ();
+	     itOut != output.end (); ++itOut) {
+	  for (size_type i = itOut->first;
+	       i < itOut->first + itOut->second; ++i)
+	    owner [i] = k;
+	}
+      }
+      // successors [j] depend on candidate j.
+      std::vector <std::vector <std::size_t> > successors (n);
+      std::vector <std::size_t> nbPredecessors (n, 0);
+      for (std::size_t k = 0; k < n; ++k) {
+	std::vector <bool> predecessor (n, false);
+	const SizeIntervals_t& active = candidates [k]->activeColumns ();
+	for (SizeIntervals_t::const_iterator it = active.begin ();
+	     it != active.end (); ++it) {
+	  for (size_type i = it->first; i < it->first + it->second; ++i) {
+	    std::size_t j = owner [i];
+	    if (j == n || j == k || predecessor [j]) continue;
+	    predecessor [j] = true;
+	    successors [j].push_back (k);
+	    ++nbPredecessors [k];
 	  }
 	}
       }
-      explicitComputation_ = true;
+      // Topological sort (Kahn)
+      std::vector <std::size_t> ready;
+      for (std::size_t k = n; k > 0; --k) {
+	if (nbPredecessors [k-1] == 0) ready.push_back (k-1);
+      }
+      while (!ready.empty ()) {
+	std::size_t k = ready.back ();
+	ready.pop_back ();
+	explicitOrder_.push_back (indices [k]);
+	for (std::vector <std::size_t>::const_iterator it =
+	       successors [k].begin (); it != successors [k].end (); ++it) {
+	  if (--nbPredecessors [*it] == 0) ready.push_back (*it);
+	}
+      }
+      hppDout (info, explicitOrder_.size () << " explicit constraints out of "
+	       << functions_.size () << " are solved in closed form.");
+      explicitComputation_ = !functions_.empty () &&
+	(explicitOrder_.size () == functions_.size ());
+    }
+
+    void ConfigProjector::solveExplicitConstraints
+    (ConfigurationOut_t configuration)
+    {
+      for (std::vector <std::size_t>::const_iterator it =
+	     explicitOrder_.begin (); it != explicitOrder_.end (); ++it) {
+	hppDout (info, "Explicit computation: " <<
+		 functions_ [*it]->functionPtr ()->name ());
+	HPP_STATIC_PTR_CAST (ExplicitNumericalConstraint,
+			     functions_ [*it])->solve (configuration);
+      }
     }
 
     bool ConfigProjector::impl_compute (ConfigurationOut_t configuration)
     {
+      TraceScope trace ("ConfigProjector::impl_compute");
+      OperationCounters::increment (OperationCounters::PROJECTION);
+      checkWorkspaces ();
       hppDout (info, "before projection: " << configuration.transpose ());
       computeLockedDofs (configuration);
-      if (isSatisfiedNoLockedJoint (configuration)) return true;
+      valueCached_ = false;
+      // Constraints solved in closed form are only evaluated once, after
+      // the explicit solve.
+      if (!explicitComputation_ && isSatisfiedNoLockedJoint (configuration)) {
+	valueCached_ = false;
+	return true;
+      }
       if (functions_.empty ()) return true;
+      if (!explicitComputation_ && warmStart_) {
+	applyWarmStart (configuration);
+      }
+      if (!explicitOrder_.empty ()) {
+	// Explicit functions may be evaluated by solve.
+	valueCached_ = false;
+	solveExplicitConstraints (configuration);
+      }
       if (explicitComputation_) {
-	hppDout (info, "Explicit computation: " <<
-		 functions_ [0]->functionPtr ()->name ());
-	HPP_STATIC_CAST_REF_CHECK (ExplicitNumericalConstraint,
-				   *(functions_ [0]));
-	HPP_STATIC_PTR_CAST (ExplicitNumericalConstraint,
-			     functions_ [0])->solve (configuration);
+	// The explicit solve satisfies all the constraints up to rounding
+	// errors: values are checked without computing the Jacobian, which
+	// is only computed from the cached values if the check fails.
+	computeValue (configuration, value_);
+	computeError ();
+	// Same test as isSatisfied
+	if (squareNorm_ < squareErrorThreshold_) {
+	  statistics_.addSuccess ();
+	  valueCached_ = false;
+	  return true;
+	}
       }
       HPP_START_TIMECOUNTER (projection);
-      value_type alpha = .2;
-      value_type alphaMax = .95;
-      size_type errorDecreased = 3, iter = 0;
-      value_type previousSquareNorm =
-	std::numeric_limits<value_type>::infinity();
+      size_type iter = 0;
+      bool errorDecreased;
       // Fill value and Jacobian
-      computeValueAndJacobian (configuration, value_, reducedJacobian_);
+      assembleValueAndJacobian (configuration, value_, reducedJacobian_);
       computeError ();
-      while (squareNorm_ > squareErrorThreshold_ && errorDecreased &&
-	     iter < maxIterations_) {
-        computePrioritizedIncrement (value_, reducedJacobian_, alpha, dq_);
-	model::integrate (robot_, configuration, dq_, configuration);
-	// Increase alpha towards alphaMax
-	computeValueAndJacobian (configuration, value_, reducedJacobian_);
-	alpha = alphaMax - .8*(alphaMax - alpha);
-        computeError ();
-	hppDout (info, "squareNorm = " << squareNorm_);
-	--errorDecreased;
-	if (squareNorm_ < previousSquareNorm) errorDecreased = 3;
-	previousSquareNorm = squareNorm_;
-	++iter;
-      };
+      switch (stepStrategy_) {
+      case LINE_SEARCH:
+	errorDecreased = solveLineSearch (configuration, iter);
+	break;
+      case LEVENBERG_MARQUARDT:
+	errorDecreased = solveLevenbergMarquardt (configuration, iter);
+	break;
+      default:
+	errorDecreased = solveFixedSteps (configuration, iter);
+	break;
+      }
       if (squareNorm_ > squareErrorThreshold_) {
         if (!errorDecreased)
           statistics_.addFailure (REASON_ERROR_INCREASED);
@@ -559,18 +1120,216 @@ namespace hpp {
       HPP_STOP_TIMECOUNTER (projection);
       HPP_DISPLAY_TIMECOUNTER (projection);
       hppDout (info, "number of iterations: " << iter);
+      valueCached_ = false;
       if (squareNorm_ > squareErrorThreshold_) {
 	hppDout (info, "Projection failed.");
+	hasWarmStart_ = false;
 	return false;
       }
+      if (warmStart_ && !explicitComputation_) {
+	model::difference (robot_, configuration, warmStartInput_,
+			   warmStartCorrection_);
+	hasWarmStart_ = true;
+      }
       hppDout (info, "After projection: " << configuration.transpose ());
       return true;
     }
 
+    void ConfigProjector::applyWarmStart (ConfigurationOut_t configuration)
+    {
+      bool apply = hasWarmStart_;
+      if (apply) {
+	// dq_ is not used since its locked degrees of freedom should be 0.
+	model::difference (robot_, configuration, warmStartInput_,
+			   toMinusFrom_);
+	apply = (toMinusFrom_.norm () <= warmStartMaxDistance_);
+      }
+      warmStartInput_ = configuration;
+      if (!apply) return;
+      model::integrate (robot_, configuration, warmStartCorrection_, qTrial_);
+      computeValue (qTrial_, valueTrial_);
+      // squareNorm_ is the error at configuration.
+      if (squaredError (valueTrial_) < squareNorm_) {
+	hppDout (info, "warm start: " << qTrial_.transpose ());
+	configuration = qTrial_;
+      }
+    }
+
+    bool ConfigProjector::solveFixedSteps (ConfigurationOut_t configuration,
+					   size_type& iter)
+    {
+      value_type alpha = .2;
+      value_type alphaMax = .95;
+      size_type errorDecreased = 3;
+      value_type previousSquareNorm =
+	std::numeric_limits<value_type>::infinity();
+      while (squareNorm_ > squareErrorThreshold_ && errorDecreased &&
+	     iter < maxIterations_) {
+        computePrioritizedIncrement (value_, reducedJacobian_, alpha, dq_);
+	model::integrate (robot_, configuration, dq_, configuration);
+	// Increase alpha towards alphaMax
+	assembleValueAndJacobian (configuration, value_, reducedJacobian_);
+	alpha = alphaMax - .8*(alphaMax - alpha);
+        computeError ();
+	hppDout (info, "squareNorm = " << squareNorm_);
+	--errorDecreased;
+	if (squareNorm_ < previousSquareNorm) errorDecreased = 3;
+	previousSquareNorm = squareNorm_;
+	++iter;
+      }
+      return errorDecreased != 0;
+    }
+
+    bool ConfigProjector::solveLineSearch (ConfigurationOut_t configuration,
+					   size_type& iter)
+    {
+      // Sufficient decrease of the squared error along a Gauss-Newton step
+      const value_type armijo = 1e-4;
+      const value_type minimalStep = 1./64;
+      while (squareNorm_ > squareErrorThreshold_ && iter < maxIterations_) {
+        computePrioritizedIncrement (value_, reducedJacobian_, 1, dq_);
+	++iter;
+	value_type alpha = 1;
+	value_type squareNorm;
+	while (true) {
+	  model::integrate (robot_, configuration, dq_, qTrial_);
+	  computeValue (qTrial_, valueTrial_);
+	  squareNorm = squaredError (valueTrial_);
+	  if (squareNorm <= (1 - 2 * armijo * alpha) * squareNorm_) break;
+	  // Configuration is left unchanged if no step decreases the error.
+	  if (alpha <= minimalStep) return false;
+	  alpha *= .5;
+	  dq_ *= .5;
+	}
+	configuration = qTrial_;
+	assembleValueAndJacobian (configuration, value_, reducedJacobian_);
+	computeError ();
+	hppDout (info, "squareNorm = " << squareNorm_ << ", step = " << alpha);
+      }
+      return true;
+    }
+
+    bool ConfigProjector::solveLevenbergMarquardt
+    (ConfigurationOut_t configuration, size_type& iter)
+    {
+      // Damping of J J^T relative to the squared error
+      value_type lambda = 1e-2;
+      const value_type minimalLambda = 1e-8;
+      const value_type maximalLambda = 1e8;
+      while (squareNorm_ > squareErrorThreshold_ && iter < maxIterations_) {
+        computePrioritizedIncrement (value_, reducedJacobian_, 1, dq_,
+				     DAMPED_LEAST_SQUARES,
+				     lambda * squareNorm_);
+	++iter;
+	model::integrate (robot_, configuration, dq_, qTrial_);
+	computeValue (qTrial_, valueTrial_);
+	if (squaredError (valueTrial_) < squareNorm_) {
+	  configuration = qTrial_;
+	  assembleValueAndJacobian (configuration, value_, reducedJacobian_);
+	  computeError ();
+	  lambda = std::max (.1 * lambda, minimalLambda);
+	} else {
+	  // Reject step, Jacobian does not need to be recomputed.
+	  lambda *= 10;
+	  if (lambda > maximalLambda) return false;
+	}
+	hppDout (info, "squareNorm = " << squareNorm_ << ", lambda = "
+		 << lambda);
+      }
+      return true;
+    }
+
+    void ConfigProjector::applyBatch (matrixOut_t configurations,
+				      std::vector <bool>& success,
+				      std::size_t numberThreads)
+    {
+      projectBatch (configurations, 0x0, success, numberThreads);
+    }
+
+    void ConfigProjector::oneStepBatch (matrixOut_t configurations,
+					vectorIn_t alpha,
+					std::vector <bool>& success,
+					std::size_t numberThreads)
+    {
+      assert (alpha.size () == configurations.cols ());
+      projectBatch (configurations, &alpha, success, numberThreads);
+    }
+
+    void ConfigProjector::projectBatch (matrixOut_t configurations,
+					const vectorIn_t* alpha,
+					std::vector <bool>& success,
+					std::size_t numberThreads)
+    {
+      size_type n = configurations.cols ();
+      if (numberThreads <= 1 || n <= 1) {
+	success.assign (n, false);
+	for (size_type i = 0; i < n; ++i) {
+	  if (alpha) {
+	    success [i] = oneStep (configurations.col (i), (*alpha) [i]);
+	  } else {
+	    success [i] = apply (configurations.col (i));
+	  }
+	}
+	return;
+      }
+      if (!batchThreads_ ||
+	  batchThreads_->numberThreads () != numberThreads ||
+	  batchThreads_->revision () != revision ()) {
+	// Stop the threads before copying the modified projector
+	batchThreads_.reset ();
+	std::vector <ConfigProjectorPtr_t> copies;
+	for (std::size_t k = 1; k < numberThreads; ++k) {
+	  ConfigProjectorPtr_t cp (copy (robot_->clone ()));
+	  if (!cp) {
+	    throw std::runtime_error ("Numerical constraints without function "
+				      "builder cannot be copied for threads.");
+	  }
+	  copies.push_back (cp);
+	}
+	batchThreads_.reset (new configProjector::BatchThreads
+			     (copies, revision ()));
+      }
+      for (std::vector <ConfigProjectorPtr_t>::const_iterator it =
+	     batchThreads_->copies ().begin ();
+	   it != batchThreads_->copies ().end (); ++it) {
+	synchronize (**it);
+      }
+      batchThreads_->project (*this, configurations, alpha, success);
+    }
+
+    void ConfigProjector::synchronize (ConfigProjector& copy) const
+    {
+      vector_t rhs (rightHandSide ());
+      if (copy.rightHandSide () != rhs) copy.rightHandSide (rhs);
+      // Values of locked joints may be modified without the right hand side
+      copy.lockedValues_ = lockedValues_;
+      if (copy.warmStart_ != warmStart_) copy.warmStart (warmStart_);
+      copy.warmStartMaxDistance_ = warmStartMaxDistance_;
+    }
+
+    value_type ConfigProjector::curvature (ConfigurationIn_t configuration,
+					   vectorIn_t direction,
+					   const value_type& h)
+    {
+      assert (direction.size () == robot_->numberDof ());
+      assert (h > 0);
+      checkWorkspaces ();
+      if (functions_.empty ()) return 0;
+      compressVector (direction, dqSmall_);
+      computeValueAndJacobian (configuration, value_, reducedJacobian_);
+      valueTrial_.noalias () = - reducedJacobian_ * dqSmall_;
+      model::integrate (robot_, configuration, h * direction, qTrial_);
+      computeValueAndJacobian (qTrial_, value_, reducedJacobian_);
+      valueTrial_.noalias () += reducedJacobian_ * dqSmall_;
+      svd_.compute (reducedJacobian_);
+      return svd_.solve (valueTrial_).norm () / h;
+    }
+
     bool ConfigProjector::oneStep (ConfigurationOut_t configuration,
         const value_type& alpha)
     {
-      computeValueAndJacobian (configuration, value_, reducedJacobian_);
+      checkWorkspaces ();
+      assembleValueAndJacobian (configuration, value_, reducedJacobian_);
       computePrioritizedIncrement (value_, reducedJacobian_, alpha, dq_);
       model::integrate (robot_, configuration, dq_, configuration);
       return isSatisfied (configuration);
@@ -579,6 +1338,7 @@ namespace hpp {
     bool ConfigProjector::optimize (ConfigurationOut_t configuration,
         std::size_t maxIter, const value_type alpha)
     {
+      checkWorkspaces ();
       /// TODO: What should be checked first ?
       if (functions_.empty ()) return true;
       if (!isSatisfied (configuration)) return false;
@@ -587,18 +1347,18 @@ namespace hpp {
       HPP_START_TIMECOUNTER (optimize);
       Configuration_t current = configuration;
       std::size_t iter = 0;
-      computeValueAndJacobian (configuration, value_, reducedJacobian_);
+      assembleValueAndJacobian (configuration, value_, reducedJacobian_);
       do {
         computePrioritizedIncrement (value_, reducedJacobian_, alpha, dq_);
 	model::integrate (robot_, configuration, dq_, current);
-        computeValueAndJacobian (current, value_, reducedJacobian_);
+        assembleValueAndJacobian (current, value_, reducedJacobian_);
         computeError ();
         if (squareNorm_ >= squareErrorThreshold_) {
           /// Ignore last level
           computePrioritizedIncrement (value_, reducedJacobian_, 1, dq_,
               stack_.size() - 1);
           model::integrate (robot_, current, dq_, current);
-          computeValueAndJacobian (current, value_, reducedJacobian_);
+          assembleValueAndJacobian (current, value_, reducedJacobian_);
           computeError ();
           if (squareNorm_ >= squareErrorThreshold_) break;
         }
@@ -621,11 +1381,12 @@ namespace hpp {
 						 vectorIn_t velocity,
 						 vectorOut_t result)
     {
+      checkWorkspaces ();
       if (functions_.empty ()) {
         result = velocity;
         return;
       }
-      computeValueAndJacobian (from, value_, reducedJacobian_);
+      assembleValueAndJacobian (from, value_, reducedJacobian_);
       compressVector (velocity, toMinusFromSmall_);
       SVD_t svd (reducedJacobian_, Eigen::ComputeFullV);
       size_type p = svd.nonzeroSingularValues ();
@@ -641,6 +1402,7 @@ namespace hpp {
 					   ConfigurationIn_t to,
 					   ConfigurationOut_t result)
     {
+      checkWorkspaces ();
       if (functions_.empty ()) {
         result = to;
         return;
@@ -652,11 +1414,12 @@ namespace hpp {
 
     void ConfigProjector::computeLockedDofs (ConfigurationOut_t configuration)
     {
-      /// LockedDofs are always sorted by their rankInConfiguration.
-      for (LockedJoints_t::iterator itLock = lockedJoints_.begin ();
-          itLock != lockedJoints_.end (); ++itLock) {
-        configuration.segment ((*itLock)->rankInConfiguration (),
-            (*itLock)->size ()) = (*itLock)->value ();
+      size_type row = 0;
+      for (SizeIntervals_t::const_iterator it = lockedConfIntervals_.begin ();
+	   it != lockedConfIntervals_.end (); ++it) {
+	configuration.segment (it->first, it->second) =
+	  lockedValues_.segment (row, it->second);
+	row += it->second;
       }
     }
 
@@ -667,6 +1430,8 @@ namespace hpp {
 	   itLock != lockedJoints_.end (); ++itLock) {
 	if (lockedJoint->rankInVelocity () == (*itLock)->rankInVelocity ()) {
 	  *itLock = lockedJoint;
+	  updateLockedValues ();
+	  modified ();
 	  return;
 	}
       }
@@ -674,15 +1439,7 @@ namespace hpp {
       hppDout (info, "add locked joint " << lockedJoint->jointName_
 	       << " rank in velocity: " << lockedJoint->rankInVelocity ()
 	       << ", size: " << lockedJoint->numberDof ());
-      computeIntervals ();
-      hppDout (info, "Intervals: ");
-      for (SizeIntervals_t::const_iterator it = intervals_.begin ();
-	   it != intervals_.end (); ++it) {
-	hppDout (info, "[" << it->first << "," << it->first + it->second - 1
-		 << "]");
-      }
-      resize ();
-      updateExplicitComputation ();
+      update (true);
       if (!lockedJoint->comparisonType ()->constantRightHandSide ())
         rhsReducedSize_ += lockedJoint->rhsSize ();
     }
@@ -730,64 +1487,128 @@ namespace hpp {
 
     bool ConfigProjector::isSatisfiedNoLockedJoint (ConfigurationIn_t config)
     {
-      size_type row = 0, nbRows = 0;
-      for (NumericalConstraints_t::iterator it = functions_.begin ();
-	   it != functions_.end (); ++it) {
-	DifferentiableFunction& f = (*it)->function ();
-	vector_t& value = (*it)->value ();
-	f (value, config);
-        (*(*it)->comparisonType ()) (value, (*it)->jacobian ());
-	nbRows = f.outputSize ();
-	value_.segment (row, nbRows) = value;
-	row += nbRows;
-      }
+      // Values only, in the order of value_
+      computeValue (config, value_);
       computeError ();
       return squareNorm_ < squareErrorThreshold_;
     }
 
     bool ConfigProjector::isSatisfied (ConfigurationIn_t config)
     {
-      if (!isSatisfiedNoLockedJoint (config)) return false;
-      for (LockedJoints_t::iterator it = lockedJoints_.begin ();
-	   it != lockedJoints_.end (); ++it )
-	if (!(*it)->isSatisfied (config)) {
-	  hppDout (info, "locked joint not satisfied.");
-	  return false;
-	}
+      checkWorkspaces ();
+      bool satisfied = isSatisfiedNoLockedJoint (config);
+      valueCached_ = false;
+      if (!satisfied) return false;
+      size_type row = 0;
+      for (SizeIntervals_t::const_iterator it = lockedConfIntervals_.begin ();
+	   it != lockedConfIntervals_.end (); ++it) {
+	lockedBuffer_.segment (row, it->second) =
+	  config.segment (it->first, it->second);
+	row += it->second;
+      }
+      if (!lockedBuffer_.isApprox (lockedValues_)) {
+	hppDout (info, "locked joint not satisfied.");
+	return false;
+      }
       return true;
     }
 
     bool ConfigProjector::isSatisfied (ConfigurationIn_t config,
 				       vector_t& error)
     {
-      size_type row = 0, nbRows = 0;
+      checkWorkspaces ();
       bool result = true;
-      for (NumericalConstraints_t::iterator it = functions_.begin ();
-	   it != functions_.end (); ++it) {
-	DifferentiableFunction& f = (*it)->function ();
-	vector_t& value = (*it)->value ();
-	f (value, config);
-        (*(*it)->comparisonType ()) (value, (*it)->jacobian ());
-	nbRows = f.outputSize ();
-	value_.segment (row, nbRows) = value;
-	row += nbRows;
-      }
+      computeValue (config, value_);
+      valueCached_ = false;
       error = value_ - rightHandSide_;
       computeError ();
-      for (LockedJoints_t::iterator it = lockedJoints_.begin ();
-	   it != lockedJoints_.end (); ++it ) {
-	vector_t localError;
-	if (!(*it)->isSatisfied (config, localError)) {
-	  result = false;
-	}
-	error.conservativeResize (error.size () + localError.size ());
-	error.tail (localError.size ()) = localError;
+      size_type row = 0;
+      for (SizeIntervals_t::const_iterator it = lockedConfIntervals_.begin ();
+	   it != lockedConfIntervals_.end (); ++it) {
+	lockedBuffer_.segment (row, it->second) =
+	  config.segment (it->first, it->second);
+	row += it->second;
       }
+      if (!lockedBuffer_.isApprox (lockedValues_)) result = false;
+      error.conservativeResize (error.size () + lockedValues_.size ());
+      error.tail (lockedValues_.size ()) = lockedBuffer_ - lockedValues_;
       return result && squareNorm_ < squareErrorThreshold_;
     }
 
+    namespace {
+      // Estimate of the storage of Eigen::JacobiSVD
+      template <typename SVD> std::size_t svdBytes (const SVD& svd)
+      {
+	const std::size_t rows = svd.rows (), cols = svd.cols ();
+	const std::size_t diagonal = std::min (rows, cols);
+	// Preconditioned matrix, work matrix and singular values
+	std::size_t result = rows * cols + diagonal * diagonal + diagonal;
+	if (svd.computeU ()) result += rows * rows;
+	if (svd.computeV ()) result += cols * cols;
+	return result * sizeof (value_type);
+      }
+
+      template <typename Decompositions>
+      std::size_t decompositionsBytes (const Decompositions& d)
+      {
+	return (std::size_t) (d.llt_.rows () * d.llt_.cols () +
+			      d.qr_.rows () * d.qr_.cols () + d.qr_.cols ()) *
+	  sizeof (value_type) + memory::bytes (d.JJt_) + memory::bytes (d.y_);
+      }
+
+      std::size_t intervalsBytes (const IntervalsContainer_t& intervals)
+      {
+	std::size_t result = memory::bytes (intervals);
+	for (IntervalsContainer_t::const_iterator it = intervals.begin ();
+	     it != intervals.end (); ++it) {
+	  result += memory::bytes (*it);
+	}
+	return result;
+      }
+    } // namespace
+
+    std::size_t ConfigProjector::memoryUsage () const
+    {
+      std::size_t result = sizeof (ConfigProjector) + memory::bytes (name ()) +
+	memory::bytes (stack_);
+      for (std::vector <PriorityStack>::const_iterator it = stack_.begin ();
+	   it != stack_.end (); ++it) {
+	result += memory::bytes (it->functions_) +
+	  intervalsBytes (it->passiveDofs_) + svdBytes (it->svd_) +
+	  decompositionsBytes (it->decompositions_) + memory::bytes (it->PK_) +
+	  memory::bytes (it->JP_) + memory::bytes (it->residual_) +
+	  memory::bytes (it->dqLevel_) + memory::bytes (it->blocks_) +
+	  memory::bytes (it->inequalities_) + memory::bytes (it->activeRows_) +
+	  memory::bytes (it->activeJacobian_) +
+	  memory::bytes (it->activeError_);
+	for (std::vector <PriorityStack::Blocks_t>::const_iterator itBlocks =
+	       it->blocks_.begin (); itBlocks != it->blocks_.end ();
+	     ++itBlocks) {
+	  result += memory::bytes (*itBlocks);
+	}
+      }
+      result += memory::bytes (functions_) +
+	memory::bytes (explicitFunctions_) + memory::bytes (explicitOrder_) +
+	intervalsBytes (passiveDofs_) + memory::bytes (lockedJoints_) +
+	memory::bytes (lockedConfIntervals_) + memory::bytes (lockedValues_) +
+	memory::bytes (lockedBuffer_) + memory::bytes (intervals_) +
+	memory::bytes (rightHandSide_) + memory::bytes (value_) +
+	memory::bytes (reducedJacobian_) + svdBytes (svd_) +
+	decompositionsBytes (decompositions_) + memory::bytes (qTrial_) +
+	memory::bytes (valueTrial_) + memory::bytes (warmStartInput_) +
+	memory::bytes (warmStartCorrection_) +
+	memory::bytes (valueConfiguration_) +
+	memory::bytes (reducedProjector_) + memory::bytes (toMinusFrom_) +
+	memory::bytes (toMinusFromSmall_) + memory::bytes (projMinusFrom_) +
+	memory::bytes (projMinusFromSmall_) + memory::bytes (dq_) +
+	memory::bytes (dqSmall_) + memory::bytes (error_) +
+	memory::bytes (projector_);
+      return result;
+    }
+
     vector_t ConfigProjector::rightHandSideFromConfig (ConfigurationIn_t config)
     {
+      hasWarmStart_ = false;
       size_type row = 0, nbRows = 0;
       for (std::vector <PriorityStack>::iterator itPs = stack_.begin ();
           itPs != stack_.end (); ++itPs) { 
@@ -805,11 +1626,13 @@ namespace hpp {
       for (LockedJoints_t::iterator it = lockedJoints_.begin ();
           it != lockedJoints_.end (); ++it )
         (*it)->rightHandSideFromConfig (config);
+      updateLockedValues ();
       return rightHandSide();
     }
 
     void ConfigProjector::rightHandSide (const vector_t& small)
     {
+      hasWarmStart_ = false;
       size_type row = 0, nbRows = 0, sRow = 0;
       for (std::vector <PriorityStack>::iterator itPs = stack_.begin ();
           itPs != stack_.end (); ++itPs) { 
@@ -833,10 +1656,12 @@ namespace hpp {
         }
       }
       assert (sRow == small.size ());
+      updateLockedValues ();
     }
 
     void ConfigProjector::updateRightHandSide ()
     {
+      hasWarmStart_ = false;
       size_type row = 0, nbRows = 0, sRow = 0;
       for (std::vector <PriorityStack>::iterator itPs = stack_.begin ();
           itPs != stack_.end (); ++itPs) { 
@@ -850,6 +1675,7 @@ namespace hpp {
         }
       }
       assert (row == rightHandSide_.size ());
+      updateLockedValues ();
     }
 
     vector_t ConfigProjector::rightHandSide () const
@@ -880,15 +1706,39 @@ namespace hpp {
     }
 
     void ConfigProjector::computeError ()
+    {
+      squareNorm_ = squaredError (value_);
+    }
+
+    value_type ConfigProjector::squaredError (vectorIn_t value) const
     {
       if (lastIsOptional_) {
-        std::size_t rows = value_.size() - stack_.back ().outputSize_;
-        squareNorm_ = (
-            value_.segment (0, rows) - rightHandSide_.segment (0, rows)
-            ).squaredNorm ();
-      } else {
-        squareNorm_ = (value_ - rightHandSide_).squaredNorm ();
+        std::size_t rows = value.size() - stack_.back ().outputSize_;
+        return (value.segment (0, rows) - rightHandSide_.segment (0, rows)
+		).squaredNorm ();
+      }
+      return (value - rightHandSide_).squaredNorm ();
+    }
+
+    void ConfigProjector::computeValue (ConfigurationIn_t configuration,
+					vectorOut_t value)
+    {
+      size_type row = 0;
+      for (std::vector <PriorityStack>::iterator itPs = stack_.begin ();
+          itPs != stack_.end (); ++itPs) {
+        for (NumericalConstraints_t::iterator it = itPs->functions_.begin ();
+             it != itPs->functions_.end (); ++it) {
+          DifferentiableFunction& f = (*it)->function ();
+          vector_t& v = (*it)->value ();
+          f (v, configuration);
+          // Same layout as in PriorityStack::computeValueAndJacobian
+          value.segment (row, f.outputSize ()) = v;
+          (*(*it)->comparisonType ()) (value.segment (row, f.outputSize ()));
+          row += f.outputDerivativeSize ();
+        }
       }
+      valueConfiguration_ = configuration;
+      valueCached_ = true;
     }
   } // namespace core
 } // namespace hpp
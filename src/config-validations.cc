@@ -17,7 +17,11 @@
 // <http://www.gnu.org/licenses/>.
 
 
+#include <algorithm>
+#include <utility>
 #include <hpp/core/config-validations.hh>
+#include <hpp/core/operation-counters.hh>
+#include <hpp/core/query-record.hh>
 #include <hpp/core/validation-report.hh>
 
 namespace hpp {
@@ -31,46 +35,151 @@ namespace hpp {
     bool ConfigValidations::validate (const Configuration_t& config,
 				      bool throwIfInValid)
     {
-      for (std::vector <ConfigValidationPtr_t>::iterator
-	     it = validations_.begin (); it != validations_.end (); ++it) {
-	if ((*it)->validate (config, throwIfInValid)
-	    == false) {
-	  return false;
+      OperationCounters::increment (OperationCounters::CONFIG_VALIDATION);
+      RecordedEvent event (QueryRecord::CONFIG_VALIDATION);
+      for (std::size_t rank = 0; rank < validations_.size (); ++rank) {
+	++testCounts_ [rank];
+	if (!validations_ [rank]->validate (config, throwIfInValid)) {
+	  rejected (rank);
+	  return event.done (false);
 	}
       }
-      return true;
+      validated ();
+      return event.done (true);
     }
 
     bool ConfigValidations::validate (const Configuration_t& config,
 				      ValidationReport& validationReport,
 				      bool throwIfInValid)
     {
-      for (std::vector <ConfigValidationPtr_t>::iterator
-	     it = validations_.begin (); it != validations_.end (); ++it) {
-	if ((*it)->validate (config, validationReport, throwIfInValid)
-	    == false) {
-	  return false;
+      OperationCounters::increment (OperationCounters::CONFIG_VALIDATION);
+      RecordedEvent event (QueryRecord::CONFIG_VALIDATION);
+      for (std::size_t rank = 0; rank < validations_.size (); ++rank) {
+	++testCounts_ [rank];
+	if (!validations_ [rank]->validate (config, validationReport,
+					    throwIfInValid)) {
+	  rejected (rank);
+	  return event.done (false);
 	}
       }
-      return true;
+      validated ();
+      return event.done (true);
     }
 
     bool ConfigValidations::validate (const Configuration_t& config,
 				      ValidationReportPtr_t& validationReport)
     {
-      for (std::vector <ConfigValidationPtr_t>::iterator
-	     it = validations_.begin (); it != validations_.end (); ++it) {
-	if ((*it)->validate (config, validationReport)
-	    == false) {
-	  return false;
+      OperationCounters::increment (OperationCounters::CONFIG_VALIDATION);
+      RecordedEvent event (QueryRecord::CONFIG_VALIDATION);
+      for (std::size_t rank = 0; rank < validations_.size (); ++rank) {
+	++testCounts_ [rank];
+	if (!validations_ [rank]->validate (config, validationReport)) {
+	  rejected (rank);
+	  return event.done (false);
 	}
       }
-      return true;
+      validated ();
+      return event.done (true);
+    }
+
+    bool ConfigValidations::isValid (const Configuration_t& config)
+    {
+      OperationCounters::increment (OperationCounters::CONFIG_VALIDATION);
+      RecordedEvent event (QueryRecord::CONFIG_VALIDATION);
+      for (std::size_t rank = 0; rank < validations_.size (); ++rank) {
+	++testCounts_ [rank];
+	if (!validations_ [rank]->isValid (config)) {
+	  rejected (rank);
+	  return event.done (false);
+	}
+      }
+      validated ();
+      return event.done (true);
+    }
+
+    bool ConfigValidations::validateBatch (const matrix_t& configurations,
+					   std::vector <bool>& valid,
+					   bool stopAtFirst)
+    {
+      OperationCounters::increment (OperationCounters::CONFIG_VALIDATION,
+				    configurations.cols ());
+      valid.assign (configurations.cols (), true);
+      std::vector <bool> validOne;
+      for (std::size_t rank = 0; rank < validations_.size (); ++rank) {
+	testCounts_ [rank] += configurations.cols ();
+	if (!validations_ [rank]->validateBatch (configurations, validOne,
+						 stopAtFirst)) {
+	  // Only the first invalid configuration is tested if stopAtFirst
+	  hitCounts_ [rank] += stopAtFirst ? 1 :
+	    std::count (validOne.begin (), validOne.end (), false);
+	}
+	for (std::size_t i = 0; i < valid.size (); ++i) {
+	  valid [i] = valid [i] && validOne [i];
+	}
+      }
+      std::vector <bool>::iterator firstInvalid =
+	std::find (valid.begin (), valid.end (), false);
+      if (stopAtFirst) std::fill (firstInvalid, valid.end (), false);
+      if (costOrdering_) sortByExpectedCost ();
+      return firstInvalid == valid.end ();
     }
 
     void ConfigValidations::add (const ConfigValidationPtr_t& configValidation)
     {
       validations_.push_back (configValidation);
+      hitCounts_.push_back (0);
+      testCounts_.push_back (0);
+    }
+
+    void ConfigValidations::rejected (std::size_t rank)
+    {
+      ++hitCounts_ [rank];
+      if (adaptiveOrdering_ && !costOrdering_ && rank != 0) {
+	std::rotate (validations_.begin (), validations_.begin () + rank,
+		     validations_.begin () + rank + 1);
+	std::rotate (hitCounts_.begin (), hitCounts_.begin () + rank,
+		     hitCounts_.begin () + rank + 1);
+	std::rotate (testCounts_.begin (), testCounts_.begin () + rank,
+		     testCounts_.begin () + rank + 1);
+      }
+      validated ();
+    }
+
+    void ConfigValidations::validated ()
+    {
+      if (!costOrdering_) return;
+      if (++sinceSort_ < 100) return;
+      sortByExpectedCost ();
+    }
+
+    void ConfigValidations::sortByExpectedCost ()
+    {
+      sinceSort_ = 0;
+      // Validation i is tested before validation j if
+      // cost_i / p_i < cost_j / p_j where p is the rejection rate, estimated
+      // with Laplace's rule so that validations that never rejected are
+      // still ordered by cost.
+      std::vector <std::pair <value_type, std::size_t> > keys;
+      keys.reserve (validations_.size ());
+      for (std::size_t i = 0; i < validations_.size (); ++i) {
+	value_type rate = (value_type) (hitCounts_ [i] + 1) /
+	  (value_type) (testCounts_ [i] + 2);
+	keys.push_back (std::make_pair (validations_ [i]->cost () / rate, i));
+      }
+      std::stable_sort (keys.begin (), keys.end ());
+      std::vector <ConfigValidationPtr_t> validations;
+      std::vector <std::size_t> hitCounts, testCounts;
+      validations.reserve (keys.size ());
+      hitCounts.reserve (keys.size ());
+      testCounts.reserve (keys.size ());
+      for (std::size_t i = 0; i < keys.size (); ++i) {
+	validations.push_back (validations_ [keys [i].second]);
+	hitCounts.push_back (hitCounts_ [keys [i].second]);
+	testCounts.push_back (testCounts_ [keys [i].second]);
+      }
+      validations_.swap (validations);
+      hitCounts_.swap (hitCounts);
+      testCounts_.swap (testCounts);
     }
 
     void ConfigValidations::addObstacle (const CollisionObjectPtr_t& object)
@@ -90,7 +199,58 @@ namespace hpp {
       }
     }
 
-    ConfigValidations::ConfigValidations () : validations_ ()
+    void ConfigValidations::removeObstacle (const CollisionObjectPtr_t& object)
+    {
+      for (std::vector <ConfigValidationPtr_t>::iterator itVal =
+	     validations_.begin (); itVal != validations_.end (); ++itVal) {
+	(*itVal)->removeObstacle (object);
+      }
+    }
+
+    void ConfigValidations::obstacleMoved (const CollisionObjectPtr_t& object)
+    {
+      for (std::vector <ConfigValidationPtr_t>::iterator itVal =
+	     validations_.begin (); itVal != validations_.end (); ++itVal) {
+	(*itVal)->obstacleMoved (object);
+      }
+    }
+
+    void ConfigValidations::distanceField (const DistanceFieldPtr_t& field)
+    {
+      for (std::vector <ConfigValidationPtr_t>::iterator itVal =
+	     validations_.begin (); itVal != validations_.end (); ++itVal) {
+	(*itVal)->distanceField (field);
+      }
+    }
+
+    ConfigValidationPtr_t ConfigValidations::copy
+    (const DevicePtr_t& robot) const
+    {
+      ConfigValidationsPtr_t other (create ());
+      other->adaptiveOrdering_ = adaptiveOrdering_;
+      other->costOrdering_ = costOrdering_;
+      for (std::vector <ConfigValidationPtr_t>::const_iterator itVal =
+	     validations_.begin (); itVal != validations_.end (); ++itVal) {
+	ConfigValidationPtr_t validation ((*itVal)->copy (robot));
+	if (!validation) return ConfigValidationPtr_t ();
+	other->add (validation);
+      }
+      return other;
+    }
+
+    value_type ConfigValidations::cost () const
+    {
+      value_type result = 0;
+      for (std::vector <ConfigValidationPtr_t>::const_iterator itVal =
+	     validations_.begin (); itVal != validations_.end (); ++itVal) {
+	result += (*itVal)->cost ();
+      }
+      return result;
+    }
+
+    ConfigValidations::ConfigValidations () : validations_ (), hitCounts_ (),
+      testCounts_ (), adaptiveOrdering_ (false), costOrdering_ (true),
+      sinceSort_ (0)
     {
     }
 
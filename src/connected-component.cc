@@ -17,152 +17,171 @@
 // <http://www.gnu.org/licenses/>.
 
 #include <algorithm>
+#include <deque>
 #include <hpp/core/connected-component.hh>
 #include <hpp/core/edge.hh>
 
 namespace hpp {
   namespace core {
-    // Mark connected components of a list as unexplored.
-    void clean (ConnectedComponents_t& set)
-    {
-      for (ConnectedComponents_t::iterator it = set.begin ();
-	   it != set.end (); ++it) {
-	(*it)->explored_ = false;
-      }
-    }
-
     void ConnectedComponent::merge (const ConnectedComponentPtr_t& other)
     {
-      // Tell other's nodes that they now belong to this connected component
-      for (Nodes_t::iterator itNode = other->nodes_.begin ();
-	   itNode != other->nodes_.end (); ++itNode) {
-	(*itNode)->connectedComponent (weak_.lock ());
-      }
-      // Add other's nodes to this list.
+      ConnectedComponentPtr_t thisCC = weak_.lock ();
+      // Add other's nodes to this list. Nodes get the new connected component
+      // through representative ().
       nodes_.splice (nodes_.end (), other->nodes_);
 
       // Tell other's reachableTo's that other has been replaced by this
       for (ConnectedComponents_t::iterator itcc = other->reachableTo_.begin ();
 	   itcc != other->reachableTo_.end (); ++itcc) {
 	(*itcc)->reachableFrom_.erase (other);
-	(*itcc)->reachableFrom_.insert (weak_.lock ());
+	if (*itcc == thisCC) continue;
+	(*itcc)->reachableFrom_.insert (thisCC);
+	reachableTo_.insert (*itcc);
       }
 
       // Tell other's reachableFrom's that other has been replaced by this
       for (ConnectedComponents_t::iterator itcc=other->reachableFrom_.begin ();
 	   itcc != other->reachableFrom_.end (); ++itcc) {
 	(*itcc)->reachableTo_.erase (other);
-	(*itcc)->reachableTo_.insert (weak_.lock ());
+	if (*itcc == thisCC) continue;
+	(*itcc)->reachableTo_.insert (thisCC);
+	reachableFrom_.insert (*itcc);
       }
-      
-      ConnectedComponents_t tmp;
-      std::set_union (reachableTo_.begin (), reachableTo_.end (),
-		      other->reachableTo_.begin (), other->reachableTo_.end (),
-		      std::inserter (tmp, tmp.begin ()));
-      reachableTo_ = tmp; tmp.clear ();
       reachableTo_.erase (other);
-      reachableTo_.erase (weak_.lock ());
-      std::set_union (reachableFrom_.begin (), reachableFrom_.end (),
-		      other->reachableFrom_.begin (),
-		      other->reachableFrom_.end (),
-		      std::inserter (tmp, tmp.begin ()));
-      reachableFrom_ = tmp; tmp.clear ();
       reachableFrom_.erase (other);
-      reachableFrom_.erase (weak_.lock ());
+      other->reachableTo_.clear ();
+      other->reachableFrom_.clear ();
+      other->mergedInto_ = thisCC;
+      link (other);
+    }
+
+    ConnectedComponentPtr_t ConnectedComponent::representative ()
+    {
+      ConnectedComponentPtr_t root = weak_.lock ();
+      while (root->mergedInto_) root = root->mergedInto_;
+      // Path compression
+      ConnectedComponentPtr_t cc = weak_.lock ();
+      while (cc->mergedInto_ && cc->mergedInto_ != root) {
+	ConnectedComponentPtr_t next = cc->mergedInto_;
+	cc->mergedInto_ = root;
+	cc = next;
+      }
+      return root;
+    }
+
+    ConnectedComponentPtr_t ConnectedComponent::linkRoot ()
+    {
+      ConnectedComponentPtr_t root = weak_.lock ();
+      while (root->linkedTo_) root = root->linkedTo_;
+      // Path compression
+      ConnectedComponentPtr_t cc = weak_.lock ();
+      while (cc->linkedTo_ && cc->linkedTo_ != root) {
+	ConnectedComponentPtr_t next = cc->linkedTo_;
+	cc->linkedTo_ = root;
+	cc = next;
+      }
+      return root;
+    }
+
+    void ConnectedComponent::link (const ConnectedComponentPtr_t& cc)
+    {
+      ConnectedComponentPtr_t root1 = linkRoot ();
+      ConnectedComponentPtr_t root2 = cc->linkRoot ();
+      if (root1 != root2) {
+	root2->linkedTo_ = root1;
+	// Marks of the components of both sets must differ from new marks.
+	root1->lastMark_ = std::max (root1->lastMark_, root2->lastMark_);
+      }
+    }
+
+    unsigned int ConnectedComponent::newMark ()
+    {
+      return ++linkRoot ()->lastMark_;
+    }
+
+    bool ConnectedComponent::isLinkedTo (const ConnectedComponentPtr_t& cc)
+    {
+      return linkRoot () == cc->linkRoot ();
     }
 
     bool ConnectedComponent::canReach (const ConnectedComponentPtr_t& cc)
     {
-      // Store visited connected components for further cleaning.
-      ConnectedComponents_t explored;
+      if (!isLinkedTo (cc)) return false;
+      // Visited connected components are marked with a new value.
+      unsigned int mark = newMark ();
       std::deque <ConnectedComponentWkPtr_t> queue;
       queue.push_back (weak_);
-      explored_ = true;
-      explored.insert (weak_.lock ());
+      forwardMark_ = mark;
       while (!queue.empty ()) {
 	ConnectedComponentPtr_t current = queue.front ().lock ();
 	queue.pop_front ();
 	if (current == cc) {
-	  clean (explored);
 	  return true;
 	}
 	for (ConnectedComponents_t::iterator itChild =
 	       current->reachableTo_.begin ();
 	     itChild != current->reachableTo_.end (); ++itChild) {
 	  ConnectedComponentPtr_t child = *itChild;
-	  if (!child->explored_) {
-	    child->explored_ = true;
-	    explored.insert (child);
+	  if (child->forwardMark_ != mark) {
+	    child->forwardMark_ = mark;
 	    queue.push_back (child);
 	  }
 	}
       }
-      clean (explored);
       return false;
     }
 
     bool ConnectedComponent::canReach
     (const ConnectedComponentPtr_t& cc, ConnectedComponents_t& ccToThis)
     {
+      if (!isLinkedTo (cc)) return false;
       bool reachable = false;
       ConnectedComponentPtr_t thisCC = weak_.lock ();
-      // Store visited connected components
-      ConnectedComponents_t exploredForward;
+      unsigned int forwardMark = newMark ();
       std::deque <ConnectedComponentWkPtr_t> queue;
       queue.push_back (weak_);
-      explored_ = true;
-      exploredForward.insert (thisCC);
+      forwardMark_ = forwardMark;
       while (!queue.empty ()) {
 	ConnectedComponentPtr_t current = queue.front ().lock ();
 	queue.pop_front ();
 	if (current == cc) {
 	  reachable = true;
-	  exploredForward.insert (current);
 	} else {
 	  for (ConnectedComponents_t::iterator itChild =
 		 current->reachableTo_.begin ();
 	       itChild != current->reachableTo_.end (); ++itChild) {
 	    ConnectedComponentPtr_t child = *itChild;
-	    if (!child->explored_) {
-	      child->explored_ = true;
-	      exploredForward.insert (child);
+	    if (child->forwardMark_ != forwardMark) {
+	      child->forwardMark_ = forwardMark;
 	      queue.push_back (child);
 	    }
 	  }
 	}
       }
-      // Set visited connected components to unexplored
-      clean (exploredForward);
       if (!reachable) return false;
 
-      // Store visited connected components
-      ConnectedComponents_t exploredBackward;
+      // Connected components visited by both searches are between this and
+      // cc.
+      unsigned int backwardMark = newMark ();
       queue.push_back (cc);
-      cc->explored_ = true;
-      exploredBackward.insert (cc);
+      cc->backwardMark_ = backwardMark;
+      ccToThis.insert (cc);
       while (!queue.empty ()) {
 	ConnectedComponentPtr_t current = queue.front ().lock ();
 	queue.pop_front ();
-	if (current == thisCC) {
-	  exploredBackward.insert (current);
-	} else {
+	if (current != thisCC) {
 	  for (ConnectedComponents_t::iterator itChild =
 		 current->reachableFrom_.begin ();
 	       itChild != current->reachableFrom_.end (); ++itChild) {
 	    ConnectedComponentPtr_t child = *itChild;
-	    if (!child->explored_) {
-	      child->explored_ = true;
-	      exploredBackward.insert (child);
+	    if (child->backwardMark_ != backwardMark) {
+	      child->backwardMark_ = backwardMark;
+	      if (child->forwardMark_ == forwardMark) ccToThis.insert (child);
 	      queue.push_back (child);
 	    }
 	  }
 	}
       }
-      // Set visited connected components to unexplored
-      clean (exploredBackward);
-      std::set_intersection (exploredForward.begin (), exploredForward.end (),
-			     exploredBackward.begin (), exploredBackward.end (),
-			     std::inserter (ccToThis, ccToThis.begin ()));
       return true;
     }
 
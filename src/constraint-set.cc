@@ -20,6 +20,7 @@
 #include <hpp/model/configuration.hh>
 #include <hpp/core/constraint-set.hh>
 #include <hpp/core/config-projector.hh>
+#include "memory-usage.hh"
 
 namespace hpp {
   namespace core {
@@ -154,6 +155,17 @@ namespace hpp {
       return result;
     }
 
+    std::size_t ConstraintSet::memoryUsage () const
+    {
+      std::size_t result = sizeof (ConstraintSet) + memory::bytes (name ()) +
+	memory::bytes (constraints_);
+      for (Constraints_t::const_iterator it = constraints_.begin ();
+	   it != constraints_.end (); ++it) {
+	result += (*it)->memoryUsage ();
+      }
+      return result;
+    }
+
     size_type ConstraintSet::numberNonLockedDof () const
     {
       return HPP_STATIC_PTR_CAST (ConfigProjector, *trivialOrNotConfigProjectorIt_)
@@ -16,19 +16,37 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <boost/atomic.hpp>
 #include <hpp/core/constraint-set.hh>
+#include "memory-usage.hh"
 
 namespace hpp {
   namespace core {
+    namespace {
+      // Last revision drawn, constraints may be created by several threads.
+      boost::atomic <std::size_t> lastRevision (0);
+    } // namespace
+
     bool Constraint::apply (ConfigurationOut_t configuration)
     {
       return impl_compute (configuration);
     }
 
+    std::size_t Constraint::memoryUsage () const
+    {
+      return sizeof (Constraint) + memory::bytes (name_);
+    }
+
+    void Constraint::modified ()
+    {
+      revision_ = ++lastRevision;
+    }
+
     void
     Constraint::addToConstraintSet (const ConstraintSetPtr_t& constraintSet)
     {
       constraintSet->constraints_.push_back (weak_.lock ());
+      constraintSet->modified ();
     }
   } // namespace core
 } // namespace core
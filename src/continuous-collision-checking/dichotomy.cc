@@ -16,14 +16,20 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <deque>
+#include <functional>
+#include <queue>
+#include <vector>
 #include <hpp/util/debug.hh>
 #include <hpp/core/continuous-collision-checking/dichotomy.hh>
 #include <hpp/core/collision-path-validation-report.hh>
 #include <hpp/core/straight-path.hh>
 #include <hpp/core/path-vector.hh>
+#include <hpp/core/trace.hh>
 
 #include "continuous-collision-checking/dichotomy/body-pair-collision.hh"
+#include "continuous-collision-checking/segment-validation.hh"
 
 namespace hpp {
   namespace core {
@@ -33,40 +39,15 @@ namespace hpp {
       using dichotomy::BodyPairCollisionPtr_t;
       using dichotomy::BodyPairCollisions_t;
 
-      bool compareBodyPairCol (const BodyPairCollisionPtr_t& bodyPair1,
-			       const BodyPairCollisionPtr_t& bodyPair2)
-      {
-	assert (!bodyPair1->validSubset ().list ().empty ());
-	assert (!bodyPair2->validSubset ().list ().empty ());
-	return bodyPair1->validSubset ().list ().begin ()->second <
-	  bodyPair2->validSubset ().list ().begin ()->second;
-      }
+      namespace {
+	// Priority of a body pair and rank of the pair
+	typedef std::pair <value_type, std::size_t> QueueElement_t;
+	// Pairs closer to collision come first
+	typedef std::priority_queue <QueueElement_t,
+				     std::vector <QueueElement_t>,
+				     std::greater <QueueElement_t> > Queue_t;
+      } // namespace
 
-      bool compareReverseBodyPairCol (const BodyPairCollisionPtr_t& bodyPair1,
-				      const BodyPairCollisionPtr_t& bodyPair2)
-      {
-	assert (!bodyPair1->validSubset ().list ().empty ());
-	assert (!bodyPair2->validSubset ().list ().empty ());
-	return bodyPair1->validSubset ().list ().rbegin ()->first >
-	  bodyPair2->validSubset ().list ().rbegin ()->first;
-      }
-
-      // Partially sort a list where only the first element is not sorted
-      template <typename Compare>
-      void partialSort (BodyPairCollisions_t& list, Compare comp)
-      {
-	BodyPairCollisions_t::iterator it1 = list.begin ();
-	if (it1 == list.end ()) return;
-	BodyPairCollisions_t::iterator it2 = it1; ++it2;
-	while (it2 != list.end ()) {
-	  if (comp (*it2, *it1))
-	    std::iter_swap (it1, it2);
-	  else
-	    return;
-	  it1 = it2;
-	  ++it2;
-	}
-      }
       DichotomyPtr_t
       Dichotomy::create (const DevicePtr_t& robot, const value_type& tolerance)
       {
@@ -76,6 +57,13 @@ namespace hpp {
 	return shPtr;
       }
 
+      PathValidationPtr_t Dichotomy::copy (const DevicePtr_t& robot) const
+      {
+	DichotomyPtr_t other = create (robot, tolerance_);
+	other->numberThreads_ = numberThreads_;
+	return other;
+      }
+
       bool Dichotomy::validate
       (const PathPtr_t& path, bool reverse, PathPtr_t& validPart)
       {
@@ -104,10 +92,10 @@ namespace hpp {
 	  if (reverse) {
 	    value_type param = path->length ();
 	    std::deque <PathPtr_t> paths;
-	    for (std::size_t i=pv->numberPaths () + 1; i != 0 ; --i) {
+	    for (std::size_t i=pv->numberPaths (); i != 0 ; --i) {
 	      PathPtr_t localPath (pv->pathAtRank (i-1));
 	      if (validate (localPath, reverse, localValidPart, report)) {
-		paths.push_front (localPath->copy ());
+		paths.push_front (localPath);
 		param -= localPath->length ();
 	      } else {
 		report.parameter += param - localPath->length ();
@@ -125,7 +113,7 @@ namespace hpp {
 	    for (std::size_t i=0; i < pv->numberPaths (); ++i) {
 	      PathPtr_t localPath (pv->pathAtRank (i));
 	      if (validate (localPath, reverse, localValidPart, report)) {
-		validPathVector->appendPath (localPath->copy ());
+		validPathVector->appendPath (localPath);
 		param += localPath->length ();
 	      } else {
 		report.parameter += param;
@@ -136,111 +124,21 @@ namespace hpp {
 	    return true;
 	  }
 	}
-	StraightPathPtr_t straightPath = HPP_DYNAMIC_PTR_CAST
-	  (StraightPath, path);
-	// for each BodyPairCollision
-	//   - set path,
-	//   - compute valid interval at start (end if reverse)
-	value_type t0 = path->timeRange ().first;
-	value_type t1 = path->timeRange ().second;
-	if (reverse) {
-	  for (BodyPairCollisions_t::iterator itPair =
-		 bodyPairCollisions_.begin ();
-	       itPair != bodyPairCollisions_.end (); ++itPair) {
-	    (*itPair)->path (straightPath);
-	    // If collision at end point, return false
-	    if (!(*itPair)->validateInterval (t1, collisionReport)) {
-	      report.parameter = t1;
-	      validPart = path->extract (interval_t (t1, t1));
-	      return false;
-	    }
-	    assert ((*itPair)->validSubset ().contains (t1));
-	  }
-	  // Sort collision pairs
-	  bodyPairCollisions_.sort (compareReverseBodyPairCol);
-
-	  BodyPairCollisionPtr_t first = *(bodyPairCollisions_.begin ());
-	  while (!first->validSubset ().contains (t0, true)) {
-	    // find middle of first non valid interval
-	    const std::list <interval_t>& intervals =
-	      first->validSubset ().list ();
-	    std::list <interval_t>::const_reverse_iterator lastInterval =
-	      intervals.rbegin ();
-	    std::list <interval_t>::const_reverse_iterator beforeLastInterval =
-	      lastInterval; ++beforeLastInterval;
-	    value_type upper = lastInterval->first;
-	    value_type lower;
-	    if (beforeLastInterval != intervals.rend ()) {
-	      lower = beforeLastInterval->second;
-	    } else {
-	      lower = t0;
-	    }
-	    value_type middle = .5 * (lower + upper);
-	    if (first->validateInterval (middle, collisionReport)) {
-	      partialSort (bodyPairCollisions_, compareReverseBodyPairCol);
-	    } else {
-	      report.parameter = middle;
-	      validPart = path->extract (interval_t (upper, t1));
-	      return false;
-	    }
-	    first = *(bodyPairCollisions_.begin ());
-	  }
-	} else {
-	  for (BodyPairCollisions_t::iterator itPair =
-		 bodyPairCollisions_.begin ();
-	       itPair != bodyPairCollisions_.end (); ++itPair) {
-	    (*itPair)->path (straightPath);
-	    // If collision at start point, return false
-	    bool valid = (*itPair)->validateInterval (t0, collisionReport);
-	    if (!valid) {
-          report.parameter = t0;
-	      validPart = path->extract (interval_t (t0, t0));
-	      hppDout (error, "Initial position in collision.");
-	      return false;
-	    }
-	    assert ((*itPair)->validSubset ().contains (t0));
-	  }
-	  // Sort collision pairs
-	  bodyPairCollisions_.sort (compareBodyPairCol);
-	  BodyPairCollisionPtr_t first = *(bodyPairCollisions_.begin ());
-	  while (!first->validSubset ().contains (t1)) {
-	    // find middle of first non valid interval
-	    const std::list <interval_t>& intervals =
-	      first->validSubset ().list ();
-	    std::list <interval_t>::const_iterator firstInterval =
-	      intervals.begin ();
-	    std::list <interval_t>::const_iterator secondInterval =
-	      firstInterval;
-	    ++secondInterval;
-	    value_type lower = firstInterval->second;
-	    value_type upper;
-	    if (secondInterval != intervals.end ()) {
-	      upper = secondInterval->first;
-	    } else {
-	      upper = t1;
-	    }
-	    value_type middle = .5 * (lower + upper);
-	    if (first->validateInterval (middle, collisionReport)) {
-	      partialSort (bodyPairCollisions_, compareBodyPairCol);
-	    } else {
-	      report.parameter = middle;
-	      validPart = path->extract (interval_t (t0, lower));
-	      return false;
-	    }
-	    first = *(bodyPairCollisions_.begin ());
-	  }
-	}
-	validPart = path;
-	return true;
+	return validateElementaryPath (path, reverse, validPart,
+				       report.parameter, collisionReport);
       }
 
       bool Dichotomy::validate (const PathPtr_t& path, bool reverse,
 				PathPtr_t& validPart,
 				PathValidationReportPtr_t& report)
       {
-	CollisionValidationReportPtr_t collisionReport
-	  (new CollisionValidationReport);
+	TraceScope trace ("Dichotomy::validate");
 	if (PathVectorPtr_t pv = HPP_DYNAMIC_PTR_CAST (PathVector, path)) {
+	  if (numberThreads_ > 1 && pv->numberPaths () > 1 &&
+	      parallelizable (pv)) {
+	    if (workers_.size () < numberThreads_) createWorkers ();
+	    return validateSegments (workers_, pv, reverse, validPart, report);
+	  }
 	  PathVectorPtr_t validPathVector = PathVector::create
 	    (path->outputSize (), path->outputDerivativeSize ());
 	  validPart = validPathVector;
@@ -248,10 +146,10 @@ namespace hpp {
 	  if (reverse) {
 	    value_type param = path->length ();
 	    std::deque <PathPtr_t> paths;
-	    for (std::size_t i=pv->numberPaths () + 1; i != 0 ; --i) {
+	    for (std::size_t i=pv->numberPaths (); i != 0 ; --i) {
 	      PathPtr_t localPath (pv->pathAtRank (i-1));
 	      if (validate (localPath, reverse, localValidPart, report)) {
-		paths.push_front (localPath->copy ());
+		paths.push_front (localPath);
 		param -= localPath->length ();
 	      } else {
 		report->parameter += param - localPath->length ();
@@ -269,7 +167,7 @@ namespace hpp {
 	    for (std::size_t i=0; i < pv->numberPaths (); ++i) {
 	      PathPtr_t localPath (pv->pathAtRank (i));
 	      if (validate (localPath, reverse, localValidPart, report)) {
-		validPathVector->appendPath (localPath->copy ());
+		validPathVector->appendPath (localPath);
 		param += localPath->length ();
 	      } else {
 		report->parameter += param;
@@ -280,131 +178,190 @@ namespace hpp {
 	    return true;
 	  }
 	}
-	StraightPathPtr_t straightPath = HPP_DYNAMIC_PTR_CAST
-	  (StraightPath, path);
+	value_type parameter;
+	if (!validateElementaryPath (path, reverse, validPart, parameter,
+				     collisionReport_)) {
+	  // Reuse the reports of the caller if nobody else refers to them
+	  CollisionValidationReportPtr_t collisionReport
+	    (CollisionPathValidationReport::reusableConfigurationReport
+	     (report));
+	  if (!collisionReport) {
+	    collisionReport = CollisionValidationReportPtr_t
+	      (new CollisionValidationReport);
+	  }
+	  *collisionReport = collisionReport_;
+	  CollisionPathValidationReportPtr_t pathReport
+	    (CollisionPathValidationReport::reuse (report));
+	  pathReport->parameter = parameter;
+	  pathReport->configurationReport = collisionReport;
+	  return false;
+	}
+	return true;
+      }
+
+      bool Dichotomy::validateElementaryPath
+      (const PathPtr_t& path, bool reverse, PathPtr_t& validPart,
+       value_type& parameter, CollisionValidationReport& report)
+      {
 	// for each BodyPairCollision
 	//   - set path,
 	//   - compute valid interval at start (end if reverse)
+	PathVelocityBounds bounds;
+	bounds.compute (path);
 	value_type t0 = path->timeRange ().first;
 	value_type t1 = path->timeRange ().second;
-	if (reverse) {
-	  for (BodyPairCollisions_t::iterator itPair =
-		 bodyPairCollisions_.begin ();
-	       itPair != bodyPairCollisions_.end (); ++itPair) {
-	    (*itPair)->path (straightPath);
-	    // If collision at end point, return false
-	    if (!(*itPair)->validateInterval (t1, *collisionReport)) {
-	      report = CollisionPathValidationReportPtr_t
-		(new CollisionPathValidationReport (t1, collisionReport));
-	      validPart = path->extract (interval_t (t1, t1));
-	      return false;
-	    }
-	    assert ((*itPair)->validSubset ().contains (t1));
+	value_type tStart = reverse ? t1 : t0;
+	interval_t range (t0, t1);
+	sample_->reset ();
+	std::vector <BodyPairCollision*> pairs;
+	pairs.reserve (bodyPairCollisions_.size ());
+	Queue_t queue;
+	for (BodyPairCollisions_t::iterator itPair =
+	       bodyPairCollisions_.begin ();
+	     itPair != bodyPairCollisions_.end (); ++itPair) {
+	  BodyPairCollision* pair = itPair->get ();
+	  pair->path (path, bounds, *sample_);
+	  // If collision at start point, return false
+	  if (!pair->validSubset ().contains (tStart) &&
+	      !pair->validateInterval (tStart, report)) {
+	    parameter = tStart;
+	    validPart = path->extract (interval_t (tStart, tStart));
+	    hppDout (info, "Initial position in collision.");
+	    return false;
 	  }
-	  // Sort collision pairs
-	  bodyPairCollisions_.sort (compareReverseBodyPairCol);
-
-	  BodyPairCollisionPtr_t first = *(bodyPairCollisions_.begin ());
-	  while (!first->validSubset ().contains (t0, true)) {
-	    // find middle of first non valid interval
-	    const std::list <interval_t>& intervals =
-	      first->validSubset ().list ();
-	    std::list <interval_t>::const_reverse_iterator lastInterval =
-	      intervals.rbegin ();
-	    std::list <interval_t>::const_reverse_iterator beforeLastInterval =
-	      lastInterval; ++beforeLastInterval;
-	    value_type upper = lastInterval->first;
-	    value_type lower;
-	    if (beforeLastInterval != intervals.rend ()) {
-	      lower = beforeLastInterval->second;
-	    } else {
-	      lower = t0;
-	    }
-	    value_type middle = .5 * (lower + upper);
-	    if (first->validateInterval (middle, *collisionReport)) {
-	      partialSort (bodyPairCollisions_, compareReverseBodyPairCol);
+	  assert (pair->validSubset ().contains (tStart));
+	  if (!pair->validSubset ().contains (range)) {
+	    queue.push (QueueElement_t (pair->distanceLowerBound (),
+					pairs.size ()));
+	  }
+	  pairs.push_back (pair);
+	}
+	// Validate the first gap (last if reverse) of the pair closest to
+	// collision until all pairs are valid on the whole interval.
+	while (!queue.empty ()) {
+	  std::size_t rank = queue.top ().second;
+	  queue.pop ();
+	  BodyPairCollision* pair = pairs [rank];
+	  const Intervals::Container_t& intervals =
+	    pair->validSubset ().list ();
+	  value_type lower, upper;
+	  if (reverse) {
+	    upper = intervals.back ().first;
+	    lower = intervals.size () > 1 ?
+	      intervals [intervals.size () - 2].second : t0;
+	  } else {
+	    lower = intervals.front ().second;
+	    upper = intervals.size () > 1 ? intervals [1].first : t1;
+	  }
+	  value_type middle = .5 * (lower + upper);
+	  if (!pair->validateInterval (middle, report)) {
+	    parameter = middle;
+	    // Part of the path valid for all pairs
+	    if (reverse) {
+	      value_type validStart = t0;
+	      for (std::size_t i = 0; i < pairs.size (); ++i) {
+		validStart = std::max (validStart, pairs [i]->validSubset ().
+				       list ().back ().first);
+	      }
+	      validPart = path->extract (interval_t (validStart, t1));
 	    } else {
-	      report = CollisionPathValidationReportPtr_t
-		(new CollisionPathValidationReport (middle, collisionReport));
-	      validPart = path->extract (interval_t (upper, t1));
-	      return false;
+	      value_type validEnd = t1;
+	      for (std::size_t i = 0; i < pairs.size (); ++i) {
+		validEnd = std::min (validEnd, pairs [i]->validSubset ().
+				     list ().front ().second);
+	      }
+	      validPart = path->extract (interval_t (t0, validEnd));
 	    }
-	    first = *(bodyPairCollisions_.begin ());
+	    return false;
+	  }
+	  if (!pair->validSubset ().contains (range)) {
+	    queue.push (QueueElement_t (pair->distanceLowerBound (), rank));
 	  }
-	} else {
-	  for (BodyPairCollisions_t::iterator itPair =
-		 bodyPairCollisions_.begin ();
-	       itPair != bodyPairCollisions_.end (); ++itPair) {
-	    (*itPair)->path (straightPath);
-	    // If collision at start point, return false
-	    bool valid = (*itPair)->validateInterval (t0, *collisionReport);
-	    if (!valid) {
-	      report = CollisionPathValidationReportPtr_t
-		(new CollisionPathValidationReport (t0, collisionReport));
-	      validPart = path->extract (interval_t (t0, t0));
-	      hppDout (error, "Initial position in collision.");
-	      return false;
+	}
+	validPart = path;
+	return true;
+      }
+
+      void Dichotomy::validateBatch (const Paths_t& paths, bool reverse,
+				     bool stopAtValid, Paths_t& validParts,
+				     std::vector <bool>& valid)
+      {
+	if (numberThreads_ > 1 && paths.size () > 1 &&
+	    parallelizable (paths)) {
+	  if (workers_.size () < numberThreads_) createWorkers ();
+	  validatePaths (workers_, paths, reverse, stopAtValid, validParts,
+			 valid);
+	  return;
+	}
+	PathValidation::validateBatch (paths, reverse, stopAtValid,
+				       validParts, valid);
+      }
+
+      void Dichotomy::createWorkers ()
+      {
+	workers_.clear ();
+	// Workers share the obstacles, only read by distance computations.
+	ObjectVector_t obstacles;
+	for (ObstaclePairs_t::const_iterator itPair = obstaclePairs_.begin ();
+	     itPair != obstaclePairs_.end (); ++itPair) {
+	  const ObjectVector_t& objects = (*itPair->second)->objects_b ();
+	  for (ObjectVector_t::const_iterator itObject = objects.begin ();
+	       itObject != objects.end (); ++itObject) {
+	    if (std::find (obstacles.begin (), obstacles.end (), *itObject) ==
+		obstacles.end ()) {
+	      obstacles.push_back (*itObject);
 	    }
-	    assert ((*itPair)->validSubset ().contains (t0));
 	  }
-	  // Sort collision pairs
-	  bodyPairCollisions_.sort (compareBodyPairCol);
-	  BodyPairCollisionPtr_t first = *(bodyPairCollisions_.begin ());
-	  while (!first->validSubset ().contains (t1)) {
-	    // find middle of first non valid interval
-	    const std::list <interval_t>& intervals =
-	      first->validSubset ().list ();
-	    std::list <interval_t>::const_iterator firstInterval =
-	      intervals.begin ();
-	    std::list <interval_t>::const_iterator secondInterval =
-	      firstInterval;
-	    ++secondInterval;
-	    value_type lower = firstInterval->second;
-	    value_type upper;
-	    if (secondInterval != intervals.end ()) {
-	      upper = secondInterval->first;
-	    } else {
-	      upper = t1;
+	}
+	const JointVector_t& jv = robot_->getJointVector ();
+	for (std::size_t k = 0; k < numberThreads_; ++k) {
+	  DevicePtr_t robot (robot_->clone ());
+	  DichotomyPtr_t worker (create (robot, tolerance_));
+	  const JointVector_t& workerJoints = robot->getJointVector ();
+	  for (ObjectVector_t::const_iterator itObject = obstacles.begin ();
+	       itObject != obstacles.end (); ++itObject) {
+	    worker->addObstacle (*itObject);
+	  }
+	  // Obstacles removed by removeObstacleFromJoint, joints of the clone
+	  // are in the same order.
+	  for (std::size_t i = 0; i < jv.size (); ++i) {
+	    if (!jv [i]->linkedBody ()) continue;
+	    ObstaclePairs_t::const_iterator itPair =
+	      obstaclePairs_.find (jv [i]);
+	    ObjectVector_t objects;
+	    if (itPair != obstaclePairs_.end ()) {
+	      objects = (*itPair->second)->objects_b ();
 	    }
-	    value_type middle = .5 * (lower + upper);
-	    if (first->validateInterval (middle, *collisionReport)) {
-	      partialSort (bodyPairCollisions_, compareBodyPairCol);
-	    } else {
-	      report = CollisionPathValidationReportPtr_t
-		(new CollisionPathValidationReport (middle, collisionReport));
-	      validPart = path->extract (interval_t (t0, lower));
-	      return false;
+	    for (ObjectVector_t::const_iterator itObject = obstacles.begin ();
+		 itObject != obstacles.end (); ++itObject) {
+	      if (std::find (objects.begin (), objects.end (), *itObject) ==
+		  objects.end ()) {
+		worker->removeObstacleFromJoint (workerJoints [i], *itObject);
+	      }
 	    }
-	    first = *(bodyPairCollisions_.begin ());
 	  }
+	  workers_.push_back (worker);
 	}
-	validPart = path;
-	return true;
       }
 
       void Dichotomy::addObstacle
       (const CollisionObjectPtr_t& object)
       {
+	workers_.clear ();
 	const JointVector_t& jv = robot_->getJointVector ();
 	for (JointVector_t::const_iterator itJoint = jv.begin ();
 	     itJoint != jv.end (); ++itJoint) {
 	  BodyPtr_t body = (*itJoint)->linkedBody ();
-	  bool foundPair = false;
 	  if (body) {
-	    for (BodyPairCollisions_t::iterator itPair =
-		   bodyPairCollisions_.begin ();
-		 itPair != bodyPairCollisions_.end (); ++itPair) {
-	      if (((*itPair)->joint_a () == *itJoint) &&
-		  (!(*itPair)->joint_b ())) {
-		(*itPair)->addObjectTo_b (object);
-		foundPair = true;
-	      }
-	    }
-	    if (!foundPair) {
+	    ObstaclePairs_t::iterator itPair = obstaclePairs_.find (*itJoint);
+	    if (itPair != obstaclePairs_.end ()) {
+	      (*itPair->second)->addObjectTo_b (object);
+	    } else {
 	      ObjectVector_t objects;
 	      objects.push_back (object);
-	      bodyPairCollisions_.push_back
-		(BodyPairCollision::create (*itJoint, objects, tolerance_));
+	      obstaclePairs_ [*itJoint] = bodyPairCollisions_.insert
+		(bodyPairCollisions_.end (),
+		 BodyPairCollision::create (*itJoint, objects, tolerance_));
 	    }
 	  }
 	}
@@ -413,20 +370,10 @@ namespace hpp {
       void Dichotomy::removeObstacleFromJoint
       (const JointPtr_t& joint, const CollisionObjectPtr_t& obstacle)
       {
-	bool removed = false;
-	for (BodyPairCollisions_t::iterator itPair =
-	       bodyPairCollisions_.begin ();
-	     itPair != bodyPairCollisions_.end (); ++itPair) {
-	  if (!(*itPair)->joint_b () && (*itPair)->joint_a () == joint) {
-	    if ((*itPair)->removeObjectTo_b (obstacle)) {
-	      removed = true;
-	      if ((*itPair)->objects_b ().empty ()) {
-		bodyPairCollisions_.erase (itPair);
-	      }
-	    }
-	  }
-	}
-	if (!removed) {
+	workers_.clear ();
+	ObstaclePairs_t::iterator itPair = obstaclePairs_.find (joint);
+	if (itPair == obstaclePairs_.end () ||
+	    !(*itPair->second)->removeObjectTo_b (obstacle)) {
 	  std::ostringstream oss;
 	  oss << "Dichotomy::removeObstacleFromJoint: obstacle \""
 	      << obstacle->name () <<
@@ -434,6 +381,38 @@ namespace hpp {
 	      << "\".";
 	  throw std::runtime_error (oss.str ());
 	}
+	if ((*itPair->second)->objects_b ().empty ()) {
+	  bodyPairCollisions_.erase (itPair->second);
+	  obstaclePairs_.erase (itPair);
+	}
+      }
+
+      void Dichotomy::removeObstacle (const CollisionObjectPtr_t& object)
+      {
+	workers_.clear ();
+	for (ObstaclePairs_t::iterator itPair = obstaclePairs_.begin ();
+	     itPair != obstaclePairs_.end ();) {
+	  BodyPairCollisionPtr_t pair = *itPair->second;
+	  if (pair->removeObjectTo_b (object) && pair->objects_b ().empty ()) {
+	    bodyPairCollisions_.erase (itPair->second);
+	    obstaclePairs_.erase (itPair++);
+	  } else {
+	    ++itPair;
+	  }
+	}
+      }
+
+      void Dichotomy::obstacleMoved (const CollisionObjectPtr_t& object)
+      {
+	workers_.clear ();
+	for (ObstaclePairs_t::iterator itPair = obstaclePairs_.begin ();
+	     itPair != obstaclePairs_.end (); ++itPair) {
+	  const ObjectVector_t& objects = (*itPair->second)->objects_b ();
+	  if (std::find (objects.begin (), objects.end (), object) !=
+	      objects.end ()) {
+	    (*itPair->second)->clearCache ();
+	  }
+	}
       }
 
       Dichotomy::~Dichotomy ()
@@ -443,7 +422,9 @@ namespace hpp {
       Dichotomy::Dichotomy
       (const DevicePtr_t& robot, const value_type& tolerance) :
 	robot_ (robot), tolerance_ (tolerance),
-	bodyPairCollisions_ ()
+	bodyPairCollisions_ (), obstaclePairs_ (),
+	sample_ (new dichotomy::PathSample (robot)), numberThreads_ (1),
+	workers_ (), collisionReport_ ()
       {
 	// Tolerance should be equal to 0, otherwise end of valid
 	// sub-path might be in collision.
@@ -19,8 +19,10 @@
 #ifndef HPP_CORE_CONT_COLLISION_CHECKING_DICHOTOMY_BODY_PAIR_COLLISION_HH
 # define HPP_CORE_CONT_COLLISION_CHECKING_DICHOTOMY_BODY_PAIR_COLLISION_HH
 
+# include <algorithm>
 # include <limits>
 # include <iterator>
+# include <map>
 
 # include <hpp/fcl/collision_data.h>
 # include <hpp/fcl/collision.h>
@@ -29,9 +31,12 @@
 # include <hpp/model/joint.hh>
 # include <hpp/model/joint-configuration.hh>
 # include <hpp/core/collision-validation-report.hh>
+# include <hpp/core/operation-counters.hh>
 # include <hpp/core/straight-path.hh>
 # include <hpp/core/projection-error.hh>
+# include "extracted-path.hh"
 # include "continuous-collision-checking/intervals.hh"
+# include "continuous-collision-checking/velocity-bounds.hh"
 
 
 namespace hpp {
@@ -55,16 +60,82 @@ namespace hpp {
 	using model::JointAnchorConstPtr_t;
 	using model::Transform3f;
 
-	/// Multiplicative coefficients of linear and angular velocities
-	struct CoefficientVelocity
+	/// Configuration and joint positions at a parameter of a path
+	///
+	/// Body pairs tested at the same parameter during a validation share
+	/// the evaluation of the path and the positions of their common
+	/// ancestors. Joint positions are computed on demand.
+	class PathSample
 	{
-	  CoefficientVelocity () : value_ (0)
+	public:
+	  /// Constructor
+	  /// \param robot robot the joints of which are stored.
+	  PathSample (const DevicePtr_t& robot) :
+	    robot_ (robot), path_ (), t_ (0), q_ (),
+	    positions_ (robot->getJointVector ().size ()),
+	    computed_ (robot->getJointVector ().size (), false), identity_ ()
+	  {
+	  }
+
+	  /// Forget the current sample
+	  void reset ()
 	  {
+	    path_.reset ();
 	  }
-	  /// Joint the degrees of freedom of which the bounds correspond to.
-	  JointConstPtr_t joint_;
-	  value_type value_;
-	}; // struct CoefficientVelocity
+
+	  /// Evaluate a path, unless it was already evaluated at this parameter
+	  /// \throw projection_error if the path cannot be evaluated.
+	  void set (const PathPtr_t& path, const value_type& t)
+	  {
+	    if (path == path_ && t == t_) return;
+	    path_.reset ();
+	    q_.resize (path->outputSize ());
+	    if (!(*path) (q_, t)) {
+	      throw projection_error
+		(std::string ("Unable to apply constraints in ") +
+		 __PRETTY_FUNCTION__);
+	    }
+	    path_ = path;
+	    t_ = t;
+	    std::fill (computed_.begin (), computed_.end (), false);
+	  }
+
+	  /// Rank of a joint in the joint vector of a robot
+	  static std::size_t jointRank (const DevicePtr_t& robot,
+					const JointConstPtr_t& joint)
+	  {
+	    const JointVector_t& jv = robot->getJointVector ();
+	    return std::find (jv.begin (), jv.end (), joint) - jv.begin ();
+	  }
+
+	  /// Position of the last joint of a chain in the world frame
+	  /// \param chain joints from the root joint,
+	  /// \param ranks ranks of the joints of the chain in the robot.
+	  const Transform3f& position (const std::vector <JointConstPtr_t>& chain,
+				       const std::vector <std::size_t>& ranks)
+	  {
+	    const Transform3f* parent = &identity_;
+	    for (std::size_t i = 0; i < chain.size (); ++i) {
+	      std::size_t rank = ranks [i];
+	      if (!computed_ [rank]) {
+		chain [i]->computePosition (q_, *parent, positions_ [rank]);
+		computed_ [rank] = true;
+	      }
+	      parent = &positions_ [rank];
+	    }
+	    return *parent;
+	  }
+
+	private:
+	  DevicePtr_t robot_;
+	  /// Path and parameter of the sample, null path if none
+	  PathPtr_t path_;
+	  value_type t_;
+	  Configuration_t q_;
+	  std::vector <Transform3f> positions_;
+	  std::vector <bool> computed_;
+	  Transform3f identity_;
+	}; // class PathSample
 
 	/// Computation of collision-free sub-intervals of a path
 	///
@@ -75,6 +146,11 @@ namespace hpp {
 	/// by intervals where boths bodies are proved to be collision-free.
 	/// Each interval is computed by bounding from above the velocity of
 	/// all points of body 1 in the reference frame of body 2.
+	///
+	/// Intervals proved collision-free are kept for each validated path as
+	/// long as the path exists and the objects of the pair do not change,
+	/// so that validating the same path again, or a path extracted from it,
+	/// starts from the intervals already proved collision-free.
 	class BodyPairCollision
 	{
 	public:
@@ -132,6 +208,7 @@ namespace hpp {
 		 " to add it to a collision pair.");
 	    }
 	    objects_b_.push_back (object);
+	    clearCache ();
 	  }
 
 	  const ObjectVector_t& objects_b  () const
@@ -145,6 +222,7 @@ namespace hpp {
 		 itObj != objects_b_.end (); ++itObj) {
 	      if (object->fcl () == (*itObj)->fcl ()) {
 		objects_b_.erase (itObj);
+		clearCache ();
 		return true;
 	      }
 	    }
@@ -153,13 +231,30 @@ namespace hpp {
 
 	  /// Set path to validate
 	  /// \param path path to validate,
+	  /// \param bounds velocity bounds of the degrees of freedom along
+	  ///        sub-intervals of the path,
+	  /// \param sample configuration and joint positions shared by the
+	  ///        pairs tested along the path.
 	  /// Compute maximal velocity of point of body a in frame of body b
-	  /// along the path.
-	  void path (const StraightPathPtr_t& path)
+	  /// on each sub-interval of the path.
+	  ///
+	  /// The valid subset is initialized with the intervals already proved
+	  /// collision-free for this path or for the path it is extracted from.
+	  void path (const PathPtr_t& path, const PathVelocityBounds& bounds,
+		     PathSample& sample)
 	  {
 	    path_ = path;
-	    computeMaximalVelocity ();
+	    sample_ = &sample;
+	    computeMaximalVelocity (bounds);
 	    intervals_.clear ();
+	    findCachedSubset ();
+	  }
+
+	  /// Forget intervals proved collision-free for previous paths
+	  void clearCache ()
+	  {
+	    cache_.clear ();
+	    cached_ = 0x0;
 	  }
 
 	  /// Get path
@@ -182,23 +277,16 @@ namespace hpp {
 	  (const value_type& t, CollisionValidationReport& report)
 	  {
 	    using std::numeric_limits;
+	    OperationCounters::increment (OperationCounters::CONTINUOUS_STEP);
 	    // Get configuration of robot corresponding to parameter
-            bool success;
-	    Configuration_t q = (*path_) (t, success);
-            if (!success) throw
-              projection_error(std::string ("Unable to apply constraints in ") + __PRETTY_FUNCTION__);
-	    // Compute position of joint a in frame of common ancestor
-	    model::Transform3f Ma, tmp;
-        for (int i = (int)indexCommonAncestor_ - 1; i >= 0; --i) {
-          joints_ [(std::size_t)i]->computePosition (q, Ma, tmp);
-	      Ma = tmp;
-	    }
-	    // Compute position of joint b in frame of common ancestor
-	    model::Transform3f Mb;
-	    for (std::size_t i = indexCommonAncestor_ + 1; i < joints_.size ();
-		 ++i) {
-	      joints_ [i]->computePosition (q, Mb, tmp);
-	      Mb = tmp;
+	    sample_->set (path_, t);
+	    // Compute positions of joints a and b in the world frame, chain b
+	    // is empty for obstacles.
+	    const Transform3f& Ma = sample_->position (chain_a_, ranks_a_);
+	    const Transform3f& Mb = sample_->position (chain_b_, ranks_b_);
+	    for (ObjectVector_t::const_iterator itb = objects_b_.begin ();
+		 itb != objects_b_.end (); ++itb) {
+	      (*itb)->fcl ()->setTransform (Mb * (*itb)->positionInJointFrame ());
 	    }
 	    value_type distanceLowerBound =
 	      numeric_limits <value_type>::infinity ();
@@ -209,38 +297,35 @@ namespace hpp {
 	      object_a->setTransform (Ma * (*ita)->positionInJointFrame ());
 	      for (ObjectVector_t::const_iterator itb = objects_b_.begin ();
 		   itb != objects_b_.end (); ++itb) {
-		// Compute position of object b
 		fcl::CollisionObject* object_b = (*itb)->fcl ().get ();
-		object_b->setTransform (Mb * (*itb)->positionInJointFrame ());
 		// Perform collision test
-		fcl::CollisionRequest request (1, false, true, 1, false, true,
-					       fcl::GST_INDEP);
-		fcl::CollisionResult result;
-		fcl::collide (object_a, object_b, request, result);
+		result_.clear ();
+		OperationCounters::increment (OperationCounters::NARROW_PHASE);
+		fcl::collide (object_a, object_b, request_, result_);
 		// Get result
-		if (result.isCollision ()) {
+		if (result_.isCollision ()) {
 		  report.object1 = *ita;
 		  report.object2 = *itb;
 		  return false;
 		}
-		if (result.distance_lower_bound < distanceLowerBound) {
-		  distanceLowerBound = result.distance_lower_bound;
+		if (result_.distance_lower_bound < distanceLowerBound) {
+		  distanceLowerBound = result_.distance_lower_bound;
 		}
 	      }
 	    }
-	    value_type halfLength;
-	    if (distanceLowerBound ==
-		numeric_limits <value_type>::infinity ()) {
-	      halfLength = numeric_limits <value_type>::infinity ();
-	    } else {
-	      halfLength = (tolerance_ + distanceLowerBound)/maximalVelocity_;
-	    }
-	    std::string joint2;
-	    if (joint_b_) joint2 = joint_b_->name ();
-	    else joint2 = (*objects_b_.begin ())->name ();
-	    assert (!isnan (halfLength));
-	    intervals_.unionInterval
-	      (interval_t(t - halfLength, t + halfLength));
+	    distanceLowerBound_ = distanceLowerBound;
+	    // Move along the path with the velocity bound of each sub-interval
+	    value_type lower = velocity_.reach
+	      (t, tolerance_ + distanceLowerBound, false);
+	    value_type upper = velocity_.reach
+	      (t, tolerance_ + distanceLowerBound, true);
+	    assert (!isnan (lower));
+	    assert (!isnan (upper));
+	    intervals_.unionInterval (interval_t (lower, upper));
+	    // Velocity bounds only hold on the interval of definition
+	    const interval_t& range = path_->timeRange ();
+	    storeInterval (interval_t (std::max (lower, range.first),
+				       std::min (upper, range.second)));
 	    return true;
 	  }
 
@@ -254,6 +339,13 @@ namespace hpp {
 	    return maximalVelocity_;
 	  }
 
+	  /// Distance lower bound between the bodies computed by the last call
+	  /// to validateInterval, infinity if none.
+	  value_type distanceLowerBound () const
+	  {
+	    return distanceLowerBound_;
+	  }
+
 	protected:
 	  /// Constructor of inter-body collision checking
 	  ///
@@ -265,8 +357,15 @@ namespace hpp {
 			     value_type tolerance):
 	    joint_a_ (joint_a), joint_b_ (joint_b), objects_a_ (),
 	    objects_b_ (), joints_ (),
-	    indexCommonAncestor_ (0), coefficients_ (), maximalVelocity_ (0),
-	    tolerance_ (tolerance)
+	    indexCommonAncestor_ (0), chain_a_ (), chain_b_ (), ranks_a_ (),
+	    ranks_b_ (), sample_ (0x0),
+	    request_ (1, false, true, 1, false, true, fcl::GST_INDEP),
+	    result_ (), coefficients_ (), maximalVelocity_ (0),
+	    velocity_ (),
+	    tolerance_ (tolerance),
+	    distanceLowerBound_ (std::numeric_limits <value_type>::infinity ()),
+	    cache_ (), cached_ (0x0),
+	    cacheReversed_ (false), cacheSum_ (0), cacheSizeBeforePurge_ (64)
 	  {
 	    assert (joint_a);
 	    assert (joint_b);
@@ -304,8 +403,15 @@ namespace hpp {
 			     value_type tolerance) :
 	    joint_a_ (joint_a), joint_b_ (), objects_a_ (), objects_b_ (),
 	    joints_ (),
-	    indexCommonAncestor_ (0), coefficients_ (), maximalVelocity_ (0),
-	    tolerance_ (tolerance)
+	    indexCommonAncestor_ (0), chain_a_ (), chain_b_ (), ranks_a_ (),
+	    ranks_b_ (), sample_ (0x0),
+	    request_ (1, false, true, 1, false, true, fcl::GST_INDEP),
+	    result_ (), coefficients_ (), maximalVelocity_ (0),
+	    velocity_ (),
+	    tolerance_ (tolerance),
+	    distanceLowerBound_ (std::numeric_limits <value_type>::infinity ()),
+	    cache_ (), cached_ (0x0),
+	    cacheReversed_ (false), cacheSum_ (0), cacheSizeBeforePurge_ (64)
 	  {
 	    assert (joint_a);
 	    BodyPtr_t body_a = joint_a_->linkedBody ();
@@ -328,6 +434,95 @@ namespace hpp {
 	  }
 
 	private:
+	  /// Intervals proved collision-free along a path
+	  struct CachedSubset
+	  {
+	    /// Used to detect that the path has been deleted
+	    PathWkPtr_t path;
+	    /// Valid subset in parameters of the path
+	    Intervals validSubset;
+	  }; // struct CachedSubset
+	  typedef std::map <const Path*, CachedSubset> Cache_t;
+
+	  /// Map parameter of current path to parameter of cached path
+	  value_type cachedParameter (const value_type& t) const
+	  {
+	    return cacheReversed_ ? cacheSum_ - t : t;
+	  }
+
+	  /// Find intervals proved collision-free for the current path
+	  ///
+	  /// Paths extracted from another path with the same constraints share
+	  /// the cached subset of the original path.
+	  void findCachedSubset ()
+	  {
+	    PathPtr_t key = path_;
+	    cacheReversed_ = false;
+	    cacheSum_ = 0;
+	    const interval_t& range = path_->timeRange ();
+	    ExtractedPathPtr_t extracted =
+	      HPP_DYNAMIC_PTR_CAST (ExtractedPath, path_);
+	    if (extracted &&
+		extracted->original ()->constraints () == path_->constraints ()) {
+	      key = extracted->original ();
+	      cacheReversed_ = extracted->reversed ();
+	      cacheSum_ = range.first + range.second;
+	    }
+	    Cache_t::iterator it = cache_.find (key.get ());
+	    if (it != cache_.end () && it->second.path.lock () != key) {
+	      // Another path was stored at the same address
+	      cache_.erase (it);
+	      it = cache_.end ();
+	    }
+	    if (it == cache_.end ()) {
+	      removeExpiredPaths ();
+	      it = cache_.insert (std::make_pair (key.get (), CachedSubset ())).
+		first;
+	      it->second.path = key;
+	    }
+	    cached_ = &(it->second.validSubset);
+	    // Restrict cached subset to the interval of definition
+	    const Intervals::Container_t& cached = cached_->list ();
+	    for (Intervals::Container_t::const_iterator itInt = cached.begin ();
+		 itInt != cached.end (); ++itInt) {
+	      value_type lower = cachedParameter (itInt->first);
+	      value_type upper = cachedParameter (itInt->second);
+	      if (lower > upper) std::swap (lower, upper);
+	      lower = std::max (lower, range.first);
+	      upper = std::min (upper, range.second);
+	      if (lower <= upper) {
+		intervals_.unionInterval (interval_t (lower, upper));
+	      }
+	    }
+	  }
+
+	  /// Store interval of the current path proved collision-free
+	  void storeInterval (const interval_t& interval)
+	  {
+	    if (!cached_ || interval.first > interval.second) return;
+	    value_type lower = cachedParameter (interval.first);
+	    value_type upper = cachedParameter (interval.second);
+	    if (lower > upper) std::swap (lower, upper);
+	    cached_->unionInterval (interval_t (lower, upper));
+	  }
+
+	  /// Remove cached subsets of deleted paths
+	  ///
+	  /// Called when the number of cached paths doubles.
+	  void removeExpiredPaths ()
+	  {
+	    if (cache_.size () < cacheSizeBeforePurge_) return;
+	    for (Cache_t::iterator it = cache_.begin (); it != cache_.end ();) {
+	      if (it->second.path.expired ()) {
+		cache_.erase (it++);
+	      } else {
+		++it;
+	      }
+	    }
+	    cacheSizeBeforePurge_ = std::max (2 * cache_.size (),
+					      (std::size_t) 64);
+	  }
+
 	  void computeSequenceOfJoints ()
 	  {
 	    JointConstPtr_t j1, j2, j, commonAncestor = 0x0;
@@ -368,17 +563,28 @@ namespace hpp {
 	      else if (*it == commonAncestor)
 		commonAncestorFound = true;
 	    }
+	    // Joints from the root joint, in the order positions are computed
+	    chain_a_.assign (aAncestors.rbegin () + 1, aAncestors.rend ());
+	    chain_b_.assign (bAncestors.begin (), bAncestors.end ());
+	    DevicePtr_t robot = joint_a_->robot ();
+	    ranks_a_.resize (chain_a_.size ());
+	    for (std::size_t i = 0; i < chain_a_.size (); ++i) {
+	      ranks_a_ [i] = PathSample::jointRank (robot, chain_a_ [i]);
+	    }
+	    ranks_b_.resize (chain_b_.size ());
+	    for (std::size_t i = 0; i < chain_b_.size (); ++i) {
+	      ranks_b_ [i] = PathSample::jointRank (robot, chain_b_ [i]);
+	    }
 	  }
 
 	  void computeCoefficients ()
 	  {
 	    JointConstPtr_t child;
 	    assert (joints_.size () > 1);
-	    coefficients_.resize (joints_.size () - 1);
+	    coefficients_.clear ();
 	    // Store r0 + sum of T_{i/i+1} in a variable
 	    value_type cumulativeLength = joint_a_->linkedBody ()->radius ();
 	    value_type distance;
-	    size_type i = 0;
 	    std::vector <JointConstPtr_t>::const_iterator it = joints_.begin ();
 	    std::vector <JointConstPtr_t>::const_iterator itNext = it + 1;
 	    while (itNext != joints_.end ()) {
@@ -389,36 +595,23 @@ namespace hpp {
 	      } else {
 		abort ();
 	      }
-	      coefficients_ [i].joint_ = child;
-	      // Go through all known types of joints
 	      distance = child->maximalDistanceToParent ();
-	      coefficients_ [i].value_ = child->upperBoundLinearVelocity () +
-		cumulativeLength * child->upperBoundAngularVelocity ();
+	      coefficients_.addJoint
+		(child->rankInVelocity (), child->numberDof (),
+		 child->upperBoundLinearVelocity () +
+		 cumulativeLength * child->upperBoundAngularVelocity ());
 	      cumulativeLength += distance;
-	      it = itNext; ++itNext; ++i;
+	      it = itNext; ++itNext;
 	    }
 	  }
 
 	  /// Compute maximal velocity of points of body1 in the frame of body 2
-	  /// \param path input path
-	  void computeMaximalVelocity ()
+	  /// on each sub-interval of the path
+	  /// \param bounds velocity bounds of the degrees of freedom.
+	  void computeMaximalVelocity (const PathVelocityBounds& bounds)
 	  {
-	    value_type t0 = path_->timeRange ().first;
-	    value_type t1 = path_->timeRange ().second;
-	    value_type T = t1 - t0;
-	    bool success;
-	    Configuration_t q1 = (*path_) (t0, success);
-	    Configuration_t q2 = (*path_) (t1, success);
-
-	    maximalVelocity_ = 0;
-	    for (std::vector <CoefficientVelocity>::const_iterator itCoef =
-		   coefficients_.begin (); itCoef != coefficients_.end ();
-		 ++itCoef) {
-	      const JointConstPtr_t& joint = itCoef->joint_;
-	      const value_type& value = itCoef->value_;
-	      maximalVelocity_ += value * joint->configuration ()->distance
-		(q1, q2, joint->rankInConfiguration ()) / T;
-	    }
+	    coefficients_.compute (bounds, velocity_);
+	    maximalVelocity_ = velocity_.maximal ();
 	  }
 
 	  JointConstPtr_t joint_a_;
@@ -427,11 +620,35 @@ namespace hpp {
 	  ObjectVector_t objects_b_;
 	  std::vector <JointConstPtr_t> joints_;
 	  std::size_t indexCommonAncestor_;
-	  std::vector <CoefficientVelocity> coefficients_;
-	  StraightPathPtr_t path_;
+	  /// Joints from the root joint to joint a
+	  std::vector <JointConstPtr_t> chain_a_;
+	  /// Joints from the root joint to joint b, empty for obstacles
+	  std::vector <JointConstPtr_t> chain_b_;
+	  /// Ranks of the joints of the chains in the robot
+	  std::vector <std::size_t> ranks_a_;
+	  std::vector <std::size_t> ranks_b_;
+	  /// Sample shared by the pairs validating the current path
+	  PathSample* sample_;
+	  fcl::CollisionRequest request_;
+	  fcl::CollisionResult result_;
+	  /// Velocity of body a in the frame of body b, built at construction
+	  ChainVelocity coefficients_;
+	  PathPtr_t path_;
 	  value_type maximalVelocity_;
+	  /// Velocity bound on each sub-interval of the path
+	  PiecewiseVelocity velocity_;
 	  Intervals intervals_;
 	  value_type tolerance_;
+	  value_type distanceLowerBound_;
+	  /// Valid subsets of the paths validated since the objects changed
+	  Cache_t cache_;
+	  /// Cached subset of the current path
+	  Intervals* cached_;
+	  /// Whether the current path goes backward along the cached path
+	  bool cacheReversed_;
+	  /// Sum of bounds of the interval of definition of an extracted path
+	  value_type cacheSum_;
+	  std::size_t cacheSizeBeforePurge_;
 	}; // class BodyPairCollision
       } // namespace dichotomy
     } // namespace continuousCollisionChecking
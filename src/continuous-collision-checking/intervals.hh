@@ -19,24 +19,24 @@
 #ifndef HPP_CORE_CONTINUOUS_COLLISION_CHECKING_INTERVALS_HH
 # define HPP_CORE_CONTINUOUS_COLLISION_CHECKING_INTERVALS_HH
 
+#include <algorithm>
 #include <ostream>
-#include <list>
+#include <sstream>
+#include <vector>
 #include <hpp/core/fwd.hh>
 
 namespace hpp {
   namespace core {
     namespace continuousCollisionChecking {
-      inline bool lastElement (const std::list <interval_t>& list,
-			       const std::list <interval_t>::iterator& it)
-      {
-	std::list <interval_t>::iterator it1 = it; ++it1;
-	if (it1 == list.end ()) return true;
-	return false;
-      }
       /// Union of intervals
+      ///
+      /// Intervals are stored disjoint and sorted in a contiguous array, so
+      /// that union and membership tests are performed by binary search.
       class Intervals
       {
       public:
+	typedef std::vector <interval_t> Container_t;
+
 	/// Reset to empty set
 	void clear ()
 	{
@@ -45,118 +45,41 @@ namespace hpp {
 	/// Union of this with an interval
 	void unionInterval (const interval_t& interval)
 	{
-	  std::list <std::list <interval_t>::iterator> toErase;
-	  unsigned int cas = 0;
-	  std::list <interval_t>::iterator it = intervals_.begin ();
-	  for (; it != intervals_.end (); ++it) {
-	    if (interval.first < it->first) {
-	      cas = 1;
-	      break;
-	    } else if (interval.first <= it->second) {
-	      cas = 2;
-	      break;
-	    }
-	  }
-	  if (cas == 0) {
-	    intervals_.push_back (interval);
-	  } else if (cas == 1) {
-	    // intervals_ |------------|       |=== *it ===|   |---------|
-	    // interval                    |------------------------------
-	    for (; it != intervals_.end (); ++it) {
-	      if (interval.second < it->first) {
-		// intervals_ ---|     |xxxxxxxx|      |=== *it ===|   |-------|
-		// interval        |----------------|
-		intervals_.insert (it, interval);
-		break;
-	      } else if (interval.second < it->second) {
-		// intervals_ ---|     |xxxxxx|      |=== *it ===|   |---------|
-		// interval        |---------------------|
-		it->first = interval.first;
-		break;
-	      } else {
-		// intervals_ ---|     |=== *it ===|     |--------|   |--------|
-		// interval        |------------------|
-		toErase.push_back (it);
-	      }
-	    }
-	    if (it == intervals_.end ()) {
-	      intervals_.push_back (interval);
-	    }
-	  } else if (cas == 2) {
-	    // intervals_ |==== *it ====|       |-------|   |---------|
-	    // interval             |----------------------------------
-	    for (std::list <interval_t>::iterator it1 = it;
-		 it1 != intervals_.end (); ++it1) {
-	      if (interval.second < it1->first) {
-		// intervals_ |==== *it ====|  |-----|   |=== *it1 ===|
-		// interval             |--------------|
-		it->second = interval.second;
-	      } else if (interval.second < it1->second) {
-		// intervals_ |==== *it ====|  |-----|   |=== *it1 ===|
-		// interval             |-------------------|
-		it->second = it1->second;
-		// Remove it1 if different from it
-		if (it1 != it) {
-		  toErase.push_back (it1);
-		}
-		break;
-	      } else if (lastElement (intervals_, it1)) {
-		it->second = interval.second;
-		if (it1 != it) {
-		  toErase.push_back (it1);
-		}
-		break;
-	      } else {
-		// intervals_ |==== *it ====|  |xxxxx|   |=== *it1 ===|
-		// interval             |------------------------------------|
-		// Remove it1 if different from it
-		if (it1 != it) {
-		  toErase.push_back (it1);
-		}
-	      }
-	    }
-	  } else {
-	    abort ();
-	  }
-	  for (std::list <std::list <interval_t>::iterator>::iterator itErase =
-		 toErase.begin (); itErase != toErase.end (); ++itErase) {
-	    intervals_.erase (*itErase);
+	  // First interval ending after the beginning of interval
+	  Container_t::iterator lower = std::lower_bound
+	    (intervals_.begin (), intervals_.end (), interval.first,
+	     compareSecond);
+	  // First interval starting after the end of interval
+	  Container_t::iterator upper = std::upper_bound
+	    (lower, intervals_.end (), interval.second, compareFirst);
+	  if (lower == upper) {
+	    // intervals_ ---|   |-------|         |---------|   |-------|
+	    // interval                     |----|
+	    intervals_.insert (lower, interval);
+	    return;
 	  }
+	  // intervals_ ---|   |== *lower ==|  |xxxxx|  |== *(upper-1) ==|   |--
+	  // interval             |---------------------------|
+	  lower->first = std::min (lower->first, interval.first);
+	  lower->second = std::max ((upper - 1)->second, interval.second);
+	  intervals_.erase (lower + 1, upper);
 	}
 
+	/// Whether an interval is included in the union
 	bool contains (const interval_t& interval) const
 	{
-	  for (std::list <interval_t>::const_iterator it = intervals_.begin ();
-	       it != intervals_.end (); ++it) {
-	    if ((it->first <= interval.first) &&
-		(interval.second <= it->second)) {
-	      return true;
-	    }
-	  }
-	  return false;
+	  Container_t::const_iterator it = find (interval.first);
+	  return (it != intervals_.end ()) && (interval.second <= it->second);
 	}
 
-	bool contains (const value_type& value, bool reverse = false) const
+	/// Whether a value belongs to the union
+	bool contains (const value_type& value) const
 	{
-	  if (reverse) {
-	    for (std::list <interval_t>::const_iterator it=intervals_.begin ();
-		 it != intervals_.end (); ++it) {
-	      if ((it->first <= value) && (value <= it->second)) {
-		return true;
-	      }
-	    }
-	  } else {
-	    for (std::list <interval_t>::const_reverse_iterator
-		   it=intervals_.rbegin (); it != intervals_.rend (); ++it) {
-	      if ((it->first <= value) && (value <= it->second)) {
-		return true;
-	      }
-	    }
-	  }
-	  return false;
+	  return find (value) != intervals_.end ();
 	}
 
-	const std::list <interval_t>& list () const
+	/// Get sorted disjoint intervals
+	const Container_t& list () const
 	{
 	  return intervals_;
 	}
@@ -164,7 +87,7 @@ namespace hpp {
 	std::ostream& print (std::ostream& os) const
 	{
 	  os << "Intervals: " << std::endl;
-	  for (std::list <interval_t>::const_iterator it = intervals_.begin ();
+	  for (Container_t::const_iterator it = intervals_.begin ();
 	       it != intervals_.end (); ++it) {
 	    os << "[" << it->first << ", " << it->second << "]" << std::endl;
 	  }
@@ -179,7 +102,30 @@ namespace hpp {
 	}
 
       private:
-	std::list <interval_t> intervals_;      
+	static bool compareSecond (const interval_t& interval,
+				   const value_type& value)
+	{
+	  return interval.second < value;
+	}
+
+	static bool compareFirst (const value_type& value,
+				  const interval_t& interval)
+	{
+	  return value < interval.first;
+	}
+
+	/// Find interval containing a value
+	/// \return iterator to the interval, end if the value is not in the
+	///         union.
+	Container_t::const_iterator find (const value_type& value) const
+	{
+	  Container_t::const_iterator it = std::lower_bound
+	    (intervals_.begin (), intervals_.end (), value, compareSecond);
+	  if (it != intervals_.end () && it->first <= value) return it;
+	  return intervals_.end ();
+	}
+
+	Container_t intervals_;
       }; // class Intervals
     } // namespace continuousCollisionChecking
   } // namespace core
@@ -16,14 +16,23 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <limits>
+#include <boost/bind.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include <hpp/util/debug.hh>
+#include <hpp/model/body.hh>
+#include <hpp/model/collision-object.hh>
 #include <hpp/core/collision-path-validation-report.hh>
 #include <hpp/core/continuous-collision-checking/progressive.hh>
 #include <hpp/core/straight-path.hh>
 #include <hpp/core/path-vector.hh>
+#include <hpp/core/trace.hh>
 
 #include "continuous-collision-checking/progressive/body-pair-collision.hh"
+#include "continuous-collision-checking/segment-validation.hh"
 
 namespace hpp {
   namespace core {
@@ -33,6 +42,159 @@ namespace hpp {
       using progressive::BodyPairCollisionPtr_t;
       using progressive::BodyPairCollisions_t;
 
+      namespace {
+	// Data shared by threads validating body pairs at a configuration
+	struct PairsData
+	{
+	  const std::vector <BodyPairCollision*>* pairs;
+	  value_type t;
+	  bool reverse;
+	  boost::mutex mutex;
+	  // Set by the first thread that finds a collision
+	  bool collision;
+	  CollisionValidationReportPtr_t report;
+	}; // struct PairsData
+
+	// Validate pairs of rank in [begin, end)
+	void validatePairRange (PairsData* data, std::size_t begin,
+				std::size_t end, value_type* tmin,
+				std::string* error)
+	{
+	  try {
+	    for (std::size_t i = begin; i < end; ++i) {
+	      {
+		boost::mutex::scoped_lock lock (data->mutex);
+		if (data->collision) return;
+	      }
+	      value_type tmpMin;
+	      CollisionValidationReportPtr_t report;
+	      if (!(*data->pairs) [i]->validateConfiguration (data->t, tmpMin,
+							      report)) {
+		boost::mutex::scoped_lock lock (data->mutex);
+		if (!data->collision) {
+		  data->collision = true;
+		  data->report = report;
+		}
+		return;
+	      }
+	      if (data->reverse) {
+		*tmin = std::max (*tmin, tmpMin);
+	      } else {
+		*tmin = std::min (*tmin, tmpMin);
+	      }
+	    }
+	  } catch (const std::exception& exc) {
+	    *error = exc.what ();
+	  }
+	}
+      } // namespace
+
+      namespace progressive {
+	// Threads validating ranges of body pairs with the calling thread
+	//
+	// Threads wait for the pairs of the next configuration instead of
+	// being created for each configuration along the path.
+	class PairThreads
+	{
+	public:
+	  // Start nbThreads - 1 threads, the calling thread validates the
+	  // first range.
+	  PairThreads (std::size_t nbThreads) :
+	    nbThreads_ (nbThreads), mutex_ (), started_ (), finished_ (),
+	    generation_ (0), running_ (0), stop_ (false), data_ (0x0),
+	    chunk_ (0), tmins_ (nbThreads), errors_ (nbThreads), threads_ ()
+	  {
+	    for (std::size_t k = 1; k < nbThreads_; ++k) {
+	      threads_.create_thread (boost::bind (&PairThreads::work, this,
+						   k));
+	    }
+	  }
+
+	  ~PairThreads ()
+	  {
+	    {
+	      boost::mutex::scoped_lock lock (mutex_);
+	      stop_ = true;
+	    }
+	    started_.notify_all ();
+	    threads_.join_all ();
+	  }
+
+	  // Validate the pairs of data split in contiguous ranges
+	  // \retval tmin smallest valid interval over all pairs if no
+	  //         collision is found.
+	  void validate (PairsData& data, value_type& tmin)
+	  {
+	    std::size_t n = data.pairs->size ();
+	    {
+	      boost::mutex::scoped_lock lock (mutex_);
+	      data_ = &data;
+	      chunk_ = (n + nbThreads_ - 1) / nbThreads_;
+	      tmins_.assign (nbThreads_, tmin);
+	      errors_.assign (nbThreads_, std::string ());
+	      running_ = nbThreads_ - 1;
+	      ++generation_;
+	    }
+	    started_.notify_all ();
+	    validatePairRange (&data, 0, std::min (n, chunk_), &tmins_ [0],
+			       &errors_ [0]);
+	    boost::mutex::scoped_lock lock (mutex_);
+	    while (running_ > 0) finished_.wait (lock);
+	    for (std::size_t k = 0; k < nbThreads_; ++k) {
+	      if (!errors_ [k].empty ()) throw std::runtime_error (errors_ [k]);
+	    }
+	    for (std::size_t k = 0; k < nbThreads_; ++k) {
+	      if (data.reverse) {
+		tmin = std::max (tmin, tmins_ [k]);
+	      } else {
+		tmin = std::min (tmin, tmins_ [k]);
+	      }
+	    }
+	  }
+
+	private:
+	  // Validate range k of each configuration
+	  void work (std::size_t k)
+	  {
+	    std::size_t generation = 0;
+	    while (true) {
+	      PairsData* data;
+	      std::size_t begin, end;
+	      {
+		boost::mutex::scoped_lock lock (mutex_);
+		while (!stop_ && generation_ == generation) {
+		  started_.wait (lock);
+		}
+		if (stop_) return;
+		generation = generation_;
+		data = data_;
+		std::size_t n = data->pairs->size ();
+		begin = std::min (n, k * chunk_);
+		end = std::min (n, begin + chunk_);
+	      }
+	      validatePairRange (data, begin, end, &tmins_ [k], &errors_ [k]);
+	      boost::mutex::scoped_lock lock (mutex_);
+	      if (--running_ == 0) finished_.notify_one ();
+	    }
+	  }
+
+	  const std::size_t nbThreads_;
+	  boost::mutex mutex_;
+	  boost::condition_variable started_;
+	  boost::condition_variable finished_;
+	  // Incremented for each configuration
+	  std::size_t generation_;
+	  // Number of threads that have not validated their range yet
+	  std::size_t running_;
+	  bool stop_;
+	  PairsData* data_;
+	  std::size_t chunk_;
+	  std::vector <value_type> tmins_;
+	  std::vector <std::string> errors_;
+	  boost::thread_group threads_;
+	}; // class PairThreads
+      } // namespace progressive
+
       ProgressivePtr_t Progressive::create (const DevicePtr_t& robot,
 					    const value_type& tolerance)
       {
@@ -42,6 +204,58 @@ namespace hpp {
 	return shPtr;
       }
 
+      PathValidationPtr_t Progressive::copy (const DevicePtr_t& robot) const
+      {
+	ProgressivePtr_t other = create (robot, tolerance_);
+	other->numberThreads_ = numberThreads_;
+	return other;
+      }
+
+      void Progressive::computeForwardKinematics
+      (const Configuration_t& config)
+      {
+	robot_->currentConfiguration (config);
+	robot_->computeForwardKinematics ();
+	// Body pairs use the bounding boxes of the objects of the robot
+	for (ObjectVector_t::const_iterator itObject = innerObjects_.begin ();
+	     itObject != innerObjects_.end (); ++itObject) {
+	  (*itObject)->fcl ()->computeAABB ();
+	}
+      }
+
+      bool Progressive::validatePairs
+      (const value_type& t, bool reverse, value_type& tmin,
+       PathValidationReportPtr_t& report)
+      {
+	std::vector <BodyPairCollision*> pairs;
+	pairs.reserve (bodyPairCollisions_.size ());
+	for (BodyPairCollisions_t::iterator itPair =
+	       bodyPairCollisions_.begin ();
+	     itPair != bodyPairCollisions_.end (); ++itPair) {
+	  pairs.push_back (itPair->get ());
+	}
+	PairsData data;
+	data.pairs = &pairs;
+	data.t = t;
+	data.reverse = reverse;
+	data.collision = false;
+	if (!pairThreads_) {
+	  pairThreads_.reset (new progressive::PairThreads (numberThreads_));
+	}
+	value_type tminPairs = tmin;
+	pairThreads_->validate (data, tminPairs);
+	if (data.collision) {
+	  CollisionPathValidationReportPtr_t pathReport
+	    (CollisionPathValidationReport::reuse (report));
+	  pathReport->configurationReport = data.report;
+	  pathReport->parameter = t;
+	  return false;
+	}
+	tmin = tminPairs;
+	hppDout (info, "tmin=" << tmin);
+	return true;
+      }
+
       bool Progressive::validateConfiguration
       (const Configuration_t& config, bool reverse, value_type& tmin,
        PathValidationReport& report)
@@ -51,10 +265,10 @@ namespace hpp {
 	CollisionValidationReport& collisionReport =
 	  static_cast <CollisionValidationReport&> (*report.configurationReport);
 	value_type t = tmin;
-	tmin = std::numeric_limits <value_type>::infinity ();
+	// Smallest valid interval over all pairs
+	tmin = (reverse ? -1 : 1) * std::numeric_limits <value_type>::infinity ();
 	value_type tmpMin;
-	robot_->currentConfiguration (config);
-	robot_->computeForwardKinematics ();
+	computeForwardKinematics (config);
 	for (BodyPairCollisions_t::iterator itPair =
 	       bodyPairCollisions_.begin ();
 	     itPair != bodyPairCollisions_.end (); ++itPair) {
@@ -78,19 +292,23 @@ namespace hpp {
        PathValidationReportPtr_t& report)
       {
 	value_type t = tmin;
-	tmin = std::numeric_limits <value_type>::infinity ();
+	tmin = (reverse ? -1 : 1) * std::numeric_limits <value_type>::infinity ();
+	computeForwardKinematics (config);
+	if (numberThreads_ > 1 && bodyPairCollisions_.size () > 1) {
+	  return validatePairs (t, reverse, tmin, report);
+	}
 	value_type tmpMin;
-	robot_->currentConfiguration (config);
-	robot_->computeForwardKinematics ();
+	// Reuse the reports of the caller if nobody else refers to them
+	CollisionValidationReportPtr_t collisionReport
+	  (CollisionPathValidationReport::reusableConfigurationReport (report));
 	for (BodyPairCollisions_t::iterator itPair =
 	       bodyPairCollisions_.begin ();
 	     itPair != bodyPairCollisions_.end (); ++itPair) {
-	  CollisionValidationReportPtr_t collisionReport;
 	  if (!(*itPair)->validateConfiguration (t, tmpMin, collisionReport)) {
-	    report = CollisionPathValidationReportPtr_t
-	      (new CollisionPathValidationReport);
-	    report->configurationReport = collisionReport;
-	    report->parameter = t;
+	    CollisionPathValidationReportPtr_t pathReport
+	      (CollisionPathValidationReport::reuse (report));
+	    pathReport->configurationReport = collisionReport;
+	    pathReport->parameter = t;
 	    return false;
 	  } else {
 	    if (reverse) {
@@ -104,6 +322,51 @@ namespace hpp {
 	return true;
       }
 
+      template <typename Report> bool Progressive::validateElementaryPath
+      (const PathPtr_t& path, bool reverse, PathPtr_t& validPart,
+       Report& report)
+      {
+	// for each BodyPairCollision
+	//   - set path,
+	//   - compute valid interval at start (end if reverse)
+	PathVelocityBounds bounds;
+	bounds.compute (path);
+	for (BodyPairCollisions_t::iterator itPair =
+	       bodyPairCollisions_.begin ();
+	     itPair != bodyPairCollisions_.end (); ++itPair) {
+	  (*itPair)->path (path, bounds, reverse);
+	}
+	value_type tmin = path->timeRange ().first;
+	value_type tmax = path->timeRange ().second;
+	value_type lastValidTime = reverse ? tmax : tmin;
+	value_type t = lastValidTime;
+	unsigned finished = 0;
+	// Configurations are written in q_ without allocation
+	q_.resize (path->outputSize ());
+	while (finished < 2) {
+	  value_type tprev = t;
+	  if (!(*path) (q_, t) ||
+	      !validateConfiguration (q_, reverse, t, report)) {
+	    if (reverse) {
+	      validPart = path->extract (std::make_pair (lastValidTime, tmax));
+	    } else {
+	      validPart = path->extract (std::make_pair (tmin, lastValidTime));
+	    }
+	    return false;
+	  }
+	  lastValidTime = tprev;
+	  if (reverse && t <= tmin) {
+	    t = tmin;
+	    finished ++;
+	  } else if (!reverse && t >= tmax) {
+	    t = tmax;
+	    finished ++;
+	  }
+	}
+	validPart = path;
+	return true;
+      }
+
       bool Progressive::validate
       (const PathPtr_t& path, bool reverse, PathPtr_t& validPart)
       {
@@ -127,10 +390,10 @@ namespace hpp {
 	  if (reverse) {
 	    value_type param = path->length ();
 	    std::deque <PathPtr_t> paths;
-	    for (std::size_t i=pv->numberPaths () + 1; i != 0 ; --i) {
+	    for (std::size_t i=pv->numberPaths (); i != 0 ; --i) {
 	      PathPtr_t localPath (pv->pathAtRank (i-1));
 	      if (validate (localPath, reverse, localValidPart, report)) {
-		paths.push_front (localPath->copy ());
+		paths.push_front (localPath);
 		param -= localPath->length ();
 	      } else {
 		report.parameter += param - localPath->length ();
@@ -148,7 +411,7 @@ namespace hpp {
 	    for (std::size_t i=0; i < pv->numberPaths (); ++i) {
 	      PathPtr_t localPath (pv->pathAtRank (i));
 	      if (validate (localPath, reverse, localValidPart, report)) {
-		validPathVector->appendPath (localPath->copy ());
+		validPathVector->appendPath (localPath);
 		param += localPath->length ();
 	      } else {
 		report.parameter += param;
@@ -159,77 +422,20 @@ namespace hpp {
 	    return true;
 	  }
 	}
-	StraightPathPtr_t straightPath = HPP_DYNAMIC_PTR_CAST
-	  (StraightPath, path);
-	// for each BodyPairCollision
-	//   - set path,
-	//   - compute valid interval at start (end if reverse)
-	bool valid = true;
-	for (BodyPairCollisions_t::iterator itPair =
-	       bodyPairCollisions_.begin ();
-	     itPair != bodyPairCollisions_.end (); ++itPair) {
-	  (*itPair)->path (straightPath, reverse);
-	}
-	if (reverse) {
-	  value_type tmin = path->timeRange ().first;
-	  value_type tmax = path->timeRange ().second;
-	  value_type lastValidTime = tmax;
-	  value_type t = tmax;
-	  unsigned finished = 0;
-	  while (finished < 2 && valid) {
-	    Configuration_t q = (*path) (t);
-	    value_type tprev = t;
-	    if (!validateConfiguration (q, reverse, t, report)) {
-	      valid = false;
-	    } else {
-	      lastValidTime = tprev;
-	    }
-	    if (t <= tmin) {
-	      t = tmin;
-	      finished ++;
-	    }
-	  }
-	  if (valid) {
-	    validPart = path;
-	    return true;
-	  } else {
-	    validPart = path->extract (std::make_pair (lastValidTime, tmax));
-	    return false;
-	  }
-	} else {
-	  value_type tmin = path->timeRange ().first;
-	  value_type tmax = path->timeRange ().second;
-	  value_type lastValidTime = tmin;
-	  value_type t = tmin;
-	  unsigned finished = 0;
-	  while (finished < 2 && valid) {
-	    Configuration_t q = (*path) (t);
-	    value_type tprev = t;
-	    if (!validateConfiguration (q, reverse, t, report)) {
-	      valid = false;
-	    } else {
-	      lastValidTime = tprev;
-	    }
-	    if (t >= tmax) {
-	      t = tmax;
-	      finished ++;
-	    }
-	  }
-	  if (valid) {
-	    validPart = path;
-	    return true;
-	  } else {
-	    validPart = path->extract (std::make_pair (tmin, lastValidTime));
-	    return false;
-	  }
-	}
+	return validateElementaryPath (path, reverse, validPart, report);
       }
 
       bool Progressive::validate (const PathPtr_t& path, bool reverse,
 				  PathPtr_t& validPart,
 				  PathValidationReportPtr_t& report)
       {
+	TraceScope trace ("Progressive::validate");
 	if (PathVectorPtr_t pv = HPP_DYNAMIC_PTR_CAST (PathVector, path)) {
+	  if (numberThreads_ > 1 && pv->numberPaths () > 1 &&
+	      parallelizable (pv)) {
+	    if (workers_.size () < numberThreads_) createWorkers ();
+	    return validateSegments (workers_, pv, reverse, validPart, report);
+	  }
 	  PathVectorPtr_t validPathVector = PathVector::create
 	    (path->outputSize (), path->outputDerivativeSize ());
 	  validPart = validPathVector;
@@ -237,10 +443,10 @@ namespace hpp {
 	  if (reverse) {
 	    value_type param = path->length ();
 	    std::deque <PathPtr_t> paths;
-	    for (std::size_t i=pv->numberPaths () + 1; i != 0 ; --i) {
+	    for (std::size_t i=pv->numberPaths (); i != 0 ; --i) {
 	      PathPtr_t localPath (pv->pathAtRank (i-1));
 	      if (validate (localPath, reverse, localValidPart, report)) {
-		paths.push_front (localPath->copy ());
+		paths.push_front (localPath);
 		param -= localPath->length ();
 	      } else {
 		report->parameter += param - localPath->length ();
@@ -258,7 +464,7 @@ namespace hpp {
 	    for (std::size_t i=0; i < pv->numberPaths (); ++i) {
 	      PathPtr_t localPath (pv->pathAtRank (i));
 	      if (validate (localPath, reverse, localValidPart, report)) {
-		validPathVector->appendPath (localPath->copy ());
+		validPathVector->appendPath (localPath);
 		param += localPath->length ();
 	      } else {
 		report->parameter += param;
@@ -269,82 +475,64 @@ namespace hpp {
 	    return true;
 	  }
 	}
-	StraightPathPtr_t straightPath = HPP_DYNAMIC_PTR_CAST
-	  (StraightPath, path);
-	// for each BodyPairCollision
-	//   - set path,
-	//   - compute valid interval at start (end if reverse)
-	bool valid = true;
-	for (BodyPairCollisions_t::iterator itPair =
-	       bodyPairCollisions_.begin ();
-	     itPair != bodyPairCollisions_.end (); ++itPair) {
-	  (*itPair)->path (straightPath, reverse);
+	return validateElementaryPath (path, reverse, validPart, report);
+      }
+
+
+      void Progressive::validateBatch (const Paths_t& paths, bool reverse,
+				       bool stopAtValid, Paths_t& validParts,
+				       std::vector <bool>& valid)
+      {
+	if (numberThreads_ > 1 && paths.size () > 1 &&
+	    parallelizable (paths)) {
+	  if (workers_.size () < numberThreads_) createWorkers ();
+	  validatePaths (workers_, paths, reverse, stopAtValid, validParts,
+			 valid);
+	  return;
 	}
-	if (reverse) {
-	  value_type tmin = path->timeRange ().first;
-	  value_type tmax = path->timeRange ().second;
-	  value_type lastValidTime = tmax;
-	  value_type t = tmax;
-	  unsigned finished = 0;
-          Configuration_t q (path->outputSize ());
-	  while (finished < 2 && valid) {
-	    bool success = (*path) (q, t);
-	    value_type tprev = t;
-	    PathValidationReportPtr_t pathReport;
-	    if (!success || !validateConfiguration (q, reverse, t, pathReport)) {
-	      report = pathReport;
-	      valid = false;
-	    } else {
-	      lastValidTime = tprev;
-	    }
-	    if (t <= tmin) {
-	      t = tmin;
-	      finished ++;
-	    }
-	  }
-	  if (valid) {
-	    validPart = path;
-	    return true;
-	  } else {
-	    validPart = path->extract (std::make_pair (lastValidTime, tmax));
-	    return false;
+	PathValidation::validateBatch (paths, reverse, stopAtValid,
+				       validParts, valid);
+      }
+
+      void Progressive::createWorkers ()
+      {
+	workers_.clear ();
+	// Workers share the obstacles, only read by distance computations.
+	ObjectVector_t obstacles;
+	for (ObstaclePairs_t::const_iterator itPair = obstaclePairs_.begin ();
+	     itPair != obstaclePairs_.end (); ++itPair) {
+	  if (std::find (obstacles.begin (), obstacles.end (),
+			 itPair->first.second) == obstacles.end ()) {
+	    obstacles.push_back (itPair->first.second);
 	  }
-	} else {
-	  value_type tmin = path->timeRange ().first;
-	  value_type tmax = path->timeRange ().second;
-	  value_type lastValidTime = tmin;
-	  value_type t = tmin;
-	  unsigned finished = 0;
-          Configuration_t q (path->outputSize ());
-	  while (finished < 2 && valid) {
-	    bool success = (*path) (q, t);
-	    value_type tprev = t;
-	    PathValidationReportPtr_t pathReport;
-	    if (!success || !validateConfiguration (q, reverse, t, pathReport)) {
-	      report = pathReport;
-	      valid = false;
-	    } else {
-	      lastValidTime = tprev;
-	    }
-	    if (t >= tmax) {
-	      t = tmax;
-	      finished ++;
+	}
+	const JointVector_t& jv = robot_->getJointVector ();
+	for (std::size_t k = 0; k < numberThreads_; ++k) {
+	  DevicePtr_t robot (robot_->clone ());
+	  ProgressivePtr_t worker (create (robot, tolerance_));
+	  worker->distanceField_ = distanceField_;
+	  const JointVector_t& workerJoints = robot->getJointVector ();
+	  for (ObjectVector_t::const_iterator itObject = obstacles.begin ();
+	       itObject != obstacles.end (); ++itObject) {
+	    worker->addObstacle (*itObject);
+	    // Pairs removed by removeObstacleFromJoint, joints of the clone
+	    // are in the same order.
+	    for (std::size_t i = 0; i < jv.size (); ++i) {
+	      if (jv [i]->linkedBody () &&
+		  obstaclePairs_.find (std::make_pair (jv [i], *itObject)) ==
+		  obstaclePairs_.end ()) {
+		worker->removeObstacleFromJoint (workerJoints [i], *itObject);
+	      }
 	    }
 	  }
-	  if (valid) {
-	    validPart = path;
-	    return true;
-	  } else {
-	    validPart = path->extract (std::make_pair (tmin, lastValidTime));
-	    return false;
-	  }
+	  workers_.push_back (worker);
 	}
       }
 
-
       void Progressive::addObstacle
       (const CollisionObjectPtr_t& object)
       {
+	workers_.clear ();
 	const JointVector_t& jv = robot_->getJointVector ();
 	for (JointVector_t::const_iterator itJoint = jv.begin ();
 	     itJoint != jv.end (); ++itJoint) {
@@ -352,8 +540,11 @@ namespace hpp {
 	  if (body) {
 	    ObjectVector_t objects;
 	    objects.push_back (object);
-	    bodyPairCollisions_.push_back
+	    BodyPairCollisionPtr_t pair
 	      (BodyPairCollision::create (*itJoint, objects, tolerance_));
+	    pair->distanceField (distanceField_);
+	    obstaclePairs_ [std::make_pair (*itJoint, object)] =
+	      bodyPairCollisions_.insert (bodyPairCollisions_.end (), pair);
 	  }
 	}
       }
@@ -361,20 +552,10 @@ namespace hpp {
       void Progressive::removeObstacleFromJoint
       (const JointPtr_t& joint, const CollisionObjectPtr_t& obstacle)
       {
-	bool removed = false;
-	for (BodyPairCollisions_t::iterator itPair =
-	       bodyPairCollisions_.begin ();
-	     itPair != bodyPairCollisions_.end (); ++itPair) {
-	  if (!(*itPair)->joint_b () && (*itPair)->joint_a () == joint) {
-	    if ((*itPair)->removeObjectTo_b (obstacle)) {
-	      removed = true;
-	      if ((*itPair)->objects_b ().empty ()) {
-		bodyPairCollisions_.erase (itPair);
-	      }
-	    }
-	  }
-	}
-	if (!removed) {
+	workers_.clear ();
+	ObstaclePairs_t::iterator itPair = obstaclePairs_.find
+	  (std::make_pair (joint, obstacle));
+	if (itPair == obstaclePairs_.end ()) {
 	  std::ostringstream oss;
 	  oss << "Progressive::removeObstacleFromJoint: obstacle \""
 	      << obstacle->name () <<
@@ -382,6 +563,45 @@ namespace hpp {
 	      << "\".";
 	  throw std::runtime_error (oss.str ());
 	}
+	bodyPairCollisions_.erase (itPair->second);
+	obstaclePairs_.erase (itPair);
+      }
+
+      void Progressive::removeObstacle (const CollisionObjectPtr_t& object)
+      {
+	workers_.clear ();
+	const JointVector_t& jv = robot_->getJointVector ();
+	for (JointVector_t::const_iterator itJoint = jv.begin ();
+	     itJoint != jv.end (); ++itJoint) {
+	  ObstaclePairs_t::iterator itPair = obstaclePairs_.find
+	    (std::make_pair (*itJoint, object));
+	  if (itPair != obstaclePairs_.end ()) {
+	    bodyPairCollisions_.erase (itPair->second);
+	    obstaclePairs_.erase (itPair);
+	  }
+	}
+      }
+
+      void Progressive::obstacleMoved (const CollisionObjectPtr_t& object)
+      {
+	// Pairs with obstacles use the bounding box computed when the
+	// obstacle was added.
+	object->fcl ()->computeAABB ();
+	// The field was computed at the previous position of the obstacle.
+	if (distanceField_ && distanceField_->contains (object)) {
+	  distanceField (DistanceFieldPtr_t ());
+	}
+      }
+
+      void Progressive::distanceField (const DistanceFieldPtr_t& field)
+      {
+	distanceField_ = field;
+	for (BodyPairCollisions_t::iterator itPair =
+	       bodyPairCollisions_.begin ();
+	     itPair != bodyPairCollisions_.end (); ++itPair) {
+	  (*itPair)->distanceField (field);
+	}
+	workers_.clear ();
       }
 
       Progressive::~Progressive ()
@@ -391,7 +611,9 @@ namespace hpp {
       Progressive::Progressive
       (const DevicePtr_t& robot, const value_type& tolerance) :
 	robot_ (robot), tolerance_ (tolerance),
-	bodyPairCollisions_ ()
+	bodyPairCollisions_ (), obstaclePairs_ (), q_ (), innerObjects_ (),
+	distanceField_ (), numberThreads_ (1), workers_ (),
+	pairThreads_ ()
       {
 	if (tolerance <= 0) {
 	  throw std::runtime_error
@@ -409,6 +631,17 @@ namespace hpp {
 					 (itPair->first, itPair->second,
 					  tolerance_));
 	}
+	const JointVector_t& jv = robot->getJointVector ();
+	for (JointVector_t::const_iterator itJoint = jv.begin ();
+	     itJoint != jv.end (); ++itJoint) {
+	  BodyPtr_t body = (*itJoint)->linkedBody ();
+	  if (body) {
+	    const ObjectVector_t& objects = body->innerObjects
+	      (model::COLLISION);
+	    innerObjects_.insert (innerObjects_.end (), objects.begin (),
+				  objects.end ());
+	  }
+	}
       }
     } // namespace continuousCollisionChecking
   } // namespace core
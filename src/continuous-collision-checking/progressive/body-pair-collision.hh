@@ -28,9 +28,12 @@
 # include <hpp/model/collision-object.hh>
 # include <hpp/model/joint.hh>
 # include <hpp/model/joint-configuration.hh>
+# include <hpp/core/distance-field.hh>
+# include <hpp/core/operation-counters.hh>
 # include <hpp/core/straight-path.hh>
 # include <hpp/core/deprecated.hh>
 # include "continuous-collision-checking/intervals.hh"
+# include "continuous-collision-checking/velocity-bounds.hh"
 
 
 namespace hpp {
@@ -54,17 +57,6 @@ namespace hpp {
 	using model::JointAnchorConstPtr_t;
 	using model::Transform3f;
 
-	/// Multiplicative coefficients of linear and angular velocities
-	struct CoefficientVelocity
-	{
-	  CoefficientVelocity () : value_ (0)
-	  {
-	  }
-	  /// Joint the degrees of freedom of which the bounds correspond to.
-	  JointConstPtr_t joint_;
-	  value_type value_;
-	}; // struct CoefficientVelocity
-
 	/// Computation of collision-free sub-intervals of a path
 	///
 	/// This class aims at validating a path for the absence of collision
@@ -130,7 +122,9 @@ namespace hpp {
 		("Object should not be attached to a joint"
 		 " to add it to a collision pair.");
 	    }
+	    object->fcl ()->computeAABB ();
 	    objects_b_.push_back (object);
+	    if (field_ && !field_->contains (object)) field_.reset ();
 	  }
 
 	  const ObjectVector_t& objects_b  () const
@@ -138,6 +132,20 @@ namespace hpp {
 	    return objects_b_;
 	  }
 
+	  /// Set distance field bounding the distance to the objects of b
+	  /// \param field field, ignored if it does not contain all the
+	  ///        objects of b, or if b is a joint.
+	  void distanceField (const DistanceFieldPtr_t& field)
+	  {
+	    field_.reset ();
+	    if (!field || joint_b_) return;
+	    for (ObjectVector_t::const_iterator it = objects_b_.begin ();
+		 it != objects_b_.end (); ++it) {
+	      if (!field->contains (*it)) return;
+	    }
+	    field_ = field;
+	  }
+
 	  bool removeObjectTo_b (const CollisionObjectPtr_t& object)
 	  {
 	    for (ObjectVector_t::iterator itObj = objects_b_.begin ();
@@ -152,15 +160,20 @@ namespace hpp {
 
 	  /// Set path to validate
 	  /// \param path path to validate,
+	  /// \param bounds velocity bounds of the degrees of freedom along
+	  ///        sub-intervals of the path,
 	  /// \param reverse whether path is validated from end to beginning.
 	  /// Compute maximal velocity of point of body a in frame of body b
-	  /// along the path.
-	  void path (const StraightPathPtr_t& path, bool reverse)
+	  /// on each sub-interval of the path.
+	  void path (const PathPtr_t& path, const PathVelocityBounds& bounds,
+		     bool reverse)
 	  {
 	    path_ = path;
-	    computeMaximalVelocity ();
+	    computeMaximalVelocity (bounds);
 	    reverse_ = reverse;
 	    valid_ = false;
+	    certified_ = (reverse ? 1 : -1) *
+	      std::numeric_limits <value_type>::infinity ();
 	  }
 
 	  /// Get path
@@ -185,66 +198,20 @@ namespace hpp {
 	      }
 	      return true;
 	    }
-	    using std::numeric_limits;
-	    value_type distanceLowerBound =
-	      numeric_limits <value_type>::infinity ();
-	    for (ObjectVector_t::const_iterator ita = objects_a_.begin ();
-		 ita != objects_a_.end (); ++ita) {
-	      // Compute position of object a
-	      fcl::CollisionObject* object_a = (*ita)->fcl ().get ();
-	      for (ObjectVector_t::const_iterator itb = objects_b_.begin ();
-		   itb != objects_b_.end (); ++itb) {
-		// Compute position of object b
-		fcl::CollisionObject* object_b = (*itb)->fcl ().get ();
-		// Perform collision test
-		fcl::CollisionRequest request (1, false, true, 1, false, true,
-					       fcl::GST_INDEP);
-		fcl::CollisionResult result;
-		fcl::collide (object_a, object_b, request, result);
-		// Get result
-		if (result.isCollision ()) {
-		  hppDout (info, "collision at " << t << " for pair ("
-			   << joint_a_->name () << "," << (*itb)->name ()
-			   << ")");
-		  report.object1 = *ita;
-		  report.object2 = *itb;
-		  return false;
-		}
-		if (result.distance_lower_bound < distanceLowerBound) {
-		  distanceLowerBound = result.distance_lower_bound;
-		}
-	      }
+	    if (isCertified (t, tmin)) return true;
+	    value_type distanceLowerBound;
+	    if (!computeDistanceLowerBound (t, distanceLowerBound,
+					    report.object1, report.object2)) {
+	      return false;
 	    }
-	    value_type halfLengthDist, halfLengthTol;
-	    if (distanceLowerBound ==
-		numeric_limits <value_type>::infinity ()) {
-	      halfLengthDist = numeric_limits <value_type>::infinity ();
-	      halfLengthTol = 0;
-	    } else {
-	      halfLengthDist = distanceLowerBound/maximalVelocity_;
-	      halfLengthTol = 2*tolerance_/maximalVelocity_;
-	    }
-	    assert (!isnan (halfLengthDist));
-	    assert (!isnan (halfLengthTol));
-	    if (reverse_) {
-	      tmin = t - (halfLengthDist + halfLengthTol);
-	      if (t - halfLengthDist <= path_->timeRange ().first) {
-		valid_ = true;
-	      }
-	    } else {
-	      tmin = t + halfLengthDist + halfLengthTol;
-	      if (t + halfLengthDist >= path_->timeRange ().second) {
-		valid_ = true;
-	      }
-	    }
-	    std::string joint2;
-	    if (joint_b_) joint2 = joint_b_->name ();
-	    else joint2 = (*objects_b_.begin ())->name ();
+	    computeValidInterval (t, distanceLowerBound, tmin);
 	    return true;
 	  }
 
 	  /// Validate interval centered on a path parameter
 	  /// \param t parameter value in the path interval of definition
+	  /// \retval report filled if the body pair is in collision: reused if
+	  ///         not empty, allocated otherwise.
 	  /// \return true if the body pair is collision free for this parameter
 	  ///         value, false if the body pair is in collision.
 	  bool validateConfiguration (const value_type& t, value_type& tmin,
@@ -258,64 +225,21 @@ namespace hpp {
 	      }
 	      return true;
 	    }
-	    using std::numeric_limits;
-	    value_type distanceLowerBound =
-	      numeric_limits <value_type>::infinity ();
-	    for (ObjectVector_t::const_iterator ita = objects_a_.begin ();
-		 ita != objects_a_.end (); ++ita) {
-	      // Compute position of object a
-	      fcl::CollisionObject* object_a = (*ita)->fcl ().get ();
-	      for (ObjectVector_t::const_iterator itb = objects_b_.begin ();
-		   itb != objects_b_.end (); ++itb) {
-		// Compute position of object b
-		fcl::CollisionObject* object_b = (*itb)->fcl ().get ();
-		// Perform collision test
-		fcl::CollisionRequest request (1, false, true, 1, false, true,
-					       fcl::GST_INDEP);
-		fcl::CollisionResult result;
-		fcl::collide (object_a, object_b, request, result);
-		// Get result
-		if (result.isCollision ()) {
-		  hppDout (info, "collision at " << t << " for pair ("
-			   << joint_a_->name () << "," << (*itb)->name ()
-			   << ")");
-		  report = CollisionValidationReportPtr_t
-		    (new CollisionValidationReport);
-		  report->object1 = *ita;
-		  report->object2 = *itb;
-		  report->result = result;
-		  return false;
-		}
-		if (result.distance_lower_bound < distanceLowerBound) {
-		  distanceLowerBound = result.distance_lower_bound;
-		}
+	    if (isCertified (t, tmin)) return true;
+	    value_type distanceLowerBound;
+	    CollisionObjectPtr_t object1, object2;
+	    if (!computeDistanceLowerBound (t, distanceLowerBound, object1,
+					    object2)) {
+	      if (!report) {
+		report = CollisionValidationReportPtr_t
+		  (new CollisionValidationReport);
 	      }
+	      report->object1 = object1;
+	      report->object2 = object2;
+	      report->result = result_;
+	      return false;
 	    }
-	    value_type halfLengthDist, halfLengthTol;
-	    if (distanceLowerBound ==
-		numeric_limits <value_type>::infinity ()) {
-	      halfLengthDist = numeric_limits <value_type>::infinity ();
-	      halfLengthTol = 0;
-	    } else {
-	      halfLengthDist = distanceLowerBound/maximalVelocity_;
-	      halfLengthTol = 2*tolerance_/maximalVelocity_;
-	    }
-	    assert (!isnan (halfLengthDist));
-	    assert (!isnan (halfLengthTol));
-	    if (reverse_) {
-	      tmin = t - (halfLengthDist + halfLengthTol);
-	      if (t - halfLengthDist <= path_->timeRange ().first) {
-		valid_ = true;
-	      }
-	    } else {
-	      tmin = t + halfLengthDist + halfLengthTol;
-	      if (t + halfLengthDist >= path_->timeRange ().second) {
-		valid_ = true;
-	      }
-	    }
-	    std::string joint2;
-	    if (joint_b_) joint2 = joint_b_->name ();
-	    else joint2 = (*objects_b_.begin ())->name ();
+	    computeValidInterval (t, distanceLowerBound, tmin);
 	    return true;
 	  }
 
@@ -351,7 +275,12 @@ namespace hpp {
 	    joint_a_ (joint_a), joint_b_ (joint_b), objects_a_ (),
 	    objects_b_ (), joints_ (),
 	    indexCommonAncestor_ (0), coefficients_ (), maximalVelocity_ (0),
-	    tolerance_ (tolerance), reverse_ (false)
+	    velocity_ (),
+	    request_ (1, false, true, 1, false, true, fcl::GST_INDEP),
+	    result_ (), field_ (), tolerance_ (tolerance), valid_ (false),
+	    reverse_ (false),
+	    certified_ (-std::numeric_limits <value_type>::infinity ()),
+	    certifiedTmin_ (0)
 	  {
 	    assert (joint_a);
 	    assert (joint_b);
@@ -390,7 +319,12 @@ namespace hpp {
 	    joint_a_ (joint_a), joint_b_ (), objects_a_ (),
 	    objects_b_ (objects_b), joints_ (),
 	    indexCommonAncestor_ (0), coefficients_ (), maximalVelocity_ (0),
-	    tolerance_ (tolerance), reverse_ (false)
+	    velocity_ (),
+	    request_ (1, false, true, 1, false, true, fcl::GST_INDEP),
+	    result_ (), field_ (), tolerance_ (tolerance), valid_ (false),
+	    reverse_ (false),
+	    certified_ (-std::numeric_limits <value_type>::infinity ()),
+	    certifiedTmin_ (0)
 	  {
 	    assert (joint_a);
 	    BodyPtr_t body_a = joint_a_->linkedBody ();
@@ -400,6 +334,8 @@ namespace hpp {
 		 it != objects_b.end (); ++it) {
 	      assert (!(*it)->joint () ||
 		      (*it)->joint ()->robot () != joint_a_->robot ());
+	      // Obstacles do not move
+	      (*it)->fcl ()->computeAABB ();
 	    }
 	    if (tolerance < 0) {
 	      throw std::runtime_error ("tolerance should be non-negative.");
@@ -411,6 +347,103 @@ namespace hpp {
 	  }
 
 	private:
+	  /// Compute a lower bound of the distance between the bodies
+	  ///
+	  /// \param t parameter of the current configuration, the forward
+	  ///        kinematics and the bounding boxes of the objects of which
+	  ///        have been computed,
+	  /// \retval distance lower bound of the distance,
+	  /// \retval object1, object2 colliding objects if any.
+	  /// \return false if objects are in collision.
+	  ///
+	  /// Pairs of objects the bounding boxes of which are farther than the
+	  /// bodies can move until the end of the path are not tested
+	  /// further: the distance between the bounding boxes is used as lower
+	  /// bound. Objects of a the bounding box of which is proved far from
+	  /// the obstacles by the distance field are not tested either.
+	  bool computeDistanceLowerBound (const value_type& t,
+					  value_type& distance,
+					  CollisionObjectPtr_t& object1,
+					  CollisionObjectPtr_t& object2)
+	  {
+	    OperationCounters::increment (OperationCounters::CONTINUOUS_STEP);
+	    distance = std::numeric_limits <value_type>::infinity ();
+	    value_type remaining = velocity_.distance (t, !reverse_);
+	    for (ObjectVector_t::const_iterator ita = objects_a_.begin ();
+		 ita != objects_a_.end (); ++ita) {
+	      const fcl::CollisionObject* object_a = (*ita)->fcl ().get ();
+	      if (field_) {
+		value_type bound = field_->lowerBound (object_a->getAABB ());
+		if (bound > 0) {
+		  distance = std::min (distance, bound);
+		  continue;
+		}
+	      }
+	      for (ObjectVector_t::const_iterator itb = objects_b_.begin ();
+		   itb != objects_b_.end (); ++itb) {
+		const fcl::CollisionObject* object_b = (*itb)->fcl ().get ();
+		value_type aabbDistance = object_a->getAABB ().distance
+		  (object_b->getAABB ());
+		if (aabbDistance > 0 && aabbDistance >= remaining) {
+		  distance = std::min (distance, aabbDistance);
+		  continue;
+		}
+		result_.clear ();
+		OperationCounters::increment (OperationCounters::NARROW_PHASE);
+		fcl::collide (object_a, object_b, request_, result_);
+		if (result_.isCollision ()) {
+		  hppDout (info, "collision at " << t << " for pair ("
+			   << joint_a_->name () << "," << (*itb)->name ()
+			   << ")");
+		  object1 = *ita;
+		  object2 = *itb;
+		  return false;
+		}
+		distance = std::min (distance, result_.distance_lower_bound);
+	      }
+	    }
+	    return true;
+	  }
+
+	  /// Compute valid interval from a distance lower bound
+	  /// \retval tmin end of the valid interval in the direction of
+	  ///         validation.
+	  /// Whether the interval validated by the last test contains a
+	  /// parameter
+	  ///
+	  /// Each pair advances along the path by its own conservative bound:
+	  /// while the configurations tested for other pairs stay in the
+	  /// interval where this pair is proved collision-free, the pair is not
+	  /// tested again.
+	  /// \retval tmin bound of the interval validated by the last test.
+	  bool isCertified (const value_type& t, value_type& tmin) const
+	  {
+	    if (reverse_ ? (t > certified_) : (t < certified_)) {
+	      tmin = certifiedTmin_;
+	      return true;
+	    }
+	    return false;
+	  }
+
+	  void computeValidInterval (const value_type& t,
+				     const value_type& distanceLowerBound,
+				     value_type& tmin)
+	  {
+	    // Move along the path with the velocity bound of each sub-interval
+	    tmin = velocity_.reach (t, distanceLowerBound + 2*tolerance_,
+				    !reverse_);
+	    value_type reached = velocity_.reach (t, distanceLowerBound,
+						  !reverse_);
+	    assert (!isnan (tmin));
+	    certified_ = reached;
+	    certifiedTmin_ = tmin;
+	    if (reverse_) {
+	      if (reached <= path_->timeRange ().first) valid_ = true;
+	    } else {
+	      if (reached >= path_->timeRange ().second) valid_ = true;
+	    }
+	  }
+
 	  void computeSequenceOfJoints ()
 	  {
 	    JointConstPtr_t j1, j2, j, commonAncestor = 0x0;
@@ -457,11 +490,10 @@ namespace hpp {
 	  {
 	    JointConstPtr_t child;
 	    assert (joints_.size () > 1);
-	    coefficients_.resize (joints_.size () - 1);
+	    coefficients_.clear ();
 	    // Store r0 + sum of T_{i/i+1} in a variable
 	    value_type cumulativeLength = joint_a_->linkedBody ()->radius ();
 	    value_type distance;
-	    size_type i = 0;
 	    std::vector <JointConstPtr_t>::const_iterator it = joints_.begin ();
 	    std::vector <JointConstPtr_t>::const_iterator itNext = it + 1;
 	    while (itNext != joints_.end ()) {
@@ -472,35 +504,23 @@ namespace hpp {
 	      } else {
 		abort ();
 	      }
-	      coefficients_ [i].joint_ = child;
-	      // Go through all known types of joints
 	      distance = child->maximalDistanceToParent ();
-	      coefficients_ [i].value_ = child->upperBoundLinearVelocity () +
-		cumulativeLength * child->upperBoundAngularVelocity ();
+	      coefficients_.addJoint
+		(child->rankInVelocity (), child->numberDof (),
+		 child->upperBoundLinearVelocity () +
+		 cumulativeLength * child->upperBoundAngularVelocity ());
 	      cumulativeLength += distance;
-	      it = itNext; ++itNext; ++i;
+	      it = itNext; ++itNext;
 	    }
 	  }
 
 	  /// Compute maximal velocity of points of body1 in the frame of body 2
-	  /// \param path input path
-	  void computeMaximalVelocity ()
+	  /// on each sub-interval of the path
+	  /// \param bounds velocity bounds of the degrees of freedom.
+	  void computeMaximalVelocity (const PathVelocityBounds& bounds)
 	  {
-	    value_type t0 = path_->timeRange ().first;
-	    value_type t1 = path_->timeRange ().second;
-	    value_type T = t1 - t0;
-	    Configuration_t q1 = (*path_) (t0);
-	    Configuration_t q2 = (*path_) (t1);
-
-	    maximalVelocity_ = 0;
-	    for (std::vector <CoefficientVelocity>::const_iterator itCoef =
-		   coefficients_.begin (); itCoef != coefficients_.end ();
-		 ++itCoef) {
-	      const JointConstPtr_t& joint = itCoef->joint_;
-	      const value_type& value = itCoef->value_;
-	      maximalVelocity_ += value * joint->configuration ()->distance
-		(q1, q2, joint->rankInConfiguration ()) / T;
-	    }
+	    coefficients_.compute (bounds, velocity_);
+	    maximalVelocity_ = velocity_.maximal ();
 	  }
 
 	  JointConstPtr_t joint_a_;
@@ -509,12 +529,24 @@ namespace hpp {
 	  ObjectVector_t objects_b_;
 	  std::vector <JointConstPtr_t> joints_;
 	  std::size_t indexCommonAncestor_;
-	  std::vector <CoefficientVelocity> coefficients_;
-	  StraightPathPtr_t path_;
+	  /// Velocity of body a in the frame of body b, built at construction
+	  ChainVelocity coefficients_;
+	  PathPtr_t path_;
 	  value_type maximalVelocity_;
+	  /// Velocity bound on each sub-interval of the path
+	  PiecewiseVelocity velocity_;
+	  /// Collision request and result reused between tests
+	  fcl::CollisionRequest request_;
+	  fcl::CollisionResult result_;
+	  /// Distance field containing the objects of b, if any
+	  DistanceFieldPtr_t field_;
 	  value_type tolerance_;
 	  bool valid_;
 	  bool reverse_;
+	  /// Pair is collision-free from the last tested parameter up to
+	  /// certified_, and valid up to certifiedTmin_ for the tolerance.
+	  value_type certified_;
+	  value_type certifiedTmin_;
 	}; // class BodyPairCollision
       } // namespace progressive
     } // namespace continuousCollisionChecking
@@ -0,0 +1,246 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <hpp/core/path-validation.hh>
+#include <hpp/core/path-validation-report.hh>
+#include <hpp/core/path-vector.hh>
+#include "continuous-collision-checking/segment-validation.hh"
+
+namespace hpp {
+  namespace core {
+    namespace continuousCollisionChecking {
+      namespace {
+	// Data shared by threads validating the segments of a path vector
+	struct SegmentsData
+	{
+	  const PathVector* path;
+	  bool reverse;
+	  boost::mutex mutex;
+	  // Rank in validation order of the next segment to validate
+	  std::size_t next;
+	  // Rank in validation order of the first invalid segment, number of
+	  // segments if none is found yet
+	  std::size_t firstInvalid;
+	  std::vector <PathPtr_t> validParts;
+	  std::vector <PathValidationReportPtr_t> reports;
+	}; // struct SegmentsData
+
+	void validateSegmentsWorker (PathValidation* validation,
+				     SegmentsData* data, std::string* error)
+	{
+	  const std::size_t n = data->path->numberPaths ();
+	  try {
+	    while (true) {
+	      std::size_t rank;
+	      {
+		boost::mutex::scoped_lock lock (data->mutex);
+		if (data->next >= data->firstInvalid) return;
+		rank = data->next++;
+	      }
+	      PathPtr_t localPath (data->path->pathAtRank
+				   (data->reverse ? n - 1 - rank : rank));
+	      PathPtr_t validPart;
+	      PathValidationReportPtr_t report;
+	      bool valid = validation->validate (localPath, data->reverse,
+						 validPart, report);
+	      boost::mutex::scoped_lock lock (data->mutex);
+	      data->validParts [rank] = valid ? localPath : validPart;
+	      data->reports [rank] = report;
+	      if (!valid && rank < data->firstInvalid) {
+		data->firstInvalid = rank;
+	      }
+	    }
+	  } catch (const std::exception& exc) {
+	    *error = exc.what ();
+	    // Stop the other threads
+	    boost::mutex::scoped_lock lock (data->mutex);
+	    data->next = n;
+	  }
+	}
+
+	// Data shared by threads validating a batch of paths
+	struct PathsData
+	{
+	  const Paths_t* paths;
+	  bool reverse;
+	  boost::mutex mutex;
+	  // Rank of the next path to validate
+	  std::size_t next;
+	  // Rank of the first valid path if validation stops there, number of
+	  // paths otherwise
+	  std::size_t stop;
+	  bool stopAtValid;
+	  Paths_t* validParts;
+	  // Not std::vector <bool> that packs bits written by several threads
+	  std::vector <char> valid;
+	}; // struct PathsData
+
+	void validatePathsWorker (PathValidation* validation,
+				  PathsData* data, std::string* error)
+	{
+	  try {
+	    while (true) {
+	      std::size_t rank;
+	      {
+		boost::mutex::scoped_lock lock (data->mutex);
+		if (data->next >= data->stop) return;
+		rank = data->next++;
+	      }
+	      PathPtr_t validPart;
+	      bool valid = validation->validateWithoutReport
+		((*data->paths) [rank], data->reverse, validPart);
+	      boost::mutex::scoped_lock lock (data->mutex);
+	      (*data->validParts) [rank] = validPart;
+	      data->valid [rank] = valid;
+	      if (valid && data->stopAtValid && rank < data->stop) {
+		data->stop = rank;
+	      }
+	    }
+	  } catch (const std::exception& exc) {
+	    *error = exc.what ();
+	    // Stop the other threads
+	    boost::mutex::scoped_lock lock (data->mutex);
+	    data->next = data->paths->size ();
+	  }
+	}
+      } // namespace
+
+      bool parallelizable (const PathVectorPtr_t& path)
+      {
+	if (path->constraints ()) return false;
+	for (std::size_t i = 0; i < path->numberPaths (); ++i) {
+	  const PathPtr_t& localPath (path->pathAtRankNoCopy (i));
+	  if (localPath->constraints ()) return false;
+	  PathVectorPtr_t pv = HPP_DYNAMIC_PTR_CAST (PathVector, localPath);
+	  if (pv && !parallelizable (pv)) return false;
+	}
+	return true;
+      }
+
+      bool validateSegments (const PathValidations_t& validations,
+			     const PathVectorPtr_t& path, bool reverse,
+			     PathPtr_t& validPart,
+			     PathValidationReportPtr_t& report)
+      {
+	const std::size_t n = path->numberPaths ();
+	std::size_t nbThreads = std::min (validations.size (), n);
+	SegmentsData data;
+	data.path = path.get ();
+	data.reverse = reverse;
+	data.next = 0;
+	data.firstInvalid = n;
+	data.validParts.resize (n);
+	data.reports.resize (n);
+	std::vector <std::string> errors (nbThreads);
+	boost::thread_group threads;
+	for (std::size_t k = 1; k < nbThreads; ++k) {
+	  threads.create_thread
+	    (boost::bind (&validateSegmentsWorker, validations [k].get (),
+			  &data, &errors [k]));
+	}
+	validateSegmentsWorker (validations [0].get (), &data, &errors [0]);
+	threads.join_all ();
+	for (std::size_t k = 0; k < nbThreads; ++k) {
+	  if (!errors [k].empty ()) throw std::runtime_error (errors [k]);
+	}
+	// Assemble the valid part as validation one segment after the other.
+	PathVectorPtr_t validPathVector = PathVector::create
+	  (path->outputSize (), path->outputDerivativeSize ());
+	validPart = validPathVector;
+	const std::size_t first = data.firstInvalid;
+	std::deque <PathPtr_t> paths;
+	value_type param = reverse ? path->length () : 0;
+	for (std::size_t rank = 0; rank < first; ++rank) {
+	  const PathPtr_t& localPath (data.validParts [rank]);
+	  if (reverse) {
+	    paths.push_front (localPath);
+	    param -= localPath->length ();
+	  } else {
+	    paths.push_back (localPath);
+	    param += localPath->length ();
+	  }
+	}
+	if (first < n) {
+	  report = data.reports [first];
+	  if (reverse) {
+	    report->parameter += param -
+	      path->pathAtRankNoCopy (n - 1 - first)->length ();
+	    paths.push_front (data.validParts [first]->copy ());
+	  } else {
+	    report->parameter += param;
+	    paths.push_back (data.validParts [first]->copy ());
+	  }
+	}
+	for (std::deque <PathPtr_t>::const_iterator it = paths.begin ();
+	     it != paths.end (); ++it) {
+	  validPathVector->appendPath (*it);
+	}
+	return first == n;
+      }
+
+      bool parallelizable (const Paths_t& paths)
+      {
+	for (Paths_t::const_iterator it = paths.begin (); it != paths.end ();
+	     ++it) {
+	  if ((*it)->constraints ()) return false;
+	  PathVectorPtr_t pv = HPP_DYNAMIC_PTR_CAST (PathVector, *it);
+	  if (pv && !parallelizable (pv)) return false;
+	}
+	return true;
+      }
+
+      void validatePaths (const PathValidations_t& validations,
+			  const Paths_t& paths, bool reverse, bool stopAtValid,
+			  Paths_t& validParts, std::vector <bool>& valid)
+      {
+	const std::size_t n = paths.size ();
+	std::size_t nbThreads = std::min (validations.size (), n);
+	PathsData data;
+	data.paths = &paths;
+	data.reverse = reverse;
+	data.next = 0;
+	data.stop = n;
+	data.stopAtValid = stopAtValid;
+	validParts.assign (n, PathPtr_t ());
+	data.validParts = &validParts;
+	data.valid.assign (n, false);
+	std::vector <std::string> errors (nbThreads);
+	boost::thread_group threads;
+	for (std::size_t k = 1; k < nbThreads; ++k) {
+	  threads.create_thread
+	    (boost::bind (&validatePathsWorker, validations [k].get (),
+			  &data, &errors [k]));
+	}
+	validatePathsWorker (validations [0].get (), &data, &errors [0]);
+	threads.join_all ();
+	for (std::size_t k = 0; k < nbThreads; ++k) {
+	  if (!errors [k].empty ()) throw std::runtime_error (errors [k]);
+	}
+	valid.assign (data.valid.begin (), data.valid.end ());
+      }
+    } // namespace continuousCollisionChecking
+  } // namespace core
+} // namespace hpp
@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_CONTINUOUS_COLLISION_CHECKING_SEGMENT_VALIDATION_HH
+# define HPP_CORE_CONTINUOUS_COLLISION_CHECKING_SEGMENT_VALIDATION_HH
+
+# include <vector>
+# include <hpp/core/fwd.hh>
+
+namespace hpp {
+  namespace core {
+    namespace continuousCollisionChecking {
+      typedef std::vector <PathValidationPtr_t> PathValidations_t;
+
+      /// Whether the segments of a path vector can be validated in parallel
+      ///
+      /// Evaluation of paths subject to constraints sets the configuration
+      /// of the robot of the constraints: such paths are validated by one
+      /// thread.
+      bool parallelizable (const PathVectorPtr_t& path);
+
+      /// Validate the segments of a path vector in parallel
+      ///
+      /// \param validations one path validation per thread, each with its
+      ///        own robot,
+      /// \param path, reverse, validPart, report see
+      ///        PathValidation::validate.
+      ///
+      /// Segments are distributed to the threads in validation order (from
+      /// the end if reverse). Segments after the first invalid one found
+      /// are not started. The valid part and the parameter of the report
+      /// are the same as if segments were validated one after the other.
+      bool validateSegments (const PathValidations_t& validations,
+			     const PathVectorPtr_t& path, bool reverse,
+			     PathPtr_t& validPart,
+			     PathValidationReportPtr_t& report);
+
+      /// Whether several paths can be validated in parallel
+      ///
+      /// Same condition as for the segments of a path vector, for each
+      /// path.
+      bool parallelizable (const Paths_t& paths);
+
+      /// Validate several paths in parallel
+      ///
+      /// \param validations one path validation per thread, each with its
+      ///        own robot,
+      /// \param paths, reverse, stopAtValid, validParts, valid see
+      ///        PathValidation::validateBatch.
+      ///
+      /// Paths are distributed to the threads in the order of the vector.
+      /// If stopAtValid, paths after the first valid path found are not
+      /// started, so that all the paths before the first valid path of the
+      /// vector are validated.
+      void validatePaths (const PathValidations_t& validations,
+			  const Paths_t& paths, bool reverse, bool stopAtValid,
+			  Paths_t& validParts, std::vector <bool>& valid);
+    } // namespace continuousCollisionChecking
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_CONTINUOUS_COLLISION_CHECKING_SEGMENT_VALIDATION_HH
@@ -0,0 +1,298 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_CONTINUOUS_COLLISION_CHECKING_VELOCITY_BOUNDS_HH
+# define HPP_CORE_CONTINUOUS_COLLISION_CHECKING_VELOCITY_BOUNDS_HH
+
+# include <algorithm>
+# include <cmath>
+# include <limits>
+# include <stdexcept>
+# include <vector>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/path.hh>
+
+namespace hpp {
+  namespace core {
+    namespace continuousCollisionChecking {
+      /// Upper bounds of the velocities of the degrees of freedom on
+      /// sub-intervals of equal length of a path
+      class PathVelocityBounds
+      {
+      public:
+	/// Number of sub-intervals of the paths
+	static const size_type numberPieces = 8;
+
+	PathVelocityBounds () : start_ (0), pieceLength_ (0), bounds_ ()
+	{
+	}
+
+	/// Compute bounds along a path
+	/// \throw std::runtime_error if the path does not provide velocity
+	///        bounds.
+	void compute (const PathPtr_t& path)
+	{
+	  start_ = path->timeRange ().first;
+	  pieceLength_ = path->length () / numberPieces;
+	  bounds_.resize (path->outputDerivativeSize (), numberPieces);
+	  for (size_type i = 0; i < numberPieces; ++i) {
+	    if (!path->velocityBound (bounds_.col (i),
+				      start_ + i * pieceLength_,
+				      start_ + (i + 1) * pieceLength_)) {
+	      throw std::runtime_error
+		("Path does not provide velocity bounds: it cannot be"
+		 " validated continuously.");
+	    }
+	  }
+	}
+
+	/// Get lower bound of the interval of definition of the path
+	value_type start () const
+	{
+	  return start_;
+	}
+	/// Get length of sub-intervals
+	value_type pieceLength () const
+	{
+	  return pieceLength_;
+	}
+	/// Get bounds of the degrees of freedom on a sub-interval
+	matrix_t::ConstColXpr bounds (size_type i) const
+	{
+	  return bounds_.col (i);
+	}
+
+      private:
+	value_type start_;
+	value_type pieceLength_;
+	matrix_t bounds_;
+      }; // class PathVelocityBounds
+
+      /// Upper bound of the velocity of the points of a body, piecewise
+      /// constant on the sub-intervals of PathVelocityBounds
+      class PiecewiseVelocity
+      {
+      public:
+	PiecewiseVelocity () : start_ (0), pieceLength_ (0), velocities_ ()
+	{
+	}
+
+	/// Set sub-intervals and reset velocities to 0
+	void reset (const PathVelocityBounds& bounds)
+	{
+	  start_ = bounds.start ();
+	  pieceLength_ = bounds.pieceLength ();
+	  velocities_.assign (PathVelocityBounds::numberPieces, 0);
+	}
+
+	/// Access velocity bound on a sub-interval
+	value_type& operator[] (size_type i)
+	{
+	  return velocities_ [i];
+	}
+
+	/// Maximal velocity over all sub-intervals
+	value_type maximal () const
+	{
+	  value_type result = 0;
+	  for (std::size_t i = 0; i < velocities_.size (); ++i) {
+	    if (velocities_ [i] > result) result = velocities_ [i];
+	  }
+	  return result;
+	}
+
+	/// Upper bound of the distance run by the points of the body
+	///
+	/// \param t parameter from which to move,
+	/// \param forward whether to move up to the end or to the beginning
+	///        of the path.
+	value_type distance (value_type t, bool forward) const
+	{
+	  value_type result = 0;
+	  for (std::size_t i = 0; i < velocities_.size (); ++i) {
+	    value_type begin = start_ + i * pieceLength_;
+	    value_type end = begin + pieceLength_;
+	    if (forward) begin = std::max (begin, t);
+	    else end = std::min (end, t);
+	    if (end > begin) result += velocities_ [i] * (end - begin);
+	  }
+	  return result;
+	}
+
+	/// Parameter reached by moving along the path up to a given distance
+	///
+	/// \param t parameter from which to move,
+	/// \param distance distance the points of the body may run,
+	/// \param forward whether to move towards increasing parameters.
+	/// \return the parameter closest to t after which points may have run
+	///         more than distance; +/- infinity if distance is not reached
+	///         before the end of the path.
+	value_type reach (value_type t, value_type distance, bool forward)
+	  const
+	{
+	  const value_type inf = std::numeric_limits <value_type>::infinity ();
+	  const value_type beyond = forward ? inf : -inf;
+	  if (distance == inf) return beyond;
+	  if (pieceLength_ <= 0) return beyond;
+	  long n = (long) velocities_.size ();
+	  long i = (long) floor ((t - start_) / pieceLength_);
+	  if (i < 0) i = 0;
+	  if (i >= n) i = n - 1;
+	  value_type s = t;
+	  while (true) {
+	    value_type v = velocities_ [i];
+	    value_type e = start_ + (forward ? i + 1 : i) * pieceLength_;
+	    value_type dt = fabs (e - s);
+	    if (v * dt >= distance) {
+	      if (v == 0) return s;
+	      return forward ? s + distance / v : s - distance / v;
+	    }
+	    distance -= v * dt;
+	    s = e;
+	    i += forward ? 1 : -1;
+	    if (i < 0 || i >= n) return beyond;
+	  }
+	}
+
+      private:
+	value_type start_;
+	value_type pieceLength_;
+	std::vector <value_type> velocities_;
+      }; // class PiecewiseVelocity
+
+      /// Upper bound of the velocity of the points of a body in the frame
+      /// of another body, as a function of the velocity bounds of the
+      /// joints of the kinematic chain between the bodies
+      ///
+      /// The terms of the bound are built once per pair of bodies and
+      /// sorted by number of degrees of freedom of the joint, so that the
+      /// norms of the velocity bounds of the joints are computed on
+      /// segments of size known at compile time for the common joints:
+      /// one for rotations and translations along an axis, three for SO(3)
+      /// joints and translations in space. Joints without degrees of
+      /// freedom, like anchor joints, do not contribute.
+      class ChainVelocity
+      {
+      public:
+	ChainVelocity () : terms1_ (), terms3_ (), terms_ ()
+	{
+	}
+
+	/// Remove all the joints
+	void clear ()
+	{
+	  terms1_.clear ();
+	  terms3_.clear ();
+	  terms_.clear ();
+	}
+
+	/// Add a joint of the chain
+	/// \param rank rank of the joint in the velocity of the robot,
+	/// \param size number of degrees of freedom of the joint,
+	/// \param coefficient multiplicative coefficient of the norm of the
+	///        velocity bounds of the joint.
+	void addJoint (size_type rank, size_type size, value_type coefficient)
+	{
+	  Term term;
+	  term.rank_ = rank;
+	  term.size_ = size;
+	  term.value_ = coefficient;
+	  switch (size) {
+	  case 0:
+	    break;
+	  case 1:
+	    terms1_.push_back (term);
+	    break;
+	  case 3:
+	    terms3_.push_back (term);
+	    break;
+	  default:
+	    terms_.push_back (term);
+	  }
+	}
+
+	/// Compute the velocity bound on each sub-interval
+	/// \param bounds velocity bounds of the degrees of freedom,
+	/// \retval velocity velocity of the points of the body, reset to the
+	///         sub-intervals of bounds.
+	void compute (const PathVelocityBounds& bounds,
+		      PiecewiseVelocity& velocity) const
+	{
+	  velocity.reset (bounds);
+	  for (size_type i = 0; i < PathVelocityBounds::numberPieces; ++i) {
+	    matrix_t::ConstColXpr b (bounds.bounds (i));
+	    velocity [i] = sum1 (terms1_, b) + sumFixed <3> (terms3_, b) +
+	      sumDynamic (terms_, b);
+	  }
+	}
+
+      private:
+	struct Term
+	{
+	  size_type rank_;
+	  size_type size_;
+	  value_type value_;
+	}; // struct Term
+	typedef std::vector <Term> Terms_t;
+
+	static value_type sum1 (const Terms_t& terms,
+			       const matrix_t::ConstColXpr& b)
+	{
+	  value_type result = 0;
+	  for (Terms_t::const_iterator it = terms.begin ();
+	       it != terms.end (); ++it) {
+	    result += it->value_ * fabs (b [it->rank_]);
+	  }
+	  return result;
+	}
+
+	template <int Size> static value_type sumFixed
+	  (const Terms_t& terms, const matrix_t::ConstColXpr& b)
+	{
+	  value_type result = 0;
+	  for (Terms_t::const_iterator it = terms.begin ();
+	       it != terms.end (); ++it) {
+	    result += it->value_ * b.segment <Size> (it->rank_).norm ();
+	  }
+	  return result;
+	}
+
+	static value_type sumDynamic (const Terms_t& terms,
+				      const matrix_t::ConstColXpr& b)
+	{
+	  value_type result = 0;
+	  for (Terms_t::const_iterator it = terms.begin ();
+	       it != terms.end (); ++it) {
+	    result += it->value_ * b.segment (it->rank_, it->size_).norm ();
+	  }
+	  return result;
+	}
+
+	/// Terms of the joints with one degree of freedom
+	Terms_t terms1_;
+	/// Terms of the joints with three degrees of freedom
+	Terms_t terms3_;
+	/// Terms of the other joints
+	Terms_t terms_;
+      }; // class ChainVelocity
+    } // namespace continuousCollisionChecking
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_CONTINUOUS_COLLISION_CHECKING_VELOCITY_BOUNDS_HH
@@ -16,6 +16,12 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <iterator>
+#include <utility>
+#include <boost/bind.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <hpp/util/debug.hh>
 #include <hpp/model/configuration.hh>
@@ -27,6 +33,7 @@
 #include <hpp/core/path.hh>
 #include <hpp/core/path-validation.hh>
 #include <hpp/core/problem.hh>
+#include <hpp/core/query-record.hh>
 #include <hpp/core/roadmap.hh>
 #include <hpp/core/steering-method.hh>
 #include <hpp/core/basic-configuration-shooter.hh>
@@ -51,7 +58,11 @@ namespace hpp {
     DiffusingPlanner::DiffusingPlanner (const Problem& problem):
       PathPlanner (problem),
       configurationShooter_ (problem.configurationShooter()),
-      qProj_ (problem.robot ()->configSize ())
+      goalBias_ (0), samples_ (problem.robot ()->configSize (), 16),
+      nextSample_ (samples_.cols ()),
+      q_rand_ (new Configuration_t (problem.robot ()->configSize ())),
+      qProj_ (problem.robot ()->configSize ()), weakPtr_ (),
+      generator_ (problem.drawSeed ()), extensionThreads_ ()
     {
     }
 
@@ -59,7 +70,11 @@ namespace hpp {
 					const RoadmapPtr_t& roadmap) :
       PathPlanner (problem, roadmap),
       configurationShooter_ (problem.configurationShooter()),
-      qProj_ (problem.robot ()->configSize ())
+      goalBias_ (0), samples_ (problem.robot ()->configSize (), 16),
+      nextSample_ (samples_.cols ()),
+      q_rand_ (new Configuration_t (problem.robot ()->configSize ())),
+      qProj_ (problem.robot ()->configSize ()), weakPtr_ (),
+      generator_ (problem.drawSeed ()), extensionThreads_ ()
     {
     }
 
@@ -71,33 +86,229 @@ namespace hpp {
 
     bool belongs (const ConfigurationPtr_t& q, const Nodes_t& nodes)
     {
+      const Configuration_t& config (*q);
       for (Nodes_t::const_iterator itNode = nodes.begin ();
 	   itNode != nodes.end (); ++itNode) {
-	if (*((*itNode)->configuration ()) == *q) return true;
+	if (*((*itNode)->configuration ()) == config) return true;
       }
       return false;
     }
 
+    namespace {
+      // Extend a node with the steering method and constraints of a problem
+      PathPtr_t extendNode (const Problem& problem, const NodePtr_t& near,
+			    const ConfigurationPtr_t& target,
+			    Configuration_t& qProj)
+      {
+	const SteeringMethodPtr_t& sm (problem.steeringMethod ());
+	const ConstraintSetPtr_t& constraints (sm->constraints ());
+	if (constraints) {
+	  ConfigProjectorPtr_t configProjector
+	    (constraints->configProjector ());
+	  if (configProjector) {
+	    configProjector->projectOnKernel (*(near->configuration ()),
+					      *target, qProj);
+	  } else {
+	    qProj = *target;
+	  }
+	  if (constraints->apply (qProj)) {
+	    return (*sm) (*(near->configuration ()), qProj);
+	  } else {
+	    return PathPtr_t ();
+	  }
+	}
+	return (*sm) (*(near->configuration ()), *target);
+      }
+    } // namespace
+
     PathPtr_t DiffusingPlanner::extend (const NodePtr_t& near,
 					const ConfigurationPtr_t& target)
     {
-      const SteeringMethodPtr_t& sm (problem ().steeringMethod ());
-      const ConstraintSetPtr_t& constraints (sm->constraints ());
-      if (constraints) {
-	ConfigProjectorPtr_t configProjector (constraints->configProjector ());
-	if (configProjector) {
-	  configProjector->projectOnKernel (*(near->configuration ()), *target,
-					    qProj_);
-	} else {
-	  qProj_ = *target;
+      return extendNode (problem (), near, target, qProj_);
+    }
+
+    /// Result of the extension of a node
+    struct DiffusingPlanner::Extension
+    {
+      Extension () : near (0x0), path (), validPath (), pathValid (false)
+      {
+      }
+      NodePtr_t near;
+      PathPtr_t path;
+      PathPtr_t validPath;
+      bool pathValid;
+    }; // struct DiffusingPlanner::Extension
+
+    namespace diffusingPlanner {
+      // Threads extending nodes with the objects of a problem each. The
+      // calling thread extends nodes with the first problem, the other
+      // problems are used by threads waiting for the next extension.
+      class ExtensionThreads
+      {
+      public:
+	ExtensionThreads (const std::vector <const Problem*>& problems) :
+	  problems_ (problems), qProj_ (), mutex_ (), started_ (),
+	  finished_ (), generation_ (0), running_ (0), stop_ (false),
+	  target_ (0x0), nodes_ (0x0), paths_ (), validPaths_ (),
+	  pathValid_ (problems.size ()), errors_ (problems.size ()),
+	  threads_ ()
+	{
+	  for (std::size_t k = 0; k < problems_.size (); ++k) {
+	    qProj_.push_back (Configuration_t
+			      (problems_ [k]->robot ()->configSize ()));
+	  }
+	  for (std::size_t k = 1; k < problems_.size (); ++k) {
+	    threads_.create_thread (boost::bind (&ExtensionThreads::work, this,
+						 k));
+	  }
+	}
+
+	~ExtensionThreads ()
+	{
+	  {
+	    boost::mutex::scoped_lock lock (mutex_);
+	    stop_ = true;
+	  }
+	  started_.notify_all ();
+	  threads_.join_all ();
+	}
+
+	const std::vector <const Problem*>& problems () const
+	{
+	  return problems_;
+	}
+
+	// Extend nodes toward target: node i is extended with problem
+	// i modulo the number of problems.
+	void extend (const ConfigurationPtr_t& target,
+		     const std::vector <NodePtr_t>& nodes)
+	{
+	  std::size_t nbThreads = problems_.size ();
+	  {
+	    boost::mutex::scoped_lock lock (mutex_);
+	    target_ = &target;
+	    nodes_ = &nodes;
+	    paths_.assign (nodes.size (), PathPtr_t ());
+	    validPaths_.assign (nodes.size (), PathPtr_t ());
+	    // std::vector <bool> packs bits: each thread writes in its own
+	    // vector of results.
+	    for (std::size_t k = 0; k < nbThreads; ++k) {
+	      pathValid_ [k].assign (nodes.size (), false);
+	    }
+	    errors_.assign (nbThreads, std::string ());
+	    running_ = nbThreads - 1;
+	    ++generation_;
+	  }
+	  started_.notify_all ();
+	  extendNodes (0);
+	  {
+	    boost::mutex::scoped_lock lock (mutex_);
+	    while (running_ > 0) finished_.wait (lock);
+	  }
+	  for (std::size_t k = 0; k < nbThreads; ++k) {
+	    if (!errors_ [k].empty ()) throw std::runtime_error (errors_ [k]);
+	  }
+	}
+
+	const PathPtr_t& path (std::size_t i) const
+	{
+	  return paths_ [i];
+	}
+
+	const PathPtr_t& validPath (std::size_t i) const
+	{
+	  return validPaths_ [i];
+	}
+
+	bool pathValid (std::size_t i) const
+	{
+	  return pathValid_ [i % problems_.size ()][i];
 	}
-	if (constraints->apply (qProj_)) {
-	  return (*sm) (*(near->configuration ()), qProj_);
-	} else {
-	  return PathPtr_t ();
+
+      private:
+	// Extend nodes k, k + nbThreads, ... of each extension
+	void work (std::size_t k)
+	{
+	  std::size_t generation = 0;
+	  while (true) {
+	    {
+	      boost::mutex::scoped_lock lock (mutex_);
+	      while (!stop_ && generation_ == generation) {
+		started_.wait (lock);
+	      }
+	      if (stop_) return;
+	      generation = generation_;
+	    }
+	    extendNodes (k);
+	    boost::mutex::scoped_lock lock (mutex_);
+	    if (--running_ == 0) finished_.notify_one ();
+	  }
+	}
+
+	// Extend nodes of rank k, k + nbThreads, ... with problem k
+	void extendNodes (std::size_t k)
+	{
+	  try {
+	    const Problem& problem (*problems_ [k]);
+	    PathValidationPtr_t pathValidation (problem.pathValidation ());
+	    for (std::size_t i = k; i < nodes_->size ();
+		 i += problems_.size ()) {
+	      paths_ [i] = extendNode (problem, (*nodes_) [i], *target_,
+				       qProj_ [k]);
+	      if (paths_ [i]) {
+		pathValid_ [k][i] = pathValidation->validateWithoutReport
+		  (paths_ [i], false, validPaths_ [i]);
+	      }
+	    }
+	  } catch (const std::exception& exc) {
+	    errors_ [k] = exc.what ();
+	  }
 	}
+
+	const std::vector <const Problem*> problems_;
+	// Projected configuration of each thread
+	std::vector <Configuration_t> qProj_;
+	boost::mutex mutex_;
+	boost::condition_variable started_;
+	boost::condition_variable finished_;
+	// Incremented at each extension
+	std::size_t generation_;
+	// Number of worker threads still extending nodes
+	std::size_t running_;
+	bool stop_;
+	const ConfigurationPtr_t* target_;
+	const std::vector <NodePtr_t>* nodes_;
+	std::vector <PathPtr_t> paths_;
+	std::vector <PathPtr_t> validPaths_;
+	std::vector <std::vector <bool> > pathValid_;
+	std::vector <std::string> errors_;
+	boost::thread_group threads_;
+      }; // class ExtensionThreads
+    } // namespace diffusingPlanner
+
+    void DiffusingPlanner::extendInParallel
+    (const NearestNodes_t& nearestNodes, const ConfigurationPtr_t& target,
+     Extensions_t& extensions) const
+    {
+      const std::vector <const Problem*>& problems (threadProblems ());
+      if (!extensionThreads_ || extensionThreads_->problems () != problems) {
+	extensionThreads_.reset ();
+	extensionThreads_.reset
+	  (new diffusingPlanner::ExtensionThreads (problems));
+      }
+      std::vector <NodePtr_t> nodes;
+      for (NearestNodes_t::const_iterator itNear = nearestNodes.begin ();
+	   itNear != nearestNodes.end (); ++itNear) {
+	nodes.push_back (itNear->second.first);
+      }
+      extensionThreads_->extend (target, nodes);
+      extensions.resize (nodes.size ());
+      for (std::size_t i = 0; i < nodes.size (); ++i) {
+	extensions [i].near = nodes [i];
+	extensions [i].path = extensionThreads_->path (i);
+	extensions [i].validPath = extensionThreads_->validPath (i);
+	extensions [i].pathValid = extensionThreads_->pathValid (i);
       }
-      return (*sm) (*(near->configuration ()), *target);
     }
 
 
@@ -124,6 +335,10 @@ namespace hpp {
     ///  Note that edges are actually added to the roadmap after step 2 in order
     ///  to avoid iterating on the list of connected components while modifying
     ///  this list.
+    ///
+    ///  If problems have been given to worker threads, steps 2.2 to 2.4 are
+    ///  computed in parallel, then step 2.5 inserts the results in the
+    ///  roadmap.
 
     void DiffusingPlanner::oneStep ()
     {
@@ -136,21 +351,39 @@ namespace hpp {
       Nodes_t newNodes;
       PathPtr_t validPath, path;
       // Pick a random node
-      ConfigurationPtr_t q_rand = configurationShooter_->shoot ();
+      ConfigurationPtr_t q_rand = sample ();
+      // Find nearest node of each connected component in one query
+      NearestNodes_t nearestNodes;
+      roadmap ()->nearestNodes (q_rand, nearestNodes);
       //
       // First extend each connected component toward q_rand
       //
-      for (ConnectedComponents_t::const_iterator itcc =
-	     roadmap ()->connectedComponents ().begin ();
-	   itcc != roadmap ()->connectedComponents ().end (); ++itcc) {
-	// Find nearest node in roadmap
-	value_type distance;
-	NodePtr_t near = roadmap ()->nearestNode (q_rand, *itcc, distance);
-	path = extend (near, q_rand);
+      Extensions_t extensions;
+      if (threadProblems ().empty ()) {
+	for (NearestNodes_t::const_iterator itNear = nearestNodes.begin ();
+	     itNear != nearestNodes.end (); ++itNear) {
+	  Extension extension;
+	  extension.near = itNear->second.first;
+	  RecordedEvent extensionEvent (QueryRecord::EXTENSION);
+	  extension.path = extend (extension.near, q_rand);
+	  if (extensionEvent.done (static_cast <bool> (extension.path))) {
+	    RecordedEvent validation (QueryRecord::PATH_VALIDATION);
+	    extension.pathValid = validation.done
+	      (pathValidation->validateWithoutReport
+	       (extension.path, false, extension.validPath));
+	  }
+	  extensions.push_back (extension);
+	}
+      } else {
+	extendInParallel (nearestNodes, q_rand, extensions);
+      }
+      for (Extensions_t::const_iterator itExt = extensions.begin ();
+	   itExt != extensions.end (); ++itExt) {
+	NodePtr_t near = itExt->near;
+	path = itExt->path;
 	if (path) {
-	  PathValidationReportPtr_t report;
-	  bool pathValid = pathValidation->validate (path, false, validPath,
-						     report);
+	  bool pathValid = itExt->pathValid;
+	  validPath = itExt->validPath;
 	  // Insert new path to q_near in roadmap
 	  value_type t_final = validPath->timeRange ().second;
 	  if (t_final != path->timeRange ().first) {
@@ -187,6 +420,33 @@ namespace hpp {
       // Second, try to connect new nodes together
       //
       const SteeringMethodPtr_t& sm (problem ().steeringMethod ());
+      if (pathValidation->numberThreads () <= 1) {
+	for (Nodes_t::const_iterator itn1 = newNodes.begin ();
+	     itn1 != newNodes.end (); ++itn1) {
+	  for (Nodes_t::const_iterator itn2 = boost::next (itn1);
+	       itn2 != newNodes.end (); ++itn2) {
+	    ConfigurationPtr_t q1 ((*itn1)->configuration ());
+	    ConfigurationPtr_t q2 ((*itn2)->configuration ());
+	    assert (*q1 != *q2);
+	    // Most of these paths are rejected, the same path is reused until
+	    // one is inserted in the roadmap.
+	    if ((*sm) (*q1, *q2, path) &&
+		pathValidation->validateWithoutReport (path, false,
+						       validPath)) {
+	      roadmap ()->addEdge (*itn1, *itn2, path);
+	      interval_t timeRange = path->timeRange ();
+	      roadmap ()->addEdge (*itn2, *itn1, path->extract
+				   (interval_t (timeRange.second,
+						timeRange.first)));
+	    }
+	  }
+	}
+	return;
+      }
+      // Candidate edges are validated in one batch by several threads.
+      typedef std::pair <NodePtr_t, NodePtr_t> NodePair_t;
+      std::vector <NodePair_t> pairs;
+      Paths_t paths;
       for (Nodes_t::const_iterator itn1 = newNodes.begin ();
 	   itn1 != newNodes.end (); ++itn1) {
 	for (Nodes_t::const_iterator itn2 = boost::next (itn1);
@@ -195,23 +455,63 @@ namespace hpp {
 	  ConfigurationPtr_t q2 ((*itn2)->configuration ());
 	  assert (*q1 != *q2);
 	  path = (*sm) (*q1, *q2);
-	  PathValidationReportPtr_t report;
-	  if (path && pathValidation->validate (path, false, validPath,
-						report)) {
-	    roadmap ()->addEdge (*itn1, *itn2, path);
-	    interval_t timeRange = path->timeRange ();
-	    roadmap ()->addEdge (*itn2, *itn1, path->extract
-				 (interval_t (timeRange.second,
-					      timeRange.first)));
+	  if (path) {
+	    pairs.push_back (NodePair_t (*itn1, *itn2));
+	    paths.push_back (path);
 	  }
 	}
       }
+      if (paths.empty ()) return;
+      Paths_t validPaths;
+      std::vector <bool> valid;
+      pathValidation->validateBatch (paths, false, false, validPaths, valid);
+      for (std::size_t i = 0; i < paths.size (); ++i) {
+	if (!valid [i]) continue;
+	roadmap ()->addEdge (pairs [i].first, pairs [i].second, paths [i]);
+	interval_t timeRange = paths [i]->timeRange ();
+	roadmap ()->addEdge (pairs [i].second, pairs [i].first,
+			     paths [i]->extract
+			     (interval_t (timeRange.second, timeRange.first)));
+      }
     }
 
     void DiffusingPlanner::configurationShooter
     (const ConfigurationShooterPtr_t& shooter)
     {
       configurationShooter_ = shooter;
+      // Discard configurations shot by the previous shooter
+      nextSample_ = samples_.cols ();
+    }
+
+    void DiffusingPlanner::samplingBatchSize (size_type size)
+    {
+      if (size <= 0) {
+	throw std::runtime_error ("Sampling batch size should be positive.");
+      }
+      samples_.resize (samples_.rows (), size);
+      nextSample_ = size;
+    }
+
+    const ConfigurationPtr_t& DiffusingPlanner::sample ()
+    {
+      RecordedEvent event (QueryRecord::SAMPLE);
+      const Nodes_t& goalNodes (roadmap ()->goalNodes ());
+      if (goalBias_ > 0 && !goalNodes.empty () &&
+	  (value_type) generator_ () / 4294967296. < goalBias_) {
+	Nodes_t::const_iterator itGoal = goalNodes.begin ();
+	std::advance (itGoal, generator_ () % goalNodes.size ());
+	*q_rand_ = *((*itGoal)->configuration ());
+	event.done (true);
+	return q_rand_;
+      }
+      if (nextSample_ == samples_.cols ()) {
+	configurationShooter_->shoot (samples_);
+	nextSample_ = 0;
+      }
+      *q_rand_ = samples_.col (nextSample_);
+      ++nextSample_;
+      event.done (true);
+      return q_rand_;
     }
 
 
@@ -16,11 +16,20 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <hpp/fcl/collision.h>
+#include <hpp/fcl/collision_data.h>
+#include <hpp/model/body.hh>
+#include <hpp/model/collision-object.hh>
 #include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
 #include <hpp/core/collision-path-validation-report.hh>
 #include <hpp/core/collision-validation.hh>
 #include <hpp/core/path.hh>
 #include <hpp/core/discretized-collision-checking.hh>
+#include <hpp/core/operation-counters.hh>
 
 namespace hpp {
   namespace core {
@@ -48,10 +57,28 @@ namespace hpp {
       return DiscretizedCollisionCheckingPtr_t (ptr);
     }
 
+    PathValidationPtr_t DiscretizedCollisionChecking::copy
+    (const DevicePtr_t& robot) const
+    {
+      ConfigValidationPtr_t configValidation (configValidation_->copy (robot));
+      if (!configValidation) return PathValidationPtr_t ();
+      DiscretizedCollisionCheckingPtr_t other =
+	createWithValidation (robot, stepSize_, unusedReport_,
+			      configValidation);
+      other->order_ = order_;
+      other->adaptiveStep_ = adaptiveStep_;
+      return other;
+    }
+
     void DiscretizedCollisionChecking::addObstacle
     (const CollisionObjectPtr_t& object)
     {
       configValidation_->addObstacle (object);
+      const JointVector_t& jv = robot_->getJointVector ();
+      for (JointVector_t::const_iterator itJoint = jv.begin ();
+	   itJoint != jv.end (); ++itJoint) {
+	addDistancePairs (object, *itJoint);
+      }
     }
 
     bool DiscretizedCollisionChecking::validate
@@ -69,129 +96,297 @@ namespace hpp {
       PathValidationReport& report =
       static_cast <PathValidationReport&> (validationReport);
       assert (path);
-      bool valid = true;
+      value_type tmin = path->timeRange ().first;
+      value_type tmax = path->timeRange ().second;
+      std::vector <value_type>& params (params_);
+      bool evaluated;
+      std::size_t firstInvalid = findInvalid (path, reverse, false, params, q_,
+					      evaluated);
+      if (firstInvalid == params.size ()) {
+	validPart = path;
+	return true;
+      }
+      report.parameter = params [firstInvalid];
+      if (evaluated) {
+	// Validate again to fill the report
+	configValidation_->validate (q_, *report.configurationReport, false);
+      }
       if (reverse) {
-	value_type tmin = path->timeRange ().first;
-	value_type tmax = path->timeRange ().second;
-	value_type lastValidTime = tmax;
-	value_type t = tmax;
-	unsigned finished = 0;
-	while (finished < 2 && valid) {
-	  Configuration_t q = (*path) (t);
-      if (!configValidation_->validate (q, *report.configurationReport, false)) {
-	    report.parameter = t;	    
-	    valid = false;
-	  } else {
-	    lastValidTime = t;
-	    t -= stepSize_;
-	  }
-	  if (t < tmin) {
-	    t = tmin;
-	    finished++;
-	  }
-	}
-	if (valid) {
-	  validPart = path;
-	  return true;
-	} else {
-	  validPart = path->extract (std::make_pair (lastValidTime, tmax));
-	  return false;
-	}
+	value_type lastValidTime = firstInvalid > 0 ?
+	  params [firstInvalid - 1] : tmax;
+	validPart = path->extract (std::make_pair (lastValidTime, tmax));
       } else {
-	value_type tmin = path->timeRange ().first;
-	value_type tmax = path->timeRange ().second;
-	value_type lastValidTime = tmin;
-	value_type t = tmin;
-	unsigned finished = 0;
-	while (finished < 2 && valid) {
-	  Configuration_t q = (*path) (t);
-      if (!configValidation_->validate (q, *report.configurationReport, false)) {
-	    report.parameter = t;	    
-	    valid = false;
-	  } else {
-	    lastValidTime = t;
-	    t += stepSize_;
-	  }
-	  if (t > tmax) {
-	    t = tmax;
-	    finished ++;
-	  }
-	}
-	if (valid) {
-	  validPart = path;
-	  return true;
-	} else {
-	  validPart = path->extract (std::make_pair (tmin, lastValidTime));
-	  return false;
-	}
+	value_type lastValidTime = firstInvalid > 0 ?
+	  params [firstInvalid - 1] : tmin;
+	validPart = path->extract (std::make_pair (tmin, lastValidTime));
       }
+      return false;
     }
 
     bool DiscretizedCollisionChecking::validate
     (const PathPtr_t& path, bool reverse, PathPtr_t& validPart,
      PathValidationReportPtr_t& validationReport)
     {
+      // Reuse reports if nobody else refers to them
+      CollisionPathValidationReportPtr_t report;
+      if (validationReport.unique ()) {
+	report = HPP_DYNAMIC_PTR_CAST (CollisionPathValidationReport,
+				       validationReport);
+      }
       ValidationReportPtr_t configReport;
+      if (report) configReport.swap (report->configurationReport);
       assert (path);
-      bool valid = true;
-      if (reverse) {
-	value_type tmin = path->timeRange ().first;
-	value_type tmax = path->timeRange ().second;
-	value_type lastValidTime = tmax;
-	value_type t = tmax;
-	unsigned finished = 0;
-        Configuration_t q (path->outputSize());
-	while (finished < 2 && valid) {
-          bool success = (*path) (q, t);
-      if (!success || !configValidation_->validate (q, configReport)) {
-	validationReport = CollisionPathValidationReportPtr_t
+      value_type tmin = path->timeRange ().first;
+      value_type tmax = path->timeRange ().second;
+      std::vector <value_type>& params (params_);
+      bool evaluated;
+      std::size_t firstInvalid = findInvalid (path, reverse, false, params, q_,
+					      evaluated);
+      if (firstInvalid == params.size ()) {
+	// Give back configuration report taken above
+	if (report) report->configurationReport.swap (configReport);
+	validPart = path;
+	return true;
+      }
+      value_type t = params [firstInvalid];
+      if (evaluated) {
+	// Validate again to get the report
+	configValidation_->validate (q_, configReport);
+      }
+      if (report) {
+	report->parameter = t;
+	report->configurationReport = configReport;
+      } else {
+	report = CollisionPathValidationReportPtr_t
 	  (new CollisionPathValidationReport (t, configReport));
-	    valid = false;
-	  } else {
-	    lastValidTime = t;
-	    t -= stepSize_;
-	  }
-	  if (t < tmin) {
-	    t = tmin;
-	    finished++;
+      }
+      validationReport = report;
+      if (reverse) {
+	value_type lastValidTime = firstInvalid > 0 ?
+	  params [firstInvalid - 1] : tmax;
+	validPart = path->extract (std::make_pair (lastValidTime, tmax));
+      } else {
+	value_type lastValidTime = firstInvalid > 0 ?
+	  params [firstInvalid - 1] : tmin;
+	validPart = path->extract (std::make_pair (tmin, lastValidTime));
+      }
+      return false;
+    }
+
+    bool DiscretizedCollisionChecking::isValid (const PathPtr_t& path)
+    {
+      assert (path);
+      std::vector <value_type>& params (params_);
+      bool evaluated;
+      return findInvalid (path, false, true, params, q_, evaluated) ==
+	params.size ();
+    }
+
+    void DiscretizedCollisionChecking::parameters
+    (const PathPtr_t& path, bool reverse, std::vector <value_type>& params)
+      const
+    {
+      value_type tmin = path->timeRange ().first;
+      value_type tmax = path->timeRange ().second;
+      params.clear ();
+      if (reverse) {
+	for (value_type t = tmax; t > tmin; t -= stepSize_) params.push_back (t);
+	params.push_back (tmin);
+      } else {
+	for (value_type t = tmin; t < tmax; t += stepSize_) params.push_back (t);
+	params.push_back (tmax);
+      }
+    }
+
+    std::size_t DiscretizedCollisionChecking::findInvalid
+    (const PathPtr_t& path, bool reverse, bool stopAtFirst,
+     std::vector <value_type>& params, Configuration_t& q, bool& evaluated)
+    {
+      // Configurations are written in q without allocation
+      q.resize (path->outputSize ());
+      evaluated = false;
+      if (adaptiveStep_ && computeVelocities (path)) {
+	return findInvalidAdaptive (path, reverse, params, q, evaluated);
+      }
+      parameters (path, reverse, params);
+      std::size_t n = params.size ();
+      if (order_ == LINEAR) {
+	// Configurations are computed first and validated in one batch.
+	// A failure to compute a configuration is handled as an invalid
+	// configuration.
+	matrix_t& configurations (configurations_);
+	configurations.resize (path->outputSize (), n);
+	std::vector <bool>& computed (computed_);
+	path->eval (Eigen::Map <const vector_t> (&params [0], n),
+		    configurations, computed);
+	std::size_t nbConfigs = std::find (computed.begin (), computed.end (),
+					   false) - computed.begin ();
+	if (nbConfigs == 0) return 0;
+	configurations.conservativeResize (Eigen::NoChange, nbConfigs);
+	std::vector <bool> valid;
+	if (configValidation_->validateBatch (configurations, valid, true)) {
+	  return nbConfigs;
+	}
+	std::size_t result = std::find (valid.begin (), valid.end (), false) -
+	  valid.begin ();
+	q = configurations.col (result);
+	evaluated = true;
+	return result;
+      }
+      // Van der Corput order: bit reversed index of 0, 1, 2,... over the
+      // smallest power of two not less than the number of configurations.
+      std::size_t bits = 0;
+      while (((std::size_t) 1 << bits) < n) ++bits;
+      if (indices_.size () != n) {
+	indices_.clear ();
+	for (std::size_t i = 0; i < ((std::size_t) 1 << bits); ++i) {
+	  std::size_t index = 0;
+	  for (std::size_t b = 0; b < bits; ++b) {
+	    if (i & ((std::size_t) 1 << b)) {
+	      index |= (std::size_t) 1 << (bits - 1 - b);
+	    }
 	  }
+	  if (index < n) indices_.push_back (index);
 	}
-	if (valid) {
-	  validPart = path;
-	  return true;
+      }
+      std::size_t result = n;
+      for (std::vector <std::size_t>::const_iterator it = indices_.begin ();
+	   it != indices_.end (); ++it) {
+	// Only configurations before the first invalid one found so far
+	// matter for the valid part.
+	if (*it >= result) continue;
+	if (!(*path) (q, params [*it])) {
+	  result = *it;
+	  evaluated = false;
+	} else if (!configValidation_->isValid (q)) {
+	  result = *it;
+	  evaluated = true;
+	  invalidConfig_ = q;
 	} else {
-	  validPart = path->extract (std::make_pair (lastValidTime, tmax));
-	  return false;
+	  continue;
 	}
-      } else {
-	value_type tmin = path->timeRange ().first;
-	value_type tmax = path->timeRange ().second;
-	value_type lastValidTime = tmin;
-	value_type t = tmin;
-	unsigned finished = 0;
-        Configuration_t q (path->outputSize());
-	while (finished < 2 && valid) {
-	  bool success = (*path) (q, t);
-      if (!success || !configValidation_->validate (q, configReport)) {
-	validationReport = CollisionPathValidationReportPtr_t
-	  (new CollisionPathValidationReport (t, configReport));
-	    valid = false;
-	  } else {
-	    lastValidTime = t;
-	    t += stepSize_;
-	  }
-	  if (t > tmax) {
-	    t = tmax;
-	    finished ++;
-	  }
+	if (stopAtFirst) break;
+      }
+      if (evaluated) q = invalidConfig_;
+      return result;
+    }
+
+    bool DiscretizedCollisionChecking::computeVelocities
+    (const PathPtr_t& path)
+    {
+      vector_t& bound (velocityBound_);
+      bound.resize (path->outputDerivativeSize ());
+      if (!path->velocityBound (bound, path->timeRange ().first,
+				path->timeRange ().second)) {
+	return false;
+      }
+      for (MovingBodies_t::iterator itBody = movingBodies_.begin ();
+	   itBody != movingBodies_.end (); ++itBody) {
+	itBody->velocity = 0;
+	for (std::vector <CoefficientVelocity_t>::const_iterator itCoef =
+	       itBody->coefficients.begin ();
+	     itCoef != itBody->coefficients.end (); ++itCoef) {
+	  const JointConstPtr_t& joint = itCoef->first;
+	  itBody->velocity += itCoef->second * bound.segment
+	    (joint->rankInVelocity (), joint->numberDof ()).norm ();
+	}
+      }
+      return true;
+    }
+
+    std::size_t DiscretizedCollisionChecking::findInvalidAdaptive
+    (const PathPtr_t& path, bool reverse, std::vector <value_type>& params,
+     Configuration_t& q, bool& evaluated)
+    {
+      value_type tmin = path->timeRange ().first;
+      value_type tmax = path->timeRange ().second;
+      params.clear ();
+      value_type t = reverse ? tmax : tmin;
+      while (true) {
+	params.push_back (t);
+	if (!(*path) (q, t)) return params.size () - 1;
+	if (!configValidation_->isValid (q)) {
+	  evaluated = true;
+	  return params.size () - 1;
 	}
-	if (valid) {
-	  validPart = path;
-	  return true;
+	if (t == (reverse ? tmin : tmax)) return params.size ();
+	// Fall back to the fixed step close to obstacles
+	value_type step = std::max (stepSize_, safeStep (q));
+	if (reverse) {
+	  t = std::max (t - step, tmin);
 	} else {
-	  validPart = path->extract (std::make_pair (tmin, lastValidTime));
-	  return false;
+	  t = std::min (t + step, tmax);
+	}
+      }
+    }
+
+    value_type DiscretizedCollisionChecking::safeStep
+    (const Configuration_t& config)
+    {
+      using std::numeric_limits;
+      robot_->currentConfiguration (config);
+      robot_->computeForwardKinematics ();
+      fcl::CollisionRequest request (1, false, true, 1, false, true,
+				     fcl::GST_INDEP);
+      fcl::CollisionResult result;
+      value_type step = numeric_limits <value_type>::infinity ();
+      for (DistancePairs_t::const_iterator itPair = distancePairs_.begin ();
+	   itPair != distancePairs_.end (); ++itPair) {
+	value_type velocity = movingBodies_ [itPair->body1].velocity;
+	if (itPair->body2 < movingBodies_.size ()) {
+	  velocity += movingBodies_ [itPair->body2].velocity;
 	}
+	if (velocity == 0) continue;
+	result.clear ();
+	OperationCounters::increment (OperationCounters::NARROW_PHASE);
+	fcl::collide (itPair->object1->fcl ().get (),
+		      itPair->object2->fcl ().get (), request, result);
+	if (result.isCollision ()) return 0;
+	step = std::min (step, result.distance_lower_bound / velocity);
+      }
+      return step;
+    }
+
+    std::size_t DiscretizedCollisionChecking::movingBody
+    (const JointConstPtr_t& joint)
+    {
+      for (std::size_t i = 0; i < movingBodies_.size (); ++i) {
+	if (movingBodies_ [i].joint == joint) return i;
+      }
+      // Velocity of the points of the body is bounded by the sum over the
+      // ancestors of the joint of the linear velocity plus the angular
+      // velocity times the maximal distance to the body.
+      MovingBody body;
+      body.joint = joint;
+      body.velocity = 0;
+      value_type cumulativeLength = joint->linkedBody ()->radius ();
+      for (JointConstPtr_t child = joint; child;
+	   child = child->parentJoint ()) {
+	body.coefficients.push_back
+	  (CoefficientVelocity_t (child, child->upperBoundLinearVelocity () +
+				  cumulativeLength *
+				  child->upperBoundAngularVelocity ()));
+	cumulativeLength += child->maximalDistanceToParent ();
+      }
+      movingBodies_.push_back (body);
+      return movingBodies_.size () - 1;
+    }
+
+    void DiscretizedCollisionChecking::addDistancePairs
+    (const CollisionObjectPtr_t& object, const JointConstPtr_t& joint)
+    {
+      BodyPtr_t body = joint->linkedBody ();
+      if (!body) return;
+      const ObjectVector_t& objects = body->innerObjects (model::COLLISION);
+      std::size_t index = movingBody (joint);
+      for (ObjectVector_t::const_iterator it = objects.begin ();
+	   it != objects.end (); ++it) {
+	DistancePair pair;
+	pair.object1 = *it;
+	pair.object2 = object;
+	pair.body1 = index;
+	pair.body2 = std::numeric_limits <std::size_t>::max ();
+	distancePairs_.push_back (pair);
       }
     }
 
@@ -201,9 +396,37 @@ namespace hpp {
 				    const ConfigValidationPtr_t& configValidation) :
       PathValidation (), robot_ (robot),
       configValidation_ (configValidation),
-      stepSize_ (stepSize),
+      stepSize_ (stepSize), order_ (LINEAR), indices_ (), params_ (),
+      configurations_ (), computed_ (), invalidConfig_ (), q_ (),
+      adaptiveStep_ (false),
+      movingBodies_ (), distancePairs_ (), velocityBound_ (),
       unusedReport_(defaultValidationReport)
     {
+      // Pairs of bodies of the robot used by adaptive step
+      typedef model::Device::CollisionPairs_t JointPairs_t;
+      const JointPairs_t& jointPairs (robot->collisionPairs (model::COLLISION));
+      for (JointPairs_t::const_iterator itPair = jointPairs.begin ();
+	   itPair != jointPairs.end (); ++itPair) {
+	BodyPtr_t body1 = itPair->first->linkedBody ();
+	BodyPtr_t body2 = itPair->second->linkedBody ();
+	if (!body1 || !body2) continue;
+	std::size_t index1 = movingBody (itPair->first);
+	std::size_t index2 = movingBody (itPair->second);
+	const ObjectVector_t& objects1 = body1->innerObjects (model::COLLISION);
+	const ObjectVector_t& objects2 = body2->innerObjects (model::COLLISION);
+	for (ObjectVector_t::const_iterator it1 = objects1.begin ();
+	     it1 != objects1.end (); ++it1) {
+	  for (ObjectVector_t::const_iterator it2 = objects2.begin ();
+	       it2 != objects2.end (); ++it2) {
+	    DistancePair pair;
+	    pair.object1 = *it1;
+	    pair.object2 = *it2;
+	    pair.body1 = index1;
+	    pair.body2 = index2;
+	    distancePairs_.push_back (pair);
+	  }
+	}
+      }
     }
 
     void DiscretizedCollisionChecking::removeObstacleFromJoint (const JointPtr_t& joint,
@@ -211,6 +434,45 @@ namespace hpp {
     {
       assert (configValidation_);
       configValidation_->removeObstacleFromJoint (joint, obstacle);
+      for (DistancePairs_t::iterator itPair = distancePairs_.begin ();
+	   itPair != distancePairs_.end ();) {
+	if (itPair->object2 == obstacle &&
+	    movingBodies_ [itPair->body1].joint == joint) {
+	  itPair = distancePairs_.erase (itPair);
+	} else {
+	  ++itPair;
+	}
+      }
+    }
+
+    void DiscretizedCollisionChecking::removeObstacle
+    (const CollisionObjectPtr_t& object)
+    {
+      assert (configValidation_);
+      configValidation_->removeObstacle (object);
+      for (DistancePairs_t::iterator itPair = distancePairs_.begin ();
+	   itPair != distancePairs_.end ();) {
+	if (itPair->object2 == object) {
+	  itPair = distancePairs_.erase (itPair);
+	} else {
+	  ++itPair;
+	}
+      }
+    }
+
+    void DiscretizedCollisionChecking::obstacleMoved
+    (const CollisionObjectPtr_t& object)
+    {
+      assert (configValidation_);
+      // Distance pairs read the current position of the obstacle.
+      configValidation_->obstacleMoved (object);
+    }
+
+    void DiscretizedCollisionChecking::distanceField
+    (const DistanceFieldPtr_t& field)
+    {
+      assert (configValidation_);
+      configValidation_->distanceField (field);
     }
   } // namespace core
 } // namespace hpp
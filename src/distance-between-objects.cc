@@ -16,6 +16,10 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <set>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
 #include <hpp/fcl/distance.h>
 
 #include <hpp/model/collision-object.hh>
@@ -31,6 +35,9 @@ namespace hpp {
     (const CollisionObjectPtr_t& object)
     {
       using model::DISTANCE;
+      object->fcl ()->computeAABB ();
+      std::set <fcl::CollisionObject*> inner (innerObjects_.begin (),
+					      innerObjects_.end ());
       const JointVector_t& jv = robot_->getJointVector ();
       for (JointVector_t::const_iterator it = jv.begin (); it != jv.end ();
 	   ++it) {
@@ -40,13 +47,40 @@ namespace hpp {
 	  const ObjectVector_t& bodyObjects = body->innerObjects (DISTANCE);
 	  for (ObjectVector_t::const_iterator itInner = bodyObjects.begin ();
 	       itInner != bodyObjects.end (); ++itInner) {
-	    collisionPairs_.push_back (CollisionPair_t (*itInner, object));
+	    collisionPairs_.push_back (FclCollisionPair_t
+				       ((*itInner)->fcl ().get (),
+					object->fcl ().get ()));
 	    distanceResults_.push_back (DistanceResult ());
+	    distanceResults_.back ().innerObject = *itInner;
+	    distanceResults_.back ().outerObject = object;
+	    if (inner.insert ((*itInner)->fcl ().get ()).second) {
+	      innerObjects_.push_back ((*itInner)->fcl ().get ());
+	    }
 	  }
 	}
       }
     }
 
+    void DistanceBetweenObjects::removeObstacle
+    (const CollisionObjectPtr_t& object)
+    {
+      std::size_t j = 0;
+      for (std::size_t i = 0; i < distanceResults_.size (); ++i) {
+	if (distanceResults_ [i].outerObject == object) continue;
+	collisionPairs_ [j] = collisionPairs_ [i];
+	distanceResults_ [j] = distanceResults_ [i];
+	++j;
+      }
+      collisionPairs_.resize (j);
+      distanceResults_.resize (j);
+    }
+
+    void DistanceBetweenObjects::obstacleMoved
+    (const CollisionObjectPtr_t& object)
+    {
+      object->fcl ()->computeAABB ();
+    }
+
     void DistanceBetweenObjects::obstacles (const ObjectVector_t& obstacles)
     {
       for (ObjectVector_t::const_iterator itObj = obstacles.begin ();
@@ -57,23 +91,57 @@ namespace hpp {
 
     void DistanceBetweenObjects::computeDistances ()
     {
-      DistanceResults_t::size_type offset = 0;
+      if (distanceThreshold_ != std::numeric_limits <value_type>::infinity ()) {
+	for (std::vector <fcl::CollisionObject*>::const_iterator it =
+	       innerObjects_.begin (); it != innerObjects_.end (); ++it) {
+	  (*it)->computeAABB ();
+	}
+      }
+      std::size_t n = collisionPairs_.size ();
+      std::size_t nbThreads = std::min (numberThreads_, n);
+      if (nbThreads <= 1) {
+	computeDistances (0, n);
+	return;
+      }
+      std::size_t chunk = (n + nbThreads - 1) / nbThreads;
+      boost::thread_group threads;
+      for (std::size_t begin = chunk; begin < n; begin += chunk) {
+	threads.create_thread
+	  (boost::bind (static_cast <void (DistanceBetweenObjects::*)
+			(std::size_t, std::size_t)>
+			(&DistanceBetweenObjects::computeDistances), this,
+			begin, std::min (n, begin + chunk)));
+      }
+      // The calling thread computes the first range
+      computeDistances (0, std::min (n, chunk));
+      threads.join_all ();
+    }
+
+    void DistanceBetweenObjects::computeDistances (std::size_t begin,
+						   std::size_t end)
+    {
+      bool threshold =
+	(distanceThreshold_ != std::numeric_limits <value_type>::infinity ());
       fcl::DistanceRequest distanceRequest (true, 0, 0, fcl::GST_INDEP);
-      for (CollisionPairs_t::const_iterator itCol = collisionPairs_.begin ();
-	   itCol != collisionPairs_.end (); ++itCol) {
-	distanceResults_ [offset].fcl.clear ();
-	const CollisionObjectPtr_t& obj1 = itCol->first;
-	const CollisionObjectPtr_t& obj2 = itCol->second;
-	fcl::distance (obj1->fcl ().get (), obj2->fcl ().get (),
-		       distanceRequest, distanceResults_ [offset].fcl);
-	distanceResults_ [offset].innerObject = obj1;
-	distanceResults_ [offset].outerObject = obj2;
-	++offset;
+      for (std::size_t i = begin; i < end; ++i) {
+	distanceResults_ [i].fcl.clear ();
+	if (threshold) {
+	  value_type lowerBound = collisionPairs_ [i].first->getAABB ().distance
+	    (collisionPairs_ [i].second->getAABB ());
+	  if (lowerBound > distanceThreshold_) {
+	    distanceResults_ [i].fcl.min_distance = lowerBound;
+	    continue;
+	  }
+	}
+	fcl::distance (collisionPairs_ [i].first, collisionPairs_ [i].second,
+		       distanceRequest, distanceResults_ [i].fcl);
       }
     }
 
     DistanceBetweenObjects::DistanceBetweenObjects  (const DevicePtr_t& robot) :
-      robot_ (robot)
+      robot_ (robot), collisionPairs_ (), distanceResults_ (),
+      innerObjects_ (), numberThreads_ (1),
+      distanceThreshold_ (std::numeric_limits <value_type>::infinity ())
     {
     }
   } // namespace core
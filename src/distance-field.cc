@@ -0,0 +1,183 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <hpp/fcl/collision_object.h>
+#include <hpp/fcl/distance.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/model/collision-object.hh>
+#include <hpp/core/distance-field.hh>
+
+namespace hpp {
+  namespace core {
+    namespace {
+      // Voxels between the bounding box of the obstacles and the outside
+      // of the grid
+      const size_type marginVoxels = 4;
+      const size_type maxVoxels = 1 << 24;
+    } // namespace
+
+    DistanceFieldPtr_t DistanceField::create (const ObjectVector_t& obstacles,
+					      value_type resolution)
+    {
+      if (!(resolution > 0)) {
+	throw std::invalid_argument
+	  ("Resolution of the distance field should be positive.");
+      }
+      DistanceField* ptr = new DistanceField (obstacles, resolution);
+      DistanceFieldPtr_t shPtr (ptr);
+      ptr->compute ();
+      return shPtr;
+    }
+
+    DistanceField::DistanceField (const ObjectVector_t& obstacles,
+				  value_type resolution) :
+      obstacles_ (obstacles), fclObstacles_ (), resolution_ (resolution),
+      margin_ ((value_type) marginVoxels * resolution), values_ ()
+    {
+      for (ObjectVector_t::const_iterator it = obstacles_.begin ();
+	   it != obstacles_.end (); ++it) {
+	fclObstacles_.insert ((*it)->fcl ().get ());
+      }
+    }
+
+    bool DistanceField::contains (const CollisionObjectPtr_t& object) const
+    {
+      return fclObstacles_.count (object->fcl ().get ()) != 0;
+    }
+
+    size_type DistanceField::voxel (std::size_t axis,
+				    value_type coordinate) const
+    {
+      value_type rank = std::floor ((coordinate - origin_ [axis]) /
+				    resolution_);
+      if (rank < 0) return 0;
+      if (rank >= (value_type) size_ [axis]) return size_ [axis] - 1;
+      return (size_type) rank;
+    }
+
+    void DistanceField::compute ()
+    {
+      const value_type inf = std::numeric_limits <value_type>::infinity ();
+      if (obstacles_.empty ()) return;
+      for (std::size_t i = 0; i < 3; ++i) {
+	lower_ [i] = inf;
+	upper_ [i] = -inf;
+      }
+      for (ObjectVector_t::const_iterator it = obstacles_.begin ();
+	   it != obstacles_.end (); ++it) {
+	fcl::CollisionObject* object = (*it)->fcl ().get ();
+	object->computeAABB ();
+	const fcl::AABB& box (object->getAABB ());
+	for (std::size_t i = 0; i < 3; ++i) {
+	  lower_ [i] = std::min (lower_ [i], (value_type) box.min_ [i]);
+	  upper_ [i] = std::max (upper_ [i], (value_type) box.max_ [i]);
+	}
+      }
+      size_type total = 1;
+      for (std::size_t i = 0; i < 3; ++i) {
+	origin_ [i] = lower_ [i] - margin_;
+	size_ [i] = std::max ((size_type) std::ceil
+			      ((upper_ [i] - lower_ [i] + 2 * margin_) /
+			       resolution_), (size_type) 1);
+	if (total > maxVoxels / size_ [i]) {
+	  throw std::invalid_argument
+	    ("Resolution of the distance field is too small for the size of "
+	     "the obstacles.");
+	}
+	total *= size_ [i];
+      }
+      values_.resize (total);
+      // The sphere circumscribed to a voxel contains the voxel: its
+      // distance to the obstacles bounds the distance of the points of the
+      // voxel.
+      boost::shared_ptr <fcl::CollisionGeometry> sphere
+	(new fcl::Sphere (.5 * std::sqrt (3.) * resolution_));
+      fcl::CollisionObject probe (sphere);
+      fcl::DistanceRequest request (false, 0, 0, fcl::GST_INDEP);
+      fcl::DistanceResult result;
+      std::size_t index = 0;
+      for (size_type z = 0; z < size_ [2]; ++z) {
+	for (size_type y = 0; y < size_ [1]; ++y) {
+	  for (size_type x = 0; x < size_ [0]; ++x, ++index) {
+	    probe.setTranslation
+	      (fcl::Vec3f (origin_ [0] + ((value_type) x + .5) * resolution_,
+			   origin_ [1] + ((value_type) y + .5) * resolution_,
+			   origin_ [2] + ((value_type) z + .5) * resolution_));
+	    probe.computeAABB ();
+	    value_type value = inf;
+	    for (ObjectVector_t::const_iterator it = obstacles_.begin ();
+		 it != obstacles_.end () && value > 0; ++it) {
+	      const fcl::CollisionObject* object = (*it)->fcl ().get ();
+	      // Obstacles the box of which is farther than the current
+	      // value cannot lower it.
+	      if (probe.getAABB ().distance (object->getAABB ()) >= value) {
+		continue;
+	      }
+	      result.clear ();
+	      fcl::distance (&probe, object, request, result);
+	      value = std::min (value, std::max ((value_type)
+						 result.min_distance,
+						 (value_type) 0));
+	    }
+	    values_ [index] = value;
+	  }
+	}
+      }
+    }
+
+    value_type DistanceField::lowerBound (const fcl::AABB& box) const
+    {
+      const value_type inf = std::numeric_limits <value_type>::infinity ();
+      if (obstacles_.empty ()) return inf;
+      value_type result = inf;
+      size_type begin [3], end [3];
+      for (std::size_t i = 0; i < 3; ++i) {
+	const value_type gridEnd = origin_ [i] +
+	  (value_type) size_ [i] * resolution_;
+	if (box.max_ [i] < origin_ [i] || box.min_ [i] > gridEnd) {
+	  // The box does not meet the grid.
+	  fcl::AABB bounds (fcl::Vec3f (lower_ [0], lower_ [1], lower_ [2]),
+			    fcl::Vec3f (upper_ [0], upper_ [1], upper_ [2]));
+	  return box.distance (bounds);
+	}
+	// Points outside of the grid are farther than the margin from the
+	// obstacles.
+	if (box.min_ [i] < origin_ [i] || box.max_ [i] > gridEnd) {
+	  result = margin_;
+	}
+	begin [i] = voxel (i, box.min_ [i]);
+	end [i] = voxel (i, box.max_ [i]) + 1;
+      }
+      for (size_type z = begin [2]; z < end [2]; ++z) {
+	for (size_type y = begin [1]; y < end [1]; ++y) {
+	  std::size_t index = (z * size_ [1] + y) * size_ [0];
+	  for (size_type x = begin [0]; x < end [0]; ++x) {
+	    result = std::min (result, values_ [index + x]);
+	  }
+	  if (result == 0) return 0;
+	}
+      }
+      return result;
+    }
+  } // namespace core
+} // namespace hpp
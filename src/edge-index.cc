@@ -0,0 +1,95 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <vector>
+#include <hpp/core/edge.hh>
+#include "edge-index.hh"
+
+namespace hpp {
+  namespace core {
+    EdgeIndex::EdgeIndex (const SweptVolumePtr_t& sweptVolume) :
+      sweptVolume_ (sweptVolume), tree_ (), entries_ (), unbounded_ ()
+    {
+    }
+
+    void EdgeIndex::insert (const EdgePtr_t& edge)
+    {
+      Entry entry;
+      if (!edge->hasPath () ||
+	  !sweptVolume_->compute (edge->path (), entry.boxes) ||
+	  entry.boxes.empty ()) {
+	unbounded_.insert (edge);
+	return;
+      }
+      fcl::AABB box;
+      for (SweptVolume::Boxes_t::const_iterator it = entry.boxes.begin ();
+	   it != entry.boxes.end (); ++it) {
+	box += *it;
+      }
+      entry.leaf = tree_.insert (box, edge);
+      entries_ [edge] = entry;
+    }
+
+    void EdgeIndex::remove (const EdgePtr_t& edge)
+    {
+      Entries_t::iterator it = entries_.find (edge);
+      if (it != entries_.end ()) {
+	tree_.remove (it->second.leaf);
+	entries_.erase (it);
+      } else {
+	unbounded_.erase (edge);
+      }
+    }
+
+    void EdgeIndex::clear ()
+    {
+      tree_.clear ();
+      entries_.clear ();
+      unbounded_.clear ();
+    }
+
+    void EdgeIndex::query (const SweptVolume::Boxes_t& region,
+			   std::set <EdgePtr_t>& edges) const
+    {
+      edges.insert (unbounded_.begin (), unbounded_.end ());
+      if (!tree_.getRoot ()) return;
+      SweptVolume::Boxes_t box (1);
+      std::vector <const TreeNode_t*> stack;
+      for (SweptVolume::Boxes_t::const_iterator itBox = region.begin ();
+	   itBox != region.end (); ++itBox) {
+	box [0] = *itBox;
+	stack.push_back (tree_.getRoot ());
+	while (!stack.empty ()) {
+	  const TreeNode_t* node = stack.back ();
+	  stack.pop_back ();
+	  if (!node->bv.overlap (*itBox)) continue;
+	  if (node->isLeaf ()) {
+	    EdgePtr_t edge = static_cast <EdgePtr_t> (node->data);
+	    if (edges.count (edge)) continue;
+	    const Entry& entry = entries_.find (edge)->second;
+	    if (SweptVolume::overlap (entry.boxes, box)) edges.insert (edge);
+	  } else {
+	    stack.push_back (node->children [0]);
+	    stack.push_back (node->children [1]);
+	  }
+	}
+      }
+    }
+  } // namespace core
+} // namespace hpp
@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_EDGE_INDEX_HH
+# define HPP_CORE_EDGE_INDEX_HH
+
+# include <map>
+# include <set>
+# include <hpp/fcl/broadphase/hierarchy_tree.h>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/swept-volume.hh>
+
+namespace hpp {
+  namespace core {
+    /// Spatial index of the edges of a roadmap
+    ///
+    /// The boxes swept by the bodies of the robot along the path of each
+    /// edge (see SweptVolume) are computed when the edge is inserted. The
+    /// union of the boxes of an edge is stored in an AABB tree, so that the
+    /// edges passing near a region are found in logarithmic time in the
+    /// number of edges. The boxes of the bodies are then tested one by one.
+    ///
+    /// Edges the path of which is not computed yet, or does not provide
+    /// velocity bounds, are not bounded: they are returned by every query.
+    class EdgeIndex
+    {
+    public:
+      EdgeIndex (const SweptVolumePtr_t& sweptVolume);
+
+      /// Compute the boxes of an edge and insert them
+      void insert (const EdgePtr_t& edge);
+      /// Remove an edge
+      void remove (const EdgePtr_t& edge);
+      /// Remove all edges
+      void clear ();
+      /// Get edges that may pass through a region
+      /// \param region union of boxes,
+      /// \retval edges edges the boxes of a body of which overlap a box of
+      ///         the region, and edges that are not bounded.
+      void query (const SweptVolume::Boxes_t& region,
+		  std::set <EdgePtr_t>& edges) const;
+
+    private:
+      typedef fcl::HierarchyTree <fcl::AABB> Tree_t;
+      typedef Tree_t::NodeType TreeNode_t;
+      struct Entry
+      {
+	SweptVolume::Boxes_t boxes;
+	TreeNode_t* leaf;
+      }; // struct Entry
+      typedef std::map <EdgePtr_t, Entry> Entries_t;
+
+      SweptVolumePtr_t sweptVolume_;
+      Tree_t tree_;
+      Entries_t entries_;
+      /// Edges that are not bounded
+      std::set <EdgePtr_t> unbounded_;
+    }; // class EdgeIndex
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_EDGE_INDEX_HH
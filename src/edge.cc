@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2016 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <limits>
+#include <hpp/core/edge.hh>
+#include <hpp/core/node.hh>
+#include <hpp/core/path-cost.hh>
+#include <hpp/core/steering-method.hh>
+
+namespace hpp {
+  namespace core {
+    void Edge::computePath () const
+    {
+      path_ = (*steeringMethod_) (*(n1_->configuration ()),
+				  *(n2_->configuration ()));
+      // The path is computed once, even if the steering method failed.
+      steeringMethod_.reset ();
+    }
+
+    value_type Edge::cost (const PathCostPtr_t& cost) const
+    {
+      if (costFunction_.lock () == cost) return cost_;
+      PathPtr_t p (path ());
+      cost_ = p ? (*cost) (p) : std::numeric_limits <value_type>::infinity ();
+      costFunction_ = cost;
+      return cost_;
+    }
+  } //   namespace core
+} // namespace hpp
@@ -64,21 +64,10 @@ namespace hpp {
       void solve (ConfigurationOut_t configuration, vectorIn_t rhs)
       {
 	assert (rhs.size () == output_.size ());
-	size_type index = 0;
-	for (SizeIntervals_t::const_iterator it = inputConfIntervals_.begin ();
-	     it != inputConfIntervals_.end (); ++it) {
-	  input_.segment (index, it->second) =
-	    configuration.segment (it->first, it->second);
-	  index += it->second;
-	}
+	gather (configuration, inputConfIndices_, input_);
 	(*inputToOutput_) (output_, input_);
-	index = 0;
-	for (SizeIntervals_t::const_iterator it = outputConfIntervals_.begin ();
-	     it != outputConfIntervals_.end (); ++it) {
-	  configuration.segment (it->first, it->second) =
-	    output_.segment (index, it->second) +
-	    rhs.segment (index, it->second);
-	  index += it->second;
+	for (std::size_t i = 0; i < outputConfIndices_.size (); ++i) {
+	  configuration [outputConfIndices_ [i]] = output_ [i] + rhs [i];
 	}
       }
 
@@ -90,9 +79,8 @@ namespace hpp {
 	: DifferentiableFunction (robot->configSize (), robot->numberDof (),
 				  function->outputSize (),
 				  function->outputDerivativeSize ()),
-	  robot_ (robot), inputToOutput_ (function), inputConfIntervals_ (),
-	  inputDerivIntervals_ (), outputConfIntervals_ (outputConf),
-	  outputDerivIntervals_ (outputVelocity)
+	  robot_ (robot), inputToOutput_ (function), inputConfIndices_ (),
+	  inputDerivIndices_ (), outputConfIndices_ (), outputDerivIndices_ ()
       {
 	// Check input consistency
 	// Each configuration variable is either input or output
@@ -105,44 +93,27 @@ namespace hpp {
 	output_.resize (function->outputSize ());
 	J_.resize (function->outputDerivativeSize (),
 		   function->inputDerivativeSize ());
-	size_type size = 0;
+	// Conpute input intervals
+	SizeIntervals_t inputConf, inputVelocity;
+	complement (robot->configSize (), outputConf, inputConf);
+	complement (robot->numberDof (), outputVelocity, inputVelocity);
+	indices (inputConf, inputConfIndices_);
+	indices (inputVelocity, inputDerivIndices_);
+	indices (outputConf, outputConfIndices_);
+	indices (outputVelocity, outputDerivIndices_);
 	// Sum of configuration output interval sizes equal function output size
-	for (SizeIntervals_t::const_iterator it = outputConf.begin ();
-	     it != outputConf.end (); ++it) {
-	  size += it->second;
-	}
-	assert (size == function->outputSize ());
+	assert ((size_type) outputConfIndices_.size () ==
+		function->outputSize ());
 	// Sum of velocity output interval sizes equal function output
 	// derivative size
-	size = 0;
-	for (SizeIntervals_t::const_iterator it = outputVelocity.begin ();
-	     it != outputVelocity.end (); ++it) {
-	  size += it->second;
-	}
-	assert (size == function->outputDerivativeSize ());
-	// Conpute input intervals
-	complement (robot->configSize (), outputConfIntervals_,
-		    inputConfIntervals_);
-	complement (robot->numberDof (), outputDerivIntervals_,
-		    inputDerivIntervals_);
+	assert ((size_type) outputDerivIndices_.size () ==
+		function->outputDerivativeSize ());
       }
 
       void impl_compute (vectorOut_t result, vectorIn_t argument) const
       {
-	size_type index = 0;
-	for (SizeIntervals_t::const_iterator it = outputConfIntervals_.begin ();
-	     it != outputConfIntervals_.end (); ++it) {
-	  result.segment (index, it->second) =
-	    argument.segment (it->first, it->second);
-	  index += it->second;
-	}
-	index = 0;
-	for (SizeIntervals_t::const_iterator it = inputConfIntervals_.begin ();
-	     it != inputConfIntervals_.end (); ++it) {
-	  input_.segment (index, it->second) =
-	    argument.segment (it->first, it->second);
-	  index += it->second;
-	}
+	gather (argument, outputConfIndices_, result);
+	gather (argument, inputConfIndices_, input_);
 	(*inputToOutput_) (output_, input_);
 	result -= output_;
       }
@@ -150,40 +121,50 @@ namespace hpp {
       void impl_jacobian (matrixOut_t jacobian, vectorIn_t arg) const
       {
 	jacobian.setZero ();
-	size_type row = 0;
-	for (SizeIntervals_t::const_iterator it=outputDerivIntervals_.begin ();
-	     it != outputDerivIntervals_.end (); ++it) {
-	  for (size_type col=it->first; col < it->first + it->second; ++col) {
-	    jacobian (row, col) = 1;
-	    ++row;
-	  }
-	}
-
-	size_type index = 0;
-	for (SizeIntervals_t::const_iterator it = inputConfIntervals_.begin ();
-	     it != inputConfIntervals_.end (); ++it) {
-	  input_.segment (index, it->second) =
-	    arg.segment (it->first, it->second);
-	  index += it->second;
+	for (std::size_t row = 0; row < outputDerivIndices_.size (); ++row) {
+	  jacobian (row, outputDerivIndices_ [row]) = 1;
 	}
+	gather (arg, inputConfIndices_, input_);
 	inputToOutput_->jacobian (J_, input_);
-	size_type col=0;
-	size_type nbRows = inputToOutput_->outputDerivativeSize ();
-	for (SizeIntervals_t::const_iterator it = inputDerivIntervals_.begin ();
-	     it != inputDerivIntervals_.end (); ++it) {
-	  jacobian.block (0, it->first, nbRows, it->second) =
-	    - J_.block (0, col, nbRows, it->second);
-	  col += it->second;
+	for (std::size_t col = 0; col < inputDerivIndices_.size (); ++col) {
+	  jacobian.col (inputDerivIndices_ [col]) = - J_.col (col);
 	}
       }
 
     private:
+      typedef std::vector <size_type> Indices_t;
+
+      // Flatten intervals into the list of their indices
+      static void indices (const SizeIntervals_t& intervals,
+			   Indices_t& result)
+      {
+	result.clear ();
+	for (SizeIntervals_t::const_iterator it = intervals.begin ();
+	     it != intervals.end (); ++it) {
+	  for (size_type i = it->first; i < it->first + it->second; ++i) {
+	    result.push_back (i);
+	  }
+	}
+      }
+
+      static void gather (vectorIn_t from, const Indices_t& indices,
+			  vectorOut_t to)
+      {
+	assert (to.size () == (size_type) indices.size ());
+	for (std::size_t i = 0; i < indices.size (); ++i) {
+	  to [i] = from [indices [i]];
+	}
+      }
+
       DevicePtr_t robot_;
       DifferentiableFunctionPtr_t inputToOutput_;
-      SizeIntervals_t inputConfIntervals_;
-      SizeIntervals_t inputDerivIntervals_;
-      SizeIntervals_t outputConfIntervals_;
-      SizeIntervals_t outputDerivIntervals_;
+      // Indices of the input and output variables of the explicit function
+      // in the configuration and in the velocity, computed at construction
+      // so that evaluations copy variables in one loop.
+      Indices_t inputConfIndices_;
+      Indices_t inputDerivIndices_;
+      Indices_t outputConfIndices_;
+      Indices_t outputDerivIndices_;
       mutable vector_t input_;
       mutable vector_t output_;
       // Jacobian of explicit function
@@ -232,14 +213,30 @@ namespace hpp {
       return createCopy (weak_.lock ());
     }
 
+    NumericalConstraintPtr_t ExplicitNumericalConstraint::copy
+    (const DevicePtr_t& robot) const
+    {
+      if (!functionBuilder ()) return NumericalConstraintPtr_t ();
+      ExplicitNumericalConstraintPtr_t nc (createCopy (weak_.lock ()));
+      if (inputToOutput_) {
+	nc->inputToOutput_ = functionBuilder () (robot);
+	nc->function (ImplicitFunction::create
+		      (robot, nc->inputToOutput_, outputConf_,
+		       outputVelocity_));
+      } else {
+	nc->function (functionBuilder () (robot));
+      }
+      return nc;
+    }
+
     ExplicitNumericalConstraint::ExplicitNumericalConstraint
     (const DevicePtr_t& robot, const DifferentiableFunctionPtr_t& function,
      const SizeIntervals_t& outputConf,
      const SizeIntervals_t& outputVelocity) :
       NumericalConstraint (ImplicitFunction::create
 			   (robot, function, outputConf, outputVelocity),
-			   Equality::create ()), outputConf_ (outputConf),
-      outputVelocity_ (outputVelocity)
+			   Equality::create ()), inputToOutput_ (function),
+      outputConf_ (outputConf), outputVelocity_ (outputVelocity)
     {
     }
 
@@ -249,8 +246,8 @@ namespace hpp {
      const SizeIntervals_t& outputVelocity, vectorIn_t rhs) :
       NumericalConstraint (ImplicitFunction::create
 			   (robot, function, outputConf, outputVelocity),
-			   Equality::create (), rhs), outputConf_ (outputConf),
-      outputVelocity_ (outputVelocity)
+			   Equality::create (), rhs), inputToOutput_ (function),
+      outputConf_ (outputConf), outputVelocity_ (outputVelocity)
     {
     }
 
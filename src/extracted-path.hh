@@ -47,9 +47,19 @@ namespace hpp {
 	return createCopy (weak_.lock (), constraints);
       }
 
+      /// Create instance and return shared pointer
+      ///
+      /// If original is itself an extracted path, the result is defined
+      /// directly on the path the restriction of which original is, so that
+      /// successive extractions do not build chains of decorators.
       static ExtractedPathPtr_t
       create (const PathPtr_t& original, const interval_t& subInterval)
       {
+	ExtractedPathPtr_t extracted
+	  (HPP_DYNAMIC_PTR_CAST (ExtractedPath, original));
+	if (extracted) {
+	  return extracted->extractFromOriginal (subInterval);
+	}
 	ExtractedPath* ptr = new ExtractedPath (original, subInterval);
 	ExtractedPathPtr_t shPtr (ptr);
 	ptr->init (shPtr);
@@ -78,47 +88,80 @@ namespace hpp {
       virtual bool impl_compute (ConfigurationOut_t result,
 				 value_type param) const
       {
-	if (reversed_) {
-	  param = timeRange ().first + timeRange ().second - param ;
-	  return original_->impl_compute (result, param);
-	} else {
-	  return original_->impl_compute (result, param);
+	return original_->impl_compute (result, originalParam (param));
+      }
+
+      virtual void impl_eval (vectorIn_t times, matrixOut_t configurations,
+			      std::vector <bool>& success) const
+      {
+	vector_t originalTimes (times.size ());
+	for (size_type i = 0; i < times.size (); ++i) {
+	  originalTimes [i] = originalParam (times [i]);
 	}
+	original_->impl_eval (originalTimes, configurations, success);
       }
 
       virtual PathPtr_t extract (const interval_t& subInterval) const
       {
-	ExtractedPathPtr_t path = createCopy (weak_.lock ());
-	bool reversed = subInterval.first > subInterval.second ? true : false;
-	value_type tmin, tmax;
-	if (reversed) {
-	  tmin = subInterval.second; tmax = subInterval.first;
-	} else {
-	  tmin = subInterval.first; tmax = subInterval.second;
+	return extractFromOriginal (subInterval);
+      }
+
+      /// Get path the restriction of which is this path
+      const PathPtr_t& original () const
+      {
+	return original_;
+      }
+
+      /// Whether this path goes through the original path backward
+      ///
+      /// If true, parameter t of this path corresponds to parameter
+      /// timeRange ().first + timeRange ().second - t of the original path.
+      bool reversed () const
+      {
+	return reversed_;
+      }
+
+      /// Get parameter of the original path corresponding to a parameter of
+      /// this path
+      value_type originalParam (value_type param) const
+      {
+	if (reversed_) {
+	  return timeRange_.first + timeRange_.second - param;
 	}
-	path->reversed_ = ((this->reversed_) && (!reversed)) ||
-	  ((!this->reversed_) && (reversed));
-	path->timeRange_ = std::make_pair (tmin, tmax);
-	assert (path->timeRange_.first >= timeRange ().first);
-	assert (path->timeRange_.second <= timeRange ().second);
-	return path;
+	return param;
       }
 
       /// Get the initial configuration
       Configuration_t initial () const
       {
 	bool success;
-        return (*original_)(timeRange_.first, success);
+        return (*original_)(originalParam (timeRange_.first), success);
       }
 
       /// Get the final configuration
       Configuration_t end () const
       {
 	bool success;
-        return (*original_)(timeRange_.second, success);
+        return (*original_)(originalParam (timeRange_.second), success);
       }
 
     protected:
+      virtual bool impl_velocityBound (vectorOut_t result, value_type t0,
+				       value_type t1) const
+      {
+	if (reversed_) {
+	  value_type sum = timeRange ().first + timeRange ().second;
+	  return original_->velocityBound (result, sum - t1, sum - t0);
+	}
+	return original_->velocityBound (result, t0, t1);
+      }
+
+      /// Size of this path and of the original path
+      virtual std::size_t impl_memoryUsage () const
+      {
+	return sizeof (ExtractedPath) + original_->memoryUsage ();
+      }
+
       /// Print path in a stream
       virtual std::ostream& print (std::ostream &os) const
       {
@@ -173,6 +216,27 @@ namespace hpp {
       }
 
     private:
+      /// Restriction of the original path to an interval of this path
+      ///
+      /// The interval is mapped to the parameters of the original path,
+      /// so that the result decorates the original path directly.
+      ExtractedPathPtr_t extractFromOriginal (const interval_t& subInterval)
+	const
+      {
+	ExtractedPathPtr_t path = createCopy (weak_.lock ());
+	value_type t0 = originalParam (subInterval.first);
+	value_type t1 = originalParam (subInterval.second);
+	path->reversed_ = t0 > t1;
+	if (path->reversed_) {
+	  path->timeRange_ = std::make_pair (t1, t0);
+	} else {
+	  path->timeRange_ = std::make_pair (t0, t1);
+	}
+	assert (path->timeRange_.first >= timeRange ().first);
+	assert (path->timeRange_.second <= timeRange ().second);
+	return path;
+      }
+
       PathPtr_t original_;
       bool reversed_;
       ExtractedPathWkPtr_t weak_;
@@ -0,0 +1,115 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <hpp/core/distance.hh>
+#include <hpp/core/node.hh>
+#include <hpp/core/weighed-distance.hh>
+#include "goal-index.hh"
+
+namespace hpp {
+  namespace core {
+    namespace {
+      typedef std::pair <value_type, NodePtr_t> KeyAndGoal_t;
+
+      bool compareKeys (const KeyAndGoal_t& a, const KeyAndGoal_t& b)
+      {
+	return a.first < b.first;
+      }
+    } // namespace
+
+    GoalIndex::GoalIndex (const DistancePtr_t& distance,
+			  const Nodes_t& goals) :
+      distance_ (distance),
+      metric_ (HPP_DYNAMIC_PTR_CAST (WeighedDistance, distance)),
+      goals_ (), keys_ (), reference_ (), distances_ ()
+    {
+      if (goals.empty ()) return;
+      const size_type size = goals.front ()->configuration ()->size ();
+      goals_.resize (size, goals.size ());
+      distances_.resize (goals.size ());
+      if (!metric_) {
+	size_type i = 0;
+	for (Nodes_t::const_iterator it = goals.begin (); it != goals.end ();
+	     ++it, ++i) {
+	  goals_.col (i) = *(*it)->configuration ();
+	}
+	return;
+      }
+      // The goal farthest from the first one spreads the keys.
+      const Configuration_t& first (*goals.front ()->configuration ());
+      value_type farthest = -1;
+      for (Nodes_t::const_iterator it = goals.begin (); it != goals.end ();
+	   ++it) {
+	value_type d = (*distance_) (first, *(*it)->configuration ());
+	if (d > farthest) {
+	  farthest = d;
+	  reference_ = *(*it)->configuration ();
+	}
+      }
+      std::vector <KeyAndGoal_t> sorted;
+      sorted.reserve (goals.size ());
+      for (Nodes_t::const_iterator it = goals.begin (); it != goals.end ();
+	   ++it) {
+	sorted.push_back (KeyAndGoal_t
+			  ((*distance_) (reference_, *(*it)->configuration ()),
+			   *it));
+      }
+      std::stable_sort (sorted.begin (), sorted.end (), compareKeys);
+      keys_.reserve (sorted.size ());
+      for (std::size_t i = 0; i < sorted.size (); ++i) {
+	keys_.push_back (sorted [i].first);
+	goals_.col (i) = *sorted [i].second->configuration ();
+      }
+    }
+
+    value_type GoalIndex::minDistance (ConfigurationIn_t q) const
+    {
+      const value_type inf = std::numeric_limits <value_type>::infinity ();
+      if (goals_.cols () == 0) return inf;
+      if (!metric_) {
+	distance_->distances (q, goals_, distances_);
+	return distances_.minCoeff ();
+      }
+      // Visit goals by increasing difference of keys to the key of q, which
+      // bounds the distance from below.
+      const value_type key = (*distance_) (reference_, q);
+      std::size_t up = std::lower_bound (keys_.begin (), keys_.end (), key) -
+	keys_.begin ();
+      std::size_t down = up;
+      value_type best = inf;
+      while (down > 0 || up < keys_.size ()) {
+	const value_type gapDown = down > 0 ? key - keys_ [down - 1] : inf;
+	const value_type gapUp = up < keys_.size () ? keys_ [up] - key : inf;
+	std::size_t i;
+	if (gapDown < gapUp) {
+	  if (gapDown >= best) break;
+	  i = --down;
+	} else {
+	  if (gapUp >= best) break;
+	  i = up++;
+	}
+	best = std::min (best, (*distance_) (q, goals_.col (i)));
+      }
+      return best;
+    }
+  } //   namespace core
+} // namespace hpp
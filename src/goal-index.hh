@@ -0,0 +1,63 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_GOAL_INDEX_HH
+# define HPP_CORE_GOAL_INDEX_HH
+
+# include <list>
+# include <vector>
+# include <hpp/core/fwd.hh>
+
+namespace hpp {
+  namespace core {
+    /// Index of the goal configurations of a roadmap
+    ///
+    /// Computes the distance from a configuration to the nearest goal
+    /// configuration. When the distance is a metric (WeighedDistance), goals
+    /// are sorted by their distance to a reference goal: by the triangle
+    /// inequality, goals the key of which differs from the distance of the
+    /// configuration to the reference by more than the best distance found
+    /// so far are skipped. Otherwise, distances to all goals are computed in
+    /// batch.
+    class GoalIndex
+    {
+    public:
+      typedef std::list <NodePtr_t> Nodes_t;
+
+      GoalIndex (const DistancePtr_t& distance, const Nodes_t& goals);
+
+      /// Get distance to the nearest goal configuration
+      /// \return infinity if there is no goal.
+      value_type minDistance (ConfigurationIn_t q) const;
+
+    private:
+      DistancePtr_t distance_;
+      /// Whether the distance satisfies the triangle inequality
+      bool metric_;
+      /// Goal configurations in columns, sorted by increasing keys_
+      matrix_t goals_;
+      /// Distances of the goals to the reference goal
+      std::vector <value_type> keys_;
+      Configuration_t reference_;
+      mutable vector_t distances_;
+    }; // class GoalIndex
+  } //   namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_GOAL_INDEX_HH
@@ -0,0 +1,227 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/model/joint-configuration.hh>
+#include <hpp/core/halton-configuration-shooter.hh>
+
+namespace hpp {
+  namespace core {
+    namespace {
+      bool isPrime (unsigned int n)
+      {
+	if (n < 2) return false;
+	for (unsigned int d = 2; d * d <= n; ++d) {
+	  if (n % d == 0) return false;
+	}
+	return true;
+      }
+    } // namespace
+
+    HaltonConfigurationShooterPtr_t HaltonConfigurationShooter::create
+    (const DevicePtr_t& robot)
+    {
+      HaltonConfigurationShooter* ptr = new HaltonConfigurationShooter (robot);
+      HaltonConfigurationShooterPtr_t shPtr (ptr);
+      ptr->init (shPtr);
+      return shPtr;
+    }
+
+    HaltonConfigurationShooterPtr_t HaltonConfigurationShooter::leapfrog
+    (const DevicePtr_t& robot, std::size_t rank, std::size_t number) const
+    {
+      if (rank >= number) {
+	throw std::invalid_argument
+	  ("Rank of stream should be less than the number of streams.");
+      }
+      // Smallest prime that is not a base and not less than number.
+      unsigned int prime = bases_.empty () ? 2 : bases_.back () + 1;
+      if (prime < number) prime = (unsigned int) number;
+      while (!isPrime (prime)) ++prime;
+      HaltonConfigurationShooterPtr_t stream (create (robot));
+      boost::mutex::scoped_lock lock (mutex_);
+      stream->start_ = start_ + (count_ + rank) * stride_;
+      stream->stride_ = prime * stride_;
+      return stream;
+    }
+
+    void HaltonConfigurationShooter::reset ()
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      count_ = 0;
+    }
+
+    HaltonConfigurationShooter::HaltonConfigurationShooter
+    (const DevicePtr_t& robot) : ConfigurationShooter (),
+      robot_ (robot), samplers_ (), bases_ (), start_ (1), stride_ (1),
+      count_ (0), mutex_ (), weak_ ()
+    {
+      const JointVector_t& jv = robot_->getJointVector ();
+      for (JointVector_t::const_iterator itJoint = jv.begin ();
+	   itJoint != jv.end (); ++itJoint) {
+	const JointPtr_t& joint (*itJoint);
+	size_type rank = joint->rankInConfiguration ();
+	if (joint->configSize () == 0) continue;
+	if (dynamic_cast <model::JointSO3*> (joint)) {
+	  addSampler (Sampler::UNIT_QUATERNION, rank, 3);
+	} else if (dynamic_cast <model::jointRotation::UnBounded*> (joint)) {
+	  if (joint->configSize () == 2) {
+	    addSampler (Sampler::UNIT_COMPLEX, rank, 1);
+	  } else {
+	    addSampler (Sampler::ANGLE, rank, 1);
+	  }
+	} else {
+	  JointConfigurationPtr_t jc (joint->configuration ());
+	  for (size_type i = 0; i < joint->configSize (); ++i) {
+	    if (!jc->isBounded (i)) {
+	      std::ostringstream oss;
+	      oss << "Cannot uniformly sample unbounded joint "
+		  << joint->name () << ", rank " << i << ".";
+	      throw std::runtime_error (oss.str ());
+	    }
+	    addSampler (Sampler::INTERVAL, rank + i, 1, jc->lowerBound (i),
+			jc->upperBound (i));
+	  }
+	}
+      }
+      // Extra configuration variables
+      size_type extraDim = robot_->extraConfigSpace ().dimension ();
+      size_type offset = robot_->configSize () - extraDim;
+      for (size_type i = 0; i < extraDim; ++i) {
+	value_type lower = robot_->extraConfigSpace ().lower (i);
+	value_type upper = robot_->extraConfigSpace ().upper (i);
+	value_type range = upper - lower;
+	if ((range < 0) ||
+	    (range == std::numeric_limits <value_type>::infinity ())) {
+	  std::ostringstream oss;
+	  oss << "Cannot uniformly sample extra config variable " << i
+	      << ". min = " << lower << ", max = " << upper;
+	  throw std::runtime_error (oss.str ());
+	}
+	addSampler (Sampler::INTERVAL, offset + i, 1, lower, upper);
+      }
+    }
+
+    void HaltonConfigurationShooter::init
+    (const HaltonConfigurationShooterPtr_t& self)
+    {
+      ConfigurationShooter::init (self);
+      weak_ = self;
+    }
+
+    void HaltonConfigurationShooter::addSampler
+    (Sampler::Type type, size_type rank, std::size_t dimensions,
+     value_type lower, value_type upper)
+    {
+      Sampler sampler;
+      sampler.type = type;
+      sampler.rank = rank;
+      sampler.dimension = bases_.size ();
+      sampler.lower = lower;
+      sampler.upper = upper;
+      samplers_.push_back (sampler);
+      // Bases are the first primes: the lower the base, the more uniform
+      // the first samples.
+      for (std::size_t i = 0; i < dimensions; ++i) {
+	unsigned int base = bases_.empty () ? 2 : bases_.back () + 1;
+	while (!isPrime (base)) ++base;
+	bases_.push_back (base);
+      }
+    }
+
+    value_type HaltonConfigurationShooter::uniform
+    (boost::uint64_t index, std::size_t dimension) const
+    {
+      const unsigned int base = bases_ [dimension];
+      const value_type inverse = 1. / base;
+      value_type factor = inverse;
+      value_type result = 0;
+      while (index > 0) {
+	result += factor * (value_type) (index % base);
+	index /= base;
+	factor *= inverse;
+      }
+      return result;
+    }
+
+    ConfigurationPtr_t HaltonConfigurationShooter::shoot () const
+    {
+      ConfigurationPtr_t config (new Configuration_t (robot_->configSize ()));
+      sample (*config);
+      return config;
+    }
+
+    void HaltonConfigurationShooter::shoot (matrixOut_t configurations) const
+    {
+      for (size_type i = 0; i < configurations.cols (); ++i) {
+	sample (configurations.col (i));
+      }
+    }
+
+    void HaltonConfigurationShooter::sample (ConfigurationOut_t q) const
+    {
+      assert (q.size () == robot_->configSize ());
+      boost::uint64_t index;
+      {
+	boost::mutex::scoped_lock lock (mutex_);
+	index = start_ + count_ * stride_;
+	++count_;
+      }
+      for (Samplers_t::const_iterator it = samplers_.begin ();
+	   it != samplers_.end (); ++it) {
+	const std::size_t d = it->dimension;
+	switch (it->type) {
+	case Sampler::INTERVAL:
+	  q [it->rank] = it->lower + (it->upper - it->lower) *
+	    uniform (index, d);
+	  break;
+	case Sampler::ANGLE:
+	  q [it->rank] = M_PI * (2 * uniform (index, d) - 1);
+	  break;
+	case Sampler::UNIT_COMPLEX:
+	  {
+	    value_type angle = M_PI * (2 * uniform (index, d) - 1);
+	    q [it->rank] = cos (angle);
+	    q [it->rank + 1] = sin (angle);
+	  }
+	  break;
+	case Sampler::UNIT_QUATERNION:
+	  {
+	    // Uniform sampling of the unit sphere in R^4 (Shoemake)
+	    value_type u1 = uniform (index, d);
+	    value_type a2 = 2 * M_PI * uniform (index, d + 1);
+	    value_type a3 = 2 * M_PI * uniform (index, d + 2);
+	    value_type r1 = sqrt (1 - u1);
+	    value_type r2 = sqrt (u1);
+	    q [it->rank] = r1 * sin (a2);
+	    q [it->rank + 1] = r1 * cos (a2);
+	    q [it->rank + 2] = r2 * sin (a3);
+	    q [it->rank + 3] = r2 * cos (a3);
+	  }
+	  break;
+	}
+      }
+    }
+  } //   namespace core
+} // namespace hpp
@@ -14,13 +14,17 @@
 // received a copy of the GNU Lesser General Public License along with
 // hpp-core. If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <hpp/util/debug.hh>
+#include <hpp/model/configuration.hh>
 #include <hpp/model/device.hh>
 #include <hpp/model/joint.hh>
 #include <hpp/model/joint-configuration.hh>
 #include <hpp/core/config-projector.hh>
 #include <hpp/core/interpolated-path.hh>
 #include <hpp/core/projection-error.hh>
+#include "interpolation-plan.hh"
+#include "memory-usage.hh"
 
 namespace hpp {
   namespace core {
@@ -30,7 +34,8 @@ namespace hpp {
         value_type length) :
       parent_t (interval_t (0, length), device->configSize (),
 		device->numberDof ()),
-      device_ (device)
+      device_ (device), times_ (), configs_ (device->configSize (), 2),
+      plan_ (InterpolationPlan::get (device))
     {
       assert (init.size() == device_->configSize ());
       insert (0, init);
@@ -47,7 +52,8 @@ namespace hpp {
 				ConstraintSetPtr_t constraints) :
       parent_t (interval_t (0, length), device->configSize (),
 		device->numberDof (), constraints),
-      device_ (device)
+      device_ (device), times_ (), configs_ (device->configSize (), 2),
+      plan_ (InterpolationPlan::get (device))
     {
       assert (init.size() == device_->configSize ());
       insert (0, init);
@@ -57,7 +63,9 @@ namespace hpp {
     }
 
     InterpolatedPath::InterpolatedPath (const InterpolatedPath& path) :
-      parent_t (path), device_ (path.device_), configs_ (path.configs_)
+      parent_t (path), device_ (path.device_), times_ (path.times_),
+      configs_ (path.configs_.leftCols (path.times_.size ())),
+      plan_ (path.plan_)
     {
       assert (initial().size() == device_->configSize ());
     }
@@ -65,7 +73,9 @@ namespace hpp {
     InterpolatedPath::InterpolatedPath (const InterpolatedPath& path,
 				const ConstraintSetPtr_t& constraints) :
       parent_t (path, constraints), device_ (path.device_),
-      configs_ (path.configs_)
+      times_ (path.times_),
+      configs_ (path.configs_.leftCols (path.times_.size ())),
+      plan_ (path.plan_)
     {
     }
 
@@ -106,31 +116,115 @@ namespace hpp {
       checkPath ();
     }
 
+    void InterpolatedPath::insert (const value_type& time,
+				   ConfigurationIn_t config)
+    {
+      std::vector <value_type>::iterator it =
+	std::lower_bound (times_.begin (), times_.end (), time);
+      if (it != times_.end () && *it == time) return;
+      size_type rank = it - times_.begin ();
+      size_type n = times_.size ();
+      if (configs_.cols () == n) {
+	configs_.conservativeResize (Eigen::NoChange,
+				     std::max (2 * n, (size_type) 2));
+      }
+      // Shift the following points
+      for (size_type j = n; j > rank; --j) {
+	configs_.col (j) = configs_.col (j - 1);
+      }
+      configs_.col (rank) = config;
+      times_.insert (it, time);
+    }
+
+    InterpolatedPath::InterpolationPoints_t
+    InterpolatedPath::interpolationPoints () const
+    {
+      InterpolationPoints_t result;
+      for (std::size_t i = 0; i < times_.size (); ++i) {
+	result.insert (InterpolationPoint_t (times_ [i], configs_.col (i)));
+      }
+      return result;
+    }
+
+    void InterpolatedPath::interpolate (std::size_t i, value_type param,
+					ConfigurationOut_t result) const
+    {
+      const value_type T = times_ [i] - times_ [i - 1];
+      const value_type u = (param - times_ [i - 1]) / T;
+      plan_->interpolate (configs_.col (i - 1), configs_.col (i), u, result);
+    }
+
     bool InterpolatedPath::impl_compute (ConfigurationOut_t result,
 				     value_type param) const
     {
       assert (param >= timeRange().first);
       assert (param <= timeRange().second);
       if (param == timeRange ().first || timeRange ().second == 0) {
-	result.noalias () = initial();
+	result.noalias () = configs_.col (0);
 	return true;
       }
       if (param == timeRange ().second) {
-	result.noalias () = end();
+	result.noalias () = configs_.col (times_.size () - 1);
 	return true;
       }
-      InterpolationPoints_t::const_iterator itA = configs_.lower_bound (param);
-      InterpolationPoints_t::const_iterator itB = itA; --itB;
-      const value_type T = itA->first - itB->first;
-      const value_type u = (param - itB->first) / T;
-
-      // Loop over device joint and interpolate
-      const JointVector_t& jv (device_->getJointVector ());
-      for (model::JointVector_t::const_iterator itJoint = jv.begin ();
-	   itJoint != jv.end (); ++itJoint) {
-	std::size_t rank = (*itJoint)->rankInConfiguration ();
-	(*itJoint)->configuration ()->interpolate
-	  (itB->second, itA->second, u, rank, result);
+      // First interpolation point after param
+      std::size_t i = std::lower_bound (times_.begin (), times_.end (), param)
+	- times_.begin ();
+      interpolate (i, param, result);
+      return true;
+    }
+
+    void InterpolatedPath::impl_eval (vectorIn_t times,
+				      matrixOut_t configurations,
+				      std::vector <bool>& success) const
+    {
+      std::size_t i = 0;
+      value_type previous = timeRange ().first;
+      for (size_type k = 0; k < times.size (); ++k) {
+	const value_type& param = times [k];
+	assert (param >= timeRange().first);
+	assert (param <= timeRange().second);
+	success [k] = true;
+	if (param == timeRange ().first || timeRange ().second == 0) {
+	  configurations.col (k) = configs_.col (0);
+	  continue;
+	}
+	if (param == timeRange ().second) {
+	  configurations.col (k) = configs_.col (times_.size () - 1);
+	  continue;
+	}
+	// First interpolation point after param
+	if (i == 0 || param < previous) {
+	  i = std::lower_bound (times_.begin (), times_.end (), param) -
+	    times_.begin ();
+	} else {
+	  while (times_ [i] < param) ++i;
+	}
+	previous = param;
+	interpolate (i, param, configurations.col (k));
+      }
+    }
+
+    std::size_t InterpolatedPath::impl_memoryUsage () const
+    {
+      return sizeof (InterpolatedPath) + memory::bytes (times_) +
+	memory::bytes (configs_);
+    }
+
+    bool InterpolatedPath::impl_velocityBound (vectorOut_t result,
+					       value_type t0,
+					       value_type t1) const
+    {
+      result.setZero ();
+      vector_t velocity (outputDerivativeSize ());
+      for (std::size_t i = 1; i < times_.size (); ++i) {
+	// Skip interpolations that do not overlap [t0, t1]
+	if (times_ [i] < t0 || times_ [i - 1] > t1) continue;
+	const value_type T = times_ [i] - times_ [i - 1];
+	if (T <= 0) continue;
+	model::difference (device_, configs_.col (i), configs_.col (i - 1),
+			   velocity);
+	result = result.cwiseMax (velocity.cwiseAbs () / T);
       }
       return true;
     }
@@ -153,14 +247,30 @@ namespace hpp {
       InterpolatedPathPtr_t result = InterpolatedPath::create (device_, q1, q2, l,
 					       constraints ());
 
-      InterpolationPoints_t::const_iterator it = configs_.upper_bound (tmin);
-      if (reverse)
-        for (; it->first < tmax; ++it)
-          result->insert (l - (it->first - tmin), it->second); 
-      else
-        for (; it->first < tmax; ++it)
-          result->insert (it->first - tmin, it->second); 
-
+      // Interpolation points in ]tmin, tmax[ are stored in order between
+      // the initial and end configurations of the result.
+      std::size_t first = std::upper_bound (times_.begin (), times_.end (),
+					    tmin) - times_.begin ();
+      std::size_t last = std::lower_bound (times_.begin (), times_.end (),
+					   tmax) - times_.begin ();
+      if (last <= first) return result;
+      std::size_t n = last - first;
+      result->times_.resize (n + 2);
+      result->times_ [n + 1] = l;
+      result->configs_.resize (outputSize (), n + 2);
+      result->configs_.col (0) = q1;
+      result->configs_.col (n + 1) = q2;
+      for (std::size_t k = 0; k < n; ++k) {
+	if (reverse) {
+	  std::size_t i = last - 1 - k;
+	  result->times_ [k + 1] = l - (times_ [i] - tmin);
+	  result->configs_.col (k + 1) = configs_.col (i);
+	} else {
+	  std::size_t i = first + k;
+	  result->times_ [k + 1] = times_ [i] - tmin;
+	  result->configs_.col (k + 1) = configs_.col (i);
+	}
+      }
       return result;
     }
 
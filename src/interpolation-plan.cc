@@ -0,0 +1,131 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <map>
+#include <boost/thread/mutex.hpp>
+#include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/model/joint-configuration.hh>
+#include "interpolation-plan.hh"
+
+namespace hpp {
+  namespace core {
+    namespace {
+      // Plans by device, shared by all the paths. The weak pointer detects
+      // devices destroyed since, the address of which may be reused.
+      struct CacheEntry {
+	DeviceWkPtr_t device;
+	InterpolationPlanPtr_t plan;
+      }; // struct CacheEntry
+      typedef std::map <const Device_t*, CacheEntry> PlanCache_t;
+      PlanCache_t planCache;
+      boost::mutex planCacheMutex;
+
+      bool isLinear (const JointPtr_t& joint)
+      {
+	return dynamic_cast <model::JointTranslation <1>*> (joint) ||
+	  dynamic_cast <model::JointTranslation <2>*> (joint) ||
+	  dynamic_cast <model::JointTranslation <3>*> (joint) ||
+	  dynamic_cast <model::jointRotation::Bounded*> (joint);
+      }
+    } // namespace
+
+    InterpolationPlanPtr_t InterpolationPlan::get (const DevicePtr_t& device)
+    {
+      boost::mutex::scoped_lock lock (planCacheMutex);
+      PlanCache_t::iterator it = planCache.find (device.get ());
+      if (it != planCache.end () && it->second.device.lock () == device &&
+	  it->second.plan->joints_ == device->getJointVector ()) {
+	return it->second.plan;
+      }
+      // Forget the plans of the destroyed devices
+      for (PlanCache_t::iterator itEntry = planCache.begin ();
+	   itEntry != planCache.end ();) {
+	if (itEntry->second.device.expired ()) planCache.erase (itEntry++);
+	else ++itEntry;
+      }
+      CacheEntry& entry (planCache [device.get ()]);
+      entry.device = device;
+      entry.plan = InterpolationPlanPtr_t (new InterpolationPlan (device));
+      return entry.plan;
+    }
+
+    InterpolationPlan::InterpolationPlan (const DevicePtr_t& device) :
+      blocks_ (), joints_ (device->getJointVector ())
+    {
+      for (JointVector_t::const_iterator itJoint = joints_.begin ();
+	   itJoint != joints_.end (); ++itJoint) {
+	const JointPtr_t& joint (*itJoint);
+	Block block;
+	block.rank = joint->rankInConfiguration ();
+	block.size = joint->configSize ();
+	block.joint = joint;
+	if (block.size == 0) continue;
+	if (isLinear (joint)) {
+	  block.joint = 0x0;
+	  // Merge with previous variables if they are linear too
+	  if (!blocks_.empty () && !blocks_.back ().joint &&
+	      blocks_.back ().rank + blocks_.back ().size == block.rank) {
+	    blocks_.back ().size += block.size;
+	    continue;
+	  }
+	}
+	blocks_.push_back (block);
+      }
+    }
+
+    void InterpolationPlan::interpolate (ConfigurationIn_t q0,
+					 ConfigurationIn_t q1, value_type u,
+					 ConfigurationOut_t result) const
+    {
+      for (Blocks_t::const_iterator it = blocks_.begin ();
+	   it != blocks_.end (); ++it) {
+	if (it->joint) {
+	  it->joint->configuration ()->interpolate (q0, q1, u, it->rank,
+						    result);
+	} else {
+	  result.segment (it->rank, it->size) =
+	    (1 - u) * q0.segment (it->rank, it->size) +
+	    u * q1.segment (it->rank, it->size);
+	}
+      }
+    }
+
+    void InterpolationPlan::interpolate (ConfigurationIn_t q0,
+					 ConfigurationIn_t q1, vectorIn_t u,
+					 matrixOut_t result) const
+    {
+      for (Blocks_t::const_iterator it = blocks_.begin ();
+	   it != blocks_.end (); ++it) {
+	if (it->joint) {
+	  model::JointConfiguration* jc = it->joint->configuration ();
+	  for (size_type i = 0; i < u.size (); ++i) {
+	    jc->interpolate (q0, q1, u [i], it->rank, result.col (i));
+	  }
+	} else {
+	  // One rank one update for all the parameters
+	  result.middleRows (it->rank, it->size).noalias () =
+	    q0.segment (it->rank, it->size) *
+	    (vector_t::Ones (u.size ()) - u).transpose () +
+	    q1.segment (it->rank, it->size) * u.transpose ();
+	}
+      }
+    }
+  } // namespace core
+} // namespace hpp
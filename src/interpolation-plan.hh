@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_INTERPOLATION_PLAN_HH
+# define HPP_CORE_INTERPOLATION_PLAN_HH
+
+# include <vector>
+# include <hpp/core/fwd.hh>
+
+namespace hpp {
+  namespace core {
+    /// Interpolation of the configurations of a device
+    ///
+    /// Consecutive configuration variables of translation joints and of
+    /// bounded rotation joints are grouped in blocks interpolated linearly
+    /// by one Eigen expression. The variables of the other joints are
+    /// interpolated by the joints.
+    ///
+    /// Plans are computed once per device and shared between the paths of
+    /// the device, see InterpolationPlan::get.
+    class InterpolationPlan
+    {
+    public:
+      /// Get the plan of a device
+      ///
+      /// The plan is computed at the first call, and again if the joints
+      /// of the device have changed since.
+      /// \note thread safe.
+      static InterpolationPlanPtr_t get (const DevicePtr_t& device);
+
+      /// Interpolate between two configurations
+      /// \param q0, q1 configurations at parameters 0 and 1,
+      /// \param u parameter,
+      /// \retval result configuration at parameter u.
+      void interpolate (ConfigurationIn_t q0, ConfigurationIn_t q1,
+			value_type u, ConfigurationOut_t result) const;
+
+      /// Interpolate between two configurations at several parameters
+      /// \param q0, q1 configurations at parameters 0 and 1,
+      /// \param u parameters,
+      /// \retval result column i is the configuration at parameter u [i].
+      ///
+      /// Each linear block is interpolated at once for all the parameters.
+      void interpolate (ConfigurationIn_t q0, ConfigurationIn_t q1,
+			vectorIn_t u, matrixOut_t result) const;
+
+    private:
+      /// Consecutive configuration variables interpolated together
+      struct Block {
+	size_type rank;
+	size_type size;
+	/// Joint that interpolates the variables, or 0x0 if the variables
+	/// are interpolated linearly.
+	JointPtr_t joint;
+      }; // struct Block
+      typedef std::vector <Block> Blocks_t;
+
+      explicit InterpolationPlan (const DevicePtr_t& device);
+
+      Blocks_t blocks_;
+      /// Joints of the device when the plan was computed
+      JointVector_t joints_;
+    }; // class InterpolationPlan
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_INTERPOLATION_PLAN_HH
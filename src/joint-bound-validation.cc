@@ -16,6 +16,8 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <cassert>
+#include <limits>
 #include <sstream>
 #include <hpp/model/device.hh>
 #include <hpp/model/joint.hh>
@@ -32,73 +34,130 @@ namespace hpp {
       return JointBoundValidationPtr_t (ptr);
     }
 
-    bool JointBoundValidation::validate (const Configuration_t& config,
-					 bool throwIfInValid)
+    ConfigValidationPtr_t JointBoundValidation::copy
+    (const DevicePtr_t& robot) const
     {
-      return validate (config, *((ValidationReport*)(0x0)), throwIfInValid);
+      return create (robot);
     }
 
-    bool JointBoundValidation::validate (const Configuration_t& config,
-					 ValidationReport&,
-					 bool throwIfInValid)
+    void JointBoundValidation::updateBounds ()
     {
-      const JointVector_t jv = robot_->getJointVector ();
+      const value_type inf = std::numeric_limits <value_type>::infinity ();
+      size_type configSize = robot_->configSize ();
+      lower_ = vector_t::Constant (configSize, -inf);
+      upper_ = vector_t::Constant (configSize, inf);
+      joints_.assign (configSize, JointPtr_t ());
+      ranks_.assign (configSize, 0);
+      const JointVector_t& jv = robot_->getJointVector ();
       for (JointVector_t::const_iterator itJoint = jv.begin ();
 	   itJoint != jv.end (); ++itJoint) {
 	size_type index = (*itJoint)->rankInConfiguration ();
 	JointConfigurationPtr_t jc = (*itJoint)->configuration ();
 	for (size_type i=0; i < (*itJoint)->configSize (); ++i) {
+	  joints_ [index + i] = *itJoint;
+	  ranks_ [index + i] = i;
 	  if (jc->isBounded (i)) {
-	    value_type lower = jc->lowerBound (i);
-	    value_type upper = jc->upperBound (i);
-	    value_type value = config [index + i];
-	    if (value < lower || upper < value) {
-	      if (throwIfInValid) {
-		std::ostringstream oss ("Joint: ");
-		oss << (*itJoint)->name () << ", rank: " << i
-		    << ", value out of range: " << value << " not in ["
-		    << lower << ", " << upper << "]";
-		throw JointBoundException (oss.str (), *itJoint, i, lower,
-					   upper, value);
-	      } else {
-		return false;
-	      }
-	    }
+	    lower_ [index + i] = jc->lowerBound (i);
+	    upper_ [index + i] = jc->upperBound (i);
 	  }
 	}
       }
-      return true;
+      // Extra configuration variables
+      size_type extraDim = robot_->extraConfigSpace ().dimension ();
+      size_type offset = configSize - extraDim;
+      for (size_type i = 0; i < extraDim; ++i) {
+	ranks_ [offset + i] = i;
+	lower_ [offset + i] = robot_->extraConfigSpace ().lower (i);
+	upper_ [offset + i] = robot_->extraConfigSpace ().upper (i);
+      }
+    }
+
+    size_type JointBoundValidation::firstOutOfBounds
+    (const Configuration_t& config) const
+    {
+      assert (config.size () == lower_.size ());
+      // Unbounded variables have infinite bounds.
+      if (!((config.array () < lower_.array ()) ||
+	    (upper_.array () < config.array ())).any ()) {
+	return config.size ();
+      }
+      size_type index = 0;
+      while (!(config [index] < lower_ [index] ||
+	       upper_ [index] < config [index])) ++index;
+      return index;
+    }
+
+    bool JointBoundValidation::validate (const Configuration_t& config,
+					 bool throwIfInValid)
+    {
+      return validate (config, *((ValidationReport*)(0x0)), throwIfInValid);
+    }
+
+    bool JointBoundValidation::validate (const Configuration_t& config,
+					 ValidationReport&,
+					 bool throwIfInValid)
+    {
+      size_type index = firstOutOfBounds (config);
+      if (index == config.size ()) return true;
+      if (throwIfInValid) {
+	std::ostringstream oss ("Joint: ");
+	if (joints_ [index]) {
+	  oss << joints_ [index]->name ();
+	} else {
+	  oss << "extra config space";
+	}
+	oss << ", rank: " << ranks_ [index]
+	    << ", value out of range: " << config [index] << " not in ["
+	    << lower_ [index] << ", " << upper_ [index] << "]";
+	throw JointBoundException (oss.str (), joints_ [index], ranks_ [index],
+				   lower_ [index], upper_ [index],
+				   config [index]);
+      }
+      return false;
     }
 
     bool JointBoundValidation::validate
     (const Configuration_t& config, ValidationReportPtr_t& validationReport)
     {
-      const JointVector_t jv = robot_->getJointVector ();
-      for (JointVector_t::const_iterator itJoint = jv.begin ();
-	   itJoint != jv.end (); ++itJoint) {
-	size_type index = (*itJoint)->rankInConfiguration ();
-	JointConfigurationPtr_t jc = (*itJoint)->configuration ();
-	for (size_type i=0; i < (*itJoint)->configSize (); ++i) {
-	  if (jc->isBounded (i)) {
-	    value_type lower = jc->lowerBound (i);
-	    value_type upper = jc->upperBound (i);
-	    value_type value = config [index + i];
-	    if (value < lower || upper < value) {
-	      JointBoundValidationReportPtr_t report
-		(new JointBoundValidationReport (*itJoint, i, lower, upper,
-						 value));
-	      validationReport = report;
-	      return false;
-	    }
-	  }
-	}
+      size_type index = firstOutOfBounds (config);
+      if (index == config.size ()) return true;
+      JointBoundValidationReportPtr_t report
+	(new JointBoundValidationReport (joints_ [index], ranks_ [index],
+					 lower_ [index], upper_ [index],
+					 config [index]));
+      validationReport = report;
+      return false;
+    }
+
+    bool JointBoundValidation::isValid (const Configuration_t& config)
+    {
+      assert (config.size () == lower_.size ());
+      return !((config.array () < lower_.array ()) ||
+	       (upper_.array () < config.array ())).any ();
+    }
+
+    bool JointBoundValidation::validateBatch (const matrix_t& configurations,
+					      std::vector <bool>& valid,
+					      bool stopAtFirst)
+    {
+      assert (configurations.rows () == lower_.size ());
+      valid.resize (configurations.cols ());
+      bool allValid = true;
+      for (size_type i = 0; i < configurations.cols (); ++i) {
+	bool inBounds =
+	  !((configurations.col (i).array () < lower_.array ()) ||
+	    (upper_.array () < configurations.col (i).array ())).any ();
+	// Configurations after the first invalid one are reported invalid
+	valid [i] = inBounds && (allValid || !stopAtFirst);
+	if (!inBounds) allValid = false;
       }
-      return true;
+      return allValid;
     }
 
     JointBoundValidation::JointBoundValidation (const DevicePtr_t& robot) :
-      robot_ (robot)
+      robot_ (robot), lower_ (), upper_ (), joints_ (), ranks_ ()
     {
+      updateBounds ();
     }
   } // namespace core
 } // namespace hpp
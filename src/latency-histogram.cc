@@ -0,0 +1,129 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <cmath>
+#include <hpp/core/latency-histogram.hh>
+
+namespace hpp {
+  namespace core {
+    namespace {
+      const std::size_t subBuckets = LatencyHistogram::subBuckets;
+      const std::size_t numberBuckets = LatencyHistogram::numberBuckets;
+      // log2 of subBuckets
+      const std::size_t precision = 4;
+
+      // Index of the most significant bit of a non zero value
+      std::size_t mostSignificantBit (boost::uint64_t value)
+      {
+	std::size_t result = 0;
+	while (value >>= 1) ++result;
+	return result;
+      }
+    } // namespace
+
+    const std::size_t LatencyHistogram::subBuckets;
+    const std::size_t LatencyHistogram::numberBuckets;
+
+    LatencyHistogram::Snapshot::Snapshot () :
+      counts (numberBuckets, 0), count (0), total (0), max (0)
+    {
+    }
+
+    value_type LatencyHistogram::Snapshot::mean () const
+    {
+      if (count == 0) return 0;
+      return 1e-6 * (value_type) total / (value_type) count;
+    }
+
+    value_type LatencyHistogram::Snapshot::quantile (value_type ratio) const
+    {
+      if (count == 0) return 0;
+      boost::uint64_t rank = (boost::uint64_t)
+	std::ceil (std::min (std::max (ratio, 0.), 1.) * (value_type) count);
+      if (rank == 0) rank = 1;
+      boost::uint64_t cumulated = 0;
+      for (std::size_t i = 0; i < counts.size (); ++i) {
+	cumulated += counts [i];
+	if (cumulated >= rank) {
+	  return 1e-6 * (value_type) std::min (upperBound (i) - 1, max);
+	}
+      }
+      return 1e-6 * (value_type) max;
+    }
+
+    std::ostream& LatencyHistogram::Snapshot::print (std::ostream& os) const
+    {
+      return os << "number: " << count << ", mean: " << 1e3 * mean ()
+		<< " ms, median: " << 1e3 * quantile (.5)
+		<< " ms, p99: " << 1e3 * quantile (.99)
+		<< " ms, max: " << 1e-3 * (value_type) max << " ms";
+    }
+
+    LatencyHistogram::LatencyHistogram ()
+    {
+      reset ();
+    }
+
+    void LatencyHistogram::reset ()
+    {
+      for (std::size_t i = 0; i < numberBuckets; ++i) {
+	counts_ [i].store (0, boost::memory_order_relaxed);
+      }
+      total_.store (0, boost::memory_order_relaxed);
+      max_.store (0, boost::memory_order_relaxed);
+    }
+
+    LatencyHistogram::Snapshot LatencyHistogram::snapshot () const
+    {
+      Snapshot result;
+      for (std::size_t i = 0; i < numberBuckets; ++i) {
+	result.counts [i] = counts_ [i].load (boost::memory_order_relaxed);
+	result.count += result.counts [i];
+      }
+      result.total = total_.load (boost::memory_order_relaxed);
+      result.max = max_.load (boost::memory_order_relaxed);
+      return result;
+    }
+
+    std::size_t LatencyHistogram::bucket (boost::uint64_t microseconds)
+    {
+      if (microseconds < subBuckets) return (std::size_t) microseconds;
+      const std::size_t msb = mostSignificantBit (microseconds);
+      const std::size_t sub = (std::size_t)
+	(microseconds >> (msb - precision)) & (subBuckets - 1);
+      return std::min (subBuckets * (msb - precision + 1) + sub,
+		       numberBuckets - 1);
+    }
+
+    boost::uint64_t LatencyHistogram::lowerBound (std::size_t bucket)
+    {
+      if (bucket < subBuckets) return bucket;
+      const std::size_t shift = bucket / subBuckets - 1;
+      return ((boost::uint64_t) (subBuckets + bucket % subBuckets)) << shift;
+    }
+
+    boost::uint64_t LatencyHistogram::upperBound (std::size_t bucket)
+    {
+      if (bucket < subBuckets) return bucket + 1;
+      const std::size_t shift = bucket / subBuckets - 1;
+      return lowerBound (bucket) + ((boost::uint64_t) 1 << shift);
+    }
+  } // namespace core
+} // namespace hpp
@@ -0,0 +1,226 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <hpp/util/debug.hh>
+#include <hpp/model/configuration.hh>
+#include <hpp/core/config-validations.hh>
+#include <hpp/core/configuration-shooter.hh>
+#include <hpp/core/connected-component.hh>
+#include <hpp/core/constraint-set.hh>
+#include <hpp/core/edge.hh>
+#include <hpp/core/lazy-prm-planner.hh>
+#include <hpp/core/node.hh>
+#include <hpp/core/path.hh>
+#include <hpp/core/path-projector.hh>
+#include <hpp/core/path-validation.hh>
+#include <hpp/core/problem.hh>
+#include <hpp/core/roadmap.hh>
+#include <hpp/core/steering-method.hh>
+#include "astar.hh"
+
+namespace hpp {
+  namespace core {
+    using model::displayConfig;
+
+    LazyPrmPlannerPtr_t LazyPrmPlanner::createWithRoadmap
+    (const Problem& problem, const RoadmapPtr_t& roadmap)
+    {
+      LazyPrmPlanner* ptr = new LazyPrmPlanner (problem, roadmap);
+      return LazyPrmPlannerPtr_t (ptr);
+    }
+
+    LazyPrmPlannerPtr_t LazyPrmPlanner::create (const Problem& problem)
+    {
+      LazyPrmPlanner* ptr = new LazyPrmPlanner (problem);
+      return LazyPrmPlannerPtr_t (ptr);
+    }
+
+    LazyPrmPlanner::LazyPrmPlanner (const Problem& problem):
+      PathPlanner (problem),
+      configurationShooter_ (problem.configurationShooter()),
+      unvalidated_ (), numberNeighbors_ (10)
+    {
+    }
+
+    LazyPrmPlanner::LazyPrmPlanner (const Problem& problem,
+				    const RoadmapPtr_t& roadmap) :
+      PathPlanner (problem, roadmap),
+      configurationShooter_ (problem.configurationShooter()),
+      unvalidated_ (), numberNeighbors_ (10)
+    {
+    }
+
+    void LazyPrmPlanner::init (const LazyPrmPlannerWkPtr_t& weak)
+    {
+      PathPlanner::init (weak);
+      weakPtr_ = weak;
+    }
+
+    void LazyPrmPlanner::startSolve ()
+    {
+      PathPlanner::startSolve ();
+      // The roadmap may have been cleared or edited since last resolution
+      const Edges_t& edges (roadmap ()->edges ());
+      std::set <EdgePtr_t> unvalidated;
+      for (Edges_t::const_iterator itEdge = edges.begin ();
+	   itEdge != edges.end (); ++itEdge) {
+	if (unvalidated_.count (*itEdge)) unvalidated.insert (*itEdge);
+      }
+      unvalidated_.swap (unvalidated);
+    }
+
+    void LazyPrmPlanner::tryDirectPath ()
+    {
+      PathPlanner::tryDirectPath ();
+      validateShortestPath ();
+    }
+
+    void LazyPrmPlanner::pruneRoadmap ()
+    {
+      Nodes_t kept;
+      for (std::set <EdgePtr_t>::const_iterator it = unvalidated_.begin ();
+	   it != unvalidated_.end (); ++it) {
+	kept.push_back ((*it)->from ());
+	kept.push_back ((*it)->to ());
+      }
+      roadmap ()->prune (kept);
+    }
+
+    void LazyPrmPlanner::oneStep ()
+    {
+      typedef std::vector <std::pair <NodePtr_t, PathPtr_t> > Neighbors_t;
+      RoadmapPtr_t r (roadmap ());
+      ConfigValidationsPtr_t configValidations
+	(problem ().configValidations ());
+      const ConstraintSetPtr_t& constraints (problem ().constraints ());
+      const SteeringMethodPtr_t& sm (problem ().steeringMethod ());
+      PathProjectorPtr_t pathProjector (problem ().pathProjector ());
+
+      // Shoot random configurations until one is valid
+      ConfigurationPtr_t q_rand;
+      ValidationReportPtr_t report;
+      do {
+	q_rand = configurationShooter_->shoot ();
+      } while ((constraints && !constraints->apply (*q_rand)) ||
+	       !configValidations->validate (*q_rand, report));
+
+      // Compute paths to nearest nodes of each connected component before
+      // inserting edges, since edges merge connected components.
+      Neighbors_t neighbors;
+      for (ConnectedComponents_t::const_iterator itcc =
+	     r->connectedComponents ().begin ();
+	   itcc != r->connectedComponents ().end (); ++itcc) {
+	value_type distance;
+	Nodes_t nodes (r->nearestNodes (q_rand, *itcc, numberNeighbors_,
+					distance));
+	for (Nodes_t::const_iterator itNode = nodes.begin ();
+	     itNode != nodes.end (); ++itNode) {
+	  PathPtr_t path = (*sm) (*((*itNode)->configuration ()), *q_rand);
+	  if (!path) continue;
+	  if (pathProjector) {
+	    PathPtr_t projPath;
+	    if (!pathProjector->apply (path, projPath)) continue;
+	    path = projPath;
+	  }
+	  neighbors.push_back (std::make_pair (*itNode, path));
+	}
+      }
+      NodePtr_t newNode = r->addNode (q_rand);
+      for (Neighbors_t::const_iterator itNeighbor = neighbors.begin ();
+	   itNeighbor != neighbors.end (); ++itNeighbor) {
+	const NodePtr_t& near = itNeighbor->first;
+	const PathPtr_t& path = itNeighbor->second;
+	interval_t timeRange = path->timeRange ();
+	unvalidated_.insert (r->addEdge (near, newNode, path));
+	unvalidated_.insert (r->addEdge (newNode, near, path->extract
+					 (interval_t (timeRange.second,
+						      timeRange.first))));
+      }
+      validateShortestPath ();
+    }
+
+    void LazyPrmPlanner::validateShortestPath ()
+    {
+      RoadmapPtr_t r (roadmap ());
+      while (r->pathExists ()) {
+	// The incremental search of the roadmap only repairs the costs of the
+	// nodes affected by the removed edges. It does not support path costs.
+	Edges_t edges;
+	if (pathCost ()) {
+	  Astar astar (r, problem ().distance (), pathCost ());
+	  edges = astar.solutionEdges ();
+	} else {
+	  edges = r->shortestPathEdges (problem ().distance ());
+	}
+	EdgePtr_t invalid (0x0);
+	for (Edges_t::const_iterator itEdge = edges.begin ();
+	     itEdge != edges.end (); ++itEdge) {
+	  if (unvalidated_.count (*itEdge) && !validate (*itEdge)) {
+	    invalid = *itEdge;
+	    break;
+	  }
+	}
+	if (!invalid) return;
+	unvalidated_.erase (invalid);
+	EdgePtr_t reverseEdge (reverse (invalid));
+	hppDout (info, "remove invalid edge between "
+		 << displayConfig (*(invalid->from ()->configuration ()))
+		 << " and "
+		 << displayConfig (*(invalid->to ()->configuration ())));
+	r->removeEdge (invalid);
+	if (reverseEdge) {
+	  unvalidated_.erase (reverseEdge);
+	  r->removeEdge (reverseEdge);
+	}
+      }
+    }
+
+    bool LazyPrmPlanner::validate (const EdgePtr_t& edge)
+    {
+      PathValidationPtr_t pathValidation (problem ().pathValidation ());
+      PathPtr_t path (edge->path ());
+      if (!path || !pathValidation->isValid (path)) {
+	return false;
+      }
+      unvalidated_.erase (edge);
+      // Both edges between two nodes have the same support
+      EdgePtr_t reverseEdge (reverse (edge));
+      if (reverseEdge) unvalidated_.erase (reverseEdge);
+      return true;
+    }
+
+    EdgePtr_t LazyPrmPlanner::reverse (const EdgePtr_t& edge) const
+    {
+      const Node::Edges_t& outEdges (edge->to ()->outEdges ());
+      for (Node::Edges_t::const_iterator itEdge = outEdges.begin ();
+	   itEdge != outEdges.end (); ++itEdge) {
+	if ((*itEdge)->to () == edge->from () &&
+	    unvalidated_.count (*itEdge)) {
+	  return *itEdge;
+	}
+      }
+      return EdgePtr_t (0x0);
+    }
+
+    void LazyPrmPlanner::configurationShooter
+    (const ConfigurationShooterPtr_t& shooter)
+    {
+      configurationShooter_ = shooter;
+    }
+  } // namespace core
+} // namespace hpp
@@ -0,0 +1,281 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_LPA_STAR_HH
+# define HPP_CORE_LPA_STAR_HH
+
+# include <limits>
+# include <queue>
+# include <vector>
+# include <functional>
+# include <hpp/core/fwd.hh>
+# include <hpp/core/distance.hh>
+# include <hpp/core/edge.hh>
+# include <hpp/core/node.hh>
+# include <hpp/core/operation-counters.hh>
+# include <hpp/core/path-vector.hh>
+# include <hpp/core/roadmap.hh>
+
+namespace hpp {
+  namespace core {
+    /// Lifelong Planning A*
+    ///
+    /// Shortest path search from the initial node to the goal nodes of a
+    /// roadmap, that keeps its result between calls. When edges are added or
+    /// removed, or when goal nodes change, only costs of the affected nodes
+    /// are repaired. The search restarts from scratch if the initial node or
+    /// the distance change.
+    ///
+    /// Goal nodes are linked by edges of zero cost to a virtual goal vertex
+    /// of index 0, node of index i is vertex i + 1.
+    class LpaStar
+    {
+      // key of a vertex and vertex index
+      typedef std::pair <value_type, value_type> Key_t;
+      typedef std::pair <Key_t, std::size_t> QueueElement_t;
+      typedef std::priority_queue <QueueElement_t,
+				   std::vector <QueueElement_t>,
+				   std::greater <QueueElement_t> > Queue_t;
+      Roadmap* roadmap_;
+      DistancePtr_t distance_;
+      NodePtr_t initNode_;
+      Nodes_t goalNodes_;
+      std::vector <NodePtr_t> nodes_;
+      // cost from initial node
+      std::vector <value_type> g_;
+      // one step lookahead cost from initial node
+      std::vector <value_type> rhs_;
+      // edge realizing rhs_
+      std::vector <EdgePtr_t> parent_;
+      // goal node realizing rhs_ [0]
+      NodePtr_t bestGoal_;
+      std::vector <bool> isGoal_;
+      Queue_t queue_;
+      // nodes with incoming edges added or removed since last search
+      std::vector <NodePtr_t> changed_;
+
+    public:
+      LpaStar (Roadmap* roadmap) :
+	roadmap_ (roadmap), distance_ (), initNode_ (0x0), goalNodes_ (),
+	nodes_ (), g_ (), rhs_ (), parent_ (), bestGoal_ (0x0), isGoal_ (),
+	queue_ (), changed_ ()
+      {
+      }
+
+      /// Notify that an edge has been added to the roadmap
+      void edgeAdded (const EdgePtr_t& edge)
+      {
+	changed_.push_back (edge->to ());
+      }
+
+      /// Notify that an edge is going to be removed from the roadmap
+      void edgeRemoved (const EdgePtr_t& edge)
+      {
+	std::size_t v = edge->to ()->index () + 1;
+	if (v < parent_.size () && parent_ [v] == edge) {
+	  parent_ [v] = EdgePtr_t (0x0);
+	}
+	changed_.push_back (edge->to ());
+      }
+
+      /// Compute edges of shortest path from initial node to goal nodes
+      /// \param distance distance used as heuristic
+      /// \retval edges edges from the initial node to the nearest goal node.
+      void solutionEdges (const DistancePtr_t& distance, Edges_t& edges)
+      {
+	update (distance);
+	computeShortestPath ();
+	if (g_ [0] == std::numeric_limits <value_type>::infinity ()) {
+	  throw std::runtime_error
+	    ("LPA* failed to find a solution to the goal.");
+	}
+	edges.clear ();
+	NodePtr_t node = bestGoal_;
+	while (node != initNode_) {
+	  EdgePtr_t edge = parent_ [node->index () + 1];
+	  assert (edge);
+	  edges.push_front (edge);
+	  node = edge->from ();
+	}
+      }
+
+      /// Compute shortest path from initial node to goal nodes
+      /// \param distance distance used as heuristic
+      PathVectorPtr_t solution (const DistancePtr_t& distance)
+      {
+	Edges_t edges;
+	solutionEdges (distance, edges);
+	PathVectorPtr_t pathVector;
+	for (Edges_t::const_iterator itEdge = edges.begin ();
+	     itEdge != edges.end (); ++itEdge) {
+	  const PathPtr_t& path ((*itEdge)->path ());
+	  if (!path) {
+	    throw std::runtime_error
+	      ("Failed to compute the path of an edge of the solution.");
+	  }
+	  if (!pathVector)
+	    pathVector = PathVector::create (path->outputSize (),
+					     path->outputDerivativeSize ());
+	  pathVector->appendPath (path);
+	}
+	return pathVector;
+      }
+
+    private:
+      // Take into account changes in the roadmap since last search
+      void update (const DistancePtr_t& distance)
+      {
+	const value_type inf = std::numeric_limits <value_type>::infinity ();
+	std::size_t size = roadmap_->nodeIndexBound () + 1;
+	if (distance != distance_ || roadmap_->initNode () != initNode_) {
+	  distance_ = distance;
+	  initNode_ = roadmap_->initNode ();
+	  nodes_.clear ();
+	  g_.clear ();
+	  rhs_.clear ();
+	  parent_.clear ();
+	  changed_.clear ();
+	  goalNodes_.clear ();
+	  queue_ = Queue_t ();
+	}
+	// New nodes are not reached yet
+	nodes_.resize (size, NodePtr_t (0x0));
+	g_.resize (size, inf);
+	rhs_.resize (size, inf);
+	parent_.resize (size, EdgePtr_t (0x0));
+	bool goalsChanged = (roadmap_->goalNodes () != goalNodes_);
+	if (goalsChanged) {
+	  goalNodes_ = roadmap_->goalNodes ();
+	  isGoal_.assign (size, false);
+	  for (Nodes_t::const_iterator itGoal = goalNodes_.begin ();
+	       itGoal != goalNodes_.end (); ++itGoal) {
+	    isGoal_ [(*itGoal)->index () + 1] = true;
+	    nodes_ [(*itGoal)->index () + 1] = *itGoal;
+	  }
+	}
+	isGoal_.resize (size, false);
+	std::size_t start = initNode_->index () + 1;
+	if (!nodes_ [start]) {
+	  nodes_ [start] = initNode_;
+	  rhs_ [start] = 0;
+	  queue_.push (QueueElement_t (key (start), start));
+	}
+	for (std::vector <NodePtr_t>::const_iterator it = changed_.begin ();
+	     it != changed_.end (); ++it) {
+	  nodes_ [(*it)->index () + 1] = *it;
+	  updateVertex ((*it)->index () + 1);
+	}
+	changed_.clear ();
+	if (goalsChanged) {
+	  // Costs from the initial node do not depend on goals, only keys of
+	  // vertices in the queue need to be updated.
+	  updateVertex (0);
+	  queue_ = Queue_t ();
+	  for (std::size_t v = 0; v < size; ++v) {
+	    if (g_ [v] != rhs_ [v]) queue_.push (QueueElement_t (key (v), v));
+	  }
+	}
+      }
+
+      void computeShortestPath ()
+      {
+	while (!queue_.empty ()) {
+	  const QueueElement_t top = queue_.top ();
+	  if (!(top.first < key (0)) && rhs_ [0] == g_ [0]) break;
+	  queue_.pop ();
+	  OperationCounters::increment (OperationCounters::ASTAR_EXPANSION);
+	  std::size_t v = top.second;
+	  // Vertices are pushed each time their key changes, older entries
+	  // are skipped.
+	  if (g_ [v] == rhs_ [v]) continue;
+	  Key_t k = key (v);
+	  if (top.first < k) {
+	    queue_.push (QueueElement_t (k, v));
+	  } else if (g_ [v] > rhs_ [v]) {
+	    g_ [v] = rhs_ [v];
+	    updateSuccessors (v);
+	  } else {
+	    g_ [v] = std::numeric_limits <value_type>::infinity ();
+	    updateVertex (v);
+	    updateSuccessors (v);
+	  }
+	}
+      }
+
+      void updateSuccessors (std::size_t v)
+      {
+	if (v == 0) return;
+	const NodePtr_t& node = nodes_ [v];
+	for (Node::Edges_t::const_iterator itEdge = node->outEdges ().begin ();
+	     itEdge != node->outEdges ().end (); ++itEdge) {
+	  NodePtr_t child ((*itEdge)->to ());
+	  nodes_ [child->index () + 1] = child;
+	  updateVertex (child->index () + 1);
+	}
+	if (isGoal_ [v]) updateVertex (0);
+      }
+
+      void updateVertex (std::size_t v)
+      {
+	const value_type inf = std::numeric_limits <value_type>::infinity ();
+	if (v != 0 && nodes_ [v] == initNode_) return;
+	value_type rhs = inf;
+	if (v == 0) {
+	  bestGoal_ = 0x0;
+	  for (Nodes_t::const_iterator itGoal = goalNodes_.begin ();
+	       itGoal != goalNodes_.end (); ++itGoal) {
+	    value_type cost = g_ [(*itGoal)->index () + 1];
+	    if (cost < rhs) {
+	      rhs = cost;
+	      bestGoal_ = *itGoal;
+	    }
+	  }
+	} else {
+	  parent_ [v] = EdgePtr_t (0x0);
+	  if (!nodes_ [v]) return;
+	  const Node::Edges_t& inEdges (nodes_ [v]->inEdges ());
+	  for (Node::Edges_t::const_iterator itEdge = inEdges.begin ();
+	       itEdge != inEdges.end (); ++itEdge) {
+	    value_type cost = g_ [(*itEdge)->from ()->index () + 1] +
+	      (*itEdge)->length ();
+	    if (cost < rhs) {
+	      rhs = cost;
+	      parent_ [v] = *itEdge;
+	    }
+	  }
+	}
+	rhs_ [v] = rhs;
+	if (g_ [v] != rhs_ [v]) queue_.push (QueueElement_t (key (v), v));
+      }
+
+      Key_t key (std::size_t v)
+      {
+	value_type k = std::min (g_ [v], rhs_ [v]);
+	return Key_t (k + heuristic (v), k);
+      }
+
+      value_type heuristic (std::size_t v)
+      {
+	if (v == 0) return 0;
+	return roadmap_->distanceToGoal (distance_, nodes_ [v]);
+      }
+    }; // class LpaStar
+  } //   namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_LPA_STAR_HH
@@ -0,0 +1,86 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#ifndef HPP_CORE_MEMORY_USAGE_HH
+# define HPP_CORE_MEMORY_USAGE_HH
+
+# include <deque>
+# include <list>
+# include <map>
+# include <set>
+# include <string>
+# include <vector>
+# include <Eigen/Core>
+
+namespace hpp {
+  namespace core {
+    /// Estimates of the memory allocated by containers, in bytes
+    ///
+    /// Used by the memoryUsage methods. Containers based on trees or linked
+    /// lists are assumed to allocate four pointers per element in addition
+    /// to the element.
+    namespace memory {
+      static const std::size_t nodeOverhead = 4 * sizeof (void*);
+
+      template <typename Derived>
+      std::size_t bytes (const Eigen::PlainObjectBase <Derived>& m)
+      {
+	return (std::size_t) m.size () * sizeof (typename Derived::Scalar);
+      }
+
+      template <typename T>
+      std::size_t bytes (const std::vector <T>& v)
+      {
+	return v.capacity () * sizeof (T);
+      }
+
+      // Blocks of a deque are not all full: the estimate is a lower bound.
+      template <typename T>
+      std::size_t bytes (const std::deque <T>& d)
+      {
+	return d.size () * sizeof (T);
+      }
+
+      template <typename T>
+      std::size_t bytes (const std::list <T>& l)
+      {
+	return l.size () * (sizeof (T) + nodeOverhead);
+      }
+
+      template <typename T>
+      std::size_t bytes (const std::set <T>& s)
+      {
+	return s.size () * (sizeof (T) + nodeOverhead);
+      }
+
+      template <typename K, typename T>
+      std::size_t bytes (const std::map <K, T>& m)
+      {
+	return m.size () * (sizeof (K) + sizeof (T) + nodeOverhead);
+      }
+
+      inline std::size_t bytes (const std::string& s)
+      {
+	return s.capacity ();
+      }
+    } // namespace memory
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_MEMORY_USAGE_HH
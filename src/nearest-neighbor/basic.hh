@@ -20,8 +20,12 @@
 # define HPP_CORE_NEAREST_NEIGHBOR_BASIC_HH
 
 # include <limits>
+# include <vector>
+# include <algorithm>
 # include <hpp/core/fwd.hh>
+# include <hpp/core/connected-component.hh>
 # include <hpp/core/distance.hh>
+# include <hpp/core/node.hh>
 # include <hpp/core/nearest-neighbor.hh>
 
 namespace hpp {
@@ -48,18 +52,28 @@ namespace hpp {
       {
       }
 
+      // Nodes are read from the connected components.
+      void removeNode (const NodePtr_t&)
+      {
+      }
+
+      using NearestNeighbor::search;
+
       virtual NodePtr_t search (const ConfigurationPtr_t& configuration,
 			       const ConnectedComponentPtr_t&
 				connectedComponent,
-			       value_type& distance)
+			       value_type& distance, bool = false)
       {
 	NodePtr_t result = NULL;
 	distance = std::numeric_limits <value_type>::infinity ();
-	for (Nodes_t::const_iterator itNode =
-	       connectedComponent->nodes ().begin ();
-	     itNode != connectedComponent->nodes ().end (); ++itNode) {
-	  value_type d = (*distance_) (*(*itNode)->configuration (),
-				       *configuration);
+	const Configuration_t& q (*configuration);
+	// Distances to nodes farther than the nearest node found so far are
+	// not computed exactly.
+	const Nodes_t& ccNodes (connectedComponent->nodes ());
+	for (Nodes_t::const_iterator itNode = ccNodes.begin ();
+	     itNode != ccNodes.end (); ++itNode) {
+	  value_type d = distance_->boundedDistance
+	    (q, *(*itNode)->configuration (), distance);
 	  if (d < distance) {
 	    distance = d;
 	    result = *itNode;
@@ -69,6 +83,37 @@ namespace hpp {
 	return result;
       }
 
+      virtual Nodes_t KNearest (const ConfigurationPtr_t& configuration,
+				const ConnectedComponentPtr_t&
+				connectedComponent,
+				std::size_t K, value_type& distance)
+      {
+	std::vector <NodeAndDistance_t> nodes;
+	computeDistances (configuration, connectedComponent,
+			  std::numeric_limits <value_type>::infinity (), nodes);
+	if (K < nodes.size ()) {
+	  std::partial_sort (nodes.begin (), nodes.begin () + K, nodes.end (),
+			     closer);
+	  nodes.resize (K);
+	} else {
+	  std::sort (nodes.begin (), nodes.end (), closer);
+	}
+	distance = nodes.empty () ?
+	  std::numeric_limits <value_type>::infinity () : nodes.back ().second;
+	return toNodes (nodes);
+      }
+
+      virtual Nodes_t withinRadius (const ConfigurationPtr_t& configuration,
+				    const ConnectedComponentPtr_t&
+				    connectedComponent,
+				    value_type radius)
+      {
+	std::vector <NodeAndDistance_t> nodes;
+	computeDistances (configuration, connectedComponent, radius, nodes);
+	std::sort (nodes.begin (), nodes.end (), closer);
+	return toNodes (nodes);
+      }
+
       virtual void merge (ConnectedComponentPtr_t, ConnectedComponentPtr_t)
       {
       }
@@ -79,7 +124,54 @@ namespace hpp {
 	return distance_;
       }
 
+      virtual std::size_t memoryUsage () const
+      {
+	return sizeof (Basic);
+      }
+
     private:
+      // Store nodes of the connected component within radius together with
+      // their distance to the configuration.
+      // Configurations are copied by batches in a local buffer, so that
+      // concurrent searches do not share memory, and distances are computed
+      // in batch by the distance function.
+      void computeDistances (const ConfigurationPtr_t& configuration,
+			     const ConnectedComponentPtr_t& connectedComponent,
+			     value_type radius,
+			     std::vector <NodeAndDistance_t>& nodes)
+      {
+	static const size_type batchSize = 64;
+	matrix_t configurations (configuration->size (), batchSize);
+	vector_t distances (batchSize);
+	const Nodes_t& ccNodes (connectedComponent->nodes ());
+	nodes.reserve (ccNodes.size ());
+	Nodes_t::const_iterator itNode = ccNodes.begin ();
+	while (itNode != ccNodes.end ()) {
+	  Nodes_t::const_iterator itBatch = itNode;
+	  size_type n = 0;
+	  for (; itNode != ccNodes.end () && n < batchSize; ++itNode, ++n) {
+	    configurations.col (n) = *(*itNode)->configuration ();
+	  }
+	  distance_->distances (*configuration, configurations.leftCols (n),
+				distances.head (n));
+	  for (size_type i=0; i < n; ++i, ++itBatch) {
+	    if (distances [i] <= radius) {
+	      nodes.push_back (NodeAndDistance_t (*itBatch, distances [i]));
+	    }
+	  }
+	}
+      }
+
+      static Nodes_t toNodes (const std::vector <NodeAndDistance_t>& nodes)
+      {
+	Nodes_t result;
+	for (std::vector <NodeAndDistance_t>::const_iterator it =
+	       nodes.begin (); it != nodes.end (); ++it) {
+	  result.push_back (it->first);
+	}
+	return result;
+      }
+
       const DistancePtr_t distance_;
     }; // class Basic
     } // namespace nearestNeighbor
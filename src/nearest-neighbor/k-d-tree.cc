@@ -17,7 +17,11 @@
 // <http://www.gnu.org/licenses/>.
 
 #include <iostream>
+#include <limits>
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <stdexcept>
 #include <hpp/util/debug.hh>
 #include <hpp/core/distance.hh>
 #include <hpp/core/node.hh>
@@ -25,25 +29,115 @@
 #include <hpp/model/joint-configuration.hh>
 #include <hpp/model/device.hh>
 #include <hpp/core/weighed-distance.hh>
+#include <hpp/core/trace.hh>
 #include "../src/nearest-neighbor/k-d-tree.hh"
+#include "memory-usage.hh"
 
 using namespace std;
 
 namespace hpp {
   namespace core {
     namespace nearestNeighbor {
+    // Distance between a value and an interval
+    static value_type gap (value_type q, value_type lower, value_type upper)
+    {
+      if (q < lower) return lower - q;
+      if (q > upper) return q - upper;
+      return 0;
+    }
+
+    size_type ComponentIds::insert (const ConnectedComponentPtr_t&
+				    connectedComponent)
+    {
+      std::map <ConnectedComponentPtr_t, size_type>::const_iterator it =
+	ids_.find (connectedComponent);
+      if (it != ids_.end ()) return root (it->second);
+      size_type id = parents_.size ();
+      parents_.push_back (id);
+      ids_ [connectedComponent] = id;
+      return id;
+    }
+
+    size_type ComponentIds::find (const ConnectedComponentPtr_t&
+				  connectedComponent)
+    {
+      std::map <ConnectedComponentPtr_t, size_type>::const_iterator it =
+	ids_.find (connectedComponent);
+      if (it == ids_.end ()) return -1;
+      return root (it->second);
+    }
+
+    size_type ComponentIds::root (size_type id)
+    {
+      // Path halving
+      while (parents_ [id] != id) {
+	parents_ [id] = parents_ [parents_ [id]];
+	id = parents_ [id];
+      }
+      return id;
+    }
+
+    void ComponentIds::merge (const ConnectedComponentPtr_t& cc1,
+			      const ConnectedComponentPtr_t& cc2)
+    {
+      std::map <ConnectedComponentPtr_t, size_type>::iterator it2 =
+	ids_.find (cc2);
+      // No node of cc2 in the tree.
+      if (it2 == ids_.end ()) return;
+      size_type id2 = it2->second;
+      // cc2 is going to be deleted, another connected component may be
+      // allocated at the same address.
+      ids_.erase (it2);
+      std::map <ConnectedComponentPtr_t, size_type>::const_iterator it1 =
+	ids_.find (cc1);
+      if (it1 == ids_.end ()) {
+	ids_ [cc1] = id2;
+	return;
+      }
+      size_type root1 = root (it1->second);
+      size_type root2 = root (id2);
+      if (root1 == root2) return;
+      parents_ [root2] = root1;
+      ++merges_;
+    }
+
+    std::size_t ComponentIds::memoryUsage () const
+    {
+      return sizeof (ComponentIds) + memory::bytes (ids_) +
+	memory::bytes (parents_);
+    }
+
+    void ComponentIds::clear ()
+    {
+      ids_.clear ();
+      parents_.clear ();
+      ++merges_;
+    }
+
     // Constructor with the mother tree node (same bounds)
     KDTree::KDTree (const KDTreePtr_t mother, size_type splitDim) :
       robot_(mother->robot_),
       dim_(mother->dim_),
       distance_(mother->distance_),
       weights_ (mother->weights_),
-      nodesMap_(),
+      typeDims_ (mother->typeDims_),
+      components_ (mother->components_),
+      ccIds_ (),
+      merges_ (mother->components_->merges ()),
+      depth_ (mother->depth_ + 1),
+      size_ (0),
+      configurations_(),
+      nodes_(),
+      nodeIds_(),
+      distances_(),
       bucketSize_(mother->bucketSize_),
       bucket_(0),
+      removed_(0),
       splitDim_(splitDim),
       upperBounds_(mother->upperBounds_),
       lowerBounds_(mother->lowerBounds_),
+      lowerData_(std::numeric_limits <value_type>::infinity ()),
+      upperData_(-std::numeric_limits <value_type>::infinity ()),
       supChild_(0x0),
       infChild_(0x0)
     {
@@ -55,12 +149,24 @@ namespace hpp {
       dim_(),
       distance_(HPP_DYNAMIC_PTR_CAST (WeighedDistance, distance)),
       weights_ (robot->configSize ()),
-      nodesMap_(),
+      typeDims_ (robot->configSize (), BOUNDED),
+      components_ (new ComponentIds),
+      ccIds_ (),
+      merges_ (0),
+      depth_ (0),
+      size_ (0),
+      configurations_(),
+      nodes_(),
+      nodeIds_(),
+      distances_(),
       bucketSize_(bucketSize),
       bucket_(0),
+      removed_(0),
       splitDim_(),
       upperBounds_(),
       lowerBounds_(),
+      lowerData_(std::numeric_limits <value_type>::infinity ()),
+      upperData_(-std::numeric_limits <value_type>::infinity ()),
       supChild_(),
       infChild_()
        {
@@ -71,13 +177,32 @@ namespace hpp {
 	     (robot_, std::vector <value_type> (jointVector.size (), 1.0));
 	 }
 	 size_type i=0;
-	 // Fill vector of weights. index of vector is configuration coordinate
-	 // and not joint rank in robot.
+	 // Fill vectors of weights and types. index of vector is
+	 // configuration coordinate and not joint rank in robot. The distance
+	 // only stores weights for joints with degrees of freedom. Extra
+	 // configuration space coordinates keep a zero weight: they are never
+	 // split and never prune the search.
+	 // The distance of a joint is bounded below by its weight times the
+	 // distance between coordinates, with a period of 2 pi for angles of
+	 // unbounded rotations, and up to the sign for quaternions: the chord
+	 // between two unit quaternions is smaller than the angle of the
+	 // rotation between them.
+	 weights_.setZero ();
 	 for (JointVector_t::const_iterator itJoint = jointVector.begin ();
 	      itJoint != jointVector.end (); ++itJoint) {
-	   weights_.segment ((*itJoint)->rankInConfiguration (),
-			     (*itJoint)->configSize ()).setConstant
-         (distance_->getWeight (i));
+	   if ((*itJoint)->numberDof () == 0) continue;
+	   size_type rank = (*itJoint)->rankInConfiguration ();
+	   size_type size = (*itJoint)->configSize ();
+	   DimensionType type = BOUNDED;
+	   if (dynamic_cast <model::JointSO3*> (*itJoint)) {
+	     type = QUATERNION;
+	   } else if (dynamic_cast <model::jointRotation::UnBounded*>
+		      (*itJoint) && size == 1) {
+	     type = LOOPED;
+	   }
+	   std::fill (typeDims_.begin () + rank, typeDims_.begin () + rank +
+		      size, type);
+	   weights_.segment (rank, size).setConstant (distance_->getWeight (i));
 	   ++i;
 	 }
       this->findDeviceBounds();
@@ -87,55 +212,241 @@ namespace hpp {
       infChild_ = NULL;
     }
 
+    std::size_t KDTree::memoryUsage () const
+    {
+      std::size_t result = sizeof (KDTree) + memory::bytes (weights_) +
+	memory::bytes (ccIds_) + memory::bytes (configurations_) +
+	memory::bytes (nodes_) + memory::bytes (nodeIds_) +
+	memory::bytes (distances_) + memory::bytes (upperBounds_) +
+	memory::bytes (lowerBounds_) + memory::bytes (typeDims_);
+      // Connected component ids are shared by the boxes of the tree
+      if (depth_ == 0) result += components_->memoryUsage ();
+      if (supChild_) result += supChild_->memoryUsage ();
+      if (infChild_) result += infChild_->memoryUsage ();
+      return result;
+    }
+
     KDTree::~KDTree() {
       clear ();
     }
 
     // find the leaf node in the tree for the configuration of the node
-    KDTreePtr_t KDTree::findLeaf (const NodePtr_t& node) {
+    KDTreePtr_t KDTree::findLeaf (const NodePtr_t& node, size_type id,
+				  std::vector <KDTreePtr_t>& path) {
       KDTreePtr_t CurrentTree = this;
-      CurrentTree->nodesMap_[node->connectedComponent()];
-      while ( CurrentTree->supChild_ != NULL && CurrentTree->infChild_ != NULL)
-	{
-	  if ( (*(node->configuration()))[CurrentTree->supChild_->splitDim_]
-	       > CurrentTree->supChild_->lowerBounds_[CurrentTree->supChild_
-						      ->splitDim_] )  {
-	    CurrentTree = CurrentTree->supChild_;
-	    CurrentTree->nodesMap_[node->connectedComponent()];
-	  }
-	  else {
-	    CurrentTree = CurrentTree->infChild_;
-	    CurrentTree->nodesMap_[node->connectedComponent()];
-	  }
+      while (true) {
+	path.push_back (CurrentTree);
+	++CurrentTree->size_;
+	CurrentTree->ccIds_.insert (id);
+	if (CurrentTree->supChild_ == NULL || CurrentTree->infChild_ == NULL) {
+	  return CurrentTree;
 	}
-      return CurrentTree;
+	// The range of the leaf is extended when the node is stored.
+	CurrentTree->extendRange (*(node->configuration ()));
+	if ( (*(node->configuration()))[CurrentTree->supChild_->splitDim_]
+	     > CurrentTree->supChild_->lowerBounds_[CurrentTree->supChild_
+						    ->splitDim_] )  {
+	  CurrentTree = CurrentTree->supChild_;
+	}
+	else {
+	  CurrentTree = CurrentTree->infChild_;
+	}
+      }
     }
 
 
     void KDTree::addNode (const NodePtr_t& node) {
+      size_type id = components_->insert (node->connectedComponent ());
+      std::vector <KDTreePtr_t> path;
+      KDTreePtr_t Leaf = this->findLeaf(node, id, path);
+      Leaf->store (node, id);
+      if (Leaf->bucket_ > bucketSize_) {
+	Leaf->distribute ();
+	balance (path);
+      }
+    }
 
-      KDTreePtr_t Leaf = this->findLeaf(node);
-      if ( Leaf->bucket_ < bucketSize_ ) {
-	Leaf->nodesMap_[node->connectedComponent()].push_front(node);
-	Leaf->bucket_++;
+    void KDTree::removeNode (const NodePtr_t& node) {
+      std::vector <KDTreePtr_t> path;
+      KDTreePtr_t current = this;
+      path.push_back (current);
+      while (current->supChild_ != NULL && current->infChild_ != NULL) {
+	if ( (*(node->configuration()))[current->supChild_->splitDim_]
+	     > current->supChild_->lowerBounds_[current->supChild_
+						->splitDim_] )  {
+	  current = current->supChild_;
+	}
+	else {
+	  current = current->infChild_;
+	}
+	path.push_back (current);
       }
-      else {
-	Leaf->split();
-	for ( NodesMap_t::iterator map = Leaf->nodesMap_.begin();
-	      map != Leaf->nodesMap_.end(); ++map) {
-	  for (Nodes_t::iterator it = map->second.begin ();
-	       it != map->second.end (); ++it) {
-	    Leaf->addNode(*it);
-	  }
-	  map->second.clear();
+      std::size_t i = 0;
+      while (i < current->bucket_ &&
+	     (current->nodes_ [i] != node || current->nodeIds_ [i] < 0)) ++i;
+      if (i == current->bucket_) {
+	throw std::runtime_error ("Attempt to remove a node that is not in "
+				  "the KDTree");
+      }
+      current->nodeIds_ [i] = -1;
+      ++current->removed_;
+      for (std::vector <KDTreePtr_t>::const_iterator it = path.begin ();
+	   it != path.end (); ++it) {
+	--(*it)->size_;
+      }
+      // Merge the largest subtree of the path that holds less than half a
+      // bucket, so that nodes added afterwards do not split it again at
+      // once. Ids of connected components of the boxes are not updated:
+      // boxes may be visited in vain.
+      for (std::vector <KDTreePtr_t>::const_iterator it = path.begin ();
+	   it != path.end () - 1; ++it) {
+	if (2 * (*it)->size_ < bucketSize_) {
+	  (*it)->rebuild ();
+	  return;
 	}
-	Leaf->addNode(node);
       }
+      if (2 * current->removed_ > current->bucket_) current->rebuild ();
     }
 
+    void KDTree::distribute () {
+      update ();
+      // All nodes of the leaf may coincide along the weighed coordinates
+      if (!split ()) return;
+      size_type splitDim = supChild_->splitDim_;
+      value_type splitValue = supChild_->lowerBounds_ [splitDim];
+      for (std::size_t i=0; i < bucket_; ++i) {
+	if (nodeIds_ [i] < 0) continue;
+	KDTreePtr_t child = configurations_ (splitDim, i) > splitValue ?
+	  supChild_ : infChild_;
+	++child->size_;
+	child->ccIds_.insert (nodeIds_ [i]);
+	child->store (nodes_ [i], nodeIds_ [i]);
+      }
+      clearStorage ();
+      if (infChild_->bucket_ > bucketSize_) infChild_->distribute ();
+      if (supChild_->bucket_ > bucketSize_) supChild_->distribute ();
+    }
+
+    void KDTree::balance (const std::vector <KDTreePtr_t>& path) {
+      const KDTreePtr_t& leaf = path.back ();
+      std::size_t depth = leaf->depth_;
+      if (leaf->infChild_ != NULL) ++depth;
+      // A subtree of n nodes built by median splits has a height of about
+      // log2 (n / bucketSize_). Rebuild the smallest subtree of the path
+      // that is more than twice as high.
+      for (std::vector <KDTreePtr_t>::const_reverse_iterator it =
+	     path.rbegin (); it != path.rend (); ++it) {
+	value_type maxHeight = 2 * std::log
+	  (1 + (value_type) (*it)->size_ / bucketSize_) / std::log (2.) + 2;
+	if ((value_type) (depth - (*it)->depth_) > maxHeight) {
+	  hppDout (info, "rebuild subtree of " << (*it)->size_ << " nodes"
+		   << " at depth " << (*it)->depth_);
+	  (*it)->rebuild ();
+	  return;
+	}
+      }
+    }
+
+    void KDTree::collect (std::vector <NodePtr_t>& nodes,
+			  std::vector <size_type>& ids) {
+      if (infChild_ == NULL || supChild_ == NULL) {
+	update ();
+	for (std::size_t i=0; i < bucket_; ++i) {
+	  if (nodeIds_ [i] < 0) continue;
+	  nodes.push_back (nodes_ [i]);
+	  ids.push_back (nodeIds_ [i]);
+	}
+      }
+      else {
+	infChild_->collect (nodes, ids);
+	supChild_->collect (nodes, ids);
+      }
+    }
+
+    void KDTree::rebuild () {
+      std::vector <NodePtr_t> nodes;
+      std::vector <size_type> ids;
+      nodes.reserve (size_);
+      ids.reserve (size_);
+      collect (nodes, ids);
+      delete infChild_;
+      infChild_ = NULL;
+      delete supChild_;
+      supChild_ = NULL;
+      clearStorage ();
+      // Removed nodes do not extend the range anymore
+      lowerData_ = std::numeric_limits <value_type>::infinity ();
+      upperData_ = -std::numeric_limits <value_type>::infinity ();
+      for (std::size_t i=0; i < nodes.size (); ++i) {
+	store (nodes [i], ids [i]);
+      }
+      if (bucket_ > bucketSize_) distribute ();
+    }
+
+    void KDTree::update () {
+      if (merges_ == components_->merges ()) return;
+      merges_ = components_->merges ();
+      std::set <size_type> ccIds;
+      for (std::set <size_type>::const_iterator it = ccIds_.begin ();
+	   it != ccIds_.end (); ++it) {
+	ccIds.insert (components_->root (*it));
+      }
+      ccIds_.swap (ccIds);
+      for (std::size_t i=0; i < bucket_; ++i) {
+	if (nodeIds_ [i] >= 0) nodeIds_ [i] = components_->root (nodeIds_ [i]);
+      }
+    }
+
+    bool KDTree::contains (size_type id) {
+      update ();
+      return ccIds_.count (id) > 0;
+    }
+
+    void KDTree::store (const NodePtr_t& node, size_type id) {
+      if (configurations_.cols () <= (size_type) bucket_) {
+	// Allocate the bucket at once, grow only if nodes cannot be split.
+	size_type cols = std::max ((size_type) bucketSize_ + 1,
+				   2 * configurations_.cols ());
+	configurations_.conservativeResize (dim_, cols);
+	nodes_.reserve (cols);
+	nodeIds_.reserve (cols);
+      }
+      configurations_.col (bucket_) = *(node->configuration ());
+      nodes_.push_back (node);
+      nodeIds_.push_back (id);
+      ++bucket_;
+      extendRange (*(node->configuration ()));
+    }
+
+    void KDTree::extendRange (const Configuration_t& configuration) {
+      value_type q = configuration [splitDim_];
+      lowerData_ = std::min (lowerData_, q);
+      upperData_ = std::max (upperData_, q);
+    }
+
+    void KDTree::computeDistances (const ConfigurationPtr_t& configuration) {
+      if (distances_.size () < configurations_.cols ()) {
+	distances_.resize (configurations_.cols ());
+      }
+      distance_->distances (*configuration, configurations_.leftCols (bucket_),
+			    distances_.head (bucket_));
+    }
+
+    void KDTree::clearStorage () {
+      configurations_.resize (0, 0);
+      distances_.resize (0);
+      nodes_.clear ();
+      nodeIds_.clear ();
+      bucket_ = 0;
+      removed_ = 0;
+    }
 
     void KDTree::clear() {
-      nodesMap_.clear();
+      ccIds_.clear();
+      size_ = 0;
+      lowerData_ = std::numeric_limits <value_type>::infinity ();
+      upperData_ = -std::numeric_limits <value_type>::infinity ();
+      clearStorage ();
       if (infChild_ != NULL ) {
 	delete infChild_;
 	infChild_ = NULL;
@@ -144,54 +455,52 @@ namespace hpp {
 	delete supChild_;
 	supChild_ = NULL;
       }
+      // Connected component ids are shared by the whole tree
+      if (depth_ == 0) {
+	components_->clear ();
+	merges_ = components_->merges ();
+      }
     }
 
 
-    void KDTree::split() {
+    bool KDTree::split() {
       if ( infChild_ != NULL || supChild_ != NULL ) {
 	// Error, you're triing to split a non leaf part of the KDTree
 	throw std::runtime_error
 	  ("Attempt to split the KDTree in a non leaf part");
       }
-      // Compute actual bounds of node configurations
-      vector_t actualLower (robot_->configSize ());
-      actualLower.setConstant (+std::numeric_limits <value_type>::infinity ());
-      vector_t actualUpper (robot_->configSize ());
-      actualUpper.setConstant (-std::numeric_limits <value_type>::infinity ());
+      if (bucket_ < 2) return false;
+      Eigen::Block <matrix_t> configurations (configurations_.block
+					      (0, 0, dim_, bucket_));
+      // Split the dimention of largest weighed variance
+      vector_t mean (configurations.rowwise ().mean ());
+      vector_t variance ((configurations.colwise () - mean).rowwise ()
+			 .squaredNorm ());
+      variance = variance.cwiseProduct (weights_.cwiseAbs2 ());
+      matrix_t::Index splitDim;
+      if (variance.maxCoeff (&splitDim) <= 0) return false;
+
+      // Compute median value of coordinates. Nodes with a coordinate equal
+      // to the split value go to the inferior child.
       std::vector <value_type> values (bucket_);
-      for (NodesMap_t::iterator itCC = nodesMap_.begin();
-	   itCC != nodesMap_.end(); ++itCC) {
-	Nodes_t nodes = itCC->second;
-	for (Nodes_t::const_iterator itNode = nodes.begin ();
-	     itNode != nodes.end (); ++itNode) {
-	  const Configuration_t& q (*((*itNode)->configuration ()));
-	  for (size_type i=0; i < q.size (); ++i) {
-	    if (q [i] < actualLower [i]) {
-	      actualLower [i] = q [i];
-	    }
-	    if (q [i] > actualUpper [i]) {
-	      actualUpper [i] = q [i];
-	    }
-	  }
-	}
+      for (std::size_t i=0; i < bucket_; ++i) {
+	values [i] = configurations (splitDim, i);
       }
-      // Split the widest dimention
-      double dimWidth = 0.;
-      size_type splitDim;
-      for (size_type i=0 ; i < actualUpper.size (); i++) {
-	if ((actualUpper [i] - actualLower [i]) * weights_ [i] > dimWidth ) {
-	  dimWidth =  actualUpper [i] - actualLower [i];
-	  splitDim = i;
-	}
+      std::vector <value_type>::iterator median = values.begin () +
+	(bucket_ - 1) / 2;
+      std::nth_element (values.begin (), median, values.end ());
+      value_type splitValue = *median;
+      value_type upper = configurations.row (splitDim).maxCoeff ();
+      if (splitValue >= upper) {
+	// More than half of the nodes share the largest value, the middle of
+	// the range separates nodes.
+	splitValue = (configurations.row (splitDim).minCoeff () + upper) / 2;
       }
-
-      // Compute median value of coordinates
       infChild_ = new KDTree (this, splitDim);
-      infChild_->upperBounds_ [splitDim] = (actualUpper [splitDim] +
-					    actualLower [splitDim])/2;
+      infChild_->upperBounds_ [splitDim] = splitValue;
       supChild_ = new KDTree(this, splitDim);
-      supChild_->lowerBounds_ [splitDim] = (actualUpper [splitDim] +
-					    actualLower [splitDim])/2;
+      supChild_->lowerBounds_ [splitDim] = splitValue;
+      return true;
     }
 
     // get joints limits
@@ -219,117 +528,279 @@ namespace hpp {
 
 
     value_type KDTree::distanceToBox (const ConfigurationPtr_t& configuration) {
-      value_type minDistance;
-      value_type DistanceToUpperBound;
-      value_type DistanceToLowerBound;
-      // Projection of the configuration on the box
-      Configuration_t confbox = *configuration;
-
-      DistanceToLowerBound = fabs (lowerBounds_[splitDim_] -
-				   (*configuration) [splitDim_])
-	* weights_ [splitDim_];
-      DistanceToUpperBound = fabs (upperBounds_[splitDim_] -
-				   (*configuration)[splitDim_])
-	* weights_ [splitDim_];
-      minDistance = std::min (DistanceToLowerBound, DistanceToUpperBound);
-      return minDistance;
+      // Empty boxes are skipped by the searches
+      if (lowerData_ > upperData_ || weights_ [splitDim_] == 0) return 0.;
+      // The range of the nodes is within the box, and does not depend on
+      // joint bounds that nodes may not satisfy.
+      value_type q = (*configuration) [splitDim_];
+      const value_type& lower (lowerData_);
+      const value_type& upper (upperData_);
+      value_type d = gap (q, lower, upper);
+      switch (typeDims_ [splitDim_]) {
+      case LOOPED:
+	d = std::min (d, std::min (gap (q - 2 * M_PI, lower, upper),
+				   gap (q + 2 * M_PI, lower, upper)));
+	break;
+      case QUATERNION:
+	d = std::min (d, gap (-q, lower, upper));
+	break;
+      case BOUNDED:
+	break;
+      }
+      return d * weights_ [splitDim_];
     }
 
     NodePtr_t KDTree::search (const ConfigurationPtr_t& configuration,
 			      const ConnectedComponentPtr_t& connectedComponent,
-                              value_type& minDistance) {
-      // Test if the configuration is in the root box
-      for ( std::size_t i=0 ; i<dim_ ; i++ ) {
-	if ( (*configuration)[i] < lowerBounds_[i] || (*configuration)[i]
-	     > upperBounds_[i] ) {
-	  std::ostringstream oss ("The Configuration isn't in the root box: \n"
-				  "  i = ");
-	  oss << i << ", lower = " << lowerBounds_[i] << ", config = "
-	      << (*configuration)[i] << ", upper = " << upperBounds_[i]
-	      << ".";
-	  throw std::runtime_error (oss.str ());
-	}
-      }
+                              value_type& minDistance, bool exact) {
+      TraceScope trace ("KDTree::search");
+      // The configuration may lie outside of the root box: distances to boxes
+      // are then underestimated, which keeps the search exact.
       value_type boxDistance = 0.;
       NodePtr_t nearest = NULL;
       minDistance = std::numeric_limits <value_type>::infinity ();
-      this->search (boxDistance, minDistance, configuration,
-		    connectedComponent, nearest);
+      size_type id = components_->find (connectedComponent);
+      if (id >= 0) {
+	value_type factor = exact ? 1 : (1 + epsilon_) * (1 + epsilon_);
+	this->search (boxDistance, minDistance, configuration, id, factor,
+		      nearest);
+      }
       assert (nearest);
       return nearest;
     }
 
     void KDTree::search (value_type boxDistance, value_type& minDistance,
 			 const ConfigurationPtr_t& configuration,
-			 const ConnectedComponentPtr_t& connectedComponent,
-			 NodePtr_t& nearest) {
-      if ( boxDistance < minDistance*minDistance
-	   && nodesMap_.count(connectedComponent) > 0 ) {
+			 size_type id, value_type factor, NodePtr_t& nearest) {
+      // Approximate search: skip boxes that cannot contain a node closer
+      // than minDistance / (1 + epsilon)
+      if ( boxDistance * factor < minDistance*minDistance
+	   && contains (id) ) {
 	// minDistance^2 because boxDistance is a squared distance
 	if ( infChild_ == NULL || supChild_ == NULL ) {
-	  value_type distance = std::numeric_limits <value_type>::infinity ();
-	  for (Nodes_t::iterator itNode =
-		 nodesMap_[connectedComponent].begin ();
-	       itNode != nodesMap_[connectedComponent].end (); ++itNode) {
-	    distance = (*distance_) (*configuration,
-				     *((*itNode)->configuration ()));
+	  // Distances to nodes farther than the nearest node found so far
+	  // are not computed exactly.
+	  for (std::size_t i=0; i < bucket_; ++i) {
+	    if (nodeIds_ [i] != id) continue;
+	    value_type distance = distance_->boundedDistance
+	      (*configuration, configurations_.col (i), minDistance);
 	    if (distance < minDistance) {
 	      minDistance = distance;
-	      nearest = (*itNode);
+	      nearest = nodes_ [i];
 	    }
 	  }
 	}
 	else {
 	  // find config to boxes distances
-	  value_type distanceToInfChild;
-	  value_type distanceToSupChild;
-	  if ( boxDistance == 0. ) {
-	    if ( (*configuration) [supChild_->splitDim_]
-		 > supChild_->lowerBounds_[supChild_->splitDim_])  {
-	      distanceToSupChild = 0.;
-	      distanceToInfChild = infChild_->distanceToBox(configuration);
-	    }
-	    else {
-	      distanceToInfChild = 0.;
-	      distanceToSupChild = supChild_->distanceToBox(configuration);
-	    }
-	  }
-	  else {
-	    distanceToInfChild = infChild_->distanceToBox(configuration);
-	    distanceToSupChild = supChild_->distanceToBox(configuration);
-	  }
+	  value_type distanceToInfChild = infChild_->distanceToBox
+	    (configuration);
+	  value_type distanceToSupChild = supChild_->distanceToBox
+	    (configuration);
 	  // search in the children
 	  if ( distanceToInfChild < distanceToSupChild ) {
 	    infChild_->search(boxDistance, minDistance,
-			      configuration, connectedComponent, nearest);
+			      configuration, id, factor, nearest);
 	    supChild_->search(boxDistance -
 			      distanceToInfChild*distanceToInfChild +
 			      distanceToSupChild*distanceToSupChild,
-			      minDistance, configuration, connectedComponent,
-			      nearest );
+			      minDistance, configuration, id, factor, nearest);
 	  }
 	  else {
 	    supChild_->search(boxDistance,minDistance,
-			      configuration, connectedComponent, nearest);
+			      configuration, id, factor, nearest);
 	    infChild_->search(boxDistance -
 			      distanceToSupChild*distanceToSupChild +
 			      distanceToInfChild*distanceToInfChild,
-			      minDistance, configuration, connectedComponent,
-			      nearest);
+			      minDistance, configuration, id, factor, nearest);
 	  }
 	}
       }
     }
 
+    void KDTree::search (const ConfigurationPtr_t& configuration,
+			 const ConnectedComponents_t& connectedComponents,
+			 NearestNodes_t& nearestNodes, bool exact) {
+      TraceScope trace ("KDTree::search");
+      // The vector is not resized afterwards: pointers to its elements
+      // remain valid during the traversal.
+      nearestNodes.assign
+	(connectedComponents.size (), NearestNode_t
+	 (ConnectedComponentPtr_t (), NodeAndDistance_t
+	  (0x0, std::numeric_limits <value_type>::infinity ())));
+      NearestNodeIds_t nearestNodeIds;
+      std::size_t i = 0;
+      for (ConnectedComponents_t::const_iterator itcc =
+	     connectedComponents.begin ();
+	   itcc != connectedComponents.end (); ++itcc, ++i) {
+	nearestNodes [i].first = *itcc;
+	size_type id = components_->find (*itcc);
+	if (id >= 0) nearestNodeIds [id] = &(nearestNodes [i].second);
+      }
+      value_type factor = exact ? 1 : (1 + epsilon_) * (1 + epsilon_);
+      this->search (0., configuration, factor, nearestNodeIds);
+    }
+
+    void KDTree::search (value_type boxDistance,
+			 const ConfigurationPtr_t& configuration,
+			 value_type factor, NearestNodeIds_t& nearestNodes) {
+      // Explore the box only if it may contain a node closer than the
+      // current nearest node of one of the connected components it stores.
+      // boxDistance is a squared distance.
+      bool explore = false;
+      update ();
+      for (std::set <size_type>::const_iterator itId = ccIds_.begin ();
+	   itId != ccIds_.end () && !explore; ++itId) {
+	NearestNodeIds_t::const_iterator itNearest = nearestNodes.find (*itId);
+	if (itNearest != nearestNodes.end ()) {
+	  const value_type& minDistance = itNearest->second->second;
+	  explore = boxDistance * factor < minDistance*minDistance;
+	}
+      }
+      if (!explore) return;
+      if ( infChild_ == NULL || supChild_ == NULL ) {
+	computeDistances (configuration);
+	NearestNodeIds_t::iterator itNearest = nearestNodes.end ();
+	for (std::size_t i=0; i < bucket_; ++i) {
+	  // Consecutive nodes often belong to the same connected component.
+	  if (itNearest == nearestNodes.end () ||
+	      itNearest->first != nodeIds_ [i]) {
+	    itNearest = nearestNodes.find (nodeIds_ [i]);
+	    if (itNearest == nearestNodes.end ()) continue;
+	  }
+	  NodeAndDistance_t& nearest = *(itNearest->second);
+	  value_type distance = distances_ [i];
+	  if (distance < nearest.second) {
+	    nearest.second = distance;
+	    nearest.first = nodes_ [i];
+	  }
+	}
+      }
+      else {
+	value_type distanceToInfChild = infChild_->distanceToBox
+	  (configuration);
+	value_type distanceToSupChild = supChild_->distanceToBox
+	  (configuration);
+	// search in the nearest child first
+	if ( distanceToInfChild < distanceToSupChild ) {
+	  infChild_->search (boxDistance, configuration, factor, nearestNodes);
+	  supChild_->search (boxDistance -
+			     distanceToInfChild*distanceToInfChild +
+			     distanceToSupChild*distanceToSupChild,
+			     configuration, factor, nearestNodes);
+	}
+	else {
+	  supChild_->search (boxDistance, configuration, factor, nearestNodes);
+	  infChild_->search (boxDistance -
+			     distanceToSupChild*distanceToSupChild +
+			     distanceToInfChild*distanceToInfChild,
+			     configuration, factor, nearestNodes);
+	}
+      }
+    }
+
+    Nodes_t KDTree::KNearest (const ConfigurationPtr_t& configuration,
+			      const ConnectedComponentPtr_t&
+			      connectedComponent,
+			      std::size_t K, value_type& distance) {
+      std::vector <NodeAndDistance_t> nearest;
+      size_type id = components_->find (connectedComponent);
+      if (id >= 0) {
+	this->search (0., configuration, id, K,
+		      std::numeric_limits <value_type>::infinity (),
+		      (1 + epsilon_) * (1 + epsilon_), nearest);
+      }
+      std::sort_heap (nearest.begin (), nearest.end (), closer);
+      distance = nearest.empty () ?
+	std::numeric_limits <value_type>::infinity () : nearest.back ().second;
+      Nodes_t result;
+      for (std::vector <NodeAndDistance_t>::const_iterator it =
+	     nearest.begin (); it != nearest.end (); ++it) {
+	result.push_back (it->first);
+      }
+      return result;
+    }
+
+    Nodes_t KDTree::withinRadius (const ConfigurationPtr_t& configuration,
+				  const ConnectedComponentPtr_t&
+				  connectedComponent,
+				  value_type radius) {
+      std::vector <NodeAndDistance_t> nearest;
+      size_type id = components_->find (connectedComponent);
+      if (id >= 0) {
+	this->search (0., configuration, id,
+		      std::numeric_limits <std::size_t>::max (), radius,
+		      (1 + epsilon_) * (1 + epsilon_), nearest);
+      }
+      std::sort_heap (nearest.begin (), nearest.end (), closer);
+      Nodes_t result;
+      for (std::vector <NodeAndDistance_t>::const_iterator it =
+	     nearest.begin (); it != nearest.end (); ++it) {
+	result.push_back (it->first);
+      }
+      return result;
+    }
+
+    void KDTree::search (value_type boxDistance,
+			 const ConfigurationPtr_t& configuration,
+			 size_type id, std::size_t K, value_type radius,
+			 value_type factor,
+			 std::vector <NodeAndDistance_t>& nearest) {
+      if (K == 0) return;
+      // boxDistance is a squared distance
+      if (boxDistance > radius*radius) return;
+      // Once K nodes are found, only nodes closer than the farthest one
+      // divided by 1 + epsilon are searched for.
+      if (nearest.size () == K) {
+	value_type bound = nearest.front ().second;
+	if (boxDistance * factor > bound*bound)
+	  return;
+      }
+      if (!contains (id)) return;
+      if ( infChild_ == NULL || supChild_ == NULL ) {
+	computeDistances (configuration);
+	for (std::size_t i=0; i < bucket_; ++i) {
+	  if (nodeIds_ [i] != id) continue;
+	  value_type distance = distances_ [i];
+	  if (distance > radius) continue;
+	  if (nearest.size () < K) {
+	    nearest.push_back (NodeAndDistance_t (nodes_ [i], distance));
+	    std::push_heap (nearest.begin (), nearest.end (), closer);
+	  } else if (distance < nearest.front ().second) {
+	    std::pop_heap (nearest.begin (), nearest.end (), closer);
+	    nearest.back () = NodeAndDistance_t (nodes_ [i], distance);
+	    std::push_heap (nearest.begin (), nearest.end (), closer);
+	  }
+	}
+      }
+      else {
+	value_type distanceToInfChild = infChild_->distanceToBox
+	  (configuration);
+	value_type distanceToSupChild = supChild_->distanceToBox
+	  (configuration);
+	// search in the nearest child first
+	if ( distanceToInfChild < distanceToSupChild ) {
+	  infChild_->search (boxDistance, configuration, id, K, radius,
+			     factor, nearest);
+	  supChild_->search (boxDistance -
+			     distanceToInfChild*distanceToInfChild +
+			     distanceToSupChild*distanceToSupChild,
+			     configuration, id, K, radius, factor, nearest);
+	}
+	else {
+	  supChild_->search (boxDistance, configuration, id, K, radius,
+			     factor, nearest);
+	  infChild_->search (boxDistance -
+			     distanceToSupChild*distanceToSupChild +
+			     distanceToInfChild*distanceToInfChild,
+			     configuration, id, K, radius, factor, nearest);
+	}
+      }
+    }
+
     void KDTree::merge(ConnectedComponentPtr_t cc1,
 		       ConnectedComponentPtr_t cc2) {
-      nodesMap_[cc1].merge(nodesMap_[cc2]);
-      NodesMap_t::iterator it = nodesMap_.find (cc2);
-      nodesMap_.erase(it);
-      if ( infChild_ != NULL || supChild_ != NULL ) {
-	infChild_->merge(cc1, cc2);
-	supChild_->merge(cc1, cc2);
-      }
+      // Ids stored in the boxes are updated when the boxes are visited.
+      components_->merge (cc1, cc2);
     }
     } // namespace nearestNeighbor
   } // namespace core
@@ -19,6 +19,10 @@
 #ifndef HPP_CORE_NEAREST_NEIGHBOR_K_D_TREE_HH
 # define HPP_CORE_NEAREST_NEIGHBOR_K_D_TREE_HH
 
+# include <map>
+# include <set>
+# include <vector>
+# include <boost/shared_ptr.hpp>
 # include <hpp/core/distance.hh>
 # include <hpp/core/node.hh>
 # include <hpp/model/joint.hh>
@@ -29,6 +33,39 @@
 namespace hpp {
   namespace core {
     namespace nearestNeighbor {
+    // Union-find structure identifying the connected components of the nodes
+    // stored in a KDTree. Merging two connected components only links their
+    // ids; ids stored in the tree are replaced by their root lazily.
+    class ComponentIds
+    {
+    public:
+      ComponentIds () : ids_ (), parents_ (), merges_ (0)
+      {
+      }
+      // get id of a connected component, create one if needed
+      size_type insert (const ConnectedComponentPtr_t& connectedComponent);
+      // get root id of a connected component, -1 if unknown
+      size_type find (const ConnectedComponentPtr_t& connectedComponent);
+      // get root of an id
+      size_type root (size_type id);
+      // cc2 is merged into cc1
+      void merge (const ConnectedComponentPtr_t& cc1,
+		  const ConnectedComponentPtr_t& cc2);
+      // number of merges linking two ids, ids stored in the tree are
+      // roots if they were updated after the same number of merges.
+      std::size_t merges () const
+      {
+	return merges_;
+      }
+      void clear ();
+      std::size_t memoryUsage () const;
+    private:
+      std::map <ConnectedComponentPtr_t, size_type> ids_;
+      std::vector <size_type> parents_;
+      std::size_t merges_;
+    }; // class ComponentIds
+    typedef boost::shared_ptr <ComponentIds> ComponentIdsPtr_t;
+
     // Built an k-dimentional tree for the nearest neighbour research
     class KDTree : public NearestNeighbor
     {
@@ -45,6 +82,11 @@ namespace hpp {
       // add a configuration in the KDTree
       virtual void addNode(const NodePtr_t& node);
 
+      // remove a node from the KDTree: the node is marked as removed in its
+      // leaf, leaves and small subtrees are compacted when removed nodes
+      // prevail.
+      virtual void removeNode(const NodePtr_t& node);
+
       // Clear all the nodes in the KDTree
       virtual void clear();
 
@@ -52,61 +94,162 @@ namespace hpp {
       virtual NodePtr_t search (const ConfigurationPtr_t& configuration,
 			        const ConnectedComponentPtr_t&
 				connectedComponent,
-				value_type& minDistance);
+				value_type& minDistance, bool exact = false);
+
+      // search nearest node of each connected component in one traversal
+      virtual void search (const ConfigurationPtr_t& configuration,
+			   const ConnectedComponents_t& connectedComponents,
+			   NearestNodes_t& nearestNodes, bool exact = false);
+
+      // search K nearest nodes of a connected component
+      virtual Nodes_t KNearest (const ConfigurationPtr_t& configuration,
+				const ConnectedComponentPtr_t&
+				connectedComponent,
+				std::size_t K, value_type& distance);
+
+      // search nodes of a connected component within radius
+      virtual Nodes_t withinRadius (const ConfigurationPtr_t& configuration,
+				    const ConnectedComponentPtr_t&
+				    connectedComponent,
+				    value_type radius);
 
       // merge two connected components in the whole tree
+      // cost does not depend on the number of nodes in the tree.
       void merge(ConnectedComponentPtr_t cc1, ConnectedComponentPtr_t cc2);
       // Get distance function
       virtual DistancePtr_t distance () const
       {
 	return distance_;
       }
+      // memory of the boxes of the tree and of the leaf storage
+      virtual std::size_t memoryUsage () const;
     private:
+      typedef std::map <size_type, NodeAndDistance_t*> NearestNodeIds_t;
+      // type of a configuration coordinate, defines the distance between
+      // a coordinate and an interval
+      enum DimensionType {
+	// translation, bounded rotation or coordinate of a unit complex
+	BOUNDED,
+	// angle of an unbounded rotation, modulo 2 pi
+	LOOPED,
+	// coordinate of a unit quaternion, defined up to the sign
+	QUATERNION
+      };
+
       DevicePtr_t robot_;
       std::size_t dim_;
 
       WeighedDistancePtr_t distance_;
+      // weight of each configuration coordinate, zero for coordinates
+      // along which boxes do not bound the distance
       vector_t weights_;
-      typedef std::map <ConnectedComponentPtr_t, Nodes_t> NodesMap_t;
-      NodesMap_t nodesMap_;
+      // type of each configuration coordinate
+      std::vector <DimensionType> typeDims_;
+      // connected component ids, shared by all the boxes of the tree
+      ComponentIdsPtr_t components_;
+      // ids of connected components having nodes in the box
+      std::set <size_type> ccIds_;
+      // number of merges when ids of the box were last updated
+      std::size_t merges_;
+      // depth of the box in the tree and number of nodes in the box
+      std::size_t depth_;
+      std::size_t size_;
+      // Leaf storage: configuration of the i-th node of the bucket is stored
+      // in the i-th column of configurations_, the node and the id of its
+      // connected component in nodes_ [i] and nodeIds_ [i]. The id of
+      // removed nodes is -1: no search matches it.
+      matrix_t configurations_;
+      std::vector <NodePtr_t> nodes_;
+      std::vector <size_type> nodeIds_;
+      // distances to the configuration searched for, from computeDistances
+      vector_t distances_;
       std::size_t bucketSize_;
+      // number of nodes stored in the leaf, and of removed nodes among them
       std::size_t bucket_;
+      std::size_t removed_;
 
       // number of the splited dimention
       std::size_t splitDim_;
       vector_t upperBounds_;
       vector_t lowerBounds_;
-
-      // type of each dimention
-      //	0 => bounded dimention
-      //	1 => looped dimention
-      //	2 => quaternion
-      vector_t typeDims_;
+      // range of the coordinates of the nodes along the splited dimention,
+      // extended as nodes are inserted: it is much smaller than the bounds
+      // along translations of mobile robots.
+      value_type lowerData_;
+      value_type upperData_;
 
       KDTreePtr_t supChild_;
       KDTreePtr_t infChild_;
 
-      // Split the node into two subnodes
-      void split();
+      // Split the node into two subnodes along the coordinate of largest
+      // weighed variance, at the median of node coordinates.
+      // return false if nodes of the leaf cannot be separated.
+      bool split();
+
+      // Split the leaf and move its nodes to the children, recursively
+      // while leaves contain more than bucketSize_ nodes.
+      void distribute ();
+
+      // Rebuild the subtree from its nodes
+      void rebuild ();
+
+      // Rebuild the deepest box of the path from root to a leaf that is too
+      // deep with respect to its number of nodes
+      void balance (const std::vector <KDTreePtr_t>& path);
+
+      // Collect nodes of the subtree, except removed nodes
+      void collect (std::vector <NodePtr_t>& nodes,
+		    std::vector <size_type>& ids);
+
+      // Replace connected component ids of the box by their roots
+      void update ();
+
+      // Whether the box contains nodes of a connected component
+      bool contains (size_type id);
+
+      // store a node in the leaf storage
+      void store (const NodePtr_t& node, size_type id);
+
+      // extend the range of the coordinates of the nodes to a configuration
+      void extendRange (const Configuration_t& configuration);
+
+      // compute distances from configuration to nodes of the leaf
+      void computeDistances (const ConfigurationPtr_t& configuration);
+
+      // free leaf storage after split
+      void clearStorage ();
 
       // find the leaf of the KDtree for the configuration/node.
       // starts the research at KDTree then go down the tree.
-      // also add connectedComopnent of node along the path from tree
-      // root to tree leaf
-      KDTreePtr_t findLeaf(const NodePtr_t& node);
+      // also add connected component id of node along the path from tree
+      // root to tree leaf, and store the path.
+      KDTreePtr_t findLeaf(const NodePtr_t& node, size_type id,
+			   std::vector <KDTreePtr_t>& path);
 
       // find bounds on each dimention
       void findDeviceBounds();
 
-      // distance to the nearest bound on the splited dimention
+      // lower bound of the distance to the nodes along the splited
+      // dimention, computed from the range of their coordinates
       value_type distanceToBox(const ConfigurationPtr_t& configuration);
 
-      // search nearest node
+      // search nearest node, factor is (1 + epsilon)^2 where epsilon is
+      // the approximation factor of the search
       void search(value_type boxDistance, value_type& minDistance,
-		  const ConfigurationPtr_t& configuration,
-		  const ConnectedComponentPtr_t& connectedComponent,
-		  NodePtr_t& nearest);
+		  const ConfigurationPtr_t& configuration, size_type id,
+		  value_type factor, NodePtr_t& nearest);
+
+      // search at most K nodes within radius, nearest is a heap whose
+      // first element is the farthest node found
+      void search(value_type boxDistance,
+		  const ConfigurationPtr_t& configuration, size_type id,
+		  std::size_t K, value_type radius, value_type factor,
+		  std::vector <NodeAndDistance_t>& nearest);
 
+      // search nearest node of each connected component in nearestNodes
+      void search(value_type boxDistance,
+		  const ConfigurationPtr_t& configuration,
+		  value_type factor, NearestNodeIds_t& nearestNodes);
 
     }; // class KDTree
     } // namespace nearestNeighbor
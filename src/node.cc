@@ -16,6 +16,7 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <hpp/util/debug.hh>
 #include <hpp/model/configuration.hh>
 #include <hpp/core/node.hh>
@@ -29,14 +30,15 @@ namespace hpp {
 
     Node::Node (const ConfigurationPtr_t& configuration) :
       configuration_ (configuration),
-      connectedComponent_ (ConnectedComponent::create ())
+      connectedComponent_ (ConnectedComponent::create ()), index_ (0),
+      goal_ (false)
     {
     }
 
     Node::Node (const ConfigurationPtr_t& configuration,
 		ConnectedComponentPtr_t connectedComponent) :
       configuration_ (configuration),
-      connectedComponent_ (connectedComponent)
+      connectedComponent_ (connectedComponent), index_ (0), goal_ (false)
     {
       assert (connectedComponent_);
     }
@@ -86,20 +88,55 @@ namespace hpp {
 
     ConnectedComponentPtr_t Node::connectedComponent () const
     {
+      connectedComponent_ = connectedComponent_->representative ();
       return connectedComponent_;
     }
 
-    const Edges_t& Node::outEdges () const
+    void Node::removeOutEdge (EdgePtr_t edge)
+    {
+      Edges_t::iterator it = std::find (outEdges_.begin (), outEdges_.end (),
+					edge);
+      if (it != outEdges_.end ()) outEdges_.erase (it);
+    }
+
+    void Node::removeInEdge (EdgePtr_t edge)
+    {
+      Edges_t::iterator it = std::find (inEdges_.begin (), inEdges_.end (),
+					edge);
+      if (it != inEdges_.end ()) inEdges_.erase (it);
+    }
+
+    std::size_t Node::index () const
+    {
+      return index_;
+    }
+
+    void Node::index (std::size_t index)
+    {
+      index_ = index;
+    }
+
+    bool Node::isGoal () const
+    {
+      return goal_;
+    }
+
+    void Node::isGoal (bool goal)
+    {
+      goal_ = goal;
+    }
+
+    const Node::Edges_t& Node::outEdges () const
     {
       return outEdges_;
     }
 
-    const Edges_t& Node::inEdges () const
+    const Node::Edges_t& Node::inEdges () const
     {
       return inEdges_;
     }
 
-    ConfigurationPtr_t Node::configuration () const
+    const ConfigurationPtr_t& Node::configuration () const
     {
       return configuration_;
     }
@@ -25,18 +25,21 @@ namespace hpp {
       Equation (comp, vector_t::Zero (function->outputSize ())),
       function_ (function), value_ (function->outputSize ()),
       jacobian_ (function->outputDerivativeSize (),
-		 function->inputDerivativeSize ())
+		 function->inputDerivativeSize ()),
+      activeColumns_ (1, SizeInterval_t (0, function->inputDerivativeSize ()))
     {}
 
     NumericalConstraint::NumericalConstraint (const DifferentiableFunctionPtr_t& function,
         ComparisonTypePtr_t comp, vectorIn_t rhs) :
       Equation (comp, rhs), function_ (function), value_ (function->outputSize ()),
-      jacobian_ (matrix_t (function->outputSize (), function->inputDerivativeSize ()))
+      jacobian_ (matrix_t (function->outputSize (), function->inputDerivativeSize ())),
+      activeColumns_ (1, SizeInterval_t (0, function->inputDerivativeSize ()))
     {}
 
     NumericalConstraint::NumericalConstraint (const NumericalConstraint& other):
-      Equation (other), function_ (other.function_), value_ (other.value_),
-      jacobian_ (other.jacobian_)
+      Equation (other), function_ (other.function_),
+      functionBuilder_ (other.functionBuilder_), value_ (other.value_),
+      jacobian_ (other.jacobian_), activeColumns_ (other.activeColumns_)
     {
     }
 
@@ -76,6 +79,24 @@ namespace hpp {
       return createCopy (weak_.lock ());
     }
 
+    NumericalConstraintPtr_t NumericalConstraint::copy
+    (const DevicePtr_t& robot) const
+    {
+      if (!functionBuilder_) return NumericalConstraintPtr_t ();
+      NumericalConstraintPtr_t nc (createCopy (weak_.lock ()));
+      nc->function (functionBuilder_ (robot));
+      return nc;
+    }
+
+    void NumericalConstraint::function
+    (const DifferentiableFunctionPtr_t& function)
+    {
+      assert (function->outputSize () == function_->outputSize ());
+      assert (function->inputDerivativeSize () ==
+	      function_->inputDerivativeSize ());
+      function_ = function;
+    }
+
     void NumericalConstraint::rightHandSideFromConfig (ConfigurationIn_t config)
     {
       if (rhsSize () > 0) {
@@ -0,0 +1,102 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+#include <hpp/fcl/collision_object.h>
+#include <hpp/fcl/broadphase/broadphase_dynamic_AABB_tree.h>
+#include <hpp/model/collision-object.hh>
+#include <hpp/core/obstacle-scene.hh>
+
+namespace hpp {
+  namespace core {
+    ObstacleScenePtr_t ObstacleScene::create ()
+    {
+      ObstacleScene* ptr = new ObstacleScene;
+      return ObstacleScenePtr_t (ptr);
+    }
+
+    ObstacleScenePtr_t ObstacleScene::createCopy (const ObstacleScene& scene)
+    {
+      ObstacleScenePtr_t result (create ());
+      for (Obstacles_t::const_iterator it = scene.obstacles_.begin ();
+	   it != scene.obstacles_.end (); ++it) {
+	result->add (it->second);
+      }
+      return result;
+    }
+
+    ObstacleScene::ObstacleScene () : obstacles_ (),
+      manager_ (new fcl::DynamicAABBTreeCollisionManager), ready_ (true)
+    {
+    }
+
+    bool ObstacleScene::add (const CollisionObjectPtr_t& object)
+    {
+      fcl::CollisionObject* fclObject = object->fcl ().get ();
+      if (!obstacles_.insert (std::make_pair (fclObject, object)).second) {
+	return false;
+      }
+      fclObject->computeAABB ();
+      manager_->registerObject (fclObject);
+      // The tree is balanced once, before the next collision test.
+      ready_ = false;
+      return true;
+    }
+
+    bool ObstacleScene::remove (const CollisionObjectPtr_t& object)
+    {
+      fcl::CollisionObject* fclObject = object->fcl ().get ();
+      if (obstacles_.erase (fclObject) == 0) return false;
+      manager_->unregisterObject (fclObject);
+      ready_ = false;
+      return true;
+    }
+
+    bool ObstacleScene::update (const CollisionObjectPtr_t& object)
+    {
+      fcl::CollisionObject* fclObject = object->fcl ().get ();
+      if (obstacles_.find (fclObject) == obstacles_.end ()) return false;
+      fclObject->computeAABB ();
+      manager_->update (fclObject);
+      ready_ = false;
+      return true;
+    }
+
+    CollisionObjectPtr_t ObstacleScene::find
+    (const fcl::CollisionObject* object) const
+    {
+      Obstacles_t::const_iterator it = obstacles_.find (object);
+      if (it == obstacles_.end ()) return CollisionObjectPtr_t ();
+      return it->second;
+    }
+
+    void ObstacleScene::setup ()
+    {
+      if (ready_) return;
+      manager_->setup ();
+      ready_ = true;
+    }
+
+    void ObstacleScene::collide (fcl::CollisionObject* object, void* data,
+				 Callback_t callback) const
+    {
+      assert (ready_);
+      manager_->collide (object, data, callback);
+    }
+  } // namespace core
+} // namespace hpp
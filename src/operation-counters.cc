@@ -0,0 +1,160 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <set>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <hpp/core/operation-counters.hh>
+
+namespace hpp {
+  namespace core {
+    namespace {
+      typedef OperationCounters::Values_t Values_t;
+      const std::size_t numberOperations =
+	OperationCounters::NUMBER_OPERATIONS;
+
+      // Counters of one thread, only incremented by this thread
+      struct ThreadCounters
+      {
+	ThreadCounters ()
+	{
+	  for (std::size_t i = 0; i < numberOperations; ++i) values [i] = 0;
+	}
+	boost::atomic <std::size_t> values [numberOperations];
+      }; // struct ThreadCounters
+
+      // Counters of running threads and sum of the counters of terminated
+      // threads, protected by a mutex
+      struct Registry
+      {
+	Registry () : retired (numberOperations, 0) {}
+	boost::mutex mutex;
+	std::set <ThreadCounters*> threads;
+	Values_t retired;
+      }; // struct Registry
+
+      // Never destroyed: the counters of the main thread are retired by the
+      // destructor of the thread specific pointer, at exit.
+      Registry& registry ()
+      {
+	static Registry* instance = new Registry;
+	return *instance;
+      }
+
+      // Called at termination of a thread
+      void retire (ThreadCounters* counters)
+      {
+	Registry& r (registry ());
+	{
+	  boost::mutex::scoped_lock lock (r.mutex);
+	  for (std::size_t i = 0; i < numberOperations; ++i) {
+	    r.retired [i] += counters->values [i].load
+	      (boost::memory_order_relaxed);
+	  }
+	  r.threads.erase (counters);
+	}
+	delete counters;
+      }
+
+      boost::thread_specific_ptr <ThreadCounters> local (&retire);
+
+      ThreadCounters& localCounters ()
+      {
+	ThreadCounters* counters = local.get ();
+	if (!counters) {
+	  counters = new ThreadCounters;
+	  Registry& r (registry ());
+	  boost::mutex::scoped_lock lock (r.mutex);
+	  r.threads.insert (counters);
+	  local.reset (counters);
+	}
+	return *counters;
+      }
+
+      const char* names [numberOperations] = {
+	"nearest neighbor queries",
+	"steering method calls",
+	"projections",
+	"configuration validations",
+	"narrow phase collision tests",
+	"continuous collision checking steps",
+	"graph search expansions"
+      };
+    } // namespace
+
+    boost::atomic <bool> OperationCounters::enabled_ (false);
+
+    void OperationCounters::enable (bool enable)
+    {
+      enabled_.store (enable, boost::memory_order_relaxed);
+    }
+
+    void OperationCounters::add (Operation operation, std::size_t n)
+    {
+      // The counter is only written by this thread: the increment does not
+      // need to be atomic, the load and store only need to be.
+      boost::atomic <std::size_t>& counter
+	(localCounters ().values [operation]);
+      counter.store (counter.load (boost::memory_order_relaxed) + n,
+		     boost::memory_order_relaxed);
+    }
+
+    Values_t OperationCounters::values ()
+    {
+      Registry& r (registry ());
+      boost::mutex::scoped_lock lock (r.mutex);
+      Values_t result (r.retired);
+      for (std::set <ThreadCounters*>::const_iterator it = r.threads.begin ();
+	   it != r.threads.end (); ++it) {
+	for (std::size_t i = 0; i < numberOperations; ++i) {
+	  result [i] += (*it)->values [i].load (boost::memory_order_relaxed);
+	}
+      }
+      return result;
+    }
+
+    void OperationCounters::reset ()
+    {
+      Registry& r (registry ());
+      boost::mutex::scoped_lock lock (r.mutex);
+      r.retired.assign (numberOperations, 0);
+      for (std::set <ThreadCounters*>::const_iterator it = r.threads.begin ();
+	   it != r.threads.end (); ++it) {
+	for (std::size_t i = 0; i < numberOperations; ++i) {
+	  (*it)->values [i].store (0, boost::memory_order_relaxed);
+	}
+      }
+    }
+
+    const char* OperationCounters::name (Operation operation)
+    {
+      return names [operation];
+    }
+
+    std::ostream& OperationCounters::print (std::ostream& os,
+					    const Values_t& values)
+    {
+      for (std::size_t i = 0; i < values.size () && i < numberOperations;
+	   ++i) {
+	os << names [i] << ": " << values [i] << std::endl;
+      }
+      return os;
+    }
+  } // namespace core
+} // namespace hpp
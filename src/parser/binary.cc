@@ -0,0 +1,345 @@
+//
+// Copyright (c) 2016 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <hpp/model/device.hh>
+#include <hpp/core/edge.hh>
+#include <hpp/core/interpolated-path.hh>
+#include <hpp/core/node.hh>
+#include <hpp/core/parser/binary.hh>
+#include <hpp/core/path-vector.hh>
+#include <hpp/core/roadmap.hh>
+#include <hpp/core/straight-path.hh>
+
+namespace hpp {
+  namespace core {
+    namespace parser {
+      namespace {
+	const boost::uint32_t binaryVersion = 1;
+
+	void initHeader (BinaryHeader& header, BinaryHeader::Content content,
+			 size_type configSize, size_type numberDof)
+	{
+	  std::memset (&header, 0, sizeof (BinaryHeader));
+	  std::memcpy (header.magic, "HPPB", 4);
+	  header.version = binaryVersion;
+	  header.content = content;
+	  header.configSize = configSize;
+	  header.numberDof = numberDof;
+	  header.initNode = -1;
+	}
+
+	template <typename T> void write (std::ostream& o,
+					  const std::vector <T>& values)
+	{
+	  if (values.empty ()) return;
+	  o.write (reinterpret_cast <const char*> (&values [0]),
+		   values.size () * sizeof (T));
+	}
+
+	// Check the header of a mapped file and return it
+	const BinaryHeader* checkHeader
+	(const boost::interprocess::mapped_region& region,
+	 BinaryHeader::Content content, const std::string& filename)
+	{
+	  const BinaryHeader* header = static_cast <const BinaryHeader*>
+	    (region.get_address ());
+	  if (region.get_size () < sizeof (BinaryHeader) ||
+	      std::memcmp (header->magic, "HPPB", 4) != 0) {
+	    throw std::runtime_error (filename + " is not a binary hpp file.");
+	  }
+	  if (header->version != binaryVersion) {
+	    std::ostringstream oss;
+	    oss << filename << ": unsupported version " << header->version
+		<< " of binary format.";
+	    throw std::runtime_error (oss.str ());
+	  }
+	  if (header->content != (boost::uint32_t) content) {
+	    throw std::runtime_error (filename + " does not contain the "
+				      "expected type of object.");
+	  }
+	  return header;
+	}
+
+	void checkSize (const boost::interprocess::mapped_region& region,
+			std::size_t numberValues, const std::string& filename)
+	{
+	  if (region.get_size () < sizeof (BinaryHeader) + 8 * numberValues) {
+	    throw std::runtime_error (filename + " is truncated.");
+	  }
+	}
+
+	void checkRobot (const BinaryHeader* header, const DevicePtr_t& robot)
+	{
+	  if (header->configSize != (boost::uint64_t) robot->configSize () ||
+	      header->numberDof != (boost::uint64_t) robot->numberDof ()) {
+	    std::ostringstream oss;
+	    oss << "Binary file stores configurations of size "
+		<< header->configSize << ", robot " << robot->name ()
+		<< " has configurations of size " << robot->configSize ()
+		<< ".";
+	    throw std::runtime_error (oss.str ());
+	  }
+	}
+      } // namespace
+
+      void writeRoadmapBinary (std::ostream& o, const RoadmapPtr_t& roadmap,
+			       const DevicePtr_t& robot)
+      {
+	const Nodes_t& nodes = roadmap->nodes ();
+	size_type configSize = robot->configSize ();
+	BinaryHeader header;
+	initHeader (header, BinaryHeader::ROADMAP, configSize,
+		    robot->numberDof ());
+	std::map <NodePtr_t, boost::uint64_t> ranks;
+	std::vector <value_type> configurations;
+	configurations.reserve (nodes.size () * configSize);
+	boost::uint64_t rank = 0;
+	for (Nodes_t::const_iterator itNode = nodes.begin ();
+	     itNode != nodes.end (); ++itNode, ++rank) {
+	  ranks [*itNode] = rank;
+	  const Configuration_t& q = *((*itNode)->configuration ());
+	  configurations.insert (configurations.end (), q.data (),
+				 q.data () + configSize);
+	}
+	std::vector <value_type> lengths;
+	std::vector <boost::uint64_t> from, to, types;
+	for (Nodes_t::const_iterator itNode = nodes.begin ();
+	     itNode != nodes.end (); ++itNode) {
+	  const Node::Edges_t& edges = (*itNode)->outEdges ();
+	  for (Node::Edges_t::const_iterator itEdge = edges.begin ();
+	       itEdge != edges.end (); ++itEdge) {
+	    // Paths computed on first access are not computed to be saved.
+	    // Straight paths are restored without constraints.
+	    lengths.push_back ((*itEdge)->length ());
+	    from.push_back (ranks [*itNode]);
+	    to.push_back (ranks [(*itEdge)->to ()]);
+	    bool straight = (*itEdge)->hasPath () &&
+	      HPP_DYNAMIC_PTR_CAST (StraightPath, (*itEdge)->path ()) &&
+	      !(*itEdge)->path ()->constraints ();
+	    types.push_back (straight ? BinaryHeader::STRAIGHT_PATH :
+			     BinaryHeader::OTHER_PATH);
+	  }
+	}
+	std::vector <boost::uint64_t> goals;
+	for (Nodes_t::const_iterator itGoal = roadmap->goalNodes ().begin ();
+	     itGoal != roadmap->goalNodes ().end (); ++itGoal) {
+	  goals.push_back (ranks [*itGoal]);
+	}
+	header.numberConfigurations = nodes.size ();
+	header.numberPaths = lengths.size ();
+	if (roadmap->initNode ()) {
+	  header.initNode = ranks [roadmap->initNode ()];
+	}
+	header.numberGoalNodes = goals.size ();
+	o.write (reinterpret_cast <const char*> (&header), sizeof (header));
+	write (o, configurations);
+	write (o, lengths);
+	write (o, from);
+	write (o, to);
+	write (o, types);
+	write (o, goals);
+	if (!o) throw std::runtime_error ("Failed to write binary roadmap.");
+      }
+
+      MappedRoadmap::MappedRoadmap (const std::string& filename) :
+	file_ (filename.c_str (), boost::interprocess::read_only),
+	region_ (file_, boost::interprocess::read_only), header_ (0x0),
+	configurations_ (0x0), lengths_ (0x0), from_ (0x0), to_ (0x0),
+	types_ (0x0), goals_ (0x0)
+      {
+	header_ = checkHeader (region_, BinaryHeader::ROADMAP, filename);
+	std::size_t nbConfigValues = header_->configSize *
+	  header_->numberConfigurations;
+	std::size_t nbEdges = header_->numberPaths;
+	checkSize (region_, nbConfigValues + 4 * nbEdges +
+		   header_->numberGoalNodes, filename);
+	configurations_ = reinterpret_cast <const value_type*> (header_ + 1);
+	lengths_ = configurations_ + nbConfigValues;
+	from_ = reinterpret_cast <const boost::uint64_t*> (lengths_ + nbEdges);
+	to_ = from_ + nbEdges;
+	types_ = to_ + nbEdges;
+	goals_ = types_ + nbEdges;
+      }
+
+      RoadmapPtr_t MappedRoadmap::roadmap
+      (const DistancePtr_t& distance, const DevicePtr_t& robot,
+       const SteeringMethodPtr_t& steeringMethod) const
+      {
+	checkRobot (header_, robot);
+	// Check the edges before creating the roadmap
+	for (std::size_t i = 0; i < numberEdges (); ++i) {
+	  if (from_ [i] >= numberNodes () || to_ [i] >= numberNodes ()) {
+	    throw std::runtime_error ("Invalid node rank in binary roadmap.");
+	  }
+	  if (types_ [i] == BinaryHeader::OTHER_PATH) {
+	    if (!steeringMethod) {
+	      throw std::runtime_error ("Paths of the edges of the binary "
+					"roadmap should be computed by a "
+					"steering method.");
+	    }
+	  } else if (types_ [i] != BinaryHeader::STRAIGHT_PATH) {
+	    throw std::runtime_error ("Unknown type of path in binary "
+				      "roadmap.");
+	  }
+	}
+	RoadmapPtr_t result = Roadmap::create (distance, robot);
+	Eigen::Map <const matrix_t> configs (configurations ());
+	std::vector <NodePtr_t> nodes (numberNodes ());
+	for (std::size_t i = 0; i < nodes.size (); ++i) {
+	  nodes [i] = result->addNode
+	    (ConfigurationPtr_t (new Configuration_t (configs.col (i))));
+	}
+	for (std::size_t i = 0; i < numberEdges (); ++i) {
+	  const NodePtr_t& from (nodes [from_ [i]]);
+	  const NodePtr_t& to (nodes [to_ [i]]);
+	  if (types_ [i] == BinaryHeader::OTHER_PATH) {
+	    result->addEdge (from, to, steeringMethod, lengths_ [i]);
+	  } else {
+	    PathPtr_t path = StraightPath::create
+	      (robot, *(from->configuration ()), *(to->configuration ()),
+	       lengths_ [i]);
+	    result->addEdge (from, to, path);
+	  }
+	}
+	if (header_->initNode >= 0 &&
+	    (std::size_t) header_->initNode < nodes.size ()) {
+	  result->initNode (nodes [header_->initNode]->configuration ());
+	}
+	for (std::size_t i = 0; i < header_->numberGoalNodes; ++i) {
+	  if (goals_ [i] >= nodes.size ()) {
+	    throw std::runtime_error ("Invalid goal rank in binary roadmap.");
+	  }
+	  result->addGoalNode (nodes [goals_ [i]]->configuration ());
+	}
+	return result;
+      }
+
+      void writePathVectorBinary (std::ostream& o, const PathVectorPtr_t& path)
+      {
+	PathVectorPtr_t flat = PathVector::create
+	  (path->outputSize (), path->outputDerivativeSize ());
+	path->flatten (flat);
+	size_type configSize = path->outputSize ();
+	BinaryHeader header;
+	initHeader (header, BinaryHeader::PATH_VECTOR, configSize,
+		    path->outputDerivativeSize ());
+	std::vector <value_type> configurations, times, lengths;
+	std::vector <boost::uint64_t> first, types;
+	for (std::size_t i = 0; i < flat->numberPaths (); ++i) {
+	  const PathPtr_t& p (flat->pathAtRankNoCopy (i));
+	  lengths.push_back (p->length ());
+	  first.push_back (times.size ());
+	  if (HPP_DYNAMIC_PTR_CAST (StraightPath, p)) {
+	    Configuration_t q (p->initial ());
+	    configurations.insert (configurations.end (), q.data (),
+				   q.data () + configSize);
+	    q = p->end ();
+	    configurations.insert (configurations.end (), q.data (),
+				   q.data () + configSize);
+	    times.push_back (0);
+	    times.push_back (p->length ());
+	    types.push_back (BinaryHeader::STRAIGHT_PATH);
+	  } else if (InterpolatedPathPtr_t ip =
+		     HPP_DYNAMIC_PTR_CAST (InterpolatedPath, p)) {
+	    for (std::size_t j = 0; j < ip->numberInterpolationPoints (); ++j) {
+	      ConfigurationIn_t q (ip->interpolationPoint (j));
+	      for (size_type k = 0; k < configSize; ++k) {
+		configurations.push_back (q [k]);
+	      }
+	      times.push_back (ip->interpolationTime (j));
+	    }
+	    types.push_back (BinaryHeader::INTERPOLATED_PATH);
+	  } else {
+	    throw std::runtime_error ("Only StraightPath and InterpolatedPath "
+				      "can be written in binary format.");
+	  }
+	}
+	header.numberConfigurations = times.size ();
+	header.numberPaths = lengths.size ();
+	o.write (reinterpret_cast <const char*> (&header), sizeof (header));
+	write (o, configurations);
+	write (o, times);
+	write (o, lengths);
+	write (o, first);
+	write (o, types);
+	if (!o) throw std::runtime_error ("Failed to write binary path.");
+      }
+
+      PathVectorPtr_t readPathVectorBinary (const std::string& filename,
+					    const DevicePtr_t& robot)
+      {
+	using boost::interprocess::read_only;
+	boost::interprocess::file_mapping file (filename.c_str (), read_only);
+	boost::interprocess::mapped_region region (file, read_only);
+	const BinaryHeader* header =
+	  checkHeader (region, BinaryHeader::PATH_VECTOR, filename);
+	checkRobot (header, robot);
+	std::size_t nbPoints = header->numberConfigurations;
+	std::size_t nbPaths = header->numberPaths;
+	std::size_t nbConfigValues = header->configSize * nbPoints;
+	checkSize (region, nbConfigValues + nbPoints + 3 * nbPaths, filename);
+	Eigen::Map <const matrix_t> configs
+	  (reinterpret_cast <const value_type*> (header + 1),
+	   header->configSize, nbPoints);
+	const value_type* times = configs.data () + nbConfigValues;
+	const value_type* lengths = times + nbPoints;
+	const boost::uint64_t* first =
+	  reinterpret_cast <const boost::uint64_t*> (lengths + nbPaths);
+	const boost::uint64_t* types = first + nbPaths;
+
+	PathVectorPtr_t result = PathVector::create (robot->configSize (),
+						     robot->numberDof ());
+	for (std::size_t i = 0; i < nbPaths; ++i) {
+	  std::size_t begin = first [i];
+	  std::size_t end = (i + 1 < nbPaths) ? first [i + 1] : nbPoints;
+	  if (end > nbPoints || begin + 2 > end) {
+	    throw std::runtime_error ("Invalid path in binary file " +
+				      filename + ".");
+	  }
+	  switch (types [i]) {
+	  case BinaryHeader::STRAIGHT_PATH:
+	    result->appendPath (StraightPath::create
+				(robot, configs.col (begin),
+				 configs.col (begin + 1), lengths [i]));
+	    break;
+	  case BinaryHeader::INTERPOLATED_PATH:
+	    {
+	      InterpolatedPathPtr_t path = InterpolatedPath::create
+		(robot, configs.col (begin), configs.col (end - 1),
+		 lengths [i]);
+	      for (std::size_t j = begin + 1; j + 1 < end; ++j) {
+		path->insert (times [j], configs.col (j));
+	      }
+	      result->appendPath (path);
+	    }
+	    break;
+	  default:
+	    throw std::runtime_error ("Unknown type of path in binary file " +
+				      filename + ".");
+	  }
+	}
+	return result;
+      }
+    } // namespace parser
+  } // namespace core
+} // namespace hpp
@@ -17,6 +17,11 @@
 #include <hpp/util/debug.hh>
 #include "hpp/core/parser/roadmap-factory.hh"
 
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
 #include <string>
 
 #include <hpp/model/configuration.hh>
@@ -24,6 +29,7 @@
 #include <hpp/model/joint.hh>
 
 #include "hpp/core/steering-method-straight.hh"
+#include "hpp/core/weighed-distance.hh"
 #include "hpp/core/roadmap.hh"
 #include "hpp/core/node.hh"
 #include "hpp/core/edge.hh"
@@ -34,40 +40,316 @@ namespace hpp {
       DistancePtr_t RoadmapFactory::ArgumentParser::d_ = DistancePtr_t ();
       DevicePtr_t   RoadmapFactory::ArgumentParser::r_ = DevicePtr_t ();
 
+      namespace {
+	typedef std::map <std::string, std::string> Attributes_t;
+
+	void writeEscaped (std::ostream& o, const std::string& text)
+	{
+	  for (std::string::const_iterator it = text.begin ();
+	       it != text.end (); ++it) {
+	    switch (*it) {
+	    case '<': o << "&lt;"; break;
+	    case '>': o << "&gt;"; break;
+	    case '&': o << "&amp;"; break;
+	    case '"': o << "&quot;"; break;
+	    default: o << *it;
+	    }
+	  }
+	}
+
+	std::string unescape (const std::string& text)
+	{
+	  static const char* entities [][2] = {
+	    {"&lt;", "<"}, {"&gt;", ">"}, {"&quot;", "\""}, {"&apos;", "'"},
+	    {"&amp;", "&"}
+	  };
+	  std::string result;
+	  result.reserve (text.size ());
+	  for (std::size_t i = 0; i < text.size (); ++i) {
+	    bool replaced = false;
+	    if (text [i] == '&') {
+	      for (std::size_t e = 0; e < 5 && !replaced; ++e) {
+		std::size_t n = std::strlen (entities [e][0]);
+		if (text.compare (i, n, entities [e][0]) == 0) {
+		  result += entities [e][1];
+		  i += n - 1;
+		  replaced = true;
+		}
+	      }
+	    }
+	    if (!replaced) result += text [i];
+	  }
+	  return result;
+	}
+
+	/// Sequential reader of the tags of an XML stream
+	///
+	/// Only what is needed to read roadmaps is supported: elements,
+	/// attributes, text, comments and declarations.
+	class TagReader
+	{
+	public:
+	  TagReader (std::istream& in) : in_ (in)
+	  {
+	  }
+
+	  /// Read next tag, skipping text, comments and declarations
+	  /// \return false at the end of the stream.
+	  bool next (std::string& name, Attributes_t& attributes,
+		     bool& closing, bool& empty)
+	  {
+	    std::string tag;
+	    while (true) {
+	      if (!in_.ignore (std::numeric_limits <std::streamsize>::max (),
+			       '<')) return false;
+	      tag.clear ();
+	      if (!std::getline (in_, tag, '>')) return false;
+	      if (tag.compare (0, 3, "!--") == 0) {
+		// Comments may contain '>'
+		while (tag.size () < 5 ||
+		       tag.compare (tag.size () - 2, 2, "--") != 0) {
+		  std::string rest;
+		  if (!std::getline (in_, rest, '>')) return false;
+		  tag += ">" + rest;
+		}
+		continue;
+	      }
+	      if (!tag.empty () && (tag [0] == '?' || tag [0] == '!')) continue;
+	      break;
+	    }
+	    closing = (!tag.empty () && tag [0] == '/');
+	    empty = (!tag.empty () && tag [tag.size () - 1] == '/');
+	    std::size_t begin = closing ? 1 : 0;
+	    std::size_t end = tag.find_first_of (" \t\r\n/", begin);
+	    if (end == std::string::npos) end = tag.size ();
+	    name = tag.substr (begin, end - begin);
+	    attributes.clear ();
+	    while (true) {
+	      std::size_t equal = tag.find ('=', end);
+	      if (equal == std::string::npos) break;
+	      std::size_t nameBegin = tag.find_first_not_of (" \t\r\n", end);
+	      std::size_t nameEnd = tag.find_last_not_of (" \t\r\n", equal - 1);
+	      std::size_t quote = tag.find_first_of ("\"'", equal);
+	      if (quote == std::string::npos) break;
+	      std::size_t valueEnd = tag.find (tag [quote], quote + 1);
+	      if (valueEnd == std::string::npos) break;
+	      attributes [tag.substr (nameBegin, nameEnd + 1 - nameBegin)] =
+		unescape (tag.substr (quote + 1, valueEnd - quote - 1));
+	      end = valueEnd + 1;
+	    }
+	    return true;
+	  }
+
+	  /// Read text up to the next tag and the closing tag of the element
+	  std::string text ()
+	  {
+	    std::string result, closingTag;
+	    std::getline (in_, result, '<');
+	    std::getline (in_, closingTag, '>');
+	    return unescape (result);
+	  }
+
+	private:
+	  std::istream& in_;
+	}; // class TagReader
+
+	// Compute the rank in the configuration of the robot of each
+	// configuration variable, listed in the order of the joint names.
+	void computePermutation (const DevicePtr_t& robot,
+				 const std::vector <std::string>& jn,
+				 std::vector <std::size_t>& permutation)
+	{
+	  size_t rank = 0;
+	  permutation = std::vector <std::size_t> (robot->configSize ());
+	  for (size_t i = 0; i < jn.size (); ++i) {
+	    JointPtr_t j = robot->getJointByName (jn[i]);
+	    if (!j) throw std::invalid_argument ("Joint " + jn[i] + " not found");
+	    for (size_type r = 0; r < j->configSize (); ++r)
+	      permutation [rank + r] = j->rankInConfiguration() + (std::size_t)r;
+	    rank += j->configSize();
+	  }
+	  if (rank != permutation.size())
+	    throw std::logic_error (
+		"The list of joints does not correspond to this robot.");
+	}
+
+	ConfigurationPtr_t permuteAndCreateConfiguration
+	(const DevicePtr_t& robot, const std::vector <std::size_t>& permutation,
+	 const std::vector <double>& config)
+	{
+	  ConfigurationPtr_t cfg (new Configuration_t (robot->configSize()));
+	  Configuration_t& q =*cfg;
+	  for (size_type i = 0; i < q.size(); ++i)
+	    q[i] = config [permutation[i]];
+	  normalize (robot, q);
+	  return cfg;
+	}
+
+	template <typename T> void readValues (const std::string& text,
+					       std::vector <T>& values)
+	{
+	  std::istringstream iss (text);
+	  values.clear ();
+	  T value;
+	  while (iss >> value) values.push_back (value);
+	}
+      } // namespace
+
       void writeRoadmap (std::ostream& o, const RoadmapPtr_t roadmap,
           const DevicePtr_t robot)
       {
-        using namespace hpp::util::parser;
-        XMLDocument doc;
-        XMLPrinter printer;
-        doc.InsertEndChild (XMLDeclaration ("0.0", "Unknown", "yes"));
-        doc.InsertEndChild (XMLComment ("This file was automatically generated."));
-        RoadmapFactory rf (robot, roadmap);
-        // XMLNode* node = rf.write (&doc);
-        rf.write (&doc);
-        doc.Accept (&printer);
-
-        o << printer.Str();
+	// Nodes and edges are formatted directly in the stream, in the
+	// layout of RoadmapFactory::write.
+	std::streamsize precision = o.precision
+	  (std::numeric_limits <value_type>::digits10 + 2);
+	o << "<?xml version=\"0.0\" encoding=\"Unknown\" standalone=\"yes\" ?>"
+	  << std::endl
+	  << "<!--This file was automatically generated.-->" << std::endl;
+	const Nodes_t& nodes = roadmap->nodes ();
+	std::map <NodePtr_t, std::size_t> ranks;
+	std::size_t rank = 0;
+	for (Nodes_t::const_iterator it = nodes.begin ();
+	     it != nodes.end (); ++it, ++rank) {
+	  ranks [*it] = rank;
+	}
+	o << "<roadmap";
+	if (roadmap->initNode ()) {
+	  o << " init_node=\"" << ranks [roadmap->initNode ()] << "\"";
+	}
+	o << ">" << std::endl;
+
+	const JointVector_t& joints = robot->getJointVector ();
+	std::vector <std::string> names;
+	for (JointVector_t::const_iterator it = joints.begin();
+	     it != joints.end(); ++it) {
+	  if ((*it)->configSize() <= 0) continue;
+	  names.push_back ((*it)->name ());
+	}
+	o << "  <joints size=\"" << names.size () << "\">";
+	for (std::size_t i = 0; i < names.size (); ++i) {
+	  writeEscaped (o, names [i]);
+	  o << " ";
+	}
+	o << "</joints>" << std::endl;
+
+	rank = 0;
+	for (Nodes_t::const_iterator it = nodes.begin ();
+	     it != nodes.end(); ++it, ++rank) {
+	  const Configuration_t& q = *((*it)->configuration());
+	  o << "  <node size=\"" << q.size () << "\">";
+	  for (size_type i = 0; i < q.size(); ++i) o << q [i] << " ";
+	  o << "</node>" << std::endl;
+	  const Node::Edges_t& edges = (*it)->outEdges ();
+	  for (Node::Edges_t::const_iterator ed = edges.begin();
+	       ed != edges.end (); ++ed) {
+	    o << "  <path from=\"" << rank << "\" to=\""
+	      << ranks [(*ed)->to ()] << "\"";
+	    // Paths computed on first access have no constraints.
+	    ConstraintSetPtr_t constraints;
+	    if ((*ed)->hasPath ()) constraints = (*ed)->path ()->constraints ();
+	    if (constraints) {
+	      o << " constraint=\"";
+	      writeEscaped (o, constraints->name ());
+	      o << "\"";
+	    }
+	    o << " />" << std::endl;
+	  }
+	}
+
+	o << "  <goal_nodes size=\"" << roadmap->goalNodes ().size () << "\">";
+	for (core::Nodes_t::const_iterator it = roadmap->goalNodes ().begin ();
+	     it != roadmap->goalNodes ().end(); ++it) {
+	  o << ranks [*it] << " ";
+	}
+	o << "</goal_nodes>" << std::endl;
+	o << "</roadmap>" << std::endl;
+	o.precision (precision);
       }
 
       RoadmapPtr_t readRoadmap (const std::string& fn, const DistancePtr_t distance,
           const DevicePtr_t robot)
       {
-        using namespace hpp::util::parser;
-        Parser p;
-        // RoadmapFactory::ArgumentParser ap (distance, robot);
-        // p.addObjectFactory ("roadmap", (Parser::FactoryType)(&(ap.create)));
-        RoadmapFactory::ArgumentParser::d_ = distance;
-        RoadmapFactory::ArgumentParser::r_ = robot;
-        p.addObjectFactory ("roadmap", RoadmapFactory::ArgumentParser::create);
-        p.addObjectFactory ("joints", create <StringSequence>);
-        p.addObjectFactory ("node", create <ConfigurationFactory>);
-        p.addObjectFactory ("goal_nodes", create <IdSequence>);
-        p.addObjectFactory ("path", create <ObjectFactory>);
-        p.parseFile (fn);
-        ObjectFactory* rf = 0;
-        p.root ()->getChildOfType ("roadmap", rf);
-        return rf->as<RoadmapFactory>()->roadmap ();
+	// Elements are processed as they are read, without building the
+	// document in memory.
+	std::ifstream file (fn.c_str ());
+	if (!file.is_open ()) {
+	  throw std::invalid_argument ("Could not open file " + fn);
+	}
+	TagReader reader (file);
+	std::vector <std::size_t> permutation;
+	RoadmapPtr_t roadmap = Roadmap::create (distance, robot);
+	std::vector <NodePtr_t> nodes;
+	std::vector <std::pair <std::size_t, std::size_t> > paths;
+	std::vector <unsigned int> goals;
+	long int initId = -1;
+	bool hasJoints = false;
+	std::string name;
+	Attributes_t attributes;
+	bool closing, empty;
+	std::vector <double> values;
+	std::vector <std::string> jointNames;
+	while (reader.next (name, attributes, closing, empty)) {
+	  if (closing) continue;
+	  if (name == "roadmap") {
+	    Attributes_t::const_iterator init = attributes.find ("init_node");
+	    if (init != attributes.end ()) {
+	      initId = boost::lexical_cast <long int> (init->second);
+	    }
+	  } else if (name == "joints" && !empty) {
+	    readValues (reader.text (), jointNames);
+	    computePermutation (robot, jointNames, permutation);
+	    hasJoints = true;
+	  } else if (name == "node" && !empty) {
+	    if (!hasJoints) {
+	      throw std::invalid_argument ("Joints should be defined before "
+					   "nodes in " + fn);
+	    }
+	    readValues (reader.text (), values);
+	    if (values.size () != (std::size_t) robot->configSize ()) {
+	      throw std::invalid_argument ("Wrong configuration size in " + fn);
+	    }
+	    nodes.push_back (roadmap->addNode
+			     (permuteAndCreateConfiguration (robot, permutation,
+							     values)));
+	  } else if (name == "path") {
+	    paths.push_back (std::make_pair
+			     (boost::lexical_cast <std::size_t>
+			      (attributes ["from"]),
+			      boost::lexical_cast <std::size_t>
+			      (attributes ["to"])));
+	    if (attributes.count ("constraint")) {
+	      hppDout (warning, "Constraints in paths is not supported yet");
+	    }
+	  } else if (name == "goal_nodes" && !empty) {
+	    readValues (reader.text (), goals);
+	  }
+	}
+
+	// Nodes of paths may be defined after the paths. Paths are only
+	// computed when edges are used, the length of the edges is the
+	// distance used by the steering method.
+	WeighedDistancePtr_t d = WeighedDistance::create (robot);
+	SteeringMethodStraightPtr_t sm = SteeringMethodStraight::create
+	  (robot, d);
+	for (std::size_t i = 0; i < paths.size (); ++i) {
+	  if (paths [i].first >= nodes.size () ||
+	      paths [i].second >= nodes.size ()) {
+	    throw std::invalid_argument ("Invalid node id in path of " + fn);
+	  }
+	  NodePtr_t from = nodes [paths [i].first],
+	    to = nodes [paths [i].second];
+	  roadmap->addEdge (from, to, sm, (*d) (*(from->configuration()),
+						*(to  ->configuration())));
+	}
+	if (initId >= 0 && (std::size_t) initId < nodes.size ()) {
+	  roadmap->initNode (nodes [initId]->configuration ());
+	}
+	for (std::size_t i = 0; i < goals.size (); ++i) {
+	  if (goals [i] < nodes.size ()) {
+	    roadmap->addGoalNode (nodes [goals [i]]->configuration ());
+	  }
+	}
+	return roadmap;
       }
 
       RoadmapFactory::RoadmapFactory (const DistancePtr_t& distance,
@@ -143,29 +425,14 @@ namespace hpp {
       void RoadmapFactory::computePermutation (
           const std::vector <std::string>& jn)
       {
-        size_t rank = 0;
-        permutation_ = SizeVector_t (robot_->configSize ());
-        for (size_t i = 0; i < jn.size (); ++i) {
-          JointPtr_t j = robot_->getJointByName (jn[i]);
-          if (!j) throw std::invalid_argument ("Joint " + jn[i] + " not found");
-          for (size_type r = 0; r < j->configSize (); ++r)
-            permutation_ [rank + r] = j->rankInConfiguration() + (std::size_t)r;
-          rank += j->configSize();
-        }
-        if (rank != permutation_.size())
-          throw std::logic_error (
-              "The list of joints does not correspond to this robot.");
+        parser::computePermutation (robot_, jn, permutation_);
       }
 
       ConfigurationPtr_t RoadmapFactory::permuteAndCreateConfiguration (
           const std::vector <double>& config)
       {
-        ConfigurationPtr_t cfg (new Configuration_t (robot_->configSize()));
-        Configuration_t& q =*cfg;
-        for (size_type i = 0; i < q.size(); ++i)
-          q[i] = config [permutation_[i]];
-	normalize (robot_, q);
-        return cfg;
+        return parser::permuteAndCreateConfiguration (robot_, permutation_,
+                                                      config);
       }
 
       RoadmapFactory::RoadmapFactory (const DevicePtr_t& robot, RoadmapPtr_t roadmap,
@@ -188,7 +455,7 @@ namespace hpp {
 
         // Write nodes and edges
         typedef std::list <NodePtr_t> NodeList;
-        typedef std::list <EdgePtr_t> EdgeList;
+        typedef Node::Edges_t EdgeList;
         size_type fromId = 0;
         const NodeList& nodes = roadmap_->nodes ();
         for (NodeList::const_iterator it = nodes.begin ();
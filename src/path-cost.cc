@@ -0,0 +1,189 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <hpp/model/device.hh>
+#include <hpp/core/distance.hh>
+#include <hpp/core/distance-between-objects.hh>
+#include <hpp/core/path.hh>
+#include <hpp/core/path-cost.hh>
+
+namespace hpp {
+  namespace core {
+    namespace {
+      // Evaluate a path at regularly spaced parameters, including the ends
+      // of the interval of definition, with intervals smaller than step.
+      // Return false if an evaluation fails.
+      bool sample (const PathPtr_t& path, value_type step,
+		   matrix_t& configurations, value_type& interval)
+      {
+	const interval_t& range (path->timeRange ());
+	const value_type length = range.second - range.first;
+	size_type n = std::max ((size_type) std::ceil (length / step),
+				(size_type) 1);
+	interval = length / (value_type) n;
+	vector_t times (n + 1);
+	for (size_type i = 0; i < n; ++i) {
+	  times [i] = range.first + (value_type) i * interval;
+	}
+	times [n] = range.second;
+	configurations.resize (path->outputSize (), n + 1);
+	std::vector <bool> success;
+	path->eval (times, configurations, success);
+	return std::find (success.begin (), success.end (), false) ==
+	  success.end ();
+      }
+
+      void checkStep (value_type step)
+      {
+	if (!(step > 0)) {
+	  throw std::invalid_argument ("Sampling step should be positive.");
+	}
+      }
+    } // namespace
+
+    LengthCostPtr_t LengthCost::create ()
+    {
+      return LengthCostPtr_t (new LengthCost);
+    }
+
+    value_type LengthCost::impl_cost (const PathPtr_t& path) const
+    {
+      return path->length ();
+    }
+
+    ClearanceCostPtr_t ClearanceCost::create
+    (const DevicePtr_t& robot, const DistanceBetweenObjectsPtr_t& clearance,
+     const DistancePtr_t& distance, value_type weight, value_type step)
+    {
+      if (weight < 0) {
+	throw std::invalid_argument ("Weight should be non negative.");
+      }
+      checkStep (step);
+      return ClearanceCostPtr_t (new ClearanceCost (robot, clearance,
+						    distance, weight, step));
+    }
+
+    ClearanceCost::ClearanceCost
+    (const DevicePtr_t& robot, const DistanceBetweenObjectsPtr_t& clearance,
+     const DistancePtr_t& distance, value_type weight, value_type step) :
+      robot_ (robot), clearance_ (clearance), distance_ (distance),
+      weight_ (weight), step_ (step)
+    {
+    }
+
+    value_type ClearanceCost::clearance (ConfigurationIn_t q) const
+    {
+      robot_->currentConfiguration (q);
+      robot_->computeForwardKinematics ();
+      clearance_->computeDistances ();
+      value_type result = std::numeric_limits <value_type>::infinity ();
+      const DistanceResults_t& results (clearance_->distanceResults ());
+      for (DistanceResults_t::const_iterator it = results.begin ();
+	   it != results.end (); ++it) {
+	result = std::min (result, (value_type) it->fcl.min_distance);
+      }
+      return result;
+    }
+
+    value_type ClearanceCost::impl_cost (const PathPtr_t& path) const
+    {
+      const value_type inf = std::numeric_limits <value_type>::infinity ();
+      matrix_t configurations;
+      value_type interval;
+      if (!sample (path, step_, configurations, interval)) return inf;
+      value_type result = 0;
+      value_type c0 = clearance (configurations.col (0));
+      for (size_type i = 1; i < configurations.cols (); ++i) {
+	const value_type c1 = clearance (configurations.col (i));
+	// Samples in contact give an infinite cost.
+	const value_type c = (c0 + c1) / 2;
+	if (!(c > 0)) return inf;
+	result += (*distance_) (configurations.col (i - 1),
+				configurations.col (i)) * (1 + weight_ / c);
+	c0 = c1;
+      }
+      return result;
+    }
+
+    EnergyCostPtr_t EnergyCost::create (const DistancePtr_t& distance,
+					value_type step)
+    {
+      checkStep (step);
+      return EnergyCostPtr_t (new EnergyCost (distance, step));
+    }
+
+    EnergyCost::EnergyCost (const DistancePtr_t& distance, value_type step) :
+      distance_ (distance), step_ (step)
+    {
+    }
+
+    value_type EnergyCost::impl_cost (const PathPtr_t& path) const
+    {
+      const value_type inf = std::numeric_limits <value_type>::infinity ();
+      matrix_t configurations;
+      value_type interval;
+      if (!sample (path, step_, configurations, interval)) return inf;
+      if (interval == 0) return 0;
+      value_type result = 0;
+      for (size_type i = 1; i < configurations.cols (); ++i) {
+	const value_type d = (*distance_) (configurations.col (i - 1),
+					   configurations.col (i));
+	result += d * d;
+      }
+      return result / interval;
+    }
+
+    TimeCostPtr_t TimeCost::create (vectorIn_t velocityLimits)
+    {
+      if (velocityLimits.size () > 0 && !(velocityLimits.minCoeff () > 0)) {
+	throw std::invalid_argument ("Limits should be positive.");
+      }
+      return TimeCostPtr_t (new TimeCost (velocityLimits));
+    }
+
+    TimeCost::TimeCost (vectorIn_t velocityLimits) :
+      velocityLimits_ (velocityLimits)
+    {
+    }
+
+    value_type TimeCost::impl_cost (const PathPtr_t& path) const
+    {
+      const interval_t& range (path->timeRange ());
+      if (path->outputDerivativeSize () != velocityLimits_.size ()) {
+	throw std::invalid_argument
+	  ("Limits should have the size of the path velocity.");
+      }
+      vector_t bound (path->outputDerivativeSize ());
+      if (!path->velocityBound (bound, range.first, range.second)) {
+	throw std::runtime_error
+	  ("Time cost requires velocity bounds of the paths.");
+      }
+      // Speed of the parameter such that all the limits are satisfied.
+      value_type ratio = 0;
+      for (size_type j = 0; j < bound.size (); ++j) {
+	ratio = std::max (ratio, bound [j] / velocityLimits_ [j]);
+      }
+      return (range.second - range.first) * ratio;
+    }
+  } // namespace core
+} // namespace hpp
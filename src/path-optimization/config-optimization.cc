@@ -17,6 +17,7 @@
 
 #include <hpp/core/path-optimization/config-optimization.hh>
 
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 
 #include <hpp/util/debug.hh>
@@ -32,6 +33,7 @@
 #include <hpp/core/steering-method.hh>
 #include <hpp/core/config-projector.hh>
 #include <hpp/core/numerical-constraint.hh>
+#include "path-optimization/thread-problems.hh"
 
 namespace hpp {
   namespace core {
@@ -44,18 +46,54 @@ namespace hpp {
         {
           value_type result = 0;
           for (std::size_t i=0; i<path->numberPaths (); ++i) {
-            const PathPtr_t& element (path->pathAtRank (i));
+            const PathPtr_t& element (path->pathAtRankNoCopy (i));
             result += (*distance) (element->initial (), element->end ());
           }
           return result;
         }
+
+        // Steer and validate the segments to validate of rank thread,
+        // thread + nbThreads, ... among them, with the objects of a problem.
+        // Segment s is between waypoints s and s+1 of configs.
+        struct ValidateSegments
+        {
+          typedef void result_type;
+          const vector_t* configs;
+          size_type configSize;
+          const std::vector <std::size_t>* segments;
+          // one value per segment of segments, char since threads write
+          // concurrently
+          std::vector <char>* valid;
+
+          void operator() (const Problem* problem, std::size_t thread,
+              std::size_t nbThreads, bool, std::string* error) const
+          {
+            try {
+              const size_type N = configSize;
+              PathValidationPtr_t pathValidation (problem->pathValidation ());
+              for (std::size_t k = thread; k < segments->size ();
+                  k += nbThreads) {
+                const size_type s = (size_type) (*segments) [k];
+                PathPtr_t path = steer (*problem,
+                    configs->segment (s * N, N),
+                    configs->segment ((s+1) * N, N));
+                PathPtr_t validPart;
+                PathValidationReportPtr_t report;
+                (*valid) [k] = path && pathValidation->validate
+                  (path, false, validPart, report);
+              }
+            } catch (const std::exception& exc) {
+              *error = exc.what ();
+            }
+          }
+        }; // struct ValidateSegments
       }
 
       ConfigOptimization::Parameters::Parameters () :
         addConfigConstraintToPath (ConfigOptimizationTraits::addConfigConstraintToPath ()),
         numberOfPass (ConfigOptimizationTraits::numberOfPass ()),
         numberOfIterations (ConfigOptimizationTraits::numberOfIterations ()),
-        getGoal (ConfigOptimizationTraits::getGoal)
+        getGoal (ConfigOptimizationTraits::getGoal), batchPass (false)
       {}
 
       ConfigOptimizationPtr_t ConfigOptimization::create (const Problem& problem)
@@ -64,12 +102,13 @@ namespace hpp {
       }
 
       ConfigOptimization::ConfigOptimization (const Problem& problem) :
-        PathOptimizer (problem)
+        PathOptimizer (problem), threadProblems_ ()
       {
       }
 
       PathVectorPtr_t ConfigOptimization::optimize (const PathVectorPtr_t& path)
       {
+        startOptimization ();
         PathVectorPtr_t unpacked = PathVector::create (path->outputSize(),
             path->outputDerivativeSize ());
         path->flatten (unpacked);
@@ -88,7 +127,31 @@ namespace hpp {
         hppDout (info, "ConfigOptimization: length " << length);
         value_type alpha = parameters.alphaInit;
         // Loop over pass index.
-        for (std::size_t ipass = 0; ipass < parameters.numberOfPass; ++ipass) {
+        for (std::size_t ipass = 0; ipass < parameters.numberOfPass &&
+            !stopOptimization (); ++ipass) {
+          if (parameters.batchPass) {
+            bool didChange;
+            PathVectorPtr_t optedBatch = batchPass (unpacked, configs,
+                newConfigs, optimizers, alpha, didChange);
+            if (optedBatch && didChange) {
+              value_type optedLength = pathLength (optedBatch,
+                  problem().distance());
+              if (optedLength < length) {
+                unpacked = opted = optedBatch;
+                length = optedLength;
+                hppDout (info, "ConfigOptimization: accepted length "
+                    << length << ", alpha = " << alpha);
+                configs = newConfigs;
+                iterationDone (length);
+                continue;
+              }
+            }
+            hppDout (info, "ConfigOptimization: batch pass " << ipass
+                << " failed, alpha = " << alpha);
+            alpha /= 2.;
+            iterationDone ();
+            continue;
+          }
           PathVectorPtr_t optedF = PathVector::create (path->outputSize(),
               path->outputDerivativeSize ());
           PathVectorPtr_t optedB = PathVector::create (path->outputSize(),
@@ -126,6 +189,7 @@ namespace hpp {
                       << length << ", alpha = " << alpha);
                   /// Update configs
                   configs = newConfigs;
+                  iterationDone (length);
                   continue;
                 }
               } else {
@@ -138,6 +202,7 @@ namespace hpp {
           hppDout (info, "ConfigOptimization: pass " << ipass << " failed"
                       << ", alpha = " << alpha);
           alpha /= 2.;
+          iterationDone ();
         }
 
         return opted;
@@ -255,7 +320,7 @@ namespace hpp {
         std::size_t iP = 0;
         configs.segment (iP, N) = path.initial ();
         for (std::size_t i = 0; i < path.numberPaths(); ++i) {
-          PathPtr_t cur = path.pathAtRank (i);
+          const PathPtr_t& cur = path.pathAtRankNoCopy (i);
           iP += N;
           configs.segment (iP, N) = cur->end ();
         }
@@ -331,6 +396,80 @@ namespace hpp {
         }
         return true;
       }
+
+      PathVectorPtr_t ConfigOptimization::batchPass (
+          const PathVectorPtr_t& path, vectorIn_t configs,
+          vectorOut_t newConfigs, const Optimizers_t& optimizers,
+          const value_type& alpha, bool& didChange) const
+      {
+        const size_type N = path->outputSize ();
+        const std::size_t P = path->numberPaths ();
+        assert (optimizers.size () + 1 == P);
+        // Optimize all waypoints but the end points, they are independent.
+        newConfigs = configs;
+        std::vector <bool> changed (P + 1, false);
+        for (std::size_t i = 1; i < P; ++i) {
+          changed [i] = optimizers[i-1].optimize (
+              newConfigs.segment (i * N, N),
+              parameters.numberOfIterations, alpha);
+          if (!changed [i])
+            newConfigs.segment (i * N, N) = configs.segment (i * N, N);
+        }
+        // Validate segments that changed, reset waypoints of invalid
+        // segments and validate again the segments around them. Segments
+        // between unchanged waypoints are those of path, and are valid.
+        std::vector <std::size_t> segments;
+        for (std::size_t s = 0; s < P; ++s) {
+          if (changed [s] || changed [s+1]) segments.push_back (s);
+        }
+        std::vector <char> valid;
+        while (!segments.empty ()) {
+          const vector_t packed (newConfigs);
+          valid.assign (segments.size (), false);
+          ValidateSegments f;
+          f.configs = &packed;
+          f.configSize = N;
+          f.segments = &segments;
+          f.valid = &valid;
+          runThreads (problem (), threadProblems_, f);
+          std::vector <std::size_t> next;
+          for (std::size_t k = 0; k < segments.size (); ++k) {
+            if (valid [k]) continue;
+            const std::size_t s = segments [k];
+            for (std::size_t w = s; w <= s + 1; ++w) {
+              if (!changed [w]) continue;
+              hppDout (info, "ConfigOptimization: reset waypoint " << w);
+              changed [w] = false;
+              newConfigs.segment (w * N, N) = configs.segment (w * N, N);
+              if (w > 0) next.push_back (w - 1);
+              if (w < P) next.push_back (w);
+            }
+          }
+          std::sort (next.begin (), next.end ());
+          next.erase (std::unique (next.begin (), next.end ()), next.end ());
+          segments.clear ();
+          for (std::size_t k = 0; k < next.size (); ++k) {
+            const std::size_t s = next [k];
+            if (changed [s] || changed [s+1]) segments.push_back (s);
+          }
+        }
+        didChange = (std::find (changed.begin (), changed.end (), true) !=
+            changed.end ());
+        // Build the path
+        PathVectorPtr_t result = PathVector::create (path->outputSize(),
+            path->outputDerivativeSize ());
+        for (std::size_t s = 0; s < P; ++s) {
+          if (!changed [s] && !changed [s+1]) {
+            result->appendPath (path->pathAtRankNoCopy (s));
+            continue;
+          }
+          PathPtr_t segment = steer (newConfigs.segment (s * N, N),
+              newConfigs.segment ((s+1) * N, N));
+          if (!segment) return PathVectorPtr_t ();
+          result->appendPath (segment);
+        }
+        return result;
+      }
     } // namespace pathOptimization
   } // namespace core
 } // namespace hpp
@@ -16,6 +16,8 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <stdexcept>
+
 #include <hpp/fcl/collision_object.h>
 #include <hpp/fcl/distance.h>
 #include <hpp/fcl/collision.h>
@@ -23,6 +25,8 @@
 #include <hpp/util/timer.hh>
 
 #include <Eigen/SVD>
+#include <Eigen/Cholesky>
+#include <Eigen/LU>
 #include <Eigen/Dense>
 #include <hpp/util/debug.hh>
 #include <hpp/model/body.hh>
@@ -47,6 +51,7 @@
 #include <hpp/constraints/transformation.hh>
 #include <hpp/constraints/relative-transformation.hh>
 #include "path-optimization/collision-constraints-result.hh"
+#include "path-optimization/thread-problems.hh"
 
 namespace hpp {
   namespace core {
@@ -66,7 +71,8 @@ namespace hpp {
       }
 
       GradientBased::GradientBased (const Problem& problem) :
-	PathOptimizer (problem), cost_ (), robot_ (problem.robot ()),
+	PathOptimizer (problem), threadProblems_ (), userCost_ (), cost_ (),
+	robot_ (problem.robot ()),
 	configSize_ (robot_->configSize ()), robotNumberDofs_
 	(robot_->numberDof ()),	robotNbNonLockedDofs_ (robot_->numberDof ()),
 	fSize_ (1),
@@ -84,19 +90,19 @@ namespace hpp {
 	  (SteeringMethodStraight, problem.steeringMethod ()->copy ());
       }
 
-      void GradientBased::compressHessian (matrixIn_t normal, matrixOut_t small)
-	const
+      void GradientBased::compressHessian (const Blocks_t& normal,
+					   Blocks_t& small) const
       {
 	ConstraintSetPtr_t constraints (problem ().constraints ());
-	if (!constraints) return;
-	size_type normalSize = robotNumberDofs_;
+	if (!constraints) {
+	  small = normal;
+	  return;
+	}
 	size_type smallSize = constraints->numberNonLockedDof ();
-	for (size_type i=0; i<nbWaypoints_; ++i) {
-	  for (size_type j=0; j<nbWaypoints_; ++j) {
-	    constraints->compressMatrix
-	      (normal.block (i*normalSize, j*normalSize, normalSize,normalSize),
-	       small.block (i*smallSize, j*smallSize, smallSize, smallSize));
-	  }
+	small.resize (normal.size ());
+	for (std::size_t i=0; i<normal.size (); ++i) {
+	  small [i].resize (smallSize, smallSize);
+	  constraints->compressMatrix (normal [i], small [i]);
 	}
       }
 
@@ -140,10 +146,19 @@ namespace hpp {
 	hppDout (info, "nbWaypoints_ = " << nbWaypoints_);
 	if (nbWaypoints_ == 0) return;
 	/* Create cost */
-	if (!cost_ || cost_->inputSize () !=
-	    nbWaypoints_ * path->outputSize () ||
-	    cost_->inputDerivativeSize () !=
-	    nbWaypoints_ * path->outputDerivativeSize ())
+	if (userCost_) {
+	  if (userCost_->inputSize () != nbWaypoints_ * path->outputSize () ||
+	      userCost_->inputDerivativeSize () !=
+	      nbWaypoints_ * path->outputDerivativeSize ()) {
+	    throw std::invalid_argument
+	      ("Size of the cost does not match the way points of the path.");
+	  }
+	  cost_ = userCost_;
+	} else if (!HPP_DYNAMIC_PTR_CAST (PathLength, cost_) ||
+		   cost_->inputSize () !=
+		   nbWaypoints_ * path->outputSize () ||
+		   cost_->inputDerivativeSize () !=
+		   nbWaypoints_ * path->outputDerivativeSize ())
 	  {
 	    hppDout (info, "creating cost");
 	    cost_ = PathLength::create (distance_, path);
@@ -155,14 +170,30 @@ namespace hpp {
 	// Get problem constraints and locked degrees of freedom
 	initializeProblemConstraints ();
 
-	/* Create Hessian and inverse Hessian of cost */
-	matrix_t H;
-	H.resize (cost_->inputDerivativeSize (),
-		  cost_->inputDerivativeSize ());
-	cost_->hessian (H);
-	H_.resize (numberDofs_, numberDofs_);
+	/* Create Hessian of cost: it is block tridiagonal, only the blocks
+	   are stored, so that memory and computation time are linear in the
+	   number of way points. */
+	Blocks_t diagonal, lower;
+	PathLengthPtr_t pathLength (HPP_DYNAMIC_PTR_CAST (PathLength, cost_));
+	if (pathLength) {
+	  pathLength->hessian (diagonal, lower);
+	} else {
+	  // Blocks of the other costs are extracted from the dense Hessian,
+	  // the blocks out of the three diagonals are ignored.
+	  const size_type n = path->outputDerivativeSize ();
+	  matrix_t hessian (cost_->inputDerivativeSize (),
+			    cost_->inputDerivativeSize ());
+	  cost_->hessian (hessian);
+	  diagonal.resize (nbWaypoints_);
+	  lower.resize (nbWaypoints_ - 1);
+	  for (size_type i = 0; i < nbWaypoints_; ++i) {
+	    diagonal [i] = hessian.block (i * n, i * n, n, n);
+	    if (i > 0) lower [i-1] = hessian.block (i * n, (i-1) * n, n, n);
+	  }
+	}
 	rgrad_.resize (1, numberDofs_);
-	compressHessian (H, H_);
+	compressHessian (diagonal, Hdiagonal_);
+	compressHessian (lower, Hlower_);
 	/* Store first and last way points */
 	initial_ = path->initial ();
 	end_ = path->end ();
@@ -215,12 +246,15 @@ namespace hpp {
 
       vector_t GradientBased::computeIterate (vectorIn_t) const
       {
+	// Solving H x = grad^T costs O(n) for n way points.
+	matrix_t h (rgrad_.transpose ());
+	solveHessian (h);
 	if (J_.rows () == 0) {
 	  // no constraints
 	  //   grad (x)^T  = grad (x1)^T + H * (x-x1)
 	  // - grad (x1)^T = H * (x-x1)
 	  //      x-x1   = - Hinverse * grad (x1)^T
-	  vector_t result (-alpha_ * Hinverse_ * rgrad_.transpose ());
+	  vector_t result (-alpha_ * h);
 	  return result;
 	} else {
 	  // cost
@@ -231,78 +265,178 @@ namespace hpp {
 	  // linearized
 	  // f (x) = f (x1) + J p = rhs
 	  // J p = rhs - f (x1)
-	  // svd (J) -> V0
-	  // p = p0 + V0 z
-	  // with p0 = J^{+} (rhs - f(x1))
-	  // C (x) = C (x1) + grad (x1) * (p0 + V0 z)
-	  //         + 1/2 (p0 + V0 z)^T H (p0 + V0 z)
-	  // C (x) = (grad (x1) + p0^T H) V0 z  + 1/2 z^T V0^T H V0 z + C (x1)
-	  // z = - (V0^T H V0)^{-1} V0^T(grad (x1)^T + H p0)
-	  Jacobi_t svd (J_, Eigen::ComputeThinU | Eigen::ComputeFullV);
-	  size_type rank = svd.rank();
-	  hppDout (info, "J_ singular values = " <<
-		   svd.singularValues ().transpose ());
+	  // Lagrange multipliers mu
+	  // grad (x1)^T + H p + J^T mu = 0
+	  // p = - H^{-1} (grad (x1)^T + J^T mu)
+	  // J H^{-1} J^T mu = - (rhs - f (x1) + J H^{-1} grad (x1)^T)
+	  // J H^{-1} J^T is invertible if and only if J is full rank.
+	  matrix_t X (J_.transpose ());
+	  solveHessian (X);
+	  matrix_t S (J_ * X);
+	  Eigen::FullPivLU <matrix_t> lu (S);
+	  size_type rank = lu.rank ();
 	  hppDout (info, "Jrows = " << J_.rows ());
 	  hppDout (info, "rank(J) = " << rank);
 	  if (rank < J_.rows ()) {
 	    p_.setZero ();
 	    return p_;
 	  }
-	  V0_ = svd.matrixV ().rightCols (numberDofs_-rank);
 	  hppDout (info, "rhs_ - value_ = " << rhs_ - value_);
-	  p0_ = svd.solve (rhs_ - value_);
-	  if (V0_.cols () != 0) {
-	    Hz_ = V0_.transpose () * H_ * V0_;
-	    gz_ = - V0_.transpose () * (rgrad_.transpose () + H_ * p0_);
-	    Jacobi_t svd2 (Hz_, Eigen::ComputeThinU | Eigen::ComputeFullV);
-	    rank = svd2.rank ();
-	    hppDout (info, "Hz_ singular values = " <<
-		     svd2.singularValues ().transpose ());
-	    hppDout (info, "rank(Hz_) = " << rank);
-	    vector_t z (svd2.solve (gz_));
-	    hppDout (info, "Hz_ * z - gz_=" << (Hz_ * z - gz_).transpose ());
-	    p_ = p0_ + V0_ * svd2.solve (gz_);
-	    hppDout (info, "constraint satisfaction: " <<
-		     (J_*p_ - (rhs_ - value_)).squaredNorm ());
-	    hppDout (info, "norm(grad*V0)? = " <<
-		     ((rgrad_ + (H_*p_).transpose ())*V0_).squaredNorm ());
-	  } else {
-	    p_ = p0_;
-	  }
+	  vector_t mu (-lu.solve (rhs_ - value_ + J_ * h));
+	  p_ = -h - X * mu;
+	  hppDout (info, "constraint satisfaction: " <<
+		   (J_*p_ - (rhs_ - value_)).squaredNorm ());
 	  return alpha_*p_;
 	}
       }
 
-      typedef std::vector <std::pair <CollisionPathValidationReportPtr_t,
-				      std::size_t> > Reports_t;
+      void GradientBased::factorizeHessian () const
+      {
+	const std::size_t n = Hdiagonal_.size ();
+	Ldiagonal_.resize (n);
+	Llower_.resize (n - 1);
+	matrix_t D (Hdiagonal_ [0]);
+	for (std::size_t i = 0; i < n; ++i) {
+	  if (i > 0) {
+	    // L_{i,i-1} = H_{i,i-1} L_{i-1,i-1}^{-T}
+	    Llower_ [i-1] = Ldiagonal_ [i-1].triangularView <Eigen::Lower> ()
+	      .solve (Hlower_ [i-1].transpose ()).transpose ();
+	    D = Hdiagonal_ [i] - Llower_ [i-1] * Llower_ [i-1].transpose ();
+	  }
+	  Eigen::LLT <matrix_t> llt (D);
+	  if (llt.info () != Eigen::Success) {
+	    throw std::runtime_error
+	      ("Hessian of the cost is not positive definite.");
+	  }
+	  Ldiagonal_ [i] = llt.matrixL ();
+	}
+      }
+
+      void GradientBased::solveHessian (matrixOut_t x) const
+      {
+	const std::size_t n = Ldiagonal_.size ();
+	const size_type m = robotNbNonLockedDofs_;
+	assert (x.rows () == (size_type) n * m);
+	// Forward substitution: L y = b
+	for (std::size_t i = 0; i < n; ++i) {
+	  if (i > 0) {
+	    x.middleRows (i*m, m) -= Llower_ [i-1] * x.middleRows ((i-1)*m, m);
+	  }
+	  Ldiagonal_ [i].triangularView <Eigen::Lower> ().solveInPlace
+	    (x.middleRows (i*m, m));
+	}
+	// Backward substitution: L^T x = y
+	for (std::size_t i = n; i-- > 0;) {
+	  if (i+1 < n) {
+	    x.middleRows (i*m, m) -=
+	      Llower_ [i].transpose () * x.middleRows ((i+1)*m, m);
+	  }
+	  Ldiagonal_ [i].triangularView <Eigen::Lower> ().transpose ()
+	    .solveInPlace (x.middleRows (i*m, m));
+	}
+      }
+
+      typedef std::vector <CollisionConstraintsResultPtr_t>
+      CollisionConstraintsResultPtrs_t;
+
+      // Validate the elements of rank thread, thread + nbThreads, ... of a
+      // path with the objects of a problem
+      struct ValidateElements
+      {
+	typedef void result_type;
+	const PathVectorPtr_t* path;
+	std::vector <PathValidationReportPtr_t>* reports;
+
+	void operator() (const Problem* problem, std::size_t thread,
+			 std::size_t nbThreads, bool copy, std::string* error)
+	  const
+	{
+	  try {
+	    PathVectorPtr_t p (copy ? steerElements (*problem, *path) : *path);
+	    PathValidationPtr_t pathValidation (problem->pathValidation ());
+	    PathPtr_t validPart;
+	    for (std::size_t i = thread; i < p->numberPaths ();
+		 i += nbThreads) {
+	      PathValidationReportPtr_t report;
+	      if (!pathValidation->validate
+		  (p->pathAtRank (i), false, validPart, report)) {
+		(*reports) [i] = report;
+	      }
+	    }
+	  } catch (const std::exception& exc) {
+	    *error = exc.what ();
+	  }
+	}
+      }; // struct ValidateElements
+
+      // Create and linearize the collision constraints of the elements
+      // validated by ValidateElements with the same arguments: reports
+      // refer to the collision objects of the robot of the problem.
+      struct ComputeCollisionConstraints
+      {
+	typedef void result_type;
+	const PathVectorPtr_t* path0;
+	const PathVectorPtr_t* path1;
+	const Reports_t* reports;
+	size_type firstRow;
+	size_type nbNonLockedDofs;
+	CollisionConstraintsResultPtrs_t* results;
+	matrix_t* jacobian;
+	vector_t* value;
+
+	void operator() (const Problem* problem, std::size_t thread,
+			 std::size_t nbThreads, bool copy, std::string* error)
+	  const
+	{
+	  try {
+	    PathVectorPtr_t p0 (copy ? steerElements (*problem, *path0) :
+				*path0);
+	    PathVectorPtr_t p1 (copy ? steerElements (*problem, *path1) :
+				*path1);
+	    const size_type fSize = CollisionConstraintsResult::fSize_;
+	    for (std::size_t k = 0; k < reports->size (); ++k) {
+	      if ((*reports) [k].second % nbThreads != thread) continue;
+	      (*results) [k] = CollisionConstraintsResultPtr_t
+		(new CollisionConstraintsResult
+		 (problem->robot (), p0, p1, (*reports) [k],
+		  firstRow + (size_type) k * fSize, nbNonLockedDofs));
+	      (*results) [k]->linearize (p0, *jacobian, *value);
+	    }
+	  } catch (const std::exception& exc) {
+	    *error = exc.what ();
+	  }
+	}
+      }; // struct ComputeCollisionConstraints
 
-      bool validatePath (const PathValidationPtr_t& pathValidation,
+      bool validatePath (const Problem& problem,
+			 const std::vector <const Problem*>& threadProblems,
 			 const PathVectorPtr_t& path, Reports_t& reports)
       {
-	bool valid = true;
-	PathPtr_t validPart;
-	PathValidationReportPtr_t report;
+	std::vector <PathValidationReportPtr_t> elementReports
+	  (path->numberPaths ());
+	ValidateElements f;
+	f.path = &path;
+	f.reports = &elementReports;
+	runThreads (problem, threadProblems, f);
 	reports.clear ();
-	for (std::size_t i=0; i<path->numberPaths (); ++i) {
-	  if (!pathValidation->validate
-	      (path->pathAtRank (i), false, validPart, report)) {
+	for (std::size_t i=0; i<elementReports.size (); ++i) {
+	  const PathValidationReportPtr_t& report (elementReports [i]);
+	  if (report) {
 	    HPP_STATIC_CAST_REF_CHECK (CollisionPathValidationReport, *report);
 	    reports.push_back
 	      (std::make_pair (HPP_STATIC_PTR_CAST
 			       (CollisionPathValidationReport, report), i));
-	    valid = false;
 	  }
 	}
-	return valid;
+	return reports.empty ();
       }
 
       PathVectorPtr_t GradientBased::optimize (const PathVectorPtr_t& path)
       {
-	interrupt_ = false;
+	startOptimization ();
 	initialize (path);
 	if (nbWaypoints_ == 0) // path is direct and optimal
 	  return path;
-	PathValidationPtr_t pathValidation (problem ().pathValidation ());
 	PathVectorPtr_t result = PathVector::create (configSize_,
 						     robotNumberDofs_);
 	ConstraintSetPtr_t constraints (problem ().constraints ());
@@ -313,10 +447,10 @@ namespace hpp {
 	/* Create initial path */
 	vector_t x1; x1.resize (cost_->inputSize ());
 	rowvector_t grad; grad.resize (cost_->inputDerivativeSize ());
+	vector_t cost (cost_->outputSize ());
 	pathToVector (path, x1);
 	vector_t x0 = x1;
-	Hinverse_ = H_.inverse ();
-	hppDout (info, "Hessian = " << H_);
+	factorizeHessian ();
 
 	/* Fill jacobian J_ and Jf_ with constraints FROM Problem */
 	cost_->jacobian (grad, x1);
@@ -345,35 +479,31 @@ namespace hpp {
 	    hppDout (info, "x1=" << x1.transpose ());
             if (!applyConstraints (x1)) {
               alpha_ /= 2;
+              iterationDone ();
               HPP_STOP_TIMECOUNTER(GBO_oneStep);
               continue;
             }
 	    PathVectorPtr_t path1 = PathVector::create (configSize_,
 							robotNumberDofs_);
 	    vectorToPath (x1, path1);
-	    bool isPathValid = validatePath (pathValidation, path1, reports);
+	    bool isPathValid = validatePath (problem (), threadProblems_,
+					     path1, reports);
 	    // if new path is in collision, we add some constraints
 	    if (!isPathValid) {
 	      if (alpha_ != 1.) {
-		for (Reports_t::const_iterator it = reports.begin ();
-		     it != reports.end (); ++it) {
-		  CollisionConstraintsResult ccr (robot_, path0, path1,
-						  *it, J_.rows (),
-						  robotNbNonLockedDofs_);
-		  // Compute J_
-		  addCollisionConstraint (ccr, path0);
-		  collisionConstraints.push_back (ccr);
-		  hppDout (info, "Number of collision constraints: "
-			   << collisionConstraints.size ());
-		  // When adding a new constraint, try first minimum under this
-		  // constraint. If this latter minimum is in collision,
-		  // re-initialize alpha_ to alphaInit_.
-		  alpha_ = 1.;
-		}
+		addCollisionConstraints (path0, path1, reports,
+					 collisionConstraints);
+		hppDout (info, "Number of collision constraints: "
+			 << collisionConstraints.size ());
+		// When adding a new constraint, try first minimum under this
+		// constraint. If this latter minimum is in collision,
+		// re-initialize alpha_ to alphaInit_.
+		alpha_ = 1.;
 	      } else {
 		alpha_ = alphaInit_;
 	      }
 	      noCollision = false;
+	      iterationDone ();
 	    } else { // path valid
 	      rowvector_t rgrad0 (rgrad_);
 	      x0 = x1;
@@ -381,10 +511,12 @@ namespace hpp {
 	      cost_->jacobian (grad, x0);
 	      compressVector (grad.transpose (), rgrad_.transpose ());
 	      noCollision = true;
+	      (*cost_) (cost, x0);
+	      iterationDone (cost [0]);
 	    }
             HPP_STOP_TIMECOUNTER(GBO_oneStep);
             HPP_DISPLAY_TIMECOUNTER(GBO_oneStep);
-	  } while (!(noCollision && minimumReached) && (!interrupt_));
+	  } while (!(noCollision && minimumReached) && (!stopOptimization ()));
 	} // while (!minimumReached)
 	return path0;
       }
@@ -531,18 +663,34 @@ namespace hpp {
 	return true;
       }
 
-      void GradientBased::addCollisionConstraint
-	(const CollisionConstraintsResult& ccr, const PathVectorPtr_t& path)
-	const
+      void GradientBased::addCollisionConstraints
+      (const PathVectorPtr_t& path0, const PathVectorPtr_t& path1,
+       const Reports_t& reports,
+       CollisionConstraintsResults_t& collisionConstraints) const
       {
-	size_type Jrows = J_.rows ();
-	J_.conservativeResize (Jrows + fSize_, J_.cols ());
-	J_.middleRows (ccr.rowInJacobian (), fSize_).setZero ();
-	value_.conservativeResize (Jrows + fSize_);
-	value_.segment (ccr.rowInJacobian (), fSize_).setZero ();
-	rhs_.conservativeResize (Jrows + fSize_);
-	rhs_ [ccr.rowInJacobian ()] = 0;
-	ccr.linearize (path, J_, value_);
+	const size_type Jrows = J_.rows ();
+	const size_type rows = (size_type) reports.size () * fSize_;
+	J_.conservativeResize (Jrows + rows, J_.cols ());
+	J_.bottomRows (rows).setZero ();
+	value_.conservativeResize (Jrows + rows);
+	value_.tail (rows).setZero ();
+	rhs_.conservativeResize (Jrows + rows);
+	rhs_.tail (rows).setZero ();
+	// Each thread writes in the rows of its constraints only.
+	CollisionConstraintsResultPtrs_t results (reports.size ());
+	ComputeCollisionConstraints f;
+	f.path0 = &path0;
+	f.path1 = &path1;
+	f.reports = &reports;
+	f.firstRow = Jrows;
+	f.nbNonLockedDofs = robotNbNonLockedDofs_;
+	f.results = &results;
+	f.jacobian = &J_;
+	f.value = &value_;
+	runThreads (problem (), threadProblems_, f);
+	for (std::size_t k = 0; k < results.size (); ++k) {
+	  collisionConstraints.push_back (*results [k]);
+	}
       }
 
       void GradientBased::updateRightHandSide
@@ -0,0 +1,236 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_PATH_OPTIMIZATION_HERMITE_PATH_HH
+# define HPP_CORE_PATH_OPTIMIZATION_HERMITE_PATH_HH
+
+# include <algorithm>
+# include <cmath>
+# include <hpp/model/configuration.hh>
+# include <hpp/model/device.hh>
+# include <hpp/model/joint.hh>
+# include <hpp/core/path.hh>
+# include "memory-usage.hh"
+
+namespace hpp {
+  namespace core {
+    namespace pathOptimization {
+      HPP_PREDEF_CLASS (HermitePath);
+      typedef boost::shared_ptr <HermitePath> HermitePathPtr_t;
+
+      /// Cubic Hermite interpolation between two configurations
+      ///
+      /// The configuration at parameter s is initial integrated by
+      /// v (s), where v is the cubic polynomial such that
+      /// \li v (0) = 0 and v (length) = end - initial,
+      /// \li v' (0) and v' (length) are the given tangents.
+      class HermitePath : public Path
+      {
+      public:
+	typedef Path parent_t;
+
+	virtual ~HermitePath () throw () {}
+
+	/// Create instance and return shared pointer
+	/// \param device robot corresponding to configurations,
+	/// \param init, end configurations at the ends of the path,
+	/// \param tangent0, tangent1 derivatives of v at the ends of the path,
+	/// \param length length of the interval of definition,
+	/// \param constraints the path is subject to.
+	static HermitePathPtr_t create
+	  (const DevicePtr_t& device, ConfigurationIn_t init,
+	   ConfigurationIn_t end, vectorIn_t tangent0, vectorIn_t tangent1,
+	   value_type length, const ConstraintSetPtr_t& constraints)
+	{
+	  HermitePath* ptr = new HermitePath (device, init, end, tangent0,
+					      tangent1, length, constraints);
+	  HermitePathPtr_t shPtr (ptr);
+	  ptr->init (shPtr);
+	  return shPtr;
+	}
+
+	static HermitePathPtr_t createCopy (const HermitePathPtr_t& path)
+	{
+	  HermitePath* ptr = new HermitePath (*path);
+	  HermitePathPtr_t shPtr (ptr);
+	  ptr->init (shPtr);
+	  return shPtr;
+	}
+
+	static HermitePathPtr_t createCopy
+	  (const HermitePathPtr_t& path, const ConstraintSetPtr_t& constraints)
+	{
+	  HermitePath* ptr = new HermitePath (*path, constraints);
+	  HermitePathPtr_t shPtr (ptr);
+	  ptr->init (shPtr);
+	  return shPtr;
+	}
+
+	virtual PathPtr_t copy () const
+	{
+	  return createCopy (weak_.lock ());
+	}
+
+	virtual PathPtr_t copy (const ConstraintSetPtr_t& constraints) const
+	{
+	  return createCopy (weak_.lock (), constraints);
+	}
+
+	virtual bool impl_compute (ConfigurationOut_t result,
+				   value_type param) const
+	{
+	  const value_type T = timeRange ().second;
+	  if (param == timeRange ().first || T == 0) {
+	    result = initial_;
+	    return true;
+	  }
+	  if (param == T) {
+	    result = end_;
+	    return true;
+	  }
+	  const value_type u = param / T;
+	  const value_type u2 = u * u;
+	  const value_type u3 = u2 * u;
+	  // Not stored in the instance: paths are shared between threads.
+	  vector_t v ((u3 - 2 * u2 + u) * T * tangent0_ +
+		      (-2 * u3 + 3 * u2) * delta_ + (u3 - u2) * T * tangent1_);
+	  model::integrate (device_, initial_, v, result);
+	  return true;
+	}
+
+	virtual Configuration_t initial () const
+	{
+	  return initial_;
+	}
+
+	virtual Configuration_t end () const
+	{
+	  return end_;
+	}
+
+      protected:
+	/// Upper bounds of the derivative of v, for each degree of freedom
+	///
+	/// For SO(3) joints, the velocity of the configuration differs from
+	/// the derivative of v by a Jacobian the norm of which is smaller
+	/// than 1: the bounds of the three degrees of freedom are replaced by
+	/// their norm.
+	virtual bool impl_velocityBound (vectorOut_t result, value_type t0,
+					 value_type t1) const
+	{
+	  const value_type T = timeRange ().second;
+	  if (T == 0) {
+	    result.setZero ();
+	    return true;
+	  }
+	  // v' (u T) = a u^2 + b u + c
+	  const value_type u0 = t0 / T, u1 = t1 / T;
+	  for (size_type i = 0; i < result.size (); ++i) {
+	    const value_type a = 3 * (tangent0_ [i] + tangent1_ [i]) -
+	      6 * delta_ [i] / T;
+	    const value_type b = -4 * tangent0_ [i] - 2 * tangent1_ [i] +
+	      6 * delta_ [i] / T;
+	    const value_type c = tangent0_ [i];
+	    value_type bound = std::max (fabs ((a * u0 + b) * u0 + c),
+					 fabs ((a * u1 + b) * u1 + c));
+	    if (a != 0) {
+	      const value_type u = -b / (2 * a);
+	      if (u0 < u && u < u1) {
+		bound = std::max (bound, fabs ((a * u + b) * u + c));
+	      }
+	    }
+	    result [i] = bound;
+	  }
+	  const JointVector_t& jv (device_->getJointVector ());
+	  for (JointVector_t::const_iterator itJoint = jv.begin ();
+	       itJoint != jv.end (); ++itJoint) {
+	    if (dynamic_cast <model::JointSO3*> (*itJoint)) {
+	      size_type rank = (*itJoint)->rankInVelocity ();
+	      result.segment (rank, 3).setConstant
+		(result.segment (rank, 3).norm ());
+	    }
+	  }
+	  return true;
+	}
+
+	virtual std::size_t impl_memoryUsage () const
+	{
+	  return sizeof (HermitePath) + memory::bytes (initial_) +
+	    memory::bytes (end_) + memory::bytes (delta_) +
+	    memory::bytes (tangent0_) + memory::bytes (tangent1_);
+	}
+
+	virtual std::ostream& print (std::ostream &os) const
+	{
+	  os << "HermitePath:" << std::endl;
+	  os << "interval: [ " << timeRange ().first << ", "
+	     << timeRange ().second << " ]" << std::endl;
+	  os << "initial configuration: " << initial_.transpose () << std::endl;
+	  os << "final configuration:   " << end_.transpose () << std::endl;
+	  return os;
+	}
+
+	HermitePath (const DevicePtr_t& device, ConfigurationIn_t init,
+		     ConfigurationIn_t end, vectorIn_t tangent0,
+		     vectorIn_t tangent1, value_type length,
+		     const ConstraintSetPtr_t& constraints) :
+	  parent_t (interval_t (0, length), device->configSize (),
+		    device->numberDof (), constraints),
+	  device_ (device), initial_ (init), end_ (end),
+	  delta_ (device->numberDof ()), tangent0_ (tangent0),
+	  tangent1_ (tangent1), weak_ ()
+	{
+	  assert (length >= 0);
+	  model::difference (device_, end_, initial_, delta_);
+	}
+
+	HermitePath (const HermitePath& path) :
+	  parent_t (path), device_ (path.device_), initial_ (path.initial_),
+	  end_ (path.end_), delta_ (path.delta_), tangent0_ (path.tangent0_),
+	  tangent1_ (path.tangent1_), weak_ ()
+	{
+	}
+
+	HermitePath (const HermitePath& path,
+		     const ConstraintSetPtr_t& constraints) :
+	  parent_t (path, constraints), device_ (path.device_),
+	  initial_ (path.initial_), end_ (path.end_), delta_ (path.delta_),
+	  tangent0_ (path.tangent0_), tangent1_ (path.tangent1_), weak_ ()
+	{
+	}
+
+	void init (const HermitePathPtr_t& self)
+	{
+	  parent_t::init (self);
+	  weak_ = self;
+	}
+
+      private:
+	DevicePtr_t device_;
+	Configuration_t initial_;
+	Configuration_t end_;
+	/// end - initial
+	vector_t delta_;
+	vector_t tangent0_;
+	vector_t tangent1_;
+	HermitePathWkPtr_t weak_;
+      }; // class HermitePath
+    } // namespace pathOptimization
+  } // namespace core
+} // namespace hpp
+#endif // HPP_CORE_PATH_OPTIMIZATION_HERMITE_PATH_HH
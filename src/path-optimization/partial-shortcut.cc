@@ -20,6 +20,8 @@
 // #include <deque>
 // #include <cstdlib>
 // #include <hpp/util/assertion.hh>
+#include <algorithm>
+#include <limits>
 #include <hpp/util/debug.hh>
 #include <hpp/model/joint.hh>
 #include <hpp/model/joint-configuration.hh>
@@ -29,7 +31,10 @@
 #include <hpp/core/path-vector.hh>
 #include <hpp/core/problem.hh>
 #include <hpp/core/config-projector.hh>
+#include <hpp/core/constraint-set.hh>
 #include <hpp/core/locked-joint.hh>
+#include <hpp/core/steering-method.hh>
+#include "path-optimization/thread-problems.hh"
 
 namespace hpp {
   namespace core {
@@ -52,11 +57,180 @@ namespace hpp {
         {
           value_type result = 0;
           for (std::size_t i=0; i<path->numberPaths (); ++i) {
-            const PathPtr_t& element (path->pathAtRank (i));
+            const PathPtr_t& element (path->pathAtRankNoCopy (i));
             result += (*distance) (element->initial (), element->end ());
           }
           return result;
         }
+
+        // Append a path to a vector, flattening it if it is a vector
+        void appendFlat (const PathVectorPtr_t& out, const PathPtr_t& path)
+        {
+          PathVectorPtr_t pv = HPP_DYNAMIC_PTR_CAST (PathVector, path);
+          if (pv) pv->flatten (out);
+          else    out->appendPath (path);
+        }
+
+        // Interpolate the configuration of a joint between (t1, q1) and
+        // (t2, q2), keeping the other joints as in path.
+        // The elements of path are not copied unless the constraints of
+        // path need to be applied to them, and the result is flattened
+        // while it is built.
+        PathVectorPtr_t generatePath (const Problem& problem,
+            PathVectorPtr_t path, const JointPtr_t joint,
+            const value_type t1, ConfigurationIn_t q1,
+            const value_type t2, ConfigurationIn_t q2)
+        {
+          value_type lt1, lt2;
+          std::size_t rkAtP1 = path->rankAtParam (t1, lt1);
+          std::size_t rkAtP2 = path->rankAtParam (t2, lt2);
+          if (rkAtP2 == rkAtP1) return PathVectorPtr_t ();
+
+          PathVectorPtr_t out = PathVector::create (
+              path->outputSize (), path->outputDerivativeSize ());
+          PathPtr_t last;
+          const bool copy = path->constraints ();
+
+          std::size_t rkCfg = joint->rankInConfiguration ();
+          Configuration_t qi = q1;
+          Configuration_t q_inter (path->outputSize ());
+          value_type t = - lt1;
+          for (std::size_t i = rkAtP1; i < rkAtP2; ++i) {
+            const PathPtr_t local (copy ? path->pathAtRank (i) :
+                path->pathAtRankNoCopy (i));
+            t += local->timeRange().second;
+            q_inter = local->end (),
+            joint->configuration()->interpolate ( q1, q2,
+                t / (t2-t1), rkCfg, q_inter);
+            const ConstraintSetPtr_t& constraints (local->constraints ());
+            if (constraints) {
+              if (!constraints->apply (q_inter)) {
+                hppDout (warning, "PartialShortcut could not apply "
+                    "the constraints");
+                return PathVectorPtr_t ();
+              }
+            }
+            last = steer (problem, qi, q_inter);
+            if (!last) return PathVectorPtr_t ();
+            appendFlat (out, last);
+            qi = q_inter;
+          }
+          last = steer (problem, qi, q2);
+          if (!last) return PathVectorPtr_t ();
+          appendFlat (out, last);
+          return out;
+        }
+
+        bool isValid (const Problem& problem, const PathVectorPtr_t& path)
+        {
+          if (!path) return false;
+          PathPtr_t validPart;
+          PathValidationReportPtr_t report;
+          return problem.pathValidation ()->validate
+            (path, false, validPart, report);
+        }
+
+        // Get the joint of the robot of a problem with the same name
+        JointPtr_t threadJoint (const Problem& problem, bool copy,
+            const JointPtr_t& joint)
+        {
+          if (!copy) return joint;
+          return problem.robot ()->getJointByName (joint->name ());
+        }
+
+        // Try a full shortcut on joints of rank thread, thread + nbThreads,
+        // ... with the objects of a problem
+        struct FullShortcuts
+        {
+          typedef void result_type;
+          const PathVectorPtr_t* path;
+          const JointVector_t* joints;
+          std::vector <value_type>* lengths;
+
+          void operator() (const Problem* problem, std::size_t thread,
+              std::size_t nbThreads, bool copy, std::string* error) const
+          {
+            try {
+              PathVectorPtr_t p (copy ? steerElements (*problem, *path) :
+                  *path);
+              const value_type t3 = p->timeRange ().second;
+              for (std::size_t k = thread; k < joints->size ();
+                  k += nbThreads) {
+                JointPtr_t joint (threadJoint (*problem, copy,
+                      (*joints) [k]));
+                PathVectorPtr_t straight = generatePath (*problem, p, joint,
+                    0, p->initial (), t3, p->end ());
+                (*lengths) [k] = isValid (*problem, straight) ?
+                  pathLength (straight, problem->distance ()) :
+                  std::numeric_limits <value_type>::infinity ();
+              }
+            } catch (const std::exception& exc) {
+              *error = exc.what ();
+            }
+          }
+        }; // struct FullShortcuts
+
+        // Random partial shortcut on one joint
+        struct Candidate
+        {
+          value_type t1, t2;
+          bool valid [3];
+          // Length of the path obtained with the valid parts
+          value_type length;
+        }; // struct Candidate
+        typedef std::vector <Candidate> Candidates_t;
+
+        // Evaluate the candidates of rank thread, thread + nbThreads, ...
+        // with the objects of a problem. Candidate k is a shortcut on
+        // joint k.
+        struct RandomShortcuts
+        {
+          typedef void result_type;
+          const PathVectorPtr_t* path;
+          const JointVector_t* joints;
+          Candidates_t* candidates;
+
+          void operator() (const Problem* problem, std::size_t thread,
+              std::size_t nbThreads, bool copy, std::string* error) const
+          {
+            try {
+              PathVectorPtr_t p (copy ? steerElements (*problem, *path) :
+                  *path);
+              const value_type t3 = p->timeRange ().second;
+              Configuration_t q1 (p->outputSize ()), q2 (p->outputSize ());
+              for (std::size_t k = thread; k < joints->size ();
+                  k += nbThreads) {
+                Candidate& c ((*candidates) [k]);
+                c.length = std::numeric_limits <value_type>::infinity ();
+                c.valid [0] = c.valid [1] = c.valid [2] = false;
+                if (!(*p) (q1, c.t1) || !(*p) (q2, c.t2)) continue;
+                JointPtr_t joint (threadJoint (*problem, copy,
+                      (*joints) [k]));
+                const value_type times [4] = { 0, c.t1, c.t2, t3 };
+                const Configuration_t configs [4] =
+                  { p->initial (), q1, q2, p->end () };
+                PathVectorPtr_t parts [3];
+                for (unsigned i=0; i<3; ++i) {
+                  PathVectorPtr_t straight = generatePath (*problem, p, joint,
+                      times [i], configs [i], times [i+1], configs [i+1]);
+                  c.valid [i] = isValid (*problem, straight);
+                  if (c.valid [i]) parts [i] = straight;
+                  else {
+                    parts [i] = p->extract (std::make_pair
+                        (times [i], times [i+1]))->as <PathVector> ();
+                  }
+                }
+                if (!c.valid [0] && !c.valid [1] && !c.valid [2]) continue;
+                c.length = 0;
+                for (unsigned i=0; i<3; ++i) {
+                  c.length += pathLength (parts [i], problem->distance ());
+                }
+              }
+            } catch (const std::exception& exc) {
+              *error = exc.what ();
+            }
+          }
+        }; // struct RandomShortcuts
       }
 
       PartialShortcut::Parameters::Parameters () :
@@ -70,12 +244,20 @@ namespace hpp {
       }
 
       PartialShortcut::PartialShortcut (const Problem& problem) :
-        PathOptimizer (problem)
+        PathOptimizer (problem), threadProblems_ (),
+        generator_ (problem.drawSeed ())
       {
       }
 
+      value_type PartialShortcut::uniform ()
+      {
+        // 32 random bits are enough for sampling.
+        return (value_type) generator_ () / 4294967296.;
+      }
+
       PathVectorPtr_t PartialShortcut::optimize (const PathVectorPtr_t& path)
       {
+        startOptimization ();
         PathVectorPtr_t unpacked = PathVector::create (path->outputSize(),
             path->outputDerivativeSize ());
         unpack (path, unpacked);
@@ -85,55 +267,14 @@ namespace hpp {
         JointVector_t jv;
 
         /// Step 2: First try to optimize each joint from beginning to end
-        PathVectorPtr_t result = optimizeFullPath (unpacked, straight_jv, jv);
-        if (parameters.onlyFullShortcut) return result;
+        PathVectorPtr_t result = threadProblems_.empty () ?
+          optimizeFullPath (unpacked, straight_jv, jv) :
+          optimizeFullPathInParallel (unpacked, straight_jv, jv);
+        if (parameters.onlyFullShortcut || jv.empty ()) return result;
 
         /// Step 3: Optimize randomly each joint
-        return optimizeRandom (result, jv);
-      }
-
-      PathVectorPtr_t PartialShortcut::generatePath (
-          PathVectorPtr_t path, const JointPtr_t joint,
-          const value_type t1, ConfigurationIn_t q1,
-          const value_type t2, ConfigurationIn_t q2) const
-      {
-        value_type lt1, lt2;
-        std::size_t rkAtP1 = path->rankAtParam (t1, lt1);
-        std::size_t rkAtP2 = path->rankAtParam (t2, lt2);
-        if (rkAtP2 == rkAtP1) return PathVectorPtr_t ();
-
-        PathVectorPtr_t pv = PathVector::create (
-            path->outputSize (), path->outputDerivativeSize ());
-        PathPtr_t last;
-
-        std::size_t rkCfg = joint->rankInConfiguration ();
-        Configuration_t qi = q1;
-        Configuration_t q_inter (path->outputSize ());
-        value_type t = - lt1;
-        for (std::size_t i = rkAtP1; i < rkAtP2; ++i) {
-          t += path->pathAtRank (i)->timeRange().second;
-          q_inter = path->pathAtRank (i)->end (),
-          joint->configuration()->interpolate ( q1, q2,
-              t / (t2-t1), rkCfg, q_inter);
-          if (path->pathAtRank (i)->constraints ()) {
-            if (!path->pathAtRank (i)->constraints ()->apply (q_inter)) {
-              hppDout (warning, "PartialShortcut could not apply "
-                  "the constraints");
-              return PathVectorPtr_t ();
-            }
-          }
-          last = (steer) (qi, q_inter);
-          if (!last) return PathVectorPtr_t ();
-          pv->appendPath (last);
-          qi = q_inter;
-        }
-        last = steer (qi, q2);
-        if (!last) return PathVectorPtr_t ();
-        pv->appendPath (last);
-        PathVectorPtr_t out = PathVector::create (
-            path->outputSize (), path->outputDerivativeSize ());
-        pv->flatten (out);
-        return out;
+        if (threadProblems_.empty ()) return optimizeRandom (result, jv);
+        return optimizeRandomInParallel (result, jv);
       }
 
       JointVector_t PartialShortcut::generateJointVector
@@ -184,7 +325,7 @@ namespace hpp {
           // Validate sub parts
           bool valid;
           PathVectorPtr_t straight;
-          straight = generatePath (opted, joint, t0, q0, t3, q3);
+          straight = generatePath (problem (), opted, joint, t0, q0, t3, q3);
           {
             PathPtr_t validPart;
             PathValidationReportPtr_t report;
@@ -207,7 +348,7 @@ namespace hpp {
       }
 
       PathVectorPtr_t PartialShortcut::optimizeRandom (
-          const PathVectorPtr_t& pv, const JointVector_t& jv) const
+          const PathVectorPtr_t& pv, const JointVector_t& jv)
       {
         PathVectorPtr_t current = pv,
                         result = pv;
@@ -226,14 +367,14 @@ namespace hpp {
         std::size_t nbFail = 0;
         std::size_t iJ = 0;
         Configuration_t q1 (pv->outputSize ()), q2 (pv->outputSize ());
-        while (nbFail < maxFailure) {
+        while (nbFail < maxFailure && !stopOptimization ()) {
           iJ %= jv.size();
           JointPtr_t joint = jv[iJ];
           ++iJ;
 
           t3 = current->timeRange ().second;
-          value_type u2 = t3 * rand ()/RAND_MAX;
-          value_type u1 = t3 * rand ()/RAND_MAX;
+          value_type u2 = t3 * uniform ();
+          value_type u1 = t3 * uniform ();
 
           value_type t1, t2;
           if (u1 < u2) {t1 = u1; t2 = u2;} else {t1 = u2; t2 = u1;}
@@ -244,14 +385,18 @@ namespace hpp {
             hppDout (warning, "The constraints could not be applied to the "
                 "current path");
             nbFail++;
+            iterationDone ();
             continue;
           }
           // Validate sub parts
           bool valid [3];
           PathVectorPtr_t straight [3];
-          straight [0] = generatePath (current, joint, t0, q0, t1, q1);
-          straight [1] = generatePath (current, joint, t1, q1, t2, q2);
-          straight [2] = generatePath (current, joint, t2, q2, t3, q3);
+          straight [0] = generatePath (problem (), current, joint,
+              t0, q0, t1, q1);
+          straight [1] = generatePath (problem (), current, joint,
+              t1, q1, t2, q2);
+          straight [2] = generatePath (problem (), current, joint,
+              t2, q2, t3, q3);
           for (unsigned i=0; i<3; ++i) {
             PathPtr_t validPart;
             PathValidationReportPtr_t report;
@@ -263,30 +408,32 @@ namespace hpp {
           }
           if (!valid[0] && !valid[1] && !valid[2]) {
             nbFail++;
+            iterationDone ();
             continue;
           }
           // Replace valid parts
           result = PathVector::create (pv->outputSize (),
               pv->outputDerivativeSize ());
           if (valid [0])
-            result->concatenate (*straight [0]);
+            result->concatenate (straight [0]);
           else
-            result->concatenate (*(current->extract
-                  (std::make_pair (t0, t1))-> as <PathVector> ()));
+            result->concatenate (current->extract
+                  (std::make_pair (t0, t1))-> as <PathVector> ());
           if (valid [1])
-            result->concatenate (*straight [1]);
+            result->concatenate (straight [1]);
           else
-            result->concatenate (*(current->extract
-                  (std::make_pair (t1, t2))-> as <PathVector> ()));
+            result->concatenate (current->extract
+                  (std::make_pair (t1, t2))-> as <PathVector> ());
           if (valid [2])
-            result->concatenate (*straight [2]);
+            result->concatenate (straight [2]);
           else
-            result->concatenate (*(current->extract
-                  (std::make_pair (t2, t3))-> as <PathVector> ()));
+            result->concatenate (current->extract
+                  (std::make_pair (t2, t3))-> as <PathVector> ());
 
           newLength = pathLength (result, problem ().distance ());
           if (newLength >= length) {
             nbFail++;
+            iterationDone ();
             continue;
           }
           if (newLength >= length - parameters.progressionMargin)
@@ -295,12 +442,128 @@ namespace hpp {
             nbFail = 0;
           --iJ; // This joint could be optimized. Try another time on it.
           length = newLength;
+          iterationDone (length);
           hppDout (info, "length = " << length << ", nbFail = " << nbFail
               << ", joint " << joint->name());
           current = result;
         }
         return result;
       }
+
+      PathVectorPtr_t PartialShortcut::optimizeFullPathInParallel (
+          const PathVectorPtr_t& pv, const JointVector_t& jvIn,
+          JointVector_t& jvOut) const
+      {
+        PathVectorPtr_t opted = pv;
+        JointVector_t joints (jvIn);
+        std::vector <value_type> lengths;
+        while (!joints.empty () && !stopOptimization ()) {
+          lengths.assign (joints.size (),
+              std::numeric_limits <value_type>::infinity ());
+          FullShortcuts f;
+          f.path = &opted;
+          f.joints = &joints;
+          f.lengths = &lengths;
+          runThreads (problem (), threadProblems_, f);
+          std::size_t best = std::min_element (lengths.begin (),
+              lengths.end ()) - lengths.begin ();
+          if (lengths [best] == std::numeric_limits <value_type>::infinity ())
+            break;
+          // Build the path again with the objects of the problem of the
+          // optimizer: the path found by the thread is equal but refers to
+          // its own robot.
+          PathVectorPtr_t straight = generatePath (problem (), opted,
+              joints [best], 0, opted->initial (),
+              opted->timeRange ().second, opted->end ());
+          if (!straight) break;
+          opted = straight;
+          hppDout (info, "length = " << lengths [best]
+              << ", joint " << joints [best]->name());
+          joints.erase (joints.begin () + best);
+        }
+        jvOut.insert (jvOut.end (), joints.begin (), joints.end ());
+        return opted;
+      }
+
+      PathVectorPtr_t PartialShortcut::optimizeRandomInParallel (
+          const PathVectorPtr_t& pv, const JointVector_t& jv)
+      {
+        PathVectorPtr_t current = pv;
+        value_type length = pathLength (pv, problem ().distance ());
+
+        hppDout (info, "parallel random partial shorcut on " << jv.size ()
+            << " joints.");
+
+        // Each round tries all the joints.
+        const std::size_t maxFailure =
+          parameters.numberOfConsecutiveFailurePerJoints;
+        std::size_t nbFail = 0;
+        Candidates_t candidates (jv.size ());
+        Configuration_t q1 (pv->outputSize ()), q2 (pv->outputSize ());
+        while (nbFail < maxFailure && !stopOptimization ()) {
+          const value_type t3 = current->timeRange ().second;
+          for (std::size_t k = 0; k < candidates.size (); ++k) {
+            value_type u2 = t3 * uniform ();
+            value_type u1 = t3 * uniform ();
+            if (u1 < u2) {
+              candidates [k].t1 = u1; candidates [k].t2 = u2;
+            } else {
+              candidates [k].t1 = u2; candidates [k].t2 = u1;
+            }
+          }
+          RandomShortcuts f;
+          f.path = &current;
+          f.joints = &jv;
+          f.candidates = &candidates;
+          runThreads (problem (), threadProblems_, f);
+          std::size_t best = 0;
+          for (std::size_t k = 1; k < candidates.size (); ++k) {
+            if (candidates [k].length < candidates [best].length) best = k;
+          }
+          const Candidate& c (candidates [best]);
+          if (c.length >= length || !(*current) (q1, c.t1) ||
+              !(*current) (q2, c.t2)) {
+            nbFail++;
+            iterationDone ();
+            continue;
+          }
+          // Replace valid parts, building them again with the objects of
+          // the problem of the optimizer.
+          const value_type times [4] = { 0, c.t1, c.t2, t3 };
+          const Configuration_t configs [4] =
+            { current->initial (), q1, q2, current->end () };
+          PathVectorPtr_t result = PathVector::create (pv->outputSize (),
+              pv->outputDerivativeSize ());
+          for (unsigned i=0; i<3; ++i) {
+            PathVectorPtr_t part;
+            if (c.valid [i]) {
+              part = generatePath (problem (), current, jv [best], times [i],
+                  configs [i], times [i+1], configs [i+1]);
+            }
+            if (!part) {
+              part = current->extract (std::make_pair
+                  (times [i], times [i+1]))->as <PathVector> ();
+            }
+            result->concatenate (part);
+          }
+          value_type newLength = pathLength (result, problem ().distance ());
+          if (newLength >= length) {
+            nbFail++;
+            iterationDone ();
+            continue;
+          }
+          if (newLength >= length - parameters.progressionMargin)
+            nbFail++;
+          else
+            nbFail = 0;
+          length = newLength;
+          iterationDone (length);
+          hppDout (info, "length = " << length << ", nbFail = " << nbFail
+              << ", joint " << jv [best]->name());
+          current = result;
+        }
+        return current;
+      }
     } // namespace pathOptimization
   } // namespace core
 } // namespace hpp
@@ -49,7 +49,7 @@ namespace hpp {
 	// Check that path is a list of straight interpolations
 	for (std::size_t i=0; i<nbPaths_; ++i) {
 	  if (!HPP_DYNAMIC_PTR_CAST (const StraightPath,
-				     path->pathAtRank (i))) {
+				     path->pathAtRankNoCopy (i))) {
 	    throw std::runtime_error
 	      ("Path is not composed of StraighPath instances.");
 	  }
@@ -69,8 +69,8 @@ namespace hpp {
 	lambda_.setZero ();
 	value_type lambdaMax = 0;
 	for (std::size_t i=0; i < nbPaths_; ++i) {
-	  value_type d = (*distance_) (path->pathAtRank (i)->initial (),
-				       path->pathAtRank (i)->end ());
+	  value_type d = (*distance_) (path->pathAtRankNoCopy (i)->initial (),
+				       path->pathAtRankNoCopy (i)->end ());
 	  lambda_ [i] = d;
 	  if (d > lambdaMax) lambdaMax = d;
 	}
@@ -179,13 +179,8 @@ namespace hpp {
 	assert (indexVelocity == jacobian.cols ());
       }
 
-      void PathLength::hessian (matrixOut_t result) const
+      matrix_t PathLength::squaredWeights () const
       {
-	assert (result.rows () == inputDerivativeSize ());
-	assert (result.cols () == inputDerivativeSize ());
-
-	size_type n = nbPaths_ - 1;
-	// Fill inverse weight matrix
 	matrix_t W2 (numberDofs_, numberDofs_); W2.setZero ();
 	size_type index = 0;
 	size_type rank = 0;
@@ -206,6 +201,17 @@ namespace hpp {
 	  }
 	}
 	assert (index == numberDofs_);
+	return W2;
+      }
+
+      void PathLength::hessian (matrixOut_t result) const
+      {
+	assert (result.rows () == inputDerivativeSize ());
+	assert (result.cols () == inputDerivativeSize ());
+
+	size_type n = nbPaths_ - 1;
+	// Fill inverse weight matrix
+	matrix_t W2 (squaredWeights ());
 
 	matrix_t hessian (inputDerivativeSize (), inputDerivativeSize ());
 	hessian.setZero ();
@@ -222,6 +228,19 @@ namespace hpp {
 		       numberDofs_) = (lambda_ [n-1] + lambda_[n]) * W2;
 	result = hessian;
       }
+
+      void PathLength::hessian (std::vector <matrix_t>& diagonal,
+				std::vector <matrix_t>& lower) const
+      {
+	size_type n = nbPaths_ - 1;
+	matrix_t W2 (squaredWeights ());
+	diagonal.resize (n);
+	lower.resize (n - 1);
+	for (size_type i = 0; i < n; ++i) {
+	  diagonal [i] = (lambda_ [i] + lambda_ [i+1]) * W2;
+	  if (i < n-1) lower [i] = -lambda_ [i+1] * W2;
+	}
+      }
     } // namespace pathOptimization
   }  // namespace core
 } // namespace hpp
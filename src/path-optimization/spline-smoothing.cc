@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <hpp/model/configuration.hh>
+#include <hpp/model/device.hh>
+#include <hpp/core/path-optimization/spline-smoothing.hh>
+#include <hpp/core/path-validation.hh>
+#include <hpp/core/path-vector.hh>
+#include <hpp/core/problem.hh>
+#include "path-optimization/hermite-path.hh"
+
+namespace hpp {
+  namespace core {
+    namespace pathOptimization {
+      SplineSmoothingPtr_t SplineSmoothing::create (const Problem& problem)
+      {
+	SplineSmoothing* ptr = new SplineSmoothing (problem);
+	return SplineSmoothingPtr_t (ptr);
+      }
+
+      SplineSmoothing::SplineSmoothing (const Problem& problem) :
+	PathOptimizer (problem)
+      {
+      }
+
+      PathVectorPtr_t SplineSmoothing::optimize (const PathVectorPtr_t& path)
+      {
+	startOptimization ();
+	const DevicePtr_t& robot (problem ().robot ());
+	PathVectorPtr_t flat = PathVector::create
+	  (path->outputSize (), path->outputDerivativeSize ());
+	path->flatten (flat);
+	// Paths of zero length do not define a piece of the spline.
+	Paths_t elements;
+	for (std::size_t i = 0; i < flat->numberPaths (); ++i) {
+	  PathPtr_t element (flat->pathAtRank (i));
+	  if (element->length () > 0) elements.push_back (element);
+	}
+	const std::size_t n = elements.size ();
+	if (n < 2) return path;
+
+	matrix_t waypoints (robot->configSize (), n + 1);
+	matrix_t delta (robot->numberDof (), n);
+	vector_t h (n);
+	waypoints.col (0) = elements [0]->initial ();
+	for (std::size_t i = 0; i < n; ++i) {
+	  waypoints.col (i + 1) = elements [i]->end ();
+	  h [i] = elements [i]->length ();
+	  model::difference (robot, waypoints.col (i + 1), waypoints.col (i),
+			     delta.col (i));
+	}
+
+	// Tangents of the natural cubic spline: row i of the tridiagonal
+	// system relates the tangents at way points i - 1, i and i + 1.
+	vector_t lower (n + 1), diagonal (n + 1), upper (n + 1);
+	matrix_t tangents (robot->numberDof (), n + 1);
+	diagonal [0] = 2;
+	upper [0] = 1;
+	tangents.col (0) = 3 / h [0] * delta.col (0);
+	for (std::size_t i = 1; i < n; ++i) {
+	  lower [i] = h [i];
+	  diagonal [i] = 2 * (h [i - 1] + h [i]);
+	  upper [i] = h [i - 1];
+	  tangents.col (i) = 3 * (h [i] / h [i - 1] * delta.col (i - 1) +
+				  h [i - 1] / h [i] * delta.col (i));
+	}
+	lower [n] = 1;
+	diagonal [n] = 2;
+	tangents.col (n) = 3 / h [n - 1] * delta.col (n - 1);
+	// The system is diagonally dominant: Gaussian elimination without
+	// pivoting is stable.
+	for (std::size_t i = 1; i <= n; ++i) {
+	  const value_type w = lower [i] / diagonal [i - 1];
+	  diagonal [i] -= w * upper [i - 1];
+	  tangents.col (i) -= w * tangents.col (i - 1);
+	}
+	tangents.col (n) /= diagonal [n];
+	for (std::size_t i = n; i > 0; --i) {
+	  tangents.col (i - 1) = (tangents.col (i - 1) -
+				  upper [i - 1] * tangents.col (i)) /
+	    diagonal [i - 1];
+	}
+
+	PathVectorPtr_t result = PathVector::create
+	  (path->outputSize (), path->outputDerivativeSize ());
+	PathValidationPtr_t pathValidation (problem ().pathValidation ());
+	for (std::size_t i = 0; i < n; ++i) {
+	  PathPtr_t piece;
+	  if (!stopOptimization ()) {
+	    PathPtr_t spline = HermitePath::create
+	      (robot, waypoints.col (i), waypoints.col (i + 1),
+	       tangents.col (i), tangents.col (i + 1), h [i],
+	       elements [i]->constraints ());
+	    PathPtr_t validPart;
+	    PathValidationReportPtr_t report;
+	    if (pathValidation->validate (spline, false, validPart, report)) {
+	      piece = spline;
+	    }
+	    iterationDone ();
+	  }
+	  // Fall back to the original path between the way points
+	  result->appendPath (piece ? piece : elements [i]);
+	}
+	return result;
+      }
+    } // namespace pathOptimization
+  } // namespace core
+} // namespace hpp
@@ -0,0 +1,103 @@
+//
+// Copyright (c) 2016 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#ifndef HPP_CORE_PATH_OPTIMIZATION_THREAD_PROBLEMS_HH
+# define HPP_CORE_PATH_OPTIMIZATION_THREAD_PROBLEMS_HH
+
+# include <algorithm>
+# include <stdexcept>
+# include <string>
+# include <vector>
+# include <boost/bind.hpp>
+# include <boost/thread/thread.hpp>
+# include <hpp/core/path-projector.hh>
+# include <hpp/core/path-vector.hh>
+# include <hpp/core/problem.hh>
+# include <hpp/core/steering-method.hh>
+
+namespace hpp {
+  namespace core {
+    namespace pathOptimization {
+      // Helpers for optimizers that evaluate paths with one problem per
+      // worker thread (see Problem::cloneForThread).
+
+      // Steer with the steering method and path projector of a problem, as
+      // PathOptimizer::steer does with the problem of the optimizer.
+      inline PathPtr_t steer (const Problem& problem, ConfigurationIn_t q1,
+			      ConfigurationIn_t q2)
+      {
+	PathPtr_t dp = (*problem.steeringMethod ()) (q1, q2);
+	if (dp && problem.pathProjector ()) {
+	  PathPtr_t pp;
+	  if (problem.pathProjector ()->apply (dp, pp)) return pp;
+	  return PathPtr_t ();
+	}
+	return dp;
+      }
+
+      // Copy a path vector with the steering method of a problem, so that
+      // the elements are evaluated with the robot and constraints of this
+      // problem.
+      inline PathVectorPtr_t steerElements (const Problem& problem,
+					    const PathVectorPtr_t& path)
+      {
+	PathVectorPtr_t result = PathVector::create
+	  (path->outputSize (), path->outputDerivativeSize ());
+	const SteeringMethod& sm (*problem.steeringMethod ());
+	for (std::size_t i=0; i<path->numberPaths (); ++i) {
+	  const PathPtr_t& element (path->pathAtRankNoCopy (i));
+	  result->appendPath (sm (element->initial (), element->end ()));
+	}
+	return result;
+      }
+
+      // Run a function object with one thread per problem of
+      // threadProblems, or with problem if threadProblems is empty. The
+      // function takes the problem, the rank of the thread, the number of
+      // threads, whether paths should be copied for the problem and an
+      // error message.
+      template <typename Function>
+      void runThreads (const Problem& problem,
+		       const std::vector <const Problem*>& threadProblems,
+		       Function f)
+      {
+	const std::size_t nbThreads = threadProblems.size ();
+	std::vector <std::string> errors (std::max (nbThreads,
+						    (std::size_t) 1));
+	if (nbThreads == 0) {
+	  f (&problem, 0, 1, false, &errors [0]);
+	} else {
+	  boost::thread_group threads;
+	  for (std::size_t thread = 0; thread < nbThreads; ++thread) {
+	    threads.create_thread
+	      (boost::bind (f, threadProblems [thread], thread, nbThreads, true,
+			    &errors [thread]));
+	  }
+	  threads.join_all ();
+	}
+	for (std::size_t thread = 0; thread < errors.size (); ++thread) {
+	  if (!errors [thread].empty ()) {
+	    throw std::runtime_error (errors [thread]);
+	  }
+	}
+      }
+    } // namespace pathOptimization
+  } // namespace core
+} // namespace hpp
+
+#endif // HPP_CORE_PATH_OPTIMIZATION_THREAD_PROBLEMS_HH
@@ -0,0 +1,102 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <hpp/model/device.hh>
+#include <hpp/core/path-optimization/time-parameterization.hh>
+#include <hpp/core/path-vector.hh>
+#include <hpp/core/problem.hh>
+#include <hpp/core/time-parameterized-path.hh>
+
+namespace hpp {
+  namespace core {
+    namespace pathOptimization {
+      TimeParameterizationPtr_t TimeParameterization::create
+      (const Problem& problem)
+      {
+	TimeParameterization* ptr = new TimeParameterization (problem);
+	return TimeParameterizationPtr_t (ptr);
+      }
+
+      TimeParameterization::TimeParameterization (const Problem& problem) :
+	PathOptimizer (problem),
+	velocityLimits_ (vector_t::Ones (problem.robot ()->numberDof ())),
+	accelerationLimits_ (vector_t::Ones (problem.robot ()->numberDof ()))
+      {
+      }
+
+      void TimeParameterization::velocityLimits (vectorIn_t limits)
+      {
+	checkLimits (limits);
+	velocityLimits_ = limits;
+      }
+
+      void TimeParameterization::accelerationLimits (vectorIn_t limits)
+      {
+	checkLimits (limits);
+	accelerationLimits_ = limits;
+      }
+
+      void TimeParameterization::checkLimits (vectorIn_t limits) const
+      {
+	if (limits.size () != velocityLimits_.size ()) {
+	  throw std::invalid_argument
+	    ("Limits should have the size of the robot velocity.");
+	}
+	if (limits.size () > 0 && !(limits.minCoeff () > 0)) {
+	  throw std::invalid_argument ("Limits should be positive.");
+	}
+      }
+
+      PathVectorPtr_t TimeParameterization::optimize
+      (const PathVectorPtr_t& path)
+      {
+	const value_type inf = std::numeric_limits <value_type>::infinity ();
+	PathVectorPtr_t flat = PathVector::create
+	  (path->outputSize (), path->outputDerivativeSize ());
+	path->flatten (flat);
+	PathVectorPtr_t result = PathVector::create
+	  (path->outputSize (), path->outputDerivativeSize ());
+	vector_t bound (path->outputDerivativeSize ());
+	for (std::size_t i = 0; i < flat->numberPaths (); ++i) {
+	  PathPtr_t element (flat->pathAtRank (i));
+	  const interval_t& range (element->timeRange ());
+	  if (!element->velocityBound (bound, range.first, range.second)) {
+	    throw std::runtime_error
+	      ("Time parameterization requires velocity bounds of the paths.");
+	  }
+	  // Maximal derivatives of the parameter of the element such that
+	  // the limits of all degrees of freedom are satisfied.
+	  value_type velocity = inf;
+	  value_type acceleration = inf;
+	  for (size_type j = 0; j < bound.size (); ++j) {
+	    if (bound [j] <= 0) continue;
+	    velocity = std::min (velocity, velocityLimits_ [j] / bound [j]);
+	    acceleration = std::min (acceleration,
+				     accelerationLimits_ [j] / bound [j]);
+	  }
+	  result->appendPath (TimeParameterizedPath::create
+			      (element, velocity, acceleration));
+	}
+	return result;
+      }
+    } // namespace pathOptimization
+  } // namespace core
+} // namespace hpp
@@ -16,6 +16,8 @@
 
 #include <hpp/core/path-optimizer.hh>
 
+#include <stdexcept>
+#include <hpp/core/cancellation-token.hh>
 #include <hpp/core/problem.hh>
 #include <hpp/core/path-projector.hh>
 #include <hpp/core/steering-method.hh>
@@ -34,6 +36,70 @@ namespace hpp {
       }
       return PathPtr_t ();
     }
+
+    bool PathOptimizer::steer (ConfigurationIn_t q1, ConfigurationIn_t q2,
+			       PathPtr_t& path) const
+    {
+      if (problem().pathProjector()) {
+	path = steer (q1, q2);
+	return path;
+      }
+      return (*problem().steeringMethod()) (q1, q2, path);
+    }
+
+    void PathOptimizer::startOptimization ()
+    {
+      interrupt_ = false;
+      startTime_ = boost::posix_time::microsec_clock::universal_time ();
+      numberIterations_ = 0;
+      costs_.clear ();
+      converged_ = false;
+    }
+
+    void PathOptimizer::minRelativeImprovement (value_type ratio,
+						std::size_t window)
+    {
+      if (ratio < 0 || window == 0) {
+	throw std::invalid_argument
+	  ("Relative improvement should be non negative and measured over at "
+	   "least one iteration.");
+      }
+      minRelativeImprovement_ = ratio;
+      window_ = window;
+    }
+
+    void PathOptimizer::iterationDone ()
+    {
+      if (costs_.empty ()) {
+	++numberIterations_;
+      } else {
+	iterationDone (costs_.back ());
+      }
+    }
+
+    void PathOptimizer::iterationDone (const value_type& cost)
+    {
+      ++numberIterations_;
+      costs_.push_back (cost);
+      if (costs_.size () > window_ + 1) costs_.pop_front ();
+      if (costs_.size () <= window_) return;
+      converged_ = (costs_.front () - cost <=
+		    minRelativeImprovement_ * costs_.front ());
+    }
+
+    bool PathOptimizer::stopOptimization () const
+    {
+      if (interrupt_) return true;
+      if (cancellationToken_ && cancellationToken_->cancelled ()) return true;
+      if (numberIterations_ >= maxIterations_) return true;
+      if (minRelativeImprovement_ > 0 && converged_) return true;
+      if (timeOut_ == std::numeric_limits <value_type>::infinity ()) {
+	return false;
+      }
+      boost::posix_time::time_duration duration
+	(boost::posix_time::microsec_clock::universal_time () - startTime_);
+      return 1e-6 * (value_type) duration.total_microseconds () > timeOut_;
+    }
   } // namespace core
 } // namespace hpp
 
@@ -16,10 +16,20 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+# include <algorithm>
+# include <limits>
+# include <stdexcept>
+# include <boost/atomic.hpp>
+# include <boost/bind.hpp>
+# include <boost/function.hpp>
+# include <boost/thread/thread.hpp>
 # include <hpp/util/debug.hh>
+#include <hpp/core/cancellation-token.hh>
+#include <hpp/core/distance.hh>
 #include <hpp/core/path-planner.hh>
 #include <hpp/core/roadmap.hh>
 #include <hpp/core/problem.hh>
+#include <hpp/core/query-record.hh>
 #include <hpp/core/node.hh>
 #include <hpp/core/edge.hh>
 #include <hpp/core/path.hh>
@@ -27,6 +37,7 @@
 #include <hpp/core/path-projector.hh>
 #include <hpp/core/steering-method.hh>
 #include "astar.hh"
+#include "path-optimization/thread-problems.hh"
 
 namespace hpp {
   namespace core {
@@ -34,14 +45,24 @@ namespace hpp {
     PathPlanner::PathPlanner (const Problem& problem) :
       problem_ (problem), roadmap_ (Roadmap::create (problem.distance (),
 						     problem.robot())),
-      interrupt_ (false)
+      pathCost_ (), interrupt_ (false), cancellationToken_ (),
+      threadProblems_ (), stopAtFirstDirectPath_ (false), maxIterations_ (0),
+      timeOut_ (std::numeric_limits <value_type>::infinity ()),
+      startTime_ (boost::posix_time::microsec_clock::universal_time ()),
+      weakPtr_ (), tryDirectPathLatency_ (), oneStepLatency_ (),
+      computePathLatency_ (), finishSolveLatency_ ()
     {
     }
 
     PathPlanner::PathPlanner (const Problem& problem,
 			      const RoadmapPtr_t& roadmap) :
-      problem_ (problem), roadmap_ (roadmap),
-      interrupt_ (false)
+      problem_ (problem), roadmap_ (roadmap), pathCost_ (),
+      interrupt_ (false), cancellationToken_ (), threadProblems_ (),
+      stopAtFirstDirectPath_ (false), maxIterations_ (0),
+      timeOut_ (std::numeric_limits <value_type>::infinity ()),
+      startTime_ (boost::posix_time::microsec_clock::universal_time ()),
+      weakPtr_ (), tryDirectPathLatency_ (), oneStepLatency_ (),
+      computePathLatency_ (), finishSolveLatency_ ()
     {
     }
 
@@ -73,24 +94,111 @@ namespace hpp {
       }
     }
 
+    bool PathPlanner::timeOutReached () const
+    {
+      if (timeOut_ == std::numeric_limits <value_type>::infinity ()) {
+	return false;
+      }
+      boost::posix_time::time_duration duration
+	(boost::posix_time::microsec_clock::universal_time () - startTime_);
+      return 1e-6 * (value_type) duration.total_microseconds () > timeOut_;
+    }
+
+    bool PathPlanner::cancelled () const
+    {
+      return interrupt_ || (cancellationToken_ &&
+			    cancellationToken_->cancelled ());
+    }
+
+    std::string PathPlanner::statusMessage (Status status)
+    {
+      switch (status) {
+      case SOLVED:
+	return "A path has been found.";
+      case CANCELLED:
+	return "Interruption";
+      case MAX_ITERATIONS_REACHED:
+	return "Maximal number of iterations reached before finding a path.";
+      case TIME_OUT_REACHED:
+	return "Time out reached before finding a path.";
+      }
+      return "Unknown status.";
+    }
+
     PathVectorPtr_t PathPlanner::solve ()
     {
+      PathVectorPtr_t result;
+      Status status (trySolve (result));
+      if (status != SOLVED) {
+	throw std::runtime_error (statusMessage (status));
+      }
+      return result;
+    }
+
+    PathPlanner::Status PathPlanner::trySolve (PathVectorPtr_t& path)
+    {
+      path.reset ();
       interrupt_ = false;
+      startTime_ = boost::posix_time::microsec_clock::universal_time ();
       bool solved = false;
       startSolve ();
+      RecordedEvent directPath (QueryRecord::DIRECT_PATH);
+      boost::posix_time::ptime start
+	(boost::posix_time::microsec_clock::universal_time ());
       tryDirectPath ();
-      solved = roadmap_->pathExists ();
+      tryDirectPathLatency_.recordSince (start);
+      solved = directPath.done (roadmap_->pathExists ());
       if (solved ) {
 	hppDout (info, "tryDirectPath succeeded");
       }
-      if (interrupt_) throw std::runtime_error ("Interruption");
+      if (cancelled ()) return CANCELLED;
+      std::size_t iteration = 0;
       while (!solved) {
+	if (maxIterations_ != 0 && iteration == maxIterations_) {
+	  return MAX_ITERATIONS_REACHED;
+	}
+	if (timeOutReached ()) return TIME_OUT_REACHED;
+	RecordedEvent step (QueryRecord::ONE_STEP);
+	start = boost::posix_time::microsec_clock::universal_time ();
 	oneStep ();
-	solved = roadmap_->pathExists ();
-	if (interrupt_) throw std::runtime_error ("Interruption");
+	oneStepLatency_.recordSince (start);
+	++iteration;
+	if (roadmap_->memoryBudgetExceeded ()) pruneRoadmap ();
+	solved = step.done (roadmap_->pathExists ());
+	if (cancelled ()) return CANCELLED;
       }
+      RecordedEvent compute (QueryRecord::COMPUTE_PATH);
+      start = boost::posix_time::microsec_clock::universal_time ();
       PathVectorPtr_t planned =  computePath ();
-      return finishSolve (planned);
+      computePathLatency_.recordSince (start);
+      compute.done (static_cast <bool> (planned));
+      start = boost::posix_time::microsec_clock::universal_time ();
+      path = finishSolve (planned);
+      finishSolveLatency_.recordSince (start);
+      return SOLVED;
+    }
+
+    void PathPlanner::pruneRoadmap ()
+    {
+      roadmap_->prune ();
+    }
+
+    PathPlanner::Latencies PathPlanner::latencies () const
+    {
+      Latencies result;
+      result.tryDirectPath = tryDirectPathLatency_.snapshot ();
+      result.oneStep = oneStepLatency_.snapshot ();
+      result.computePath = computePathLatency_.snapshot ();
+      result.finishSolve = finishSolveLatency_.snapshot ();
+      return result;
+    }
+
+    void PathPlanner::resetLatencies ()
+    {
+      tryDirectPathLatency_.reset ();
+      oneStepLatency_.reset ();
+      computePathLatency_.reset ();
+      finishSolveLatency_.reset ();
     }
 
     void PathPlanner::interrupt ()
@@ -100,7 +208,10 @@ namespace hpp {
 
     PathVectorPtr_t PathPlanner::computePath () const
     {
-      Astar astar (roadmap_, problem_.distance ());
+      if (roadmap_->incrementalSearch () && !pathCost_) {
+	return roadmap_->shortestPath (problem_.distance ());
+      }
+      Astar astar (roadmap_, problem_.distance (), pathCost_);
       return astar.solution ();
     }
 
@@ -109,39 +220,130 @@ namespace hpp {
       return path;
     }
 
+    namespace {
+      // Steer, project and validate the direct path between two
+      // configurations with the objects of a problem.
+      // Return the path if it is valid, an empty path otherwise.
+      PathPtr_t directPath (const Problem& problem, ConfigurationIn_t q1,
+			    ConfigurationIn_t q2)
+      {
+	assert (q1 != q2);
+	PathPtr_t path = pathOptimization::steer (problem, q1, q2);
+	if (!path) return PathPtr_t ();
+	PathPtr_t validPath;
+	bool pathValid = problem.pathValidation ()->validateWithoutReport
+	  (path, false, validPath);
+	if (pathValid && validPath->timeRange ().second !=
+	    path->timeRange ().first) {
+	  return path;
+	}
+	return PathPtr_t ();
+      }
+
+      // Direct paths from the init configuration to goals, shared by the
+      // worker threads
+      struct DirectPaths
+      {
+	DirectPaths (ConfigurationIn_t init, const Nodes_t& goals,
+		     bool stopAtFirst, const boost::function <bool ()>& stop,
+		     std::size_t nbThreads) :
+	  init (init), goals (goals), stopAtFirst (stopAtFirst), stop (stop),
+	  found (false), paths (goals.size ()), errors (nbThreads)
+	{
+	}
+	const Configuration_t init;
+	const Nodes_t& goals;
+	/// Whether to stop after the first valid path
+	const bool stopAtFirst;
+	/// Whether planning is cancelled
+	const boost::function <bool ()> stop;
+	boost::atomic <bool> found;
+	/// Valid paths, indexed as goals, empty if the path is not valid
+	std::vector <PathPtr_t> paths;
+	std::vector <std::string> errors;
+      }; // struct DirectPaths
+
+      // Compute the direct paths of rank thread, thread + nbThreads, ...
+      // with the objects of a problem owned by the thread.
+      void computeDirectPaths (const Problem* problem, std::size_t thread,
+			       std::size_t nbThreads, DirectPaths& direct)
+      {
+	try {
+	  for (std::size_t i = thread; i < direct.goals.size ();
+	       i += nbThreads) {
+	    if (direct.found.load (boost::memory_order_relaxed) ||
+		direct.stop ()) return;
+	    direct.paths [i] = directPath
+	      (*problem, direct.init, *(direct.goals [i]->configuration ()));
+	    if (direct.paths [i] && direct.stopAtFirst) {
+	      direct.found.store (true, boost::memory_order_relaxed);
+	    }
+	  }
+	} catch (const std::exception& exc) {
+	  direct.errors [thread] = exc.what ();
+	}
+      }
+
+      typedef std::pair <value_type, NodePtr_t> DistanceAndNode_t;
+
+      bool closer (const DistanceAndNode_t& n1, const DistanceAndNode_t& n2)
+      {
+	return n1.first < n2.first;
+      }
+    } // namespace
+
     void PathPlanner::tryDirectPath ()
     {
-      // call steering method here to build a direct conexion
-      const SteeringMethodPtr_t& sm (problem ().steeringMethod ());
-      PathValidationPtr_t pathValidation (problem ().pathValidation ());
-      PathProjectorPtr_t pathProjector (problem ().pathProjector ());
-      PathPtr_t validPath, projPath, path;
       NodePtr_t initNode = roadmap ()->initNode();
+      const Configuration_t& init (*(initNode->configuration ()));
+      // Sort goals by increasing distance, so that the shortest paths are
+      // tried first.
+      const Distance& distance (*problem ().distance ());
+      std::vector <DistanceAndNode_t> sorted;
       for (Nodes_t::const_iterator itn = roadmap ()->goalNodes ().begin();
 	   itn != roadmap ()->goalNodes ().end (); ++itn) {
-	ConfigurationPtr_t q1 ((initNode)->configuration ());
-	ConfigurationPtr_t q2 ((*itn)->configuration ());
-	assert (*q1 != *q2);
-	path = (*sm) (*q1, *q2);
-        if (!path) continue;
-        if (pathProjector) {
-          if (!pathProjector->apply (path, projPath)) continue;
-        } else {
-          projPath = path;
-        }
-        if (projPath) {
-	  PathValidationReportPtr_t report;
-          bool pathValid = pathValidation->validate (projPath, false, validPath,
-						     report);
-          if (pathValid && validPath->timeRange ().second !=
-              path->timeRange ().first) {
-            roadmap ()->addEdge (initNode, *itn, projPath);
-            interval_t timeRange = projPath->timeRange ();
-            roadmap ()->addEdge (*itn, initNode, projPath->extract
-                (interval_t (timeRange.second,
-                             timeRange.first)));
-          }
-        }
+	sorted.push_back (DistanceAndNode_t
+			  (distance (init, *((*itn)->configuration ())),
+			   *itn));
+      }
+      std::stable_sort (sorted.begin (), sorted.end (), closer);
+      Nodes_t goals;
+      for (std::size_t i = 0; i < sorted.size (); ++i) {
+	goals.push_back (sorted [i].second);
+      }
+      const std::size_t nbThreads = threadProblems_.size ();
+      DirectPaths direct (init, goals, stopAtFirstDirectPath_,
+			  boost::bind (&PathPlanner::cancelled, this),
+			  nbThreads);
+      if (nbThreads == 0) {
+	for (std::size_t i = 0; i < goals.size (); ++i) {
+	  if (cancelled ()) break;
+	  direct.paths [i] = directPath (problem (), init,
+					 *(goals [i]->configuration ()));
+	  if (direct.paths [i] && stopAtFirstDirectPath_) break;
+	}
+      } else {
+	boost::thread_group threads;
+	for (std::size_t thread = 0; thread < nbThreads; ++thread) {
+	  threads.create_thread
+	    (boost::bind (&computeDirectPaths, threadProblems_ [thread],
+			  thread, nbThreads, boost::ref (direct)));
+	}
+	threads.join_all ();
+	for (std::size_t thread = 0; thread < nbThreads; ++thread) {
+	  if (!direct.errors [thread].empty ()) {
+	    throw std::runtime_error (direct.errors [thread]);
+	  }
+	}
+      }
+      const std::vector <PathPtr_t>& paths (direct.paths);
+      for (std::size_t i = 0; i < goals.size (); ++i) {
+	if (!paths [i]) continue;
+	roadmap ()->addEdge (initNode, goals [i], paths [i]);
+	interval_t timeRange = paths [i]->timeRange ();
+	roadmap ()->addEdge (goals [i], initNode, paths [i]->extract
+			     (interval_t (timeRange.second,
+					  timeRange.first)));
       }
     }
 
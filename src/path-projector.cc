@@ -16,7 +16,10 @@
 
 #include "hpp/core/path-projector.hh"
 
+#include <algorithm>
 #include <hpp/util/pointer.hh>
+#include <hpp/core/config-projector.hh>
+#include <hpp/core/constraint-set.hh>
 #include <hpp/core/path-vector.hh>
 #include <hpp/core/distance.hh>
 #include <hpp/core/steering-method.hh>
@@ -26,7 +29,9 @@ namespace hpp {
     PathProjector::PathProjector (const DistancePtr_t& distance,
 				  const SteeringMethodPtr_t& steeringMethod,
 				  bool keepSteeringMethodConstraints) :
-      distance_ (distance), steeringMethod_ (steeringMethod->copy ())
+      distance_ (distance), steeringMethod_ (steeringMethod->copy ()),
+      cacheSize_ (0), cache_ (), cacheIndex_ (), cacheHits_ (0),
+      cacheMisses_ (0)
     {
       assert (distance_ != NULL);
       assert (steeringMethod_ != NULL);
@@ -43,6 +48,13 @@ namespace hpp {
       return (*distance_) (q1, q2);
     }
 
+    void PathProjector::distances (ConfigurationIn_t q,
+				   matrixIn_t configurations,
+				   vectorOut_t result) const
+    {
+      distance_->distances (q, configurations, result);
+    }
+
     PathPtr_t PathProjector::steer (ConfigurationIn_t q1,
 				    ConfigurationIn_t q2) const
     {
@@ -54,7 +66,95 @@ namespace hpp {
     bool PathProjector::apply (const PathPtr_t& path,
 			       PathPtr_t& proj) const
     {
-      return impl_apply (path, proj);
+      if (cacheSize_ == 0 || !path->constraints ()) {
+	return impl_apply (path, proj);
+      }
+      StraightPathPtr_t sp = HPP_DYNAMIC_PTR_CAST (StraightPath, path);
+      if (!sp) return impl_apply (path, proj);
+      CacheKey key;
+      key.initial = sp->initial ();
+      key.end = sp->end ();
+      key.constraints = path->constraints ()->revision ();
+      key.configProjector = 0;
+      const ConfigProjectorPtr_t& cp
+	(path->constraints ()->configProjector ());
+      if (cp) {
+	key.configProjector = cp->revision ();
+	key.rightHandSide = cp->rightHandSide ();
+      }
+      CacheIndex_t::iterator it = cacheIndex_.find (key);
+      if (it != cacheIndex_.end ()) {
+	++cacheHits_;
+	cache_.splice (cache_.begin (), cache_, it->second);
+	proj = it->second->second.projection;
+	return it->second->second.success;
+      }
+      ++cacheMisses_;
+      bool success = impl_apply (path, proj);
+      cache_.push_front (std::make_pair (key, CacheEntry (proj, success)));
+      cacheIndex_ [key] = cache_.begin ();
+      trimCache ();
+      return success;
+    }
+
+    PathProjectorPtr_t PathProjector::copy
+    (const DistancePtr_t& distance,
+     const SteeringMethodPtr_t& steeringMethod) const
+    {
+      PathProjectorPtr_t result (impl_copy (distance, steeringMethod));
+      if (result) result->cacheSize (cacheSize_);
+      return result;
+    }
+
+    PathProjectorPtr_t PathProjector::impl_copy
+    (const DistancePtr_t&, const SteeringMethodPtr_t&) const
+    {
+      return PathProjectorPtr_t ();
+    }
+
+    void PathProjector::cacheSize (std::size_t size)
+    {
+      cacheSize_ = size;
+      trimCache ();
+    }
+
+    void PathProjector::clearCache ()
+    {
+      cache_.clear ();
+      cacheIndex_.clear ();
+      cacheHits_ = 0;
+      cacheMisses_ = 0;
+    }
+
+    void PathProjector::trimCache () const
+    {
+      // std::list::size may be linear
+      while (cacheIndex_.size () > cacheSize_) {
+	cacheIndex_.erase (cache_.back ().first);
+	cache_.pop_back ();
+      }
+    }
+
+    namespace {
+      bool lessThan (vectorIn_t v1, vectorIn_t v2)
+      {
+	if (v1.size () != v2.size ()) return v1.size () < v2.size ();
+	return std::lexicographical_compare (v1.data (), v1.data () + v1.size (),
+					     v2.data (), v2.data () + v2.size ());
+      }
+    } // namespace
+
+    bool PathProjector::CacheKey::operator< (const CacheKey& other) const
+    {
+      if (lessThan (initial, other.initial)) return true;
+      if (lessThan (other.initial, initial)) return false;
+      if (lessThan (end, other.end)) return true;
+      if (lessThan (other.end, end)) return false;
+      if (constraints != other.constraints)
+	return constraints < other.constraints;
+      if (configProjector != other.configProjector)
+	return configProjector < other.configProjector;
+      return lessThan (rightHandSide, other.rightHandSide);
     }
   } // namespace core
 } // namespace hpp
@@ -19,8 +19,7 @@
 #include <hpp/core/path-vector.hh>
 #include <hpp/core/config-projector.hh>
 
-#include <queue>
-#include <stack>
+#include <vector>
 
 namespace hpp {
   namespace core {
@@ -28,9 +27,17 @@ namespace hpp {
       Dichotomy::Dichotomy (const DistancePtr_t& distance,
 			    const SteeringMethodPtr_t& steeringMethod,
 			    value_type maxPathLength) :
-        PathProjector (distance, steeringMethod), maxPathLength_ (maxPathLength)
+        PathProjector (distance, steeringMethod), maxPathLength_ (maxPathLength),
+	toSplit_ (), projected_ (), qMiddle_ (), qProjected_ ()
       {}
 
+      PathProjectorPtr_t Dichotomy::impl_copy
+      (const DistancePtr_t& distance,
+       const SteeringMethodPtr_t& steeringMethod) const
+      {
+	return create (distance, steeringMethod, maxPathLength_);
+      }
+
       bool Dichotomy::impl_apply (const PathPtr_t& path, PathPtr_t& proj) const
       {
 	assert (path);
@@ -84,54 +91,63 @@ namespace hpp {
           return true;
         }
 
+        // Paths the middle of which is moved by the projection by less
+        // than the error threshold of the constraints are nearly on the
+        // constraint manifold: they are not split further.
+        const value_type threshold = cp->errorThreshold ();
         bool pathIsFullyProjected = true;
-        std::queue <PathPtr_t> paths;
-        std::stack <PathPtr_t> pathToSplit;
-        Configuration_t qi (q1.size());
-        PathPtr_t sPath = steer (q1, q2);
-        pathToSplit.push (sPath);
-        while (!pathToSplit.empty ()) {
-          sPath = pathToSplit.top ();
-          pathToSplit.pop ();
+        toSplit_.clear ();
+        projected_.clear ();
+        qMiddle_.resize (q1.size ());
+        qProjected_.resize (q1.size ());
+        toSplit_.push_back (steer (q1, q2));
+        while (!toSplit_.empty ()) {
+          PathPtr_t sPath = toSplit_.back ();
+          toSplit_.pop_back ();
           double l = sPath->length ();
           if (l < maxPathLength_) {
-            paths.push (sPath);
+            projected_.push_back (sPath);
             continue;
           }
           timeRange = sPath->timeRange ();
-          const Configuration_t& qb = sPath->initial ();
-          (*sPath) (qi, timeRange.first + l / 2);
-          const Configuration_t& qe = sPath->end ();
-          if (!constraints->apply (qi)) {
+          (*sPath) (qMiddle_, timeRange.first + l / 2);
+          qProjected_ = qMiddle_;
+          if (!constraints->apply (qProjected_)) {
             pathIsFullyProjected = false;
             break;
           }
-          PathPtr_t firstPart = steer (qb, qi);
-          PathPtr_t secondPart = steer (qi, qe);
+          if (d (qMiddle_, qProjected_) <= threshold) {
+            projected_.push_back (sPath);
+            continue;
+          }
+          PathPtr_t firstPart = steer (sPath->initial (), qProjected_);
+          PathPtr_t secondPart = steer (qProjected_, sPath->end ());
           if (secondPart->length () == 0 || firstPart->length () == 0) {
             pathIsFullyProjected = false;
             break;
           }
-          pathToSplit.push (secondPart);
-          pathToSplit.push (firstPart);
+          toSplit_.push_back (secondPart);
+          toSplit_.push_back (firstPart);
         }
-        switch (paths.size ()) {
+        toSplit_.clear ();
+        switch (projected_.size ()) {
           case 0:
             return false;
             break;
           case 1:
-            projection = paths.front ()->copy (constraints);
+            projection = projected_.front ()->copy (constraints);
             break;
           default:
             core::PathVectorPtr_t pv = core::PathVector::create
 	      (path->outputSize (), path->outputDerivativeSize ());
-            while (!paths.empty ()) {
-              pv->appendPath (paths.front ()->copy (constraints));
-              paths.pop ();
+            for (std::vector <PathPtr_t>::const_iterator it =
+		   projected_.begin (); it != projected_.end (); ++it) {
+              pv->appendPath ((*it)->copy (constraints));
             }
             projection = pv;
             break;
         }
+        projected_.clear ();
         return pathIsFullyProjected;
       }
     } // namespace pathProjector
@@ -22,10 +22,10 @@
 #include <hpp/core/path-vector.hh>
 #include <hpp/core/interpolated-path.hh>
 #include <hpp/core/config-projector.hh>
+#include "interpolation-plan.hh"
 
+#include <cmath>
 #include <limits>
-#include <queue>
-#include <stack>
 
 namespace hpp {
   namespace core {
@@ -34,9 +34,18 @@ namespace hpp {
 				const SteeringMethodPtr_t& steeringMethod,
 				value_type step) :
         PathProjector (distance, steeringMethod), step_ (step),
-        alphaMin (0.2), alphaMax (0.95)
+        numberThreads_ (1), alphaMin (0.2), alphaMax (0.95)
       {}
 
+      PathProjectorPtr_t Global::impl_copy
+      (const DistancePtr_t& distance,
+       const SteeringMethodPtr_t& steeringMethod) const
+      {
+	GlobalPtr_t result (create (distance, steeringMethod, step_));
+	result->numberThreads (numberThreads_);
+	return result;
+      }
+
       bool Global::impl_apply (const PathPtr_t& path,
 				    PathPtr_t& proj) const
       {
@@ -82,25 +91,28 @@ namespace hpp {
         Configs_t cfgs;
         ConfigProjector& p = *path->constraints ()->configProjector ();
         initialConfigList (path, cfgs);
-        if (cfgs.size() == 2) { // Shorter than step_
+        const std::size_t n = cfgs.cols ();
+        if (n == 2) { // Shorter than step_
           proj = path;
           return true;
         }
-        assert ((cfgs.back () - path->end ()).isZero ());
+        assert ((cfgs.col (n - 1) - path->end ()).isZero ());
 
-        Bools_t projected (cfgs.size () - 2, false);
-        Alphas_t alphas   (cfgs.size () - 2, alphaMin);
-        Lengths_t lengths (cfgs.size () - 1, 0);
+        // End configurations are not projected
+        Bools_t projected (n, false);
+        projected.front () = projected.back () = true;
+        Alphas_t alphas   (n, alphaMin);
+        Lengths_t lengths (n - 1, 0);
 
         std::size_t nbIter = 0;
         const std::size_t maxIter = p.maxIterations ();
         const std::size_t maxCfgNum =
           2 + (std::size_t)(10 * path->length() / step_);
 
-        hppDout (info, "start with " << cfgs.size () << " configs");
+        hppDout (info, "start with " << n << " configs");
         while (!projectOneStep (p, cfgs, projected, lengths, alphas)) {
-          assert ((cfgs.back () - path->end ()).isZero ());
-          if (cfgs.size() < maxCfgNum) {
+          assert ((cfgs.col (cfgs.cols () - 1) - path->end ()).isZero ());
+          if ((std::size_t) cfgs.cols () < maxCfgNum) {
             const std::size_t newCs =
               reinterpolate (p.robot(), cfgs, projected, lengths, alphas,
                   step_);
@@ -125,31 +137,70 @@ namespace hpp {
           Alphas_t& a) const
       {
         /// First and last should not be updated
-        const Configs_t::iterator begin = ++(q.begin ());
-        const Configs_t::iterator end   = --(q.end ());
-        Bools_t  ::iterator itB   =   (b.begin ());
-        Alphas_t ::iterator itA   =   (a.begin ());
-        Lengths_t::iterator itL   =   (l.begin ());
-        Configs_t::iterator itCp  =   (q.begin ());
+        const size_type n = q.cols ();
+        if (numberThreads_ > 1)
+          return projectOneStepInParallel (p, q, b, l, a);
         bool allAreSatisfied = true;
         bool curUpdated = false, prevUpdated = false;
-        for (Configs_t::iterator it = begin; it != end; ++it) {
-          if (!*itB) {
-            *itB = p.oneStep (*it, *itA);
-            *itA = alphaMax - 0.8 * (alphaMax - *itA);
-            allAreSatisfied = allAreSatisfied && *itB;
+        for (size_type i = 1; i < n - 1; ++i) {
+          if (!b [i]) {
+            b [i] = p.oneStep (q.col (i), a [i]);
+            a [i] = alphaMax - 0.8 * (alphaMax - a [i]);
+            allAreSatisfied = allAreSatisfied && b [i];
             curUpdated = true;
           }
           if (prevUpdated || curUpdated)
-            *itL = d (*itCp, *it);
+            l [i - 1] = d (q.col (i - 1), q.col (i));
           prevUpdated = curUpdated;
           curUpdated = false;
-          ++itCp;
-          ++itB;
-          ++itL;
         }
         if (prevUpdated)
-          *itL = d (*itCp, *end);
+          l [n - 2] = d (q.col (n - 2), q.col (n - 1));
+        return allAreSatisfied;
+      }
+
+      bool Global::projectOneStepInParallel (ConfigProjector& p,
+          Configs_t& q, Bools_t& b, Lengths_t& l, Alphas_t& a) const
+      {
+        // Gather the waypoints that do not satisfy the constraints
+        const size_type n = q.cols ();
+        std::vector <size_type> indices;
+        for (size_type i = 1; i < n - 1; ++i) {
+          if (!b [i]) indices.push_back (i);
+        }
+        const size_type m = indices.size ();
+        if (m == 0) return true;
+        matrix_t configs (q.rows (), m);
+        vector_t alphas (m);
+        for (size_type k = 0; k < m; ++k) {
+          configs.col (k) = q.col (indices [k]);
+          alphas [k] = a [indices [k]];
+        }
+        std::vector <bool> success;
+        p.oneStepBatch (configs, alphas, success, numberThreads_);
+
+        bool allAreSatisfied = true;
+        for (size_type k = 0; k < m; ++k) {
+          const size_type i = indices [k];
+          q.col (i) = configs.col (k);
+          b [i] = success [k];
+          a [i] = alphaMax - 0.8 * (alphaMax - a [i]);
+          allAreSatisfied = allAreSatisfied && b [i];
+        }
+        // Update the lengths of the segments adjacent to a moved waypoint
+        // from the distances of the waypoint to its neighbors, the segment
+        // before it only if the previous waypoint did not move.
+        vector_t lengths (3);
+        for (size_type k = 0; k < m; ++k) {
+          const size_type i = indices [k];
+          if (k == 0 || indices [k - 1] != i - 1) {
+            distances (q.col (i), q.middleCols (i - 1, 3), lengths);
+            l [i - 1] = lengths [0];
+          } else {
+            distances (q.col (i), q.middleCols (i, 2), lengths.tail (2));
+          }
+          l [i] = lengths [2];
+        }
         return allAreSatisfied;
       }
 
@@ -157,38 +208,56 @@ namespace hpp {
           Configs_t& q, Bools_t& b, Lengths_t& l, Alphas_t& a,
           const value_type& maxDist) const
       {
-        Configs_t::iterator begin = ++(q.begin ());
-        Configs_t::iterator end   =   (q.end ());
-        Bools_t  ::iterator itB   =   (b.begin ());
-        Alphas_t ::iterator itA   =   (a.begin ());
-        Lengths_t::iterator itL   =   (l.begin ());
-        Configs_t::iterator itCp  =   (q.begin ());
-        Configuration_t newQ (robot->configSize ());
-        std::size_t nbNewC = 0;
-        for (Configs_t::iterator it = begin; it != end; ++it) {
-          if (*itL > maxDist) {
-            ++nbNewC;
-            hpp::model::interpolate (robot, *itCp, *it, 0.5, newQ);
-            // FIXME: make sure the iterator are valid after insertion
-            // Insert new respective elements
-            it  = q.insert (it, newQ);
-            itB = b.insert (itB, false);
-            itA = a.insert (itA, alphaMin);
-            itL = l.insert (itL, d (*itCp, *it));
-            // Update length after
-            Configs_t::iterator itNC = it;  ++itNC;
-            Lengths_t::iterator itNL = itL; ++itNL;
-            *itNL = d (*it, *itNC);
-            // FIXME: End has changed ?
-            end = q.end();
-            it = itCp;
+        // Count the configurations to insert in each segment so that all
+        // the new arrays are allocated once.
+        const size_type n = q.cols ();
+        std::vector <size_type> nbInserted (n - 1, 0);
+        size_type nbNewC = 0;
+        for (size_type i = 0; i < n - 1; ++i) {
+          if (l [i] > maxDist) {
+            nbInserted [i] = (size_type) std::ceil (l [i] / maxDist) - 1;
+            nbNewC += nbInserted [i];
+          }
+        }
+        if (nbNewC == 0) return 0;
+
+        const InterpolationPlanPtr_t plan (InterpolationPlan::get (robot));
+        Configs_t newQ (q.rows (), n + nbNewC);
+        Bools_t newB;   newB.reserve (n + nbNewC);
+        Alphas_t newA;  newA.reserve (n + nbNewC);
+        Lengths_t newL; newL.reserve (n + nbNewC - 1);
+        size_type j = 0;
+        for (size_type i = 0; i < n - 1; ++i, ++j) {
+          newQ.col (j) = q.col (i);
+          newB.push_back (b [i]);
+          newA.push_back (a [i]);
+          if (nbInserted [i] == 0) {
+            newL.push_back (l [i]);
             continue;
           }
-          ++itCp;
-          ++itB;
-          ++itA;
-          ++itL;
+          // Split the segment in pieces of equal parameter
+          const value_type m = (value_type) (nbInserted [i] + 1);
+          const vector_t u (vector_t::LinSpaced
+                            (nbInserted [i], 1 / m, nbInserted [i] / m));
+          plan->interpolate (q.col (i), q.col (i + 1), u,
+                             newQ.middleCols (j + 1, nbInserted [i]));
+          for (size_type k = 1; k <= nbInserted [i]; ++k) {
+            ++j;
+            newB.push_back (false);
+            newA.push_back (alphaMin);
+            newL.push_back (d (newQ.col (j - 1), newQ.col (j)));
+          }
+          newL.push_back (d (newQ.col (j), q.col (i + 1)));
         }
+        newQ.col (j) = q.col (n - 1);
+        newB.push_back (b [n - 1]);
+        newA.push_back (a [n - 1]);
+        assert (j + 1 == newQ.cols ());
+
+        q.swap (newQ);
+        b.swap (newB);
+        a.swap (newA);
+        l.swap (newL);
         return nbNewC;
       }
 
@@ -196,39 +265,33 @@ namespace hpp {
           const ConstraintSetPtr_t& constraint, const Configs_t& q,
           const Bools_t& b, const Lengths_t& l, PathPtr_t& result) const
       {
-        /// Compute total length
+        /// Compute total length and find the last configuration of the
+        /// longest projected part starting at the initial configuration
+        const size_type n = q.cols ();
         value_type length = 0;
-        Lengths_t::const_iterator itL   = (l.begin ());
-        Bools_t  ::const_iterator itB   = (b.begin ());
-        Configs_t::const_iterator itCl  = (q.begin ());
+        size_type last = 0;
         bool fullyProjected = true;
-        for (; itB != b.end (); ++itB) {
-          if (!*itB || *itL > step_) {
+        for (size_type i = 1; i < n - 1; ++i) {
+          if (!b [i] || l [i - 1] > step_) {
             fullyProjected = false;
             break;
           }
-          length += *itL;
-          ++itCl;
-          ++itL;
+          length += l [i - 1];
+          last = i;
         }
         if (fullyProjected) {
-          length += *itL;
-          ++itCl;
-          ++itL;
-          assert (itL == l.end ());
+          length += l [n - 2];
+          last = n - 1;
         }
 
         InterpolatedPathPtr_t out = InterpolatedPath::create
-          (robot, q.front(), *itCl, length, constraint);
+          (robot, q.col (0), q.col (last), length, constraint);
 
-        if (itCl != q.begin ()) {
+        if (last != 0) {
           length = 0;
-          Lengths_t::const_iterator itL   =   (l.begin ());
-          Configs_t::const_iterator begin = ++(q.begin ());
-          for (Configs_t::const_iterator it = begin; it != itCl; ++it) {
-            length += *itL;
-            out->insert (length, *it);
-            ++itL;
+          for (size_type i = 1; i < last; ++i) {
+            length += l [i - 1];
+            out->insert (length, q.col (i));
           }
         } else {
           hppDout (info, "Path of length 0");
@@ -246,26 +309,26 @@ namespace hpp {
           HPP_DYNAMIC_PTR_CAST (InterpolatedPath, path);
         if (ip) {
           // Get the waypoint of ip
-          const InterpolatedPath::InterpolationPoints_t& ips =
-            ip->interpolationPoints();
-          for (InterpolatedPath::InterpolationPoints_t::const_iterator it =
-              ips.begin (); it != ips.end (); ++it) {
-            cfgs.push_back (it->second);
-          }
+          cfgs.resize (path->outputSize (), ip->numberInterpolationPoints ());
+          for (std::size_t i = 0; i < ip->numberInterpolationPoints (); ++i)
+            cfgs.col (i) = ip->interpolationPoint (i);
         } else {
           const value_type L = path->length ();
-          Configuration_t q (path->outputSize ());
-          cfgs.push_back (path->initial ());
           // Factor 0.99 is to ensure that the distance between two consecutives
           // configurations will be smaller that step_
-          for (value_type t = step_; t < L; t += step_*0.99) {
+          size_type nb = 2;
+          for (value_type t = step_; t < L; t += step_*0.99) ++nb;
+          cfgs.resize (path->outputSize (), nb);
+          cfgs.col (0) = path->initial ();
+          size_type i = 1;
+          for (value_type t = step_; t < L; t += step_*0.99, ++i) {
             // Interpolate without taking care of the constraints
             // FIXME: Path must not be a PathVector otherwise the constraints
             // are applied.
-            path->at (t, q);
-            cfgs.push_back (q);
+            path->at (t, cfgs.col (i));
           }
-          cfgs.push_back (path->end ());
+          assert (i == nb - 1);
+          cfgs.col (nb - 1) = path->end ();
         }
       }
     } // namespace pathProjector
@@ -16,10 +16,14 @@
 
 #include "hpp/core/path-projector/progressive.hh"
 
+#include <hpp/model/configuration.hh>
+
 #include <hpp/core/path-vector.hh>
 #include <hpp/core/interpolated-path.hh>
 #include <hpp/core/config-projector.hh>
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include <queue>
 #include <stack>
@@ -30,9 +34,17 @@ namespace hpp {
       Progressive::Progressive (const DistancePtr_t& distance,
 				const SteeringMethodPtr_t& steeringMethod,
 				value_type step) :
-        PathProjector (distance, steeringMethod), step_ (step)
+        PathProjector (distance, steeringMethod), step_ (step),
+        curvature_ (0), curvatureOutdated_ (true), curvatureProjector_ ()
       {}
 
+      PathProjectorPtr_t Progressive::impl_copy
+      (const DistancePtr_t& distance,
+       const SteeringMethodPtr_t& steeringMethod) const
+      {
+	return create (distance, steeringMethod, step_);
+      }
+
       bool Progressive::impl_apply (const PathPtr_t& path,
 				    PathPtr_t& proj) const
       {
@@ -106,12 +118,12 @@ namespace hpp {
             break;
           }
           const Configuration_t& qb = toSplit->initial ();
-          curStep = step_;
+          curStep = stepLength (cp, qb, q2);
           curLength = std::numeric_limits <value_type>::max();
           size_t dicC = 0;
-          /// Find the good length.
-          /// Here, it would be good to have an upper bound of the Hessian
-          /// of the constraint.
+          /// Find the good length, starting from the step predicted with the
+          /// curvature of the constraints. The curvature is estimated again
+          /// after a step that needed to be reduced.
           do {
             if (dicC >= maxDichotomyTries) break;
             (*toSplit) (qi, curStep);
@@ -120,6 +132,7 @@ namespace hpp {
             curStep /= 2;
             dicC++;
           } while (curLength > step_ || curLength < 1e-3);
+          curvatureOutdated_ = curvatureOutdated_ || dicC > 1;
           if (dicC >= maxDichotomyTries || c > maxPathSplit) break;
 	  assert (curLength == d (qb, qi));
           PathPtr_t part = steer (qb, qi);
@@ -177,6 +190,23 @@ namespace hpp {
 		(d (projection->end (), path->end ()) == 0));
         return pathIsFullyProjected;
       }
+
+      value_type Progressive::stepLength (const ConfigProjectorPtr_t& cp,
+          ConfigurationIn_t q, ConfigurationIn_t target) const
+      {
+        if (curvatureOutdated_ || curvatureProjector_.lock () != cp) {
+          vector_t v (cp->robot ()->numberDof ());
+          model::difference (cp->robot (), target, q, v);
+          const value_type norm = v.norm ();
+          if (norm == 0) return step_;
+          v /= norm;
+          curvature_ = cp->curvature (q, v, std::min (.1 * step_, norm));
+          curvatureProjector_ = cp;
+          curvatureOutdated_ = false;
+        }
+        if (curvature_ <= 0) return step_;
+        return (sqrt (1 + 2 * curvature_ * step_) - 1) / curvature_;
+      }
     } // namespace pathProjector
   } // namespace core
 } // namespace hpp
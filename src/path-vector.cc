@@ -16,7 +16,10 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <cassert>
 #include <hpp/core/path-vector.hh>
+#include "memory-usage.hh"
 
 namespace hpp {
   namespace core {
@@ -24,23 +27,31 @@ namespace hpp {
     std::size_t PathVector::rankAtParam (const value_type& param,
 					 value_type& localParam) const
     {
-      std::size_t res = 0;
-      localParam = param;
-      bool finished = false;
-
-      while (res < paths_.size () - 1 && !finished) {
-	if (localParam > paths_ [res]->length ()) {
-	  localParam -= paths_ [res]->length ();
-	  res ++;
-	}
-	else {
-	  finished = true;
+      assert (!paths_.empty ());
+      assert (ends_.size () == paths_.size ());
+      std::size_t n = paths_.size ();
+      // Rank res is the first one such that param <= ends_ [res].
+      std::size_t res = lastRank_;
+      if (res >= n) res = 0;
+      value_type begin = (res == 0 ? 0 : ends_ [res - 1]);
+      if (!((res == 0 || param > begin) && param <= ends_ [res])) {
+	if (res + 1 < n && param > ends_ [res] && param <= ends_ [res + 1]) {
+	  // Next path when sampling in increasing order
+	  ++res;
+	} else if (res > 0 && (res == 1 || param > ends_ [res - 2]) &&
+		   param <= begin) {
+	  // Previous path when sampling in decreasing order
+	  --res;
+	} else {
+	  res = std::lower_bound (ends_.begin (), ends_.end (), param) -
+	    ends_.begin ();
+	  if (res >= n) res = n - 1;
 	}
+	begin = (res == 0 ? 0 : ends_ [res - 1]);
       }
+      lastRank_ = res;
+      localParam = param - begin;
       if (localParam > paths_ [res]->length ()) {
-	if (res != paths_.size () -1) {
-	  throw std::runtime_error ("localparam out of range.");
-	}
 	localParam = paths_ [res]->timeRange ().second;
       }
       localParam += paths_ [res]->timeRange ().first;
@@ -51,6 +62,7 @@ namespace hpp {
     {
       paths_.push_back (path);
       timeRange_.second += path->length ();
+      ends_.push_back (timeRange_.second);
     }
 
     PathPtr_t PathVector::pathAtRank (std::size_t rank) const
@@ -76,14 +88,28 @@ namespace hpp {
     void PathVector::concatenate (const PathVector& path)
     {
       for (std::size_t i=0; i<path.numberPaths (); ++i) {
-	appendPath (path.pathAtRank (i)->copy ());
+	appendPath (path.pathAtRank (i));
+      }
+    }
+
+    void PathVector::concatenate (const PathVectorPtr_t& path)
+    {
+      if (path->constraints ()) {
+	concatenate (*path);
+	return;
+      }
+      paths_.reserve (paths_.size () + path->numberPaths ());
+      ends_.reserve (ends_.size () + path->numberPaths ());
+      for (std::size_t i=0; i<path->numberPaths (); ++i) {
+	appendPath (path->pathAtRankNoCopy (i));
       }
     }
 
     void PathVector::flatten (PathVectorPtr_t p) const
     {
       for (std::size_t i = 0; i < numberPaths (); ++i) {
-        PathPtr_t path = pathAtRank (i);
+        // Sub-paths are only copied to apply the constraints of the vector
+        PathPtr_t path = constraints () ? pathAtRank (i) : paths_ [i];
         PathVectorPtr_t pv = HPP_DYNAMIC_PTR_CAST(PathVector, path);
         if (pv) pv->flatten (p);
         else    p->appendPath (path);
@@ -102,6 +128,64 @@ namespace hpp {
       return (*subpath) (result, localParam);
     }
 
+    void PathVector::impl_eval (vectorIn_t times, matrixOut_t configurations,
+				std::vector <bool>& success) const
+    {
+      vector_t localTimes (times.size ());
+      std::vector <bool> localSuccess;
+      size_type i = 0;
+      while (i < times.size ()) {
+	// Gather successive parameters on the same sub-path
+	std::size_t rank = rankAtParam (times [i], localTimes [0]);
+	size_type n = 1;
+	value_type localParam;
+	while (i + n < times.size () &&
+	       rankAtParam (times [i + n], localParam) == rank) {
+	  localTimes [n] = localParam;
+	  ++n;
+	}
+	paths_ [rank]->eval (localTimes.head (n),
+			     configurations.middleCols (i, n), localSuccess);
+	for (size_type j = 0; j < n; ++j) success [i + j] = localSuccess [j];
+	i += n;
+      }
+    }
+
+    std::size_t PathVector::impl_memoryUsage () const
+    {
+      std::size_t result = sizeof (PathVector) + memory::bytes (paths_) +
+	memory::bytes (ends_);
+      for (Paths_t::const_iterator it = paths_.begin (); it != paths_.end ();
+	   ++it) {
+	result += (*it)->memoryUsage ();
+      }
+      return result;
+    }
+
+    bool PathVector::impl_velocityBound (vectorOut_t result, value_type t0,
+					 value_type t1) const
+    {
+      result.setZero ();
+      vector_t bound (outputDerivativeSize ());
+      value_type start = timeRange ().first;
+      for (Paths_t::const_iterator itPath = paths_.begin ();
+	   itPath != paths_.end (); ++itPath) {
+	const PathPtr_t& path (*itPath);
+	value_type end = start + path->length ();
+	if (end >= t0 && start <= t1) {
+	  // Bounds of the overlap in the parameters of the sub-path
+	  value_type offset = path->timeRange ().first - start;
+	  if (!path->velocityBound (bound, std::max (start, t0) + offset,
+				    std::min (end, t1) + offset)) {
+	    return false;
+	  }
+	  result = result.cwiseMax (bound);
+	}
+	start = end;
+      }
+      return true;
+    }
+
     PathPtr_t PathVector::extract (const interval_t& subInterval) const
     {
       using std::make_pair;
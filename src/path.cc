@@ -60,6 +60,13 @@ namespace hpp {
       assert (!path.constraints_);
     }
 
+    std::size_t Path::memoryUsage () const
+    {
+      std::size_t result = impl_memoryUsage ();
+      if (constraints_) result += constraints_->memoryUsage ();
+      return result;
+    }
+
     // Initialization after creation
     void Path::init (const PathPtr_t& self)
     {
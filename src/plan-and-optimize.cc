@@ -16,6 +16,8 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <limits>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <hpp/core/path-optimizer.hh>
 #include <hpp/core/plan-and-optimize.hh>
 
@@ -27,6 +29,11 @@ namespace hpp {
       pathPlanner_->oneStep ();
     }
 
+    void PlanAndOptimize::pruneRoadmap ()
+    {
+      pathPlanner_->pruneRoadmap ();
+    }
+
     void PlanAndOptimize::startSolve ()
     {
       pathPlanner_->startSolve ();
@@ -34,10 +41,25 @@ namespace hpp {
 
     PathVectorPtr_t PlanAndOptimize::finishSolve (const PathVectorPtr_t& path)
     {
+      using boost::posix_time::microsec_clock;
       PathVectorPtr_t result = path;
+      const boost::posix_time::ptime start (microsec_clock::universal_time ());
       for (Optimizers_t::iterator itOpt = optimizers_.begin ();
 	   itOpt != optimizers_.end (); ++itOpt) {
-	result = (*itOpt)->optimize (result);
+	boost::posix_time::time_duration duration
+	  (microsec_clock::universal_time () - start);
+	value_type remaining = optimizationTimeOut_ -
+	  1e-6 * (value_type) duration.total_microseconds ();
+	if (remaining <= 0) break;
+	const value_type timeOut = (*itOpt)->timeOut ();
+	if (remaining < timeOut) (*itOpt)->timeOut (remaining);
+	try {
+	  result = (*itOpt)->measuredOptimize (result);
+	} catch (...) {
+	  (*itOpt)->timeOut (timeOut);
+	  throw;
+	}
+	(*itOpt)->timeOut (timeOut);
       }
       return result;
     }
@@ -57,7 +79,8 @@ namespace hpp {
 
     PlanAndOptimize::PlanAndOptimize (const PathPlannerPtr_t& pathPlanner) :
       PathPlanner (pathPlanner->problem (), pathPlanner->roadmap ()),
-      pathPlanner_ (pathPlanner), optimizers_ ()
+      pathPlanner_ (pathPlanner), optimizers_ (),
+      optimizationTimeOut_ (std::numeric_limits <value_type>::infinity ())
     {
     }
 
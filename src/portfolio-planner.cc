@@ -0,0 +1,166 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <sstream>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <hpp/util/debug.hh>
+#include <hpp/util/pointer.hh>
+#include <hpp/core/basic-configuration-shooter.hh>
+#include <hpp/core/node.hh>
+#include <hpp/core/path-vector.hh>
+#include <hpp/core/portfolio-planner.hh>
+#include <hpp/core/problem.hh>
+#include <hpp/core/roadmap.hh>
+#include <hpp/core/seeded-configuration-shooter.hh>
+
+namespace hpp {
+  namespace core {
+    PortfolioPlannerPtr_t PortfolioPlanner::createWithRoadmap
+    (const Problem& problem, const RoadmapPtr_t& roadmap)
+    {
+      PortfolioPlanner* ptr = new PortfolioPlanner (problem, roadmap);
+      return PortfolioPlannerPtr_t (ptr);
+    }
+
+    PortfolioPlannerPtr_t PortfolioPlanner::create (const Problem& problem)
+    {
+      PortfolioPlanner* ptr = new PortfolioPlanner (problem);
+      return PortfolioPlannerPtr_t (ptr);
+    }
+
+    PortfolioPlanner::PortfolioPlanner (const Problem& problem):
+      PathPlanner (problem), builders_ (), mutex_ (), finished_ (false),
+      solution_ (), errors_ ()
+    {
+    }
+
+    PortfolioPlanner::PortfolioPlanner (const Problem& problem,
+					const RoadmapPtr_t& roadmap) :
+      PathPlanner (problem, roadmap), builders_ (), mutex_ (),
+      finished_ (false), solution_ (), errors_ ()
+    {
+    }
+
+    void PortfolioPlanner::init (const PortfolioPlannerWkPtr_t& weak)
+    {
+      PathPlanner::init (weak);
+      weakPtr_ = weak;
+    }
+
+    void PortfolioPlanner::interrupt ()
+    {
+      PathPlanner::interrupt ();
+      boost::mutex::scoped_lock lock (mutex_);
+      finished_ = true;
+    }
+
+    bool PortfolioPlanner::finished ()
+    {
+      if (cancelled ()) return true;
+      boost::mutex::scoped_lock lock (mutex_);
+      return finished_;
+    }
+
+    void PortfolioPlanner::run (const PathPlannerPtr_t& planner,
+				std::size_t rank)
+    {
+      try {
+	// PathPlanner::solve is not called since it resets the interruption
+	// flag: a planner started after the end of the race would not stop.
+	planner->startSolve ();
+	planner->tryDirectPath ();
+	while (!planner->roadmap ()->pathExists ()) {
+	  if (finished ()) return;
+	  planner->oneStep ();
+	}
+	PathVectorPtr_t path (planner->finishSolve (planner->computePath ()));
+	boost::mutex::scoped_lock lock (mutex_);
+	if (!finished_) {
+	  hppDout (info, "planner " << rank << " found a solution");
+	  finished_ = true;
+	  solution_ = path;
+	}
+      } catch (const std::exception& exc) {
+	boost::mutex::scoped_lock lock (mutex_);
+	errors_ [rank] = exc.what ();
+      }
+    }
+
+    void PortfolioPlanner::oneStep ()
+    {
+      if (builders_.empty ()) {
+	throw std::runtime_error ("No planner in portfolio.");
+      }
+      // Problems are destroyed after the planners that refer to them.
+      std::vector <boost::shared_ptr <Problem> > problems;
+      std::vector <PathPlannerPtr_t> planners;
+      for (std::vector <PlannerBuilder_t>::const_iterator itBuilder =
+	     builders_.begin (); itBuilder != builders_.end (); ++itBuilder) {
+	boost::shared_ptr <Problem> copy (problem ().cloneForThread ());
+	// BasicConfigurationShooter samples joints with the generator of the
+	// C library, shared by the threads.
+	if (HPP_DYNAMIC_PTR_CAST (BasicConfigurationShooter,
+				  copy->configurationShooter ())) {
+	  copy->configurationShooter (SeededConfigurationShooter::create
+				      (copy->robot (), copy->drawSeed ()));
+	}
+	problems.push_back (copy);
+	planners.push_back ((*itBuilder)
+			    (*copy, Roadmap::create (copy->distance (),
+						     copy->robot ())));
+      }
+      finished_ = false;
+      solution_.reset ();
+      errors_.assign (planners.size (), std::string ());
+      boost::thread_group threads;
+      for (std::size_t rank = 0; rank < planners.size (); ++rank) {
+	threads.create_thread (boost::bind (&PortfolioPlanner::run, this,
+					    planners [rank], rank));
+      }
+      threads.join_all ();
+      if (!solution_) {
+	// Planners have been interrupted: solve stops since no path is found.
+	if (cancelled ()) return;
+	std::ostringstream oss;
+	oss << "All planners failed:";
+	for (std::size_t rank = 0; rank < errors_.size (); ++rank) {
+	  oss << std::endl << "planner " << rank << ": ";
+	  if (errors_ [rank].empty ()) {
+	    oss << "stopped without finding a path";
+	  } else {
+	    oss << errors_ [rank];
+	  }
+	}
+	throw std::runtime_error (oss.str ());
+      }
+      // Insert solution in the roadmap
+      RoadmapPtr_t r (roadmap ());
+      Configuration_t end (solution_->end ());
+      for (Nodes_t::const_iterator itGoal = r->goalNodes ().begin ();
+	   itGoal != r->goalNodes ().end (); ++itGoal) {
+	if (*((*itGoal)->configuration ()) == end) {
+	  r->addEdge (r->initNode (), *itGoal, solution_);
+	  r->addEdge (*itGoal, r->initNode (), solution_->reverse ());
+	  return;
+	}
+      }
+      throw std::runtime_error ("Solution does not end at a goal node.");
+    }
+  } // namespace core
+} // namespace hpp
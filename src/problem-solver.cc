@@ -16,12 +16,24 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <boost/bind.hpp>
 #include <hpp/util/debug.hh>
 #include <hpp/model/collision-object.hh>
 #include <hpp/constraints/differentiable-function.hh>
 #include <hpp/core/problem-solver.hh>
+#include <hpp/core/cached-path-validation.hh>
+#include <hpp/core/cancellation-token.hh>
 #include <hpp/core/diffusing-planner.hh>
 #include <hpp/core/distance-between-objects.hh>
+#include <hpp/core/distance-field.hh>
+#include <hpp/core/edge.hh>
+#include <hpp/core/joint-bound-validation.hh>
+#include <hpp/core/lazy-prm-planner.hh>
+#include <hpp/core/path-validation.hh>
+#include <hpp/core/portfolio-planner.hh>
 #include <hpp/core/roadmap.hh>
 #include <hpp/core/discretized-collision-checking.hh>
 #include <hpp/core/continuous-collision-checking/dichotomy.hh>
@@ -32,12 +44,22 @@
 #include <hpp/core/path-optimization/gradient-based.hh>
 #include <hpp/core/path-optimization/partial-shortcut.hh>
 #include <hpp/core/path-optimization/config-optimization.hh>
+#include <hpp/core/path-optimization/spline-smoothing.hh>
+#include <hpp/core/path-optimization/time-parameterization.hh>
 #include <hpp/core/random-shortcut.hh>
 #include <hpp/core/roadmap.hh>
+#include <hpp/core/rrt-connect-planner.hh>
+#include <hpp/core/rrt-star-planner.hh>
 #include <hpp/core/steering-method-straight.hh>
 #include <hpp/core/visibility-prm-planner.hh>
 #include <hpp/core/weighed-distance.hh>
 #include <hpp/core/basic-configuration-shooter.hh>
+#include <hpp/core/seeded-configuration-shooter.hh>
+#include <hpp/core/solve-future.hh>
+#include <hpp/core/solver-pool.hh>
+#include <hpp/core/halton-configuration-shooter.hh>
+#include "../src/nearest-neighbor/basic.hh"
+#include "../src/nearest-neighbor/k-d-tree.hh"
 
 namespace hpp {
   namespace core {
@@ -60,6 +82,30 @@ namespace hpp {
       }
     }; // struct NonePathProjector
 
+    // Structs that construct nearest neighbor objects.
+    struct BasicNearestNeighbor
+    {
+      static NearestNeighborPtr_t create (const DevicePtr_t&,
+					  const DistancePtr_t& distance)
+      {
+	return new nearestNeighbor::Basic (distance);
+      }
+    }; // struct BasicNearestNeighbor
+
+    struct KDTreeNearestNeighbor
+    {
+      static NearestNeighborPtr_t create (const DevicePtr_t& robot,
+					  const DistancePtr_t& distance)
+      {
+	if (!HPP_DYNAMIC_PTR_CAST (WeighedDistance, distance)) {
+	  hppDout (warning, "k-d tree requires a WeighedDistance, "
+		   "using linear search.");
+	  return new nearestNeighbor::Basic (distance);
+	}
+	return new nearestNeighbor::KDTree (robot, distance, 30);
+      }
+    }; // struct KDTreeNearestNeighbor
+
     ProblemSolverPtr_t ProblemSolver::latest_ = 0x0;
     ProblemSolverPtr_t ProblemSolver::create ()
     {
@@ -82,19 +128,44 @@ namespace hpp {
       configurationShooterType_ ("BasicConfigurationShooter"),
       pathOptimizerTypes_ (), pathOptimizers_ (),
       pathValidationType_ ("Discretized"), pathValidationTolerance_ (0.05),
-      pathPlannerFactory_ (), configurationShooterFactory_ (),
+      pathValidationCacheSize_ (0),
+      pathPlannerFactory_ (), portfolioPlannerTypes_ (),
+      configurationShooterFactory_ (),
       pathOptimizerFactory_ (), pathValidationFactory_ (),
       collisionObstacles_ (), distanceObstacles_ (), obstacleMap_ (),
-      errorThreshold_ (1e-4), maxIterations_ (20), numericalConstraintMap_ (),
+      distanceFieldResolution_ (0), distanceField_ (),
+      errorThreshold_ (1e-4), maxIterations_ (20),
+      planningTimeOut_ (std::numeric_limits <value_type>::infinity ()),
+      maxPlanningIterations_ (0),
+      optimizerTimeOut_ (std::numeric_limits <value_type>::infinity ()),
+      numericalConstraintMap_ (),
       passiveDofsMap_ (), comcMap_ (),
-      distanceBetweenObjects_ ()
+      distanceBetweenObjects_ (), nearestNeighborType_ ("KDTree"),
+      nearestNeighborFactory_ (), nearestNeighborEpsilon_ (0),
+      multiQuery_ (false), seed_ (5489u), keepSolveComponents_ (false),
+      solveComponents_ (), anytime_ (false), pathCallback_ (), bestPath_ (),
+      optimizedPaths_ (), optimizing_ (false), stopOptimization_ (false),
+      optimizationThread_ (), pathMutex_ (), operationCounts_ (),
+      recordFilename_ (), solveFuture_ (), solveThread_ ()
     {
       pathPlannerFactory_ ["DiffusingPlanner"] =
 	DiffusingPlanner::createWithRoadmap;
       pathPlannerFactory_ ["VisibilityPrmPlanner"] =
 	VisibilityPrmPlanner::createWithRoadmap;
+      pathPlannerFactory_ ["LazyPrmPlanner"] =
+	LazyPrmPlanner::createWithRoadmap;
+      pathPlannerFactory_ ["RrtConnectPlanner"] =
+	RrtConnectPlanner::createWithRoadmap;
+      pathPlannerFactory_ ["RrtStarPlanner"] =
+	RrtStarPlanner::createWithRoadmap;
+      pathPlannerFactory_ ["PortfolioPlanner"] =
+	boost::bind (&ProblemSolver::createPortfolioPlanner, this, _1, _2);
       configurationShooterFactory_ ["BasicConfigurationShooter"] =
         BasicConfigurationShooter::create;
+      configurationShooterFactory_ ["SeededConfigurationShooter"] =
+	boost::bind (&SeededConfigurationShooter::create, _1, 5489u);
+      configurationShooterFactory_ ["HaltonConfigurationShooter"] =
+	HaltonConfigurationShooter::create;
       // Store path optimization methods in map.
       pathOptimizerFactory_ ["RandomShortcut"] = RandomShortcut::create;
       pathOptimizerFactory_ ["GradientBased"] =
@@ -103,6 +174,10 @@ namespace hpp {
 	pathOptimization::PartialShortcut::create;
       pathOptimizerFactory_ ["ConfigOptimization"] =
 	pathOptimization::ConfigOptimization::create;
+      pathOptimizerFactory_ ["SplineSmoothing"] =
+	pathOptimization::SplineSmoothing::create;
+      pathOptimizerFactory_ ["TimeParameterization"] =
+	pathOptimization::TimeParameterization::create;
       pathOptimizerFactory_ ["None"] = NoneOptimizer::create;
       // Store path validation methods in map.
       pathValidationFactory_ ["Discretized"] =
@@ -120,13 +195,44 @@ namespace hpp {
 	pathProjector::Dichotomy::create;
       pathProjectorFactory_ ["Global"] =
 	pathProjector::Global::create;
+      // Store nearest neighbor methods in map.
+      nearestNeighborFactory_ ["Basic"] = BasicNearestNeighbor::create;
+      nearestNeighborFactory_ ["KDTree"] = KDTreeNearestNeighbor::create;
     }
 
     ProblemSolver::~ProblemSolver ()
     {
+      if (solveFuture_) solveFuture_->cancel ();
+      if (solveThread_) solveThread_->join ();
+      stopOptimization ();
       if (problem_) delete problem_;
     }
 
+    void ProblemSolver::addPortfolioPlannerType (const std::string& type)
+    {
+      if (pathPlannerFactory_.find (type) == pathPlannerFactory_.end ()) {
+	throw std::runtime_error (std::string ("No path planner with name ") +
+				  type);
+      }
+      if (type == "PortfolioPlanner") {
+	throw std::runtime_error ("A portfolio cannot contain a portfolio.");
+      }
+      portfolioPlannerTypes_.push_back (type);
+    }
+
+    PathPlannerPtr_t ProblemSolver::createPortfolioPlanner
+    (const Problem& problem, const RoadmapPtr_t& roadmap) const
+    {
+      PortfolioPlannerPtr_t planner
+	(PortfolioPlanner::createWithRoadmap (problem, roadmap));
+      for (std::vector <std::string>::const_iterator itType =
+	     portfolioPlannerTypes_.begin ();
+	   itType != portfolioPlannerTypes_.end (); ++itType) {
+	planner->addPlannerType (pathPlannerFactory_.find (*itType)->second);
+      }
+      return planner;
+    }
+
     void ProblemSolver::pathPlannerType (const std::string& type)
     {
       if (pathPlannerFactory_.find (type) == pathPlannerFactory_.end ()) {
@@ -156,18 +262,106 @@ namespace hpp {
 
     void ProblemSolver::clearPathOptimizers ()
     {
+      stopOptimization ();
       pathOptimizerTypes_.clear ();
       pathOptimizers_.clear ();
     }
 
     void ProblemSolver::optimizePath (PathVectorPtr_t path)
     {
+      stopOptimization ();
       createPathOptimizers ();
       for (PathOptimizers_t::const_iterator it = pathOptimizers_.begin ();
 	   it != pathOptimizers_.end (); ++it) {
-	path = (*it)->optimize (path);
+	RecordedEvent event (QueryRecord::PATH_OPTIMIZATION);
+	path = (*it)->measuredOptimize (path);
+	event.done (static_cast <bool> (path));
 	paths_.push_back (path);
+	publishPath (path);
+      }
+    }
+
+    void ProblemSolver::pathImprovedCallback (const PathCallback_t& callback)
+    {
+      boost::mutex::scoped_lock lock (pathMutex_);
+      pathCallback_ = callback;
+    }
+
+    PathVectorPtr_t ProblemSolver::bestPath () const
+    {
+      boost::mutex::scoped_lock lock (pathMutex_);
+      return bestPath_;
+    }
+
+    bool ProblemSolver::optimizing () const
+    {
+      boost::mutex::scoped_lock lock (pathMutex_);
+      return optimizing_;
+    }
+
+    void ProblemSolver::waitOptimization ()
+    {
+      if (!optimizationThread_) return;
+      optimizationThread_->join ();
+      optimizationThread_.reset ();
+      paths_.insert (paths_.end (), optimizedPaths_.begin (),
+		     optimizedPaths_.end ());
+      optimizedPaths_.clear ();
+    }
+
+    void ProblemSolver::stopOptimization ()
+    {
+      if (!optimizationThread_) return;
+      {
+	boost::mutex::scoped_lock lock (pathMutex_);
+	stopOptimization_ = true;
+      }
+      // An optimizer resets its interruption flag when it starts: interrupt
+      // until the thread terminates.
+      do {
+	for (PathOptimizers_t::iterator it = pathOptimizers_.begin ();
+	     it != pathOptimizers_.end (); ++it) {
+	  (*it)->interrupt ();
+	}
+      } while (!optimizationThread_->timed_join
+	       (boost::posix_time::milliseconds (10)));
+      waitOptimization ();
+    }
+
+    void ProblemSolver::runPathOptimizers (PathVectorPtr_t path)
+    {
+      for (PathOptimizers_t::const_iterator it = pathOptimizers_.begin ();
+	   it != pathOptimizers_.end (); ++it) {
+	{
+	  boost::mutex::scoped_lock lock (pathMutex_);
+	  if (stopOptimization_) break;
+	}
+	try {
+	  path = (*it)->measuredOptimize (path);
+	} catch (const std::exception& exc) {
+	  hppDout (error, "Path optimization failed: " << exc.what ());
+	  break;
+	}
+	{
+	  boost::mutex::scoped_lock lock (pathMutex_);
+	  optimizedPaths_.push_back (path);
+	}
+	publishPath (path);
+      }
+      boost::mutex::scoped_lock lock (pathMutex_);
+      optimizing_ = false;
+    }
+
+    void ProblemSolver::publishPath (const PathVectorPtr_t& path)
+    {
+      PathCallback_t callback;
+      {
+	boost::mutex::scoped_lock lock (pathMutex_);
+	bestPath_ = path;
+	callback = pathCallback_;
       }
+      // Call outside of the lock so that the callback may call bestPath.
+      if (callback) callback (path);
     }
 
     void ProblemSolver::pathValidationType (const std::string& type,
@@ -181,10 +375,60 @@ namespace hpp {
       pathValidationTolerance_ = tolerance;
       // If a robot is present, set path validation method
       if (robot_ && problem_) {
-	PathValidationPtr_t pathValidation =
-	  pathValidationFactory_ [pathValidationType_]
-	  (robot_, pathValidationTolerance_);
-	problem_->pathValidation (pathValidation);
+	problem_->pathValidation (createPathValidation ());
+      }
+    }
+
+    void ProblemSolver::pathValidationCacheSize (std::size_t size)
+    {
+      pathValidationCacheSize_ = size;
+      if (robot_ && problem_) {
+	problem_->pathValidation (createPathValidation ());
+      }
+    }
+
+    PathValidationPtr_t ProblemSolver::createPathValidation () const
+    {
+      PathValidationPtr_t pathValidation =
+	pathValidationFactory_.find (pathValidationType_)->second
+	(robot_, pathValidationTolerance_);
+      if (pathValidationCacheSize_ == 0) return pathValidation;
+      return CachedPathValidation::create (pathValidation,
+					   pathValidationCacheSize_);
+    }
+
+    void ProblemSolver::distanceFieldResolution (value_type resolution)
+    {
+      if (resolution < 0) {
+	throw std::invalid_argument
+	  ("Resolution of the distance field should be non negative.");
+      }
+      distanceFieldResolution_ = resolution;
+      distanceField_.reset ();
+      if (problem_) problem_->distanceField (distanceField_);
+    }
+
+    void ProblemSolver::updateDistanceField ()
+    {
+      if (distanceFieldResolution_ == 0) return;
+      // Obstacles are static between two resolutions: the field is
+      // computed once for all the obstacles added since the last change.
+      if (!distanceField_) {
+	distanceField_ = DistanceField::create (collisionObstacles_,
+						distanceFieldResolution_);
+      }
+      problem_->distanceField (distanceField_);
+    }
+
+    void ProblemSolver::updateJointBounds () const
+    {
+      const std::vector <ConfigValidationPtr_t>& validations
+	(problem_->configValidations ()->validations ());
+      for (std::vector <ConfigValidationPtr_t>::const_iterator it =
+	     validations.begin (); it != validations.end (); ++it) {
+	JointBoundValidationPtr_t jointBounds
+	  (HPP_DYNAMIC_PTR_CAST (JointBoundValidation, *it));
+	if (jointBounds) jointBounds->updateBounds ();
       }
     }
 
@@ -207,6 +451,42 @@ namespace hpp {
       }
     }
 
+    void ProblemSolver::nearestNeighborType (const std::string& type)
+    {
+      if (nearestNeighborFactory_.find (type) ==
+	  nearestNeighborFactory_.end ()) {
+	throw std::runtime_error (std::string ("No nearest neighbor method "
+					       "with name ") + type);
+      }
+      nearestNeighborType_ = type;
+      if (problem_) resetRoadmap ();
+    }
+
+    void ProblemSolver::nearestNeighborEpsilon (const value_type& epsilon)
+    {
+      if (epsilon < 0) {
+	throw std::runtime_error ("Approximation factor of nearest neighbor "
+				  "search should be non negative.");
+      }
+      nearestNeighborEpsilon_ = epsilon;
+      if (roadmap_) roadmap_->nearestNeighbor ()->epsilon (epsilon);
+    }
+
+    void ProblemSolver::multiQuery (bool multiQuery)
+    {
+      multiQuery_ = multiQuery;
+      if (roadmap_) {
+	roadmap_->incrementalSearch (multiQuery);
+	roadmap_->indexEdges (multiQuery);
+      }
+    }
+
+    void ProblemSolver::seed (unsigned int seed)
+    {
+      seed_ = seed;
+      if (problem_) problem_->seed (seed);
+    }
+
     void ProblemSolver::robot (const DevicePtr_t& robot)
     {
       robot_ = robot;
@@ -310,6 +590,7 @@ namespace hpp {
 
     void ProblemSolver::resetProblem ()
     {
+      stopOptimization ();
       if (problem_)
 	delete problem_;
       initializeProblem (new Problem (robot_));
@@ -318,14 +599,12 @@ namespace hpp {
     void ProblemSolver::initializeProblem (ProblemPtr_t problem)
     {
       problem_ = problem;
+      problem_->seed (seed_);
       resetRoadmap ();
       // Set constraints
       problem_->constraints (constraints_);
       // Set path validation method
-      PathValidationPtr_t pathValidation =
-	pathValidationFactory_ [pathValidationType_] (robot_,
-						      pathValidationTolerance_);
-      problem_->pathValidation (pathValidation);
+      problem_->pathValidation (createPathValidation ());
       // Set obstacles
       problem_->collisionObstacles(collisionObstacles_);
       // Distance to obstacles
@@ -339,6 +618,16 @@ namespace hpp {
       if (!problem_)
         throw std::runtime_error ("The problem is not defined.");
       roadmap_ = Roadmap::create (problem_->distance (), problem_->robot());
+      roadmap_->nearestNeighbor (nearestNeighborFactory_ [nearestNeighborType_]
+				 (problem_->robot (), problem_->distance ()));
+      roadmap_->nearestNeighbor ()->epsilon (nearestNeighborEpsilon_);
+      roadmap_->incrementalSearch (multiQuery_);
+      roadmap_->indexEdges (multiQuery_);
+    }
+
+    void ProblemSolver::removeInvalidEdges (const ObjectVector_t& obstacles)
+    {
+      roadmap_->removeInvalidEdges (problem_->pathValidation (), obstacles);
     }
 
     void ProblemSolver::createPathOptimizers ()
@@ -349,15 +638,41 @@ namespace hpp {
 	     ++it) {
 	  PathOptimizerBuilder_t createOptimizer = pathOptimizerFactory_ [*it];
 	  pathOptimizers_.push_back (createOptimizer (*problem_));
+	  pathOptimizers_.back ()->timeOut (optimizerTimeOut_);
 	}
       }
     }
 
-    bool ProblemSolver::prepareSolveStepByStep ()
+    void ProblemSolver::optimizerTimeOut (value_type seconds)
+    {
+      optimizerTimeOut_ = seconds;
+      for (PathOptimizers_t::iterator it = pathOptimizers_.begin ();
+	   it != pathOptimizers_.end (); ++it) {
+	(*it)->timeOut (seconds);
+      }
+    }
+
+    void ProblemSolver::prepareSolveComponents ()
     {
+      SolveComponents components;
+      components.problem = problem_;
+      components.roadmap = roadmap_;
+      components.pathPlannerType = pathPlannerType_;
+      components.configurationShooterType = configurationShooterType_;
+      components.pathProjectorType = pathProjectorType_;
+      components.pathProjectorTolerance = pathProjectorTolerance_;
+      components.portfolioPlannerTypes = portfolioPlannerTypes_;
+      updateDistanceField ();
+      if (keepSolveComponents_ && pathPlanner_ &&
+	  solveComponents_ == components) {
+	return;
+      }
+      updateJointBounds ();
       // Set shooter
-      problem_->configurationShooter
-        (configurationShooterFactory_ [configurationShooterType_] (robot_));
+      ConfigurationShooterPtr_t shooter
+	(configurationShooterFactory_ [configurationShooterType_] (robot_));
+      shooter->seed (problem_->drawSeed ());
+      problem_->configurationShooter (shooter);
       PathPlannerBuilder_t createPlanner =
 	pathPlannerFactory_ [pathPlannerType_];
       pathPlanner_ = createPlanner (*problem_, roadmap_);
@@ -370,6 +685,44 @@ namespace hpp {
       PathProjectorPtr_t pathProjector_ =
         createProjector (problem_->distance (), sm, pathProjectorTolerance_);
       problem_->pathProjector (pathProjector_);
+      if (keepSolveComponents_) solveComponents_ = components;
+    }
+
+    SolverPoolPtr_t ProblemSolver::createSolverPool
+    (std::size_t numberContexts)
+    {
+      if (!problem_)
+        throw std::runtime_error ("The problem is not defined.");
+      updateJointBounds ();
+      SolverPoolPtr_t pool (SolverPool::create
+			    (pathPlannerFactory_ [pathPlannerType_]));
+      for (std::size_t i = 0; i < numberContexts; ++i) {
+	ProblemPtr_t problem (problem_->cloneForThread ());
+	const DevicePtr_t& robot (problem->robot ());
+	ConfigurationShooterPtr_t shooter
+	  (configurationShooterFactory_ [configurationShooterType_] (robot));
+	shooter->seed (problem->drawSeed ());
+	problem->configurationShooter (shooter);
+	// The projector copies the steering method of the clone, that applies
+	// to the clone of the robot.
+	problem->pathProjector (pathProjectorFactory_ [pathProjectorType_]
+				(problem->distance (),
+				 problem->steeringMethod (),
+				 pathProjectorTolerance_));
+	pool->addContext (problem);
+      }
+      for (PathOptimizerTypes_t::const_iterator it =
+	     pathOptimizerTypes_.begin (); it != pathOptimizerTypes_.end ();
+	   ++it) {
+	pool->addPathOptimizer (pathOptimizerFactory_ [*it]);
+      }
+      pool->planningBudget (planningTimeOut_, maxPlanningIterations_);
+      return pool;
+    }
+
+    bool ProblemSolver::prepareSolveStepByStep ()
+    {
+      prepareSolveComponents ();
       // Reset init and goal configurations
       problem_->initConfig (initConf_);
       problem_->resetGoalConfigs ();
@@ -398,25 +751,31 @@ namespace hpp {
       paths_.push_back (pathPlanner_->finishSolve (planned));
     }
 
-    void ProblemSolver::solve ()
+    namespace {
+      /// Write record when a recording solve returns or throws
+      struct RecordWriter
+      {
+	RecordWriter (QueryRecord& record, const std::string& filename) :
+	  record_ (record), filename_ (filename)
+	{
+	  record_.start ();
+	}
+	~RecordWriter ()
+	{
+	  record_.stop ();
+	  try {
+	    record_.write (filename_);
+	  } catch (const std::exception& exc) {
+	    hppDout (error, exc.what ());
+	  }
+	}
+	QueryRecord& record_;
+	const std::string& filename_;
+      }; // struct RecordWriter
+    } // namespace
+
+    void ProblemSolver::setPlanningQuery ()
     {
-      // Set shooter
-      problem_->configurationShooter
-        (configurationShooterFactory_ [configurationShooterType_] (robot_));
-      PathPlannerBuilder_t createPlanner =
-	pathPlannerFactory_ [pathPlannerType_];
-      pathPlanner_ = createPlanner (*problem_, roadmap_);
-      /// create Path projector
-      PathProjectorBuilder_t createProjector =
-        pathProjectorFactory_ [pathProjectorType_];
-      // Create a default steering method until we add a steering method
-      // factory.
-      SteeringMethodPtr_t sm (SteeringMethodStraight::create (robot ()));
-      PathProjectorPtr_t pathProjector_ =
-        createProjector (problem_->distance (), sm, pathProjectorTolerance_);
-      problem_->pathProjector (pathProjector_);
-      /// create Path optimizer
-      // Reset init and goal configurations
       problem_->initConfig (initConf_);
       problem_->resetGoalConfigs ();
       for (Configurations_t::const_iterator itConfig =
@@ -424,13 +783,177 @@ namespace hpp {
 	   itConfig != goalConfigurations_.end (); ++itConfig) {
 	problem_->addGoalConfig (*itConfig);
       }
+      pathPlanner_->timeOut (planningTimeOut_);
+      pathPlanner_->maxIterations (maxPlanningIterations_);
+    }
+
+    void ProblemSolver::solve ()
+    {
+      joinSolveThread ();
+      stopOptimization ();
+      QueryRecord record;
+      boost::shared_ptr <RecordWriter> recordWriter;
+      if (!recordFilename_.empty () && !QueryRecord::active ()) {
+	if (!problem_)
+	  throw std::runtime_error ("The problem is not defined.");
+	record.seed = problem_->drawSeed ();
+	problem_->seed (record.seed);
+	record.pathPlannerType = pathPlannerType_;
+	record.configurationShooterType = configurationShooterType_;
+	record.pathValidationType = pathValidationType_;
+	record.pathValidationTolerance = pathValidationTolerance_;
+	record.pathOptimizerTypes.assign (pathOptimizerTypes_.begin (),
+					  pathOptimizerTypes_.end ());
+	record.maxIterations = maxPlanningIterations_;
+	record.timeOut = planningTimeOut_;
+	if (initConf_) record.initConfig = *initConf_;
+	for (Configurations_t::const_iterator itConfig =
+	       goalConfigurations_.begin ();
+	     itConfig != goalConfigurations_.end (); ++itConfig) {
+	  record.goalConfigs.push_back (**itConfig);
+	}
+	recordWriter.reset (new RecordWriter (record, recordFilename_));
+      }
+      operationCounts_.clear ();
+      bool counting = OperationCounters::enabled ();
+      if (counting) OperationCounters::reset ();
+      prepareSolveComponents ();
+      setPlanningQuery ();
       PathVectorPtr_t path = pathPlanner_->solve ();
       paths_.push_back (path);
-      optimizePath (path);
+      publishPath (path);
+      if (!anytime_) {
+	optimizePath (path);
+	if (counting) operationCounts_ = OperationCounters::values ();
+	return;
+      }
+      if (counting) operationCounts_ = OperationCounters::values ();
+      createPathOptimizers ();
+      {
+	boost::mutex::scoped_lock lock (pathMutex_);
+	optimizing_ = true;
+	stopOptimization_ = false;
+      }
+      optimizationThread_.reset
+	(new boost::thread (boost::bind (&ProblemSolver::runPathOptimizers,
+					 this, path)));
+    }
+
+    void ProblemSolver::joinSolveThread ()
+    {
+      if (!solveThread_) return;
+      if (!solveFuture_->done ()) {
+	throw std::runtime_error ("A query is solved in background.");
+      }
+      solveThread_->join ();
+      solveThread_.reset ();
+    }
+
+    void ProblemSolver::cancellationToken (const CancellationTokenPtr_t& token)
+    {
+      pathPlanner_->cancellationToken (token);
+      for (PathOptimizers_t::iterator it = pathOptimizers_.begin ();
+	   it != pathOptimizers_.end (); ++it) {
+	(*it)->cancellationToken (token);
+      }
+    }
+
+    SolveFuturePtr_t ProblemSolver::solveAsync ()
+    {
+      joinSolveThread ();
+      stopOptimization ();
+      prepareSolveComponents ();
+      setPlanningQuery ();
+      createPathOptimizers ();
+      CancellationTokenPtr_t token (CancellationToken::create ());
+      cancellationToken (token);
+      solveFuture_ = SolveFuturePtr_t (new SolveFuture (pathPlanner_, token));
+      solveThread_.reset
+	(new boost::thread (boost::bind (&ProblemSolver::runSolveAsync, this,
+					 solveFuture_)));
+      return solveFuture_;
+    }
+
+    void ProblemSolver::runSolveAsync (SolveFuturePtr_t future)
+    {
+      SolveFuture::Status status (SolveFuture::SOLVED);
+      std::string error;
+      try {
+	PathVectorPtr_t path;
+	PathPlanner::Status planned (pathPlanner_->trySolve (path));
+	if (planned == PathPlanner::CANCELLED) {
+	  status = SolveFuture::CANCELLED;
+	} else if (planned != PathPlanner::SOLVED) {
+	  status = SolveFuture::FAILED;
+	  error = PathPlanner::statusMessage (planned);
+	} else {
+	  future->publish (path, false);
+	  for (PathOptimizers_t::const_iterator it = pathOptimizers_.begin ();
+	       it != pathOptimizers_.end (); ++it) {
+	    if (future->token_->cancelled ()) break;
+	    path = (*it)->measuredOptimize (path);
+	    future->publish (path, true);
+	  }
+	  if (future->token_->cancelled ()) status = SolveFuture::CANCELLED;
+	}
+      } catch (const std::exception& exc) {
+	status = SolveFuture::FAILED;
+	error = exc.what ();
+      }
+      // Later queries solved by solve should not see the token.
+      cancellationToken (CancellationTokenPtr_t ());
+      future->finish (status, error);
+    }
+
+    QueryRecord ProblemSolver::replay (const std::string& filename,
+				       std::ostream& os)
+    {
+      if (!problem_)
+	throw std::runtime_error ("The problem is not defined.");
+      QueryRecord recorded;
+      recorded.read (filename);
+      pathPlannerType (recorded.pathPlannerType);
+      configurationShooterType (recorded.configurationShooterType);
+      pathValidationType (recorded.pathValidationType,
+			  recorded.pathValidationTolerance);
+      clearPathOptimizers ();
+      for (std::vector <std::string>::const_iterator it =
+	     recorded.pathOptimizerTypes.begin ();
+	   it != recorded.pathOptimizerTypes.end (); ++it) {
+	addPathOptimizer (*it);
+      }
+      maxPlanningIterations (recorded.maxIterations);
+      planningTimeOut (recorded.timeOut);
+      initConfig (ConfigurationPtr_t
+		  (new Configuration_t (recorded.initConfig)));
+      resetGoalConfigs ();
+      for (std::vector <Configuration_t>::const_iterator itConfig =
+	     recorded.goalConfigs.begin ();
+	   itConfig != recorded.goalConfigs.end (); ++itConfig) {
+	addGoalConfig (ConfigurationPtr_t (new Configuration_t (*itConfig)));
+      }
+      if (!multiQuery_) resetRoadmap ();
+      problem_->seed (recorded.seed);
+      QueryRecord replayed (recorded);
+      replayed.start ();
+      try {
+	solve ();
+	waitOptimization ();
+      } catch (...) {
+	replayed.stop ();
+	throw;
+      }
+      replayed.stop ();
+      os << "Recorded query:" << std::endl;
+      recorded.printBreakdown (os);
+      os << "Replayed query:" << std::endl;
+      replayed.printBreakdown (os);
+      return replayed;
     }
 
     void ProblemSolver::interrupt ()
     {
+      if (solveFuture_) solveFuture_->cancel ();
       if (pathPlanner ()) pathPlanner ()->interrupt ();
       for (PathOptimizers_t::iterator it = pathOptimizers_.begin ();
 	   it != pathOptimizers_.end (); ++it) {
@@ -442,14 +965,21 @@ namespace hpp {
 				     bool collision, bool distance)
     {
 
+      // In multi-query mode, edges in collision with the obstacle are
+      // removed once the obstacle is known by the path validation.
+      bool keepRoadmap = multiQuery_ && problem_ && roadmap_;
       if (collision){
 	collisionObstacles_.push_back (object);
-        resetRoadmap ();
+	distanceField_.reset ();
+	if (!keepRoadmap) resetRoadmap ();
       }
       if (distance)
 	distanceObstacles_.push_back (object);
       if (problem ())
         problem ()->addObstacle (object);
+      if (collision && keepRoadmap) {
+	removeInvalidEdges (ObjectVector_t (1, object));
+      }
       if (distanceBetweenObjects_) {
 	distanceBetweenObjects_->addObstacle (object);
       }
@@ -467,6 +997,55 @@ namespace hpp {
       problem ()->removeObstacleFromJoint (joint, object);
     }
 
+    void ProblemSolver::removeObstacle (const std::string& name)
+    {
+      std::map <std::string, CollisionObjectPtr_t>::iterator itObj =
+	obstacleMap_.find (name);
+      if (itObj == obstacleMap_.end () || !itObj->second) {
+	throw std::runtime_error ("No obstacle with name " + name + ".");
+      }
+      CollisionObjectPtr_t object = itObj->second;
+      ObjectVector_t::iterator it = std::find
+	(collisionObstacles_.begin (), collisionObstacles_.end (), object);
+      if (it != collisionObstacles_.end ()) {
+	collisionObstacles_.erase (it);
+	distanceField_.reset ();
+	if (problem_) problem_->removeObstacle (object);
+      }
+      it = std::find (distanceObstacles_.begin (), distanceObstacles_.end (),
+		      object);
+      if (it != distanceObstacles_.end ()) {
+	distanceObstacles_.erase (it);
+	if (distanceBetweenObjects_) {
+	  distanceBetweenObjects_->removeObstacle (object);
+	}
+      }
+      obstacleMap_.erase (itObj);
+    }
+
+    void ProblemSolver::obstacleMoved (const std::string& name)
+    {
+      std::map <std::string, CollisionObjectPtr_t>::iterator itObj =
+	obstacleMap_.find (name);
+      if (itObj == obstacleMap_.end () || !itObj->second) {
+	throw std::runtime_error ("No obstacle with name " + name + ".");
+      }
+      const CollisionObjectPtr_t& object = itObj->second;
+      if (std::find (collisionObstacles_.begin (), collisionObstacles_.end (),
+		     object) != collisionObstacles_.end ()) {
+	distanceField_.reset ();
+	if (problem_) problem_->obstacleMoved (object);
+	if (multiQuery_ && problem_ && roadmap_) {
+	  removeInvalidEdges (ObjectVector_t (1, object));
+	} else {
+	  resetRoadmap ();
+	}
+      }
+      if (distanceBetweenObjects_) {
+	distanceBetweenObjects_->obstacleMoved (object);
+      }
+    }
+
     const CollisionObjectPtr_t& ProblemSolver::obstacle
     (const std::string& name)
     {
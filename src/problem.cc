@@ -16,13 +16,20 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
 
 #include <hpp/util/debug.hh>
+#include <hpp/model/collision-object.hh>
 #include <hpp/model/device.hh>
 #include <hpp/core/collision-validation.hh>
 #include <hpp/core/joint-bound-validation.hh>
 #include <hpp/core/config-validations.hh>
+#include <hpp/core/config-projector.hh>
+#include <hpp/core/constraint-set.hh>
+#include <hpp/core/distance-field.hh>
+#include <hpp/core/path-projector.hh>
 #include <hpp/core/problem.hh>
 #include <hpp/core/steering-method-straight.hh>
 #include <hpp/core/weighed-distance.hh>
@@ -30,6 +37,7 @@
 #include <hpp/core/continuous-collision-checking/dichotomy.hh>
 #include <hpp/core/continuous-collision-checking/progressive.hh>
 #include <hpp/core/basic-configuration-shooter.hh>
+#include <hpp/core/seeded-configuration-shooter.hh>
 
 namespace hpp {
   namespace core {
@@ -44,11 +52,14 @@ namespace hpp {
       configValidations_ (ConfigValidations::create ()),
       pathValidation_ (DiscretizedCollisionChecking::create
 		       (robot, 0.05)),
-      collisionObstacles_ (), constraints_ (),
-      configurationShooter_(BasicConfigurationShooter::create (robot))
+      collisionObstacles_ (), distanceField_ (), constraints_ (),
+      configurationShooter_(BasicConfigurationShooter::create (robot)),
+      generator_ ()
     {
-      configValidations_->add (CollisionValidation::create (robot));
+      configurationShooter_->seed (drawSeed ());
+      // Joint bounds are cheaper to check than collisions.
       configValidations_->add (JointBoundValidation::create (robot));
+      configValidations_->add (CollisionValidation::create (robot));
     }
 
     // ======================================================================
@@ -134,6 +145,60 @@ namespace hpp {
 
     // ======================================================================
 
+    void Problem::removeObstacle (const CollisionObjectPtr_t& object)
+    {
+      ObjectVector_t::iterator it = std::find
+	(collisionObstacles_.begin (), collisionObstacles_.end (), object);
+      if (it == collisionObstacles_.end ()) {
+	throw std::runtime_error ("Object " + object->name () +
+				  " is not an obstacle of the problem.");
+      }
+      collisionObstacles_.erase (it);
+      if (pathValidation_) {
+	pathValidation_->removeObstacle (object);
+      }
+      if (configValidations_) {
+	configValidations_->removeObstacle (object);
+      }
+    }
+
+    // ======================================================================
+
+    void Problem::obstacleMoved (const CollisionObjectPtr_t& object)
+    {
+      if (std::find (collisionObstacles_.begin (), collisionObstacles_.end (),
+		     object) == collisionObstacles_.end ()) {
+	throw std::runtime_error ("Object " + object->name () +
+				  " is not an obstacle of the problem.");
+      }
+      if (pathValidation_) {
+	pathValidation_->obstacleMoved (object);
+      }
+      if (configValidations_) {
+	configValidations_->obstacleMoved (object);
+      }
+      // Validations drop the field computed at the previous position.
+      if (distanceField_ && distanceField_->contains (object)) {
+	distanceField_.reset ();
+      }
+    }
+
+    // ======================================================================
+
+    void Problem::distanceField (const DistanceFieldPtr_t& field)
+    {
+      if (field == distanceField_) return;
+      distanceField_ = field;
+      if (pathValidation_) {
+	pathValidation_->distanceField (field);
+      }
+      if (configValidations_) {
+	configValidations_->distanceField (field);
+      }
+    }
+
+    // ======================================================================
+
     void Problem::pathValidation (const PathValidationPtr_t& pathValidation)
     {
       pathValidation_ = pathValidation;
@@ -142,6 +207,7 @@ namespace hpp {
 	   it != collisionObstacles_.end (); ++it) {
 	pathValidation_->addObstacle (*it);
       }
+      if (distanceField_) pathValidation_->distanceField (distanceField_);
     }
 
     // ======================================================================
@@ -153,6 +219,14 @@ namespace hpp {
 
     // ======================================================================
 
+    void Problem::seed (unsigned int seed)
+    {
+      generator_.seed (seed);
+      if (configurationShooter_) configurationShooter_->seed (drawSeed ());
+    }
+
+    // ======================================================================
+
     void Problem::checkProblem () const
     {
       if (!robot ()) {
@@ -193,5 +267,118 @@ namespace hpp {
 
     // ======================================================================
 
+    ProblemPtr_t Problem::cloneForThread () const
+    {
+      DevicePtr_t robot (robot_->clone ());
+      // Methods that may not be copied are copied first, so that the
+      // problem is not created if one of them cannot be copied.
+      ConfigValidationsPtr_t configValidations;
+      if (configValidations_) {
+	configValidations = HPP_DYNAMIC_PTR_CAST
+	  (ConfigValidations, configValidations_->copy (robot));
+	if (!configValidations) {
+	  throw std::runtime_error
+	    ("Configuration validation methods cannot be copied.");
+	}
+      }
+      PathValidationPtr_t pathValidation;
+      if (pathValidation_) {
+	pathValidation = pathValidation_->copy (robot);
+	if (!pathValidation) {
+	  throw std::runtime_error ("Path validation method cannot be copied.");
+	}
+      }
+      ConstraintSetPtr_t constraints;
+      if (constraints_) {
+	for (Constraints_t::iterator it = constraints_->begin ();
+	     it != constraints_->end (); ++it) {
+	  // The trivial projector of a set is created by ConstraintSet.
+	  if (!HPP_DYNAMIC_PTR_CAST (ConfigProjector, *it)) {
+	    throw std::runtime_error ("Constraints cannot be copied.");
+	  }
+	}
+	constraints = ConstraintSet::create (robot, constraints_->name ());
+	ConfigProjectorPtr_t configProjector
+	  (constraints_->configProjector ());
+	if (configProjector) {
+	  ConfigProjectorPtr_t copy (configProjector->copy (robot));
+	  if (!copy) {
+	    throw std::runtime_error ("Numerical constraints without function "
+				      "builder cannot be copied.");
+	  }
+	  constraints->addConstraint (copy);
+	}
+      }
+      DistancePtr_t distance;
+      WeighedDistancePtr_t weighedDistance
+	(HPP_DYNAMIC_PTR_CAST (WeighedDistance, distance_));
+      if (weighedDistance) {
+	std::vector <value_type> weights (weighedDistance->size ());
+	for (std::size_t i = 0; i < weights.size (); ++i) {
+	  weights [i] = weighedDistance->getWeight (i);
+	}
+	weighedDistance = WeighedDistance::create (robot, weights);
+	distance = weighedDistance;
+      } else {
+	distance = distance_->clone ();
+      }
+      SteeringMethodPtr_t steeringMethod;
+      if (HPP_DYNAMIC_PTR_CAST (SteeringMethodStraight, steeringMethod_)) {
+	if (weighedDistance) {
+	  steeringMethod = SteeringMethodStraight::create
+	    (robot, weighedDistance);
+	} else {
+	  steeringMethod = SteeringMethodStraight::create (robot);
+	}
+      } else {
+	steeringMethod = steeringMethod_->copy ();
+      }
+      // The projector builds paths with its own copy of the steering method
+      // and has mutable workspaces.
+      PathProjectorPtr_t pathProjector;
+      if (pathProjector_) {
+	pathProjector = pathProjector_->copy (distance, steeringMethod);
+	if (!pathProjector) {
+	  throw std::runtime_error ("Path projector cannot be copied.");
+	}
+      }
+      Problem* problem = new Problem (robot);
+      problem->distance (distance);
+      problem->steeringMethod (steeringMethod);
+      if (constraints) problem->constraints (constraints);
+      problem->configValidation (configValidations);
+      problem->pathValidation (pathValidation);
+      problem->collisionObstacles (collisionObstacles_);
+      // The field is only read by validations.
+      problem->distanceField (distanceField_);
+      SeededConfigurationShooterPtr_t seeded
+	(HPP_DYNAMIC_PTR_CAST (SeededConfigurationShooter,
+			       configurationShooter_));
+      if (HPP_DYNAMIC_PTR_CAST (BasicConfigurationShooter,
+				configurationShooter_)) {
+	problem->configurationShooter (BasicConfigurationShooter::create
+				       (robot));
+      } else if (seeded) {
+	problem->configurationShooter (seeded->copy (robot));
+      } else {
+	problem->configurationShooter (configurationShooter_);
+      }
+      problem->pathProjector (pathProjector);
+      problem->seed (drawSeed ());
+      if (initConf_) {
+	problem->initConfig (ConfigurationPtr_t
+			     (new Configuration_t (*initConf_)));
+      }
+      for (Configurations_t::const_iterator itGoal =
+	     goalConfigurations_.begin ();
+	   itGoal != goalConfigurations_.end (); ++itGoal) {
+	problem->addGoalConfig (ConfigurationPtr_t
+				(new Configuration_t (**itGoal)));
+      }
+      return problem;
+    }
+
+    // ======================================================================
+
   } // namespace core
 } // namespace hpp
@@ -0,0 +1,110 @@
+//
+// Copyright (c) 2016 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+#include <vector>
+#include <hpp/model/configuration.hh>
+#include <hpp/model/device.hh>
+#include <hpp/core/config-validations.hh>
+#include <hpp/core/constraint-set.hh>
+#include <hpp/core/distance.hh>
+#include <hpp/core/interpolated-path.hh>
+#include <hpp/core/projected-steering.hh>
+
+namespace hpp {
+  namespace core {
+    ProjectedSteeringPtr_t ProjectedSteering::create
+    (const DevicePtr_t& robot, const DistancePtr_t& distance,
+     const ConfigValidationsPtr_t& validations, value_type step)
+    {
+      return ProjectedSteeringPtr_t
+	(new ProjectedSteering (robot, distance, validations, step));
+    }
+
+    ProjectedSteering::ProjectedSteering
+    (const DevicePtr_t& robot, const DistancePtr_t& distance,
+     const ConfigValidationsPtr_t& validations, value_type step) :
+      robot_ (robot), distance_ (distance), validations_ (validations),
+      step_ (step)
+    {
+      assert (step_ > 0);
+    }
+
+    bool ProjectedSteering::operator() (ConfigurationIn_t q1,
+					ConfigurationIn_t q2,
+					const ConstraintSetPtr_t& constraints,
+					PathPtr_t& validPart) const
+    {
+      const Distance& d (*distance_);
+      const std::size_t maxDichotomyTries = 10;
+      const std::size_t maxSamples = 2 + (std::size_t)
+	(10 * d (q1, q2) / step_);
+      // Valid samples and distances from the previous one
+      std::vector <Configuration_t> samples;
+      std::vector <value_type> lengths;
+      Configuration_t qb (q1), q (q1.size ());
+      ValidationReportPtr_t report;
+      bool reached = false;
+      while (samples.size () < maxSamples) {
+	const value_type remaining = d (qb, q2);
+	if (remaining <= step_) {
+	  q = q2;
+	  reached = validations_->validate (q, report);
+	  if (reached) lengths.push_back (remaining);
+	  break;
+	}
+	// Halve the step until the projection is not too far
+	value_type u = step_ / remaining, l = 0;
+	bool found = false;
+	for (std::size_t k = 0; k < maxDichotomyTries && !found; ++k) {
+	  model::interpolate (robot_, qb, q2, u, q);
+	  if (!constraints || constraints->apply (q)) {
+	    l = d (qb, q);
+	    found = (l <= step_ && l >= 1e-3);
+	  }
+	  u /= 2;
+	}
+	if (!found) break;
+	// The constraints were last evaluated at q, the robot is already in
+	// this configuration for the validation.
+	if (!validations_->validate (q, report)) break;
+	samples.push_back (q);
+	lengths.push_back (l);
+	qb = q;
+      }
+      // Build the path through the valid samples
+      if (!reached && !samples.empty ()) {
+	q = samples.back ();
+	samples.pop_back ();
+      } else if (!reached) {
+	q = q1;
+      }
+      value_type length = 0;
+      for (std::size_t i = 0; i < lengths.size (); ++i) length += lengths [i];
+      InterpolatedPathPtr_t path = InterpolatedPath::create
+	(robot_, q1, q, length, constraints);
+      value_type t = 0;
+      for (std::size_t i = 0; i < samples.size (); ++i) {
+	t += lengths [i];
+	path->insert (t, samples [i]);
+      }
+      validPart = path;
+      return reached;
+    }
+  } //   namespace core
+} // namespace hpp
@@ -0,0 +1,275 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include <boost/thread/tss.hpp>
+#include <hpp/core/query-record.hh>
+
+namespace hpp {
+  namespace core {
+    namespace {
+      const char magic [4] = {'H', 'P', 'P', 'Q'};
+      const boost::uint32_t version = 1;
+
+      // Records are owned by the caller of QueryRecord::start
+      void doNotDelete (QueryRecord*)
+      {
+      }
+      boost::thread_specific_ptr <QueryRecord> activeRecord (&doNotDelete);
+
+      boost::uint32_t microseconds (const boost::posix_time::time_duration& d)
+      {
+	boost::int64_t us = d.total_microseconds ();
+	if (us < 0) return 0;
+	if (us > std::numeric_limits <boost::uint32_t>::max ()) {
+	  return std::numeric_limits <boost::uint32_t>::max ();
+	}
+	return (boost::uint32_t) us;
+      }
+
+      // Values are stored with the byte order of the machine.
+      template <typename T> void writeValue (std::ostream& os, const T& value)
+      {
+	os.write (reinterpret_cast <const char*> (&value), sizeof (T));
+      }
+
+      template <typename T> void readValue (std::istream& is, T& value)
+      {
+	is.read (reinterpret_cast <char*> (&value), sizeof (T));
+	if (!is) throw std::runtime_error ("Truncated query record.");
+      }
+
+      void writeString (std::ostream& os, const std::string& s)
+      {
+	writeValue (os, (boost::uint32_t) s.size ());
+	os.write (s.data (), s.size ());
+      }
+
+      void readString (std::istream& is, std::string& s)
+      {
+	boost::uint32_t size;
+	readValue (is, size);
+	s.resize (size);
+	if (size > 0) is.read (&s [0], size);
+	if (!is) throw std::runtime_error ("Truncated query record.");
+      }
+
+      void writeConfig (std::ostream& os, const Configuration_t& q)
+      {
+	writeValue (os, (boost::uint32_t) q.size ());
+	for (size_type i = 0; i < q.size (); ++i) writeValue (os, q [i]);
+      }
+
+      void readConfig (std::istream& is, Configuration_t& q)
+      {
+	boost::uint32_t size;
+	readValue (is, size);
+	q.resize (size);
+	for (size_type i = 0; i < q.size (); ++i) readValue (is, q [i]);
+      }
+
+      const char* names [QueryRecord::NUMBER_EVENT_TYPES] = {
+	"sample",
+	"extension",
+	"configuration validation",
+	"path validation",
+	"direct path",
+	"one step",
+	"compute path",
+	"path optimization"
+      };
+    } // namespace
+
+    boost::atomic <std::size_t> QueryRecord::numberActive_ (0);
+
+    QueryRecord::QueryRecord () : seed (0), pathPlannerType (),
+      configurationShooterType (), pathValidationType (),
+      pathValidationTolerance (0), pathOptimizerTypes (), maxIterations (0),
+      timeOut (std::numeric_limits <value_type>::infinity ()), initConfig (),
+      goalConfigs (), events (), start_ ()
+    {
+    }
+
+    QueryRecord::~QueryRecord ()
+    {
+      stop ();
+    }
+
+    void QueryRecord::start ()
+    {
+      if (activeRecord.get ()) {
+	throw std::runtime_error
+	  ("A query record is already active in this thread.");
+      }
+      events.clear ();
+      start_ = now ();
+      activeRecord.reset (this);
+      ++numberActive_;
+    }
+
+    void QueryRecord::stop ()
+    {
+      if (activeRecord.get () != this) return;
+      activeRecord.reset ();
+      --numberActive_;
+    }
+
+    QueryRecord* QueryRecord::activeInThread ()
+    {
+      return activeRecord.get ();
+    }
+
+    void QueryRecord::add (EventType type, bool success,
+			   const boost::posix_time::ptime& start)
+    {
+      Event event;
+      event.type = (boost::uint8_t) type;
+      event.success = success;
+      event.start = microseconds (start - start_);
+      event.duration = microseconds (now () - start);
+      events.push_back (event);
+    }
+
+    void QueryRecord::write (const std::string& filename) const
+    {
+      std::ofstream os (filename.c_str (), std::ios::binary);
+      if (!os) {
+	throw std::runtime_error ("Cannot open " + filename + " for writing.");
+      }
+      os.write (magic, sizeof (magic));
+      writeValue (os, version);
+      writeValue (os, (boost::uint32_t) seed);
+      writeString (os, pathPlannerType);
+      writeString (os, configurationShooterType);
+      writeString (os, pathValidationType);
+      writeValue (os, pathValidationTolerance);
+      writeValue (os, (boost::uint32_t) pathOptimizerTypes.size ());
+      for (std::size_t i = 0; i < pathOptimizerTypes.size (); ++i) {
+	writeString (os, pathOptimizerTypes [i]);
+      }
+      writeValue (os, (boost::int64_t) maxIterations);
+      writeValue (os, timeOut);
+      writeConfig (os, initConfig);
+      writeValue (os, (boost::uint32_t) goalConfigs.size ());
+      for (std::size_t i = 0; i < goalConfigs.size (); ++i) {
+	writeConfig (os, goalConfigs [i]);
+      }
+      writeValue (os, (boost::uint64_t) events.size ());
+      for (Events_t::const_iterator it = events.begin (); it != events.end ();
+	   ++it) {
+	writeValue (os, it->type);
+	writeValue (os, (boost::uint8_t) it->success);
+	writeValue (os, it->start);
+	writeValue (os, it->duration);
+      }
+      if (!os) throw std::runtime_error ("Cannot write " + filename + ".");
+    }
+
+    void QueryRecord::read (const std::string& filename)
+    {
+      std::ifstream is (filename.c_str (), std::ios::binary);
+      if (!is) {
+	throw std::runtime_error ("Cannot open " + filename + " for reading.");
+      }
+      char m [sizeof (magic)];
+      boost::uint32_t v;
+      is.read (m, sizeof (m));
+      if (!is || !std::equal (m, m + sizeof (m), magic)) {
+	throw std::runtime_error (filename + " is not a query record.");
+      }
+      readValue (is, v);
+      if (v != version) {
+	throw std::runtime_error ("Unsupported version of query record " +
+				  filename + ".");
+      }
+      boost::uint32_t n;
+      readValue (is, n);
+      seed = n;
+      readString (is, pathPlannerType);
+      readString (is, configurationShooterType);
+      readString (is, pathValidationType);
+      readValue (is, pathValidationTolerance);
+      readValue (is, n);
+      pathOptimizerTypes.resize (n);
+      for (std::size_t i = 0; i < pathOptimizerTypes.size (); ++i) {
+	readString (is, pathOptimizerTypes [i]);
+      }
+      boost::int64_t iterations;
+      readValue (is, iterations);
+      maxIterations = (size_type) iterations;
+      readValue (is, timeOut);
+      readConfig (is, initConfig);
+      readValue (is, n);
+      goalConfigs.resize (n);
+      for (std::size_t i = 0; i < goalConfigs.size (); ++i) {
+	readConfig (is, goalConfigs [i]);
+      }
+      boost::uint64_t size;
+      readValue (is, size);
+      events.resize (size);
+      for (Events_t::iterator it = events.begin (); it != events.end ();
+	   ++it) {
+	boost::uint8_t success;
+	readValue (is, it->type);
+	readValue (is, success);
+	readValue (is, it->start);
+	readValue (is, it->duration);
+	if (it->type >= NUMBER_EVENT_TYPES) {
+	  throw std::runtime_error ("Wrong event type in query record " +
+				    filename + ".");
+	}
+	it->success = success;
+      }
+    }
+
+    std::ostream& QueryRecord::printBreakdown (std::ostream& os) const
+    {
+      std::vector <std::size_t> count (NUMBER_EVENT_TYPES, 0);
+      std::vector <std::size_t> success (NUMBER_EVENT_TYPES, 0);
+      std::vector <double> total (NUMBER_EVENT_TYPES, 0);
+      for (Events_t::const_iterator it = events.begin (); it != events.end ();
+	   ++it) {
+	++count [it->type];
+	if (it->success) ++success [it->type];
+	total [it->type] += it->duration;
+      }
+      os << std::left << std::setw (28) << "event" << std::right
+	 << std::setw (10) << "number" << std::setw (10) << "success"
+	 << std::setw (14) << "total (ms)" << std::setw (14) << "mean (us)"
+	 << std::endl;
+      for (std::size_t i = 0; i < NUMBER_EVENT_TYPES; ++i) {
+	if (count [i] == 0) continue;
+	os << std::left << std::setw (28) << names [i] << std::right
+	   << std::setw (10) << count [i] << std::setw (10) << success [i]
+	   << std::setw (14) << total [i] * 1e-3
+	   << std::setw (14) << total [i] / count [i] << std::endl;
+      }
+      return os;
+    }
+
+    const char* QueryRecord::name (EventType type)
+    {
+      return names [type];
+    }
+  } // namespace core
+} // namespace hpp
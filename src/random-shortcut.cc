@@ -16,33 +16,168 @@
 // hpp-core  If not, see
 // <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
 #include <limits>
 #include <deque>
-#include <cstdlib>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
 #include <hpp/util/assertion.hh>
 #include <hpp/util/debug.hh>
 #include <hpp/core/distance.hh>
+#include <hpp/core/path-cost.hh>
+#include <hpp/core/path-projector.hh>
 #include <hpp/core/path-validation.hh>
 #include <hpp/core/path-vector.hh>
 #include <hpp/core/problem.hh>
 #include <hpp/core/random-shortcut.hh>
+#include <hpp/core/steering-method.hh>
+#include <hpp/core/trace.hh>
 
 namespace hpp {
   namespace core {
-    // Compute the length of a vector of paths assuming that each element
-    // is optimal for the given distance.
-    static value_type pathLength (const PathVectorPtr_t& path,
-				  const DistancePtr_t& distance)
-    {
-      value_type result = 0;
-      for (std::size_t i=0; i<path->numberPaths (); ++i) {
-	const PathPtr_t& element (path->pathAtRank (i));
-	Configuration_t q1 = element->initial ();
-	Configuration_t q2 = element->end ();
-	result += (*distance) (q1, q2);
+    namespace {
+      /// Shortcuts between configurations at two random parameters
+      struct Candidate
+      {
+	value_type t1, t2;
+	Configuration_t q1, q2;
+	PathPtr_t straight [3];
+	bool valid [3];
+	/// Lengths of the valid shortcuts
+	value_type lengths [3];
+	/// Length of the path with the valid shortcuts
+	value_type length;
+      }; // struct Candidate
+      typedef std::vector <Candidate> Candidates_t;
+
+      // Steer between two configurations with the objects of a problem,
+      // reusing the storage of the previous path if possible.
+      bool steer (const Problem& problem, ConfigurationIn_t q1,
+		  ConfigurationIn_t q2, PathPtr_t& path)
+      {
+	const SteeringMethodPtr_t& sm (problem.steeringMethod ());
+	if (!problem.pathProjector ()) return (*sm) (q1, q2, path);
+	PathPtr_t dp = (*sm) (q1, q2);
+	path.reset ();
+	if (dp) {
+	  PathPtr_t pp;
+	  if (problem.pathProjector ()->apply (dp, pp)) path = pp;
+	}
+	return path;
+      }
+
+      // Steer and validate the shortcuts of candidates of rank thread,
+      // thread + nbThreads, ... with the objects of a problem
+      void evaluateCandidates (const Problem* problem, std::size_t thread,
+			       std::size_t nbThreads,
+			       const Configuration_t* q0,
+			       const Configuration_t* q3,
+			       Candidates_t* candidates, std::string* error)
+      {
+	try {
+	  PathValidationPtr_t pathValidation (problem->pathValidation ());
+	  for (std::size_t k = thread; k < candidates->size ();
+	       k += nbThreads) {
+	    Candidate& c ((*candidates) [k]);
+	    steer (*problem, *q0, c.q1, c.straight [0]);
+	    steer (*problem, c.q1, c.q2, c.straight [1]);
+	    steer (*problem, c.q2, *q3, c.straight [2]);
+	    for (unsigned i=0; i<3; ++i) {
+	      PathPtr_t validPart;
+	      PathValidationReportPtr_t report;
+	      if (!c.straight [i]) c.valid [i] = false;
+	      else {
+		c.valid [i] = pathValidation->validate
+		  (c.straight [i], false, validPart, report);
+	      }
+	    }
+	  }
+	} catch (const std::exception& exc) {
+	  *error = exc.what ();
+	}
       }
-      return result;
-    }
+
+      // Length of a path: its cost if a cost is given, otherwise the
+      // distance between its ends, assuming that the path is optimal for
+      // the distance.
+      value_type pathLength (const PathPtr_t& path, const Distance& d,
+			     const PathCost* cost)
+      {
+	if (cost) return (*cost) (path);
+	return d (path->initial (), path->end ());
+      }
+
+      // Compute the length of each element of a vector of paths
+      void elementLengths (const PathVectorPtr_t& path,
+			   const Distance& distance, const PathCost* cost,
+			   std::vector <value_type>& lengths)
+      {
+	lengths.resize (path->numberPaths ());
+	for (std::size_t i=0; i<path->numberPaths (); ++i) {
+	  lengths [i] = pathLength (path->pathAtRankNoCopy (i), distance,
+				    cost);
+	}
+      }
+
+      // Length of the part of a path between parameters a and b, the
+      // configurations of which are qa and qb.
+      // cumulated [i] is the length of the elements of rank smaller than i.
+      // With a cost, only the elements that contain a and b are evaluated.
+      value_type partLength (const PathVectorPtr_t& path,
+			     const std::vector <value_type>& cumulated,
+			     const Distance& d, const PathCost* cost,
+			     value_type a, ConfigurationIn_t qa,
+			     value_type b, ConfigurationIn_t qb)
+      {
+	value_type la, lb;
+	std::size_t ia = path->rankAtParam (a, la);
+	std::size_t ib = path->rankAtParam (b, lb);
+	const PathPtr_t& ea (path->pathAtRankNoCopy (ia));
+	const PathPtr_t& eb (path->pathAtRankNoCopy (ib));
+	if (cost) {
+	  if (ia == ib) return (*cost) (ea->extract (interval_t (la, lb)));
+	  return (*cost) (ea->extract (interval_t
+				       (la, ea->timeRange ().second))) +
+	    cumulated [ib] - cumulated [ia + 1] +
+	    (*cost) (eb->extract (interval_t (eb->timeRange ().first, lb)));
+	}
+	if (ia == ib) return d (qa, qb);
+	return d (qa, ea->end ()) + cumulated [ib] - cumulated [ia + 1] +
+	  d (eb->initial (), qb);
+      }
+
+      // Append the part of a path between parameters a and b to result.
+      // Elements of the path that are entirely in the part are shared, only
+      // the first and last ones are extracted.
+      void appendPart (const PathVectorPtr_t& path,
+		       const std::vector <value_type>& lengths,
+		       const Distance& d, const PathCost* cost,
+		       value_type a, value_type b,
+		       const PathVectorPtr_t& result,
+		       std::vector <value_type>& resultLengths)
+      {
+	value_type la, lb;
+	std::size_t ia = path->rankAtParam (a, la);
+	std::size_t ib = path->rankAtParam (b, lb);
+	for (std::size_t i = ia; i <= ib; ++i) {
+	  const PathPtr_t& element (path->pathAtRankNoCopy (i));
+	  interval_t range (element->timeRange ());
+	  if (i == ia) range.first = la;
+	  if (i == ib) range.second = lb;
+	  if (range == element->timeRange ()) {
+	    result->appendPath (element);
+	    resultLengths.push_back (lengths [i]);
+	  } else {
+	    PathPtr_t part (element->extract (range));
+	    result->appendPath (part);
+	    resultLengths.push_back (pathLength (part, d, cost));
+	  }
+	}
+      }
+    } // namespace
 
     RandomShortcutPtr_t
     RandomShortcut::create (const Problem& problem)
@@ -52,14 +187,22 @@ namespace hpp {
     }
 
     RandomShortcut::RandomShortcut (const Problem& problem) :
-      PathOptimizer (problem)
+      PathOptimizer (problem), numberCandidates_ (1), threadProblems_ (),
+      cost_ (), generator_ (problem.drawSeed ())
     {
     }
 
+    value_type RandomShortcut::uniform ()
+    {
+      // 32 random bits are enough for sampling.
+      return (value_type) generator_ () / 4294967296.;
+    }
+
     PathVectorPtr_t RandomShortcut::optimize (const PathVectorPtr_t& path)
     {
+      TraceScope trace ("RandomShortcut::optimize");
       using std::numeric_limits;
-      using std::make_pair;
+      startOptimization ();
       bool finished = false;
       value_type t3 = path->timeRange ().second;
       Configuration_t q0 = path->initial ();
@@ -68,65 +211,108 @@ namespace hpp {
 
       // Maximal number of iterations without improvements
       const std::size_t n = 5;
+      const Distance& d (*problem ().distance ());
+      const PathCost* cost (cost_.get ());
+      // Lengths of the elements of tmpPath and cumulated lengths, updated
+      // with the elements that change at each iteration.
+      std::vector <value_type> lengths, resultLengths, cumulated;
+      elementLengths (tmpPath, d, cost, lengths);
+      cumulated.resize (lengths.size () + 1);
+      cumulated [0] = 0;
+      std::partial_sum (lengths.begin (), lengths.end (),
+			cumulated.begin () + 1);
       std::deque <value_type> length (n-1,
 				      numeric_limits <value_type>::infinity ());
-      length.push_back (pathLength (tmpPath, problem ().distance ()));
-      PathVectorPtr_t result;
-      Configuration_t q1 (path->outputSize ()),
-                      q2 (path->outputSize ());
+      length.push_back (cumulated.back ());
+      PathVectorPtr_t result (path);
+      // Shortcuts that are not kept in the result are reused at next
+      // iteration.
+      Candidates_t candidates (numberCandidates_);
+      for (std::size_t k = 0; k < candidates.size (); ++k) {
+	candidates [k].q1.resize (path->outputSize ());
+	candidates [k].q2.resize (path->outputSize ());
+      }
+      const std::size_t nbThreads = threadProblems_.size ();
+      std::vector <std::string> errors (std::max (nbThreads,
+						  (std::size_t) 1));
 
-      while (!finished) {
+      while (!finished && !stopOptimization ()) {
 	t3 = tmpPath->timeRange ().second;
-	value_type u2 = t3 * rand ()/RAND_MAX;
-	value_type u1 = t3 * rand ()/RAND_MAX;
-	value_type t1, t2;
-	if (u1 < u2) {t1 = u1; t2 = u2;} else {t1 = u2; t2 = u1;}
-	if (!(*tmpPath) (q1, t1)) {
-          hppDout (error, "Configuration at param " << t1 << " could not be "
-              "projected");
-        }
-	if (!(*tmpPath) (q2, t2)) {
-          hppDout (error, "Configuration at param " << t1 << " could not be "
-              "projected");
-        }
+	for (std::size_t k = 0; k < candidates.size (); ++k) {
+	  Candidate& c (candidates [k]);
+	  value_type u2 = t3 * uniform ();
+	  value_type u1 = t3 * uniform ();
+	  if (u1 < u2) {c.t1 = u1; c.t2 = u2;} else {c.t1 = u2; c.t2 = u1;}
+	  if (!(*tmpPath) (c.q1, c.t1)) {
+	    hppDout (error, "Configuration at param " << c.t1 << " could not "
+		     "be projected");
+	  }
+	  if (!(*tmpPath) (c.q2, c.t2)) {
+	    hppDout (error, "Configuration at param " << c.t2 << " could not "
+		     "be projected");
+	  }
+	}
 	// Validate sub parts
-	bool valid [3];
-	PathPtr_t straight [3];
-	straight [0] = steer (q0, q1);
-	straight [1] = steer (q1, q2);
-	straight [2] = steer (q2, q3);
-	for (unsigned i=0; i<3; ++i) {
-	  PathPtr_t validPart;
-	  PathValidationReportPtr_t report;
-          if (!straight [i]) valid[i] = false;
-          else {
-            valid [i] = problem ().pathValidation ()->validate
-              (straight [i], false, validPart, report);
-          }
+	if (nbThreads == 0) {
+	  evaluateCandidates (&problem (), 0, 1, &q0, &q3, &candidates,
+			      &errors [0]);
+	} else {
+	  boost::thread_group threads;
+	  for (std::size_t thread = 0; thread < nbThreads; ++thread) {
+	    threads.create_thread
+	      (boost::bind (&evaluateCandidates, threadProblems_ [thread],
+			    thread, nbThreads, &q0, &q3, &candidates,
+			    &errors [thread]));
+	  }
+	  threads.join_all ();
 	}
-	// Replace valid parts
+	for (std::size_t thread = 0; thread < errors.size (); ++thread) {
+	  if (!errors [thread].empty ()) {
+	    throw std::runtime_error (errors [thread]);
+	  }
+	}
+	// Compute the length each candidate would give, without building
+	// the path.
+	std::size_t best = 0;
+	for (std::size_t k = 0; k < candidates.size (); ++k) {
+	  Candidate& c (candidates [k]);
+	  const value_type times [4] = { 0, c.t1, c.t2, t3 };
+	  const Configuration_t* configs [4] = { &q0, &c.q1, &c.q2, &q3 };
+	  c.length = 0;
+	  for (unsigned i=0; i<3; ++i) {
+	    if (c.valid [i]) {
+	      c.lengths [i] = pathLength (c.straight [i], d, cost);
+	      c.length += c.lengths [i];
+	    } else {
+	      c.length += partLength (tmpPath, cumulated, d, cost,
+				      times [i], *configs [i],
+				      times [i+1], *configs [i+1]);
+	    }
+	  }
+	  if (c.length < candidates [best].length) best = k;
+	}
+	// Replace valid parts of the best candidate
+	const Candidate& c (candidates [best]);
+	const value_type times [4] = { 0, c.t1, c.t2, t3 };
 	result = PathVector::create (path->outputSize (),
 				     path->outputDerivativeSize ());
-	if (valid [0])
-	  result->appendPath (straight [0]);
-	else
-	  result->concatenate (*(tmpPath->extract
-				 (make_pair <value_type,value_type> (0, t1))->
-				 as <PathVector> ()));
-	if (valid [1])
-	  result->appendPath (straight [1]);
-	else
-	  result->concatenate (*(tmpPath->extract
-				 (make_pair <value_type,value_type> (t1, t2))->
-				 as <PathVector> ()));
-	if (valid [2])
-	  result->appendPath (straight [2]);
-	else
-	  result->concatenate (*(tmpPath->extract
-				(make_pair <value_type, value_type> (t2, t3))->
-				 as <PathVector> ()));
-	length.push_back (pathLength (result, problem ().distance ()));
+	resultLengths.clear ();
+	for (unsigned i=0; i<3; ++i) {
+	  if (c.valid [i]) {
+	    result->appendPath (c.straight [i]);
+	    resultLengths.push_back (c.lengths [i]);
+	  } else {
+	    appendPart (tmpPath, lengths, d, cost, times [i], times [i+1],
+			result, resultLengths);
+	  }
+	}
+	lengths.swap (resultLengths);
+	cumulated.resize (lengths.size () + 1);
+	std::partial_sum (lengths.begin (), lengths.end (),
+			  cumulated.begin () + 1);
+	length.push_back (cumulated.back ());
 	length.pop_front ();
+	iterationDone (cumulated.back ());
 	finished = (length [0] <= length [n-1]);
 	hppDout (info, "length = " << length [n-1]);
 	tmpPath = result;
@@ -17,19 +17,114 @@
 // <http://www.gnu.org/licenses/>.
 
 #include <algorithm>
+#include <deque>
+#include <functional>
+#include <map>
+#include <queue>
+#include <set>
+#include <stdexcept>
 #include <hpp/util/debug.hh>
+#include <hpp/fcl/collision_object.h>
+#include <hpp/model/collision-object.hh>
 #include <hpp/model/configuration.hh>
 #include <hpp/core/connected-component.hh>
 #include <hpp/core/edge.hh>
 #include <hpp/core/node.hh>
+#include <hpp/core/operation-counters.hh>
 #include <hpp/core/path.hh>
+#include <hpp/core/path-validation.hh>
+#include <hpp/core/path-validation-report.hh>
 #include <hpp/core/roadmap.hh>
-#include <../src/nearest-neighbor/basic.hh>
+#include <hpp/core/swept-volume.hh>
+#include <hpp/core/weighed-distance.hh>
+#include "../src/nearest-neighbor/basic.hh"
+#include "../src/nearest-neighbor/k-d-tree.hh"
+#include "edge-index.hh"
+#include "goal-index.hh"
+#include "lpa-star.hh"
+#include "memory-usage.hh"
 
 namespace hpp {
   namespace core {
     using model::displayConfig;
 
+    namespace {
+      bool shorterEdge (const EdgePtr_t& e1, const EdgePtr_t& e2)
+      {
+	return e1->length () < e2->length ();
+      }
+
+      // Whether kept edges link two nodes by a path shorter than a bound,
+      // computed by Dijkstra's algorithm stopped at the bound.
+      bool linked (const NodePtr_t& from, const NodePtr_t& to,
+		   const std::set <EdgePtr_t>& kept, value_type bound)
+      {
+	typedef std::pair <value_type, NodePtr_t> Item_t;
+	std::priority_queue <Item_t, std::vector <Item_t>,
+			     std::greater <Item_t> > queue;
+	std::map <NodePtr_t, value_type> costs;
+	costs [from] = 0;
+	queue.push (Item_t (0, from));
+	while (!queue.empty ()) {
+	  const Item_t item (queue.top ());
+	  queue.pop ();
+	  if (item.second == to) return true;
+	  if (item.first > costs [item.second]) continue;
+	  const Node::Edges_t& edges (item.second->outEdges ());
+	  for (Node::Edges_t::const_iterator it = edges.begin ();
+	       it != edges.end (); ++it) {
+	    if (!kept.count (*it)) continue;
+	    const value_type cost = item.first + (*it)->length ();
+	    if (cost >= bound) continue;
+	    std::map <NodePtr_t, value_type>::iterator itCost =
+	      costs.find ((*it)->to ());
+	    if (itCost != costs.end () && itCost->second <= cost) continue;
+	    costs [(*it)->to ()] = cost;
+	    queue.push (Item_t (cost, (*it)->to ()));
+	  }
+	}
+	return false;
+      }
+
+      // Whether nodes of a connected component are reachable from one
+      // another by edges between nodes of the connected component.
+      bool stronglyConnected (const ConnectedComponentPtr_t& cc)
+      {
+	const ConnectedComponent::Nodes_t& nodes (cc->nodes ());
+	if (nodes.size () < 2) return true;
+	for (int forward = 0; forward < 2; ++forward) {
+	  std::set <NodePtr_t> visited;
+	  std::deque <NodePtr_t> queue;
+	  visited.insert (nodes.front ());
+	  queue.push_back (nodes.front ());
+	  while (!queue.empty ()) {
+	    const NodePtr_t node (queue.front ());
+	    queue.pop_front ();
+	    const Node::Edges_t& edges (forward ? node->outEdges () :
+					node->inEdges ());
+	    for (Node::Edges_t::const_iterator it = edges.begin ();
+		 it != edges.end (); ++it) {
+	      const NodePtr_t next (forward ? (*it)->to () : (*it)->from ());
+	      if (next->connectedComponent () != cc) continue;
+	      if (visited.insert (next).second) queue.push_back (next);
+	    }
+	  }
+	  if (visited.size () != nodes.size ()) return false;
+	}
+	return true;
+      }
+
+      // Whether the connected component of n1 was created before the one of
+      // n2, compared by the index of their first node
+      bool createdBefore (const NearestNode_t& n1, const NearestNode_t& n2)
+      {
+	if (n2.first->nodes ().empty ()) return !n1.first->nodes ().empty ();
+	if (n1.first->nodes ().empty ()) return false;
+	return n1.first->nodes ().front ()->index () <
+	  n2.first->nodes ().front ()->index ();
+      }
+    } // namespace
+
     RoadmapPtr_t Roadmap::create (const DistancePtr_t& distance,
 				  const DevicePtr_t& robot)
     {
@@ -37,16 +132,32 @@ namespace hpp {
       return RoadmapPtr_t (ptr);
     }
 
-    Roadmap::Roadmap (const DistancePtr_t& distance, const DevicePtr_t&) :
-      distance_ (distance), connectedComponents_ (), nodes_ (), edges_ (),
-      initNode_ (), goalNodes_ (),
-      nearestNeighbor_ (new nearestNeighbor::Basic (distance))
+    Roadmap::Roadmap (const DistancePtr_t& distance,
+		      const DevicePtr_t& robot) :
+      distance_ (distance), robot_ (robot), sweptVolume_ (),
+      connectedComponents_ (), nodes_ (), edges_ (),
+      initNode_ (), goalNodes_ (), nearestNeighbor_ (), nodePool_ (),
+      edgePool_ (), nodeIndexBound_ (0), distancesToGoal_ (),
+      distanceToGoal_ (), goalsOfDistances_ (), goalsChanged_ (false),
+      goalIndex_ (0x0), lpaStar_ (0x0),
+      incrementalSearch_ (false), edgeIndex_ (0x0), memoryBudget_ (0),
+      nextMemoryCheck_ (0)
     {
+      // The k-d tree bounds distances to its boxes with the weights of the
+      // distance: fall back to linear search for other distances.
+      if (robot && HPP_DYNAMIC_PTR_CAST (WeighedDistance, distance)) {
+	nearestNeighbor_ = new nearestNeighbor::KDTree (robot, distance, 30);
+      } else {
+	nearestNeighbor_ = new nearestNeighbor::Basic (distance);
+      }
     }
 
     Roadmap::~Roadmap ()
     {
       clear ();
+      delete nearestNeighbor_;
+      delete edgeIndex_;
+      delete goalIndex_;
     }
 
     const ConnectedComponents_t& Roadmap::connectedComponents () const
@@ -64,8 +175,10 @@ namespace hpp {
       if (nodes_.size() != 0) {
         throw std::runtime_error ("The roadmap must be empty before setting a new NearestNeighbor object.");
       }
-      if(nearestNeighbor)
+      if(nearestNeighbor) {
+        delete nearestNeighbor_;
         nearestNeighbor_ = nearestNeighbor;
+      }
     }
 
     void Roadmap::clear ()
@@ -73,30 +186,53 @@ namespace hpp {
       connectedComponents_.clear ();
 
       for (Nodes_t::iterator it = nodes_.begin (); it != nodes_.end (); ++it) {
-	delete *it;
+	destroyNode (*it);
       }
       nodes_.clear ();
+      nodePool_.clear ();
+      nodeIndexBound_ = 0;
+      distancesToGoal_.clear ();
+      goalsOfDistances_.clear ();
+      delete goalIndex_;
+      goalIndex_ = 0x0;
+      delete lpaStar_;
+      lpaStar_ = 0x0;
 
       for (Edges_t::iterator it = edges_.begin (); it != edges_.end (); ++it) {
-	delete *it;
+	edgePool_.destroy (*it);
       }
       edges_.clear ();
+      edgePool_.clear ();
+      if (edgeIndex_) edgeIndex_->clear ();
 
       goalNodes_.clear ();
+      goalsChanged_ = false;
       initNode_ = 0x0;
       nearestNeighbor_->clear();
+      nextMemoryCheck_ = 0;
+    }
+
+    void Roadmap::destroyNode (const NodePtr_t& node)
+    {
+      // Child classes may create nodes with operator new.
+      if (nodePool_.owns (node)) {
+	nodePool_.destroy (node);
+      } else {
+	delete node;
+      }
     }
 
     NodePtr_t Roadmap::addNode (const ConfigurationPtr_t& configuration)
     {
       value_type distance;
       if (nodes_.size () != 0) {
-	NodePtr_t nearest = nearestNode (configuration, distance);
+	NodePtr_t nearest = nearestNode (configuration, distance, true);
 	if (*(nearest->configuration ()) == *configuration) {
 	  return nearest;
 	}
       }
       NodePtr_t node = createNode (configuration);
+      node->index (nodeIndexBound_++);
       hppDout (info, "Added node: " << displayConfig (*configuration));
       push_node (node);
       // Node constructor creates a new connected component. This new
@@ -113,12 +249,13 @@ namespace hpp {
       value_type distance;
       if (nodes_.size () != 0) {
 	NodePtr_t nearest = nearestNode (configuration, connectedComponent,
-					 distance);
+					 distance, true);
 	if (*(nearest->configuration ()) == *configuration) {
 	  return nearest;
 	}
       }
       NodePtr_t node = createNode (configuration);
+      node->index (nodeIndexBound_++);
       node->connectedComponent (connectedComponent);
       hppDout (info, "Added node: " << displayConfig (*configuration));
       push_node (node);
@@ -132,14 +269,17 @@ namespace hpp {
     void Roadmap::addEdges (const NodePtr_t from, const NodePtr_t& to,
 			    const PathPtr_t& path)
     {
-      EdgePtr_t edge = new Edge (from, to, path);
+      EdgePtr_t edge = new (edgePool_.allocate ()) Edge (from, to, path);
       from->addOutEdge (edge);
       to->addInEdge (edge);
       edges_.push_back (edge);
-      edge = new Edge (to, from, path->reverse ());
+      if (lpaStar_) lpaStar_->edgeAdded (edge);
+      if (edgeIndex_) edgeIndex_->insert (edge);
+      edge = new (edgePool_.allocate ()) Edge (to, from, path->reverse ());
       from->addInEdge (edge);
       to->addOutEdge (edge);
       edges_.push_back (edge);
+      if (lpaStar_) lpaStar_->edgeAdded (edge);
     }
 
     NodePtr_t Roadmap::addNodeAndEdges (const NodePtr_t from,
@@ -153,40 +293,125 @@ namespace hpp {
 
     NodePtr_t
     Roadmap::nearestNode (const ConfigurationPtr_t& configuration,
-			  value_type& minDistance)
+			  value_type& minDistance, bool exact)
     {
       NodePtr_t closest = 0x0;
       minDistance = std::numeric_limits<value_type>::infinity ();
-      for (ConnectedComponents_t::const_iterator itcc =
-	     connectedComponents_.begin ();
-	   itcc != connectedComponents_.end (); ++itcc) {
-	value_type distance;
-	NodePtr_t node;
-	node = nearestNeighbor_->search(configuration, *itcc, distance);
-	if (distance < minDistance) {
-	  minDistance = distance;
-	  closest = node;
+      NearestNodes_t nearest;
+      OperationCounters::increment (OperationCounters::NEAREST_NEIGHBOR);
+      nearestNeighbor_->search (configuration, connectedComponents_, nearest,
+				exact);
+      // Break ties independently of the addresses of connected components
+      std::sort (nearest.begin (), nearest.end (), createdBefore);
+      for (NearestNodes_t::const_iterator it = nearest.begin ();
+	   it != nearest.end (); ++it) {
+	if (it->second.second < minDistance) {
+	  minDistance = it->second.second;
+	  closest = it->second.first;
 	}
       }
       return closest;
     }
 
+    void Roadmap::nearestNodes (const ConfigurationPtr_t& configuration,
+				NearestNodes_t& nearestNodes)
+    {
+      OperationCounters::increment (OperationCounters::NEAREST_NEIGHBOR);
+      nearestNeighbor_->search (configuration, connectedComponents_,
+				nearestNodes);
+      // Connected components are stored by address: sort them in an order
+      // that does not vary from one run to the next.
+      std::sort (nearestNodes.begin (), nearestNodes.end (), createdBefore);
+    }
+
+    Nodes_t Roadmap::nearestNodes
+    (const ConfigurationPtr_t& configuration,
+     const ConnectedComponentPtr_t& connectedComponent, std::size_t k,
+     value_type& distance)
+    {
+      assert (connectedComponent);
+      OperationCounters::increment (OperationCounters::NEAREST_NEIGHBOR);
+      return nearestNeighbor_->KNearest (configuration, connectedComponent, k,
+					 distance);
+    }
+
+    Nodes_t Roadmap::nodesWithinRadius
+    (const ConfigurationPtr_t& configuration,
+     const ConnectedComponentPtr_t& connectedComponent, value_type radius)
+    {
+      assert (connectedComponent);
+      OperationCounters::increment (OperationCounters::NEAREST_NEIGHBOR);
+      return nearestNeighbor_->withinRadius (configuration, connectedComponent,
+					     radius);
+    }
+
     NodePtr_t
     Roadmap::nearestNode (const ConfigurationPtr_t& configuration,
 			  const ConnectedComponentPtr_t& connectedComponent,
-			  value_type& minDistance)
+			  value_type& minDistance, bool exact)
     {
       assert (connectedComponent);
       assert (connectedComponent->nodes ().size () != 0);
+      OperationCounters::increment (OperationCounters::NEAREST_NEIGHBOR);
       NodePtr_t closest =
-	nearestNeighbor_->search(configuration, connectedComponent, minDistance);
+	nearestNeighbor_->search(configuration, connectedComponent, minDistance,
+				 exact);
       return closest;
     }
     
     void Roadmap::addGoalNode (const ConfigurationPtr_t& config)
     {
       NodePtr_t node = addNode (config);
+      if (node->isGoal ()) return;
+      node->isGoal (true);
       goalNodes_.push_back (node);
+      goalsChanged_ = true;
+    }
+
+    void Roadmap::resetGoalNodes ()
+    {
+      for (Nodes_t::const_iterator it = goalNodes_.begin ();
+	   it != goalNodes_.end (); ++it) {
+	(*it)->isGoal (false);
+      }
+      goalNodes_.clear ();
+      goalsChanged_ = true;
+    }
+
+    std::vector <value_type>& Roadmap::distancesToGoal
+    (const DistancePtr_t& distance)
+    {
+      // Goal nodes are reset and added again at each resolution: lists are
+      // compared only after a change, not at each heuristic evaluation.
+      if (goalsChanged_) {
+	goalsChanged_ = false;
+	if (goalNodes_ != goalsOfDistances_) {
+	  goalsOfDistances_ = goalNodes_;
+	  distanceToGoal_.reset ();
+	}
+      }
+      if (distance != distanceToGoal_) {
+	distancesToGoal_.clear ();
+	distanceToGoal_ = distance;
+	delete goalIndex_;
+	goalIndex_ = 0x0;
+      }
+      // Nodes added since the last call have no value yet.
+      distancesToGoal_.resize (nodeIndexBound_, -1);
+      return distancesToGoal_;
+    }
+
+    value_type Roadmap::distanceToGoal (const DistancePtr_t& distance,
+					const NodePtr_t& node)
+    {
+      value_type& result = distancesToGoal (distance) [node->index ()];
+      if (result < 0) {
+	if (!goalIndex_) {
+	  goalIndex_ = new GoalIndex (distance, goalsOfDistances_);
+	}
+	result = goalIndex_->minDistance (*node->configuration ());
+      }
+      return result;
     }
     
     const DistancePtr_t& Roadmap::distance () const
@@ -197,10 +422,25 @@ namespace hpp {
     EdgePtr_t Roadmap::addEdge (const NodePtr_t& n1, const NodePtr_t& n2,
 				const PathPtr_t& path)
     {
-      EdgePtr_t edge = new Edge (n1, n2, path);
+      return insertEdge (new (edgePool_.allocate ()) Edge (n1, n2, path));
+    }
+
+    EdgePtr_t Roadmap::addEdge (const NodePtr_t& n1, const NodePtr_t& n2,
+				const SteeringMethodPtr_t& steeringMethod,
+				value_type length)
+    {
+      return insertEdge (new (edgePool_.allocate ())
+			 Edge (n1, n2, steeringMethod, length));
+    }
+
+    EdgePtr_t Roadmap::insertEdge (const EdgePtr_t& edge)
+    {
+      NodePtr_t n1 = edge->from ();
+      NodePtr_t n2 = edge->to ();
       n1->addOutEdge (edge);
       n2->addInEdge (edge);
       edges_.push_back (edge);
+      if (lpaStar_) lpaStar_->edgeAdded (edge);
 
       ConnectedComponentPtr_t cc1 = n1->connectedComponent ();
       ConnectedComponentPtr_t cc2 = n2->connectedComponent ();
@@ -209,6 +449,368 @@ namespace hpp {
       return edge;
     }
 
+    void Roadmap::removeEdges (const Edges_t& edges)
+    {
+      // edges may be the list of edges of the roadmap
+      eraseEdges (std::set <EdgePtr_t> (edges.begin (), edges.end ()));
+      rebuildConnectedComponents ();
+    }
+
+    void Roadmap::removeEdge (const EdgePtr_t& edge)
+    {
+      const NodePtr_t from (edge->from ()), to (edge->to ());
+      std::set <EdgePtr_t> removed;
+      removed.insert (edge);
+      eraseEdges (removed);
+      if (!keepsConnectedComponents (from, to)) rebuildConnectedComponents ();
+    }
+
+    void Roadmap::removeNode (const NodePtr_t& node)
+    {
+      const ConnectedComponentPtr_t cc (node->connectedComponent ());
+      std::set <EdgePtr_t> removed (node->outEdges ().begin (),
+				    node->outEdges ().end ());
+      removed.insert (node->inEdges ().begin (), node->inEdges ().end ());
+      // Edges from and to other connected components
+      std::vector <std::pair <NodePtr_t, NodePtr_t> > links;
+      for (std::set <EdgePtr_t>::const_iterator it = removed.begin ();
+	   it != removed.end (); ++it) {
+	if ((*it)->from ()->connectedComponent () !=
+	    (*it)->to ()->connectedComponent ()) {
+	  links.push_back (std::make_pair ((*it)->from (), (*it)->to ()));
+	}
+      }
+      eraseEdges (removed);
+      nodes_.remove (node);
+      cc->nodes_.remove (node);
+      nearestNeighbor_->removeNode (node);
+      if (node->isGoal ()) {
+	goalNodes_.remove (node);
+	goalsChanged_ = true;
+      }
+      if (initNode_ == node) initNode_ = 0x0;
+      // The incremental search stores costs of the removed node.
+      delete lpaStar_;
+      lpaStar_ = 0x0;
+      bool rebuild;
+      if (cc->nodes_.empty ()) {
+	// Connected components may reach one another through cc only.
+	rebuild = !cc->reachableTo_.empty () && !cc->reachableFrom_.empty ();
+	if (!rebuild) {
+	  for (ConnectedComponents_t::const_iterator it =
+		 cc->reachableTo_.begin (); it != cc->reachableTo_.end ();
+	       ++it) {
+	    (*it)->reachableFrom_.erase (cc);
+	  }
+	  for (ConnectedComponents_t::const_iterator it =
+		 cc->reachableFrom_.begin (); it != cc->reachableFrom_.end ();
+	       ++it) {
+	    (*it)->reachableTo_.erase (cc);
+	  }
+	  cc->reachableTo_.clear ();
+	  cc->reachableFrom_.clear ();
+	  connectedComponents_.erase (cc);
+	}
+      } else {
+	rebuild = !stronglyConnected (cc);
+	// The node still refers to its connected component.
+	for (std::size_t i = 0; !rebuild && i < links.size (); ++i) {
+	  rebuild = !keepsConnectedComponents (links [i].first,
+					      links [i].second);
+	}
+      }
+      destroyNode (node);
+      if (rebuild) rebuildConnectedComponents ();
+    }
+
+    bool Roadmap::keepsConnectedComponents (const NodePtr_t& from,
+					    const NodePtr_t& to) const
+    {
+      const ConnectedComponentPtr_t cc1 (from->connectedComponent ());
+      const ConnectedComponentPtr_t cc2 (to->connectedComponent ());
+      if (cc1 == cc2) return stronglyConnected (cc1);
+      // Reachability between connected components is unchanged if another
+      // edge links them.
+      const ConnectedComponent::Nodes_t& nodes (cc1->nodes ());
+      for (ConnectedComponent::Nodes_t::const_iterator itNode =
+	     nodes.begin (); itNode != nodes.end (); ++itNode) {
+	const Node::Edges_t& edges ((*itNode)->outEdges ());
+	for (Node::Edges_t::const_iterator it = edges.begin ();
+	     it != edges.end (); ++it) {
+	  if ((*it)->to ()->connectedComponent () == cc2) return true;
+	}
+      }
+      return false;
+    }
+
+    void Roadmap::eraseEdges (const std::set <EdgePtr_t>& removed)
+    {
+      for (std::set <EdgePtr_t>::const_iterator it = removed.begin ();
+	   it != removed.end (); ++it) {
+	(*it)->from ()->removeOutEdge (*it);
+	(*it)->to ()->removeInEdge (*it);
+	if (lpaStar_) lpaStar_->edgeRemoved (*it);
+	if (edgeIndex_) edgeIndex_->remove (*it);
+      }
+      for (Edges_t::iterator it = edges_.begin (); it != edges_.end ();) {
+	if (removed.count (*it)) {
+	  edgePool_.destroy (*it);
+	  it = edges_.erase (it);
+	} else {
+	  ++it;
+	}
+      }
+    }
+
+    Roadmap::MemoryUsage Roadmap::memoryUsage () const
+    {
+      MemoryUsage result;
+      // Nodes are listed by the roadmap and by their connected component.
+      result.nodes = nodePool_.memoryUsage () + 2 * memory::bytes (nodes_) +
+	memory::bytes (connectedComponents_) +
+	memory::bytes (distancesToGoal_);
+      for (Nodes_t::const_iterator it = nodes_.begin (); it != nodes_.end ();
+	   ++it) {
+	const NodePtr_t& node (*it);
+	if (!nodePool_.owns (node)) result.nodes += sizeof (Node);
+	// Configuration and reference count of the shared pointer
+	result.nodes += sizeof (Configuration_t) + 2 * sizeof (long) +
+	  memory::bytes (*node->configuration ()) +
+	  memory::bytes (node->outEdges ()) + memory::bytes (node->inEdges ());
+      }
+      result.edges = edgePool_.memoryUsage () + memory::bytes (edges_);
+      // Edges may share paths
+      std::set <const Path*> paths;
+      result.paths = 0;
+      for (Edges_t::const_iterator it = edges_.begin (); it != edges_.end ();
+	   ++it) {
+	if (!(*it)->hasPath ()) continue;
+	PathPtr_t path ((*it)->path ());
+	if (paths.insert (path.get ()).second) {
+	  result.paths += path->memoryUsage ();
+	}
+      }
+      result.nearestNeighbor = nearestNeighbor_->memoryUsage ();
+      return result;
+    }
+
+    bool Roadmap::memoryBudgetExceeded ()
+    {
+      if (memoryBudget_ == 0) return false;
+      const std::size_t size = nodes_.size () + edges_.size ();
+      if (size < nextMemoryCheck_) return false;
+      nextMemoryCheck_ = size + size / 10 + 1;
+      return memoryUsage ().total () > memoryBudget_;
+    }
+
+    std::size_t Roadmap::prune (const Nodes_t& kept)
+    {
+      std::set <NodePtr_t> protectedNodes (kept.begin (), kept.end ());
+      if (initNode_) protectedNodes.insert (initNode_);
+      protectedNodes.insert (goalNodes_.begin (), goalNodes_.end ());
+      std::set <NodePtr_t> removedNodes;
+      std::set <EdgePtr_t> removedEdges;
+      for (Nodes_t::const_iterator it = nodes_.begin (); it != nodes_.end ();
+	   ++it) {
+	if (protectedNodes.count (*it)) continue;
+	const Node::Edges_t& outEdges ((*it)->outEdges ());
+	const Node::Edges_t& inEdges ((*it)->inEdges ());
+	NodePtr_t neighbor = 0x0;
+	bool redundant = true;
+	for (Node::Edges_t::const_iterator itEdge = outEdges.begin ();
+	     redundant && itEdge != outEdges.end (); ++itEdge) {
+	  if (neighbor && (*itEdge)->to () != neighbor) redundant = false;
+	  neighbor = (*itEdge)->to ();
+	}
+	for (Node::Edges_t::const_iterator itEdge = inEdges.begin ();
+	     redundant && itEdge != inEdges.end (); ++itEdge) {
+	  if (neighbor && (*itEdge)->from () != neighbor) redundant = false;
+	  neighbor = (*itEdge)->from ();
+	}
+	if (!redundant) continue;
+	removedNodes.insert (*it);
+	removedEdges.insert (outEdges.begin (), outEdges.end ());
+	removedEdges.insert (inEdges.begin (), inEdges.end ());
+      }
+      if (removedNodes.empty ()) return 0;
+      hppDout (info, "Pruning " << removedNodes.size () << " nodes out of "
+	       << nodes_.size ());
+      eraseEdges (removedEdges);
+      for (Nodes_t::iterator it = nodes_.begin (); it != nodes_.end ();) {
+	if (removedNodes.count (*it)) {
+	  destroyNode (*it);
+	  it = nodes_.erase (it);
+	} else {
+	  ++it;
+	}
+      }
+      // The incremental search stores costs of the removed nodes.
+      delete lpaStar_;
+      lpaStar_ = 0x0;
+      rebuildConnectedComponents ();
+      const std::size_t size = nodes_.size () + edges_.size ();
+      nextMemoryCheck_ = size + size / 10 + 1;
+      return removedNodes.size ();
+    }
+
+    std::size_t Roadmap::sparsify (value_type stretch, const Nodes_t& kept)
+    {
+      if (!(stretch >= 1)) {
+	throw std::invalid_argument ("The stretch factor should not be smaller "
+				     "than 1.");
+      }
+      Edges_t edges (edges_);
+      std::stable_sort (edges.begin (), edges.end (), shorterEdge);
+      std::set <EdgePtr_t> keptEdges;
+      std::set <EdgePtr_t> removedEdges;
+      for (Edges_t::const_iterator it = edges.begin (); it != edges.end ();
+	   ++it) {
+	if (linked ((*it)->from (), (*it)->to (), keptEdges,
+		    stretch * (*it)->length ())) {
+	  removedEdges.insert (*it);
+	} else {
+	  keptEdges.insert (*it);
+	}
+      }
+      hppDout (info, "Sparsifying: removing " << removedEdges.size ()
+	       << " edges out of " << edges_.size ());
+      if (!removedEdges.empty ()) {
+	eraseEdges (removedEdges);
+	rebuildConnectedComponents ();
+      }
+      prune (kept);
+      return removedEdges.size ();
+    }
+
+    void Roadmap::indexEdges (bool index)
+    {
+      if (!index) {
+	delete edgeIndex_;
+	edgeIndex_ = 0x0;
+	return;
+      }
+      if (edgeIndex_) return;
+      if (!robot_) {
+	throw std::runtime_error
+	  ("The roadmap needs a robot to bound the paths of its edges.");
+      }
+      if (!sweptVolume_) sweptVolume_ = SweptVolume::create (robot_);
+      edgeIndex_ = new EdgeIndex (sweptVolume_);
+      for (Edges_t::const_iterator it = edges_.begin (); it != edges_.end ();
+	   ++it) {
+	edgeIndex_->insert (*it);
+      }
+    }
+
+    Edges_t Roadmap::edgesNear (const ObjectVector_t& obstacles)
+    {
+      Edges_t result;
+      SweptVolume::Boxes_t region;
+      for (ObjectVector_t::const_iterator itObj = obstacles.begin ();
+	   itObj != obstacles.end (); ++itObj) {
+	(*itObj)->fcl ()->computeAABB ();
+	region.push_back ((*itObj)->fcl ()->getAABB ());
+      }
+      if (region.empty ()) return result;
+      if (edgeIndex_) {
+	std::set <EdgePtr_t> edges;
+	edgeIndex_->query (region, edges);
+	result.assign (edges.begin (), edges.end ());
+	return result;
+      }
+      if (!sweptVolume_ && robot_) sweptVolume_ = SweptVolume::create (robot_);
+      SweptVolume::Boxes_t boxes;
+      for (Edges_t::const_iterator it = edges_.begin (); it != edges_.end ();
+	   ++it) {
+	// Paths computed on first access are not computed here, their edges
+	// are returned.
+	if (!(*it)->hasPath () || !(*it)->path () || !sweptVolume_ ||
+	    !sweptVolume_->compute ((*it)->path (), boxes) ||
+	    SweptVolume::overlap (boxes, region)) {
+	  result.push_back (*it);
+	}
+      }
+      return result;
+    }
+
+    std::size_t Roadmap::removeInvalidEdges
+    (const PathValidationPtr_t& pathValidation,
+     const ObjectVector_t& obstacles)
+    {
+      const Edges_t candidates (edgesNear (obstacles));
+      std::set <EdgePtr_t> checked;
+      Edges_t invalidEdges;
+      for (Edges_t::const_iterator it = candidates.begin ();
+	   it != candidates.end (); ++it) {
+	if (!checked.insert (*it).second) continue;
+	// Both edges between two nodes have the same support
+	EdgePtr_t reverse (reverseEdge (*it));
+	if (reverse) checked.insert (reverse);
+	PathPtr_t path ((*it)->path ());
+	if (!path || !pathValidation->isValid (path)) {
+	  invalidEdges.push_back (*it);
+	  if (reverse) invalidEdges.push_back (reverse);
+	}
+      }
+      hppDout (info, "Validated " << checked.size () << " edges, removed "
+	       << invalidEdges.size () << " edges out of " << edges_.size ());
+      if (!invalidEdges.empty ()) removeEdges (invalidEdges);
+      return invalidEdges.size ();
+    }
+
+    EdgePtr_t Roadmap::reverseEdge (const EdgePtr_t& edge) const
+    {
+      const Node::Edges_t& outEdges (edge->to ()->outEdges ());
+      for (Node::Edges_t::const_iterator itEdge = outEdges.begin ();
+	   itEdge != outEdges.end (); ++itEdge) {
+	if ((*itEdge)->to () == edge->from ()) return *itEdge;
+      }
+      return EdgePtr_t (0x0);
+    }
+
+    void Roadmap::rebuildConnectedComponents ()
+    {
+      // Break reference cycles between former connected components
+      for (ConnectedComponents_t::const_iterator it =
+	     connectedComponents_.begin (); it != connectedComponents_.end ();
+	   ++it) {
+	(*it)->reachableTo_.clear ();
+	(*it)->reachableFrom_.clear ();
+      }
+      connectedComponents_.clear ();
+      nearestNeighbor_->clear ();
+      for (Nodes_t::const_iterator it = nodes_.begin (); it != nodes_.end ();
+	   ++it) {
+	(*it)->connectedComponent (ConnectedComponent::create ());
+	addConnectedComponent (*it);
+      }
+      for (Edges_t::const_iterator it = edges_.begin (); it != edges_.end ();
+	   ++it) {
+	connect ((*it)->from ()->connectedComponent (),
+		 (*it)->to ()->connectedComponent ());
+      }
+    }
+
+    PathVectorPtr_t Roadmap::shortestPath (const DistancePtr_t& distance)
+    {
+      if (!initNode_) {
+	throw std::runtime_error ("The roadmap has no initial node.");
+      }
+      if (!lpaStar_) lpaStar_ = new LpaStar (this);
+      return lpaStar_->solution (distance);
+    }
+
+    Edges_t Roadmap::shortestPathEdges (const DistancePtr_t& distance)
+    {
+      if (!initNode_) {
+	throw std::runtime_error ("The roadmap has no initial node.");
+      }
+      if (!lpaStar_) lpaStar_ = new LpaStar (this);
+      Edges_t edges;
+      lpaStar_->solutionEdges (distance, edges);
+      return edges;
+    }
+
     void Roadmap::addConnectedComponent (const NodePtr_t& node)
     {
       connectedComponents_.insert (node->connectedComponent ());
@@ -219,13 +821,20 @@ namespace hpp {
     NodePtr_t Roadmap::createNode (const ConfigurationPtr_t& configuration)
       const
     {
-      return NodePtr_t (new Node (configuration));
+      return NodePtr_t (new (nodePool_.allocate ()) Node (configuration));
     }
 
     void Roadmap::connect (const ConnectedComponentPtr_t& cc1,
 			   const ConnectedComponentPtr_t& cc2)
     {
       if (cc1->canReach (cc2)) return;
+      if (!cc1->isLinkedTo (cc2)) {
+	// cc2 cannot reach cc1 if no edge links them.
+	cc1->link (cc2);
+	cc1->reachableTo_.insert (cc2);
+	cc2->reachableFrom_.insert (cc1);
+	return;
+      }
       ConnectedComponents_t cc2Tocc1;
       if (cc2->canReach (cc1, cc2Tocc1)) {
 	merge (cc1, cc2Tocc1);
@@ -241,6 +850,7 @@ namespace hpp {
       for (ConnectedComponents_t::iterator itcc = ccs.begin ();
 	   itcc != ccs.end (); ++itcc) {
 	if (*itcc != cc1) {
+	  nearestNeighbor_->merge (cc1, *itcc);
 	  cc1->merge (*itcc);
 #ifndef NDEBUG	  
 	  std::size_t nb =
@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <hpp/util/debug.hh>
+#include <hpp/model/configuration.hh>
+#include <hpp/core/configuration-shooter.hh>
+#include <hpp/core/connected-component.hh>
+#include <hpp/core/distance.hh>
+#include <hpp/core/node.hh>
+#include <hpp/core/path.hh>
+#include <hpp/core/path-validation.hh>
+#include <hpp/core/problem.hh>
+#include <hpp/core/roadmap.hh>
+#include <hpp/core/rrt-connect-planner.hh>
+
+namespace hpp {
+  namespace core {
+    using model::displayConfig;
+
+    RrtConnectPlannerPtr_t RrtConnectPlanner::createWithRoadmap
+    (const Problem& problem, const RoadmapPtr_t& roadmap)
+    {
+      RrtConnectPlanner* ptr = new RrtConnectPlanner (problem, roadmap);
+      return RrtConnectPlannerPtr_t (ptr);
+    }
+
+    RrtConnectPlannerPtr_t RrtConnectPlanner::create (const Problem& problem)
+    {
+      RrtConnectPlanner* ptr = new RrtConnectPlanner (problem);
+      return RrtConnectPlannerPtr_t (ptr);
+    }
+
+    RrtConnectPlanner::RrtConnectPlanner (const Problem& problem):
+      DiffusingPlanner (problem), extendInitTree_ (true)
+    {
+    }
+
+    RrtConnectPlanner::RrtConnectPlanner (const Problem& problem,
+					  const RoadmapPtr_t& roadmap) :
+      DiffusingPlanner (problem, roadmap), extendInitTree_ (true)
+    {
+    }
+
+    void RrtConnectPlanner::init (const RrtConnectPlannerWkPtr_t& weak)
+    {
+      DiffusingPlanner::init (weak);
+      weakPtr_ = weak;
+    }
+
+    NodePtr_t RrtConnectPlanner::extendNode (const NodePtr_t& near,
+					     const ConfigurationPtr_t& target,
+					     bool& reached)
+    {
+      PathValidationPtr_t pathValidation (problem ().pathValidation ());
+      PathPtr_t validPath;
+      reached = false;
+      PathPtr_t path = extend (near, target);
+      if (!path) return NodePtr_t (0x0);
+      bool pathValid = pathValidation->validateWithoutReport
+	(path, false, validPath);
+      if (validPath->timeRange ().second == path->timeRange ().first) {
+	return NodePtr_t (0x0);
+      }
+      reached = pathValid;
+      ConfigurationPtr_t q_new (new Configuration_t (validPath->end ()));
+      return roadmap ()->addNodeAndEdges (near, q_new, validPath);
+    }
+
+    bool RrtConnectPlanner::connect (const ConnectedComponentPtr_t& cc,
+				     const NodePtr_t& target)
+    {
+      PathValidationPtr_t pathValidation (problem ().pathValidation ());
+      const Distance& distance (*(problem ().distance ()));
+      const ConfigurationPtr_t& q_target (target->configuration ());
+      value_type minDistance;
+      NodePtr_t near = roadmap ()->nearestNode (q_target, cc, minDistance);
+      while (true) {
+	PathPtr_t validPath, path = extend (near, q_target);
+	if (!path) return false;
+	bool pathValid = pathValidation->validateWithoutReport
+	  (path, false, validPath);
+	if (pathValid && path->end () == *q_target) {
+	  roadmap ()->addEdge (near, target, path);
+	  interval_t timeRange = path->timeRange ();
+	  roadmap ()->addEdge (target, near, path->extract
+			       (interval_t (timeRange.second,
+					    timeRange.first)));
+	  hppDout (info, "trees connected at "
+		   << displayConfig (*q_target));
+	  return true;
+	}
+	if (validPath->timeRange ().second == path->timeRange ().first) {
+	  return false;
+	}
+	ConfigurationPtr_t q_new (new Configuration_t (validPath->end ()));
+	// Constraints may prevent the extension to reach the target: stop
+	// when the extension does not get closer.
+	value_type d = distance (*q_new, *q_target);
+	near = roadmap ()->addNodeAndEdges (near, q_new, validPath);
+	if (!pathValid || d >= minDistance) return false;
+	minDistance = d;
+      }
+    }
+
+    /// This method performs one step of RRT-Connect as follows
+    ///  1. the tree to extend is the connected component of the initial node
+    ///     or of a goal node, alternately,
+    ///  2. a random configuration "q_rand" is shot,
+    ///  3. the nearest node of the tree is extended toward "q_rand" and the
+    ///     valid part of the path is inserted as new node "q_new",
+    ///  4. the other tree is extended toward "q_new" from its nearest node,
+    ///     then from the nodes it inserts, until "q_new" is reached or the
+    ///     extension is blocked.
+    void RrtConnectPlanner::oneStep ()
+    {
+      RoadmapPtr_t r (roadmap ());
+      ConnectedComponentPtr_t initTree (r->initNode ()->connectedComponent ());
+      ConnectedComponentPtr_t goalTree;
+      for (Nodes_t::const_iterator itGoal = r->goalNodes ().begin ();
+	   itGoal != r->goalNodes ().end (); ++itGoal) {
+	if ((*itGoal)->connectedComponent () != initTree) {
+	  goalTree = (*itGoal)->connectedComponent ();
+	  break;
+	}
+      }
+      if (!goalTree) return;
+      ConnectedComponentPtr_t tree (extendInitTree_ ? initTree : goalTree);
+      ConnectedComponentPtr_t other (extendInitTree_ ? goalTree : initTree);
+      extendInitTree_ = !extendInitTree_;
+
+      ConfigurationPtr_t q_rand = configurationShooter ()->shoot ();
+      value_type distance;
+      NodePtr_t near = r->nearestNode (q_rand, tree, distance);
+      bool reached;
+      NodePtr_t newNode = extendNode (near, q_rand, reached);
+      if (!newNode) return;
+      connect (other, newNode);
+    }
+  } // namespace core
+} // namespace hpp
@@ -0,0 +1,336 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <hpp/util/debug.hh>
+#include <hpp/model/configuration.hh>
+#include <hpp/core/connected-component.hh>
+#include <hpp/core/distance.hh>
+#include <hpp/core/edge.hh>
+#include <hpp/core/node.hh>
+#include <hpp/core/path.hh>
+#include <hpp/core/path-cost.hh>
+#include <hpp/core/path-projector.hh>
+#include <hpp/core/path-validation.hh>
+#include <hpp/core/problem.hh>
+#include <hpp/core/roadmap.hh>
+#include <hpp/core/rrt-star-planner.hh>
+#include <hpp/core/steering-method.hh>
+
+namespace hpp {
+  namespace core {
+    using model::displayConfig;
+
+    namespace {
+      // Path to a node of the tree with the cost of the node through it
+      struct Candidate
+      {
+	value_type cost;
+	NodePtr_t node;
+	PathPtr_t path;
+	bool operator< (const Candidate& other) const
+	{
+	  return cost < other.cost;
+	}
+      }; // struct Candidate
+      typedef std::vector <Candidate> Candidates_t;
+
+      EdgePtr_t edgeTo (const NodePtr_t& from, const NodePtr_t& to)
+      {
+	const Node::Edges_t& outEdges (from->outEdges ());
+	for (Node::Edges_t::const_iterator itEdge = outEdges.begin ();
+	     itEdge != outEdges.end (); ++itEdge) {
+	  if ((*itEdge)->to () == to) return *itEdge;
+	}
+	return EdgePtr_t (0x0);
+      }
+    } // namespace
+
+    RrtStarPlannerPtr_t RrtStarPlanner::createWithRoadmap
+    (const Problem& problem, const RoadmapPtr_t& roadmap)
+    {
+      RrtStarPlanner* ptr = new RrtStarPlanner (problem, roadmap);
+      return RrtStarPlannerPtr_t (ptr);
+    }
+
+    RrtStarPlannerPtr_t RrtStarPlanner::create (const Problem& problem)
+    {
+      RrtStarPlanner* ptr = new RrtStarPlanner (problem);
+      return RrtStarPlannerPtr_t (ptr);
+    }
+
+    RrtStarPlanner::RrtStarPlanner (const Problem& problem):
+      DiffusingPlanner (problem), weakPtr_ (), costs_ (), parents_ (),
+      numberRefinementSteps_ (0), neighborFactor_ (2 * M_E),
+      extensionLength_ (std::numeric_limits <value_type>::infinity ())
+    {
+    }
+
+    RrtStarPlanner::RrtStarPlanner (const Problem& problem,
+				    const RoadmapPtr_t& roadmap) :
+      DiffusingPlanner (problem, roadmap), weakPtr_ (), costs_ (),
+      parents_ (), numberRefinementSteps_ (0), neighborFactor_ (2 * M_E),
+      extensionLength_ (std::numeric_limits <value_type>::infinity ())
+    {
+    }
+
+    void RrtStarPlanner::init (const RrtStarPlannerWkPtr_t& weak)
+    {
+      DiffusingPlanner::init (weak);
+      weakPtr_ = weak;
+    }
+
+    void RrtStarPlanner::startSolve ()
+    {
+      DiffusingPlanner::startSolve ();
+      // The roadmap may have been edited since last resolution
+      computeCosts ();
+    }
+
+    void RrtStarPlanner::pruneRoadmap ()
+    {
+      DiffusingPlanner::pruneRoadmap ();
+      computeCosts ();
+    }
+
+    PathVectorPtr_t RrtStarPlanner::finishSolve (const PathVectorPtr_t& path)
+    {
+      if (numberRefinementSteps_ == 0) return path;
+      for (std::size_t i = 0; i < numberRefinementSteps_ &&
+	     !timeOutReached (); ++i) {
+	oneStep ();
+	if (roadmap ()->memoryBudgetExceeded ()) pruneRoadmap ();
+      }
+      return computePath ();
+    }
+
+    value_type RrtStarPlanner::cost (const EdgePtr_t& edge) const
+    {
+      if (pathCost ()) return edge->cost (pathCost ());
+      return edge->length ();
+    }
+
+    value_type RrtStarPlanner::cost (const PathPtr_t& path) const
+    {
+      if (pathCost ()) return (*pathCost ()) (path);
+      return path->length ();
+    }
+
+    value_type RrtStarPlanner::nodeCost (const NodePtr_t& node) const
+    {
+      if (node->index () >= costs_.size ()) {
+	return std::numeric_limits <value_type>::infinity ();
+      }
+      return costs_ [node->index ()];
+    }
+
+    EdgePtr_t RrtStarPlanner::parentEdge (const NodePtr_t& node) const
+    {
+      if (node->index () >= parents_.size ()) return EdgePtr_t (0x0);
+      return parents_ [node->index ()];
+    }
+
+    void RrtStarPlanner::resizeCosts ()
+    {
+      std::size_t size = roadmap ()->nodeIndexBound ();
+      costs_.resize (size, std::numeric_limits <value_type>::infinity ());
+      parents_.resize (size, EdgePtr_t (0x0));
+    }
+
+    void RrtStarPlanner::computeCosts ()
+    {
+      typedef std::pair <value_type, NodePtr_t> Open_t;
+      std::priority_queue <Open_t, std::vector <Open_t>,
+			   std::greater <Open_t> > open;
+      costs_.clear ();
+      parents_.clear ();
+      resizeCosts ();
+      NodePtr_t initNode (roadmap ()->initNode ());
+      costs_ [initNode->index ()] = 0;
+      open.push (Open_t (0, initNode));
+      while (!open.empty ()) {
+	Open_t current (open.top ());
+	open.pop ();
+	// Nodes are pushed again when their cost decreases, older entries
+	// are skipped.
+	if (current.first > costs_ [current.second->index ()]) continue;
+	const Node::Edges_t& outEdges (current.second->outEdges ());
+	for (Node::Edges_t::const_iterator itEdge = outEdges.begin ();
+	     itEdge != outEdges.end (); ++itEdge) {
+	  std::size_t child = (*itEdge)->to ()->index ();
+	  value_type c = current.first + cost (*itEdge);
+	  if (c < costs_ [child]) {
+	    costs_ [child] = c;
+	    parents_ [child] = *itEdge;
+	    open.push (Open_t (c, (*itEdge)->to ()));
+	  }
+	}
+      }
+    }
+
+    void RrtStarPlanner::propagateCost (const NodePtr_t& node)
+    {
+      std::deque <NodePtr_t> queue (1, node);
+      while (!queue.empty ()) {
+	NodePtr_t current (queue.front ());
+	queue.pop_front ();
+	const Node::Edges_t& outEdges (current->outEdges ());
+	for (Node::Edges_t::const_iterator itEdge = outEdges.begin ();
+	     itEdge != outEdges.end (); ++itEdge) {
+	  std::size_t child = (*itEdge)->to ()->index ();
+	  if (parents_ [child] != *itEdge) continue;
+	  costs_ [child] = costs_ [current->index ()] + cost (*itEdge);
+	  queue.push_back ((*itEdge)->to ());
+	}
+      }
+    }
+
+    void RrtStarPlanner::connect (const NodePtr_t& parent,
+				  const NodePtr_t& child,
+				  const PathPtr_t& path, value_type cost)
+    {
+      RoadmapPtr_t r (roadmap ());
+      EdgePtr_t edge (r->addEdge (parent, child, path));
+      interval_t timeRange = path->timeRange ();
+      r->addEdge (child, parent, path->extract
+		  (interval_t (timeRange.second, timeRange.first)));
+      costs_ [child->index ()] = cost;
+      parents_ [child->index ()] = edge;
+      propagateCost (child);
+    }
+
+    PathPtr_t RrtStarPlanner::steer (ConfigurationIn_t q1,
+				     ConfigurationIn_t q2) const
+    {
+      PathPtr_t path = (*problem ().steeringMethod ()) (q1, q2);
+      PathProjectorPtr_t pathProjector (problem ().pathProjector ());
+      if (!path || !pathProjector) return path;
+      PathPtr_t projPath;
+      if (!pathProjector->apply (path, projPath)) return PathPtr_t ();
+      return projPath;
+    }
+
+    bool RrtStarPlanner::validate (const PathPtr_t& path) const
+    {
+      return problem ().pathValidation ()->isValid (path);
+    }
+
+    /// This method performs one step of RRT* as follows
+    ///  1. the nearest node of the tree of the initial node is extended
+    ///     toward a random configuration and the valid part of the path,
+    ///     not longer than extensionLength, ends at "q_new",
+    ///  2. the k nearest nodes of the tree to "q_new" are searched,
+    ///  3. the parent of "q_new" is the near node through which the cost
+    ///     of "q_new" is minimal, paths from near nodes cheaper than the
+    ///     extension are validated in order of increasing cost,
+    ///  4. the near nodes and the goal nodes of other connected components
+    ///     closer than the farthest near node are connected from "q_new"
+    ///     if their cost decreases.
+    void RrtStarPlanner::oneStep ()
+    {
+      RoadmapPtr_t r (roadmap ());
+      const value_type inf = std::numeric_limits <value_type>::infinity ();
+      resizeCosts ();
+      ConnectedComponentPtr_t tree (r->initNode ()->connectedComponent ());
+      const ConfigurationPtr_t& q_rand (sample ());
+      value_type distance;
+      NodePtr_t near = r->nearestNode (q_rand, tree, distance);
+      PathPtr_t path = extend (near, q_rand);
+      if (!path) return;
+      const interval_t& range (path->timeRange ());
+      if (range.second - range.first > extensionLength_) {
+	path = path->extract (interval_t (range.first,
+					  range.first + extensionLength_));
+      }
+      PathPtr_t validPath;
+      problem ().pathValidation ()->validateWithoutReport (path, false,
+							   validPath);
+      if (validPath->timeRange ().second == path->timeRange ().first) {
+	return;
+      }
+      ConfigurationPtr_t q_new (new Configuration_t (validPath->end ()));
+
+      // Choose parent
+      std::size_t n = tree->nodes ().size ();
+      std::size_t k = std::max ((std::size_t) std::ceil
+				(neighborFactor_ * std::log ((value_type) n)),
+				(std::size_t) 1);
+      value_type radius;
+      Nodes_t nearNodes (r->nearestNodes (q_new, tree, k, radius));
+      Candidate best;
+      best.cost = costs_ [near->index ()] + cost (validPath);
+      best.node = near;
+      best.path = validPath;
+      Candidates_t candidates;
+      for (Nodes_t::const_iterator itNode = nearNodes.begin ();
+	   itNode != nearNodes.end (); ++itNode) {
+	if (*itNode == near || costs_ [(*itNode)->index ()] == inf) continue;
+	Candidate c;
+	c.node = *itNode;
+	c.path = steer (*((*itNode)->configuration ()), *q_new);
+	if (!c.path || c.path->end () != *q_new) continue;
+	c.cost = costs_ [(*itNode)->index ()] + cost (c.path);
+	if (c.cost < best.cost) candidates.push_back (c);
+      }
+      std::sort (candidates.begin (), candidates.end ());
+      for (Candidates_t::const_iterator itc = candidates.begin ();
+	   itc != candidates.end (); ++itc) {
+	if (validate (itc->path)) {
+	  best = *itc;
+	  break;
+	}
+      }
+      NodePtr_t newNode (r->addNodeAndEdges (best.node, q_new, best.path));
+      resizeCosts ();
+      // q_new may already be in the tree.
+      if (best.cost < costs_ [newNode->index ()]) {
+	costs_ [newNode->index ()] = best.cost;
+	parents_ [newNode->index ()] = edgeTo (best.node, newNode);
+	propagateCost (newNode);
+      }
+
+      // Rewire near nodes and connect goal nodes
+      for (Nodes_t::const_iterator itGoal = r->goalNodes ().begin ();
+	   itGoal != r->goalNodes ().end (); ++itGoal) {
+	if ((*itGoal)->connectedComponent () != tree &&
+	    (*problem ().distance ()) (*q_new, *((*itGoal)->configuration ()))
+	    <= radius) {
+	  nearNodes.push_back (*itGoal);
+	}
+      }
+      for (Nodes_t::const_iterator itNode = nearNodes.begin ();
+	   itNode != nearNodes.end (); ++itNode) {
+	if (*itNode == best.node || *itNode == newNode) continue;
+	const Configuration_t& q (*((*itNode)->configuration ()));
+	PathPtr_t p (steer (*q_new, q));
+	if (!p || p->end () != q) continue;
+	value_type c = costs_ [newNode->index ()] + cost (p);
+	if (c < costs_ [(*itNode)->index ()] && validate (p)) {
+	  hppDout (info, "rewire " << displayConfig (q));
+	  connect (newNode, *itNode, p, c);
+	}
+      }
+    }
+  } // namespace core
+} // namespace hpp
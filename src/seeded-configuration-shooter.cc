@@ -0,0 +1,177 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/model/joint-configuration.hh>
+#include <hpp/core/seeded-configuration-shooter.hh>
+
+namespace hpp {
+  namespace core {
+    SeededConfigurationShooterPtr_t SeededConfigurationShooter::create
+    (const DevicePtr_t& robot, unsigned int seed)
+    {
+      SeededConfigurationShooter* ptr =
+	new SeededConfigurationShooter (robot, seed);
+      SeededConfigurationShooterPtr_t shPtr (ptr);
+      ptr->init (shPtr);
+      return shPtr;
+    }
+
+    SeededConfigurationShooterPtr_t SeededConfigurationShooter::copy
+    (const DevicePtr_t& robot) const
+    {
+      return create (robot, generator_ ());
+    }
+
+    void SeededConfigurationShooter::seed (unsigned int seed)
+    {
+      generator_.seed (seed);
+    }
+
+    SeededConfigurationShooter::SeededConfigurationShooter
+    (const DevicePtr_t& robot, unsigned int seed) : ConfigurationShooter (),
+      robot_ (robot), samplers_ (), generator_ (seed), weak_ ()
+    {
+      const JointVector_t& jv = robot_->getJointVector ();
+      for (JointVector_t::const_iterator itJoint = jv.begin ();
+	   itJoint != jv.end (); ++itJoint) {
+	const JointPtr_t& joint (*itJoint);
+	size_type rank = joint->rankInConfiguration ();
+	if (joint->configSize () == 0) continue;
+	if (dynamic_cast <model::JointSO3*> (joint)) {
+	  addSampler (Sampler::UNIT_QUATERNION, rank);
+	} else if (dynamic_cast <model::jointRotation::UnBounded*> (joint)) {
+	  if (joint->configSize () == 2) {
+	    addSampler (Sampler::UNIT_COMPLEX, rank);
+	  } else {
+	    addSampler (Sampler::ANGLE, rank);
+	  }
+	} else {
+	  JointConfigurationPtr_t jc (joint->configuration ());
+	  for (size_type i = 0; i < joint->configSize (); ++i) {
+	    if (!jc->isBounded (i)) {
+	      std::ostringstream oss;
+	      oss << "Cannot uniformly sample unbounded joint "
+		  << joint->name () << ", rank " << i << ".";
+	      throw std::runtime_error (oss.str ());
+	    }
+	    addSampler (Sampler::INTERVAL, rank + i, jc->lowerBound (i),
+			jc->upperBound (i));
+	  }
+	}
+      }
+      // Extra configuration variables
+      size_type extraDim = robot_->extraConfigSpace ().dimension ();
+      size_type offset = robot_->configSize () - extraDim;
+      for (size_type i = 0; i < extraDim; ++i) {
+	value_type lower = robot_->extraConfigSpace ().lower (i);
+	value_type upper = robot_->extraConfigSpace ().upper (i);
+	value_type range = upper - lower;
+	if ((range < 0) ||
+	    (range == std::numeric_limits <value_type>::infinity ())) {
+	  std::ostringstream oss;
+	  oss << "Cannot uniformly sample extra config variable " << i
+	      << ". min = " << lower << ", max = " << upper;
+	  throw std::runtime_error (oss.str ());
+	}
+	addSampler (Sampler::INTERVAL, offset + i, lower, upper);
+      }
+    }
+
+    void SeededConfigurationShooter::init
+    (const SeededConfigurationShooterPtr_t& self)
+    {
+      ConfigurationShooter::init (self);
+      weak_ = self;
+    }
+
+    void SeededConfigurationShooter::addSampler
+    (Sampler::Type type, size_type rank, value_type lower, value_type upper)
+    {
+      Sampler sampler;
+      sampler.type = type;
+      sampler.rank = rank;
+      sampler.lower = lower;
+      sampler.upper = upper;
+      samplers_.push_back (sampler);
+    }
+
+    value_type SeededConfigurationShooter::uniform () const
+    {
+      // 32 random bits are enough for sampling.
+      return (value_type) generator_ () / 4294967296.;
+    }
+
+    ConfigurationPtr_t SeededConfigurationShooter::shoot () const
+    {
+      ConfigurationPtr_t config (new Configuration_t (robot_->configSize ()));
+      sample (*config);
+      return config;
+    }
+
+    void SeededConfigurationShooter::shoot (matrixOut_t configurations) const
+    {
+      for (size_type i = 0; i < configurations.cols (); ++i) {
+	sample (configurations.col (i));
+      }
+    }
+
+    void SeededConfigurationShooter::sample (ConfigurationOut_t q) const
+    {
+      assert (q.size () == robot_->configSize ());
+      for (Samplers_t::const_iterator it = samplers_.begin ();
+	   it != samplers_.end (); ++it) {
+	switch (it->type) {
+	case Sampler::INTERVAL:
+	  q [it->rank] = it->lower + (it->upper - it->lower) * uniform ();
+	  break;
+	case Sampler::ANGLE:
+	  q [it->rank] = M_PI * (2 * uniform () - 1);
+	  break;
+	case Sampler::UNIT_COMPLEX:
+	  {
+	    value_type angle = M_PI * (2 * uniform () - 1);
+	    q [it->rank] = cos (angle);
+	    q [it->rank + 1] = sin (angle);
+	  }
+	  break;
+	case Sampler::UNIT_QUATERNION:
+	  {
+	    // Uniform sampling of the unit sphere in R^4 (Shoemake)
+	    value_type u1 = uniform ();
+	    value_type a2 = 2 * M_PI * uniform ();
+	    value_type a3 = 2 * M_PI * uniform ();
+	    value_type r1 = sqrt (1 - u1);
+	    value_type r2 = sqrt (u1);
+	    q [it->rank] = r1 * sin (a2);
+	    q [it->rank + 1] = r1 * cos (a2);
+	    q [it->rank + 2] = r2 * sin (a3);
+	    q [it->rank + 3] = r2 * cos (a3);
+	  }
+	  break;
+	}
+      }
+    }
+  } //   namespace core
+} // namespace hpp
@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <limits>
+#include <boost/thread/thread_time.hpp>
+#include <hpp/core/cancellation-token.hh>
+#include <hpp/core/path-planner.hh>
+#include <hpp/core/solve-future.hh>
+
+namespace hpp {
+  namespace core {
+    SolveFuture::SolveFuture (const PathPlannerPtr_t& planner,
+			      const CancellationTokenPtr_t& token) :
+      planner_ (planner), token_ (token),
+      initialSteps_ (planner->latencies ().oneStep.count), mutex_ (),
+      finished_ (), status_ (PLANNING), path_ (), optimizedPaths_ (0),
+      error_ ()
+    {
+    }
+
+    SolveFuture::Status SolveFuture::status () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return status_;
+    }
+
+    bool SolveFuture::done () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return status_ != PLANNING && status_ != OPTIMIZING;
+    }
+
+    void SolveFuture::wait () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      while (status_ == PLANNING || status_ == OPTIMIZING) {
+	finished_.wait (lock);
+      }
+    }
+
+    bool SolveFuture::timedWait (value_type seconds) const
+    {
+      if (seconds == std::numeric_limits <value_type>::infinity ()) {
+	wait ();
+	return true;
+      }
+      const boost::system_time deadline
+	(boost::get_system_time () +
+	 boost::posix_time::microseconds ((boost::int64_t) (1e6 * seconds)));
+      boost::mutex::scoped_lock lock (mutex_);
+      while (status_ == PLANNING || status_ == OPTIMIZING) {
+	if (!finished_.timed_wait (lock, deadline)) {
+	  return status_ != PLANNING && status_ != OPTIMIZING;
+	}
+      }
+      return true;
+    }
+
+    void SolveFuture::cancel ()
+    {
+      token_->cancel ();
+    }
+
+    std::size_t SolveFuture::planningIterations () const
+    {
+      // Histograms can be read while the planner records durations.
+      const boost::uint64_t steps (planner_->latencies ().oneStep.count);
+      // Durations may have been removed by PathPlanner::resetLatencies.
+      return steps > initialSteps_ ? (std::size_t) (steps - initialSteps_) :
+	0;
+    }
+
+    std::size_t SolveFuture::numberOptimizedPaths () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return optimizedPaths_;
+    }
+
+    PathVectorPtr_t SolveFuture::path () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return path_;
+    }
+
+    std::string SolveFuture::error () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return error_;
+    }
+
+    void SolveFuture::publish (const PathVectorPtr_t& path, bool optimized)
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      path_ = path;
+      if (optimized) ++optimizedPaths_;
+      else status_ = OPTIMIZING;
+    }
+
+    void SolveFuture::finish (Status status, const std::string& error)
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      status_ = status;
+      error_ = error;
+      finished_.notify_all ();
+    }
+  } // namespace core
+} // namespace hpp
@@ -0,0 +1,157 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <limits>
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <hpp/core/path-optimizer.hh>
+#include <hpp/core/path-planner.hh>
+#include <hpp/core/path-vector.hh>
+#include <hpp/core/problem.hh>
+#include <hpp/core/roadmap.hh>
+#include <hpp/core/solver-pool.hh>
+
+namespace hpp {
+  namespace core {
+    SolverPoolPtr_t SolverPool::create (const PathPlannerBuilder_t& pathPlanner)
+    {
+      SolverPool* ptr = new SolverPool (pathPlanner);
+      return SolverPoolPtr_t (ptr);
+    }
+
+    SolverPool::SolverPool (const PathPlannerBuilder_t& pathPlanner) :
+      problems_ (), busy_ (), parameters_ (), mutex_ (), contextReleased_ ()
+    {
+      parameters_.pathPlanner = pathPlanner;
+      parameters_.timeOut = std::numeric_limits <value_type>::infinity ();
+      parameters_.maxIterations = 0;
+    }
+
+    SolverPool::~SolverPool ()
+    {
+      for (std::vector <ProblemPtr_t>::iterator it = problems_.begin ();
+	   it != problems_.end (); ++it) {
+	delete *it;
+      }
+    }
+
+    void SolverPool::addContext (ProblemPtr_t problem)
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      problems_.push_back (problem);
+      busy_.push_back (false);
+      contextReleased_.notify_one ();
+    }
+
+    std::size_t SolverPool::numberContexts () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return problems_.size ();
+    }
+
+    void SolverPool::addPathOptimizer
+    (const PathOptimizerBuilder_t& pathOptimizer)
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      parameters_.pathOptimizers.push_back (pathOptimizer);
+    }
+
+    void SolverPool::planningBudget (value_type seconds,
+				     std::size_t iterations)
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      parameters_.timeOut = seconds;
+      parameters_.maxIterations = iterations;
+    }
+
+    std::size_t SolverPool::acquire (Parameters& parameters,
+				     ProblemPtr_t& problem)
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      if (problems_.empty ()) {
+	throw std::runtime_error ("The solver pool has no context.");
+      }
+      while (true) {
+	for (std::size_t context = 0; context < busy_.size (); ++context) {
+	  if (!busy_ [context]) {
+	    busy_ [context] = true;
+	    parameters = parameters_;
+	    problem = problems_ [context];
+	    return context;
+	  }
+	}
+	contextReleased_.wait (lock);
+      }
+    }
+
+    void SolverPool::release (std::size_t context)
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      busy_ [context] = false;
+      contextReleased_.notify_one ();
+    }
+
+    namespace {
+      // Release a context when leaving the scope
+      struct ContextReleaser
+      {
+	ContextReleaser (const boost::function <void ()>& release) :
+	  release (release)
+	{
+	}
+	~ContextReleaser ()
+	{
+	  release ();
+	}
+	boost::function <void ()> release;
+      }; // struct ContextReleaser
+    } // namespace
+
+    PathVectorPtr_t SolverPool::solve (const Configuration_t& init,
+				       const Configurations_t& goals)
+    {
+      Parameters parameters;
+      ProblemPtr_t acquired;
+      std::size_t context = acquire (parameters, acquired);
+      ContextReleaser releaser (boost::bind (&SolverPool::release, this,
+					     context));
+      // Only the thread that acquired the context accesses its problem.
+      Problem& problem (*acquired);
+      problem.initConfig (ConfigurationPtr_t (new Configuration_t (init)));
+      problem.resetGoalConfigs ();
+      for (Configurations_t::const_iterator itGoal = goals.begin ();
+	   itGoal != goals.end (); ++itGoal) {
+	problem.addGoalConfig (ConfigurationPtr_t
+			       (new Configuration_t (**itGoal)));
+      }
+      RoadmapPtr_t roadmap (Roadmap::create (problem.distance (),
+					     problem.robot ()));
+      PathPlannerPtr_t planner (parameters.pathPlanner (problem, roadmap));
+      planner->timeOut (parameters.timeOut);
+      planner->maxIterations (parameters.maxIterations);
+      PathVectorPtr_t path (planner->solve ());
+      for (std::vector <PathOptimizerBuilder_t>::const_iterator it =
+	     parameters.pathOptimizers.begin ();
+	   it != parameters.pathOptimizers.end (); ++it) {
+	path = (*it) (problem)->optimize (path);
+      }
+      return path;
+    }
+  } // namespace core
+} // namespace hpp
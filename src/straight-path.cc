@@ -17,12 +17,15 @@
 // <http://www.gnu.org/licenses/>.
 
 #include <hpp/util/debug.hh>
+#include <hpp/model/configuration.hh>
 #include <hpp/model/device.hh>
 #include <hpp/model/joint.hh>
 #include <hpp/model/joint-configuration.hh>
 #include <hpp/core/config-projector.hh>
 #include <hpp/core/straight-path.hh>
 #include <hpp/core/projection-error.hh>
+#include "interpolation-plan.hh"
+#include "memory-usage.hh"
 
 namespace hpp {
   namespace core {
@@ -32,7 +35,8 @@ namespace hpp {
 				value_type length) :
       parent_t (interval_t (0, length), device->configSize (),
 		device->numberDof ()),
-      device_ (device), initial_ (init), end_ (end)
+      device_ (device), initial_ (init), end_ (end),
+      plan_ (InterpolationPlan::get (device))
     {
       assert (device);
       assert (length >= 0);
@@ -46,7 +50,8 @@ namespace hpp {
 				ConstraintSetPtr_t constraints) :
       parent_t (interval_t (0, length), device->configSize (),
 		device->numberDof (), constraints),
-      device_ (device), initial_ (init), end_ (end)
+      device_ (device), initial_ (init), end_ (end),
+      plan_ (InterpolationPlan::get (device))
     {
       assert (device);
       assert (length >= 0);
@@ -60,14 +65,14 @@ namespace hpp {
 
     StraightPath::StraightPath (const StraightPath& path) :
       parent_t (path), device_ (path.device_), initial_ (path.initial_),
-      end_ (path.end_)
+      end_ (path.end_), plan_ (path.plan_)
     {
     }
 
     StraightPath::StraightPath (const StraightPath& path,
 				const ConstraintSetPtr_t& constraints) :
       parent_t (path, constraints), device_ (path.device_),
-      initial_ (path.initial_), end_ (path.end_)
+      initial_ (path.initial_), end_ (path.end_), plan_ (path.plan_)
     {
       assert (constraints->apply (initial_));
       assert (constraints->apply (end_));
@@ -86,19 +91,48 @@ namespace hpp {
 	result = end_;
 	return true;
       }
-      value_type u = param/timeRange ().second;
-      if (timeRange ().second == 0)
-	u = 0;
-      // Loop over device joint and interpolate
-      const JointVector_t& jv (device_->getJointVector ());
-      for (model::JointVector_t::const_iterator itJoint = jv.begin ();
-	   itJoint != jv.end (); ++itJoint) {
-	std::size_t rank = (*itJoint)->rankInConfiguration ();
-	(*itJoint)->configuration ()->interpolate
-	  (initial_, end_, u, rank, result);
+      plan_->interpolate (initial_, end_, param / timeRange ().second,
+			  result);
+      return true;
+    }
+
+    void StraightPath::impl_eval (vectorIn_t times,
+				  matrixOut_t configurations,
+				  std::vector <bool>& success) const
+    {
+      const value_type T = timeRange ().second;
+      if (T != 0) {
+	plan_->interpolate (initial_, end_, times / T, configurations);
+      }
+      for (size_type i = 0; i < times.size (); ++i) {
+	const value_type& param = times [i];
+	if (param == timeRange ().first || T == 0) {
+	  configurations.col (i) = initial_;
+	} else if (param == T) {
+	  configurations.col (i) = end_;
+	}
+	success [i] = true;
+      }
+    }
+
+    bool StraightPath::impl_velocityBound (vectorOut_t result, value_type,
+					   value_type) const
+    {
+      if (timeRange ().second == 0) {
+	result.setZero ();
+	return true;
       }
+      model::difference (device_, end_, initial_, result);
+      result = result.cwiseAbs () / timeRange ().second;
       return true;
     }
+
+    std::size_t StraightPath::impl_memoryUsage () const
+    {
+      return sizeof (StraightPath) + memory::bytes (initial_) +
+	memory::bytes (end_);
+    }
+
     PathPtr_t StraightPath::extract (const interval_t& subInterval) const
     {
       // Length is assumed to be proportional to interval range
@@ -116,6 +150,23 @@ namespace hpp {
       return result;
     }
 
+    void StraightPath::reset (ConfigurationIn_t init, ConfigurationIn_t end,
+			      value_type length)
+    {
+      assert (init.size () == initial_.size ());
+      assert (end.size () == end_.size ());
+      assert (length >= 0);
+      initial_ = init;
+      end_ = end;
+      timeRange_ = interval_t (0, length);
+      const ConstraintSetPtr_t& c (constraints ());
+      if (c && c->configProjector ()) {
+	c->configProjector ()->rightHandSideFromConfig (initial_);
+      }
+      assert (!c || c->isSatisfied (initial_));
+      assert (!c || c->isSatisfied (end_));
+    }
+
     DevicePtr_t StraightPath::device () const
     {
       return device_;
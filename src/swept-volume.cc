@@ -0,0 +1,111 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <hpp/fcl/collision_object.h>
+#include <hpp/model/body.hh>
+#include <hpp/model/collision-object.hh>
+#include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/core/path.hh>
+#include <hpp/core/swept-volume.hh>
+
+namespace hpp {
+  namespace core {
+    SweptVolumePtr_t SweptVolume::create (const DevicePtr_t& robot)
+    {
+      SweptVolume* ptr = new SweptVolume (robot);
+      return SweptVolumePtr_t (ptr);
+    }
+
+    SweptVolume::SweptVolume (const DevicePtr_t& robot) :
+      robot_ (robot), joints_ (), coefficients_ (), bound_ (), q_ ()
+    {
+      const JointVector_t& jv = robot->getJointVector ();
+      for (JointVector_t::const_iterator itJoint = jv.begin ();
+	   itJoint != jv.end (); ++itJoint) {
+	BodyPtr_t body = (*itJoint)->linkedBody ();
+	if (!body || body->innerObjects (model::COLLISION).empty ()) continue;
+	joints_.push_back (*itJoint);
+	// Velocity of the points of the body is bounded by the sum over the
+	// ancestors of the joint of the linear velocity plus the angular
+	// velocity times the maximal distance to the body.
+	std::vector <CoefficientVelocity_t> coefficients;
+	value_type cumulativeLength = body->radius ();
+	for (JointConstPtr_t child = *itJoint; child;
+	     child = child->parentJoint ()) {
+	  coefficients.push_back
+	    (CoefficientVelocity_t (child, child->upperBoundLinearVelocity () +
+				    cumulativeLength *
+				    child->upperBoundAngularVelocity ()));
+	  cumulativeLength += child->maximalDistanceToParent ();
+	}
+	coefficients_.push_back (coefficients);
+      }
+    }
+
+    bool SweptVolume::compute (const PathPtr_t& path, Boxes_t& boxes)
+    {
+      const interval_t& range = path->timeRange ();
+      bound_.resize (path->outputDerivativeSize ());
+      if (!path->velocityBound (bound_, range.first, range.second)) {
+	return false;
+      }
+      const value_type halfLength = .5 * (range.second - range.first);
+      q_.resize (path->outputSize ());
+      if (!(*path) (q_, range.first + halfLength)) return false;
+      robot_->currentConfiguration (q_);
+      robot_->computeForwardKinematics ();
+      boxes.resize (joints_.size ());
+      for (std::size_t i = 0; i < joints_.size (); ++i) {
+	fcl::AABB& box (boxes [i]);
+	box = fcl::AABB ();
+	const ObjectVector_t& objects =
+	  joints_ [i]->linkedBody ()->innerObjects (model::COLLISION);
+	for (ObjectVector_t::const_iterator itObj = objects.begin ();
+	     itObj != objects.end (); ++itObj) {
+	  (*itObj)->fcl ()->computeAABB ();
+	  box += (*itObj)->fcl ()->getAABB ();
+	}
+	value_type velocity = 0;
+	for (std::vector <CoefficientVelocity_t>::const_iterator itCoef =
+	       coefficients_ [i].begin (); itCoef != coefficients_ [i].end ();
+	     ++itCoef) {
+	  const JointConstPtr_t& joint = itCoef->first;
+	  velocity += itCoef->second * bound_.segment
+	    (joint->rankInVelocity (), joint->numberDof ()).norm ();
+	}
+	const value_type distance = velocity * halfLength;
+	box.expand (fcl::Vec3f (distance, distance, distance));
+      }
+      return true;
+    }
+
+    bool SweptVolume::overlap (const Boxes_t& boxes1, const Boxes_t& boxes2)
+    {
+      for (Boxes_t::const_iterator it1 = boxes1.begin ();
+	   it1 != boxes1.end (); ++it1) {
+	for (Boxes_t::const_iterator it2 = boxes2.begin ();
+	     it2 != boxes2.end (); ++it2) {
+	  if (it1->overlap (*it2)) return true;
+	}
+      }
+      return false;
+    }
+  } // namespace core
+} // namespace hpp
@@ -0,0 +1,183 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <hpp/core/time-parameterized-path.hh>
+
+namespace hpp {
+  namespace core {
+    TimeParameterizedPathPtr_t TimeParameterizedPath::create
+    (const PathPtr_t& original, value_type velocity, value_type acceleration)
+    {
+      TimeParameterizedPath* ptr = new TimeParameterizedPath
+	(original, velocity, acceleration);
+      TimeParameterizedPathPtr_t shPtr (ptr);
+      ptr->init (shPtr);
+      return shPtr;
+    }
+
+    TimeParameterizedPathPtr_t TimeParameterizedPath::createCopy
+    (const TimeParameterizedPathPtr_t& path)
+    {
+      TimeParameterizedPath* ptr = new TimeParameterizedPath (*path);
+      TimeParameterizedPathPtr_t shPtr (ptr);
+      ptr->init (shPtr);
+      return shPtr;
+    }
+
+    TimeParameterizedPathPtr_t TimeParameterizedPath::createCopy
+    (const TimeParameterizedPathPtr_t& path,
+     const ConstraintSetPtr_t& constraints)
+    {
+      TimeParameterizedPath* ptr = new TimeParameterizedPath
+	(*path, constraints);
+      TimeParameterizedPathPtr_t shPtr (ptr);
+      ptr->init (shPtr);
+      return shPtr;
+    }
+
+    TimeParameterizedPath::TimeParameterizedPath
+    (const PathPtr_t& original, value_type velocity,
+     value_type acceleration) :
+      Path (interval_t (0, 0), original->outputSize (),
+	    original->outputDerivativeSize (), original->constraints ()),
+      original_ (original), velocity_ (velocity),
+      acceleration_ (acceleration), accelerationTime_ (0), weak_ ()
+    {
+      assert (velocity > 0);
+      assert (acceleration > 0);
+      const value_type inf = std::numeric_limits <value_type>::infinity ();
+      const value_type length = original->length ();
+      if (length <= 0 || (velocity == inf && acceleration == inf)) {
+	velocity_ = 0;
+	acceleration_ = 0;
+	return;
+      }
+      // The maximal velocity is not reached if the path is shorter than the
+      // distances covered by accelerating and decelerating.
+      if (velocity_ * velocity_ > length * acceleration_) {
+	velocity_ = sqrt (length * acceleration_);
+      }
+      accelerationTime_ = velocity_ / acceleration_;
+      timeRange_.second = length / velocity_ + accelerationTime_;
+    }
+
+    TimeParameterizedPath::TimeParameterizedPath
+    (const TimeParameterizedPath& path) :
+      Path (path), original_ (path.original_), velocity_ (path.velocity_),
+      acceleration_ (path.acceleration_),
+      accelerationTime_ (path.accelerationTime_), weak_ ()
+    {
+    }
+
+    TimeParameterizedPath::TimeParameterizedPath
+    (const TimeParameterizedPath& path,
+     const ConstraintSetPtr_t& constraints) :
+      Path (path, constraints), original_ (path.original_),
+      velocity_ (path.velocity_), acceleration_ (path.acceleration_),
+      accelerationTime_ (path.accelerationTime_), weak_ ()
+    {
+    }
+
+    void TimeParameterizedPath::init
+    (const TimeParameterizedPathPtr_t& self)
+    {
+      parent_t::init (self);
+      weak_ = self;
+    }
+
+    value_type TimeParameterizedPath::originalParam (value_type t) const
+    {
+      const value_type T = timeRange_.second;
+      const value_type length = original_->length ();
+      const value_type s0 = original_->timeRange ().first;
+      if (T == 0) return s0;
+      value_type s;
+      if (t < accelerationTime_) {
+	s = .5 * acceleration_ * t * t;
+      } else if (T - t < accelerationTime_) {
+	s = length - .5 * acceleration_ * (T - t) * (T - t);
+      } else {
+	s = velocity_ * (t - .5 * accelerationTime_);
+      }
+      return s0 + std::min (std::max (s, (value_type) 0), length);
+    }
+
+    value_type TimeParameterizedPath::paramDerivative (value_type t) const
+    {
+      const value_type T = timeRange_.second;
+      if (T == 0) return 0;
+      t = std::min (std::max (t, (value_type) 0), T);
+      if (t < accelerationTime_) return acceleration_ * t;
+      if (T - t < accelerationTime_) return acceleration_ * (T - t);
+      return velocity_;
+    }
+
+    void TimeParameterizedPath::impl_eval
+    (vectorIn_t times, matrixOut_t configurations,
+     std::vector <bool>& success) const
+    {
+      vector_t originalTimes (times.size ());
+      for (size_type i = 0; i < times.size (); ++i) {
+	originalTimes [i] = originalParam (times [i]);
+      }
+      original_->impl_eval (originalTimes, configurations, success);
+    }
+
+    std::size_t TimeParameterizedPath::impl_memoryUsage () const
+    {
+      return sizeof (TimeParameterizedPath) + original_->memoryUsage ();
+    }
+
+    bool TimeParameterizedPath::impl_velocityBound
+    (vectorOut_t result, value_type t0, value_type t1) const
+    {
+      if (!original_->velocityBound (result, originalParam (t0),
+				     originalParam (t1))) {
+	return false;
+      }
+      // The derivative of the parameter increases, stays constant and
+      // decreases: it is maximal on the interval if the interval overlaps
+      // the constant phase.
+      const value_type T = timeRange_.second;
+      value_type derivative;
+      if (t0 <= T - accelerationTime_ && t1 >= accelerationTime_) {
+	derivative = velocity_;
+      } else {
+	derivative = std::max (paramDerivative (t0), paramDerivative (t1));
+      }
+      result *= derivative;
+      return true;
+    }
+
+    std::ostream& TimeParameterizedPath::print (std::ostream &os) const
+    {
+      os << "Time parameterized path:" << std::endl;
+      os << "interval: [ " << timeRange ().first << ", "
+	 << timeRange ().second << " ]" << std::endl;
+      os << "velocity: " << velocity_ << ", acceleration: "
+	 << acceleration_ << std::endl;
+      os << "original path:" << std::endl;
+      os << *original_ << std::endl;
+      return os;
+    }
+  } //   namespace core
+} // namespace hpp
@@ -0,0 +1,205 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+#include <fstream>
+#include <set>
+#include <stdexcept>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <hpp/core/trace.hh>
+
+namespace hpp {
+  namespace core {
+    namespace {
+      struct Event
+      {
+	const char* name;
+	boost::posix_time::ptime start;
+	boost::posix_time::time_duration duration;
+	std::size_t thread;
+      }; // struct Event
+      typedef std::vector <Event> Events_t;
+
+      // Events of one thread. The mutex is only contended when events are
+      // written or cleared.
+      struct ThreadEvents
+      {
+	ThreadEvents (std::size_t id) : mutex (), events (), thread (id) {}
+	boost::mutex mutex;
+	Events_t events;
+	std::size_t thread;
+      }; // struct ThreadEvents
+
+      // Events of running threads and events of terminated threads,
+      // protected by a mutex
+      struct Registry
+      {
+	Registry () : mutex (), threads (), retired (), numberThreads (0) {}
+	boost::mutex mutex;
+	std::set <ThreadEvents*> threads;
+	Events_t retired;
+	std::size_t numberThreads;
+      }; // struct Registry
+
+      // Never destroyed: the buffer of the main thread is retired by the
+      // destructor of the thread specific pointer, at exit.
+      Registry& registry ()
+      {
+	static Registry* instance = new Registry;
+	return *instance;
+      }
+
+      // Called at termination of a thread
+      void retire (ThreadEvents* events)
+      {
+	Registry& r (registry ());
+	{
+	  boost::mutex::scoped_lock lock (r.mutex);
+	  r.retired.insert (r.retired.end (), events->events.begin (),
+			    events->events.end ());
+	  r.threads.erase (events);
+	}
+	delete events;
+      }
+
+      boost::thread_specific_ptr <ThreadEvents> local (&retire);
+
+      ThreadEvents& localEvents ()
+      {
+	ThreadEvents* events = local.get ();
+	if (!events) {
+	  Registry& r (registry ());
+	  boost::mutex::scoped_lock lock (r.mutex);
+	  events = new ThreadEvents (r.numberThreads++);
+	  r.threads.insert (events);
+	  local.reset (events);
+	}
+	return *events;
+      }
+
+      // Events are stored in the order of their end: nested events first.
+      void earliest (const Events_t& events, boost::posix_time::ptime& start)
+      {
+	for (Events_t::const_iterator it = events.begin ();
+	     it != events.end (); ++it) {
+	  if (it->start < start) start = it->start;
+	}
+      }
+
+      void writeEvent (std::ostream& os, const Event& event,
+		       const boost::posix_time::ptime& origin, bool& first)
+      {
+	if (!first) os << ",";
+	first = false;
+	os << std::endl << "{\"name\":\"" << event.name
+	   << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread
+	   << ",\"ts\":" << (event.start - origin).total_microseconds ()
+	   << ",\"dur\":" << event.duration.total_microseconds () << "}";
+      }
+    } // namespace
+
+    boost::atomic <bool> Trace::enabled_ (false);
+
+    void Trace::enable (bool enable)
+    {
+      enabled_.store (enable, boost::memory_order_relaxed);
+    }
+
+    void Trace::add (const char* name, const boost::posix_time::ptime& start)
+    {
+      ThreadEvents& events (localEvents ());
+      Event event;
+      event.name = name;
+      event.start = start;
+      event.duration =
+	boost::posix_time::microsec_clock::universal_time () - start;
+      event.thread = events.thread;
+      boost::mutex::scoped_lock lock (events.mutex);
+      events.events.push_back (event);
+    }
+
+    void Trace::clear ()
+    {
+      Registry& r (registry ());
+      boost::mutex::scoped_lock lock (r.mutex);
+      r.retired.clear ();
+      for (std::set <ThreadEvents*>::const_iterator it = r.threads.begin ();
+	   it != r.threads.end (); ++it) {
+	boost::mutex::scoped_lock threadLock ((*it)->mutex);
+	(*it)->events.clear ();
+      }
+    }
+
+    std::size_t Trace::numberEvents ()
+    {
+      Registry& r (registry ());
+      boost::mutex::scoped_lock lock (r.mutex);
+      std::size_t result = r.retired.size ();
+      for (std::set <ThreadEvents*>::const_iterator it = r.threads.begin ();
+	   it != r.threads.end (); ++it) {
+	boost::mutex::scoped_lock threadLock ((*it)->mutex);
+	result += (*it)->events.size ();
+      }
+      return result;
+    }
+
+    std::ostream& Trace::write (std::ostream& os)
+    {
+      Registry& r (registry ());
+      boost::mutex::scoped_lock lock (r.mutex);
+      // Time stamps are relative to the first event.
+      boost::posix_time::ptime origin (boost::posix_time::pos_infin);
+      earliest (r.retired, origin);
+      for (std::set <ThreadEvents*>::const_iterator it = r.threads.begin ();
+	   it != r.threads.end (); ++it) {
+	boost::mutex::scoped_lock threadLock ((*it)->mutex);
+	earliest ((*it)->events, origin);
+      }
+      bool first = true;
+      os << "{\"traceEvents\":[";
+      for (Events_t::const_iterator it = r.retired.begin ();
+	   it != r.retired.end (); ++it) {
+	writeEvent (os, *it, origin, first);
+      }
+      for (std::set <ThreadEvents*>::const_iterator itThread =
+	     r.threads.begin (); itThread != r.threads.end (); ++itThread) {
+	boost::mutex::scoped_lock threadLock ((*itThread)->mutex);
+	const Events_t& events ((*itThread)->events);
+	for (Events_t::const_iterator it = events.begin ();
+	     it != events.end (); ++it) {
+	  writeEvent (os, *it, origin, first);
+	}
+      }
+      return os << std::endl << "],\"displayTimeUnit\":\"ms\"}" << std::endl;
+    }
+
+    void Trace::write (const std::string& filename)
+    {
+      std::ofstream file (filename.c_str ());
+      if (!file) {
+	throw std::runtime_error ("Cannot open " + filename + ".");
+      }
+      write (file);
+      if (!file) {
+	throw std::runtime_error ("Cannot write " + filename + ".");
+      }
+    }
+  } // namespace core
+} // namespace hpp
@@ -22,6 +22,8 @@
 #include <hpp/core/config-projector.hh>
 #include <hpp/core/config-validations.hh>
 #include <hpp/core/connected-component.hh>
+#include <hpp/core/distance.hh>
+#include <hpp/core/node.hh>
 #include <hpp/core/path-validation.hh>
 #include <hpp/core/problem.hh>
 #include <hpp/core/roadmap.hh>
@@ -30,6 +32,13 @@
 
 #include <stdio.h>
 #include <time.h>
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
 
 namespace hpp {
   namespace core {
@@ -51,14 +60,16 @@ namespace hpp {
 
     VisibilityPrmPlanner::VisibilityPrmPlanner (const Problem& problem):
       PathPlanner (problem),
-      configurationShooter_ (problem.configurationShooter())
+      configurationShooter_ (problem.configurationShooter()),
+      neighborhoodSize_ (0)
     {
     }
 
     VisibilityPrmPlanner::VisibilityPrmPlanner (const Problem& problem,
 						const RoadmapPtr_t& roadmap) :
       PathPlanner (problem, roadmap),
-      configurationShooter_ (problem.configurationShooter())
+      configurationShooter_ (problem.configurationShooter()),
+      neighborhoodSize_ (0)
     {
     }
 
@@ -68,101 +79,324 @@ namespace hpp {
       weakPtr_ = weak;
     }
 
+    namespace {
+      // Apply the constraints of the problem on q, after projecting it on
+      // the tangent space of the constraints at qFrom.
+      // Return whether the projection succeeded.
+      bool applyConstraints (const Problem& problem,
+			     const Configuration_t& qFrom, Configuration_t& q)
+      {
+	ConstraintSetPtr_t constraints (problem.constraints ());
+	if (!constraints) return true;
+	ConfigProjectorPtr_t configProjector (constraints->configProjector ());
+	if (!configProjector) return true;
+	Configuration_t qTo (q);
+	configProjector->projectOnKernel (qFrom, qTo, q);
+	return constraints->apply (q);
+      }
+
+      // Shoot random configurations with a shooter as long as they do not
+      // satisfy the constraints and validations of the problem.
+      ConfigurationPtr_t shootValidConfig
+      (const Problem& problem, const ConfigurationShooterPtr_t& shooter,
+       const Configuration_t& qInit)
+      {
+	ConfigValidationsPtr_t configValidations
+	  (problem.configValidations ());
+	ValidationReportPtr_t report;
+	ConfigurationPtr_t q;
+	bool valid;
+	do {
+	  q = shooter->shoot ();
+	  valid = applyConstraints (problem, qInit, *q);
+	  // Validations that need the positions of the bodies, like
+	  // CollisionValidation, compute the forward kinematics themselves.
+	  if (valid) valid = configValidations->validate (*q, report);
+	} while (!valid);
+	return q;
+      }
+
+      void shootInThread (const Problem* problem, std::size_t thread,
+			  const Configuration_t& qInit,
+			  std::vector <ConfigurationPtr_t>& samples,
+			  std::vector <std::string>& errors)
+      {
+	try {
+	  samples [thread] = shootValidConfig
+	    (*problem, problem->configurationShooter (), qInit);
+	} catch (const std::exception& exc) {
+	  errors [thread] = exc.what ();
+	}
+      }
+
+      // Guard nodes of a connected component and result of the test of
+      // visibility
+      struct Visibility
+      {
+	Nodes_t guards;
+	NodePtr_t node;
+	PathPtr_t path;
+      }; // struct Visibility
+
+      // Test visibility from the components of rank thread,
+      // thread + nbThreads, ... with the objects of a problem owned by the
+      // thread.
+      void testVisibility (const Problem* problem, std::size_t thread,
+			   std::size_t nbThreads, const ConfigurationPtr_t& q,
+			   std::vector <Visibility>& visibilities,
+			   std::vector <std::string>& errors)
+      {
+	try {
+	  PathValidationPtr_t pathValidation (problem->pathValidation ());
+	  SteeringMethodPtr_t sm (problem->steeringMethod ());
+	  PathPtr_t path;
+	  for (std::size_t i = thread; i < visibilities.size ();
+	       i += nbThreads) {
+	    Visibility& visibility (visibilities [i]);
+	    for (Nodes_t::const_iterator itNode = visibility.guards.begin ();
+		 itNode != visibility.guards.end (); ++itNode) {
+	      if ((*sm) (*q, *(*itNode)->configuration (), path) &&
+		  pathValidation->isValid (path)) {
+		visibility.node = *itNode;
+		visibility.path = path->reverse ();
+		break;
+	      }
+	    }
+	  }
+	} catch (const std::exception& exc) {
+	  errors [thread] = exc.what ();
+	}
+      }
+
+      void throwErrors (const std::vector <std::string>& errors)
+      {
+	for (std::size_t thread = 0; thread < errors.size (); ++thread) {
+	  if (!errors [thread].empty ()) {
+	    throw std::runtime_error (errors [thread]);
+	  }
+	}
+      }
+    } // namespace
+
+    void VisibilityPrmPlanner::startSolve ()
+    {
+      PathPlanner::startSolve ();
+      isGuard_.clear ();
+      guards_.clear ();
+    }
+
+    void VisibilityPrmPlanner::addGuard (const NodePtr_t& node)
+    {
+      if (isGuard (node)) return;
+      if (node->index () >= isGuard_.size ()) {
+	isGuard_.resize (node->index () + 1, false);
+      }
+      isGuard_ [node->index ()] = true;
+      guards_.push_back (node);
+    }
+
+    bool VisibilityPrmPlanner::isGuard (const NodePtr_t& node) const
+    {
+      return node->index () < isGuard_.size () && isGuard_ [node->index ()];
+    }
+
+    void VisibilityPrmPlanner::guardsByComponent
+    (std::vector <Nodes_t>& guards) const
+    {
+      const ConnectedComponents_t& ccs (roadmap ()->connectedComponents ());
+      std::map <ConnectedComponentPtr_t, std::size_t> ranks;
+      std::size_t rank = 0;
+      for (ConnectedComponents_t::const_iterator itcc = ccs.begin ();
+	   itcc != ccs.end (); ++itcc, ++rank) {
+	ranks [*itcc] = rank;
+      }
+      guards.assign (ccs.size (), Nodes_t ());
+      // Components of guards may have been merged since the guards were
+      // created.
+      for (Nodes_t::const_iterator itNode = guards_.begin ();
+	   itNode != guards_.end (); ++itNode) {
+	guards [ranks [(*itNode)->connectedComponent ()]].push_back (*itNode);
+      }
+    }
+
+    namespace {
+      typedef std::pair <value_type, NodePtr_t> DistanceAndNode_t;
+      bool closer (const DistanceAndNode_t& n1, const DistanceAndNode_t& n2)
+      {
+	return n1.first < n2.first;
+      }
+    } // namespace
+
+    void VisibilityPrmPlanner::nearestGuards (const ConfigurationPtr_t& q,
+					      Nodes_t& guards) const
+    {
+      // Guards are sorted by increasing distance to q: the first visible
+      // guard node gives the shortest edge.
+      const Distance& distance (*problem ().distance ());
+      std::vector <DistanceAndNode_t> sorted;
+      sorted.reserve (guards.size ());
+      for (Nodes_t::const_iterator itNode = guards.begin ();
+	   itNode != guards.end (); ++itNode) {
+	sorted.push_back (std::make_pair
+			  (distance (*q, *(*itNode)->configuration ()),
+			   *itNode));
+      }
+      std::size_t k = neighborhoodSize_;
+      if (k == 0 || k > sorted.size ()) k = sorted.size ();
+      std::partial_sort (sorted.begin (), sorted.begin () + k, sorted.end (),
+			 closer);
+      guards.clear ();
+      for (std::size_t i = 0; i < k; ++i) guards.push_back (sorted [i].second);
+    }
+
     bool VisibilityPrmPlanner::visibleFromCC (const ConfigurationPtr_t q, 
-					      const ConnectedComponentPtr_t cc){
-      PathPtr_t validPart;
-      bool found = false; 
-      value_type length = std::numeric_limits <value_type>::infinity ();
+					      const Nodes_t& guards){
       PathValidationPtr_t pathValidation (problem ().pathValidation ());
       SteeringMethodPtr_t sm (problem ().steeringMethod ());
-      RoadmapPtr_t r (roadmap ());
-      DelayedEdge_t delayedEdge;
-
-      for (Nodes_t::const_iterator n_it = cc->nodes ().begin (); 
-	   n_it != cc->nodes ().end (); ++n_it){
-	if(nodeStatus_ [*n_it]){// only iterate on guard nodes
+      if (pathValidation->numberThreads () <= 1) {
+	// Only the reverse of a visible path is kept, the same path is
+	// reused for all the guard nodes.
+	PathPtr_t path;
+	for (Nodes_t::const_iterator n_it = guards.begin ();
+	     n_it != guards.end (); ++n_it){
 	  ConfigurationPtr_t qCC = (*n_it)->configuration ();
-	  PathPtr_t path = (*sm) (*q, *qCC);
-	  PathValidationReportPtr_t report;
-	  if (pathValidation->validate (path, false, validPart, report)){
-	    // q and qCC see each other
-	    if (path->length () < length) {
-	      length = path->length ();
-	      // Save shortest edge
-	      delayedEdge = DelayedEdge_t (*n_it, q, path->reverse ());
-	    }
-	    found = true;
+	  if ((*sm) (*q, *qCC, path) && pathValidation->isValid (path)) {
+	    // q and qCC see each other: store shortest delayed edge in list
+	    delayedEdges_.push_back (DelayedEdge_t (*n_it, q,
+						    path->reverse ()));
+	    return true;
 	  }
 	}
+	return false;
+      }
+      // Paths to all the guard nodes are validated in one batch by several
+      // threads, stopping at the first visible guard node: the closest one.
+      std::vector <NodePtr_t> nodes;
+      Paths_t paths;
+      for (Nodes_t::const_iterator n_it = guards.begin (); 
+	   n_it != guards.end (); ++n_it){
+	ConfigurationPtr_t qCC = (*n_it)->configuration ();
+	PathPtr_t path ((*sm) (*q, *qCC));
+	if (path) {
+	  nodes.push_back (*n_it);
+	  paths.push_back (path);
+	}
+      }
+      if (paths.empty ()) return false;
+      Paths_t validParts;
+      std::vector <bool> valid;
+      pathValidation->validateBatch (paths, false, true, validParts, valid);
+      for (std::size_t i = 0; i < paths.size (); ++i) {
+	if (valid [i]) {
+	  // q and qCC see each other: store shortest delayed edge in list
+	  delayedEdges_.push_back (DelayedEdge_t (nodes [i], q,
+						  paths [i]->reverse ()));
+	  return true;
+	}
+      }
+      return false;
+    }
+
+    ConfigurationPtr_t VisibilityPrmPlanner::shootValid
+    (const Configuration_t& qInit)
+    {
+      if (threadProblems ().empty ()) {
+	return shootValidConfig (problem (), configurationShooter_, qInit);
       }
-      if (found) {
-	// Store shortest delayed edge in list
-	delayedEdges_.push_back (delayedEdge);
-	return true;
+      if (samples_.empty ()) {
+	// Each thread shoots one valid configuration.
+	std::size_t nbThreads = threadProblems ().size ();
+	std::vector <ConfigurationPtr_t> samples (nbThreads);
+	std::vector <std::string> errors (nbThreads);
+	boost::thread_group threads;
+	for (std::size_t thread = 0; thread < nbThreads; ++thread) {
+	  threads.create_thread
+	    (boost::bind (&shootInThread, threadProblems () [thread], thread,
+			  boost::cref (qInit), boost::ref (samples),
+			  boost::ref (errors)));
+	}
+	threads.join_all ();
+	throwErrors (errors);
+	samples_.insert (samples_.end (), samples.begin (), samples.end ());
       }
-      else return false;
+      ConfigurationPtr_t q (samples_.front ());
+      samples_.pop_front ();
+      return q;
     }
 
-    ConfigurationPtr_t VisibilityPrmPlanner::applyConstraints 
-    (const ConfigurationPtr_t qFrom, const ConfigurationPtr_t qTo){
-      ConfigurationPtr_t qProj (new Configuration_t (*qTo));
-      ConstraintSetPtr_t constraints (problem ().constraints ());
-      if (constraints) {
-	ConfigProjectorPtr_t configProjector (constraints->configProjector ());
-	if (configProjector) {
-	  constrApply_ = false; // while apply has not successed
-	  configProjector->projectOnKernel (*qFrom, *qTo, *qProj);
-	  if (constraints->apply (*qProj)) {
-	    constrApply_ = true;
-	    return qProj;
-	  }
+    std::size_t VisibilityPrmPlanner::visibleInParallel
+    (const ConfigurationPtr_t& q, std::vector <Nodes_t>& guards)
+    {
+      // Distances to guards are computed by this thread only.
+      std::vector <Visibility> visibilities (guards.size ());
+      for (std::size_t i = 0; i < guards.size (); ++i) {
+	nearestGuards (q, guards [i]);
+	visibilities [i].guards.swap (guards [i]);
+      }
+      std::size_t nbThreads = threadProblems ().size ();
+      std::vector <std::string> errors (nbThreads);
+      boost::thread_group threads;
+      for (std::size_t thread = 0; thread < nbThreads; ++thread) {
+	threads.create_thread
+	  (boost::bind (&testVisibility, threadProblems () [thread], thread,
+			nbThreads, boost::cref (q), boost::ref (visibilities),
+			boost::ref (errors)));
+      }
+      threads.join_all ();
+      throwErrors (errors);
+      // Merge delayed edges in the order of the components
+      std::size_t count = 0;
+      for (std::size_t i = 0; i < visibilities.size (); ++i) {
+	if (visibilities [i].node) {
+	  delayedEdges_.push_back (DelayedEdge_t
+				   (visibilities [i].node, q,
+				    visibilities [i].path));
+	  ++count;
 	}
       }
-      return qTo;
+      return count;
+    }
+
+    void VisibilityPrmPlanner::pruneRoadmap ()
+    {
+      roadmap ()->prune (guards_);
     }
 
     void VisibilityPrmPlanner::oneStep ()
     {
-      DevicePtr_t robot (problem ().robot ());
-      ConfigValidationsPtr_t configValidations (problem ().configValidations());
       RoadmapPtr_t r (roadmap ());
       ConfigurationPtr_t q_rand;
-      value_type count; // number of times q has been seen
-      constrApply_ = true; // stay true if no constraint in Problem
-      ConfigurationPtr_t q_init 
-	(new Configuration_t (*(r->initNode ()->configuration ())));
+      std::size_t count; // number of times q has been seen
+      const Configuration_t& q_init (*(r->initNode ()->configuration ()));
 
       /* Initialization of guard status */
-      nodeStatus_ [r->initNode ()] = true; // init node is guard
+      addGuard (r->initNode ()); // init node is guard
       for (Nodes_t::const_iterator itg = r->goalNodes ().begin();
 	   itg != r->goalNodes ().end (); ++itg) {
-	nodeStatus_ [*itg] = true; // goal nodes are guards
+	addGuard (*itg); // goal nodes are guards
       }
 
       // Shoot random config as long as not collision-free
-      ValidationReportPtr_t report;
-      do {
-	q_rand = configurationShooter_->shoot ();
-	q_rand = applyConstraints(q_init, q_rand);
-	robot->currentConfiguration (*q_rand);
-	robot->computeForwardKinematics ();
-      } while (!configValidations->validate (*q_rand, report) ||
-	       !constrApply_);
+      q_rand = shootValid (q_init);
       count = 0;
 
-      for (ConnectedComponents_t::const_iterator itcc =
-	     r->connectedComponents ().begin ();
-	   itcc != r->connectedComponents ().end (); ++itcc) {
-	ConnectedComponentPtr_t cc = *itcc;
-	if (visibleFromCC (q_rand, cc)) { 
-	  // delayedEdges_ will completed if visible
-	  count++; // count how many times q has been seen
+      std::vector <Nodes_t> guards;
+      guardsByComponent (guards);
+      if (threadProblems ().empty ()) {
+	for (std::size_t i = 0; i < guards.size (); ++i) {
+	  nearestGuards (q_rand, guards [i]);
+	  if (visibleFromCC (q_rand, guards [i])) { 
+	    // delayedEdges_ will completed if visible
+	    count++; // count how many times q has been seen
+	  }
 	}
+      } else {
+	count = visibleInParallel (q_rand, guards);
       }
 	
       if (count == 0){ // q not visible from anywhere
 	NodePtr_t newNode = r->addNode (q_rand); // add q as a guard node
-	nodeStatus_ [newNode] = true;
+	addGuard (newNode);
 	hppDout(info, "q is a guard node: " << displayConfig (*q_rand));
       }
       if (count > 1){ // q visible several times
@@ -173,7 +407,6 @@ namespace hpp {
 	  const ConfigurationPtr_t& q_new = itEdge-> get <1> ();
 	  const PathPtr_t& validPath = itEdge-> get <2> ();
 	  NodePtr_t newNode = r->addNode (q_new);
-	  nodeStatus_ [newNode] = false;
 	  r->addEdge (near, newNode, validPath);
 	  interval_t timeRange = validPath->timeRange ();
 	  r->addEdge (newNode, near, validPath->extract
@@ -17,6 +17,11 @@
 // <http://www.gnu.org/licenses/>.
 
 #include <limits>
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <string>
+#include <boost/thread/mutex.hpp>
 #include <hpp/util/debug.hh>
 #include <hpp/model/body.hh>
 #include <hpp/model/device.hh>
@@ -28,6 +33,15 @@
 
 namespace hpp {
   namespace core {
+    namespace {
+      // Weights computed by the constructor from the robot, by key of the
+      // robot, shared by all instances.
+      typedef std::map <std::string, std::vector <value_type> >
+      WeightsCache_t;
+      WeightsCache_t weightsCache;
+      boost::mutex weightsCacheMutex;
+    } // namespace
+
     std::ostream& operator<< (std::ostream& os, const std::vector <value_type>& v)
     {
       for (std::size_t i=0; i<v.size (); ++i) {
@@ -78,6 +92,7 @@ namespace hpp {
       if ( rank < weights_.size() ) 
       {
 	weights_[rank] = weight;
+	computeSquaredWeights ();
       }
       else {
 	std::ostringstream oss;
@@ -88,18 +103,87 @@ namespace hpp {
     } 
 
     WeighedDistance::WeighedDistance (const DevicePtr_t& robot) :
-      robot_ (robot), weights_ ()
+      robot_ (robot), weights_ (), joints_ (), euclidean_ (false),
+      squaredWeights_ ()
+    {
+      const std::string key (weightsKey ());
+      bool found = false;
+      {
+	boost::mutex::scoped_lock lock (weightsCacheMutex);
+	WeightsCache_t::const_iterator it = weightsCache.find (key);
+	if (it != weightsCache.end ()) {
+	  weights_ = it->second;
+	  found = true;
+	}
+      }
+      if (!found) {
+	computeWeights ();
+	boost::mutex::scoped_lock lock (weightsCacheMutex);
+	weightsCache [key] = weights_;
+      }
+      computeJointTable ();
+      computeSquaredWeights ();
+    }
+
+    WeighedDistance::WeighedDistance (const DevicePtr_t& robot,
+				      const std::vector <value_type>& weights) :
+      robot_ (robot), weights_ (weights), joints_ (), euclidean_ (false),
+      squaredWeights_ ()
+    {
+      computeJointTable ();
+      computeSquaredWeights ();
+    }
+
+    void WeighedDistance::clearWeightsCache ()
+    {
+      boost::mutex::scoped_lock lock (weightsCacheMutex);
+      weightsCache.clear ();
+    }
+
+    std::string WeighedDistance::weightsKey () const
+    {
+      // Weights depend on the kinematic tree, on the radii of the bodies
+      // and on the current configuration.
+      std::ostringstream oss;
+      oss.precision (17);
+      oss << robot_->name () << ";" << robot_->currentConfiguration ().
+	transpose () << ";";
+      const JointVector_t& jointVector (robot_->getJointVector ());
+      for (JointVector_t::const_iterator itJoint = jointVector.begin ();
+	   itJoint != jointVector.end (); ++itJoint) {
+	const JointPtr_t& joint (*itJoint);
+	const Transform3f& position (joint->positionInParentFrame ());
+	oss << joint->name () << "," << joint->configSize () << ","
+	    << joint->numberDof () << ","
+	    << (joint->parentJoint () ? joint->parentJoint ()->name () : "")
+	    << "," << position.getTranslation () [0] << ","
+	    << position.getTranslation () [1] << ","
+	    << position.getTranslation () [2];
+	for (std::size_t i = 0; i < 3; ++i) {
+	  for (std::size_t j = 0; j < 3; ++j) {
+	    oss << "," << position.getRotation () (i, j);
+	  }
+	}
+	if (BodyPtr_t body = joint->linkedBody ()) {
+	  oss << "," << body->radius ();
+	}
+	oss << ";";
+      }
+      return oss.str ();
+    }
+
+    void WeighedDistance::computeWeights ()
     {
       // Store computation flag
-      Device_t::Computation_t flag = robot->computationFlag ();
+      Device_t::Computation_t flag = robot_->computationFlag ();
       Device_t::Computation_t newflag = static_cast <Device_t::Computation_t>
 	(flag | Device_t::JACOBIAN);
-      robot->controlComputation (newflag);
-      robot->computeForwardKinematics ();
-      robot->controlComputation (flag);
+      robot_->controlComputation (newflag);
+      robot_->computeForwardKinematics ();
+      robot_->controlComputation (flag);
       value_type minLength = std::numeric_limits <value_type>::infinity ();
-      matrix_t jacobian; jacobian.resize (3, robot->numberDof ());
-      const JointVector_t jointVector (robot->getJointVector ());
+      matrix_t jacobian; jacobian.resize (3, robot_->numberDof ());
+      const JointVector_t jointVector (robot_->getJointVector ());
       for (JointVector_t::const_iterator it1 = jointVector.begin ();
 	   it1 != jointVector.end (); ++it1) {
 	if ((*it1)->numberDof () != 0) {
@@ -135,16 +219,65 @@ namespace hpp {
       }
     }
 
-    WeighedDistance::WeighedDistance (const DevicePtr_t& robot,
-				      const std::vector <value_type>& weights) :
-      robot_ (robot), weights_ (weights)
+    WeighedDistance::WeighedDistance (const WeighedDistance& distance) :
+      robot_ (distance.robot_),
+      weights_ (distance.weights_),
+      joints_ (distance.joints_),
+      euclidean_ (distance.euclidean_),
+      squaredWeights_ (distance.squaredWeights_)
     {
     }
 
-    WeighedDistance::WeighedDistance (const WeighedDistance& distance) :
-      robot_ (distance.robot_),
-      weights_ (distance.weights_)
+    void WeighedDistance::computeJointTable ()
     {
+      joints_.clear ();
+      euclidean_ = true;
+      const JointVector_t& jointVector (robot_->getJointVector ());
+      for (JointVector_t::const_iterator itJoint = jointVector.begin ();
+	   itJoint != jointVector.end (); ++itJoint) {
+	const JointPtr_t& joint (*itJoint);
+	if (joint->numberDof () != 0) {
+	  JointData data;
+	  data.joint = joint;
+	  data.rank = joint->rankInConfiguration ();
+	  if (dynamic_cast <model::JointTranslation <1>*> (joint) ||
+	      dynamic_cast <model::JointTranslation <2>*> (joint) ||
+	      dynamic_cast <model::JointTranslation <3>*> (joint) ||
+	      dynamic_cast <model::jointRotation::Bounded*> (joint)) {
+	    data.euclideanSize = joint->configSize ();
+	    data.type = JointData::EUCLIDEAN;
+	  } else {
+	    data.euclideanSize = 0;
+	    euclidean_ = false;
+	    if (dynamic_cast <model::JointSO3*> (joint)) {
+	      data.type = JointData::QUATERNION;
+	    } else if (dynamic_cast <model::jointRotation::UnBounded*>
+		       (joint)) {
+	      data.type = joint->configSize () == 2 ?
+		JointData::UNIT_COMPLEX : JointData::ANGLE;
+	    } else {
+	      data.type = JointData::OTHER;
+	    }
+	  }
+	  joints_.push_back (data);
+	}
+      }
+    }
+
+    void WeighedDistance::computeSquaredWeights ()
+    {
+      if (!euclidean_ || weights_.size () != joints_.size ()) {
+	squaredWeights_.resize (0);
+	return;
+      }
+      // Configuration variables of joints without degrees of freedom and
+      // of the extra configuration space do not contribute.
+      squaredWeights_ = vector_t::Zero (robot_->configSize ());
+      for (std::size_t i = 0; i < joints_.size (); ++i) {
+	squaredWeights_.segment (joints_ [i].rank,
+				 joints_ [i].euclideanSize).setConstant
+	  (weights_ [i] * weights_ [i]);
+      }
     }
 
     void WeighedDistance::init (WeighedDistanceWkPtr_t self)
@@ -152,25 +285,109 @@ namespace hpp {
       weak_ = self;
     }
 
+    value_type WeighedDistance::squaredDistance
+    (ConfigurationIn_t q1, ConfigurationIn_t q2, value_type bound2) const
+    {
+      if (squaredWeights_.size () != 0) {
+	return (squaredWeights_.array () * (q1 - q2).array ().square ()).sum ();
+      }
+      value_type res = 0;
+      for (std::size_t i = 0; i < joints_.size () && res <= bound2; ++i) {
+	const JointData& data (joints_ [i]);
+	value_type length = weights_ [i];
+	value_type distance;
+	if (data.euclideanSize != 0) {
+	  distance = (q1.segment (data.rank, data.euclideanSize) -
+		      q2.segment (data.rank, data.euclideanSize)).norm ();
+	} else {
+	  distance = data.joint->configuration ()->distance (q1, q2,
+							     data.rank);
+	}
+	res += length * length * distance * distance;
+      }
+      return res;
+    }
+
     value_type WeighedDistance::impl_distance (ConfigurationIn_t q1,
 					       ConfigurationIn_t q2) const
     {
-      // Loop over robot joint and interpolate
-      value_type res = 0;
-      std::size_t i=0;
-      const JointVector_t jointVector (robot_->getJointVector ());
-      for (JointVector_t::const_iterator itJoint = jointVector.begin ();
-	   itJoint != jointVector.end (); ++itJoint) {
-	if ((*itJoint)->numberDof () != 0) {
-	  value_type length = weights_ [i];
-	  value_type distance =
-	    (*itJoint)->configuration ()->distance
-	    (q1, q2, (*itJoint)->rankInConfiguration ());
-	  res += length * length * distance * distance;
-	  ++i;
+      return sqrt (squaredDistance
+		   (q1, q2, std::numeric_limits <value_type>::infinity ()));
+    }
+
+    value_type WeighedDistance::boundedDistance (ConfigurationIn_t q1,
+						 ConfigurationIn_t q2,
+						 value_type bound) const
+    {
+      return sqrt (squaredDistance (q1, q2, bound * bound));
+    }
+
+    void WeighedDistance::distances (ConfigurationIn_t q,
+				     matrixIn_t configurations,
+				     vectorOut_t result) const
+    {
+      assert (result.size () == configurations.cols ());
+      if (squaredWeights_.size () != 0) {
+	result.noalias () = ((configurations.colwise () - q).array ().square ()
+			     .matrix ().transpose ()) * squaredWeights_;
+	result.array () = result.array ().sqrt ();
+	return;
+      }
+      // Accumulate squared weighed distances joint by joint, in the same
+      // order as impl_distance. Rotations are computed for all the
+      // configurations at once, with the formulas of the joint
+      // configurations.
+      result.setZero ();
+      vector_t angle (configurations.cols ());
+      for (std::size_t i = 0; i < joints_.size (); ++i) {
+	const JointData& data (joints_ [i]);
+	value_type length = weights_ [i];
+	value_type length2 = length * length;
+	size_type rank = data.rank;
+	size_type n = data.euclideanSize;
+	switch (data.type) {
+	case JointData::EUCLIDEAN:
+	  {
+	    rowvector_t distance =
+	      (configurations.middleRows (rank, n).colwise () -
+	       q.segment (rank, n)).colwise ().norm ();
+	    result.array () += length2 * distance.transpose ().array () *
+	      distance.transpose ().array ();
+	  }
+	  break;
+	case JointData::QUATERNION:
+	  // theta is the angle between the unit quaternions: the angle of the
+	  // rotation is 2 min (theta, pi - theta).
+	  angle.noalias () = configurations.middleRows (rank, 4).transpose () *
+	    q.segment (rank, 4);
+	  angle.array () = angle.array ().max (-1.).min (1.).acos ();
+	  angle.array () = 2 * angle.array ().min (-angle.array () + M_PI);
+	  result.array () += length2 * angle.array ().square ();
+	  break;
+	case JointData::UNIT_COMPLEX:
+	  angle.noalias () = configurations.middleRows (rank, 2).transpose () *
+	    q.segment (rank, 2);
+	  angle.array () = angle.array ().max (-1.).min (1.).acos ();
+	  result.array () += length2 * angle.array ().square ();
+	  break;
+	case JointData::ANGLE:
+	  for (size_type c=0; c < configurations.cols (); ++c) {
+	    value_type distance = fmod (fabs (configurations (rank, c) -
+					      q [rank]), 2 * M_PI);
+	    if (distance > M_PI) distance = 2 * M_PI - distance;
+	    result [c] += length2 * distance * distance;
+	  }
+	  break;
+	case JointData::OTHER:
+	  for (size_type c=0; c < configurations.cols (); ++c) {
+	    value_type distance = data.joint->configuration ()->distance
+	      (q, configurations.col (c), rank);
+	    result [c] += length2 * distance * distance;
+	  }
+	  break;
 	}
       }
-      return sqrt (res);
+      result.array () = result.array ().sqrt ();
     }
   } //   namespace core
 } // namespace hpp
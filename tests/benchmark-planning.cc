@@ -0,0 +1,584 @@
+//
+// Copyright (c) 2014 CNRS
+// Authors: Florent Lamiraux
+//
+// This file is part of hpp-core
+// hpp-core is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either version
+// 3 of the License, or (at your option) any later version.
+//
+// hpp-core is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Lesser Public License for more details.  You should have
+// received a copy of the GNU Lesser General Public License along with
+// hpp-core  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+// Benchmarks of the operations performed most often by path planning.
+//
+// Usage: benchmark-planning [filter]
+//
+// Only benchmarks the name of which contains filter are run. For each
+// benchmark, the number of iterations, the time and the number of memory
+// allocations per iteration are printed. Random inputs are drawn from
+// generators with fixed seeds, so that runs are reproducible. Build with
+// CMAKE_BUILD_TYPE=Release for meaningful timings.
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include <hpp/fcl/math/transform.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/model/body.hh>
+#include <hpp/model/collision-object.hh>
+#include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/model/object-factory.hh>
+#include <hpp/constraints/position.hh>
+
+#include <hpp/core/collision-validation.hh>
+#include <hpp/core/config-projector.hh>
+#include <hpp/core/connected-component.hh>
+#include <hpp/core/continuous-collision-checking/dichotomy.hh>
+#include <hpp/core/continuous-collision-checking/progressive.hh>
+#include <hpp/core/node.hh>
+#include <hpp/core/numerical-constraint.hh>
+#include <hpp/core/operation-counters.hh>
+#include <hpp/core/path-validation-report.hh>
+#include <hpp/core/path-vector.hh>
+#include <hpp/core/problem-solver.hh>
+#include <hpp/core/roadmap.hh>
+#include <hpp/core/seeded-configuration-shooter.hh>
+#include <hpp/core/steering-method-straight.hh>
+#include <hpp/core/validation-report.hh>
+#include <hpp/core/weighed-distance.hh>
+#include "../src/astar.hh"
+#include "../src/continuous-collision-checking/intervals.hh"
+#include "../src/nearest-neighbor/basic.hh"
+#include "../src/nearest-neighbor/k-d-tree.hh"
+
+using hpp::model::BodyPtr_t;
+using hpp::model::CollisionObject;
+using hpp::model::Device;
+using hpp::model::JointSO3;
+using hpp::model::JointTranslation;
+using hpp::model::ObjectFactory;
+using hpp::model::Transform3f;
+using hpp::constraints::Position;
+using hpp::constraints::matrix3_t;
+using hpp::constraints::vector3_t;
+using namespace hpp::core;
+
+// Count allocations performed through operator new. Eigen allocates
+// aligned memory with malloc: these allocations are not counted.
+#if __cplusplus >= 201103L
+# define BENCHMARK_THROW_BAD_ALLOC
+# define BENCHMARK_NO_THROW noexcept
+#else
+# define BENCHMARK_THROW_BAD_ALLOC throw (std::bad_alloc)
+# define BENCHMARK_NO_THROW throw ()
+#endif
+
+namespace {
+  // Benchmarks run in a single thread.
+  std::size_t allocations = 0;
+} // namespace
+
+void* operator new (std::size_t size) BENCHMARK_THROW_BAD_ALLOC
+{
+  ++allocations;
+  void* ptr = std::malloc (size == 0 ? 1 : size);
+  if (!ptr) throw std::bad_alloc ();
+  return ptr;
+}
+
+void* operator new[] (std::size_t size) BENCHMARK_THROW_BAD_ALLOC
+{
+  return operator new (size);
+}
+
+void operator delete (void* ptr) BENCHMARK_NO_THROW
+{
+  std::free (ptr);
+}
+
+void operator delete[] (void* ptr) BENCHMARK_NO_THROW
+{
+  std::free (ptr);
+}
+
+namespace {
+  typedef boost::random::mt19937 Generator_t;
+  typedef boost::random::uniform_real_distribution <value_type> Uniform_t;
+
+  std::string filter;
+  // Prevent the compiler from removing the computations benchmarked
+  volatile value_type sink;
+
+  bool selected (const std::string& name)
+  {
+    return name.find (filter) != std::string::npos;
+  }
+
+  /// Time and allocations between construction and call to stop
+  class Measure
+  {
+  public:
+    Measure (const std::string& name) : name_ (name),
+      allocations_ (allocations), start_ (now ())
+    {
+    }
+
+    void stop (std::size_t iterations)
+    {
+      const double time =
+	(double) (now () - start_).total_microseconds () / iterations;
+      const double allocs =
+	(double) (allocations - allocations_) / iterations;
+      std::cout << std::left << std::setw (44) << name_ << std::right
+		<< std::setw (10) << iterations
+		<< std::setw (14) << std::setprecision (4) << time
+		<< std::setw (14) << std::setprecision (4) << allocs
+		<< std::endl;
+    }
+
+  private:
+    static boost::posix_time::ptime now ()
+    {
+      return boost::posix_time::microsec_clock::universal_time ();
+    }
+    std::string name_;
+    std::size_t allocations_;
+    boost::posix_time::ptime start_;
+  }; // class Measure
+
+  std::string toString (std::size_t n)
+  {
+    std::ostringstream oss; oss << n;
+    return oss.str ();
+  }
+
+  /// Robot with 3 translations, SO(3) and an unbounded rotation, without
+  /// geometry
+  DevicePtr_t createFreeFlyer ()
+  {
+    DevicePtr_t robot = Device::create ("free-flyer");
+    JointPtr_t translation = new JointTranslation <3> (Transform3f ());
+    for (size_type i = 0; i < 3; ++i) {
+      translation->isBounded (i, true);
+      translation->lowerBound (i, -3.);
+      translation->upperBound (i, 3.);
+    }
+    JointPtr_t so3 = new JointSO3 (Transform3f ());
+    JointPtr_t so2 = new hpp::model::jointRotation::UnBounded
+      (Transform3f (fcl::Vec3f (0, 0, 1)));
+    robot->rootJoint (translation);
+    translation->addChildJoint (so3);
+    so3->addChildJoint (so2);
+    return robot;
+  }
+
+  /// Planar robot with a box, moving in [-5, 5] x [-5, 5]
+  DevicePtr_t createPlanarRobot ()
+  {
+    ObjectFactory factory;
+    DevicePtr_t robot = Device::create ("planar-robot");
+    Transform3f position; position.setIdentity ();
+    JointPtr_t root = factory.createJointTranslation2 (position);
+    for (size_type i = 0; i < 2; ++i) {
+      root->isBounded (i, true);
+      root->lowerBound (i, -5.);
+      root->upperBound (i, 5.);
+    }
+    robot->rootJoint (root);
+    // Rotation around z
+    position.setQuatRotation
+      (fcl::Quaternion3f (sqrt (2)/2, 0, -sqrt (2)/2, 0));
+    JointPtr_t joint = factory.createUnBoundedJointRotation (position);
+    joint->name ("rotation");
+    root->addChildJoint (joint);
+    position.setIdentity ();
+    fcl::CollisionGeometryPtr_t box (new fcl::Box (.1, .1, .4));
+    BodyPtr_t body = factory.createBody ();
+    body->name ("body");
+    joint->setLinkedBody (body);
+    body->addInnerObject (CollisionObject::create (box, position, "box"),
+			  true, true);
+    return robot;
+  }
+
+  /// Grid of 5 x 5 unit cubes spaced by 2 in the plane of the planar robot
+  ObjectVector_t createObstacles ()
+  {
+    ObjectVector_t obstacles;
+    fcl::CollisionGeometryPtr_t cube (new fcl::Box (1, 1, 1));
+    for (int i = 0; i < 5; ++i) {
+      for (int j = 0; j < 5; ++j) {
+	Transform3f position;
+	position.setTranslation (fcl::Vec3f (-4 + 2 * i, -4 + 2 * j, 0));
+	const std::string name ("obstacle-" + toString (5 * i + j));
+	obstacles.push_back (CollisionObject::create (cube, position, name));
+      }
+    }
+    return obstacles;
+  }
+
+  /// Configuration of the planar robot
+  Configuration_t planarConfig (value_type x, value_type y)
+  {
+    Configuration_t q (4);
+    q << x, y, 1, 0;
+    return q;
+  }
+
+  matrix_t sample (const DevicePtr_t& robot, std::size_t n,
+		   unsigned int seed)
+  {
+    matrix_t configurations (robot->configSize (), n);
+    SeededConfigurationShooter::create (robot, seed)->shoot (configurations);
+    return configurations;
+  }
+
+  // Nearest neighbor in a roadmap of one connected component
+  void benchmarkNearestNeighbor (const std::string& type, std::size_t size)
+  {
+    const std::string name ("nearest-neighbor/" + type + "/" +
+			    toString (size));
+    if (!selected (name)) return;
+    DevicePtr_t robot = createFreeFlyer ();
+    WeighedDistancePtr_t distance = WeighedDistance::create (robot);
+    SteeringMethodPtr_t sm = SteeringMethodStraight::create (robot);
+    RoadmapPtr_t roadmap = Roadmap::create (distance, robot);
+    // roadmap takes ownership of the nearest neighbor object
+    if (type == "kd-tree") {
+      roadmap->nearestNeighbor (new nearestNeighbor::KDTree
+				(robot, distance, 30));
+    } else {
+      roadmap->nearestNeighbor (new nearestNeighbor::Basic (distance));
+    }
+    SeededConfigurationShooterPtr_t shooter =
+      SeededConfigurationShooter::create (robot, 1);
+    Measure insert (name + "/insert");
+    NodePtr_t root = roadmap->addNode (shooter->shoot ());
+    for (std::size_t i = 1; i < size; ++i) {
+      // Paths of the edges are not computed
+      NodePtr_t node = roadmap->addNode (shooter->shoot ());
+      roadmap->addEdge (root, node, sm, 0);
+      roadmap->addEdge (node, root, sm, 0);
+    }
+    insert.stop (size);
+
+    const std::size_t queries = 100;
+    std::vector <ConfigurationPtr_t> configurations (queries);
+    for (std::size_t i = 0; i < queries; ++i) {
+      configurations [i] = shooter->shoot ();
+    }
+    const ConnectedComponentPtr_t& cc (root->connectedComponent ());
+    value_type minDistance;
+    Measure search (name + "/search");
+    for (std::size_t i = 0; i < queries; ++i) {
+      roadmap->nearestNode (configurations [i], cc, minDistance);
+      sink = minDistance;
+    }
+    search.stop (queries);
+  }
+
+  void benchmarkWeighedDistance ()
+  {
+    const std::string name ("weighed-distance");
+    if (!selected (name)) return;
+    DevicePtr_t robot = createFreeFlyer ();
+    WeighedDistancePtr_t distance = WeighedDistance::create (robot);
+    const std::size_t n = 1000, repeat = 1000;
+    matrix_t q1 (sample (robot, n, 1)), q2 (sample (robot, n, 2));
+    value_type sum = 0;
+    Measure measure (name);
+    for (std::size_t k = 0; k < repeat; ++k) {
+      for (size_type i = 0; i < q1.cols (); ++i) {
+	sum += (*distance) (q1.col (i), q2.col (i));
+      }
+    }
+    measure.stop (n * repeat);
+    sink = sum;
+  }
+
+  void benchmarkConfigProjector ()
+  {
+    const std::string name ("config-projector/apply");
+    if (!selected (name)) return;
+    DevicePtr_t robot = createPlanarRobot ();
+    JointPtr_t joint = robot->getJointByName ("rotation");
+    matrix3_t rot; rot.setIdentity ();
+    // Point (1, 0, 0) of the robot on a point of the plane
+    ConfigProjectorPtr_t projector =
+      ConfigProjector::create (robot, "benchmark", 1e-4, 20);
+    projector->add (NumericalConstraint::create
+		    (Position::create (robot, joint, vector3_t (1, 0, 0),
+				       vector3_t (1, 1, 0), rot)));
+    const std::size_t n = 10000;
+    matrix_t configurations (sample (robot, n, 1));
+    Configuration_t q (robot->configSize ());
+    std::size_t success = 0;
+    Measure measure (name);
+    for (size_type i = 0; i < configurations.cols (); ++i) {
+      q = configurations.col (i);
+      if (projector->apply (q)) ++success;
+    }
+    measure.stop (n);
+    sink = (value_type) success;
+  }
+
+  void benchmarkCollisionValidation ()
+  {
+    const std::string name ("collision-validation/validate");
+    if (!selected (name)) return;
+    DevicePtr_t robot = createPlanarRobot ();
+    CollisionValidationPtr_t validation = CollisionValidation::create (robot);
+    ObjectVector_t obstacles (createObstacles ());
+    for (ObjectVector_t::const_iterator it = obstacles.begin ();
+	 it != obstacles.end (); ++it) {
+      validation->addObstacle (*it);
+    }
+    const std::size_t n = 100000;
+    matrix_t configurations (sample (robot, n, 1));
+    std::size_t valid = 0;
+    Configuration_t q (robot->configSize ());
+    ValidationReportPtr_t report;
+    Measure measure (name);
+    for (size_type i = 0; i < configurations.cols (); ++i) {
+      q = configurations.col (i);
+      if (validation->validate (q, report)) ++valid;
+    }
+    measure.stop (n);
+    sink = (value_type) valid;
+  }
+
+  // Validation of straight paths between random configurations
+  void benchmarkPathValidation (const std::string& type,
+				const PathValidationPtr_t& validation,
+				const DevicePtr_t& robot)
+  {
+    const std::string name ("path-validation/" + type);
+    if (!selected (name)) return;
+    ObjectVector_t obstacles (createObstacles ());
+    for (ObjectVector_t::const_iterator it = obstacles.begin ();
+	 it != obstacles.end (); ++it) {
+      validation->addObstacle (*it);
+    }
+    SteeringMethodPtr_t sm = SteeringMethodStraight::create (robot);
+    const std::size_t n = 1000;
+    matrix_t q1 (sample (robot, n, 1)), q2 (sample (robot, n, 2));
+    std::vector <PathPtr_t> paths (n);
+    for (std::size_t i = 0; i < n; ++i) {
+      paths [i] = (*sm) (q1.col (i), q2.col (i));
+    }
+    PathPtr_t validPart;
+    PathValidationReportPtr_t report;
+    value_type validLength = 0;
+    Measure measure (name);
+    for (std::size_t i = 0; i < n; ++i) {
+      validation->validate (paths [i], false, validPart, report);
+      if (validPart) validLength += validPart->length ();
+    }
+    measure.stop (n);
+    sink = validLength;
+  }
+
+  void benchmarkRankAtParam ()
+  {
+    const std::string name ("path-vector/rank-at-param");
+    if (!selected (name)) return;
+    DevicePtr_t robot = createFreeFlyer ();
+    SteeringMethodPtr_t sm = SteeringMethodStraight::create (robot);
+    const std::size_t n = 1000;
+    matrix_t q (sample (robot, n + 1, 1));
+    PathVectorPtr_t path = PathVector::create (robot->configSize (),
+					       robot->numberDof ());
+    for (std::size_t i = 0; i < n; ++i) {
+      path->appendPath ((*sm) (q.col (i), q.col (i + 1)));
+    }
+    const std::size_t queries = 1000000;
+    const value_type length = path->length ();
+    value_type localParam, sum = 0;
+    // Increasing parameters, as when a path is sampled
+    Measure sequential (name + "/sequential");
+    for (std::size_t i = 0; i < queries; ++i) {
+      sum += path->rankAtParam (length * i / queries, localParam);
+    }
+    sequential.stop (queries);
+    std::vector <value_type> params (queries);
+    Generator_t generator (1);
+    Uniform_t uniform (0, length);
+    for (std::size_t i = 0; i < queries; ++i) {
+      params [i] = uniform (generator);
+    }
+    Measure random (name + "/random");
+    for (std::size_t i = 0; i < queries; ++i) {
+      sum += path->rankAtParam (params [i], localParam);
+    }
+    random.stop (queries);
+    sink = sum;
+  }
+
+  // Union of many small intervals, as computed by dichotomy on a long path
+  // vector, then queries of parameters
+  void benchmarkIntervals ()
+  {
+    const std::string name ("intervals");
+    if (!selected (name)) return;
+    const std::size_t n = 20000, queries = 100000;
+    Generator_t generator (1);
+    Uniform_t uniform (0, 1000), halfLength (0, .01);
+    std::vector <interval_t> inserted (n);
+    for (std::size_t i = 0; i < n; ++i) {
+      value_type t = uniform (generator), l = halfLength (generator);
+      inserted [i] = interval_t (t - l, t + l);
+    }
+    std::vector <value_type> params (queries);
+    for (std::size_t i = 0; i < queries; ++i) {
+      params [i] = uniform (generator);
+    }
+    continuousCollisionChecking::Intervals intervals;
+    Measure unions (name + "/union");
+    for (std::size_t i = 0; i < n; ++i) {
+      intervals.unionInterval (inserted [i]);
+    }
+    unions.stop (n);
+    std::size_t contained = 0;
+    Measure contains (name + "/contains");
+    for (std::size_t i = 0; i < queries; ++i) {
+      if (intervals.contains (params [i])) ++contained;
+    }
+    contains.stop (queries);
+    sink = (value_type) contained;
+  }
+
+  // Add edges in both directions between two nodes
+  void link (const RoadmapPtr_t& roadmap, const SteeringMethodPtr_t& sm,
+	     const NodePtr_t& n1, const NodePtr_t& n2)
+  {
+    PathPtr_t path ((*sm) (*n1->configuration (), *n2->configuration ()));
+    roadmap->addEdge (n1, n2, path);
+    roadmap->addEdge (n2, n1, path->reverse ());
+  }
+
+  // Shortest path in a roadmap the nodes of which form a square grid,
+  // linked to their 4 neighbors.
+  void benchmarkAstar (std::size_t side)
+  {
+    const std::string name ("astar/grid/" + toString (side * side));
+    if (!selected (name)) return;
+    DevicePtr_t robot = createPlanarRobot ();
+    WeighedDistancePtr_t distance = WeighedDistance::create (robot);
+    SteeringMethodPtr_t sm = SteeringMethodStraight::create (robot);
+    RoadmapPtr_t roadmap = Roadmap::create (distance, robot);
+    std::vector <NodePtr_t> nodes (side * side);
+    const value_type step = 10. / (side - 1);
+    for (std::size_t i = 0; i < side; ++i) {
+      for (std::size_t j = 0; j < side; ++j) {
+	ConfigurationPtr_t q (new Configuration_t
+			      (planarConfig (-5 + i * step, -5 + j * step)));
+	if (i == 0 && j == 0) {
+	  roadmap->initNode (q);
+	  nodes [0] = roadmap->initNode ();
+	} else {
+	  nodes [i * side + j] = roadmap->addNode (q);
+	}
+      }
+    }
+    for (std::size_t i = 0; i < side; ++i) {
+      for (std::size_t j = 0; j < side; ++j) {
+	NodePtr_t node = nodes [i * side + j];
+	if (i + 1 < side) link (roadmap, sm, node, nodes [(i + 1) * side + j]);
+	if (j + 1 < side) link (roadmap, sm, node, nodes [i * side + j + 1]);
+      }
+    }
+    roadmap->addGoalNode (nodes.back ()->configuration ());
+    const std::size_t searches = 10;
+    value_type length = 0;
+    // Heuristics are computed by the first search and kept by the roadmap
+    Measure measure (name);
+    for (std::size_t i = 0; i < searches; ++i) {
+      Astar astar (roadmap, distance);
+      length += astar.solution ()->length ();
+    }
+    measure.stop (searches);
+    sink = length;
+  }
+
+  // Full resolution of a problem by a ProblemSolver
+  void benchmarkSolve (const std::string& planner)
+  {
+    const std::string name ("solve/" + planner);
+    if (!selected (name)) return;
+    ProblemSolverPtr_t problemSolver = ProblemSolver::create ();
+    problemSolver->robot (createPlanarRobot ());
+    ObjectVector_t obstacles (createObstacles ());
+    for (ObjectVector_t::const_iterator it = obstacles.begin ();
+	 it != obstacles.end (); ++it) {
+      problemSolver->addObstacle (*it, true, true);
+    }
+    problemSolver->configurationShooterType ("SeededConfigurationShooter");
+    problemSolver->pathValidationType ("Progressive", 0.05);
+    problemSolver->pathPlannerType (planner);
+    ConfigurationPtr_t q (new Configuration_t (planarConfig (-4.9, -4.9)));
+    problemSolver->initConfig (q);
+    q = ConfigurationPtr_t (new Configuration_t (planarConfig (4.9, 4.9)));
+    problemSolver->addGoalConfig (q);
+    problemSolver->seed (1);
+    problemSolver->countOperations (true);
+    Measure measure (name);
+    problemSolver->solve ();
+    measure.stop (1);
+    problemSolver->countOperations (false);
+    std::cout << "  path length: " << problemSolver->paths ().back ()->
+      length () << ", roadmap nodes: "
+	      << problemSolver->roadmap ()->nodes ().size () << std::endl;
+    OperationCounters::print (std::cout, problemSolver->operationCounts ());
+    delete problemSolver;
+  }
+} // namespace
+
+int main (int argc, char** argv)
+{
+  if (argc > 1) filter = argv [1];
+  std::cout << std::left << std::setw (44) << "benchmark" << std::right
+	    << std::setw (10) << "iterations" << std::setw (14) << "us/iter"
+	    << std::setw (14) << "allocs/iter" << std::endl;
+  const std::size_t sizes [] = {10000, 100000, 1000000};
+  for (std::size_t i = 0; i < 3; ++i) {
+    benchmarkNearestNeighbor ("kd-tree", sizes [i]);
+    benchmarkNearestNeighbor ("basic", sizes [i]);
+  }
+  benchmarkWeighedDistance ();
+  benchmarkConfigProjector ();
+  benchmarkCollisionValidation ();
+  DevicePtr_t robot = createPlanarRobot ();
+  benchmarkPathValidation ("progressive",
+			   continuousCollisionChecking::Progressive::create
+			   (robot, 0.05), robot);
+  robot = createPlanarRobot ();
+  benchmarkPathValidation ("dichotomy",
+			   continuousCollisionChecking::Dichotomy::create
+			   (robot, 0), robot);
+  benchmarkRankAtParam ();
+  benchmarkIntervals ();
+  benchmarkAstar (30);
+  benchmarkAstar (100);
+  benchmarkSolve ("DiffusingPlanner");
+  benchmarkSolve ("VisibilityPrmPlanner");
+  return 0;
+}
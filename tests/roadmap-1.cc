@@ -16,9 +16,15 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with hpp-core.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 #include <boost/assign.hpp>
 
 #include <hpp/util/debug.hh>
+#include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/model/body.hh>
+#include <hpp/model/collision-object.hh>
 #include <hpp/model/device.hh>
 #include <hpp/model/joint.hh>
 #include <hpp/core/fwd.hh>
@@ -26,11 +32,17 @@
 #include <hpp/core/weighed-distance.hh>
 #include "hpp/core/basic-configuration-shooter.hh"
 #include <hpp/core/connected-component.hh>
+#include <hpp/core/discretized-collision-checking.hh>
 #include <hpp/core/node.hh>
+#include <hpp/core/edge.hh>
+#include <hpp/core/path-vector.hh>
+#include <hpp/core/problem.hh>
+#include <hpp/core/rrt-star-planner.hh>
 #include <hpp/model/joint-configuration.hh>
 
 #include <hpp/core/steering-method-straight.hh>
 #include <hpp/core/weighed-distance.hh>
+#include "../src/nearest-neighbor/k-d-tree.hh"
 
 #define BOOST_TEST_MODULE roadmap-1
 #include <boost/test/included/unit_test.hpp>
@@ -131,6 +143,14 @@ BOOST_AUTO_TEST_CASE (Roadmap1) {
   // 0 -> 1
   addEdge (r, *sm, nodes, 0, 1);
   BOOST_CHECK_EQUAL (r->connectedComponents ().size (), 6);
+  BOOST_CHECK (nodes [0]->connectedComponent ()->isLinkedTo
+	       (nodes [1]->connectedComponent ()));
+  BOOST_CHECK (!nodes [0]->connectedComponent ()->isLinkedTo
+	       (nodes [5]->connectedComponent ()));
+  BOOST_CHECK (nodes [0]->connectedComponent ()->canReach
+	       (nodes [1]->connectedComponent ()));
+  BOOST_CHECK (!nodes [1]->connectedComponent ()->canReach
+	       (nodes [0]->connectedComponent ()));
   for (std::size_t i=0; i < nodes.size (); ++i) {
     for (std::size_t j=i+1; j < nodes.size (); ++j) {
       BOOST_CHECK_MESSAGE (nodes [i]->connectedComponent () !=
@@ -231,6 +251,10 @@ BOOST_AUTO_TEST_CASE (Roadmap1) {
   // 3 -> 5
   addEdge (r, *sm, nodes, 3, 5);
   BOOST_CHECK_EQUAL (r->connectedComponents ().size (), 4);
+  BOOST_CHECK (nodes [5]->connectedComponent ()->isLinkedTo
+	       (nodes [0]->connectedComponent ()));
+  BOOST_CHECK (!nodes [5]->connectedComponent ()->canReach
+	       (nodes [0]->connectedComponent ()));
   BOOST_CHECK (nodes [0]->connectedComponent () == 
 	       nodes [1]->connectedComponent ());
   BOOST_CHECK (nodes [0]->connectedComponent () == 
@@ -280,6 +304,451 @@ BOOST_AUTO_TEST_CASE (Roadmap1) {
   BOOST_CHECK (r->pathExists ());
   std::cout << *r << std::endl;
 
+  // Clear the roadmap, memory of nodes and edges is reused.
+  r->clear ();
+  BOOST_CHECK (r->nodes ().empty ());
+  BOOST_CHECK (r->edges ().empty ());
+  q = ConfigurationPtr_t (new Configuration_t (robot->configSize ()));
+  (*q) [0] = 2.5; (*q) [1] = 2.9;
+  r->initNode (q);
+  q = ConfigurationPtr_t (new Configuration_t (robot->configSize ()));
+  (*q) [0] = 1; (*q) [1] = 0;
+  NodePtr_t node = r->addNode (q);
+  r->addEdge (r->initNode (), node, (*sm) (*(r->initNode ()->configuration ()),
+					  *q));
+  BOOST_CHECK_EQUAL (r->nodes ().size (), 2);
+  BOOST_CHECK_EQUAL (r->edges ().size (), 1);
+  BOOST_CHECK (r->initNode ()->connectedComponent ()->canReach
+	       (node->connectedComponent ()));
+}
+BOOST_AUTO_TEST_CASE (Roadmap2) {
+  // Build robot
+  DevicePtr_t robot = Device::create("robot");
+  JointPtr_t xJoint = new JointTranslation <1> (fcl::Transform3f());
+  xJoint->isBounded(0,1);
+  xJoint->lowerBound(0,-3.);
+  xJoint->upperBound(0,3.);
+  JointPtr_t yJoint = new JointTranslation <1>
+    (fcl::Transform3f(fcl::Quaternion3f (sqrt (2)/2, 0, 0, sqrt(2)/2)));
+  yJoint->isBounded(0,1);
+  yJoint->lowerBound(0,-3.);
+  yJoint->upperBound(0,3.);
+
+  robot->rootJoint (xJoint);
+  xJoint->addChildJoint (yJoint);
+
+  SteeringMethodStraightPtr_t sm = SteeringMethodStraight::create (robot);
+  hpp::core::DistancePtr_t distance (WeighedDistance::create
+				     (robot, boost::assign::list_of (1)(1)));
+  RoadmapPtr_t r = Roadmap::create (distance, robot);
+  r->incrementalSearch (true);
+
+  // Square of nodes, the goal is reachable through nodes 1 and 2 or
+  // directly.
+  std::vector <NodePtr_t> nodes;
+  hpp::core::value_type coordinates [4][2] = {{0, 0}, {1, 0}, {0, 1}, {1, 1}};
+  for (std::size_t i=0; i < 4; ++i) {
+    ConfigurationPtr_t q (new Configuration_t (robot->configSize ()));
+    (*q) [0] = coordinates [i][0]; (*q) [1] = coordinates [i][1];
+    if (i == 0) {
+      r->initNode (q);
+      nodes.push_back (r->initNode ());
+    } else {
+      nodes.push_back (r->addNode (q));
+    }
+  }
+  r->addGoalNode (nodes [3]->configuration ());
+  addEdge (r, *sm, nodes, 0, 1);
+  addEdge (r, *sm, nodes, 1, 3);
+  addEdge (r, *sm, nodes, 0, 2);
+  addEdge (r, *sm, nodes, 2, 3);
+  hpp::core::PathVectorPtr_t path = r->shortestPath (distance);
+  BOOST_CHECK_EQUAL (path->numberPaths (), 2);
+
+  // A shortcut is found by repairing the previous search.
+  addEdge (r, *sm, nodes, 0, 3);
+  path = r->shortestPath (distance);
+  BOOST_CHECK_EQUAL (path->numberPaths (), 1);
+
+  // Removing the shortcut restores the previous solution.
+  hpp::core::Edges_t removed;
+  removed.push_back (nodes [0]->outEdges ().back ());
+  BOOST_CHECK (removed.front ()->to () == nodes [3]);
+  r->removeEdges (removed);
+  BOOST_CHECK_EQUAL (r->edges ().size (), 4);
+  BOOST_CHECK (r->pathExists ());
+  path = r->shortestPath (distance);
+  BOOST_CHECK_EQUAL (path->numberPaths (), 2);
+
+  // Removing edges to the goal disconnects it.
+  removed.clear ();
+  removed.push_back (nodes [1]->outEdges ().front ());
+  removed.push_back (nodes [2]->outEdges ().front ());
+  r->removeEdges (removed);
+  BOOST_CHECK (!r->pathExists ());
+  BOOST_CHECK (!nodes [0]->connectedComponent ()->isLinkedTo
+	       (nodes [3]->connectedComponent ()));
+  BOOST_CHECK_THROW (r->shortestPath (distance), std::runtime_error);
+
+  // Goal moved to node 2
+  r->resetGoalNodes ();
+  r->addGoalNode (nodes [2]->configuration ());
+  path = r->shortestPath (distance);
+  BOOST_CHECK_EQUAL (path->numberPaths (), 1);
+}
+
+// Robot moving in the plane
+DevicePtr_t createPlanarRobot ()
+{
+  DevicePtr_t robot = Device::create("robot");
+  JointPtr_t xJoint = new JointTranslation <1> (fcl::Transform3f());
+  xJoint->isBounded(0,1);
+  xJoint->lowerBound(0,-3.);
+  xJoint->upperBound(0,3.);
+  JointPtr_t yJoint = new JointTranslation <1>
+    (fcl::Transform3f(fcl::Quaternion3f (sqrt (2)/2, 0, 0, sqrt(2)/2)));
+  yJoint->isBounded(0,1);
+  yJoint->lowerBound(0,-3.);
+  yJoint->upperBound(0,3.);
+  robot->rootJoint (xJoint);
+  xJoint->addChildJoint (yJoint);
+  return robot;
+}
+
+ConfigurationPtr_t planarConfig (const DevicePtr_t& robot,
+				 hpp::core::value_type x,
+				 hpp::core::value_type y)
+{
+  ConfigurationPtr_t q (new Configuration_t (robot->configSize ()));
+  (*q) [0] = x; (*q) [1] = y;
+  return q;
+}
+
+// Distance to the nearest node of a connected component computed without
+// the nearest neighbor structure
+hpp::core::value_type nearestInComponent
+(const hpp::core::DistancePtr_t& distance, const ConfigurationPtr_t& q,
+ const hpp::core::ConnectedComponentPtr_t& cc)
+{
+  hpp::core::value_type minDistance =
+    std::numeric_limits <hpp::core::value_type>::infinity ();
+  for (hpp::core::ConnectedComponent::Nodes_t::const_iterator it =
+	 cc->nodes ().begin (); it != cc->nodes ().end (); ++it) {
+    minDistance = std::min (minDistance, (*distance)
+			    (*q, *((*it)->configuration ())));
+  }
+  return minDistance;
+}
+
+BOOST_AUTO_TEST_CASE (RemoveNode) {
+  DevicePtr_t robot = createPlanarRobot ();
+  SteeringMethodStraightPtr_t sm = SteeringMethodStraight::create (robot);
+  hpp::core::DistancePtr_t distance (WeighedDistance::create
+				     (robot, boost::assign::list_of (1)(1)));
+  RoadmapPtr_t r = Roadmap::create (distance, robot);
+  // Small buckets so that the tree has several levels; roadmap takes
+  // ownership of the tree.
+  r->nearestNeighbor (new hpp::core::nearestNeighbor::KDTree
+		      (robot, distance, 2));
+
+  // Chain of nodes linked in both directions
+  const std::size_t n = 20;
+  std::vector <NodePtr_t> nodes;
+  for (std::size_t i=0; i < n; ++i) {
+    nodes.push_back (r->addNode (planarConfig (robot, .25 * i - 2.5,
+					       i % 2 ? .1 : -.1)));
+    if (i > 0) {
+      addEdge (r, *sm, nodes, i - 1, i);
+      addEdge (r, *sm, nodes, i, i - 1);
+    }
+  }
+  BOOST_CHECK_EQUAL (r->connectedComponents ().size (), 1);
+
+  // Removing the middle node splits the chain
+  r->removeNode (nodes [10]);
+  nodes [10] = 0x0;
+  BOOST_CHECK_EQUAL (r->nodes ().size (), n - 1);
+  BOOST_CHECK_EQUAL (r->edges ().size (), 2 * (n - 3));
+  BOOST_CHECK_EQUAL (r->connectedComponents ().size (), 2);
+  hpp::core::ConnectedComponentPtr_t cc1 (nodes [0]->connectedComponent ());
+  hpp::core::ConnectedComponentPtr_t cc2 (nodes [n-1]->connectedComponent ());
+  BOOST_CHECK (cc1 != cc2);
+  BOOST_CHECK_EQUAL (cc1->nodes ().size (), 10);
+  BOOST_CHECK_EQUAL (cc2->nodes ().size (), n - 11);
+  for (std::size_t i=0; i < n; ++i) {
+    if (i == 10) continue;
+    BOOST_CHECK (nodes [i]->connectedComponent () == (i < 10 ? cc1 : cc2));
+  }
+  BOOST_CHECK (!cc1->canReach (cc2));
+  BOOST_CHECK (!cc2->canReach (cc1));
+
+  // Searches of the k-d tree do not return the removed node and find the
+  // nearest node of each component.
+  hpp::core::value_type minDistance;
+  for (std::size_t i=0; i < 40; ++i) {
+    ConfigurationPtr_t q (planarConfig (robot, .15 * i - 3., .05 * i - 1.));
+    hpp::core::NearestNodes_t nearest;
+    r->nearestNodes (q, nearest);
+    BOOST_CHECK_EQUAL (nearest.size (), 2);
+    for (std::size_t j=0; j < nearest.size (); ++j) {
+      BOOST_CHECK (nearest [j].second.first != 0x0);
+      BOOST_CHECK_CLOSE (nearest [j].second.second, nearestInComponent
+			 (distance, q, nearest [j].first), 1e-10);
+    }
+    r->nearestNode (q, cc1, minDistance);
+    BOOST_CHECK_CLOSE (minDistance, nearestInComponent (distance, q, cc1),
+		       1e-10);
+    r->nearestNode (q, cc2, minDistance);
+    BOOST_CHECK_CLOSE (minDistance, nearestInComponent (distance, q, cc2),
+		       1e-10);
+  }
+  // Configuration of the removed node
+  ConfigurationPtr_t q (planarConfig (robot, 0, -.1));
+  NodePtr_t near = r->nearestNode (q, minDistance);
+  BOOST_CHECK (near == nodes [9] || near == nodes [11]);
+  BOOST_CHECK_CLOSE (minDistance, sqrt (.25 * .25 + .2 * .2), 1e-10);
+
+  // Removing one direction of an edge makes one component reach the other
+  hpp::core::EdgePtr_t edge = 0x0;
+  for (hpp::core::Node::Edges_t::const_iterator it =
+	 nodes [4]->outEdges ().begin (); it != nodes [4]->outEdges ().end ();
+       ++it) {
+    if ((*it)->to () == nodes [5]) edge = *it;
+  }
+  BOOST_REQUIRE (edge);
+  r->removeEdge (edge);
+  BOOST_CHECK_EQUAL (r->edges ().size (), 2 * (n - 3) - 1);
+  BOOST_CHECK_EQUAL (r->connectedComponents ().size (), 3);
+  cc1 = nodes [0]->connectedComponent ();
+  hpp::core::ConnectedComponentPtr_t cc3 (nodes [5]->connectedComponent ());
+  BOOST_CHECK (cc1 != cc3);
+  BOOST_CHECK (nodes [4]->connectedComponent () == cc1);
+  BOOST_CHECK (nodes [9]->connectedComponent () == cc3);
+  BOOST_CHECK (cc3->canReach (cc1));
+  BOOST_CHECK (!cc1->canReach (cc3));
+  for (std::size_t i=0; i < 20; ++i) {
+    ConfigurationPtr_t q (planarConfig (robot, .1 * i - 1.5, 0));
+    r->nearestNode (q, cc1, minDistance);
+    BOOST_CHECK_CLOSE (minDistance, nearestInComponent (distance, q, cc1),
+		       1e-10);
+    r->nearestNode (q, cc3, minDistance);
+    BOOST_CHECK_CLOSE (minDistance, nearestInComponent (distance, q, cc3),
+		       1e-10);
+  }
+
+  // Removing the last node of a component removes the component
+  const std::size_t sizeBefore = r->connectedComponents ().size ();
+  NodePtr_t single = r->addNode (planarConfig (robot, 2.9, 2.9));
+  BOOST_CHECK_EQUAL (r->connectedComponents ().size (), sizeBefore + 1);
+  r->removeNode (single);
+  BOOST_CHECK_EQUAL (r->connectedComponents ().size (), sizeBefore);
+}
+
+BOOST_AUTO_TEST_CASE (Sparsify) {
+  DevicePtr_t robot = createPlanarRobot ();
+  SteeringMethodStraightPtr_t sm = SteeringMethodStraight::create (robot);
+  hpp::core::DistancePtr_t distance (WeighedDistance::create
+				     (robot, boost::assign::list_of (1)(1)));
+  RoadmapPtr_t r = Roadmap::create (distance, robot);
+
+  // Unit square with its diagonals, and node 4 linked to node 1 only
+  std::vector <NodePtr_t> nodes;
+  hpp::core::value_type coordinates [5][2] =
+    {{0, 0}, {1, 0}, {0, 1}, {1, 1}, {2, 0}};
+  r->initNode (planarConfig (robot, 0, 0));
+  nodes.push_back (r->initNode ());
+  for (std::size_t i=1; i < 5; ++i) {
+    nodes.push_back (r->addNode (planarConfig (robot, coordinates [i][0],
+					       coordinates [i][1])));
+  }
+  r->addGoalNode (nodes [3]->configuration ());
+  for (std::size_t i=0; i < 4; ++i) {
+    for (std::size_t j=i+1; j < 4; ++j) {
+      addEdge (r, *sm, nodes, i, j);
+      addEdge (r, *sm, nodes, j, i);
+    }
+  }
+  addEdge (r, *sm, nodes, 1, 4);
+  addEdge (r, *sm, nodes, 4, 1);
+  BOOST_CHECK_EQUAL (r->edges ().size (), 14);
+  BOOST_CHECK_THROW (r->sparsify (.5), std::invalid_argument);
+
+  // Diagonals are longer than two sides divided by the stretch factor
+  BOOST_CHECK_EQUAL (r->sparsify (1), 0);
+  BOOST_CHECK_EQUAL (r->edges ().size (), 14);
+
+  // Diagonals are replaced by two sides, node 4 is kept.
+  hpp::core::Nodes_t kept (1, nodes [4]);
+  BOOST_CHECK_EQUAL (r->sparsify (1.5, kept), 4);
+  BOOST_CHECK_EQUAL (r->edges ().size (), 10);
+  BOOST_CHECK_EQUAL (r->nodes ().size (), 5);
+  for (hpp::core::Edges_t::const_iterator it = r->edges ().begin ();
+       it != r->edges ().end (); ++it) {
+    BOOST_CHECK_CLOSE ((*it)->length (), 1, 1e-10);
+  }
+  BOOST_CHECK_EQUAL (r->connectedComponents ().size (), 1);
+  BOOST_CHECK (r->pathExists ());
+  hpp::core::PathVectorPtr_t path = r->shortestPath (distance);
+  BOOST_CHECK_CLOSE (path->length (), 2, 1e-10);
+  BOOST_CHECK (path->length () <= 1.5 * sqrt (2));
+
+  // Nothing to remove, node 4 is a dead end removed by prune.
+  BOOST_CHECK_EQUAL (r->sparsify (1.5), 0);
+  BOOST_CHECK_EQUAL (r->nodes ().size (), 4);
+  BOOST_CHECK_EQUAL (r->edges ().size (), 8);
+  BOOST_CHECK_EQUAL (r->connectedComponents ().size (), 1);
+  hpp::core::value_type minDistance;
+  BOOST_CHECK (r->nearestNode (planarConfig (robot, 2, 0), minDistance) ==
+	       nodes [1]);
+  BOOST_CHECK_CLOSE (minDistance, 1, 1e-10);
+}
+
+// Shoot always the same configuration
+class ConstantShooter : public hpp::core::ConfigurationShooter
+{
+public:
+  ConstantShooter (const ConfigurationPtr_t& q) : q_ (q)
+  {
+  }
+  virtual ConfigurationPtr_t shoot () const
+  {
+    return ConfigurationPtr_t (new Configuration_t (*q_));
+  }
+private:
+  ConfigurationPtr_t q_;
+}; // class ConstantShooter
+
+BOOST_AUTO_TEST_CASE (RrtStarRewiring) {
+  DevicePtr_t robot = createPlanarRobot ();
+  SteeringMethodStraightPtr_t sm = SteeringMethodStraight::create (robot);
+  hpp::core::DistancePtr_t distance (WeighedDistance::create
+				     (robot, boost::assign::list_of (1)(1)));
+  hpp::core::Problem problem (robot);
+  problem.distance (distance);
+  problem.initConfig (planarConfig (robot, 0, 0));
+  problem.addGoalConfig (planarConfig (robot, 2.5, 2.5));
+  // Random configurations are all the same, close to the initial node
+  problem.configurationShooter (hpp::core::ConfigurationShooterPtr_t
+				(new ConstantShooter
+				 (planarConfig (robot, .9, 0))));
+
+  // Node x is reached from the initial node through a detour by node d.
+  RoadmapPtr_t r = Roadmap::create (distance, robot);
+  r->initNode (problem.initConfig ());
+  std::vector <NodePtr_t> nodes;
+  nodes.push_back (r->initNode ());
+  nodes.push_back (r->addNode (planarConfig (robot, 1, 2)));
+  nodes.push_back (r->addNode (planarConfig (robot, 2, 0)));
+  for (std::size_t i=0; i < 2; ++i) {
+    addEdge (r, *sm, nodes, i, i + 1);
+    addEdge (r, *sm, nodes, i + 1, i);
+  }
+  hpp::core::RrtStarPlannerPtr_t planner =
+    hpp::core::RrtStarPlanner::createWithRoadmap (problem, r);
+  planner->startSolve ();
+  BOOST_CHECK_EQUAL (planner->nodeCost (nodes [0]), 0);
+  BOOST_CHECK_CLOSE (planner->nodeCost (nodes [1]), sqrt (5), 1e-10);
+  BOOST_CHECK_CLOSE (planner->nodeCost (nodes [2]), 2 * sqrt (5), 1e-10);
+  BOOST_CHECK (planner->parentEdge (nodes [2])->from () == nodes [1]);
+
+  // The new node (.9, 0), child of the initial node, becomes the parent of
+  // x. The cost of d does not decrease through the new node.
+  planner->oneStep ();
+  BOOST_CHECK_EQUAL (r->nodes ().size (), 5);
+  NodePtr_t newNode = r->nodes ().back ();
+  BOOST_CHECK (*(newNode->configuration ()) == *planarConfig (robot, .9, 0));
+  BOOST_CHECK_CLOSE (planner->nodeCost (newNode), .9, 1e-10);
+  BOOST_CHECK (planner->parentEdge (newNode)->from () == nodes [0]);
+  BOOST_CHECK_CLOSE (planner->nodeCost (nodes [2]), 2, 1e-10);
+  BOOST_CHECK (planner->parentEdge (nodes [2])->from () == newNode);
+  BOOST_CHECK_CLOSE (planner->nodeCost (nodes [1]), sqrt (5), 1e-10);
+  BOOST_CHECK (planner->parentEdge (nodes [1])->from () == nodes [0]);
+  // The new cost of x is the cost of its path in the roadmap.
+  BOOST_CHECK_CLOSE (planner->nodeCost (nodes [2]),
+		     planner->nodeCost (newNode) +
+		     planner->parentEdge (nodes [2])->length (), 1e-10);
+}
+
+// Whether a vector of edges contains an edge
+bool contains (const hpp::core::Edges_t& edges,
+	       const hpp::core::EdgePtr_t& edge)
+{
+  return std::find (edges.begin (), edges.end (), edge) != edges.end ();
+}
+
+BOOST_AUTO_TEST_CASE (EdgeInvalidation) {
+  DevicePtr_t robot = createPlanarRobot ();
+  // Cube of side .2 moving with the robot
+  fcl::CollisionGeometryPtr_t box (new fcl::Box (.2, .2, .2));
+  hpp::model::BodyPtr_t body = new hpp::model::Body ();
+  robot->getJointVector ().back ()->setLinkedBody (body);
+  body->addInnerObject (hpp::model::CollisionObject::create
+			(box, fcl::Transform3f (), "box"), true, true);
+  SteeringMethodStraightPtr_t sm = SteeringMethodStraight::create (robot);
+  hpp::core::DistancePtr_t distance (WeighedDistance::create
+				     (robot, boost::assign::list_of (1)(1)));
+  RoadmapPtr_t r = Roadmap::create (distance, robot);
+
+  // Two horizontal edges linked by a vertical edge
+  std::vector <NodePtr_t> nodes;
+  r->initNode (planarConfig (robot, 0, 0));
+  nodes.push_back (r->initNode ());
+  nodes.push_back (r->addNode (planarConfig (robot, 2, 0)));
+  nodes.push_back (r->addNode (planarConfig (robot, 0, 2.5)));
+  nodes.push_back (r->addNode (planarConfig (robot, 2, 2.5)));
+  r->addGoalNode (nodes [2]->configuration ());
+  const std::size_t from [3] = {0, 1, 3};
+  const std::size_t to [3] = {1, 3, 2};
+  for (std::size_t i=0; i < 3; ++i) {
+    addEdge (r, *sm, nodes, from [i], to [i]);
+    addEdge (r, *sm, nodes, to [i], from [i]);
+  }
+  BOOST_CHECK_EQUAL (r->edges ().size (), 6);
+  BOOST_CHECK (r->pathExists ());
+  const hpp::core::Node::Edges_t& outEdges (nodes [0]->outEdges ());
+  BOOST_REQUIRE_EQUAL (outEdges.size (), 1);
+  hpp::core::EdgePtr_t crossing (outEdges.front ());
+  const hpp::core::Node::Edges_t& inEdges (nodes [0]->inEdges ());
+  BOOST_REQUIRE_EQUAL (inEdges.size (), 1);
+  hpp::core::EdgePtr_t crossingReverse (inEdges.front ());
+  hpp::core::EdgePtr_t far (nodes [2]->outEdges ().front ());
+
+  // Cube of side .5 across the edge between nodes 0 and 1
+  hpp::core::ObjectVector_t obstacles;
+  BOOST_CHECK (r->edgesNear (obstacles).empty ());
+  fcl::CollisionGeometryPtr_t cube (new fcl::Box (.5, .5, .5));
+  fcl::Transform3f position;
+  position.setTranslation (fcl::Vec3f (1, 0, 0));
+  obstacles.push_back (hpp::model::CollisionObject::create
+		       (cube, position, "obstacle"));
+  hpp::core::Edges_t near (r->edgesNear (obstacles));
+  BOOST_CHECK (contains (near, crossing));
+  BOOST_CHECK (contains (near, crossingReverse));
+  BOOST_CHECK (!contains (near, far));
+
+  // Same edges with the swept volumes in an AABB tree
+  r->indexEdges (true);
+  BOOST_CHECK (r->indexEdges ());
+  hpp::core::Edges_t indexed (r->edgesNear (obstacles));
+  BOOST_CHECK_EQUAL (indexed.size (), near.size ());
+  for (hpp::core::Edges_t::const_iterator it = near.begin ();
+       it != near.end (); ++it) {
+    BOOST_CHECK (contains (indexed, *it));
+  }
+
+  // Only the edges through the obstacle are removed, the initial node is
+  // not connected to the goal anymore.
+  hpp::core::DiscretizedCollisionCheckingPtr_t validation
+    (hpp::core::DiscretizedCollisionChecking::create (robot, .05));
+  validation->addObstacle (obstacles.front ());
+  BOOST_CHECK_EQUAL (r->removeInvalidEdges (validation, obstacles), 2);
+  BOOST_CHECK_EQUAL (r->edges ().size (), 4);
+  BOOST_CHECK (nodes [0]->outEdges ().empty ());
+  BOOST_CHECK (nodes [0]->inEdges ().empty ());
+  BOOST_CHECK_EQUAL (r->connectedComponents ().size (), 2);
+  BOOST_CHECK (!r->pathExists ());
+  BOOST_CHECK_EQUAL (r->removeInvalidEdges (validation, obstacles), 0);
+  BOOST_CHECK_EQUAL (r->edges ().size (), 4);
 }
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,133 @@
+// Copyright (C) 2016 LAAS-CNRS
+//
+// This file is part of the hpp-core.
+//
+// hpp-core is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// test-hpp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with hpp-core.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cstdio>
+#include <fstream>
+#include <boost/assign.hpp>
+
+#include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/model/joint-configuration.hh>
+#include <hpp/core/fwd.hh>
+#include <hpp/core/edge.hh>
+#include <hpp/core/node.hh>
+#include <hpp/core/parser/binary.hh>
+#include <hpp/core/roadmap.hh>
+#include <hpp/core/steering-method-straight.hh>
+#include <hpp/core/straight-path.hh>
+#include <hpp/core/weighed-distance.hh>
+
+#define BOOST_TEST_MODULE binaryRoadmap
+#include <boost/test/included/unit_test.hpp>
+
+using namespace hpp;
+using namespace core;
+using namespace model;
+using hpp::core::parser::BinaryHeader;
+using hpp::core::parser::MappedRoadmap;
+
+BOOST_AUTO_TEST_SUITE( test_hpp_core )
+
+BOOST_AUTO_TEST_CASE (roadmapRoundTrip) {
+  DevicePtr_t robot = Device::create("robot");
+  JointPtr_t xJoint = new JointTranslation <1> (fcl::Transform3f());
+  xJoint->isBounded(0,1);
+  xJoint->lowerBound(0,-3.);
+  xJoint->upperBound(0,3.);
+  JointPtr_t yJoint = new JointTranslation <1>
+    (fcl::Transform3f(fcl::Quaternion3f (sqrt (2)/2, 0, 0, sqrt(2)/2)));
+  yJoint->isBounded(0,1);
+  yJoint->lowerBound(0,-3.);
+  yJoint->upperBound(0,3.);
+  robot->rootJoint (xJoint);
+  xJoint->addChildJoint (yJoint);
+
+  SteeringMethodStraightPtr_t sm = SteeringMethodStraight::create (robot);
+  DistancePtr_t distance (WeighedDistance::create
+			  (robot, boost::assign::list_of (1)(1)));
+  RoadmapPtr_t r = Roadmap::create (distance, robot);
+  std::vector <NodePtr_t> nodes;
+  for (std::size_t i = 0; i < 3; ++i) {
+    ConfigurationPtr_t q (new Configuration_t (robot->configSize ()));
+    (*q) [0] = (value_type) i; (*q) [1] = .5 * i;
+    nodes.push_back (r->addNode (q));
+  }
+  r->initNode (nodes [0]->configuration ());
+  r->addGoalNode (nodes [2]->configuration ());
+  // Straight edge
+  r->addEdge (nodes [0], nodes [1], (*sm) (*(nodes [0]->configuration ()),
+					   *(nodes [1]->configuration ())));
+  // Edge the path of which is not computed yet
+  value_type length = (*distance) (*(nodes [1]->configuration ()),
+				   *(nodes [2]->configuration ()));
+  r->addEdge (nodes [1], nodes [2], sm, length);
+
+  const std::string filename ("test-binary-roadmap.bin");
+  {
+    std::ofstream file (filename.c_str (), std::ios::binary);
+    parser::writeRoadmapBinary (file, r, robot);
+  }
+  {
+    MappedRoadmap mapped (filename);
+    BOOST_CHECK_EQUAL (mapped.numberNodes (), 3);
+    BOOST_CHECK_EQUAL (mapped.numberEdges (), 2);
+    BOOST_CHECK (mapped.configurations ().col (2) ==
+		 *(nodes [2]->configuration ()));
+    for (std::size_t i = 0; i < mapped.numberEdges (); ++i) {
+      if (mapped.edgeFrom (i) == 0) {
+	BOOST_CHECK_EQUAL (mapped.edgeTo (i), 1);
+	BOOST_CHECK_EQUAL (mapped.edgeType (i), BinaryHeader::STRAIGHT_PATH);
+      } else {
+	BOOST_CHECK_EQUAL (mapped.edgeFrom (i), 1);
+	BOOST_CHECK_EQUAL (mapped.edgeTo (i), 2);
+	BOOST_CHECK_EQUAL (mapped.edgeType (i), BinaryHeader::OTHER_PATH);
+	BOOST_CHECK_EQUAL (mapped.edgeLength (i), length);
+      }
+    }
+    // Edges of type OTHER_PATH are computed by a steering method
+    BOOST_CHECK_THROW (mapped.roadmap (distance, robot),
+		       std::runtime_error);
+
+    RoadmapPtr_t read = mapped.roadmap (distance, robot, sm);
+    BOOST_CHECK_EQUAL (read->nodes ().size (), 3);
+    BOOST_CHECK_EQUAL (read->edges ().size (), 2);
+    BOOST_REQUIRE (read->initNode ());
+    BOOST_CHECK (*(read->initNode ()->configuration ()) ==
+		 *(nodes [0]->configuration ()));
+    BOOST_CHECK_EQUAL (read->goalNodes ().size (), 1);
+    BOOST_CHECK (*(read->goalNodes ().front ()->configuration ()) ==
+		 *(nodes [2]->configuration ()));
+    for (Edges_t::const_iterator it = read->edges ().begin ();
+	 it != read->edges ().end (); ++it) {
+      const EdgePtr_t& edge (*it);
+      if (*(edge->from ()->configuration ()) ==
+	  *(nodes [0]->configuration ())) {
+	BOOST_CHECK (edge->hasPath ());
+	BOOST_CHECK (HPP_DYNAMIC_PTR_CAST (StraightPath, edge->path ()));
+      } else {
+	BOOST_CHECK (!edge->hasPath ());
+	BOOST_CHECK_EQUAL (edge->length (), length);
+	BOOST_REQUIRE (edge->path ());
+	BOOST_CHECK (edge->path ()->end () ==
+		     *(nodes [2]->configuration ()));
+      }
+    }
+  }
+  std::remove (filename.c_str ());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
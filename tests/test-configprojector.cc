@@ -38,6 +38,7 @@ using hpp::constraints::Position;
 using hpp::constraints::PositionPtr_t;
 using hpp::constraints::matrix3_t;
 using hpp::constraints::vector3_t;
+using hpp::constraints::DifferentiableFunctionPtr_t;
 
 using namespace hpp::core;
 
@@ -267,6 +268,15 @@ DevicePtr_t createRobot ()
   return robot;
 }
 
+// Build the position constraint of apply_batch for a robot
+DifferentiableFunctionPtr_t createPosition (const DevicePtr_t& robot)
+{
+  matrix3_t rot; rot.setIdentity ();
+  vector3_t zero; zero.setZero();
+  return Position::create (robot, robot->getJointByName ("test_z"), zero,
+			   vector3_t (1, .5, 1), rot);
+}
+
 BOOST_AUTO_TEST_SUITE (config_projector)
 
 BOOST_AUTO_TEST_CASE (ref_zero)
@@ -343,4 +353,43 @@ BOOST_AUTO_TEST_CASE (ref_not_zero)
   BOOST_CHECK_MESSAGE ( cfg (2) > 1                                     , "Dof 2 should have been modified.");
 }
 
+BOOST_AUTO_TEST_CASE (apply_batch)
+{
+  DevicePtr_t dev = createRobot ();
+  BOOST_REQUIRE (dev);
+  NumericalConstraintPtr_t constraint
+    (NumericalConstraint::create (createPosition (dev)));
+  ConfigProjectorPtr_t serial =
+    ConfigProjector::create (dev, "serial", 1e-4, 20);
+  serial->add (constraint);
+  ConfigProjectorPtr_t parallel =
+    ConfigProjector::create (dev, "parallel", 1e-4, 20);
+  parallel->add (constraint);
+  std::vector <bool> success;
+  matrix_t configurations (dev->configSize (), 8);
+  configurations.setZero ();
+  // Numerical constraints are copied for other threads by their builder
+  BOOST_CHECK_THROW (parallel->applyBatch (configurations, success, 3),
+		     std::runtime_error);
+  constraint->functionBuilder (&createPosition);
+
+  for (size_type i = 0; i < configurations.cols (); ++i) {
+    configurations (0, i) = .3 * i;
+    configurations (7, i) = .1 * i;
+    configurations (3, i) = 1; // Normalize quaternion
+  }
+  matrix_t projected (configurations);
+  std::vector <bool> serialSuccess;
+  serial->applyBatch (projected, serialSuccess);
+  for (std::size_t k = 0; k < 2; ++k) {
+    // Threads and copies are kept for the second batch
+    matrix_t batch (configurations);
+    parallel->applyBatch (batch, success, 3);
+    BOOST_CHECK (success == serialSuccess);
+    BOOST_CHECK (batch.isApprox (projected));
+  }
+  BOOST_CHECK_EQUAL (parallel->statistics ().nbSuccess (),
+		     2 * serial->statistics ().nbSuccess ());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
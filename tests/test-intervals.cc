@@ -17,6 +17,7 @@
 // <http://www.gnu.org/licenses/>.
 
 #define BOOST_TEST_MODULE intervals
+#include <iostream>
 #include "continuous-collision-checking/intervals.hh"
 #include <boost/test/included/unit_test.hpp>
 
@@ -26,8 +27,8 @@ using hpp::core::continuousCollisionChecking::Intervals;
 bool checkIntervals (const Intervals& intervals)
 {
   if (intervals.list ().empty ()) return true;
-  std::list <interval_t>::const_iterator it = intervals.list ().begin ();
-  std::list <interval_t>::const_iterator it1 = it;
+  Intervals::Container_t::const_iterator it = intervals.list ().begin ();
+  Intervals::Container_t::const_iterator it1 = it;
 
   while (it1 != intervals.list ().end ()) {
     BOOST_CHECK (it1->first <= it1->second);
@@ -62,7 +63,7 @@ BOOST_AUTO_TEST_CASE (intervals_1)
   checkIntervals (intervals);
 
   BOOST_CHECK (intervals.list ().size () == 4);
-  std::list <interval_t>::const_iterator it = intervals.list ().begin ();
+  Intervals::Container_t::const_iterator it = intervals.list ().begin ();
   BOOST_CHECK_EQUAL (it->first, 0);
   BOOST_CHECK_EQUAL (it->second, 1);
   ++it;
@@ -101,7 +102,7 @@ BOOST_AUTO_TEST_CASE (intervals_2)
   checkIntervals (intervals);
 
   BOOST_CHECK (intervals.list ().size () == 4);
-  std::list <interval_t>::const_iterator it = intervals.list ().begin ();
+  Intervals::Container_t::const_iterator it = intervals.list ().begin ();
   BOOST_CHECK_EQUAL (it->first, 0);
   BOOST_CHECK_EQUAL (it->second, 1);
   ++it;
@@ -140,7 +141,7 @@ BOOST_AUTO_TEST_CASE (intervals_3)
   checkIntervals (intervals);
 
   BOOST_CHECK (intervals.list ().size () == 4);
-  std::list <interval_t>::const_iterator it = intervals.list ().begin ();
+  Intervals::Container_t::const_iterator it = intervals.list ().begin ();
   BOOST_CHECK_EQUAL (it->first, 0);
   BOOST_CHECK_EQUAL (it->second, 1);
   ++it;
@@ -179,7 +180,7 @@ BOOST_AUTO_TEST_CASE (intervals_4)
   checkIntervals (intervals);
 
   BOOST_CHECK (intervals.list ().size () == 4);
-  std::list <interval_t>::const_iterator it = intervals.list ().begin ();
+  Intervals::Container_t::const_iterator it = intervals.list ().begin ();
   BOOST_CHECK_EQUAL (it->first, 0);
   BOOST_CHECK_EQUAL (it->second, 1);
   ++it;
@@ -218,7 +219,7 @@ BOOST_AUTO_TEST_CASE (intervals_5)
   checkIntervals (intervals);
 
   BOOST_CHECK (intervals.list ().size () == 2);
-  std::list <interval_t>::const_iterator it = intervals.list ().begin ();
+  Intervals::Container_t::const_iterator it = intervals.list ().begin ();
   BOOST_CHECK_EQUAL (it->first, 0);
   BOOST_CHECK_EQUAL (it->second, 1);
   ++it;
@@ -263,4 +264,36 @@ BOOST_AUTO_TEST_CASE (interval_7)
   }
 }
 
+// Union of many small intervals, as computed by dichotomy on a long path
+// vector, compared with the intervals inserted. Timings are measured by
+// benchmark-planning.
+BOOST_AUTO_TEST_CASE (intervals_8)
+{
+  using hpp::core::value_type;
+  const unsigned int nbIntervals = 500;
+  const unsigned int nbQueries = 2000;
+  std::vector <interval_t> inserted;
+  inserted.reserve (nbIntervals);
+  srand (0);
+  Intervals intervals;
+  for (unsigned int i=0; i<nbIntervals; ++i) {
+    value_type t = 10.*rand ()/RAND_MAX;
+    value_type l = .01*rand ()/RAND_MAX;
+    inserted.push_back (interval_t (t-l, t+l));
+    intervals.unionInterval (inserted.back ());
+  }
+  checkIntervals (intervals);
+  for (unsigned int i=0; i<nbQueries; ++i) {
+    value_type t = 10.*rand ()/RAND_MAX;
+    bool expected = false;
+    for (unsigned int j=0; j<nbIntervals && !expected; ++j) {
+      expected = (inserted [j].first <= t) && (t <= inserted [j].second);
+    }
+    BOOST_CHECK_EQUAL (intervals.contains (t), expected);
+  }
+  for (unsigned int j=0; j<nbIntervals; ++j) {
+    BOOST_CHECK (intervals.contains (inserted [j]));
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -72,7 +72,8 @@ BOOST_AUTO_TEST_CASE (kdTree) {
   // Build Distance, nearestNeighbor, KDTree
   WeighedDistancePtr_t distance = WeighedDistance::create(robot);
   BasicConfigurationShooterPtr_t confShoot = BasicConfigurationShooter::create(robot);
-  nearestNeighbor::KDTree kdTree(robot,distance,30);
+  nearestNeighbor::KDTreePtr_t kdTree = new nearestNeighbor::KDTree
+    (robot,distance,30);
   nearestNeighbor::Basic basic (distance);
   SteeringMethodPtr_t sm = SteeringMethodStraight::create (robot);
 
@@ -81,7 +82,8 @@ BOOST_AUTO_TEST_CASE (kdTree) {
   NodePtr_t node;
   NodePtr_t rootNode [4];
   RoadmapPtr_t roadmap = Roadmap::create (distance, robot);
-  roadmap->nearestNeighbor(&kdTree);
+  // roadmap takes ownership of kdTree
+  roadmap->nearestNeighbor(kdTree);
   for ( int i=0 ; i<4 ; i++ ) {
     configuration = confShoot->shoot();
     rootNode [i] = roadmap->addNode (configuration);
@@ -94,6 +96,19 @@ BOOST_AUTO_TEST_CASE (kdTree) {
     }
   }
 
+  // batch distance computation
+  matrix_t configurations (robot->configSize (), 10);
+  for (size_type i=0; i < configurations.cols (); ++i) {
+    configurations.col (i) = *(confShoot->shoot ());
+  }
+  configuration = confShoot->shoot ();
+  vector_t distances (configurations.cols ());
+  distance->distances (*configuration, configurations, distances);
+  for (size_type i=0; i < configurations.cols (); ++i) {
+    BOOST_CHECK_CLOSE ((*distance) (*configuration, configurations.col (i)),
+		       distances [i], 1e-10);
+  }
+
   // search nearest node
   value_type minDistance1;
   value_type minDistance2;
@@ -114,6 +129,63 @@ BOOST_AUTO_TEST_CASE (kdTree) {
       std::cout << displayConfig (*(node1->configuration ())) << std::endl;
       std::cout << minDistance1 << std::endl;
     }
+    // search all connected components at once
+    NearestNodes_t nearestNodes;
+    roadmap->nearestNodes (configuration, nearestNodes);
+    BOOST_CHECK_EQUAL (nearestNodes.size (), 4);
+    for ( int i=0 ; i<4 ; i++ ) {
+      ConnectedComponentPtr_t cc = rootNode [i]->connectedComponent ();
+      node1 = basic.search (configuration, cc, minDistance1);
+      // Connected components are sorted in order of creation
+      BOOST_CHECK (nearestNodes [i].first == cc);
+      BOOST_CHECK (nearestNodes [i].second.first == node1);
+      BOOST_CHECK (nearestNodes [i].second.second == minDistance1);
+      // k nearest nodes and nodes within radius
+      Nodes_t kNearest1 = basic.KNearest (configuration, cc, 10,
+					  minDistance1);
+      Nodes_t kNearest2 = kdTree->KNearest (configuration, cc, 10,
+					    minDistance2);
+      BOOST_CHECK_EQUAL (kNearest1.size (), 10);
+      BOOST_CHECK (kNearest1 == kNearest2);
+      BOOST_CHECK (minDistance1 == minDistance2);
+      Nodes_t inRadius1 = basic.withinRadius (configuration, cc,
+					      minDistance1);
+      Nodes_t inRadius2 = kdTree->withinRadius (configuration, cc,
+						minDistance1);
+      BOOST_CHECK (inRadius1 == kNearest1);
+      BOOST_CHECK (inRadius1 == inRadius2);
+    }
+  }
+
+  // Add nodes concentrated along a line to unbalance the tree, then merge
+  // connected components 0 and 1.
+  for (int j=0 ; j<500 ; j++) {
+    configuration = confShoot->shoot();
+    (*configuration) [0] = -3. + 1e-4 * j;
+    (*configuration) [1] = 0.;
+    PathPtr_t path = (*sm) (*(rootNode [2]->configuration ()),
+			    *configuration);
+    roadmap->addNodeAndEdges (rootNode [2], configuration, path);
+  }
+  PathPtr_t path = (*sm) (*(rootNode [0]->configuration ()),
+			  *(rootNode [1]->configuration ()));
+  roadmap->addEdge (rootNode [0], rootNode [1], path);
+  path = (*sm) (*(rootNode [1]->configuration ()),
+		*(rootNode [0]->configuration ()));
+  roadmap->addEdge (rootNode [1], rootNode [0], path);
+  BOOST_CHECK (rootNode [0]->connectedComponent () ==
+	       rootNode [1]->connectedComponent ());
+  BOOST_CHECK_EQUAL (roadmap->connectedComponents ().size (), 3);
+  for ( int j=0 ; j<200 ; j++ ) {
+    configuration = confShoot->shoot();
+    if (j % 2 == 0) (*configuration) [0] = -3. + 1e-4 * j;
+    for ( int i=0 ; i<4 ; i++ ) {
+      ConnectedComponentPtr_t cc = rootNode [i]->connectedComponent ();
+      node1 = basic.search (configuration, cc, minDistance1);
+      node2 = roadmap->nearestNode (configuration, cc, minDistance2);
+      BOOST_CHECK( node1 == node2 );
+      BOOST_CHECK( minDistance1 == minDistance2 );
+    }
   }
 }
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,68 @@
+// Copyright (C) 2014 LAAS-CNRS
+//
+// This file is part of the hpp-core.
+//
+// hpp-core is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// test-hpp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with hpp-core.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <hpp/model/device.hh>
+#include <hpp/model/joint.hh>
+#include <hpp/model/joint-configuration.hh>
+#include <hpp/core/fwd.hh>
+#include <hpp/core/seeded-configuration-shooter.hh>
+
+#define BOOST_TEST_MODULE seededConfigurationShooter
+#include <boost/test/included/unit_test.hpp>
+
+using namespace hpp;
+using namespace core;
+using namespace model;
+
+BOOST_AUTO_TEST_SUITE( test_hpp_core )
+
+BOOST_AUTO_TEST_CASE (seededConfigurationShooter) {
+  DevicePtr_t robot = Device::create("robot");
+  JointPtr_t transJoint = new JointTranslation <3> (Transform3f());
+  for (size_type i=0; i<3; ++i) {
+    transJoint->isBounded (i, true);
+    transJoint->lowerBound(i,-3.);
+    transJoint->upperBound(i, 3.);
+  }
+  JointPtr_t so3Joint = new JointSO3(Transform3f());
+  JointPtr_t so2Joint = new jointRotation::UnBounded
+    (Transform3f (fcl::Vec3f (0, 0, 1)));
+  robot->rootJoint(transJoint);
+  transJoint->addChildJoint (so3Joint);
+  so3Joint->addChildJoint (so2Joint);
+
+  SeededConfigurationShooterPtr_t shooter1 =
+    SeededConfigurationShooter::create (robot, 42);
+  SeededConfigurationShooterPtr_t shooter2 =
+    SeededConfigurationShooter::create (robot, 42);
+  matrix_t configurations (robot->configSize (), 100);
+  shooter1->shoot (configurations);
+  Configuration_t q (robot->configSize ());
+  for (size_type i=0; i < configurations.cols (); ++i) {
+    // Same seed yields same sequence
+    shooter2->sample (q);
+    BOOST_CHECK (q == configurations.col (i));
+    for (size_type j=0; j<3; ++j) {
+      BOOST_CHECK (-3. <= q [j] && q [j] <= 3.);
+    }
+    BOOST_CHECK_CLOSE (q.segment (3, 4).norm (), 1., 1e-10);
+  }
+  // Reseeding restarts the sequence
+  shooter1->seed (42);
+  BOOST_CHECK (*(shooter1->shoot ()) == configurations.col (0));
+}
+BOOST_AUTO_TEST_SUITE_END()